@@ -420,6 +420,8 @@ class Configure(config.package.Package):
       self.compilers.LIBS = oldLibs
       return
     self.addDefine('HAVE_MPIIO', 1)
+    if self.checkLink('#include <mpi.h>\n', 'MPI_File fh;\nvoid *buf;\nMPI_Request req;\nif (MPI_File_iwrite_at_all(fh, 0, buf, 1, MPI_INT, &req));\n'):
+      self.addDefine('HAVE_MPI_FILE_IWRITE_AT_ALL', 1)
     self.compilers.CPPFLAGS = oldFlags
     self.compilers.LIBS = oldLibs
     return
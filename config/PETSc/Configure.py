@@ -140,7 +140,7 @@ class Configure(config.base.Configure):
     # test for a variety of basic headers and functions
     headersC = map(lambda name: name+'.h', ['setjmp','dos', 'endian', 'fcntl', 'float', 'io', 'limits', 'malloc', 'pwd', 'search', 'strings',
                                             'unistd', 'sys/sysinfo', 'machine/endian', 'sys/param', 'sys/procfs', 'sys/resource',
-                                            'sys/systeminfo', 'sys/times', 'sys/utsname','string', 'stdlib',
+                                            'sys/systeminfo', 'sys/times', 'sys/utsname', 'sys/mman','string', 'stdlib',
                                             'sys/socket','sys/wait','netinet/in','netdb','Direct','time','Ws2tcpip','sys/types',
                                             'WindowsX', 'cxxabi','float','ieeefp','stdint','sched','pthread','mathimf','inttypes'])
     functions = ['access', '_access', 'clock', 'drand48', 'getcwd', '_getcwd', 'getdomainname', 'gethostname',
@@ -148,7 +148,7 @@ class Configure(config.base.Configure):
                  'readlink', 'realpath',  'sigaction', 'signal', 'sigset', 'usleep', 'sleep', '_sleep', 'socket',
                  'times', 'gethostbyname', 'uname','snprintf','_snprintf','lseek','_lseek','time','fork','stricmp',
                  'strcasecmp', 'bzero', 'dlopen', 'dlsym', 'dlclose', 'dlerror','get_nprocs','sysctlbyname',
-                 '_set_output_format','_mkdir']
+                 '_set_output_format','_mkdir','mmap']
     libraries1 = [(['socket', 'nsl'], 'socket'), (['fpe'], 'handle_sigfpes')]
     self.headers.headers.extend(headersC)
     self.functions.functions.extend(functions)
@@ -804,6 +804,22 @@ fprintf(f, "%lu\\n", (unsigned long)sizeof(struct mystruct));
       self.addDefine('HAVE_BUILTIN_EXPECT', 1)
     self.popLanguage()
 
+  def configureAVX512Target(self):
+    '''Sees if single functions can be compiled for AVX-512 with __attribute((target)) and the processor checked for it at run time'''
+    self.pushLanguage(self.languages.clanguage)
+    includes = '''#include <immintrin.h>
+__attribute((target("avx512f"))) static double sum(const double *x,const int *idx) {
+  __m256i vidx = _mm512_castsi512_si256(_mm512_maskz_loadu_epi32((__mmask16)0xFF,idx));
+  return _mm512_reduce_add_pd(_mm512_fmadd_pd(_mm512_loadu_pd(x),_mm512_i32gather_pd(vidx,x,8),_mm512_setzero_pd()));
+}
+'''
+    body = '''double x[8] = {0.,1.,2.,3.,4.,5.,6.,7.};
+int idx[8] = {7,6,5,4,3,2,1,0};
+if (__builtin_cpu_supports("avx512f")) return (int)sum(x,idx);'''
+    if self.checkLink(includes, body):
+      self.addDefine('HAVE_ATTRIBUTE_TARGET_AVX512', 1)
+    self.popLanguage()
+
   def configureFunctionName(self):
     '''Sees if the compiler supports __func__ or a variant.'''
     def getFunctionName(lang):
@@ -1080,6 +1096,7 @@ fprintf(f, "%lu\\n", (unsigned long)sizeof(struct mystruct));
     self.executeTest(self.configureDeprecated)
     self.executeTest(self.configureIsatty)
     self.executeTest(self.configureExpect);
+    self.executeTest(self.configureAVX512Target)
     self.executeTest(self.configureAlign);
     self.executeTest(self.configureFunctionName);
     self.executeTest(self.configureIntptrt);
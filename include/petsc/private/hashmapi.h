@@ -0,0 +1,9 @@
+#if !defined(_PETSC_HASHMAPI_H)
+#define _PETSC_HASHMAPI_H
+
+#include <petsc/private/hashtable.h>
+
+/* Map PetscInt -> PetscInt, absent keys map to -1 */
+PETSC_HASH_MAP(HMapI,PetscInt,PetscInt,PetscHashInt,PetscHashEqual,-1)
+
+#endif /* _PETSC_HASHMAPI_H */
@@ -0,0 +1,18 @@
+#if !defined(_PETSC_HASHMAPIJ_H)
+#define _PETSC_HASHMAPIJ_H
+
+#include <petsc/private/hashtable.h>
+
+/* Key (a pair of integers) */
+typedef struct _PetscHMapIJKey {
+  PetscInt i,j;
+} PetscHMapIJKey;
+
+#define PetscHMapIJKeyHash(key) PetscHashCombine(PetscHashInt((key).i),PetscHashInt((key).j))
+
+#define PetscHMapIJKeyEqual(k1,k2) (((k1).i == (k2).i) ? ((k1).j == (k2).j) : 0)
+
+/* Map (PetscInt,PetscInt) -> PetscInt, absent keys map to -1 */
+PETSC_HASH_MAP(HMapIJ,PetscHMapIJKey,PetscInt,PetscHMapIJKeyHash,PetscHMapIJKeyEqual,-1)
+
+#endif /* _PETSC_HASHMAPIJ_H */
@@ -0,0 +1,9 @@
+#if !defined(_PETSC_HASHMAPIJV_H)
+#define _PETSC_HASHMAPIJV_H
+
+#include <petsc/private/hashmapij.h>
+
+/* Map (PetscInt,PetscInt) -> PetscScalar, absent keys map to 0 */
+PETSC_HASH_MAP(HMapIJV,PetscHMapIJKey,PetscScalar,PetscHMapIJKeyHash,PetscHMapIJKeyEqual,0)
+
+#endif /* _PETSC_HASHMAPIJV_H */
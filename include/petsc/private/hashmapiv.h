@@ -0,0 +1,9 @@
+#if !defined(_PETSC_HASHMAPIV_H)
+#define _PETSC_HASHMAPIV_H
+
+#include <petsc/private/hashtable.h>
+
+/* Map PetscInt -> PetscScalar, absent keys map to 0 */
+PETSC_HASH_MAP(HMapIV,PetscInt,PetscScalar,PetscHashInt,PetscHashEqual,0)
+
+#endif /* _PETSC_HASHMAPIV_H */
@@ -0,0 +1,9 @@
+#if !defined(_PETSC_HASHSETI_H)
+#define _PETSC_HASHSETI_H
+
+#include <petsc/private/hashtable.h>
+
+/* Set of PetscInt */
+PETSC_HASH_SET(HSetI,PetscInt,PetscHashInt,PetscHashEqual)
+
+#endif /* _PETSC_HASHSETI_H */
@@ -0,0 +1,445 @@
+#if !defined(_PETSC_HASHTABLE_H)
+#define _PETSC_HASHTABLE_H
+
+/*
+   Open-addressing hash tables with power-of-two capacity and linear probing.
+
+   Unlike PetscTable (keys restricted to 1..maxkey, prime table sizes, modulo arithmetic
+   and double hashing) these tables accept any key, locate a bucket with a single mask of
+   a mixed hash and probe consecutive buckets, so successful and unsuccessful lookups touch
+   a handful of adjacent cache lines. Deletion uses backward shifting, hence there are no
+   tombstones and lookups never degrade after many insert/delete cycles.
+
+   The tables are generated from the macros PETSC_HASH_SET() and PETSC_HASH_MAP() below;
+   see hashseti.h, hashmapi.h, hashmapiv.h, hashmapij.h and hashmapijv.h for the instantiations.
+   For a set named HSetI the generated interface is
+
+     PetscHSetICreate(PetscHSetI*)                        PetscHSetIDestroy(PetscHSetI*)
+     PetscHSetIReset(PetscHSetI)                          PetscHSetIClear(PetscHSetI)
+     PetscHSetIResize(PetscHSetI,PetscInt nkeys)          PetscHSetIGetSize(PetscHSetI,PetscInt*)
+     PetscHSetIGetCapacity(PetscHSetI,PetscInt*)          PetscHSetIHas(PetscHSetI,key,PetscBool*)
+     PetscHSetIDel(PetscHSetI,key)                        PetscHSetIAdd(PetscHSetI,key)
+     PetscHSetIQueryAdd(PetscHSetI,key,PetscBool*)        PetscHSetIAddArray(PetscHSetI,PetscInt n,const key[])
+     PetscHSetIGetElems(PetscHSetI,PetscInt *off,key[])
+
+   and for a map named HMapI additionally
+
+     PetscHMapIGet(PetscHMapI,key,val*)                   PetscHMapIGetWithDefault(PetscHMapI,key,def,val*)
+     PetscHMapISet(PetscHMapI,key,val)
+     PetscHMapIAddValue(PetscHMapI,key,val)               PetscHMapIQuerySet(PetscHMapI,key,val,PetscBool*)
+     PetscHMapISetArray(PetscHMapI,PetscInt n,const key[],const val[])
+     PetscHMapILookupArray(PetscHMapI,PetscInt n,const key[],val[])
+     PetscHMapIGetKeys(PetscHMapI,PetscInt *off,key[])    PetscHMapIGetVals(PetscHMapI,PetscInt *off,val[])
+     PetscHMapIGetPairs(PetscHMapI,PetscInt *off,key[],val[])
+
+   Get() and LookupArray() return the default value given in PETSC_HASH_MAP() for absent keys.
+   The GetElems(), GetKeys(), GetVals() and GetPairs() routines store the entries starting at
+   array[*off] in storage order and advance *off by the number of entries written.
+*/
+
+#include <petsc/private/petscimpl.h>
+
+/* Finalizer of MurmurHash3, a cheap full-avalanche mixer. Contiguous integer keys (typical
+   of column indices) would otherwise fill consecutive buckets and strided ones would collide. */
+PETSC_STATIC_INLINE PetscInt PetscHashInt(PetscInt key)
+{
+#if defined(PETSC_USE_64BIT_INDICES)
+  unsigned long long h = (unsigned long long)key;
+  h ^= h >> 33; h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+#else
+  unsigned int h = (unsigned int)key;
+  h ^= h >> 16; h *= 0x85ebca6bU;
+  h ^= h >> 13; h *= 0xc2b2ae35U;
+  h ^= h >> 16;
+#endif
+  return (PetscInt)(h & (unsigned long long)PETSC_MAX_INT);
+}
+
+PETSC_STATIC_INLINE PetscInt PetscHashCombine(PetscInt seed,PetscInt hash)
+{
+  return (PetscInt)(((size_t)seed ^ ((size_t)hash + 0x9e3779b9 + ((size_t)seed << 6) + ((size_t)seed >> 2))) & (size_t)PETSC_MAX_INT);
+}
+
+#define PetscHashEqual(a,b) ((a) == (b))
+
+/* Keep at most half of the buckets occupied; with linear probing this bounds the expected
+   length of an unsuccessful search to 2.5 probes. */
+#define PetscHashUpperBound(nbuckets) ((nbuckets) >> 1)
+
+/*
+   Core of both sets and maps. HashT is the table name (HSetI,...), KeyType/ValType the stored
+   types; IsMap is 0 for sets, in which case no value storage is allocated.
+*/
+#define PETSC_HASH_TABLE_CORE(HashT,KeyType,ValType,IsMap,HashFunc,EqualFunc)          \
+                                                                                        \
+typedef struct _n_Petsc##HashT *Petsc##HashT;                                           \
+struct _n_Petsc##HashT {                                                                \
+  PetscInt  nbuckets;   /* zero or a power of two */                                    \
+  PetscInt  size;       /* number of stored entries */                                  \
+  PetscInt  upper;      /* grow when size reaches this */                               \
+  char      *flags;     /* nonzero if the bucket is occupied */                         \
+  KeyType   *keys;                                                                      \
+  ValType   *vals;                                                                      \
+};                                                                                      \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##Create(Petsc##HashT *ht)               \
+{                                                                                       \
+  PetscErrorCode ierr;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  ierr = PetscNew(ht);CHKERRQ(ierr);                                                    \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##Reset(Petsc##HashT ht)                 \
+{                                                                                       \
+  PetscErrorCode ierr;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  ierr = PetscFree3(ht->flags,ht->keys,ht->vals);CHKERRQ(ierr);                         \
+  ht->nbuckets = ht->size = ht->upper = 0;                                              \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##Destroy(Petsc##HashT *ht)              \
+{                                                                                       \
+  PetscErrorCode ierr;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  if (!*ht) PetscFunctionReturn(0);                                                     \
+  ierr = Petsc##HashT##Reset(*ht);CHKERRQ(ierr);                                        \
+  ierr = PetscFree(*ht);CHKERRQ(ierr);                                                  \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##Clear(Petsc##HashT ht)                 \
+{                                                                                       \
+  PetscErrorCode ierr;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  if (ht->size) {ierr = PetscMemzero(ht->flags,ht->nbuckets*sizeof(char));CHKERRQ(ierr);} \
+  ht->size = 0;                                                                         \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##GetSize(Petsc##HashT ht,PetscInt *n)   \
+{                                                                                       \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  PetscValidIntPointer(n,2);                                                            \
+  *n = ht->size;                                                                        \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##GetCapacity(Petsc##HashT ht,PetscInt *n) \
+{                                                                                       \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  PetscValidIntPointer(n,2);                                                            \
+  *n = ht->nbuckets;                                                                    \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+/* Bucket holding key, or -1. Not error checked, this is the innermost loop */          \
+PETSC_STATIC_INLINE PetscInt Petsc##HashT##Locate_Private(Petsc##HashT ht,KeyType key)  \
+{                                                                                       \
+  PetscInt mask = ht->nbuckets - 1,i;                                                   \
+                                                                                        \
+  if (!ht->nbuckets) return -1;                                                         \
+  for (i=HashFunc(key)&mask; ht->flags[i]; i=(i+1)&mask) {                              \
+    if (EqualFunc(ht->keys[i],key)) return i;                                           \
+  }                                                                                     \
+  return -1;                                                                            \
+}                                                                                       \
+                                                                                        \
+/* Rehash into nbuckets (a power of two large enough for all current entries) */        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##Rehash_Private(Petsc##HashT ht,PetscInt nbuckets) \
+{                                                                                       \
+  char           *flags = ht->flags;                                                    \
+  KeyType        *keys  = ht->keys;                                                     \
+  ValType        *vals  = ht->vals;                                                     \
+  PetscInt       oldnb  = ht->nbuckets,mask = nbuckets-1,i,j;                           \
+  PetscErrorCode ierr;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  ierr = PetscMalloc3(nbuckets,&ht->flags,nbuckets,&ht->keys,IsMap ? nbuckets : 0,&ht->vals);CHKERRQ(ierr); \
+  ierr = PetscMemzero(ht->flags,nbuckets*sizeof(char));CHKERRQ(ierr);                  \
+  for (i=0; i<oldnb; i++) {                                                             \
+    if (!flags[i]) continue;                                                            \
+    for (j=HashFunc(keys[i])&mask; ht->flags[j]; j=(j+1)&mask) ;                        \
+    ht->flags[j] = 1;                                                                   \
+    ht->keys[j]  = keys[i];                                                             \
+    if (IsMap) ht->vals[j] = vals[i];                                                   \
+  }                                                                                     \
+  ierr = PetscFree3(flags,keys,vals);CHKERRQ(ierr);                                     \
+  ht->nbuckets = nbuckets;                                                              \
+  ht->upper    = PetscHashUpperBound(nbuckets);                                         \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+/* Make room for nkeys entries without further rehashing; never shrinks */              \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##Resize(Petsc##HashT ht,PetscInt nkeys) \
+{                                                                                       \
+  PetscInt       nbuckets = 4;                                                          \
+  PetscErrorCode ierr;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  if (nkeys < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of keys %D cannot be negative",nkeys); \
+  while (PetscHashUpperBound(nbuckets) <= nkeys) {                                      \
+    if (nbuckets > PETSC_MAX_INT/2) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"A really huge hash is being requested.. cannot process: %D",nkeys); \
+    nbuckets <<= 1;                                                                     \
+  }                                                                                     \
+  if (nbuckets > ht->nbuckets) {ierr = Petsc##HashT##Rehash_Private(ht,nbuckets);CHKERRQ(ierr);} \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+/* Bucket for key in *i, inserting the key (but not a value) if it was not present */   \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##Insert_Private(Petsc##HashT ht,KeyType key,PetscInt *i,PetscBool *missing) \
+{                                                                                       \
+  PetscInt       mask,j;                                                                \
+  PetscErrorCode ierr;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  *i = -1; *missing = PETSC_FALSE; /* set on the error path too, for the callers */     \
+  if (ht->size >= ht->upper) {ierr = Petsc##HashT##Resize(ht,ht->size+1);CHKERRQ(ierr);} \
+  mask = ht->nbuckets - 1;                                                              \
+  for (j=HashFunc(key)&mask; ht->flags[j]; j=(j+1)&mask) {                              \
+    if (EqualFunc(ht->keys[j],key)) {*i = j; *missing = PETSC_FALSE; PetscFunctionReturn(0);} \
+  }                                                                                     \
+  ht->flags[j] = 1;                                                                     \
+  ht->keys[j]  = key;                                                                   \
+  ht->size++;                                                                           \
+  *i = j; *missing = PETSC_TRUE;                                                        \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##Has(Petsc##HashT ht,KeyType key,PetscBool *has) \
+{                                                                                       \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  PetscValidPointer(has,3);                                                             \
+  *has = Petsc##HashT##Locate_Private(ht,key) >= 0 ? PETSC_TRUE : PETSC_FALSE;          \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+/* Removes key if present; later entries of the cluster are shifted back into the hole */ \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##Del(Petsc##HashT ht,KeyType key)       \
+{                                                                                       \
+  PetscInt mask,i,j,k;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  if ((i = Petsc##HashT##Locate_Private(ht,key)) < 0) PetscFunctionReturn(0);           \
+  mask = ht->nbuckets - 1;                                                              \
+  for (j=(i+1)&mask; ht->flags[j]; j=(j+1)&mask) {                                      \
+    k = HashFunc(ht->keys[j])&mask;                                                     \
+    /* entry j may move to i only if its home bucket k is not cyclically within (i,j] */ \
+    if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j)) continue;                     \
+    ht->keys[i] = ht->keys[j];                                                          \
+    if (IsMap) ht->vals[i] = ht->vals[j];                                               \
+    i = j;                                                                              \
+  }                                                                                     \
+  ht->flags[i] = 0;                                                                     \
+  ht->size--;                                                                           \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+
+#define PETSC_HASH_SET(HashT,KeyType,HashFunc,EqualFunc)                                \
+                                                                                        \
+PETSC_HASH_TABLE_CORE(HashT,KeyType,char,0,HashFunc,EqualFunc)                          \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##QueryAdd(Petsc##HashT ht,KeyType key,PetscBool *missing) \
+{                                                                                       \
+  PetscInt       i;                                                                     \
+  PetscErrorCode ierr;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  PetscValidPointer(missing,3);                                                         \
+  ierr = Petsc##HashT##Insert_Private(ht,key,&i,missing);CHKERRQ(ierr);                 \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##Add(Petsc##HashT ht,KeyType key)       \
+{                                                                                       \
+  PetscInt       i;                                                                     \
+  PetscBool      missing;                                                               \
+  PetscErrorCode ierr;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  ierr = Petsc##HashT##Insert_Private(ht,key,&i,&missing);CHKERRQ(ierr);                \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##AddArray(Petsc##HashT ht,PetscInt n,const KeyType keys[]) \
+{                                                                                       \
+  PetscInt       i,j;                                                                   \
+  PetscBool      missing;                                                               \
+  PetscErrorCode ierr;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  if (n) PetscValidPointer(keys,3);                                                     \
+  ierr = Petsc##HashT##Resize(ht,ht->size+n);CHKERRQ(ierr);                             \
+  for (i=0; i<n; i++) {ierr = Petsc##HashT##Insert_Private(ht,keys[i],&j,&missing);CHKERRQ(ierr);} \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##GetElems(Petsc##HashT ht,PetscInt *off,KeyType array[]) \
+{                                                                                       \
+  PetscInt i,pos;                                                                       \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  PetscValidIntPointer(off,2);                                                          \
+  pos = *off;                                                                           \
+  for (i=0; i<ht->nbuckets; i++) if (ht->flags[i]) array[pos++] = ht->keys[i];          \
+  *off = pos;                                                                           \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+
+#define PETSC_HASH_MAP(HashT,KeyType,ValType,HashFunc,EqualFunc,DefaultValue)           \
+                                                                                        \
+PETSC_HASH_TABLE_CORE(HashT,KeyType,ValType,1,HashFunc,EqualFunc)                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##Get(Petsc##HashT ht,KeyType key,ValType *val) \
+{                                                                                       \
+  PetscInt i;                                                                           \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  PetscValidPointer(val,3);                                                             \
+  i    = Petsc##HashT##Locate_Private(ht,key);                                          \
+  *val = (i >= 0) ? ht->vals[i] : (DefaultValue);                                       \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##GetWithDefault(Petsc##HashT ht,KeyType key,ValType def,ValType *val) \
+{                                                                                       \
+  PetscInt i;                                                                           \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  PetscValidPointer(val,4);                                                             \
+  i    = Petsc##HashT##Locate_Private(ht,key);                                          \
+  *val = (i >= 0) ? ht->vals[i] : def;                                                  \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##QuerySet(Petsc##HashT ht,KeyType key,ValType val,PetscBool *missing) \
+{                                                                                       \
+  PetscInt       i;                                                                     \
+  PetscErrorCode ierr;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  PetscValidPointer(missing,4);                                                         \
+  ierr = Petsc##HashT##Insert_Private(ht,key,&i,missing);CHKERRQ(ierr);                 \
+  ht->vals[i] = val;                                                                    \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##Set(Petsc##HashT ht,KeyType key,ValType val) \
+{                                                                                       \
+  PetscInt       i;                                                                     \
+  PetscBool      missing;                                                               \
+  PetscErrorCode ierr;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  ierr = Petsc##HashT##Insert_Private(ht,key,&i,&missing);CHKERRQ(ierr);                \
+  ht->vals[i] = val;                                                                    \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+/* Accumulates into the value of key, an absent key starts from zero */                 \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##AddValue(Petsc##HashT ht,KeyType key,ValType val) \
+{                                                                                       \
+  PetscInt       i;                                                                     \
+  PetscBool      missing;                                                               \
+  PetscErrorCode ierr;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  ierr = Petsc##HashT##Insert_Private(ht,key,&i,&missing);CHKERRQ(ierr);                \
+  if (missing) ht->vals[i] = val;                                                       \
+  else ht->vals[i] += val;                                                              \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##SetArray(Petsc##HashT ht,PetscInt n,const KeyType keys[],const ValType vals[]) \
+{                                                                                       \
+  PetscInt       i,j;                                                                   \
+  PetscBool      missing;                                                               \
+  PetscErrorCode ierr;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  if (n) {PetscValidPointer(keys,3); PetscValidPointer(vals,4);}                        \
+  ierr = Petsc##HashT##Resize(ht,ht->size+n);CHKERRQ(ierr);                             \
+  for (i=0; i<n; i++) {                                                                 \
+    ierr = Petsc##HashT##Insert_Private(ht,keys[i],&j,&missing);CHKERRQ(ierr);          \
+    ht->vals[j] = vals[i];                                                              \
+  }                                                                                     \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##LookupArray(Petsc##HashT ht,PetscInt n,const KeyType keys[],ValType vals[]) \
+{                                                                                       \
+  PetscInt i,j;                                                                         \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  if (n) {PetscValidPointer(keys,3); PetscValidPointer(vals,4);}                        \
+  for (i=0; i<n; i++) {                                                                 \
+    j       = Petsc##HashT##Locate_Private(ht,keys[i]);                                 \
+    vals[i] = (j >= 0) ? ht->vals[j] : (DefaultValue);                                  \
+  }                                                                                     \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##GetPairs(Petsc##HashT ht,PetscInt *off,KeyType karray[],ValType varray[]) \
+{                                                                                       \
+  PetscInt i,pos;                                                                       \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  PetscValidPointer(ht,1);                                                              \
+  PetscValidIntPointer(off,2);                                                          \
+  pos = *off;                                                                           \
+  for (i=0; i<ht->nbuckets; i++) {                                                      \
+    if (!ht->flags[i]) continue;                                                        \
+    if (karray) karray[pos] = ht->keys[i];                                              \
+    if (varray) varray[pos] = ht->vals[i];                                              \
+    pos++;                                                                              \
+  }                                                                                     \
+  *off = pos;                                                                           \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##GetKeys(Petsc##HashT ht,PetscInt *off,KeyType array[]) \
+{                                                                                       \
+  PetscErrorCode ierr;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  ierr = Petsc##HashT##GetPairs(ht,off,array,NULL);CHKERRQ(ierr);                       \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+                                                                                        \
+PETSC_STATIC_INLINE PetscErrorCode Petsc##HashT##GetVals(Petsc##HashT ht,PetscInt *off,ValType array[]) \
+{                                                                                       \
+  PetscErrorCode ierr;                                                                  \
+                                                                                        \
+  PetscFunctionBegin;                                                                   \
+  ierr = Petsc##HashT##GetPairs(ht,off,NULL,array);CHKERRQ(ierr);                       \
+  PetscFunctionReturn(0);                                                               \
+}                                                                                       \
+
+#endif /* _PETSC_HASHTABLE_H */
@@ -525,6 +525,10 @@ struct  _p_MatFDColoring{
   PetscBool      fset;             /* indicates that the initial function value F(X) is set */
   PetscErrorCode (*f)(void);       /* function that defines Jacobian */
   void           *fctx;            /* optional user-defined context for use by the function f */
+  PetscErrorCode (*fbatch)(void*,PetscInt,Vec*,Vec*,void*); /* evaluates the function at several points at once */
+  void           *fbatchctx;
+  Vec            *xb,*yb;          /* perturbed points and function values for fbatch */
+  PetscInt       nb;               /* number of vectors in xb and yb */
   Vec            vscale;           /* holds FD scaling, i.e. 1/dx for each perturbed column */
   PetscInt       currentcolor;     /* color for which function evaluation is being done now */
   const char     *htype;           /* "wp" or "ds" */
@@ -602,6 +606,7 @@ typedef struct {
  Used by MatCreateSubMatrices_MPIXAIJ_Local()
 */
 #include <petscctable.h>
+#include <petsc/private/hashmapi.h>
 typedef struct { /* used by MatCreateSubMatrices_MPIAIJ_SingleIS_Local() and MatCreateSubMatrices_MPIAIJ_Local */
   PetscInt   id;   /* index of submats, only submats[0] is responsible for deleting some arrays below */
   PetscInt   nrqs,nrqr;
@@ -615,8 +620,14 @@ typedef struct { /* used by MatCreateSubMatrices_MPIAIJ_SingleIS_Local() and Mat
   PetscBool  singleis;
   PetscInt   *row2proc; /* row to proc map */
   PetscInt   nstages;
+
+  /* value exchange of MAT_REUSE_MATRIX, only submats[0] owns the persistent requests and buffers */
+  MPI_Request *v_waits;        /* nrqs persistent receives followed by nrqr persistent sends */
+  PetscScalar **rbuf4,**sbuf_aa;
+  PetscInt    *rbuf4_dest;     /* location in submats[is_no]->a of each received value, -1 if its column is not kept */
+  PetscInt    *loc_dest;       /* location in this submat's a of each entry of its local rows of C, -1 if not kept */
 #if defined(PETSC_USE_CTABLE)
-  PetscTable cmap,rmap;
+  PetscHMapI cmap,rmap;
   PetscInt   *cmap_loc,*rmap_loc;
 #else
   PetscInt   *cmap,*rmap;
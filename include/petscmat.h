@@ -29,6 +29,9 @@ typedef const char* MatType;
 #define MATMAIJ            "maij"
 #define MATSEQMAIJ         "seqmaij"
 #define MATMPIMAIJ         "mpimaij"
+#define MATKAIJ            "kaij"
+#define MATSEQKAIJ         "seqkaij"
+#define MATMPIKAIJ         "mpikaij"
 #define MATIS              "is"
 #define MATAIJ             "aij"
 #define MATSEQAIJ          "seqaij"
@@ -48,6 +51,18 @@ typedef const char* MatType;
 #define MATAIJPERM         "aijperm"
 #define MATSEQAIJPERM      "seqaijperm"
 #define MATMPIAIJPERM      "mpiaijperm"
+#define MATAIJSELL         "aijsell"
+#define MATSEQAIJSELL      "seqaijsell"
+#define MATMPIAIJSELL      "mpiaijsell"
+#define MATAIJDELTA        "aijdelta"
+#define MATSEQAIJDELTA     "seqaijdelta"
+#define MATMPIAIJDELTA     "mpiaijdelta"
+#define MATAIJMIXED        "aijmixed"
+#define MATSEQAIJMIXED     "seqaijmixed"
+#define MATMPIAIJMIXED     "mpiaijmixed"
+#define MATAIJOMP          "aijomp"
+#define MATSEQAIJOMP       "seqaijomp"
+#define MATMPIAIJOMP       "mpiaijomp"
 #define MATSHELL           "shell"
 #define MATDENSE           "dense"
 #define MATSEQDENSE        "seqdense"
@@ -227,6 +242,16 @@ PETSC_EXTERN PetscErrorCode MatLRCGetMats(Mat,Mat*,Mat*,Vec*,Mat*);
 PETSC_EXTERN PetscErrorCode MatCreateIS(MPI_Comm,PetscInt,PetscInt,PetscInt,PetscInt,PetscInt,ISLocalToGlobalMapping,ISLocalToGlobalMapping,Mat*);
 PETSC_EXTERN PetscErrorCode MatCreateSeqAIJCRL(MPI_Comm,PetscInt,PetscInt,PetscInt,const PetscInt[],Mat*);
 PETSC_EXTERN PetscErrorCode MatCreateMPIAIJCRL(MPI_Comm,PetscInt,PetscInt,PetscInt,const PetscInt[],PetscInt,const PetscInt[],Mat*);
+PETSC_EXTERN PetscErrorCode MatCreateSeqAIJSELL(MPI_Comm,PetscInt,PetscInt,PetscInt,const PetscInt[],Mat*);
+PETSC_EXTERN PetscErrorCode MatCreateMPIAIJSELL(MPI_Comm,PetscInt,PetscInt,PetscInt,PetscInt,PetscInt,const PetscInt[],PetscInt,const PetscInt[],Mat*);
+PETSC_EXTERN PetscErrorCode MatCreateSeqAIJDelta(MPI_Comm,PetscInt,PetscInt,PetscInt,const PetscInt[],Mat*);
+PETSC_EXTERN PetscErrorCode MatCreateMPIAIJDelta(MPI_Comm,PetscInt,PetscInt,PetscInt,PetscInt,PetscInt,const PetscInt[],PetscInt,const PetscInt[],Mat*);
+PETSC_EXTERN PetscErrorCode MatCreateSeqAIJMixed(MPI_Comm,PetscInt,PetscInt,PetscInt,const PetscInt[],Mat*);
+PETSC_EXTERN PetscErrorCode MatCreateMPIAIJMixed(MPI_Comm,PetscInt,PetscInt,PetscInt,PetscInt,PetscInt,const PetscInt[],PetscInt,const PetscInt[],Mat*);
+#if defined(PETSC_HAVE_OPENMP)
+PETSC_EXTERN PetscErrorCode MatCreateSeqAIJOMP(MPI_Comm,PetscInt,PetscInt,PetscInt,const PetscInt[],Mat*);
+PETSC_EXTERN PetscErrorCode MatCreateMPIAIJOMP(MPI_Comm,PetscInt,PetscInt,PetscInt,PetscInt,PetscInt,const PetscInt[],PetscInt,const PetscInt[],Mat*);
+#endif
 
 PETSC_EXTERN PetscErrorCode MatCreateScatter(MPI_Comm,VecScatter,Mat*);
 PETSC_EXTERN PetscErrorCode MatScatterSetVecScatter(Mat,VecScatter);
@@ -519,6 +544,7 @@ PETSC_EXTERN PetscErrorCode MatGetGhosts(Mat, PetscInt *,const PetscInt *[]);
 PETSC_EXTERN PetscErrorCode MatIncreaseOverlap(Mat,PetscInt,IS[],PetscInt);
 PETSC_EXTERN PetscErrorCode MatIncreaseOverlapSplit(Mat mat,PetscInt n,IS is[],PetscInt ov);
 PETSC_EXTERN PetscErrorCode MatMPIAIJSetUseScalableIncreaseOverlap(Mat,PetscBool);
+PETSC_EXTERN PetscErrorCode MatMPIAIJSetFrozenPattern(Mat,PetscBool);
 
 PETSC_EXTERN PetscErrorCode MatMatMult(Mat,Mat,MatReuse,PetscReal,Mat*);
 PETSC_EXTERN PetscErrorCode MatMatMultSymbolic(Mat,Mat,PetscReal,Mat*);
@@ -1032,6 +1058,7 @@ PETSC_EXTERN PetscErrorCode MatOrderingRegister(const char[],PetscErrorCode(*)(M
 PETSC_EXTERN PetscFunctionList MatOrderingList;
 
 PETSC_EXTERN PetscErrorCode MatReorderForNonzeroDiagonal(Mat,PetscReal,IS,IS);
+PETSC_EXTERN PetscErrorCode MatMPIAIJSetLocalityReordering(Mat,MatOrderingType);
 PETSC_EXTERN PetscErrorCode MatCreateLaplacian(Mat,PetscReal,PetscBool,Mat*);
 
 /*S
@@ -1222,6 +1249,7 @@ PETSC_EXTERN PetscErrorCode MatFDColoringDestroy(MatFDColoring*);
 PETSC_EXTERN PetscErrorCode MatFDColoringView(MatFDColoring,PetscViewer);
 PETSC_EXTERN PetscErrorCode MatFDColoringSetFunction(MatFDColoring,PetscErrorCode (*)(void),void*);
 PETSC_EXTERN PetscErrorCode MatFDColoringGetFunction(MatFDColoring,PetscErrorCode (**)(void),void**);
+PETSC_EXTERN PetscErrorCode MatFDColoringSetFunctionBatch(MatFDColoring,PetscErrorCode (*)(void*,PetscInt,Vec[],Vec[],void*),void*);
 PETSC_EXTERN PetscErrorCode MatFDColoringSetParameters(MatFDColoring,PetscReal,PetscReal);
 PETSC_EXTERN PetscErrorCode MatFDColoringSetFromOptions(MatFDColoring);
 PETSC_EXTERN PetscErrorCode MatFDColoringApply(Mat,MatFDColoring,Vec,void *);
@@ -1564,6 +1592,11 @@ PETSC_EXTERN PetscErrorCode MatCreateMAIJ(Mat,PetscInt,Mat*);
 PETSC_EXTERN PetscErrorCode MatMAIJRedimension(Mat,PetscInt,Mat*);
 PETSC_EXTERN PetscErrorCode MatMAIJGetAIJ(Mat,Mat*);
 
+PETSC_EXTERN PetscErrorCode MatCreateKAIJ(Mat,PetscInt,const PetscScalar[],const PetscScalar[],Mat*);
+PETSC_EXTERN PetscErrorCode MatKAIJGetAIJ(Mat,Mat*);
+PETSC_EXTERN PetscErrorCode MatKAIJGetS(Mat,PetscInt*,const PetscScalar**);
+PETSC_EXTERN PetscErrorCode MatKAIJGetT(Mat,PetscInt*,const PetscScalar**);
+
 PETSC_EXTERN PetscErrorCode MatComputeExplicitOperator(Mat,Mat*);
 
 PETSC_EXTERN PetscErrorCode MatDiagonalScaleLocal(Mat,Vec);
@@ -2245,9 +2245,13 @@ M*/
 #if !defined(PETSC_WORDS_BIGENDIAN)
 PETSC_EXTERN PetscErrorCode MPIU_File_write_all(MPI_File,void*,PetscMPIInt,MPI_Datatype,MPI_Status*);
 PETSC_EXTERN PetscErrorCode MPIU_File_read_all(MPI_File,void*,PetscMPIInt,MPI_Datatype,MPI_Status*);
+PETSC_EXTERN PetscErrorCode MPIU_File_write_at_all(MPI_File,MPI_Offset,void*,PetscMPIInt,MPI_Datatype,MPI_Status*);
+PETSC_EXTERN PetscErrorCode MPIU_File_read_at_all(MPI_File,MPI_Offset,void*,PetscMPIInt,MPI_Datatype,MPI_Status*);
 #else
 #define MPIU_File_write_all(a,b,c,d,e) MPI_File_write_all(a,b,c,d,e)
 #define MPIU_File_read_all(a,b,c,d,e) MPI_File_read_all(a,b,c,d,e)
+#define MPIU_File_write_at_all(a,b,c,d,e,f) MPI_File_write_at_all(a,b,c,d,e,f)
+#define MPIU_File_read_at_all(a,b,c,d,e,f) MPI_File_read_at_all(a,b,c,d,e,f)
 #endif
 #endif
 
@@ -26,6 +26,8 @@ PETSC_STATIC_INLINE PetscErrorCode PetscHDF5IntCast(PetscInt a,hsize_t *b)
 }
 PETSC_EXTERN PetscErrorCode PetscDataTypeToHDF5DataType(PetscDataType,hid_t*);
 PETSC_EXTERN PetscErrorCode PetscHDF5DataTypeToPetscDataType(hid_t,PetscDataType*);
+PETSC_EXTERN PetscErrorCode PetscViewerHDF5CreateDatasetPList(PetscViewer,int,int,PetscInt,hsize_t[],hid_t*);
+PETSC_EXTERN PetscErrorCode PetscViewerHDF5CreateTransferPList(PetscViewer,hid_t*);
 
 #define PetscStackCallHDF5(func,args) do {                        \
     herr_t _status;                                               \
@@ -57,4 +59,9 @@ PETSC_EXTERN PetscErrorCode PetscViewerHDF5GetBaseDimension2(PetscViewer,PetscBo
 PETSC_EXTERN PetscErrorCode PetscViewerHDF5SetSPOutput(PetscViewer,PetscBool);
 PETSC_EXTERN PetscErrorCode PetscViewerHDF5GetSPOutput(PetscViewer,PetscBool*);
 
+PETSC_EXTERN PetscErrorCode PetscViewerHDF5SetChunkSize(PetscViewer,PetscInt);
+PETSC_EXTERN PetscErrorCode PetscViewerHDF5SetCompress(PetscViewer,PetscInt,PetscBool);
+PETSC_EXTERN PetscErrorCode PetscViewerHDF5SetAlignment(PetscViewer,PetscInt,PetscInt);
+PETSC_EXTERN PetscErrorCode PetscViewerHDF5SetCollective(PetscViewer,PetscBool);
+
 #endif
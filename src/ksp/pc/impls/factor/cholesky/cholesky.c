@@ -95,6 +95,7 @@ static PetscErrorCode PCSetUp_Cholesky(PC pc)
       if (dir->row) {ierr = PetscLogObjectParent((PetscObject)pc,(PetscObject)dir->row);CHKERRQ(ierr);}
       if (!((PC_Factor*)dir)->fact) {
         ierr = MatGetFactor(pc->pmat,((PC_Factor*)dir)->solvertype,MAT_FACTOR_CHOLESKY,&((PC_Factor*)dir)->fact);CHKERRQ(ierr);
+        ierr = MatSetOptionsPrefix(((PC_Factor*)dir)->fact,((PetscObject)pc)->prefix);CHKERRQ(ierr);
       }
       ierr                = MatCholeskyFactorSymbolic(((PC_Factor*)dir)->fact,pc->pmat,dir->row,&((PC_Factor*)dir)->info);CHKERRQ(ierr);
       ierr                = MatGetInfo(((PC_Factor*)dir)->fact,MAT_LOCAL,&info);CHKERRQ(ierr);
@@ -117,6 +118,7 @@ static PetscErrorCode PCSetUp_Cholesky(PC pc)
       }
       ierr                = MatDestroy(&((PC_Factor*)dir)->fact);CHKERRQ(ierr);
       ierr                = MatGetFactor(pc->pmat,((PC_Factor*)dir)->solvertype,MAT_FACTOR_CHOLESKY,&((PC_Factor*)dir)->fact);CHKERRQ(ierr);
+      ierr                = MatSetOptionsPrefix(((PC_Factor*)dir)->fact,((PetscObject)pc)->prefix);CHKERRQ(ierr);
       ierr                = MatCholeskyFactorSymbolic(((PC_Factor*)dir)->fact,pc->pmat,dir->row,&((PC_Factor*)dir)->info);CHKERRQ(ierr);
       ierr                = MatGetInfo(((PC_Factor*)dir)->fact,MAT_LOCAL,&info);CHKERRQ(ierr);
       dir->hdr.actualfill = info.fill_ratio_needed;
@@ -13,6 +13,7 @@ PetscErrorCode PCFactorSetUpMatSolverPackage_Factor(PC pc)
   if (!pc->pmat) SETERRQ(PetscObjectComm((PetscObject)pc),PETSC_ERR_ARG_WRONGSTATE,"You can only call this routine after the matrix object has been provided to the solver, for example with KSPSetOperators() or SNESSetJacobian()");
   if (!pc->setupcalled && !((PC_Factor*)icc)->fact) {
     ierr = MatGetFactor(pc->pmat,((PC_Factor*)icc)->solvertype,((PC_Factor*)icc)->factortype,&((PC_Factor*)icc)->fact);CHKERRQ(ierr);
+    ierr = MatSetOptionsPrefix(((PC_Factor*)icc)->fact,((PetscObject)pc)->prefix);CHKERRQ(ierr);
   }
   PetscFunctionReturn(0);
 }
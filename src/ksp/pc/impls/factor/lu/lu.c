@@ -91,6 +91,7 @@ static PetscErrorCode PCSetUp_LU(PC pc)
       }
       if (!((PC_Factor*)dir)->fact) {
         ierr = MatGetFactor(pc->pmat,((PC_Factor*)dir)->solvertype,MAT_FACTOR_LU,&((PC_Factor*)dir)->fact);CHKERRQ(ierr);
+        ierr = MatSetOptionsPrefix(((PC_Factor*)dir)->fact,((PetscObject)pc)->prefix);CHKERRQ(ierr);
       }
       ierr                = MatLUFactorSymbolic(((PC_Factor*)dir)->fact,pc->pmat,dir->row,dir->col,&((PC_Factor*)dir)->info);CHKERRQ(ierr);
       ierr                = MatGetInfo(((PC_Factor*)dir)->fact,MAT_LOCAL,&info);CHKERRQ(ierr);
@@ -111,6 +112,7 @@ static PetscErrorCode PCSetUp_LU(PC pc)
       }
       ierr                = MatDestroy(&((PC_Factor*)dir)->fact);CHKERRQ(ierr);
       ierr                = MatGetFactor(pc->pmat,((PC_Factor*)dir)->solvertype,MAT_FACTOR_LU,&((PC_Factor*)dir)->fact);CHKERRQ(ierr);
+      ierr                = MatSetOptionsPrefix(((PC_Factor*)dir)->fact,((PetscObject)pc)->prefix);CHKERRQ(ierr);
       ierr                = MatLUFactorSymbolic(((PC_Factor*)dir)->fact,pc->pmat,dir->row,dir->col,&((PC_Factor*)dir)->info);CHKERRQ(ierr);
       ierr                = MatGetInfo(((PC_Factor*)dir)->fact,MAT_LOCAL,&info);CHKERRQ(ierr);
       dir->hdr.actualfill = info.fill_ratio_needed;
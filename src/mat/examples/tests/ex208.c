@@ -0,0 +1,119 @@
+
+static char help[] = "Tests MatSetValues() into an unpreallocated MATSEQAIJ matrix with MAT_USE_HASH_TABLE.\n\n";
+
+#include <petscmat.h>
+
+/* 2d five point Laplacian, inserted element by element in an order that defeats any row-wise preallocation */
+static PetscErrorCode FillMatrix(Mat A,PetscInt n)
+{
+  PetscInt       e,i,j,r,c,idx[2];
+  PetscScalar    v[4] = {1.0,-1.0,-1.0,1.0};
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  for (e=n*n-1; e>=0; e--) {
+    i = e/n; j = e%n;
+    idx[0] = e;
+    for (r=0; r<2; r++) {
+      c = r ? (i<n-1 ? e+n : -1) : (j<n-1 ? e+1 : -1);
+      if (c < 0) continue;
+      idx[1] = c;
+      ierr = MatSetValues(A,2,idx,2,idx,v,ADD_VALUES);CHKERRQ(ierr);
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+/* explicit zeros and MAT_NEW_NONZERO_LOCATIONS must be handled the same way with and without the hash table */
+static PetscErrorCode TestOptions(PetscBool usehash)
+{
+  Mat            C;
+  PetscInt       rows[2] = {0,1},row,col = 3;
+  PetscScalar    zero = 0.0,one[2] = {1.0,1.0};
+  MatInfo        info;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreateSeqAIJ(PETSC_COMM_SELF,4,4,2,NULL,&C);CHKERRQ(ierr);
+  ierr = MatSetOption(C,MAT_USE_HASH_TABLE,usehash);CHKERRQ(ierr);
+  ierr = MatSetOption(C,MAT_IGNORE_ZERO_ENTRIES,PETSC_TRUE);CHKERRQ(ierr);
+  ierr = MatSetValues(C,2,rows,1,&col,one,INSERT_VALUES);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(C,MAT_FLUSH_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(C,MAT_FLUSH_ASSEMBLY);CHKERRQ(ierr);
+  /* an explicit zero overwrites an existing entry but does not create a new one */
+  row  = 0;
+  ierr = MatSetValues(C,1,&row,1,&col,&zero,INSERT_VALUES);CHKERRQ(ierr);
+  row  = 2;
+  ierr = MatSetValues(C,1,&row,1,&col,&zero,INSERT_VALUES);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(C,MAT_FLUSH_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(C,MAT_FLUSH_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatSetOption(C,MAT_NEW_NONZERO_LOCATIONS,PETSC_FALSE);CHKERRQ(ierr);
+  row  = 3;
+  ierr = MatSetValues(C,1,&row,1,&rows[0],one,ADD_VALUES);CHKERRQ(ierr);
+  row  = 1;
+  ierr = MatSetValues(C,1,&row,1,&col,one,ADD_VALUES);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatGetInfo(C,MAT_LOCAL,&info);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_SELF,"Hash table %d, nonzeros %D\n",(int)usehash,(PetscInt)info.nz_used);CHKERRQ(ierr);
+  ierr = MatView(C,PETSC_VIEWER_STDOUT_SELF);CHKERRQ(ierr);
+  ierr = MatDestroy(&C);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **args)
+{
+  Mat            A,B;
+  PetscInt       n = 10,row = 0,col = 0;
+  PetscScalar    one = 1.0;
+  PetscBool      equal;
+  MatInfo        info;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+
+  /* reference matrix, exactly preallocated */
+  ierr = MatCreateSeqAIJ(PETSC_COMM_SELF,n*n,n*n,5,NULL,&B);CHKERRQ(ierr);
+  ierr = FillMatrix(B,n);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  /* no preallocation, the first entry goes into the CSR arrays and must be carried over to the hash table */
+  ierr = MatCreateSeqAIJ(PETSC_COMM_SELF,n*n,n*n,1,NULL,&A);CHKERRQ(ierr);
+  ierr = MatSetOption(A,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatSetValues(A,1,&row,1,&col,&one,ADD_VALUES);CHKERRQ(ierr);
+  ierr = MatSetOption(A,MAT_USE_HASH_TABLE,PETSC_TRUE);CHKERRQ(ierr);
+  ierr = FillMatrix(A,n);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(A,MAT_FLUSH_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FLUSH_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatSetValues(A,1,&row,1,&col,&one,ADD_VALUES);CHKERRQ(ierr);
+  one  = -2.0;
+  ierr = MatSetValues(A,1,&row,1,&col,&one,ADD_VALUES);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  ierr = MatEqual(A,B,&equal);CHKERRQ(ierr);
+  ierr = MatGetInfo(A,MAT_LOCAL,&info);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_SELF,"Matrices equal %d, nonzeros %D, mallocs %D, unneeded %D\n",(int)equal,(PetscInt)info.nz_used,(PetscInt)info.mallocs,(PetscInt)info.nz_unneeded);CHKERRQ(ierr);
+
+  /* the nonzero pattern is frozen after the first assembly, values are inserted into the CSR arrays again */
+  ierr = MatZeroEntries(A);CHKERRQ(ierr);
+  ierr = MatZeroEntries(B);CHKERRQ(ierr);
+  ierr = FillMatrix(A,n);CHKERRQ(ierr);
+  ierr = FillMatrix(B,n);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatEqual(A,B,&equal);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_SELF,"Matrices equal after reassembly %d\n",(int)equal);CHKERRQ(ierr);
+
+  ierr = TestOptions(PETSC_FALSE);CHKERRQ(ierr);
+  ierr = TestOptions(PETSC_TRUE);CHKERRQ(ierr);
+
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
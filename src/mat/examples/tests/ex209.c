@@ -0,0 +1,144 @@
+
+static char help[] = "Tests loading a sequential vector and MATSEQAIJ matrices with -viewer_binary_mmap.\n\n";
+
+#include <petscmat.h>
+
+/* 2d five point Laplacian, with an optional extra entry that shifts the values of following objects in the file */
+static PetscErrorCode CreateMatrix(PetscInt n,PetscBool corner,Mat *A)
+{
+  PetscInt       e,i,j,N = n*n;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreateSeqAIJ(PETSC_COMM_SELF,N,N,6,NULL,A);CHKERRQ(ierr);
+  for (e=0; e<N; e++) {
+    i = e/n; j = e%n;
+    if (i > 0)   {ierr = MatSetValue(*A,e,e-n,-1.0,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j > 0)   {ierr = MatSetValue(*A,e,e-1,-1.0,INSERT_VALUES);CHKERRQ(ierr);}
+    ierr = MatSetValue(*A,e,e,4.0,INSERT_VALUES);CHKERRQ(ierr);
+    if (j < n-1) {ierr = MatSetValue(*A,e,e+1,-1.0,INSERT_VALUES);CHKERRQ(ierr);}
+    if (i < n-1) {ierr = MatSetValue(*A,e,e+n,-1.0,INSERT_VALUES);CHKERRQ(ierr);}
+  }
+  if (corner) {ierr = MatSetValue(*A,0,N-1,0.5,INSERT_VALUES);CHKERRQ(ierr);}
+  ierr = MatAssemblyBegin(*A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(*A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* when not NULL, aligned[k] tells whether the values of the k-th matrix are aligned in the file, so that they can be mapped */
+static PetscErrorCode Load(const char file[],PetscBool usemmap,Vec *x,Mat A[],PetscBool aligned[])
+{
+  PetscViewer    viewer;
+  MatInfo        info;
+  PetscInt       k,M;
+  int            fd;
+  off_t          off;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscViewerCreate(PETSC_COMM_SELF,&viewer);CHKERRQ(ierr);
+  ierr = PetscViewerSetType(viewer,PETSCVIEWERBINARY);CHKERRQ(ierr);
+  ierr = PetscViewerBinarySetUseMmap(viewer,usemmap);CHKERRQ(ierr);
+  ierr = PetscViewerFileSetMode(viewer,FILE_MODE_READ);CHKERRQ(ierr);
+  ierr = PetscViewerFileSetName(viewer,file);CHKERRQ(ierr);
+  ierr = VecCreate(PETSC_COMM_SELF,x);CHKERRQ(ierr);
+  ierr = VecLoad(*x,viewer);CHKERRQ(ierr);
+  for (k=0; k<2; k++) {
+    ierr = PetscViewerBinaryGetDescriptor(viewer,&fd);CHKERRQ(ierr);
+    ierr = PetscBinarySeek(fd,0,PETSC_BINARY_SEEK_CUR,&off);CHKERRQ(ierr);
+    ierr = MatCreate(PETSC_COMM_SELF,&A[k]);CHKERRQ(ierr);
+    ierr = MatSetType(A[k],MATSEQAIJ);CHKERRQ(ierr);
+    ierr = MatLoad(A[k],viewer);CHKERRQ(ierr);
+    if (aligned) {
+      /* the header, the row lengths and the column indices precede the values */
+      ierr       = MatGetSize(A[k],&M,NULL);CHKERRQ(ierr);
+      ierr       = MatGetInfo(A[k],MAT_LOCAL,&info);CHKERRQ(ierr);
+      off       += (4 + M + (PetscInt)info.nz_used)*sizeof(PetscInt);
+      aligned[k] = (PetscBool)!(off % sizeof(PetscScalar));
+    }
+  }
+  /* the loaded objects must remain valid after the file is closed */
+  ierr = PetscViewerDestroy(&viewer);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **args)
+{
+  Mat            A[2],B[2],C[2];
+  Vec            x,y,z,u,w;
+  PetscViewer    viewer;
+  PetscObject    map;
+  PetscInt       k,n = 10;
+  PetscReal      nrm;
+  PetscBool      equal,aligned[2],canmap = PETSC_FALSE;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+
+  ierr = CreateMatrix(n,PETSC_FALSE,&A[0]);CHKERRQ(ierr);
+  ierr = CreateMatrix(n,PETSC_TRUE,&A[1]);CHKERRQ(ierr);
+  ierr = MatCreateVecs(A[0],&x,NULL);CHKERRQ(ierr);
+  for (k=0; k<n*n; k++) {ierr = VecSetValue(x,k,(PetscScalar)(k+1),INSERT_VALUES);CHKERRQ(ierr);}
+  ierr = VecAssemblyBegin(x);CHKERRQ(ierr);
+  ierr = VecAssemblyEnd(x);CHKERRQ(ierr);
+
+  ierr = PetscViewerBinaryOpen(PETSC_COMM_SELF,"mmap.dat",FILE_MODE_WRITE,&viewer);CHKERRQ(ierr);
+  ierr = VecView(x,viewer);CHKERRQ(ierr);
+  ierr = MatView(A[0],viewer);CHKERRQ(ierr);
+  ierr = MatView(A[1],viewer);CHKERRQ(ierr);
+  ierr = PetscViewerDestroy(&viewer);CHKERRQ(ierr);
+
+  /* binary files are big-endian, so they are mapped only on big-endian machines with mmap() */
+#if defined(PETSC_HAVE_MMAP) && defined(PETSC_HAVE_SYS_MMAN_H) && defined(PETSC_WORDS_BIGENDIAN)
+  canmap = PETSC_TRUE;
+#endif
+  ierr = Load("mmap.dat",PETSC_TRUE,&y,B,aligned);CHKERRQ(ierr);
+  ierr = PetscObjectQuery((PetscObject)y,"VecLoad_Binary_map",&map);CHKERRQ(ierr);
+  ierr = VecEqual(x,y,&equal);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_SELF,"Vector mapped as expected %d, equal %d\n",(int)(!!map == canmap),(int)equal);CHKERRQ(ierr);
+  for (k=0; k<2; k++) {
+    PetscBool jmapped,amapped;
+    /* the second matrix shifts the following data, its values may not be aligned in the file and then only its column indices are mapped */
+    ierr    = PetscObjectQuery((PetscObject)B[k],"MatLoad_SeqAIJ_jmap",&map);CHKERRQ(ierr);
+    jmapped = (PetscBool)!!map;
+    ierr    = PetscObjectQuery((PetscObject)B[k],"MatLoad_SeqAIJ_amap",&map);CHKERRQ(ierr);
+    amapped = (PetscBool)!!map;
+    ierr    = MatEqual(A[k],B[k],&equal);CHKERRQ(ierr);
+    ierr    = PetscPrintf(PETSC_COMM_SELF,"Matrix %D mapped as expected %d, equal %d\n",k,(int)(jmapped == canmap && amapped == (canmap && aligned[k])),(int)equal);CHKERRQ(ierr);
+  }
+
+  /* writing into the loaded objects must not change the file */
+  ierr = VecDuplicate(x,&z);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&w);CHKERRQ(ierr);
+  ierr = VecScale(y,2.0);CHKERRQ(ierr);
+  for (k=0; k<2; k++) {
+    ierr = MatScale(B[k],2.0);CHKERRQ(ierr);
+    ierr = MatMult(B[k],y,z);CHKERRQ(ierr);
+    ierr = MatMult(A[k],x,w);CHKERRQ(ierr);
+    ierr = VecAXPY(z,-4.0,w);CHKERRQ(ierr);
+    ierr = VecNorm(z,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_SELF,"Matrix %D error after scaling %g\n",k,(double)nrm);CHKERRQ(ierr);
+  }
+  ierr = Load("mmap.dat",PETSC_FALSE,&u,C,NULL);CHKERRQ(ierr);
+  ierr = VecEqual(x,u,&equal);CHKERRQ(ierr);
+  for (k=0; k<2; k++) {
+    PetscBool eq;
+    ierr  = MatEqual(A[k],C[k],&eq);CHKERRQ(ierr);
+    equal = (PetscBool)(equal && eq);
+  }
+  ierr = PetscPrintf(PETSC_COMM_SELF,"File unchanged %d\n",(int)equal);CHKERRQ(ierr);
+
+  for (k=0; k<2; k++) {
+    ierr = MatDestroy(&A[k]);CHKERRQ(ierr);
+    ierr = MatDestroy(&B[k]);CHKERRQ(ierr);
+    ierr = MatDestroy(&C[k]);CHKERRQ(ierr);
+  }
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = VecDestroy(&u);CHKERRQ(ierr);
+  ierr = VecDestroy(&w);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
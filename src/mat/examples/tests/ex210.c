@@ -0,0 +1,177 @@
+
+static char help[] = "Tests the products of MATAIJSELL matrices against MATAIJ.\n\n";
+
+#include <petscmat.h>
+
+/* rows of irregular length, so that the slices need padding and the sorting changes the row order */
+static PetscErrorCode FillMatrix(Mat A,PetscBool extra)
+{
+  PetscInt       i,k,rstart,rend,N,col;
+  PetscScalar    v;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetSize(A,&N,NULL);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  for (i=rstart; i<rend; i++) {
+    v    = 10.0;
+    ierr = MatSetValues(A,1,&i,1,&i,&v,ADD_VALUES);CHKERRQ(ierr);
+    for (k=0; k<i%11; k++) {
+      col  = (7*i + 13*k + 1) % N;
+      v    = -1.0 - (PetscReal)((i+k)%5)/4.0;
+      ierr = MatSetValues(A,1,&i,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);
+    }
+    if (extra && !(i%17)) {
+      col  = N-1-i;
+      v    = 0.5;
+      ierr = MatSetValues(A,1,&i,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);
+    }
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode CheckProducts(const char *stage,Mat A,Mat B)
+{
+  Vec            x,y,z,w,u;
+  PetscReal      err[4],nrm;
+  PetscInt       k;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreateVecs(A,&x,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&w);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&u);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,NULL);CHKERRQ(ierr);
+  ierr = VecSetRandom(y,NULL);CHKERRQ(ierr);
+
+  ierr = MatMult(A,x,z);CHKERRQ(ierr);
+  ierr = MatMult(B,x,y);CHKERRQ(ierr);
+  ierr = VecAXPY(y,-1.0,z);CHKERRQ(ierr);
+  ierr = VecNorm(y,NORM_INFINITY,&err[0]);CHKERRQ(ierr);
+
+  ierr = VecSet(y,1.0);CHKERRQ(ierr);
+  ierr = MatMultAdd(A,x,y,z);CHKERRQ(ierr);
+  ierr = MatMultAdd(B,x,y,y);CHKERRQ(ierr);
+  ierr = VecAXPY(y,-1.0,z);CHKERRQ(ierr);
+  ierr = VecNorm(y,NORM_INFINITY,&err[1]);CHKERRQ(ierr);
+
+  ierr = VecSetRandom(y,NULL);CHKERRQ(ierr);
+  ierr = MatMultTranspose(A,y,w);CHKERRQ(ierr);
+  ierr = MatMultTranspose(B,y,u);CHKERRQ(ierr);
+  ierr = VecAXPY(u,-1.0,w);CHKERRQ(ierr);
+  ierr = VecNorm(u,NORM_INFINITY,&err[2]);CHKERRQ(ierr);
+
+  ierr = MatMultTransposeAdd(A,y,x,w);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd(B,y,x,x);CHKERRQ(ierr);
+  ierr = VecAXPY(x,-1.0,w);CHKERRQ(ierr);
+  ierr = VecNorm(x,NORM_INFINITY,&err[3]);CHKERRQ(ierr);
+
+  ierr = VecNorm(w,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  for (k=0; k<4; k++) {
+    if (err[k] > 100.0*PETSC_MACHINE_EPSILON*nrm) {
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: product %D differs by %g\n",stage,k,(double)err[k]);CHKERRQ(ierr);
+    }
+  }
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: products checked\n",stage);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = VecDestroy(&w);CHKERRQ(ierr);
+  ierr = VecDestroy(&u);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode ScaleArray(Mat A)
+{
+  Mat            Ad;
+  MatInfo        info;
+  PetscScalar    *a;
+  PetscInt       k;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetDiagonalBlock(A,&Ad);CHKERRQ(ierr);
+  ierr = MatGetInfo(Ad,MAT_LOCAL,&info);CHKERRQ(ierr);
+  ierr = MatSeqAIJGetArray(Ad,&a);CHKERRQ(ierr);
+  for (k=0; k<(PetscInt)info.nz_used; k++) a[k] *= 3.0;
+  ierr = MatSeqAIJRestoreArray(Ad,&a);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **args)
+{
+  Mat            A,B,C,D;
+  MatType        type;
+  PetscInt       n = 203;
+  PetscBool      flg;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,n,n);CHKERRQ(ierr);
+  ierr = MatSetType(A,MATAIJ);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(A,13,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(A,13,NULL,13,NULL);CHKERRQ(ierr);
+  ierr = FillMatrix(A,PETSC_FALSE);CHKERRQ(ierr);
+
+  /* conversion of an assembled matrix */
+  ierr = MatConvert(A,MATAIJSELL,MAT_INITIAL_MATRIX,&B);CHKERRQ(ierr);
+  ierr = CheckProducts("Converted",A,B);CHKERRQ(ierr);
+
+  /* assembly directly into the new format */
+  ierr = MatCreate(PETSC_COMM_WORLD,&C);CHKERRQ(ierr);
+  ierr = MatSetSizes(C,PETSC_DECIDE,PETSC_DECIDE,n,n);CHKERRQ(ierr);
+  ierr = MatSetType(C,MATAIJSELL);CHKERRQ(ierr);
+  ierr = MatSetFromOptions(C);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(C,13,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(C,13,NULL,13,NULL);CHKERRQ(ierr);
+  ierr = FillMatrix(C,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatGetType(C,&type);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Type %s\n",type);CHKERRQ(ierr);
+  ierr = CheckProducts("Assembled",A,C);CHKERRQ(ierr);
+
+  /* changed values must be picked up without a new assembly */
+  ierr = MatScale(A,2.0);CHKERRQ(ierr);
+  ierr = MatScale(C,2.0);CHKERRQ(ierr);
+  ierr = MatShift(A,1.0);CHKERRQ(ierr);
+  ierr = MatShift(C,1.0);CHKERRQ(ierr);
+  ierr = CheckProducts("Scaled",A,C);CHKERRQ(ierr);
+
+  /* values changed through the array of the local diagonal block */
+  ierr = ScaleArray(A);CHKERRQ(ierr);
+  ierr = ScaleArray(C);CHKERRQ(ierr);
+  ierr = CheckProducts("Array",A,C);CHKERRQ(ierr);
+
+  /* a new assembly with the same nonzero pattern only refreshes the values of the sliced copy */
+  ierr = MatZeroEntries(A);CHKERRQ(ierr);
+  ierr = MatZeroEntries(C);CHKERRQ(ierr);
+  ierr = FillMatrix(A,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = FillMatrix(C,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = CheckProducts("Reassembled",A,C);CHKERRQ(ierr);
+
+  /* new nonzeros change the sliced structure */
+  ierr = MatSetOption(A,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatSetOption(C,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatZeroEntries(A);CHKERRQ(ierr);
+  ierr = MatZeroEntries(C);CHKERRQ(ierr);
+  ierr = FillMatrix(A,PETSC_TRUE);CHKERRQ(ierr);
+  ierr = FillMatrix(C,PETSC_TRUE);CHKERRQ(ierr);
+  ierr = CheckProducts("Refilled",A,C);CHKERRQ(ierr);
+
+  ierr = MatDuplicate(C,MAT_COPY_VALUES,&D);CHKERRQ(ierr);
+  ierr = CheckProducts("Duplicated",A,D);CHKERRQ(ierr);
+  ierr = MatEqual(A,D,&flg);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Duplicate equal %d\n",(int)flg);CHKERRQ(ierr);
+
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+  ierr = MatDestroy(&C);CHKERRQ(ierr);
+  ierr = MatDestroy(&D);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
@@ -0,0 +1,107 @@
+
+static char help[] = "Tests MatMult() and MatMultAdd() of SeqAIJ matrices, with and without inodes and compressed rows, against a product computed with MatGetRow().\n\n";
+
+#include <petscmat.h>
+
+/* z = y + A x computed one row at a time */
+static PetscErrorCode RowProduct(Mat A,Vec x,Vec y,Vec z)
+{
+  PetscInt          i,j,m,ncols;
+  const PetscInt    *cols;
+  const PetscScalar *vals,*xa,*ya;
+  PetscScalar       *za,sum;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetSize(A,&m,NULL);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(x,&xa);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(y,&ya);CHKERRQ(ierr);
+  ierr = VecGetArray(z,&za);CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    ierr = MatGetRow(A,i,&ncols,&cols,&vals);CHKERRQ(ierr);
+    sum  = ya[i];
+    for (j=0; j<ncols; j++) sum += vals[j]*xa[cols[j]];
+    za[i] = sum;
+    ierr = MatRestoreRow(A,i,&ncols,&cols,&vals);CHKERRQ(ierr);
+  }
+  ierr = VecRestoreArrayRead(x,&xa);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(y,&ya);CHKERRQ(ierr);
+  ierr = VecRestoreArray(z,&za);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **args)
+{
+  Mat            A;
+  Vec            x,y,z,w,zero;
+  PetscInt       n = 157,i,k,col,rows[3];
+  PetscScalar    v;
+  PetscReal      err[3],nrm;
+  PetscBool      empty = PETSC_FALSE;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-empty_rows",&empty,NULL);CHKERRQ(ierr);
+
+  ierr = MatCreate(PETSC_COMM_SELF,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,n,n,n,n);CHKERRQ(ierr);
+  ierr = MatSetType(A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(A,3*23,NULL);CHKERRQ(ierr);
+  /* groups of three rows with the same columns give inodes; the row lengths cover all the remainders of the unrolled loops */
+  for (i=0; i<n; i+=3) {
+    if (empty && (i/3)%4) continue; /* mostly empty rows, so the compressed row format is used */
+    for (k=0; k<3; k++) rows[k] = PetscMin(i+k,n-1);
+    for (k=0; k<(i/3)%23; k++) {
+      col  = (5*i + 11*k) % n;
+      v    = 1.0 + (PetscReal)k/8.0;
+      ierr = MatSetValues(A,1,&rows[0],1,&col,&v,ADD_VALUES);CHKERRQ(ierr);
+      if (rows[1] != rows[0]) {ierr = MatSetValues(A,1,&rows[1],1,&col,&v,ADD_VALUES);CHKERRQ(ierr);}
+      if (rows[2] != rows[1]) {ierr = MatSetValues(A,1,&rows[2],1,&col,&v,ADD_VALUES);CHKERRQ(ierr);}
+    }
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  ierr = MatCreateVecs(A,&x,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&w);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&zero);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,NULL);CHKERRQ(ierr);
+  ierr = VecSetRandom(y,NULL);CHKERRQ(ierr);
+  ierr = VecSet(zero,0.0);CHKERRQ(ierr);
+
+  ierr = RowProduct(A,x,zero,w);CHKERRQ(ierr);
+  ierr = VecSet(z,1.0);CHKERRQ(ierr);
+  ierr = MatMult(A,x,z);CHKERRQ(ierr);
+  ierr = VecAXPY(z,-1.0,w);CHKERRQ(ierr);
+  ierr = VecNorm(z,NORM_INFINITY,&err[0]);CHKERRQ(ierr);
+  ierr = VecNorm(w,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+
+  ierr = RowProduct(A,x,y,w);CHKERRQ(ierr);
+  ierr = MatMultAdd(A,x,y,z);CHKERRQ(ierr);
+  ierr = VecAXPY(z,-1.0,w);CHKERRQ(ierr);
+  ierr = VecNorm(z,NORM_INFINITY,&err[1]);CHKERRQ(ierr);
+
+  /* in place */
+  ierr = MatMultAdd(A,x,y,y);CHKERRQ(ierr);
+  ierr = VecAXPY(y,-1.0,w);CHKERRQ(ierr);
+  ierr = VecNorm(y,NORM_INFINITY,&err[2]);CHKERRQ(ierr);
+
+  for (k=0; k<3; k++) {
+    if (err[k] > 100.0*PETSC_MACHINE_EPSILON*nrm) {
+      ierr = PetscPrintf(PETSC_COMM_SELF,"Product %D differs by %g\n",k,(double)err[k]);CHKERRQ(ierr);
+    }
+  }
+  ierr = PetscPrintf(PETSC_COMM_SELF,"Products checked\n");CHKERRQ(ierr);
+
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = VecDestroy(&w);CHKERRQ(ierr);
+  ierr = VecDestroy(&zero);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
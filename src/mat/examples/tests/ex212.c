@@ -0,0 +1,149 @@
+
+static char help[] = "Tests the threaded products and SOR of MATAIJOMP matrices against MATAIJ.\n\n";
+
+#include <petscmat.h>
+
+/* diagonally dominant 2d five point stencil with a few symmetric long range couplings, so that the rows have different lengths */
+static PetscErrorCode FillMatrix(Mat A,PetscInt n)
+{
+  PetscInt       i,j,row,col,rstart,rend;
+  PetscScalar    v;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  for (row=rstart; row<rend; row++) {
+    i = row/n; j = row%n;
+    v = 5.0;
+    ierr = MatSetValues(A,1,&row,1,&row,&v,ADD_VALUES);CHKERRQ(ierr);
+    v = -1.0;
+    if (i>0)   {col = row-n; ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);}
+    if (i<n-1) {col = row+n; ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);}
+    if (j>0)   {col = row-1; ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);}
+    if (j<n-1) {col = row+1; ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);}
+    col = n*n-1-row;
+    if (!(row%7) && col != row) {
+      v    = -0.25;
+      ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);
+      ierr = MatSetValues(A,1,&col,1,&row,&v,ADD_VALUES);CHKERRQ(ierr);
+    }
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode CheckProducts(Mat A,Mat B)
+{
+  Vec            x,y,z,w,u;
+  PetscReal      err[4],nrm;
+  PetscInt       k;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreateVecs(A,&x,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&w);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&u);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,NULL);CHKERRQ(ierr);
+
+  ierr = MatMult(A,x,z);CHKERRQ(ierr);
+  ierr = MatMult(B,x,y);CHKERRQ(ierr);
+  ierr = VecAXPY(y,-1.0,z);CHKERRQ(ierr);
+  ierr = VecNorm(y,NORM_INFINITY,&err[0]);CHKERRQ(ierr);
+
+  ierr = VecSet(y,1.0);CHKERRQ(ierr);
+  ierr = MatMultAdd(A,x,y,z);CHKERRQ(ierr);
+  ierr = MatMultAdd(B,x,y,y);CHKERRQ(ierr);
+  ierr = VecAXPY(y,-1.0,z);CHKERRQ(ierr);
+  ierr = VecNorm(y,NORM_INFINITY,&err[1]);CHKERRQ(ierr);
+
+  ierr = VecSetRandom(y,NULL);CHKERRQ(ierr);
+  ierr = MatMultTranspose(A,y,w);CHKERRQ(ierr);
+  ierr = MatMultTranspose(B,y,u);CHKERRQ(ierr);
+  ierr = VecAXPY(u,-1.0,w);CHKERRQ(ierr);
+  ierr = VecNorm(u,NORM_INFINITY,&err[2]);CHKERRQ(ierr);
+
+  ierr = MatMultTransposeAdd(A,y,x,w);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd(B,y,x,x);CHKERRQ(ierr);
+  ierr = VecAXPY(x,-1.0,w);CHKERRQ(ierr);
+  ierr = VecNorm(x,NORM_INFINITY,&err[3]);CHKERRQ(ierr);
+
+  ierr = VecNorm(w,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  for (k=0; k<4; k++) {
+    if (err[k] > 100.0*PETSC_MACHINE_EPSILON*nrm) {
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"Product %D differs by %g\n",k,(double)err[k]);CHKERRQ(ierr);
+    }
+  }
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Products checked\n");CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = VecDestroy(&w);CHKERRQ(ierr);
+  ierr = VecDestroy(&u);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* the multicolor sweeps must reduce the residual as Gauss-Seidel does, by the same amount for any number of threads */
+static PetscErrorCode CheckSOR(Mat B,MatSORType type,PetscReal omega,const char *name)
+{
+  Vec            b,x,r;
+  PetscReal      rnorm[2];
+  PetscInt       k;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreateVecs(B,&x,&b);CHKERRQ(ierr);
+  ierr = VecDuplicate(b,&r);CHKERRQ(ierr);
+  ierr = VecSet(b,1.0);CHKERRQ(ierr);
+  ierr = VecNorm(b,NORM_2,&rnorm[0]);CHKERRQ(ierr);
+  ierr = MatSOR(B,b,omega,(MatSORType)(type | SOR_ZERO_INITIAL_GUESS),0.0,1,1,x);CHKERRQ(ierr);
+  for (k=1; k<20; k++) {
+    ierr = MatSOR(B,b,omega,type,0.0,1,1,x);CHKERRQ(ierr);
+  }
+  ierr = MatMult(B,x,r);CHKERRQ(ierr);
+  ierr = VecAYPX(r,-1.0,b);CHKERRQ(ierr);
+  ierr = VecNorm(r,NORM_2,&rnorm[1]);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: relative residual %.2e\n",name,(double)(rnorm[1]/rnorm[0]));CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&r);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **args)
+{
+  Mat            A,B;
+  MatType        type;
+  PetscInt       n = 23;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,n*n,n*n);CHKERRQ(ierr);
+  ierr = MatSetType(A,MATAIJ);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(A,6,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(A,6,NULL,3,NULL);CHKERRQ(ierr);
+  ierr = FillMatrix(A,n);CHKERRQ(ierr);
+
+  ierr = MatCreate(PETSC_COMM_WORLD,&B);CHKERRQ(ierr);
+  ierr = MatSetSizes(B,PETSC_DECIDE,PETSC_DECIDE,n*n,n*n);CHKERRQ(ierr);
+  ierr = MatSetType(B,MATAIJOMP);CHKERRQ(ierr);
+  ierr = MatSetFromOptions(B);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(B,6,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(B,6,NULL,3,NULL);CHKERRQ(ierr);
+  ierr = FillMatrix(B,n);CHKERRQ(ierr);
+  ierr = MatGetType(B,&type);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Type %s\n",type);CHKERRQ(ierr);
+
+  ierr = CheckProducts(A,B);CHKERRQ(ierr);
+  ierr = CheckSOR(B,SOR_LOCAL_SYMMETRIC_SWEEP,1.0,"Symmetric Gauss-Seidel");CHKERRQ(ierr);
+  ierr = CheckSOR(B,SOR_LOCAL_FORWARD_SWEEP,1.3,"Forward SOR");CHKERRQ(ierr);
+
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
@@ -0,0 +1,139 @@
+
+static char help[] = "Tests the products of MATAIJDELTA matrices, whose column indices are stored as 16 bit differences, against MATAIJ.\n\
+The couplings to the mirrored row do not fit into 16 bits for n > 181.\n\n";
+
+#include <petscmat.h>
+
+/* 2d five point stencil with a few symmetric couplings to the mirrored row, which are far from the diagonal for large n */
+static PetscErrorCode FillMatrix(Mat A,PetscInt n)
+{
+  PetscInt       i,j,row,col,rstart,rend;
+  PetscScalar    v;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  for (row=rstart; row<rend; row++) {
+    i = row/n; j = row%n;
+    v = 5.0;
+    ierr = MatSetValues(A,1,&row,1,&row,&v,ADD_VALUES);CHKERRQ(ierr);
+    v = -1.0;
+    if (i>0)   {col = row-n; ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);}
+    if (i<n-1) {col = row+n; ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);}
+    if (j>0)   {col = row-1; ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);}
+    if (j<n-1) {col = row+1; ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);}
+    col = n*n-1-row;
+    if (!(row%7) && col != row) {
+      v    = -0.25;
+      ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);
+      ierr = MatSetValues(A,1,&col,1,&row,&v,ADD_VALUES);CHKERRQ(ierr);
+    }
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode CheckProducts(Mat A,Mat B)
+{
+  Vec            x,y,z,w,u;
+  PetscReal      err[4],nrm;
+  PetscInt       k;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreateVecs(A,&x,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&w);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&u);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,NULL);CHKERRQ(ierr);
+
+  ierr = MatMult(A,x,z);CHKERRQ(ierr);
+  ierr = MatMult(B,x,y);CHKERRQ(ierr);
+  ierr = VecAXPY(y,-1.0,z);CHKERRQ(ierr);
+  ierr = VecNorm(y,NORM_INFINITY,&err[0]);CHKERRQ(ierr);
+
+  ierr = VecSet(y,1.0);CHKERRQ(ierr);
+  ierr = MatMultAdd(A,x,y,z);CHKERRQ(ierr);
+  ierr = MatMultAdd(B,x,y,y);CHKERRQ(ierr);
+  ierr = VecAXPY(y,-1.0,z);CHKERRQ(ierr);
+  ierr = VecNorm(y,NORM_INFINITY,&err[1]);CHKERRQ(ierr);
+
+  ierr = VecSetRandom(y,NULL);CHKERRQ(ierr);
+  ierr = MatMultTranspose(A,y,w);CHKERRQ(ierr);
+  ierr = MatMultTranspose(B,y,u);CHKERRQ(ierr);
+  ierr = VecAXPY(u,-1.0,w);CHKERRQ(ierr);
+  ierr = VecNorm(u,NORM_INFINITY,&err[2]);CHKERRQ(ierr);
+
+  ierr = MatMultTransposeAdd(A,y,x,w);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd(B,y,x,x);CHKERRQ(ierr);
+  ierr = VecAXPY(x,-1.0,w);CHKERRQ(ierr);
+  ierr = VecNorm(x,NORM_INFINITY,&err[3]);CHKERRQ(ierr);
+
+  ierr = VecNorm(w,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  for (k=0; k<4; k++) {
+    if (err[k] > 100.0*PETSC_MACHINE_EPSILON*nrm) {
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"Product %D differs by %g\n",k,(double)err[k]);CHKERRQ(ierr);
+    }
+  }
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Products checked\n");CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = VecDestroy(&w);CHKERRQ(ierr);
+  ierr = VecDestroy(&u);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **args)
+{
+  Mat            A,B,C;
+  MatType        type;
+  PetscInt       n = 23,row = 1,col;
+  PetscScalar    v = 1.0;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,n*n,n*n);CHKERRQ(ierr);
+  ierr = MatSetType(A,MATAIJ);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(A,7,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(A,7,NULL,4,NULL);CHKERRQ(ierr);
+  ierr = FillMatrix(A,n);CHKERRQ(ierr);
+
+  ierr = MatCreate(PETSC_COMM_WORLD,&B);CHKERRQ(ierr);
+  ierr = MatSetSizes(B,PETSC_DECIDE,PETSC_DECIDE,n*n,n*n);CHKERRQ(ierr);
+  ierr = MatSetType(B,MATAIJDELTA);CHKERRQ(ierr);
+  ierr = MatSetFromOptions(B);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(B,7,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(B,7,NULL,4,NULL);CHKERRQ(ierr);
+  ierr = FillMatrix(B,n);CHKERRQ(ierr);
+  ierr = MatGetType(B,&type);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Type %s\n",type);CHKERRQ(ierr);
+  ierr = CheckProducts(A,B);CHKERRQ(ierr);
+
+  /* a new nonzero far from the diagonal changes the nonzero structure, so the encoding is rebuilt */
+  col  = n*n-1;
+  ierr = MatSetOption(A,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatSetOption(B,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);
+  ierr = MatSetValues(B,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = CheckProducts(A,B);CHKERRQ(ierr);
+
+  ierr = MatConvert(A,MATAIJDELTA,MAT_INITIAL_MATRIX,&C);CHKERRQ(ierr);
+  ierr = MatScale(C,2.0);CHKERRQ(ierr);
+  ierr = MatScale(A,2.0);CHKERRQ(ierr);
+  ierr = CheckProducts(A,C);CHKERRQ(ierr);
+
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+  ierr = MatDestroy(&C);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
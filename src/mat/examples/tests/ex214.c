@@ -0,0 +1,177 @@
+
+static char help[] = "Tests the products, SOR sweeps and triangular solves of MATAIJMIXED matrices against MATAIJ.\n\n";
+
+#include <petscmat.h>
+
+/* diagonally dominant 2d five point stencil with a few symmetric long range couplings; the values are not exact in single precision */
+static PetscErrorCode FillMatrix(Mat A,PetscInt n)
+{
+  PetscInt       i,j,row,col,rstart,rend;
+  PetscScalar    v;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  for (row=rstart; row<rend; row++) {
+    i = row/n; j = row%n;
+    v = 5.0;
+    ierr = MatSetValues(A,1,&row,1,&row,&v,ADD_VALUES);CHKERRQ(ierr);
+    v = -1.1;
+    if (i>0)   {col = row-n; ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);}
+    if (i<n-1) {col = row+n; ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);}
+    if (j>0)   {col = row-1; ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);}
+    if (j<n-1) {col = row+1; ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);}
+    col = n*n-1-row;
+    if (!(row%7) && col != row) {
+      v    = -0.3;
+      ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);
+      ierr = MatSetValues(A,1,&col,1,&row,&v,ADD_VALUES);CHKERRQ(ierr);
+    }
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* the results may differ from the double precision ones by the rounding of the values to single precision */
+static PetscErrorCode Compare(Vec u,Vec w,const char *name)
+{
+  PetscReal      err,nrm;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecNorm(w,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  ierr = VecAXPY(u,-1.0,w);CHKERRQ(ierr);
+  ierr = VecNorm(u,NORM_INFINITY,&err);CHKERRQ(ierr);
+  if (err > 1.e-5*nrm) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"%s differs by %g\n",name,(double)(err/nrm));CHKERRQ(ierr);
+  } else if (err < 1.e-13*nrm) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"%s does not use the single precision values\n",name);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode CheckOperations(Mat A,Mat B)
+{
+  Vec            x,y,z,w,u;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreateVecs(A,&x,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&w);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&u);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,NULL);CHKERRQ(ierr);
+
+  ierr = MatMult(A,x,z);CHKERRQ(ierr);
+  ierr = MatMult(B,x,y);CHKERRQ(ierr);
+  ierr = Compare(y,z,"MatMult");CHKERRQ(ierr);
+
+  ierr = VecSet(y,1.0);CHKERRQ(ierr);
+  ierr = MatMultAdd(A,x,y,z);CHKERRQ(ierr);
+  ierr = MatMultAdd(B,x,y,y);CHKERRQ(ierr);
+  ierr = Compare(y,z,"MatMultAdd");CHKERRQ(ierr);
+
+  ierr = MatSOR(A,x,1.0,(MatSORType)(SOR_LOCAL_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),0.0,2,1,w);CHKERRQ(ierr);
+  ierr = MatSOR(B,x,1.0,(MatSORType)(SOR_LOCAL_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),0.0,2,1,u);CHKERRQ(ierr);
+  ierr = Compare(u,w,"Symmetric Gauss-Seidel");CHKERRQ(ierr);
+
+  ierr = VecSet(w,1.0);CHKERRQ(ierr);
+  ierr = VecSet(u,1.0);CHKERRQ(ierr);
+  ierr = MatSOR(A,x,1.3,SOR_LOCAL_BACKWARD_SWEEP,0.0,1,2,w);CHKERRQ(ierr);
+  ierr = MatSOR(B,x,1.3,SOR_LOCAL_BACKWARD_SWEEP,0.0,1,2,u);CHKERRQ(ierr);
+  ierr = Compare(u,w,"Backward SOR");CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Products and sweeps checked\n");CHKERRQ(ierr);
+
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = VecDestroy(&w);CHKERRQ(ierr);
+  ierr = VecDestroy(&u);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode CheckFactor(Mat A,Mat B,MatFactorType ftype,MatOrderingType otype,const char *name)
+{
+  Mat            FA,FB;
+  IS             isrow,iscol;
+  MatFactorInfo  info;
+  MatType        type;
+  Vec            x,b,u;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatFactorInfoInitialize(&info);CHKERRQ(ierr);
+  info.fill = 2.0;
+  ierr = MatGetOrdering(A,otype,&isrow,&iscol);CHKERRQ(ierr);
+  ierr = MatGetFactor(A,MATSOLVERPETSC,ftype,&FA);CHKERRQ(ierr);
+  ierr = MatGetFactor(B,MATSOLVERPETSC,ftype,&FB);CHKERRQ(ierr);
+  if (ftype == MAT_FACTOR_LU) {
+    ierr = MatLUFactorSymbolic(FA,A,isrow,iscol,&info);CHKERRQ(ierr);
+    ierr = MatLUFactorSymbolic(FB,B,isrow,iscol,&info);CHKERRQ(ierr);
+  } else {
+    info.levels = 1;
+    ierr = MatILUFactorSymbolic(FA,A,isrow,iscol,&info);CHKERRQ(ierr);
+    ierr = MatILUFactorSymbolic(FB,B,isrow,iscol,&info);CHKERRQ(ierr);
+  }
+  ierr = MatLUFactorNumeric(FA,A,&info);CHKERRQ(ierr);
+  ierr = MatLUFactorNumeric(FB,B,&info);CHKERRQ(ierr);
+  ierr = MatGetType(FB,&type);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"%s factor type %s\n",name,type);CHKERRQ(ierr);
+
+  ierr = MatCreateVecs(A,&x,&b);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&u);CHKERRQ(ierr);
+  ierr = VecSetRandom(b,NULL);CHKERRQ(ierr);
+  ierr = MatSolve(FA,b,x);CHKERRQ(ierr);
+  ierr = MatSolve(FB,b,u);CHKERRQ(ierr);
+  ierr = Compare(u,x,name);CHKERRQ(ierr);
+
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = VecDestroy(&u);CHKERRQ(ierr);
+  ierr = ISDestroy(&isrow);CHKERRQ(ierr);
+  ierr = ISDestroy(&iscol);CHKERRQ(ierr);
+  ierr = MatDestroy(&FA);CHKERRQ(ierr);
+  ierr = MatDestroy(&FB);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **args)
+{
+  Mat            A,B;
+  MatType        type;
+  PetscInt       n = 23;
+  PetscMPIInt    size;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,n*n,n*n);CHKERRQ(ierr);
+  ierr = MatSetType(A,MATAIJ);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(A,6,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(A,6,NULL,3,NULL);CHKERRQ(ierr);
+  ierr = FillMatrix(A,n);CHKERRQ(ierr);
+
+  ierr = MatConvert(A,MATAIJMIXED,MAT_INITIAL_MATRIX,&B);CHKERRQ(ierr);
+  ierr = MatGetType(B,&type);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Type %s\n",type);CHKERRQ(ierr);
+  ierr = CheckOperations(A,B);CHKERRQ(ierr);
+
+  /* changed values must reach the single precision copy */
+  ierr = MatScale(A,0.7);CHKERRQ(ierr);
+  ierr = MatScale(B,0.7);CHKERRQ(ierr);
+  ierr = CheckOperations(A,B);CHKERRQ(ierr);
+
+  if (size == 1) {
+    ierr = CheckFactor(A,B,MAT_FACTOR_LU,MATORDERINGND,"LU");CHKERRQ(ierr);
+    ierr = CheckFactor(A,B,MAT_FACTOR_ILU,MATORDERINGNATURAL,"ILU(1)");CHKERRQ(ierr);
+  }
+
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
@@ -0,0 +1,242 @@
+
+static char help[] = "Tests and times the SeqBAIJ kernels of the block sizes 1 to 16.\n\
+  -n <n>   : the block matrix is the five point stencil on an n by n grid\n\
+  -time    : print the time of the products, the SOR sweeps and the factorization\n\
+  -its <k> : number of repetitions for the timing\n\n";
+
+#include <petscmat.h>
+#include <petsctime.h>
+
+/* five point stencil on an n by n grid of dense bs by bs blocks, diagonally dominant */
+static PetscErrorCode FillMatrix(Mat A,PetscInt n,PetscInt bs)
+{
+  PetscInt       i,j,k,l,row,cols[5],ncols;
+  PetscScalar    *v;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscMalloc1(5*bs*bs,&v);CHKERRQ(ierr);
+  for (row=0; row<n*n; row++) {
+    i = row/n; j = row%n; ncols = 0;
+    if (i>0)   cols[ncols++] = row-n;
+    if (j>0)   cols[ncols++] = row-1;
+    cols[ncols++] = row;
+    if (j<n-1) cols[ncols++] = row+1;
+    if (i<n-1) cols[ncols++] = row+n;
+    /* v is row oriented: the block row of the bs rows times the ncols*bs columns */
+    for (k=0; k<bs; k++) {
+      for (l=0; l<ncols*bs; l++) {
+        if (cols[l/bs] == row) v[k*ncols*bs+l] = (k == l%bs) ? 5.0*bs : 1.0/(1.0+k+2.0*(l%bs));
+        else v[k*ncols*bs+l] = -0.5/(1.0+((k+3*(l%bs)+cols[l/bs])%7));
+      }
+    }
+    ierr = MatSetValuesBlocked(A,1,&row,ncols,cols,v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(v);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode CreateMatrix(PetscInt n,PetscInt bs,Mat *A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreateSeqBAIJ(PETSC_COMM_SELF,bs,n*n*bs,n*n*bs,5,NULL,A);CHKERRQ(ierr);
+  ierr = FillMatrix(*A,n,bs);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode Compare(PetscInt bs,Vec u,Vec w,const char *name)
+{
+  PetscReal      err,nrm;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecNorm(w,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  ierr = VecAXPY(u,-1.0,w);CHKERRQ(ierr);
+  ierr = VecNorm(u,NORM_INFINITY,&err);CHKERRQ(ierr);
+  if (err > PETSC_SQRT_MACHINE_EPSILON*nrm) {
+    ierr = PetscPrintf(PETSC_COMM_SELF,"bs %D: %s differs by %g\n",bs,name,(double)(err/nrm));CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/* A uses the kernels for its block size, R the general ones and C is the AIJ copy */
+static PetscErrorCode CheckOperations(PetscInt bs,Mat A,Mat R,Mat C)
+{
+  Vec            x,y,z,w,u;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreateVecs(A,&x,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&w);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&u);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,NULL);CHKERRQ(ierr);
+
+  ierr = MatMult(A,x,y);CHKERRQ(ierr);
+  ierr = MatMult(C,x,z);CHKERRQ(ierr);
+  ierr = Compare(bs,y,z,"MatMult");CHKERRQ(ierr);
+
+  ierr = VecSet(y,1.0);CHKERRQ(ierr);
+  ierr = MatMultAdd(C,x,y,z);CHKERRQ(ierr);
+  ierr = MatMultAdd(A,x,y,y);CHKERRQ(ierr);
+  ierr = Compare(bs,y,z,"MatMultAdd");CHKERRQ(ierr);
+
+  ierr = MatMultTranspose(A,x,y);CHKERRQ(ierr);
+  ierr = MatMultTranspose(C,x,z);CHKERRQ(ierr);
+  ierr = Compare(bs,y,z,"MatMultTranspose");CHKERRQ(ierr);
+
+  ierr = VecSet(y,1.0);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd(C,x,y,z);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd(A,x,y,y);CHKERRQ(ierr);
+  ierr = Compare(bs,y,z,"MatMultTransposeAdd");CHKERRQ(ierr);
+
+  ierr = MatSOR(A,x,1.0,(MatSORType)(SOR_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),0.0,2,1,w);CHKERRQ(ierr);
+  ierr = MatSOR(R,x,1.0,(MatSORType)(SOR_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),0.0,2,1,u);CHKERRQ(ierr);
+  ierr = Compare(bs,u,w,"Symmetric block Gauss-Seidel");CHKERRQ(ierr);
+
+  ierr = VecSet(w,1.0);CHKERRQ(ierr);
+  ierr = VecSet(u,1.0);CHKERRQ(ierr);
+  ierr = MatSOR(A,x,1.0,SOR_FORWARD_SWEEP,0.0,1,1,w);CHKERRQ(ierr);
+  ierr = MatSOR(R,x,1.0,SOR_FORWARD_SWEEP,0.0,1,1,u);CHKERRQ(ierr);
+  ierr = Compare(bs,u,w,"Forward block Gauss-Seidel");CHKERRQ(ierr);
+
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = VecDestroy(&w);CHKERRQ(ierr);
+  ierr = VecDestroy(&u);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* the LU factorizations of A and of its AIJ copy C must give the same solutions */
+static PetscErrorCode CheckFactorization(PetscInt bs,Mat A,Mat C,MatOrderingType otype)
+{
+  Mat            F,G;
+  IS             isrow,iscol,isrowc,iscolc;
+  MatFactorInfo  info;
+  Vec            x,y,z;
+  char           name[64];
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreateVecs(A,&x,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,NULL);CHKERRQ(ierr);
+  ierr = MatFactorInfoInitialize(&info);CHKERRQ(ierr);
+
+  ierr = MatGetOrdering(A,otype,&isrow,&iscol);CHKERRQ(ierr);
+  ierr = MatGetFactor(A,MATSOLVERPETSC,MAT_FACTOR_LU,&F);CHKERRQ(ierr);
+  ierr = MatLUFactorSymbolic(F,A,isrow,iscol,&info);CHKERRQ(ierr);
+  ierr = MatLUFactorNumeric(F,A,&info);CHKERRQ(ierr);
+  ierr = MatSolve(F,x,y);CHKERRQ(ierr);
+
+  ierr = MatGetOrdering(C,MATORDERINGNATURAL,&isrowc,&iscolc);CHKERRQ(ierr);
+  ierr = MatGetFactor(C,MATSOLVERPETSC,MAT_FACTOR_LU,&G);CHKERRQ(ierr);
+  ierr = MatLUFactorSymbolic(G,C,isrowc,iscolc,&info);CHKERRQ(ierr);
+  ierr = MatLUFactorNumeric(G,C,&info);CHKERRQ(ierr);
+  ierr = MatSolve(G,x,z);CHKERRQ(ierr);
+
+  ierr = PetscSNPrintf(name,sizeof(name),"MatSolve after LU with ordering %s",otype);CHKERRQ(ierr);
+  ierr = Compare(bs,y,z,name);CHKERRQ(ierr);
+
+  ierr = ISDestroy(&isrow);CHKERRQ(ierr);
+  ierr = ISDestroy(&iscol);CHKERRQ(ierr);
+  ierr = ISDestroy(&isrowc);CHKERRQ(ierr);
+  ierr = ISDestroy(&iscolc);CHKERRQ(ierr);
+  ierr = MatDestroy(&F);CHKERRQ(ierr);
+  ierr = MatDestroy(&G);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode TimeOperations(PetscInt bs,Mat A,PetscInt its)
+{
+  Mat            F;
+  IS             isrow,iscol;
+  MatFactorInfo  info;
+  Vec            x,y;
+  PetscInt       k;
+  PetscLogDouble t0,t1,tmult,tmultt,tsor,tlu,tsolve;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreateVecs(A,&x,&y);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,NULL);CHKERRQ(ierr);
+
+  ierr = PetscTime(&t0);CHKERRQ(ierr);
+  for (k=0; k<its; k++) {ierr = MatMult(A,x,y);CHKERRQ(ierr);}
+  ierr = PetscTime(&t1);CHKERRQ(ierr);
+  tmult = (t1-t0)/its;
+
+  ierr = PetscTime(&t0);CHKERRQ(ierr);
+  for (k=0; k<its; k++) {ierr = MatMultTranspose(A,x,y);CHKERRQ(ierr);}
+  ierr = PetscTime(&t1);CHKERRQ(ierr);
+  tmultt = (t1-t0)/its;
+
+  ierr = PetscTime(&t0);CHKERRQ(ierr);
+  for (k=0; k<its; k++) {ierr = MatSOR(A,x,1.0,(MatSORType)(SOR_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),0.0,1,1,y);CHKERRQ(ierr);}
+  ierr = PetscTime(&t1);CHKERRQ(ierr);
+  tsor = (t1-t0)/its;
+
+  ierr = MatFactorInfoInitialize(&info);CHKERRQ(ierr);
+  info.fill = 1.0;
+  ierr = MatGetOrdering(A,MATORDERINGNATURAL,&isrow,&iscol);CHKERRQ(ierr);
+  ierr = MatGetFactor(A,MATSOLVERPETSC,MAT_FACTOR_ILU,&F);CHKERRQ(ierr);
+  ierr = MatILUFactorSymbolic(F,A,isrow,iscol,&info);CHKERRQ(ierr);
+  ierr = PetscTime(&t0);CHKERRQ(ierr);
+  for (k=0; k<its; k++) {ierr = MatLUFactorNumeric(F,A,&info);CHKERRQ(ierr);}
+  ierr = PetscTime(&t1);CHKERRQ(ierr);
+  tlu  = (t1-t0)/its;
+  ierr = PetscTime(&t0);CHKERRQ(ierr);
+  for (k=0; k<its; k++) {ierr = MatSolve(F,x,y);CHKERRQ(ierr);}
+  ierr = PetscTime(&t1);CHKERRQ(ierr);
+  tsolve = (t1-t0)/its;
+
+  ierr = PetscPrintf(PETSC_COMM_SELF,"bs %2D: MatMult %8.2e MatMultTranspose %8.2e SOR %8.2e ILU(0) %8.2e MatSolve %8.2e sec\n",bs,tmult,tmultt,tsor,tlu,tsolve);CHKERRQ(ierr);
+
+  ierr = ISDestroy(&isrow);CHKERRQ(ierr);
+  ierr = ISDestroy(&iscol);CHKERRQ(ierr);
+  ierr = MatDestroy(&F);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **argv)
+{
+  Mat            A,R,C;
+  PetscInt       n = 6,bs,its = 100;
+  PetscBool      flg = PETSC_FALSE;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-its",&its,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-time",&flg,NULL);CHKERRQ(ierr);
+
+  for (bs=1; bs<=16; bs++) {
+    ierr = CreateMatrix(n,bs,&A);CHKERRQ(ierr);
+    ierr = MatConvert(A,MATSEQAIJ,MAT_INITIAL_MATRIX,&C);CHKERRQ(ierr);
+    ierr = PetscOptionsSetValue(NULL,"-mat_no_unroll",NULL);CHKERRQ(ierr);
+    ierr = CreateMatrix(n,bs,&R);CHKERRQ(ierr);
+    ierr = PetscOptionsClearValue(NULL,"-mat_no_unroll");CHKERRQ(ierr);
+
+    ierr = CheckOperations(bs,A,R,C);CHKERRQ(ierr);
+    ierr = CheckFactorization(bs,A,C,MATORDERINGNATURAL);CHKERRQ(ierr);
+    ierr = CheckFactorization(bs,A,C,MATORDERINGND);CHKERRQ(ierr);
+    if (flg) {ierr = TimeOperations(bs,A,its);CHKERRQ(ierr);}
+
+    ierr = MatDestroy(&A);CHKERRQ(ierr);
+    ierr = MatDestroy(&R);CHKERRQ(ierr);
+    ierr = MatDestroy(&C);CHKERRQ(ierr);
+  }
+  ierr = PetscPrintf(PETSC_COMM_SELF,"Checked block sizes 1 to 16\n");CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
@@ -0,0 +1,107 @@
+
+static char help[] = "Tests the detection of the block size of AIJ matrices assembled without one.\n\
+  -n <n>    : the matrix is the five point stencil on an n by n grid\n\
+  -bs <bs>  : number of fully coupled unknowns per grid point\n\
+  -broken   : add an entry that breaks the block structure\n\n";
+
+#include <petscmat.h>
+
+/* sets the entries one at a time, as an application that does not know about blocks would */
+static PetscErrorCode FillMatrix(Mat A,PetscInt n,PetscInt bs,PetscBool broken)
+{
+  PetscInt       node,i,j,k,l,row,col,nodes[5],nn,rstart,rend;
+  PetscScalar    v;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  for (node=rstart/bs; node<rend/bs; node++) {
+    i = node/n; j = node%n; nn = 0;
+    if (i>0)   nodes[nn++] = node-n;
+    if (j>0)   nodes[nn++] = node-1;
+    nodes[nn++] = node;
+    if (j<n-1) nodes[nn++] = node+1;
+    if (i<n-1) nodes[nn++] = node+n;
+    for (k=0; k<bs; k++) {
+      row = bs*node + k;
+      for (l=0; l<nn*bs; l++) {
+        col  = bs*nodes[l/bs] + l%bs;
+        v    = (nodes[l/bs] == node) ? ((k == l%bs) ? 4.0*bs : 0.5) : -1.0/(1.0+k+l%bs);
+        ierr = MatSetValues(A,1,&row,1,&col,&v,INSERT_VALUES);CHKERRQ(ierr);
+      }
+    }
+  }
+  if (broken && !rstart) {
+    row  = 0; col = n*n*bs-1; v = 0.25;
+    ierr = MatSetValues(A,1,&row,1,&col,&v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode CreateMatrix(PetscInt n,PetscInt bs,PetscBool broken,PetscBool fromoptions,Mat *A)
+{
+  PetscInt       m = PETSC_DECIDE,N = n*n;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSplitOwnership(PETSC_COMM_WORLD,&m,&N);CHKERRQ(ierr);
+  ierr = MatCreate(PETSC_COMM_WORLD,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,m*bs,m*bs,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRQ(ierr);
+  if (fromoptions) {
+    ierr = MatSetFromOptions(*A);CHKERRQ(ierr);
+  } else {
+    ierr = MatSetType(*A,MATAIJ);CHKERRQ(ierr);
+  }
+  ierr = MatSeqAIJSetPreallocation(*A,5*bs+1,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(*A,5*bs+1,NULL,4*bs+1,NULL);CHKERRQ(ierr);
+  ierr = FillMatrix(*A,n,bs,broken);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **argv)
+{
+  Mat            A,R;
+  Vec            x,y,z;
+  PetscInt       n = 5,bs = 3,rbs,cbs;
+  PetscReal      err;
+  PetscBool      broken = PETSC_FALSE;
+  MatType        type;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-bs",&bs,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-broken",&broken,NULL);CHKERRQ(ierr);
+
+  ierr = CreateMatrix(n,bs,broken,PETSC_TRUE,&A);CHKERRQ(ierr);
+  ierr = CreateMatrix(n,bs,broken,PETSC_FALSE,&R);CHKERRQ(ierr);
+
+  ierr = MatGetType(A,&type);CHKERRQ(ierr);
+  ierr = MatGetBlockSizes(A,&rbs,&cbs);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Matrix type %s, block sizes %D %D\n",type,rbs,cbs);CHKERRQ(ierr);
+  ierr = PetscViewerPushFormat(PETSC_VIEWER_STDOUT_WORLD,PETSC_VIEWER_ASCII_INFO);CHKERRQ(ierr);
+  ierr = MatView(A,PETSC_VIEWER_STDOUT_WORLD);CHKERRQ(ierr);
+  ierr = PetscViewerPopFormat(PETSC_VIEWER_STDOUT_WORLD);CHKERRQ(ierr);
+
+  /* the matrix must be unchanged */
+  ierr = MatCreateVecs(R,&x,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,NULL);CHKERRQ(ierr);
+  ierr = MatMult(A,x,y);CHKERRQ(ierr);
+  ierr = MatMult(R,x,z);CHKERRQ(ierr);
+  ierr = VecAXPY(y,-1.0,z);CHKERRQ(ierr);
+  ierr = VecNorm(y,NORM_INFINITY,&err);CHKERRQ(ierr);
+  if (err > PETSC_SMALL) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"MatMult differs by %g\n",(double)err);CHKERRQ(ierr);
+  }
+
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&R);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
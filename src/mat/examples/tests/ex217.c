@@ -0,0 +1,173 @@
+
+static char help[] = "Tests KAIJ matrices I kron S + A kron T against the same matrix assembled as AIJ.\n\
+  -n <n>       : A is a convection-diffusion stencil on an n by n grid\n\
+  -dof <dof>   : size of S and T\n\
+  -no_S        : use S = 0\n\
+  -identity_T  : use T = I\n\n";
+
+#include <petscmat.h>
+
+/* builds I kron S + A kron T entry by entry */
+static PetscErrorCode AssembleExplicit(Mat A,PetscInt dof,const PetscScalar *S,const PetscScalar *T,Mat *E)
+{
+  PetscInt          i,j,k,l,rstart,rend,ncols,row,col;
+  const PetscInt    *cols;
+  const PetscScalar *vals;
+  PetscScalar       v;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  ierr = MatCreate(PETSC_COMM_WORLD,E);CHKERRQ(ierr);
+  ierr = MatSetSizes(*E,dof*(rend-rstart),dof*(rend-rstart),PETSC_DETERMINE,PETSC_DETERMINE);CHKERRQ(ierr);
+  ierr = MatSetBlockSize(*E,dof);CHKERRQ(ierr);
+  ierr = MatSetType(*E,MATAIJ);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(*E,6*dof,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(*E,6*dof,NULL,4*dof,NULL);CHKERRQ(ierr);
+  for (i=rstart; i<rend; i++) {
+    ierr = MatGetRow(A,i,&ncols,&cols,&vals);CHKERRQ(ierr);
+    for (k=0; k<dof; k++) {
+      row = dof*i+k;
+      for (j=0; j<ncols; j++) {
+        for (l=0; l<dof; l++) {
+          col  = dof*cols[j]+l;
+          v    = vals[j]*(T ? T[k+l*dof] : (PetscScalar)(k == l));
+          ierr = MatSetValues(*E,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);
+        }
+      }
+      for (l=0; S && l<dof; l++) {
+        col  = dof*i+l;
+        ierr = MatSetValues(*E,1,&row,1,&col,&S[k+l*dof],ADD_VALUES);CHKERRQ(ierr);
+      }
+    }
+    ierr = MatRestoreRow(A,i,&ncols,&cols,&vals);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(*E,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(*E,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode CheckVecs(const char *name,Vec x,Vec y)
+{
+  PetscReal      nrm,err;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecNorm(y,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  ierr = VecAXPY(y,-1.0,x);CHKERRQ(ierr);
+  ierr = VecNorm(y,NORM_INFINITY,&err);CHKERRQ(ierr);
+  if (err > PETSC_SMALL*PetscMax(nrm,1.0)) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"%s differs by %g\n",name,(double)err);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **argv)
+{
+  Mat            A,K,E,C,Eb;
+  Vec            x,y,z,y2,z2,b;
+  PetscInt       n = 6,dof = 3,i,k,l,rstart,rend,col[5],nc;
+  PetscScalar    *S,*T,v[5];
+  PetscReal      err;
+  PetscBool      noS = PETSC_FALSE,identityT = PETSC_FALSE;
+  MatType        type;
+  PetscRandom    rdm;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-dof",&dof,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-no_S",&noS,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-identity_T",&identityT,NULL);CHKERRQ(ierr);
+
+  /* A: nonsymmetric five point stencil */
+  ierr = MatCreateAIJ(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,n*n,n*n,5,NULL,4,NULL,&A);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  for (i=rstart; i<rend; i++) {
+    nc = 0;
+    if (i >= n)      {col[nc] = i-n; v[nc++] = -1.2;}
+    if (i%n)         {col[nc] = i-1; v[nc++] = -1.1;}
+    col[nc] = i; v[nc++] = 4.0;
+    if ((i+1)%n)     {col[nc] = i+1; v[nc++] = -0.9;}
+    if (i+n < n*n)   {col[nc] = i+n; v[nc++] = -0.8;}
+    ierr = MatSetValues(A,1,&i,nc,col,v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  /* S and T: nonsymmetric, S + a_ii T well conditioned */
+  ierr = PetscMalloc2(dof*dof,&S,dof*dof,&T);CHKERRQ(ierr);
+  for (k=0; k<dof; k++) {
+    for (l=0; l<dof; l++) {
+      S[k+l*dof] = (k == l) ? 5.0+k : 1.0/(1.0+k+2*l);
+      T[k+l*dof] = (k == l) ? 1.0 : 0.1*(k-l)/dof;
+    }
+  }
+  ierr = MatCreateKAIJ(A,dof,noS ? NULL : S,identityT ? NULL : T,&K);CHKERRQ(ierr);
+  ierr = AssembleExplicit(A,dof,noS ? NULL : S,identityT ? NULL : T,&E);CHKERRQ(ierr);
+  ierr = MatGetType(K,&type);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Matrix type %s\n",type);CHKERRQ(ierr);
+
+  /* products */
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rdm);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rdm);CHKERRQ(ierr);
+  ierr = MatCreateVecs(E,&x,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&y2);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z2);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&b);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,rdm);CHKERRQ(ierr);
+  ierr = VecSetRandom(z,rdm);CHKERRQ(ierr);
+  ierr = MatMult(E,x,y);CHKERRQ(ierr);
+  ierr = MatMult(K,x,y2);CHKERRQ(ierr);
+  ierr = CheckVecs("MatMult",y,y2);CHKERRQ(ierr);
+  ierr = MatMultAdd(E,x,z,y);CHKERRQ(ierr);
+  ierr = MatMultAdd(K,x,z,y2);CHKERRQ(ierr);
+  ierr = CheckVecs("MatMultAdd",y,y2);CHKERRQ(ierr);
+  ierr = MatMultTranspose(E,x,y);CHKERRQ(ierr);
+  ierr = MatMultTranspose(K,x,y2);CHKERRQ(ierr);
+  ierr = CheckVecs("MatMultTranspose",y,y2);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd(E,x,z,y);CHKERRQ(ierr);
+  ierr = VecCopy(z,z2);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd(K,x,z2,z2);CHKERRQ(ierr);
+  ierr = CheckVecs("MatMultTransposeAdd",y,z2);CHKERRQ(ierr);
+  ierr = MatGetDiagonal(E,y);CHKERRQ(ierr);
+  ierr = MatGetDiagonal(K,y2);CHKERRQ(ierr);
+  ierr = CheckVecs("MatGetDiagonal",y,y2);CHKERRQ(ierr);
+
+  /* conversion */
+  ierr = MatConvert(K,MATAIJ,MAT_INITIAL_MATRIX,&C);CHKERRQ(ierr);
+  ierr = MatAXPY(C,-1.0,E,DIFFERENT_NONZERO_PATTERN);CHKERRQ(ierr);
+  ierr = MatNorm(C,NORM_FROBENIUS,&err);CHKERRQ(ierr);
+  if (err > PETSC_SMALL) {ierr = PetscPrintf(PETSC_COMM_WORLD,"MatConvert differs by %g\n",(double)err);CHKERRQ(ierr);}
+  ierr = MatDestroy(&C);CHKERRQ(ierr);
+
+  /* point-block SOR must match BAIJ with the same blocks */
+  ierr = MatConvert(E,MATBAIJ,MAT_INITIAL_MATRIX,&Eb);CHKERRQ(ierr);
+  ierr = VecSetRandom(b,rdm);CHKERRQ(ierr);
+  ierr = MatSOR(Eb,b,1.0,(MatSORType)(SOR_LOCAL_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),0.0,2,1,y);CHKERRQ(ierr);
+  ierr = MatSOR(K,b,1.0,(MatSORType)(SOR_LOCAL_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),0.0,2,1,y2);CHKERRQ(ierr);
+  ierr = CheckVecs("MatSOR",y,y2);CHKERRQ(ierr);
+  ierr = MatDestroy(&Eb);CHKERRQ(ierr);
+
+  /* SOR as a solver, with over-relaxation */
+  ierr = MatSOR(K,b,1.1,(MatSORType)(SOR_LOCAL_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),0.0,100,1,y);CHKERRQ(ierr);
+  ierr = MatMult(E,y,y2);CHKERRQ(ierr);
+  ierr = VecAXPY(y2,-1.0,b);CHKERRQ(ierr);
+  ierr = VecNorm(y2,NORM_2,&err);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"SOR iteration: %s\n",err < 1.e-8 ? "residual is small" : "residual is large");CHKERRQ(ierr);
+
+  ierr = PetscRandomDestroy(&rdm);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = VecDestroy(&y2);CHKERRQ(ierr);
+  ierr = VecDestroy(&z2);CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = PetscFree2(S,T);CHKERRQ(ierr);
+  ierr = MatDestroy(&K);CHKERRQ(ierr);
+  ierr = MatDestroy(&E);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
@@ -0,0 +1,89 @@
+
+static char help[] = "Tests the algorithms of MatMatMult() for SeqAIJ matrices against each other.\n\
+  -n <n>       : A is the five point stencil on an n by n grid\n\
+  -coarsen <c> : P aggregates c by c blocks of grid points, so A*P has few columns\n\n";
+
+#include <petscmat.h>
+
+static PetscErrorCode CheckProduct(const char *alg,Mat A,Mat B,Mat Cref)
+{
+  Mat            C;
+  PetscReal      err;
+  PetscBool      same;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsSetValue(NULL,"-matmatmult_via",alg);CHKERRQ(ierr);
+  ierr = MatMatMult(A,B,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&C);CHKERRQ(ierr);
+  /* the values of A change, the numeric phase is done again */
+  ierr = MatScale(A,2.0);CHKERRQ(ierr);
+  ierr = MatMatMult(A,B,MAT_REUSE_MATRIX,PETSC_DEFAULT,&C);CHKERRQ(ierr);
+  ierr = MatScale(A,0.5);CHKERRQ(ierr);
+  ierr = MatScale(C,A == B ? 0.25 : 0.5);CHKERRQ(ierr);
+  ierr = MatEqual(C,Cref,&same);CHKERRQ(ierr);
+  ierr = MatAXPY(C,-1.0,Cref,DIFFERENT_NONZERO_PATTERN);CHKERRQ(ierr);
+  ierr = MatNorm(C,NORM_FROBENIUS,&err);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: %s\n",alg,(same || err < PETSC_SMALL) ? "products agree" : "products differ");CHKERRQ(ierr);
+  ierr = MatDestroy(&C);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **argv)
+{
+  Mat            A,P,AA,AP;
+  PetscInt       n = 20,coarsen = 5,nc,i,j,k,col[5],row,cols;
+  PetscScalar    v[5],one = 1.0;
+  const char     *algs[] = {"scalable","scalable_fast","heap","btheap","llcondensed","hash","auto"};
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-coarsen",&coarsen,NULL);CHKERRQ(ierr);
+  nc   = (n+coarsen-1)/coarsen;
+
+  /* A: nonsymmetric five point stencil */
+  ierr = MatCreateSeqAIJ(PETSC_COMM_SELF,n*n,n*n,5,NULL,&A);CHKERRQ(ierr);
+  for (i=0; i<n*n; i++) {
+    k = 0;
+    if (i >= n)    {col[k] = i-n; v[k++] = -1.2;}
+    if (i%n)       {col[k] = i-1; v[k++] = -1.1;}
+    col[k] = i; v[k++] = 4.0 + 0.01*i;
+    if ((i+1)%n)   {col[k] = i+1; v[k++] = -0.9;}
+    if (i+n < n*n) {col[k] = i+n; v[k++] = -0.8;}
+    ierr = MatSetValues(A,1,&i,k,col,v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  /* P: piecewise constant aggregation, a narrow matrix */
+  ierr = MatCreateSeqAIJ(PETSC_COMM_SELF,n*n,nc*nc,1,NULL,&P);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    for (j=0; j<n; j++) {
+      row  = i*n+j; cols = (i/coarsen)*nc + j/coarsen;
+      ierr = MatSetValues(P,1,&row,1,&cols,&one,INSERT_VALUES);CHKERRQ(ierr);
+    }
+  }
+  ierr = MatAssemblyBegin(P,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(P,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  /* reference products with the dense accumulator */
+  ierr = PetscOptionsSetValue(NULL,"-matmatmult_via","sorted");CHKERRQ(ierr);
+  ierr = MatMatMult(A,A,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&AA);CHKERRQ(ierr);
+  ierr = MatMatMult(A,P,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&AP);CHKERRQ(ierr);
+
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"A*A\n");CHKERRQ(ierr);
+  for (k=0; k<(PetscInt)(sizeof(algs)/sizeof(algs[0])); k++) {
+    ierr = CheckProduct(algs[k],A,A,AA);CHKERRQ(ierr);
+  }
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"A*P\n");CHKERRQ(ierr);
+  for (k=0; k<(PetscInt)(sizeof(algs)/sizeof(algs[0])); k++) {
+    ierr = CheckProduct(algs[k],A,P,AP);CHKERRQ(ierr);
+  }
+
+  ierr = MatDestroy(&AA);CHKERRQ(ierr);
+  ierr = MatDestroy(&AP);CHKERRQ(ierr);
+  ierr = MatDestroy(&P);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
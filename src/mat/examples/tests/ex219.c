@@ -0,0 +1,166 @@
+
+static char help[] = "Tests the level scheduled triangular solves of LU, ILU, Cholesky and ICC factors of SeqAIJ matrices.\n\
+  -n <n>      : the matrix is a five point stencil on an n by n grid\n\
+  -dof <dof>  : number of fully coupled unknowns per grid point\n\n";
+
+#include <petscmat.h>
+
+/* nonsymmetric unless symmetric is set, diagonally dominant */
+static PetscErrorCode CreateMatrix(PetscInt n,PetscInt dof,PetscBool symmetric,Mat *A)
+{
+  PetscInt       node,i,j,k,l,nodes[5],nn,row,col;
+  PetscScalar    v;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreateSeqAIJ(PETSC_COMM_SELF,n*n*dof,n*n*dof,5*dof,NULL,A);CHKERRQ(ierr);
+  for (node=0; node<n*n; node++) {
+    i = node/n; j = node%n; nn = 0;
+    if (i>0)   nodes[nn++] = node-n;
+    if (j>0)   nodes[nn++] = node-1;
+    nodes[nn++] = node;
+    if (j<n-1) nodes[nn++] = node+1;
+    if (i<n-1) nodes[nn++] = node+n;
+    for (k=0; k<dof; k++) {
+      row = dof*node+k;
+      for (l=0; l<nn*dof; l++) {
+        col = dof*nodes[l/dof]+l%dof;
+        if (nodes[l/dof] == node) v = (k == l%dof) ? 4.0*dof+1.0 : 0.5;
+        else if (symmetric)       v = -1.0/(1.0+k+l%dof);
+        else                      v = (nodes[l/dof] < node ? -1.2 : -0.8)/(1.0+k+2*(l%dof));
+        ierr = MatSetValues(*A,1,&row,1,&col,&v,INSERT_VALUES);CHKERRQ(ierr);
+      }
+    }
+  }
+  ierr = MatAssemblyBegin(*A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(*A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode Refactor(Mat F,Mat A)
+{
+  MatFactorInfo  info;
+  MatFactorType  ftype;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatFactorInfoInitialize(&info);CHKERRQ(ierr);
+  ierr = MatGetFactorType(F,&ftype);CHKERRQ(ierr);
+  if (ftype == MAT_FACTOR_CHOLESKY || ftype == MAT_FACTOR_ICC) {
+    ierr = MatCholeskyFactorNumeric(F,A,&info);CHKERRQ(ierr);
+  } else {
+    ierr = MatLUFactorNumeric(F,A,&info);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode Factor(Mat A,MatFactorType ftype,MatOrderingType otype,PetscInt levels,PetscBool solvelevels,Mat *F)
+{
+  IS             row,col;
+  MatFactorInfo  info;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsSetValue(NULL,"-mat_solve_levels",solvelevels ? "1" : "0");CHKERRQ(ierr);
+  ierr = MatGetFactor(A,MATSOLVERPETSC,ftype,F);CHKERRQ(ierr);
+  ierr = MatGetOrdering(A,otype,&row,&col);CHKERRQ(ierr);
+  ierr = MatFactorInfoInitialize(&info);CHKERRQ(ierr);
+  info.levels = levels;
+  info.fill   = 5.0;
+  switch (ftype) {
+  case MAT_FACTOR_LU:
+    ierr = MatLUFactorSymbolic(*F,A,row,col,&info);CHKERRQ(ierr);
+    break;
+  case MAT_FACTOR_ILU:
+    ierr = MatILUFactorSymbolic(*F,A,row,col,&info);CHKERRQ(ierr);
+    break;
+  case MAT_FACTOR_CHOLESKY:
+    ierr = MatCholeskyFactorSymbolic(*F,A,row,&info);CHKERRQ(ierr);
+    break;
+  case MAT_FACTOR_ICC:
+    ierr = MatICCFactorSymbolic(*F,A,row,&info);CHKERRQ(ierr);
+    break;
+  default: SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Factor type not tested");
+  }
+  ierr = Refactor(*F,A);CHKERRQ(ierr);
+  ierr = ISDestroy(&row);CHKERRQ(ierr);
+  ierr = ISDestroy(&col);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* factors A twice with the same structure and compares the solves with and without levels */
+static PetscErrorCode Test(Mat A,MatFactorType ftype,MatOrderingType otype,PetscInt levels,const char *name)
+{
+  Mat            F,Fl;
+  Vec            b,x,y;
+  PetscReal      nrm,err,errt;
+  PetscInt       it;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreateVecs(A,&x,&b);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&y);CHKERRQ(ierr);
+  ierr = VecSetRandom(b,NULL);CHKERRQ(ierr);
+  ierr = Factor(A,ftype,otype,levels,PETSC_FALSE,&F);CHKERRQ(ierr);
+  ierr = Factor(A,ftype,otype,levels,PETSC_TRUE,&Fl);CHKERRQ(ierr);
+  for (it=0; it<2; it++) {
+    if (it) {
+      /* refactor with new values, the levels of the first factorization are reused */
+      ierr = MatShift(A,1.0);CHKERRQ(ierr);
+      ierr = Refactor(F,A);CHKERRQ(ierr);
+      ierr = Refactor(Fl,A);CHKERRQ(ierr);
+    }
+    ierr = MatSolve(F,b,x);CHKERRQ(ierr);
+    ierr = MatSolve(Fl,b,y);CHKERRQ(ierr);
+    ierr = VecNorm(x,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+    ierr = VecAXPY(y,-1.0,x);CHKERRQ(ierr);
+    ierr = VecNorm(y,NORM_INFINITY,&err);CHKERRQ(ierr);
+    errt = 0.0;
+    if (ftype == MAT_FACTOR_CHOLESKY || ftype == MAT_FACTOR_ICC) {
+      ierr = MatSolveTranspose(Fl,b,y);CHKERRQ(ierr);
+      ierr = VecAXPY(y,-1.0,x);CHKERRQ(ierr);
+      ierr = VecNorm(y,NORM_INFINITY,&errt);CHKERRQ(ierr);
+    }
+    if (PetscMax(err,errt) > PETSC_SMALL*nrm) {
+      ierr = PetscPrintf(PETSC_COMM_SELF,"%s: level scheduled solve differs by %g\n",name,(double)PetscMax(err,errt));CHKERRQ(ierr);
+    } else {
+      ierr = PetscPrintf(PETSC_COMM_SELF,"%s: level scheduled solve agrees%s\n",name,it ? " after refactorization" : "");CHKERRQ(ierr);
+    }
+  }
+  ierr = MatDestroy(&F);CHKERRQ(ierr);
+  ierr = MatDestroy(&Fl);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **argv)
+{
+  Mat            A,S;
+  PetscInt       n = 12,dof = 1;
+  PetscMPIInt    size;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  if (size != 1) SETERRQ(PETSC_COMM_WORLD,PETSC_ERR_SUP,"This is a uniprocessor example only");
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-dof",&dof,NULL);CHKERRQ(ierr);
+
+  ierr = CreateMatrix(n,dof,PETSC_FALSE,&A);CHKERRQ(ierr);
+  ierr = CreateMatrix(n,dof,PETSC_TRUE,&S);CHKERRQ(ierr);
+
+  ierr = Test(A,MAT_FACTOR_LU,MATORDERINGND,0,"LU nd");CHKERRQ(ierr);
+  ierr = Test(A,MAT_FACTOR_ILU,MATORDERINGNATURAL,0,"ILU(0) natural");CHKERRQ(ierr);
+  ierr = Test(A,MAT_FACTOR_ILU,MATORDERINGRCM,0,"ILU(0) rcm");CHKERRQ(ierr);
+  ierr = Test(A,MAT_FACTOR_ILU,MATORDERINGNATURAL,2,"ILU(2) natural");CHKERRQ(ierr);
+  ierr = Test(S,MAT_FACTOR_CHOLESKY,MATORDERINGND,0,"Cholesky nd");CHKERRQ(ierr);
+  ierr = Test(S,MAT_FACTOR_ICC,MATORDERINGNATURAL,0,"ICC(0) natural");CHKERRQ(ierr);
+  ierr = Test(S,MAT_FACTOR_ICC,MATORDERINGRCM,1,"ICC(1) rcm");CHKERRQ(ierr);
+
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&S);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
@@ -0,0 +1,137 @@
+
+static char help[] = "Tests the supernodal numeric Cholesky factorization of SeqAIJ and SeqSBAIJ matrices.\n\
+  -n <n>      : the matrix is the seven point Laplacian on an n by n by n grid\n\
+  -sigma <s>  : shift of the matrix, makes it indefinite when large enough\n\n";
+
+#include <petscmat.h>
+
+/* with layers the grid planes are not coupled, which gives a matrix of the same size with another nonzero pattern */
+static PetscErrorCode CreateMatrix(MatType type,PetscInt n,PetscScalar sigma,PetscBool layers,Mat *A)
+{
+  PetscInt       i,j,k,row,cols[7],nc;
+  PetscScalar    v[7];
+  PetscBool      sbaij;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscStrcmp(type,MATSEQSBAIJ,&sbaij);CHKERRQ(ierr);
+  ierr = MatCreate(PETSC_COMM_SELF,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,n*n*n,n*n*n,n*n*n,n*n*n);CHKERRQ(ierr);
+  ierr = MatSetType(*A,type);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(*A,7,NULL);CHKERRQ(ierr);
+  ierr = MatSeqSBAIJSetPreallocation(*A,1,4,NULL);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    for (j=0; j<n; j++) {
+      for (k=0; k<n; k++) {
+        row = i+n*(j+n*k); nc = 0;
+        if (!sbaij) {
+          if (k>0 && !layers) {cols[nc] = row-n*n; v[nc++] = -1.0;}
+          if (j>0) {cols[nc] = row-n;   v[nc++] = -1.0;}
+          if (i>0) {cols[nc] = row-1;   v[nc++] = -1.0;}
+        }
+        cols[nc] = row; v[nc++] = 6.0-sigma;
+        if (i<n-1) {cols[nc] = row+1;   v[nc++] = -1.0;}
+        if (j<n-1) {cols[nc] = row+n;   v[nc++] = -1.0;}
+        if (k<n-1 && !layers) {cols[nc] = row+n*n; v[nc++] = -1.0;}
+        ierr = MatSetValues(*A,1,&row,nc,cols,v,INSERT_VALUES);CHKERRQ(ierr);
+      }
+    }
+  }
+  ierr = MatAssemblyBegin(*A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(*A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* with reuse the symbolic factorization is repeated on the existing factor */
+static PetscErrorCode Factor(Mat A,MatOrderingType otype,PetscBool supernodal,PetscBool reuse,Mat *F)
+{
+  IS             row,col;
+  MatFactorInfo  info;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsSetValue(NULL,"-mat_cholesky_supernodal",supernodal ? "1" : "0");CHKERRQ(ierr);
+  if (!reuse) {ierr = MatGetFactor(A,MATSOLVERPETSC,MAT_FACTOR_CHOLESKY,F);CHKERRQ(ierr);}
+  ierr = MatGetOrdering(A,otype,&row,&col);CHKERRQ(ierr);
+  ierr = MatFactorInfoInitialize(&info);CHKERRQ(ierr);
+  ierr = MatCholeskyFactorSymbolic(*F,A,row,&info);CHKERRQ(ierr);
+  ierr = MatCholeskyFactorNumeric(*F,A,&info);CHKERRQ(ierr);
+  ierr = ISDestroy(&row);CHKERRQ(ierr);
+  ierr = ISDestroy(&col);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* factors A with and without supernodes, then again after changing its values and after changing its
+   nonzero pattern, and compares the solutions */
+static PetscErrorCode Test(MatType type,PetscInt n,PetscScalar sigma,MatOrderingType otype)
+{
+  Mat            A,F,Fs;
+  Vec            b,x,y;
+  MatFactorInfo  info;
+  PetscReal      nrm,err;
+  PetscInt       it,nneg,nzero,npos,snneg,snzero,snpos;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = CreateMatrix(type,n,sigma,PETSC_FALSE,&A);CHKERRQ(ierr);
+  ierr = MatCreateVecs(A,&x,&b);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&y);CHKERRQ(ierr);
+  ierr = VecSetRandom(b,NULL);CHKERRQ(ierr);
+  ierr = Factor(A,otype,PETSC_FALSE,PETSC_FALSE,&F);CHKERRQ(ierr);
+  ierr = Factor(A,otype,PETSC_TRUE,PETSC_FALSE,&Fs);CHKERRQ(ierr);
+  ierr = MatFactorInfoInitialize(&info);CHKERRQ(ierr);
+  for (it=0; it<3; it++) {
+    if (it == 1) {
+      ierr = MatShift(A,0.5);CHKERRQ(ierr);
+      ierr = MatCholeskyFactorNumeric(F,A,&info);CHKERRQ(ierr);
+      ierr = MatCholeskyFactorNumeric(Fs,A,&info);CHKERRQ(ierr);
+    } else if (it == 2) {
+      ierr = MatDestroy(&A);CHKERRQ(ierr);
+      ierr = CreateMatrix(type,n,sigma,PETSC_TRUE,&A);CHKERRQ(ierr);
+      ierr = Factor(A,otype,PETSC_FALSE,PETSC_TRUE,&F);CHKERRQ(ierr);
+      ierr = Factor(A,otype,PETSC_TRUE,PETSC_TRUE,&Fs);CHKERRQ(ierr);
+    }
+    ierr = MatSolve(F,b,x);CHKERRQ(ierr);
+    ierr = MatSolve(Fs,b,y);CHKERRQ(ierr);
+    ierr = VecNorm(x,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+    ierr = VecAXPY(y,-1.0,x);CHKERRQ(ierr);
+    ierr = VecNorm(y,NORM_INFINITY,&err);CHKERRQ(ierr);
+    ierr = MatGetInertia(F,&nneg,&nzero,&npos);CHKERRQ(ierr);
+    ierr = MatGetInertia(Fs,&snneg,&snzero,&snpos);CHKERRQ(ierr);
+    if (err > PETSC_SMALL*nrm) {
+      ierr = PetscPrintf(PETSC_COMM_SELF,"%s %s: supernodal solution differs by %g\n",type,otype,(double)err);CHKERRQ(ierr);
+    } else if (nneg != snneg || nzero != snzero || npos != snpos) {
+      ierr = PetscPrintf(PETSC_COMM_SELF,"%s %s: supernodal inertia differs\n",type,otype);CHKERRQ(ierr);
+    } else {
+      ierr = PetscPrintf(PETSC_COMM_SELF,"%s %s: supernodal factorization agrees, %D negative eigenvalues\n",type,otype,nneg);CHKERRQ(ierr);
+    }
+  }
+  ierr = MatDestroy(&F);CHKERRQ(ierr);
+  ierr = MatDestroy(&Fs);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **argv)
+{
+  PetscInt       n = 6;
+  PetscScalar    sigma = 0.0;
+  PetscMPIInt    size;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  if (size != 1) SETERRQ(PETSC_COMM_WORLD,PETSC_ERR_SUP,"This is a uniprocessor example only");
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetScalar(NULL,NULL,"-sigma",&sigma,NULL);CHKERRQ(ierr);
+
+  ierr = Test(MATSEQAIJ,n,sigma,MATORDERINGNATURAL);CHKERRQ(ierr);
+  ierr = Test(MATSEQAIJ,n,sigma,MATORDERINGND);CHKERRQ(ierr);
+  ierr = Test(MATSEQAIJ,n,sigma,MATORDERINGRCM);CHKERRQ(ierr);
+  ierr = Test(MATSEQSBAIJ,n,sigma,MATORDERINGNATURAL);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
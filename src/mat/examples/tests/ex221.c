@@ -0,0 +1,117 @@
+
+static char help[] = "Tests MatCreateSubMatrices() with MAT_REUSE_MATRIX for MPIAIJ matrices whose values change.\n\
+  -n <n>      : the matrix is a nine point stencil on an n by n grid\n\
+  -nd <nd>    : number of subdomains on each process\n\
+  -ov <ov>    : overlap of the subdomains\n\
+  -idle_last  : the last process requests no submatrices\n\
+  -col_type <k> : the columns of subdomain i are its rows, its rows reversed or all the columns for (i+k)%%3 = 0, 1, 2\n\
+  -single_is  : one subdomain on each process, extracted with MAT_SUBMAT_SINGLEIS as PCASM does\n\n";
+
+#include <petscmat.h>
+
+/* sets random values in the nine point stencil, the nonzero structure is always the same */
+static PetscErrorCode FillMatrix(Mat A,PetscInt n,PetscRandom rdm)
+{
+  PetscInt       row,rstart,rend,i,j,k,l,cols[9],nc;
+  PetscScalar    v[9];
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  for (row=rstart; row<rend; row++) {
+    i = row/n; j = row%n; nc = 0;
+    for (k=PetscMax(i-1,0); k<=PetscMin(i+1,n-1); k++) {
+      for (l=PetscMax(j-1,0); l<=PetscMin(j+1,n-1); l++) {
+        cols[nc] = k*n+l;
+        ierr     = PetscRandomGetValue(rdm,&v[nc++]);CHKERRQ(ierr);
+      }
+    }
+    ierr = MatSetValues(A,1,&row,nc,cols,v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **argv)
+{
+  Mat            A,*sub,*ref;
+  IS             *isrow,*iscol;
+  PetscInt       n = 12,nd = 3,ov = 2,coltype = 0,nis,i,j,it,rstart,rend,len,*idx;
+  const PetscInt *rows;
+  PetscBool      idle = PETSC_FALSE,single = PETSC_FALSE,flg,same = PETSC_TRUE,allsame;
+  PetscMPIInt    rank,size;
+  PetscRandom    rdm;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-nd",&nd,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-ov",&ov,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-idle_last",&idle,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-col_type",&coltype,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-single_is",&single,NULL);CHKERRQ(ierr);
+  if (single) {nd = 1; idle = PETSC_FALSE;}
+
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rdm);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rdm);CHKERRQ(ierr);
+  ierr = MatCreateAIJ(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,n*n,n*n,9,NULL,6,NULL,&A);CHKERRQ(ierr);
+  ierr = FillMatrix(A,n,rdm);CHKERRQ(ierr);
+
+  /* subdomains: pieces of the local rows grown by the overlap; the columns are the rows,
+     the rows reversed (unsorted), or all the columns */
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  nis  = (idle && rank == size-1) ? 0 : nd;
+  ierr = PetscMalloc2(nis,&isrow,nis,&iscol);CHKERRQ(ierr);
+  for (i=0; i<nis; i++) {
+    len  = (rend-rstart)/nis;
+    ierr = ISCreateStride(PETSC_COMM_SELF,len,rstart+i*len,1,&isrow[i]);CHKERRQ(ierr);
+  }
+  ierr = MatIncreaseOverlap(A,nis,isrow,ov);CHKERRQ(ierr);
+  for (i=0; i<nis; i++) {
+    ierr = ISSort(isrow[i]);CHKERRQ(ierr);
+    if ((i+coltype)%3 == 2) {
+      ierr = ISCreateStride(PETSC_COMM_SELF,n*n,0,1,&iscol[i]);CHKERRQ(ierr);
+    } else if ((i+coltype)%3 == 1) {
+      ierr = ISGetLocalSize(isrow[i],&len);CHKERRQ(ierr);
+      ierr = ISGetIndices(isrow[i],&rows);CHKERRQ(ierr);
+      ierr = PetscMalloc1(len,&idx);CHKERRQ(ierr);
+      for (j=0; j<len; j++) idx[j] = rows[len-1-j];
+      ierr = ISRestoreIndices(isrow[i],&rows);CHKERRQ(ierr);
+      ierr = ISCreateGeneral(PETSC_COMM_SELF,len,idx,PETSC_OWN_POINTER,&iscol[i]);CHKERRQ(ierr);
+    } else {
+      ierr = ISDuplicate(isrow[i],&iscol[i]);CHKERRQ(ierr);
+    }
+  }
+
+  /* the reused submatrices must equal newly extracted ones after each change of the values;
+     MAT_SUBMAT_SINGLEIS only holds for the next extraction, reuse follows the original one */
+  if (single) {ierr = MatSetOption(A,MAT_SUBMAT_SINGLEIS,PETSC_TRUE);CHKERRQ(ierr);}
+  ierr = MatCreateSubMatrices(A,nis,isrow,iscol,MAT_INITIAL_MATRIX,&sub);CHKERRQ(ierr);
+  for (it=0; it<3; it++) {
+    ierr = FillMatrix(A,n,rdm);CHKERRQ(ierr);
+    ierr = MatCreateSubMatrices(A,nis,isrow,iscol,MAT_REUSE_MATRIX,&sub);CHKERRQ(ierr);
+    if (single) {ierr = MatSetOption(A,MAT_SUBMAT_SINGLEIS,PETSC_TRUE);CHKERRQ(ierr);}
+    ierr = MatCreateSubMatrices(A,nis,isrow,iscol,MAT_INITIAL_MATRIX,&ref);CHKERRQ(ierr);
+    for (i=0; i<nis; i++) {
+      ierr = MatEqual(sub[i],ref[i],&flg);CHKERRQ(ierr);
+      if (!flg) same = PETSC_FALSE;
+    }
+    ierr = MatDestroySubMatrices(nis,&ref);CHKERRQ(ierr);
+  }
+  ierr = MPIU_Allreduce(&same,&allsame,1,MPIU_BOOL,MPI_LAND,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Reused submatrices %s\n",allsame ? "agree" : "differ");CHKERRQ(ierr);
+
+  ierr = MatDestroySubMatrices(nis,&sub);CHKERRQ(ierr);
+  for (i=0; i<nis; i++) {
+    ierr = ISDestroy(&isrow[i]);CHKERRQ(ierr);
+    ierr = ISDestroy(&iscol[i]);CHKERRQ(ierr);
+  }
+  ierr = PetscFree2(isrow,iscol);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rdm);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
@@ -0,0 +1,79 @@
+
+static char help[] = "Tests the scalable MatIncreaseOverlap() of MPIAIJ matrices against the default algorithm.\n\
+  -n <n>      : the matrix is a five point stencil on an n by n grid with some random long range couplings\n\
+  -nd <nd>    : number of index sets on each process\n\
+  -ov <ov>    : largest overlap tested\n\n";
+
+#include <petscmat.h>
+
+int main(int argc,char **argv)
+{
+  Mat            A;
+  IS             *is,*iss;
+  PetscInt       n = 16,nd = 3,ov = 3,o,i,j,row,rstart,rend,col[6],nc,len,*idx;
+  PetscScalar    v[6],r;
+  PetscBool      flg,same = PETSC_TRUE,allsame;
+  PetscRandom    rdm;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-nd",&nd,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-ov",&ov,NULL);CHKERRQ(ierr);
+
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rdm);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rdm);CHKERRQ(ierr);
+  ierr = MatCreateAIJ(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,n*n,n*n,6,NULL,6,NULL,&A);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  for (row=rstart; row<rend; row++) {
+    nc = 0;
+    if (row >= n)      {col[nc] = row-n; v[nc++] = -1.0;}
+    if (row%n)         {col[nc] = row-1; v[nc++] = -1.0;}
+    col[nc] = row; v[nc++] = 4.0;
+    if ((row+1)%n)     {col[nc] = row+1; v[nc++] = -1.0;}
+    if (row+n < n*n)   {col[nc] = row+n; v[nc++] = -1.0;}
+    ierr = PetscRandomGetValue(rdm,&r);CHKERRQ(ierr);
+    if (PetscRealPart(r) < 0.1) {
+      ierr = PetscRandomGetValue(rdm,&r);CHKERRQ(ierr);
+      col[nc] = (PetscInt)(PetscRealPart(r)*n*n); v[nc++] = 0.1;
+    }
+    ierr = MatSetValues(A,1,&row,nc,col,v,ADD_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  /* random index sets, with duplicates and rows of other processes */
+  ierr = PetscMalloc3(nd,&is,nd,&iss,n*n,&idx);CHKERRQ(ierr);
+  for (o=1; o<=ov; o++) {
+    for (i=0; i<nd; i++) {
+      ierr = PetscRandomGetValue(rdm,&r);CHKERRQ(ierr);
+      len  = 1 + (PetscInt)(PetscRealPart(r)*(rend-rstart));
+      for (j=0; j<len; j++) {
+        ierr   = PetscRandomGetValue(rdm,&r);CHKERRQ(ierr);
+        idx[j] = (PetscInt)(PetscRealPart(r)*n*n);
+      }
+      ierr = ISCreateGeneral(PETSC_COMM_SELF,len,idx,PETSC_COPY_VALUES,&is[i]);CHKERRQ(ierr);
+      ierr = ISCreateGeneral(PETSC_COMM_SELF,len,idx,PETSC_COPY_VALUES,&iss[i]);CHKERRQ(ierr);
+    }
+    ierr = MatMPIAIJSetUseScalableIncreaseOverlap(A,PETSC_FALSE);CHKERRQ(ierr);
+    ierr = MatIncreaseOverlap(A,nd,is,o);CHKERRQ(ierr);
+    ierr = MatMPIAIJSetUseScalableIncreaseOverlap(A,PETSC_TRUE);CHKERRQ(ierr);
+    ierr = MatIncreaseOverlap(A,nd,iss,o);CHKERRQ(ierr);
+    for (i=0; i<nd; i++) {
+      ierr = ISSort(is[i]);CHKERRQ(ierr);
+      ierr = ISSort(iss[i]);CHKERRQ(ierr);
+      ierr = ISEqual(is[i],iss[i],&flg);CHKERRQ(ierr);
+      if (!flg) same = PETSC_FALSE;
+      ierr = ISDestroy(&is[i]);CHKERRQ(ierr);
+      ierr = ISDestroy(&iss[i]);CHKERRQ(ierr);
+    }
+    ierr = MPIU_Allreduce(&same,&allsame,1,MPIU_BOOL,MPI_LAND,PETSC_COMM_WORLD);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Overlap %D: scalable index sets %s\n",o,allsame ? "agree" : "differ");CHKERRQ(ierr);
+  }
+
+  ierr = PetscFree3(is,iss,idx);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rdm);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
@@ -0,0 +1,139 @@
+
+static char help[] = "Tests MatMatMult() and MatTransposeMatMult() of AIJ and dense matrices against MatMult() and MatMultTranspose().\n\
+  -m <m>      : number of rows of the sparse matrix\n\
+  -n <n>      : number of columns of the sparse matrix\n\
+  -empty      : leave three of every four rows of the sparse matrix empty\n\
+  -lda <l>    : extra leading dimension of the sequential dense matrices\n\n";
+
+#include <petscmat.h>
+
+/* sets random entries in B, whose array is given when its leading dimension is not its number of rows */
+static PetscErrorCode FillDense(Mat B,PetscInt lda,PetscScalar *array,PetscRandom rdm)
+{
+  PetscInt       i,j,M,N;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!array) {
+    ierr = MatSetRandom(B,rdm);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = MatGetSize(B,&M,&N);CHKERRQ(ierr);
+  for (j=0; j<N; j++) {
+    for (i=0; i<M; i++) {ierr = PetscRandomGetValue(rdm,&array[j*(M+lda)+i]);CHKERRQ(ierr);}
+  }
+  PetscFunctionReturn(0);
+}
+
+/* creates a dense matrix with the given local rows and random entries, with a larger leading dimension when requested */
+static PetscErrorCode CreateDense(PetscInt m,PetscInt M,PetscInt N,PetscInt lda,PetscRandom rdm,PetscScalar **array,Mat *B)
+{
+  PetscMPIInt    size;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  *array = NULL;
+  ierr   = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  if (size == 1 && lda) {
+    ierr = PetscCalloc1((M+lda)*N,array);CHKERRQ(ierr);
+    ierr = MatCreateSeqDense(PETSC_COMM_SELF,M,N,*array,B);CHKERRQ(ierr);
+    ierr = MatSeqDenseSetLDA(*B,M+lda);CHKERRQ(ierr);
+  } else {
+    ierr = MatCreateDense(PETSC_COMM_WORLD,m,PETSC_DECIDE,M,N,NULL,B);CHKERRQ(ierr);
+  }
+  ierr = FillDense(*B,lda,*array,rdm);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* largest relative difference between the columns of C and op(A) times the columns of B */
+static PetscErrorCode CheckColumns(Mat A,Mat B,Mat C,PetscBool trans,PetscReal *err)
+{
+  Vec            x,y,z;
+  PetscInt       j,N;
+  PetscReal      nrm,e;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (trans) {ierr = MatCreateVecs(A,&y,&x);CHKERRQ(ierr);}
+  else       {ierr = MatCreateVecs(A,&x,&y);CHKERRQ(ierr);}
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = MatGetSize(B,NULL,&N);CHKERRQ(ierr);
+  *err = 0.0;
+  for (j=0; j<N; j++) {
+    ierr = MatGetColumnVector(B,x,j);CHKERRQ(ierr);
+    if (trans) {ierr = MatMultTranspose(A,x,y);CHKERRQ(ierr);}
+    else       {ierr = MatMult(A,x,y);CHKERRQ(ierr);}
+    ierr = MatGetColumnVector(C,z,j);CHKERRQ(ierr);
+    ierr = VecNorm(y,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+    ierr = VecAXPY(z,-1.0,y);CHKERRQ(ierr);
+    ierr = VecNorm(z,NORM_INFINITY,&e);CHKERRQ(ierr);
+    *err = PetscMax(*err,e/PetscMax(nrm,1.0));
+  }
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **argv)
+{
+  Mat            A,B,C;
+  PetscInt       m = 37,n = 29,lda = 0,ncols[4] = {1,5,8,13},i,k,nc,row,rstart,rend,mloc,nloc,col[5];
+  PetscScalar    v[5],r,*array;
+  PetscReal      err,terr;
+  PetscBool      empty = PETSC_FALSE;
+  PetscRandom    rdm;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-lda",&lda,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-empty",&empty,NULL);CHKERRQ(ierr);
+
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rdm);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rdm);CHKERRQ(ierr);
+  ierr = MatCreateAIJ(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,m,n,5,NULL,5,NULL,&A);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  for (row=rstart; row<rend; row++) {
+    if (empty && row%4) continue;
+    nc = 1 + row%5;
+    for (i=0; i<nc; i++) {
+      ierr   = PetscRandomGetValue(rdm,&r);CHKERRQ(ierr);
+      col[i] = (PetscInt)(PetscRealPart(r)*n);
+      ierr   = PetscRandomGetValue(rdm,&v[i]);CHKERRQ(ierr);
+    }
+    ierr = MatSetValues(A,1,&row,nc,col,v,ADD_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(A,&mloc,&nloc);CHKERRQ(ierr);
+
+  /* the product is computed twice, the second time reusing C after new values of B */
+  for (k=0; k<4; k++) {
+    ierr = CreateDense(nloc,n,ncols[k],lda,rdm,&array,&B);CHKERRQ(ierr);
+    ierr = MatMatMult(A,B,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&C);CHKERRQ(ierr);
+    ierr = FillDense(B,lda,array,rdm);CHKERRQ(ierr);
+    ierr = MatMatMult(A,B,MAT_REUSE_MATRIX,PETSC_DEFAULT,&C);CHKERRQ(ierr);
+    ierr = CheckColumns(A,B,C,PETSC_FALSE,&err);CHKERRQ(ierr);
+    ierr = MatDestroy(&B);CHKERRQ(ierr);
+    ierr = MatDestroy(&C);CHKERRQ(ierr);
+    ierr = PetscFree(array);CHKERRQ(ierr);
+
+    ierr = CreateDense(mloc,m,ncols[k],lda,rdm,&array,&B);CHKERRQ(ierr);
+    ierr = MatTransposeMatMult(A,B,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&C);CHKERRQ(ierr);
+    ierr = FillDense(B,lda,array,rdm);CHKERRQ(ierr);
+    ierr = MatTransposeMatMult(A,B,MAT_REUSE_MATRIX,PETSC_DEFAULT,&C);CHKERRQ(ierr);
+    ierr = CheckColumns(A,B,C,PETSC_TRUE,&terr);CHKERRQ(ierr);
+    ierr = MatDestroy(&B);CHKERRQ(ierr);
+    ierr = MatDestroy(&C);CHKERRQ(ierr);
+    ierr = PetscFree(array);CHKERRQ(ierr);
+
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"%D columns: A*B %s, A^T*B %s\n",ncols[k],err < PETSC_SMALL ? "agrees" : "differs",terr < PETSC_SMALL ? "agrees" : "differs");CHKERRQ(ierr);
+  }
+
+  ierr = PetscRandomDestroy(&rdm);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
@@ -0,0 +1,116 @@
+
+static char help[] = "Tests MatTranspose() of MPIAIJ matrices, including MAT_REUSE_MATRIX and MAT_INPLACE_MATRIX.\n\
+  -m <m>      : number of rows of the matrix\n\
+  -n <n>      : number of columns of the matrix\n\n";
+
+#include <petscmat.h>
+
+/* random entries with a fixed nonzero structure, some rows and columns are empty, more of them with sparser */
+static PetscErrorCode FillMatrix(Mat A,PetscRandom rdm,PetscBool sparser)
+{
+  PetscInt       row,rstart,rend,N,nc,i,col[4];
+  PetscScalar    v[4];
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  ierr = MatGetSize(A,NULL,&N);CHKERRQ(ierr);
+  for (row=rstart; row<rend; row++) {
+    if (row%7 == 3 || (sparser && row%5 == 1)) continue;
+    nc = 0;
+    for (i=0; i<4; i++) {
+      col[nc] = ((i+1)*(row+3)*(row+5)/(i+2)) % N;
+      if (col[nc]%11 != 2 && !(sparser && i == 2)) nc++;
+    }
+    for (i=0; i<nc; i++) {ierr = PetscRandomGetValue(rdm,&v[i]);CHKERRQ(ierr);}
+    ierr = MatSetValues(A,1,&row,nc,col,v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* compares At*x with the transpose of A applied to x, and checks that no memory of At is left unused */
+static PetscErrorCode CheckTranspose(Mat A,Mat At,const char *name)
+{
+  Vec            x,y,z;
+  PetscReal      nrm,err;
+  MatInfo        info;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreateVecs(A,&y,&x);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,NULL);CHKERRQ(ierr);
+  ierr = MatMultTranspose(A,x,y);CHKERRQ(ierr);
+  ierr = MatMult(At,x,z);CHKERRQ(ierr);
+  ierr = VecNorm(y,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  ierr = VecAXPY(z,-1.0,y);CHKERRQ(ierr);
+  ierr = VecNorm(z,NORM_INFINITY,&err);CHKERRQ(ierr);
+  ierr = MatGetInfo(At,MAT_GLOBAL_SUM,&info);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: transpose %s, %g unneeded nonzeros\n",name,err < PETSC_SMALL*PetscMax(nrm,1.0) ? "agrees" : "differs",(double)info.nz_unneeded);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **argv)
+{
+  Mat            A,At,Att,B;
+  PetscInt       m = 31,n = 23;
+  PetscBool      flg;
+  PetscRandom    rdm;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rdm);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rdm);CHKERRQ(ierr);
+
+  ierr = MatCreateAIJ(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,m,n,4,NULL,4,NULL,&A);CHKERRQ(ierr);
+  ierr = FillMatrix(A,rdm,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatTranspose(A,MAT_INITIAL_MATRIX,&At);CHKERRQ(ierr);
+  ierr = CheckTranspose(A,At,"initial");CHKERRQ(ierr);
+
+  /* new values in A are moved into the same At */
+  ierr = FillMatrix(A,rdm,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatTranspose(A,MAT_REUSE_MATRIX,&At);CHKERRQ(ierr);
+  ierr = CheckTranspose(A,At,"reuse");CHKERRQ(ierr);
+
+  /* a duplicate of At does not carry the saved communication pattern */
+  ierr = MatDuplicate(At,MAT_DO_NOT_COPY_VALUES,&B);CHKERRQ(ierr);
+  ierr = FillMatrix(A,rdm,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatTranspose(A,MAT_REUSE_MATRIX,&B);CHKERRQ(ierr);
+  ierr = CheckTranspose(A,B,"reuse of a duplicate");CHKERRQ(ierr);
+  ierr = MatTranspose(B,MAT_INITIAL_MATRIX,&Att);CHKERRQ(ierr);
+  ierr = MatEqual(A,Att,&flg);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"transpose twice: %s\n",flg ? "equal" : "differs");CHKERRQ(ierr);
+  ierr = MatDestroy(&Att);CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+
+  /* a matrix with a smaller nonzero pattern, the saved communication pattern of At must not be used */
+  ierr = MatCreateAIJ(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,m,n,4,NULL,4,NULL,&B);CHKERRQ(ierr);
+  ierr = FillMatrix(B,rdm,PETSC_TRUE);CHKERRQ(ierr);
+  ierr = MatTranspose(B,MAT_REUSE_MATRIX,&At);CHKERRQ(ierr);
+  ierr = MatTranspose(B,MAT_REUSE_MATRIX,&At);CHKERRQ(ierr);
+  ierr = CheckTranspose(B,At,"reuse for another pattern");CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+  ierr = MatDestroy(&At);CHKERRQ(ierr);
+
+  /* in place, for a square matrix */
+  ierr = MatCreateAIJ(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,m,m,4,NULL,4,NULL,&B);CHKERRQ(ierr);
+  ierr = FillMatrix(B,rdm,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatTranspose(B,MAT_INITIAL_MATRIX,&At);CHKERRQ(ierr);
+  ierr = MatTranspose(B,MAT_INPLACE_MATRIX,&B);CHKERRQ(ierr);
+  ierr = MatEqual(B,At,&flg);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"in place: %s\n",flg ? "equal" : "differs");CHKERRQ(ierr);
+  ierr = MatDestroy(&At);CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+
+  ierr = PetscRandomDestroy(&rdm);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
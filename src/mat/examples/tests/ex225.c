@@ -0,0 +1,87 @@
+
+static char help[] = "Tests repeated assembly of MPIAIJ matrices whose nonzero pattern is frozen with MatMPIAIJSetFrozenPattern().\n\
+  -n <n>      : the matrix is assembled from the bilinear elements of an n by n grid of nodes\n\n";
+
+#include <petscmat.h>
+
+/*
+   Adds the element matrices of the elements of this process, which are distributed independently of the rows
+   so that many entries belong to other processes; a flush assembly is done halfway when requested
+*/
+static PetscErrorCode AssembleMatrix(Mat A,PetscInt n,PetscInt it,PetscBool flush)
+{
+  PetscInt       ne = (n-1)*(n-1),estart,eend,e,i,j,k,l,idx[4];
+  PetscScalar    v[16];
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatZeroEntries(A);CHKERRQ(ierr);
+  eend = PETSC_DECIDE;
+  ierr = PetscSplitOwnership(PETSC_COMM_WORLD,&eend,&ne);CHKERRQ(ierr);
+  ierr = MPI_Scan(&eend,&estart,1,MPIU_INT,MPI_SUM,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  estart -= eend; eend += estart;
+  for (e=ne-1-estart; e>=ne-eend; e--) {
+    i      = e/(n-1); j = e%(n-1);
+    idx[0] = i*n+j; idx[1] = idx[0]+1; idx[2] = idx[0]+n; idx[3] = idx[2]+1;
+    for (k=0; k<4; k++) {
+      for (l=0; l<4; l++) v[4*k+l] = (k == l) ? 4 + it : -((e+k+l+it)%3);
+    }
+    ierr = MatSetValues(A,4,idx,4,idx,v,ADD_VALUES);CHKERRQ(ierr);
+    if (flush && e == ne-1-(estart+eend)/2) {
+      ierr = MatAssemblyBegin(A,MAT_FLUSH_ASSEMBLY);CHKERRQ(ierr);
+      ierr = MatAssemblyEnd(A,MAT_FLUSH_ASSEMBLY);CHKERRQ(ierr);
+    }
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **argv)
+{
+  Mat            A,F;
+  PetscInt       n = 9,it,row = 0,col;
+  PetscMPIInt    rank;
+  PetscScalar    one = 1.0;
+  PetscBool      flg;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = MatCreateAIJ(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,n*n,n*n,9,NULL,9,NULL,&A);CHKERRQ(ierr);
+  ierr = MatCreateAIJ(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,n*n,n*n,9,NULL,9,NULL,&F);CHKERRQ(ierr);
+
+  /* the entries are integers, so the sums do not depend on the order of the additions; the pattern is
+     frozen by the second assembly, after new nonzero locations have been turned off */
+  for (it=0; it<4; it++) {
+    ierr = AssembleMatrix(A,n,it,PETSC_FALSE);CHKERRQ(ierr);
+    ierr = AssembleMatrix(F,n,it,(PetscBool)(it%2 == 0));CHKERRQ(ierr);
+    ierr = MatEqual(A,F,&flg);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Assembly %D: frozen pattern matrix %s\n",it,flg ? "agrees" : "differs");CHKERRQ(ierr);
+    if (!it) {
+      ierr = MatSetOption(F,MAT_NEW_NONZERO_LOCATIONS,PETSC_FALSE);CHKERRQ(ierr);
+      ierr = MatMPIAIJSetFrozenPattern(F,PETSC_TRUE);CHKERRQ(ierr);
+    }
+  }
+
+  /* back to the usual assembly, which ignores new nonzero locations again */
+  ierr = MatMPIAIJSetFrozenPattern(F,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = AssembleMatrix(F,n,4,PETSC_TRUE);CHKERRQ(ierr);
+  ierr = AssembleMatrix(A,n,4,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatEqual(A,F,&flg);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Unfrozen: matrix %s\n",flg ? "agrees" : "differs");CHKERRQ(ierr);
+  if (!rank) {
+    col  = n+3;
+    ierr = MatSetValues(F,1,&row,1,&col,&one,ADD_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(F,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(F,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatEqual(A,F,&flg);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Unfrozen: new nonzero location %s\n",flg ? "ignored" : "inserted");CHKERRQ(ierr);
+
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&F);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
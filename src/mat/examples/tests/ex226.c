@@ -0,0 +1,152 @@
+
+static char help[] = "Tests MatMult(), MatMultAdd() and MatSOR() of MPIAIJ matrices with the locality reordering of MatMPIAIJSetLocalityReordering().\n\
+  -n <n>      : the matrix is a five point stencil on an n by n grid whose numbering is scrambled on each process\n\n";
+
+#include <petscmat.h>
+
+/* number of the node g of the grid; the nodes of each process are numbered in a scrambled order */
+static PetscInt Number(const PetscInt *ranges,PetscMPIInt size,PetscInt g)
+{
+  PetscMPIInt p;
+  PetscInt    len,s,a,b,t;
+
+  for (p=0; g >= ranges[p+1]; p++) ;
+  len = ranges[p+1] - ranges[p];
+  for (s=len/2+1; ; s++) { /* a multiplier prime to len */
+    for (a=s, b=len; b; t=a%b, a=b, b=t) ;
+    if (a == 1) break;
+  }
+  return ranges[p] + ((g-ranges[p])*s)%len;
+}
+
+static PetscErrorCode CreateMatrix(PetscInt n,Mat *A)
+{
+  const PetscInt *ranges;
+  PetscInt       g,i,j,row,cols[5],nc,rstart,rend;
+  PetscScalar    v[5];
+  PetscMPIInt    size;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  ierr = MatCreateAIJ(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,n*n,n*n,5,NULL,5,NULL,A);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRanges(*A,&ranges);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(*A,&rstart,&rend);CHKERRQ(ierr);
+  for (g=rstart; g<rend; g++) {
+    i   = g/n; j = g%n; nc = 0;
+    row = Number(ranges,size,g);
+    if (i > 0)   {cols[nc] = Number(ranges,size,g-n); v[nc++] = -1.0;}
+    if (j > 0)   {cols[nc] = Number(ranges,size,g-1); v[nc++] = -2.0;}
+    cols[nc] = row; v[nc++] = 12.0;
+    if (j < n-1) {cols[nc] = Number(ranges,size,g+1); v[nc++] = -2.0;}
+    if (i < n-1) {cols[nc] = Number(ranges,size,g+n); v[nc++] = -1.0;}
+    ierr = MatSetValues(*A,1,&row,nc,cols,v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(*A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(*A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* residual norm after its local symmetric sweeps from a zero initial guess */
+static PetscErrorCode SORResidual(Mat A,Vec b,PetscInt its,Vec x,PetscReal *rnorm)
+{
+  Vec            r;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecDuplicate(b,&r);CHKERRQ(ierr);
+  ierr = MatSOR(A,b,1.0,(MatSORType)(SOR_LOCAL_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),0.0,its,1,x);CHKERRQ(ierr);
+  ierr = MatMult(A,x,r);CHKERRQ(ierr);
+  ierr = VecAYPX(r,-1.0,b);CHKERRQ(ierr);
+  ierr = VecNorm(r,NORM_2,rnorm);CHKERRQ(ierr);
+  ierr = VecDestroy(&r);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode Test(PetscInt n,MatOrderingType type)
+{
+  Mat            A,R;
+  Vec            x,y,w,z,yr,zr;
+  PetscInt       i,rstart,rend,it;
+  PetscReal      bnorm,rnorm,rrnorm;
+  PetscBool      flg,same = PETSC_TRUE;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = CreateMatrix(n,&A);CHKERRQ(ierr);
+  ierr = CreateMatrix(n,&R);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetLocalityReordering(R,type);CHKERRQ(ierr);
+  ierr = MatCreateVecs(A,&x,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&w);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&yr);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&zr);CHKERRQ(ierr);
+  ierr = VecGetOwnershipRange(x,&rstart,&rend);CHKERRQ(ierr);
+  for (i=rstart; i<rend; i++) {
+    ierr = VecSetValue(x,i,(PetscScalar)(i%7-3),INSERT_VALUES);CHKERRQ(ierr);
+    ierr = VecSetValue(w,i,(PetscScalar)(i%5),INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = VecAssemblyBegin(x);CHKERRQ(ierr);
+  ierr = VecAssemblyEnd(x);CHKERRQ(ierr);
+  ierr = VecAssemblyBegin(w);CHKERRQ(ierr);
+  ierr = VecAssemblyEnd(w);CHKERRQ(ierr);
+
+  /* the entries are integers, so the products do not depend on the order of the additions; the values of
+     the matrices are changed between the products */
+  for (it=0; it<3; it++) {
+    if (it == 1) {
+      ierr = MatScale(A,2.0);CHKERRQ(ierr);
+      ierr = MatScale(R,2.0);CHKERRQ(ierr);
+    } else if (it == 2) {
+      ierr = MatShift(A,1.0);CHKERRQ(ierr);
+      ierr = MatShift(R,1.0);CHKERRQ(ierr);
+    }
+    ierr = MatMult(A,x,y);CHKERRQ(ierr);
+    ierr = MatMult(R,x,yr);CHKERRQ(ierr);
+    ierr = VecEqual(y,yr,&flg);CHKERRQ(ierr);
+    if (!flg) same = PETSC_FALSE;
+    ierr = MatMultAdd(A,x,w,z);CHKERRQ(ierr);
+    ierr = MatMultAdd(R,x,w,zr);CHKERRQ(ierr);
+    ierr = VecEqual(z,zr,&flg);CHKERRQ(ierr);
+    if (!flg) same = PETSC_FALSE;
+    ierr = VecCopy(w,zr);CHKERRQ(ierr);
+    ierr = MatMultAdd(R,x,zr,zr);CHKERRQ(ierr);
+    ierr = VecEqual(z,zr,&flg);CHKERRQ(ierr);
+    if (!flg) same = PETSC_FALSE;
+  }
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: products %s\n",type,same ? "agree" : "differ");CHKERRQ(ierr);
+
+  /* the sweeps are in the new ordering, they reduce the residual about as much as in the original numbering */
+  ierr = VecNorm(w,NORM_2,&bnorm);CHKERRQ(ierr);
+  ierr = SORResidual(A,w,10,y,&rnorm);CHKERRQ(ierr);
+  ierr = SORResidual(R,w,10,yr,&rrnorm);CHKERRQ(ierr);
+  ierr = VecEqual(y,yr,&flg);CHKERRQ(ierr);
+  if (rrnorm > 1.e-3*bnorm) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: SOR residual %g\n",type,(double)(rrnorm/bnorm));CHKERRQ(ierr);
+  } else {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: SOR converges, %s the original numbering\n",type,flg ? "same iterates as" : "different iterates from");CHKERRQ(ierr);
+  }
+
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&R);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&w);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = VecDestroy(&yr);CHKERRQ(ierr);
+  ierr = VecDestroy(&zr);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **argv)
+{
+  PetscInt       n = 12;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = Test(n,MATORDERINGNATURAL);CHKERRQ(ierr);
+  ierr = Test(n,MATORDERINGRCM);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
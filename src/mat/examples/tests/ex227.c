@@ -0,0 +1,153 @@
+
+static char help[] = "Tests MatFDColoringApply() with a function that evaluates several points at once, see MatFDColoringSetFunctionBatch().\n\
+  -n <n>      : the function is A x + x^3, with A a five point stencil on an n by n grid\n\n";
+
+#include <petscmat.h>
+
+typedef struct {
+  Mat      A;
+  PetscInt nf,nbatch,nbatchpoints; /* calls of the function and of the batch function, points given to the latter */
+} AppCtx;
+
+static PetscErrorCode Evaluate(Mat A,Vec x,Vec y)
+{
+  const PetscScalar *xx;
+  PetscScalar       *yy;
+  PetscInt          i,n;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatMult(A,x,y);CHKERRQ(ierr);
+  ierr = VecGetLocalSize(x,&n);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(x,&xx);CHKERRQ(ierr);
+  ierr = VecGetArray(y,&yy);CHKERRQ(ierr);
+  for (i=0; i<n; i++) yy[i] += xx[i]*xx[i]*xx[i];
+  ierr = VecRestoreArray(y,&yy);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(x,&xx);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode Function(void *sctx,Vec x,Vec y,void *ctx)
+{
+  AppCtx         *user = (AppCtx*)ctx;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  user->nf++;
+  ierr = Evaluate(user->A,x,y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode FunctionBatch(void *sctx,PetscInt n,Vec x[],Vec y[],void *ctx)
+{
+  AppCtx         *user = (AppCtx*)ctx;
+  PetscInt       i;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  user->nbatch++;
+  user->nbatchpoints += n;
+  for (i=0; i<n; i++) {
+    ierr = Evaluate(user->A,x[i],y[i]);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+int main(int argc,char **argv)
+{
+  AppCtx         user;
+  Mat            J,Jb,Jexact;
+  Vec            x,d;
+  MatColoring    mc;
+  ISColoring     iscoloring;
+  MatFDColoring  fd,fdb;
+  PetscInt       n = 10,i,row,rstart,rend,cols[5],nc,ncolors;
+  PetscScalar    v[5];
+  PetscReal      nrm,err;
+  PetscBool      flg;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscMemzero(&user,sizeof(user));CHKERRQ(ierr);
+
+  ierr = MatCreateAIJ(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,n*n,n*n,5,NULL,2,NULL,&user.A);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(user.A,&rstart,&rend);CHKERRQ(ierr);
+  for (row=rstart; row<rend; row++) {
+    nc = 0;
+    if (row >= n)    {cols[nc] = row-n; v[nc++] = -1.0;}
+    if (row%n)       {cols[nc] = row-1; v[nc++] = -2.0;}
+    cols[nc] = row; v[nc++] = 4.0;
+    if ((row+1)%n)   {cols[nc] = row+1; v[nc++] = -1.0;}
+    if (row+n < n*n) {cols[nc] = row+n; v[nc++] = -3.0;}
+    ierr = MatSetValues(user.A,1,&row,nc,cols,v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(user.A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(user.A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatDuplicate(user.A,MAT_DO_NOT_COPY_VALUES,&J);CHKERRQ(ierr);
+  ierr = MatDuplicate(user.A,MAT_DO_NOT_COPY_VALUES,&Jb);CHKERRQ(ierr);
+
+  ierr = MatCreateVecs(user.A,&x,&d);CHKERRQ(ierr);
+  for (row=rstart; row<rend; row++) {
+    ierr = VecSetValue(x,row,1.0+0.1*(row%7),INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = VecAssemblyBegin(x);CHKERRQ(ierr);
+  ierr = VecAssemblyEnd(x);CHKERRQ(ierr);
+
+  /* the Jacobian A + 3 diag(x^2) */
+  ierr = MatDuplicate(user.A,MAT_COPY_VALUES,&Jexact);CHKERRQ(ierr);
+  ierr = VecPointwiseMult(d,x,x);CHKERRQ(ierr);
+  ierr = VecScale(d,3.0);CHKERRQ(ierr);
+  ierr = MatDiagonalSet(Jexact,d,ADD_VALUES);CHKERRQ(ierr);
+
+  ierr = MatColoringCreate(user.A,&mc);CHKERRQ(ierr);
+  ierr = MatColoringSetType(mc,MATCOLORINGSL);CHKERRQ(ierr);
+  ierr = MatColoringSetDistance(mc,2);CHKERRQ(ierr);
+  ierr = MatColoringApply(mc,&iscoloring);CHKERRQ(ierr);
+  ierr = MatColoringDestroy(&mc);CHKERRQ(ierr);
+
+  /* the same coloring, one point at a time and in batches of four colors */
+  ierr = MatFDColoringCreate(J,iscoloring,&fd);CHKERRQ(ierr);
+  ierr = MatFDColoringSetFunction(fd,(PetscErrorCode (*)(void))Function,&user);CHKERRQ(ierr);
+  ierr = MatFDColoringSetBlockSize(fd,PETSC_DEFAULT,4);CHKERRQ(ierr);
+  ierr = MatFDColoringSetFromOptions(fd);CHKERRQ(ierr);
+  ierr = MatFDColoringSetUp(J,iscoloring,fd);CHKERRQ(ierr);
+  ierr = MatFDColoringCreate(Jb,iscoloring,&fdb);CHKERRQ(ierr);
+  ierr = MatFDColoringSetFunction(fdb,(PetscErrorCode (*)(void))Function,&user);CHKERRQ(ierr);
+  ierr = MatFDColoringSetFunctionBatch(fdb,FunctionBatch,&user);CHKERRQ(ierr);
+  ierr = MatFDColoringSetBlockSize(fdb,PETSC_DEFAULT,4);CHKERRQ(ierr);
+  ierr = MatFDColoringSetFromOptions(fdb);CHKERRQ(ierr);
+  ierr = MatFDColoringSetUp(Jb,iscoloring,fdb);CHKERRQ(ierr);
+  ierr = ISColoringGetIS(iscoloring,&ncolors,NULL);CHKERRQ(ierr);
+  ierr = ISColoringRestoreIS(iscoloring,NULL);CHKERRQ(ierr);
+  ierr = ISColoringDestroy(&iscoloring);CHKERRQ(ierr);
+
+  /* twice, to reuse the work vectors of the batches */
+  for (i=0; i<2; i++) {
+    ierr = MatFDColoringApply(J,fd,x,NULL);CHKERRQ(ierr);
+    ierr = MatFDColoringApply(Jb,fdb,x,NULL);CHKERRQ(ierr);
+    ierr = VecScale(x,1.5);CHKERRQ(ierr);
+  }
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"%D colors: %D calls of the function, %D batched calls with %D points\n",ncolors,user.nf,user.nbatch,user.nbatchpoints);CHKERRQ(ierr);
+  ierr = MatEqual(J,Jb,&flg);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Batched Jacobian %s\n",flg ? "agrees" : "differs");CHKERRQ(ierr);
+  ierr = VecScale(x,1.0/(1.5*1.5));CHKERRQ(ierr);
+  ierr = MatFDColoringApply(Jb,fdb,x,NULL);CHKERRQ(ierr);
+  ierr = MatNorm(Jexact,NORM_FROBENIUS,&nrm);CHKERRQ(ierr);
+  ierr = MatAXPY(Jb,-1.0,Jexact,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+  ierr = MatNorm(Jb,NORM_FROBENIUS,&err);CHKERRQ(ierr);
+  if (err > 1.e-5*nrm) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Batched Jacobian error %g\n",(double)(err/nrm));CHKERRQ(ierr);
+  }
+
+  ierr = MatFDColoringDestroy(&fd);CHKERRQ(ierr);
+  ierr = MatFDColoringDestroy(&fdb);CHKERRQ(ierr);
+  ierr = MatDestroy(&user.A);CHKERRQ(ierr);
+  ierr = MatDestroy(&J);CHKERRQ(ierr);
+  ierr = MatDestroy(&Jb);CHKERRQ(ierr);
+  ierr = MatDestroy(&Jexact);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&d);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
@@ -0,0 +1,145 @@
+
+#include <../src/mat/impls/aij/mpi/mpiaij.h>
+#include <../src/mat/impls/aij/seq/aijdelta/aijdelta.h>
+
+/*@C
+   MatCreateMPIAIJDelta - Creates a sparse parallel matrix whose local
+   portions are stored as SEQAIJDELTA matrices (a matrix class that inherits
+   from SEQAIJ but performs its matrix-vector products with column indices
+   encoded as 16 bit differences).  The same guidelines that apply to MPIAIJ matrices for
+   preallocating the matrix storage apply here as well.
+
+      Collective on MPI_Comm
+
+   Input Parameters:
++  comm - MPI communicator
+.  m - number of local rows (or PETSC_DECIDE to have calculated if M is given)
+           This value should be the same as the local size used in creating the
+           y vector for the matrix-vector product y = Ax.
+.  n - This value should be the same as the local size used in creating the
+       x vector for the matrix-vector product y = Ax. (or PETSC_DECIDE to have
+       calculated if N is given) For square matrices n is almost always m.
+.  M - number of global rows (or PETSC_DETERMINE to have calculated if m is given)
+.  N - number of global columns (or PETSC_DETERMINE to have calculated if n is given)
+.  d_nz  - number of nonzeros per row in DIAGONAL portion of local submatrix
+           (same value is used for all local rows)
+.  d_nnz - array containing the number of nonzeros in the various rows of the
+           DIAGONAL portion of the local submatrix (possibly different for each row)
+           or NULL, if d_nz is used to specify the nonzero structure.
+           The size of this array is equal to the number of local rows, i.e 'm'.
+.  o_nz  - number of nonzeros per row in the OFF-DIAGONAL portion of local
+           submatrix (same value is used for all local rows).
+-  o_nnz - array containing the number of nonzeros in the various rows of the
+           OFF-DIAGONAL portion of the local submatrix (possibly different for
+           each row) or NULL, if o_nz is used to specify the nonzero
+           structure. The size of this array is equal to the number
+           of local rows, i.e 'm'.
+
+   Output Parameter:
+.  A - the matrix
+
+   Notes:
+   If the *_nnz parameter is given then the *_nz parameter is ignored
+
+   The DIAGONAL and OFF-DIAGONAL portions of the local submatrix are each stored as a
+   SEQAIJDELTA matrix.  The columns of the OFF-DIAGONAL portion are numbered consecutively
+   over the ghost values, so their differences are small as well.
+
+   When calling this routine with a single process communicator, a matrix of
+   type SEQAIJDELTA is returned.  If a matrix of type MPIAIJDELTA is desired
+   for this type of communicator, use the construction mechanism:
+     MatCreate(...,&A); MatSetType(A,MPIAIJDELTA); MatMPIAIJSetPreallocation(A,...);
+
+   Level: intermediate
+
+.keywords: matrix, compressed, column indices, sparse, parallel
+
+.seealso: MatCreate(), MatCreateSeqAIJDelta(), MatSetValues(), MATMPIAIJDELTA
+@*/
+PetscErrorCode  MatCreateMPIAIJDelta(MPI_Comm comm,PetscInt m,PetscInt n,PetscInt M,PetscInt N,PetscInt d_nz,const PetscInt d_nnz[],PetscInt o_nz,const PetscInt o_nnz[],Mat *A)
+{
+  PetscErrorCode ierr;
+  PetscMPIInt    size;
+
+  PetscFunctionBegin;
+  ierr = MatCreate(comm,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,m,n,M,N);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  if (size > 1) {
+    ierr = MatSetType(*A,MATMPIAIJDELTA);CHKERRQ(ierr);
+    ierr = MatMPIAIJSetPreallocation(*A,d_nz,d_nnz,o_nz,o_nnz);CHKERRQ(ierr);
+  } else {
+    ierr = MatSetType(*A,MATSEQAIJDELTA);CHKERRQ(ierr);
+    ierr = MatSeqAIJSetPreallocation(*A,d_nz,d_nnz);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatMPIAIJDelta_ConvertBlocks(Mat B)
+{
+  Mat_MPIAIJ     *b = (Mat_MPIAIJ*)B->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatConvert_SeqAIJ_SeqAIJDelta(b->A,MATSEQAIJDELTA,MAT_INPLACE_MATRIX,&b->A);CHKERRQ(ierr);
+  ierr = MatConvert_SeqAIJ_SeqAIJDelta(b->B,MATSEQAIJDELTA,MAT_INPLACE_MATRIX,&b->B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode  MatMPIAIJSetPreallocation_MPIAIJDelta(Mat B,PetscInt d_nz,const PetscInt d_nnz[],PetscInt o_nz,const PetscInt o_nnz[])
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatMPIAIJSetPreallocation_MPIAIJ(B,d_nz,d_nnz,o_nz,o_nnz);CHKERRQ(ierr);
+  ierr = MatMPIAIJDelta_ConvertBlocks(B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJDelta(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  /* an already preallocated matrix keeps its blocks, which are converted in place */
+  if (((Mat_MPIAIJ*)B->data)->A) {
+    ierr = MatMPIAIJDelta_ConvertBlocks(B);CHKERRQ(ierr);
+  }
+  ierr = PetscObjectChangeTypeName((PetscObject)B,MATMPIAIJDELTA);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatMPIAIJSetPreallocation_C",MatMPIAIJSetPreallocation_MPIAIJDelta);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJDelta(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSetType(A,MATMPIAIJ);CHKERRQ(ierr);
+  ierr = MatConvert_MPIAIJ_MPIAIJDelta(A,MATMPIAIJDELTA,MAT_INPLACE_MATRIX,&A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   MATAIJDELTA - MATAIJDELTA = "aijdelta" - A matrix type to be used for sparse matrices whose
+   matrix-vector products read column indices encoded as 16 bit differences.
+
+   This matrix type is identical to MATSEQAIJDELTA when constructed with a single process communicator,
+   and MATMPIAIJDELTA otherwise.  As a result, for single process communicators,
+  MatSeqAIJSetPreallocation() is supported, and similarly MatMPIAIJSetPreallocation() is supported
+  for communicators controlling multiple processes.  It is recommended that you call both of
+  the above preallocation routines for simplicity.
+
+   Options Database Keys:
+. -mat_type aijdelta - sets the matrix type to "aijdelta" during a call to MatSetFromOptions()
+
+  Level: beginner
+
+.seealso: MatCreateMPIAIJDelta(), MATSEQAIJDELTA, MATMPIAIJDELTA, MATAIJPERM, MATAIJSELL
+M*/
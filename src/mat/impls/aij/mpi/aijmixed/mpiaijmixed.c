@@ -0,0 +1,152 @@
+
+#include <../src/mat/impls/aij/mpi/mpiaij.h>
+#include <../src/mat/impls/aij/seq/aijmixed/aijmixed.h>
+
+/*@C
+   MatCreateMPIAIJMixed - Creates a sparse parallel matrix whose local
+   portions are stored as SEQAIJMIXED matrices (a matrix class that inherits
+   from SEQAIJ but performs its matrix-vector products, SOR sweeps and LU/ILU
+   triangular solves with a single precision copy of the values).  The same guidelines that apply to MPIAIJ matrices for
+   preallocating the matrix storage apply here as well.
+
+      Collective on MPI_Comm
+
+   Input Parameters:
++  comm - MPI communicator
+.  m - number of local rows (or PETSC_DECIDE to have calculated if M is given)
+           This value should be the same as the local size used in creating the
+           y vector for the matrix-vector product y = Ax.
+.  n - This value should be the same as the local size used in creating the
+       x vector for the matrix-vector product y = Ax. (or PETSC_DECIDE to have
+       calculated if N is given) For square matrices n is almost always m.
+.  M - number of global rows (or PETSC_DETERMINE to have calculated if m is given)
+.  N - number of global columns (or PETSC_DETERMINE to have calculated if n is given)
+.  d_nz  - number of nonzeros per row in DIAGONAL portion of local submatrix
+           (same value is used for all local rows)
+.  d_nnz - array containing the number of nonzeros in the various rows of the
+           DIAGONAL portion of the local submatrix (possibly different for each row)
+           or NULL, if d_nz is used to specify the nonzero structure.
+           The size of this array is equal to the number of local rows, i.e 'm'.
+.  o_nz  - number of nonzeros per row in the OFF-DIAGONAL portion of local
+           submatrix (same value is used for all local rows).
+-  o_nnz - array containing the number of nonzeros in the various rows of the
+           OFF-DIAGONAL portion of the local submatrix (possibly different for
+           each row) or NULL, if o_nz is used to specify the nonzero
+           structure. The size of this array is equal to the number
+           of local rows, i.e 'm'.
+
+   Output Parameter:
+.  A - the matrix
+
+   Notes:
+   If the *_nnz parameter is given then the *_nz parameter is ignored
+
+   The DIAGONAL and OFF-DIAGONAL portions of the local submatrix are each stored as a
+   SEQAIJMIXED matrix, so MatMult() and the local sweeps of MatSOR() read single precision
+   values while the ghost values are communicated and summed in double precision.
+
+   When calling this routine with a single process communicator, a matrix of
+   type SEQAIJMIXED is returned.  If a matrix of type MPIAIJMIXED is desired
+   for this type of communicator, use the construction mechanism:
+     MatCreate(...,&A); MatSetType(A,MPIAIJMIXED); MatMPIAIJSetPreallocation(A,...);
+
+   Level: intermediate
+
+.keywords: matrix, mixed precision, single precision, sparse, parallel
+
+.seealso: MatCreate(), MatCreateSeqAIJMixed(), MatSetValues(), MATMPIAIJMIXED
+@*/
+PetscErrorCode  MatCreateMPIAIJMixed(MPI_Comm comm,PetscInt m,PetscInt n,PetscInt M,PetscInt N,PetscInt d_nz,const PetscInt d_nnz[],PetscInt o_nz,const PetscInt o_nnz[],Mat *A)
+{
+  PetscErrorCode ierr;
+  PetscMPIInt    size;
+
+  PetscFunctionBegin;
+  ierr = MatCreate(comm,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,m,n,M,N);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  if (size > 1) {
+    ierr = MatSetType(*A,MATMPIAIJMIXED);CHKERRQ(ierr);
+    ierr = MatMPIAIJSetPreallocation(*A,d_nz,d_nnz,o_nz,o_nnz);CHKERRQ(ierr);
+  } else {
+    ierr = MatSetType(*A,MATSEQAIJMIXED);CHKERRQ(ierr);
+    ierr = MatSeqAIJSetPreallocation(*A,d_nz,d_nnz);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatMPIAIJMixed_ConvertBlocks(Mat B)
+{
+  Mat_MPIAIJ     *b = (Mat_MPIAIJ*)B->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatConvert_SeqAIJ_SeqAIJMixed(b->A,MATSEQAIJMIXED,MAT_INPLACE_MATRIX,&b->A);CHKERRQ(ierr);
+  ierr = MatConvert_SeqAIJ_SeqAIJMixed(b->B,MATSEQAIJMIXED,MAT_INPLACE_MATRIX,&b->B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode  MatMPIAIJSetPreallocation_MPIAIJMixed(Mat B,PetscInt d_nz,const PetscInt d_nnz[],PetscInt o_nz,const PetscInt o_nnz[])
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatMPIAIJSetPreallocation_MPIAIJ(B,d_nz,d_nnz,o_nz,o_nnz);CHKERRQ(ierr);
+  ierr = MatMPIAIJMixed_ConvertBlocks(B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJMixed(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  /* an already preallocated matrix keeps its blocks, which are converted in place */
+  if (((Mat_MPIAIJ*)B->data)->A) {
+    ierr = MatMPIAIJMixed_ConvertBlocks(B);CHKERRQ(ierr);
+  }
+  ierr = PetscObjectChangeTypeName((PetscObject)B,MATMPIAIJMIXED);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatMPIAIJSetPreallocation_C",MatMPIAIJSetPreallocation_MPIAIJMixed);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJMixed(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSetType(A,MATMPIAIJ);CHKERRQ(ierr);
+  ierr = MatConvert_MPIAIJ_MPIAIJMixed(A,MATMPIAIJMIXED,MAT_INPLACE_MATRIX,&A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   MATAIJMIXED - MATAIJMIXED = "aijmixed" - A matrix type to be used for sparse matrices whose
+   products, SOR sweeps and triangular solves read single precision values and accumulate in
+   double precision.
+
+   This matrix type is identical to MATSEQAIJMIXED when constructed with a single process communicator,
+   and MATMPIAIJMIXED otherwise.  As a result, for single process communicators,
+  MatSeqAIJSetPreallocation() is supported, and similarly MatMPIAIJSetPreallocation() is supported
+  for communicators controlling multiple processes.  It is recommended that you call both of
+  the above preallocation routines for simplicity.
+
+   Options Database Keys:
+. -mat_type aijmixed - sets the matrix type to "aijmixed" during a call to MatSetFromOptions()
+
+   Notes:
+   Only available for real double precision builds.  The type is meant for the preconditioning
+   matrix: pass a MATAIJMIXED copy of the operator as the second matrix of KSPSetOperators(),
+   then the SOR smoothers, block Jacobi and ASM subdomain ILU/LU solves read single precision
+   values, since the subdomain matrices and their factors inherit the type.
+
+  Level: beginner
+
+.seealso: MatCreateMPIAIJMixed(), MATSEQAIJMIXED, MATMPIAIJMIXED, MATAIJPERM, MATAIJSELL
+M*/
@@ -0,0 +1,163 @@
+
+#include <../src/mat/impls/aij/mpi/mpiaij.h>
+#include <../src/mat/impls/aij/seq/aijomp/aijomp.h>
+
+/*@C
+   MatCreateMPIAIJOMP - Creates a sparse parallel matrix whose local
+   portions are stored as SEQAIJOMP matrices (a matrix class that inherits
+   from SEQAIJ but performs its matrix-vector products and SOR relaxation with
+   several OpenMP threads).  The same guidelines that apply to MPIAIJ matrices for
+   preallocating the matrix storage apply here as well.
+
+      Collective on MPI_Comm
+
+   Input Parameters:
++  comm - MPI communicator
+.  m - number of local rows (or PETSC_DECIDE to have calculated if M is given)
+           This value should be the same as the local size used in creating the
+           y vector for the matrix-vector product y = Ax.
+.  n - This value should be the same as the local size used in creating the
+       x vector for the matrix-vector product y = Ax. (or PETSC_DECIDE to have
+       calculated if N is given) For square matrices n is almost always m.
+.  M - number of global rows (or PETSC_DETERMINE to have calculated if m is given)
+.  N - number of global columns (or PETSC_DETERMINE to have calculated if n is given)
+.  d_nz  - number of nonzeros per row in DIAGONAL portion of local submatrix
+           (same value is used for all local rows)
+.  d_nnz - array containing the number of nonzeros in the various rows of the
+           DIAGONAL portion of the local submatrix (possibly different for each row)
+           or NULL, if d_nz is used to specify the nonzero structure.
+           The size of this array is equal to the number of local rows, i.e 'm'.
+.  o_nz  - number of nonzeros per row in the OFF-DIAGONAL portion of local
+           submatrix (same value is used for all local rows).
+-  o_nnz - array containing the number of nonzeros in the various rows of the
+           OFF-DIAGONAL portion of the local submatrix (possibly different for
+           each row) or NULL, if o_nz is used to specify the nonzero
+           structure. The size of this array is equal to the number
+           of local rows, i.e 'm'.
+
+   Output Parameter:
+.  A - the matrix
+
+   Options Database Keys:
+.  -mat_aijomp_threads <n> - number of threads per process, defaults to the OpenMP maximum (OMP_NUM_THREADS)
+
+   Notes:
+   If the *_nnz parameter is given then the *_nz parameter is ignored
+
+   The DIAGONAL and OFF-DIAGONAL portions of the local submatrix are each stored as a
+   SEQAIJOMP matrix, so MatMult() overlaps the communication of the ghost values with
+   the threaded product of the diagonal portion, exactly as for MPIAIJ.  This allows one
+   process per socket or node with many threads, which sends fewer and larger messages
+   than one process per core.
+
+   When calling this routine with a single process communicator, a matrix of
+   type SEQAIJOMP is returned.  If a matrix of type MPIAIJOMP is desired
+   for this type of communicator, use the construction mechanism:
+     MatCreate(...,&A); MatSetType(A,MPIAIJOMP); MatMPIAIJSetPreallocation(A,...);
+
+   Level: intermediate
+
+.keywords: matrix, openmp, threads, sparse, parallel
+
+.seealso: MatCreate(), MatCreateSeqAIJOMP(), MatSetValues(), MATMPIAIJOMP
+@*/
+PetscErrorCode  MatCreateMPIAIJOMP(MPI_Comm comm,PetscInt m,PetscInt n,PetscInt M,PetscInt N,PetscInt d_nz,const PetscInt d_nnz[],PetscInt o_nz,const PetscInt o_nnz[],Mat *A)
+{
+  PetscErrorCode ierr;
+  PetscMPIInt    size;
+
+  PetscFunctionBegin;
+  ierr = MatCreate(comm,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,m,n,M,N);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  if (size > 1) {
+    ierr = MatSetType(*A,MATMPIAIJOMP);CHKERRQ(ierr);
+    ierr = MatMPIAIJSetPreallocation(*A,d_nz,d_nnz,o_nz,o_nnz);CHKERRQ(ierr);
+  } else {
+    ierr = MatSetType(*A,MATSEQAIJOMP);CHKERRQ(ierr);
+    ierr = MatSeqAIJSetPreallocation(*A,d_nz,d_nnz);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/* converts the diagonal and off-diagonal blocks, which take the number of threads from the options of the parallel matrix */
+static PetscErrorCode MatMPIAIJOMP_ConvertBlocks(Mat B)
+{
+  Mat_MPIAIJ     *b = (Mat_MPIAIJ*)B->data;
+  PetscInt       nthreads;
+  PetscBool      flg;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatConvert_SeqAIJ_SeqAIJOMP(b->A,MATSEQAIJOMP,MAT_INPLACE_MATRIX,&b->A);CHKERRQ(ierr);
+  ierr = MatConvert_SeqAIJ_SeqAIJOMP(b->B,MATSEQAIJOMP,MAT_INPLACE_MATRIX,&b->B);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(((PetscObject)B)->options,((PetscObject)B)->prefix,"-mat_aijomp_threads",&nthreads,&flg);CHKERRQ(ierr);
+  if (flg) {
+    if (nthreads < 1) SETERRQ1(PetscObjectComm((PetscObject)B),PETSC_ERR_ARG_OUTOFRANGE,"Number of threads %D must be positive",nthreads);
+    ((Mat_SeqAIJOMP*)b->A->spptr)->nthreads     = nthreads;
+    ((Mat_SeqAIJOMP*)b->A->spptr)->nonzerostate = -1;
+    ((Mat_SeqAIJOMP*)b->B->spptr)->nthreads     = nthreads;
+    ((Mat_SeqAIJOMP*)b->B->spptr)->nonzerostate = -1;
+  }
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode  MatMPIAIJSetPreallocation_MPIAIJOMP(Mat B,PetscInt d_nz,const PetscInt d_nnz[],PetscInt o_nz,const PetscInt o_nnz[])
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatMPIAIJSetPreallocation_MPIAIJ(B,d_nz,d_nnz,o_nz,o_nnz);CHKERRQ(ierr);
+  ierr = MatMPIAIJOMP_ConvertBlocks(B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJOMP(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  /* an already preallocated matrix keeps its blocks, which are converted in place */
+  if (((Mat_MPIAIJ*)B->data)->A) {
+    ierr = MatMPIAIJOMP_ConvertBlocks(B);CHKERRQ(ierr);
+  }
+  ierr = PetscObjectChangeTypeName((PetscObject)B,MATMPIAIJOMP);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatMPIAIJSetPreallocation_C",MatMPIAIJSetPreallocation_MPIAIJOMP);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJOMP(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSetType(A,MATMPIAIJ);CHKERRQ(ierr);
+  ierr = MatConvert_MPIAIJ_MPIAIJOMP(A,MATMPIAIJOMP,MAT_INPLACE_MATRIX,&A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   MATAIJOMP - MATAIJOMP = "aijomp" - A matrix type to be used for sparse matrices whose
+   matrix-vector products and SOR relaxation are performed by several OpenMP threads on each process.
+   Requires PETSc to be configured with --with-openmp.
+
+   This matrix type is identical to MATSEQAIJOMP when constructed with a single process communicator,
+   and MATMPIAIJOMP otherwise.  As a result, for single process communicators,
+  MatSeqAIJSetPreallocation() is supported, and similarly MatMPIAIJSetPreallocation() is supported
+  for communicators controlling multiple processes.  It is recommended that you call both of
+  the above preallocation routines for simplicity.
+
+   Options Database Keys:
++ -mat_type aijomp - sets the matrix type to "aijomp" during a call to MatSetFromOptions()
+- -mat_aijomp_threads <n> - number of threads per process
+
+  Level: beginner
+
+.seealso: MatCreateMPIAIJOMP(), MATSEQAIJOMP, MATMPIAIJOMP, MATAIJPERM, MATAIJOMP
+M*/
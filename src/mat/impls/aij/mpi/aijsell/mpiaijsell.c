@@ -0,0 +1,175 @@
+
+#include <../src/mat/impls/aij/mpi/mpiaij.h>
+#include <../src/mat/impls/aij/seq/aijsell/aijsell.h>
+
+/*@C
+   MatCreateMPIAIJSELL - Creates a sparse parallel matrix whose local
+   portions are stored as SEQAIJSELL matrices (a matrix class that inherits
+   from SEQAIJ but performs its matrix-vector products with a sliced ELLPACK
+   copy of the matrix).  The same guidelines that apply to MPIAIJ matrices for
+   preallocating the matrix storage apply here as well.
+
+      Collective on MPI_Comm
+
+   Input Parameters:
++  comm - MPI communicator
+.  m - number of local rows (or PETSC_DECIDE to have calculated if M is given)
+           This value should be the same as the local size used in creating the
+           y vector for the matrix-vector product y = Ax.
+.  n - This value should be the same as the local size used in creating the
+       x vector for the matrix-vector product y = Ax. (or PETSC_DECIDE to have
+       calculated if N is given) For square matrices n is almost always m.
+.  M - number of global rows (or PETSC_DETERMINE to have calculated if m is given)
+.  N - number of global columns (or PETSC_DETERMINE to have calculated if n is given)
+.  d_nz  - number of nonzeros per row in DIAGONAL portion of local submatrix
+           (same value is used for all local rows)
+.  d_nnz - array containing the number of nonzeros in the various rows of the
+           DIAGONAL portion of the local submatrix (possibly different for each row)
+           or NULL, if d_nz is used to specify the nonzero structure.
+           The size of this array is equal to the number of local rows, i.e 'm'.
+.  o_nz  - number of nonzeros per row in the OFF-DIAGONAL portion of local
+           submatrix (same value is used for all local rows).
+-  o_nnz - array containing the number of nonzeros in the various rows of the
+           OFF-DIAGONAL portion of the local submatrix (possibly different for
+           each row) or NULL, if o_nz is used to specify the nonzero
+           structure. The size of this array is equal to the number
+           of local rows, i.e 'm'.
+
+   Output Parameter:
+.  A - the matrix
+
+   Options Database Keys:
+.  -mat_aijsell_sigma <sigma> - number of consecutive rows that are sorted by length to reduce the padding, 1 disables sorting
+
+   Notes:
+   If the *_nnz parameter is given then the *_nz parameter is ignored
+
+   The DIAGONAL and OFF-DIAGONAL portions of the local submatrix are each stored as a
+   SEQAIJSELL matrix, so MatMult() overlaps the communication of the ghost values with
+   the sliced product of the diagonal portion, exactly as for MPIAIJ.
+
+   When calling this routine with a single process communicator, a matrix of
+   type SEQAIJSELL is returned.  If a matrix of type MPIAIJSELL is desired
+   for this type of communicator, use the construction mechanism:
+     MatCreate(...,&A); MatSetType(A,MPIAIJSELL); MatMPIAIJSetPreallocation(A,...);
+
+   Level: intermediate
+
+.keywords: matrix, sell, sliced ellpack, sparse, parallel
+
+.seealso: MatCreate(), MatCreateSeqAIJSELL(), MatSetValues(), MATMPIAIJSELL
+@*/
+PetscErrorCode  MatCreateMPIAIJSELL(MPI_Comm comm,PetscInt m,PetscInt n,PetscInt M,PetscInt N,PetscInt d_nz,const PetscInt d_nnz[],PetscInt o_nz,const PetscInt o_nnz[],Mat *A)
+{
+  PetscErrorCode ierr;
+  PetscMPIInt    size;
+
+  PetscFunctionBegin;
+  ierr = MatCreate(comm,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,m,n,M,N);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  if (size > 1) {
+    ierr = MatSetType(*A,MATMPIAIJSELL);CHKERRQ(ierr);
+    ierr = MatMPIAIJSetPreallocation(*A,d_nz,d_nnz,o_nz,o_nnz);CHKERRQ(ierr);
+  } else {
+    ierr = MatSetType(*A,MATSEQAIJSELL);CHKERRQ(ierr);
+    ierr = MatSeqAIJSetPreallocation(*A,d_nz,d_nnz);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/* converts the diagonal and off-diagonal blocks, which take the sorting window from the options of the parallel matrix */
+static PetscErrorCode MatMPIAIJSELL_ConvertBlocks(Mat B)
+{
+  Mat_MPIAIJ     *b = (Mat_MPIAIJ*)B->data;
+  PetscInt       sigma;
+  PetscBool      flg;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatConvert_SeqAIJ_SeqAIJSELL(b->A,MATSEQAIJSELL,MAT_INPLACE_MATRIX,&b->A);CHKERRQ(ierr);
+  ierr = MatConvert_SeqAIJ_SeqAIJSELL(b->B,MATSEQAIJSELL,MAT_INPLACE_MATRIX,&b->B);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(((PetscObject)B)->options,((PetscObject)B)->prefix,"-mat_aijsell_sigma",&sigma,&flg);CHKERRQ(ierr);
+  if (flg) {
+    if (sigma < 1) SETERRQ1(PetscObjectComm((PetscObject)B),PETSC_ERR_ARG_OUTOFRANGE,"Sorting window %D must be positive",sigma);
+    ((Mat_SeqAIJSELL*)b->A->spptr)->sigma = sigma;
+    ((Mat_SeqAIJSELL*)b->B->spptr)->sigma = sigma;
+  }
+  PetscFunctionReturn(0);
+}
+
+extern PetscErrorCode MatAssemblyEnd_MPIAIJ(Mat,MatAssemblyType);
+
+static PetscErrorCode MatAssemblyEnd_MPIAIJSELL(Mat A,MatAssemblyType mode)
+{
+  Mat_MPIAIJ     *a = (Mat_MPIAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatAssemblyEnd_MPIAIJ(A,mode);CHKERRQ(ierr);
+  /* MatSetUpMultiply_MPIAIJ() ran and renumbered the columns of B in place, without changing its nonzero state */
+  if (mode == MAT_FINAL_ASSEMBLY && !A->was_assembled) {
+    ((Mat_SeqAIJSELL*)a->B->spptr)->nonzerostate = -1;
+  }
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode  MatMPIAIJSetPreallocation_MPIAIJSELL(Mat B,PetscInt d_nz,const PetscInt d_nnz[],PetscInt o_nz,const PetscInt o_nnz[])
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatMPIAIJSetPreallocation_MPIAIJ(B,d_nz,d_nnz,o_nz,o_nnz);CHKERRQ(ierr);
+  ierr = MatMPIAIJSELL_ConvertBlocks(B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJSELL(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  /* an already preallocated matrix keeps its blocks, which are converted in place */
+  if (((Mat_MPIAIJ*)B->data)->A) {
+    ierr = MatMPIAIJSELL_ConvertBlocks(B);CHKERRQ(ierr);
+  }
+  B->ops->assemblyend = MatAssemblyEnd_MPIAIJSELL;
+
+  ierr = PetscObjectChangeTypeName((PetscObject)B,MATMPIAIJSELL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatMPIAIJSetPreallocation_C",MatMPIAIJSetPreallocation_MPIAIJSELL);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJSELL(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSetType(A,MATMPIAIJ);CHKERRQ(ierr);
+  ierr = MatConvert_MPIAIJ_MPIAIJSELL(A,MATMPIAIJSELL,MAT_INPLACE_MATRIX,&A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   MATAIJSELL - MATAIJSELL = "aijsell" - A matrix type to be used for sparse matrices.
+
+   This matrix type is identical to MATSEQAIJSELL when constructed with a single process communicator,
+   and MATMPIAIJSELL otherwise.  As a result, for single process communicators,
+  MatSeqAIJSetPreallocation() is supported, and similarly MatMPIAIJSetPreallocation() is supported
+  for communicators controlling multiple processes.  It is recommended that you call both of
+  the above preallocation routines for simplicity.
+
+   Options Database Keys:
++ -mat_type aijsell - sets the matrix type to "aijsell" during a call to MatSetFromOptions()
+- -mat_aijsell_sigma <sigma> - number of consecutive rows that are sorted by length to reduce the padding
+
+  Level: beginner
+
+.seealso: MatCreateMPIAIJSELL(), MATSEQAIJSELL, MATMPIAIJSELL, MATAIJPERM, MATAIJCRL
+M*/
@@ -155,15 +155,45 @@ PetscErrorCode  MatFDColoringApply_BAIJ(Mat J,MatFDColoring coloring,Vec x1,void
   PetscFunctionReturn(0);
 }
 
+/*
+   w = x1 + dx in the columns of color k; vscale_array is the array of vscale, which has the ghost points, for 'ds'
+*/
+static PetscErrorCode MatFDColoringPerturb_AIJ_Private(MatFDColoring coloring,PetscInt k,Vec x1,PetscScalar dx,PetscScalar *vscale_array,PetscInt cstart,Vec w)
+{
+  PetscErrorCode ierr;
+  PetscInt       l,col;
+  PetscScalar    *w_array;
+
+  PetscFunctionBegin;
+  ierr = VecCopy(x1,w);CHKERRQ(ierr);
+  ierr = VecGetArray(w,&w_array);CHKERRQ(ierr);
+  if (coloring->ctype == IS_COLORING_GLOBAL) w_array -= cstart; /* shift pointer so global index can be used */
+  if (coloring->htype[0] == 'w') {
+    for (l=0; l<coloring->ncolumns[k]; l++) {
+      col = coloring->columns[k][l]; /* local column (in global index!) of the matrix we are probing for */
+      w_array[col] += 1.0/dx;
+    }
+  } else { /* htype == 'ds' */
+    vscale_array -= cstart; /* shift pointer so global index can be used */
+    for (l=0; l<coloring->ncolumns[k]; l++) {
+      col = coloring->columns[k][l]; /* local column (in global index!) of the matrix we are probing for */
+      w_array[col] += 1.0/vscale_array[col];
+    }
+  }
+  if (coloring->ctype == IS_COLORING_GLOBAL) w_array += cstart;
+  ierr = VecRestoreArray(w,&w_array);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /* this is declared PETSC_EXTERN because it is used by MatFDColoringUseDM() which is in the DM library */
 PetscErrorCode  MatFDColoringApply_AIJ(Mat J,MatFDColoring coloring,Vec x1,void *sctx)
 {
   PetscErrorCode    (*f)(void*,Vec,Vec,void*) = (PetscErrorCode (*)(void*,Vec,Vec,void*))coloring->f;
   PetscErrorCode    ierr;
   PetscInt          k,cstart,cend,l,row,col,nz;
-  PetscScalar       dx=0.0,*y,*w3_array;
+  PetscScalar       dx=0.0,*y;
   const PetscScalar *xx;
-  PetscScalar       *vscale_array;
+  PetscScalar       *vscale_array = NULL;
   PetscReal         epsilon=coloring->error_rel,umin=coloring->umin,unorm;
   Vec               w1=coloring->w1,w2=coloring->w2,w3,vscale=coloring->vscale;
   void              *fctx=coloring->fctx;
@@ -171,7 +201,7 @@ PetscErrorCode  MatFDColoringApply_AIJ(Mat J,MatFDColoring coloring,Vec x1,void
   PetscInt          nxloc,nrows_k;
   MatEntry          *Jentry=coloring->matentry;
   MatEntry2         *Jentry2=coloring->matentry2;
-  const PetscInt    ncolors=coloring->ncolors,*ncolumns=coloring->ncolumns,*nrows=coloring->nrows;
+  const PetscInt    ncolors=coloring->ncolors,*nrows=coloring->nrows;
 
   PetscFunctionBegin;
   if ((ctype == IS_COLORING_LOCAL) && (J->ops->fdcoloringapply == MatFDColoringApply_AIJ)) SETERRQ(PetscObjectComm((PetscObject)J),PETSC_ERR_SUP,"Must call MatColoringUseDM() with IS_COLORING_LOCAL");
@@ -216,6 +246,17 @@ PetscErrorCode  MatFDColoringApply_AIJ(Mat J,MatFDColoring coloring,Vec x1,void
     ierr = PetscLogObjectParent((PetscObject)coloring,(PetscObject)coloring->w3);CHKERRQ(ierr);
   }
   w3 = coloring->w3;
+  if (coloring->fbatch && coloring->bcols > 1 && coloring->nb < coloring->bcols) { /* bcols may have grown since the last call */
+    if (coloring->nb) {
+      ierr = VecDestroyVecs(coloring->nb,&coloring->xb);CHKERRQ(ierr);
+      ierr = VecDestroyVecs(coloring->nb,&coloring->yb);CHKERRQ(ierr);
+    }
+    coloring->nb = coloring->bcols;
+    ierr = VecDuplicateVecs(x1,coloring->nb,&coloring->xb);CHKERRQ(ierr);
+    ierr = VecDuplicateVecs(w1,coloring->nb,&coloring->yb);CHKERRQ(ierr);
+    ierr = PetscLogObjectParents(coloring,coloring->nb,coloring->xb);CHKERRQ(ierr);
+    ierr = PetscLogObjectParents(coloring,coloring->nb,coloring->yb);CHKERRQ(ierr);
+  }
 
   ierr = VecGetOwnershipRange(x1,&cstart,&cend);CHKERRQ(ierr); /* used by ghosted vscale */
   if (vscale) {
@@ -238,38 +279,36 @@ PetscErrorCode  MatFDColoringApply_AIJ(Mat J,MatFDColoring coloring,Vec x1,void
 
       dy_k = dy;
       if (k + bcols > ncolors) bcols = ncolors - k;
-      for (i=0; i<bcols; i++) {
-
-        ierr = VecCopy(x1,w3);CHKERRQ(ierr);
-        ierr = VecGetArray(w3,&w3_array);CHKERRQ(ierr);
-        if (ctype == IS_COLORING_GLOBAL) w3_array -= cstart; /* shift pointer so global index can be used */
-        if (coloring->htype[0] == 'w') {
-          for (l=0; l<ncolumns[k+i]; l++) {
-            col = coloring->columns[k+i][l]; /* local column (in global index!) of the matrix we are probing for */
-            w3_array[col] += 1.0/dx;
-          }
-        } else { /* htype == 'ds' */
-          vscale_array -= cstart; /* shift pointer so global index can be used */
-          for (l=0; l<ncolumns[k+i]; l++) {
-            col = coloring->columns[k+i][l]; /* local column (in global index!) of the matrix we are probing for */
-            w3_array[col] += 1.0/vscale_array[col];
-          }
-          vscale_array += cstart;
+      if (coloring->fbatch && coloring->nb >= bcols) {
+        /* perturb all the colors of the block and evaluate the function at all the points in one call */
+        for (i=0; i<bcols; i++) {
+          ierr = MatFDColoringPerturb_AIJ_Private(coloring,k+i,x1,dx,vscale_array,cstart,coloring->xb[i]);CHKERRQ(ierr);
         }
-        if (ctype == IS_COLORING_GLOBAL) w3_array += cstart;
-        ierr = VecRestoreArray(w3,&w3_array);CHKERRQ(ierr);
-
-        /*
-         (3-2) Evaluate function at w3 = x1 + dx (here dx is a vector of perturbations)
-                           w2 = F(x1 + dx) - F(x1)
-         */
         ierr = PetscLogEventBegin(MAT_FDColoringFunction,0,0,0,0);CHKERRQ(ierr);
-        ierr = VecPlaceArray(w2,dy_k);CHKERRQ(ierr); /* place w2 to the array dy_i */
-        ierr = (*f)(sctx,w3,w2,fctx);CHKERRQ(ierr);
+        ierr = (*coloring->fbatch)(sctx,bcols,coloring->xb,coloring->yb,coloring->fbatchctx);CHKERRQ(ierr);
         ierr = PetscLogEventEnd(MAT_FDColoringFunction,0,0,0,0);CHKERRQ(ierr);
-        ierr = VecAXPY(w2,-1.0,w1);CHKERRQ(ierr);
-        ierr = VecResetArray(w2);CHKERRQ(ierr);
-        dy_k += m; /* points to dy+i*nxloc */
+        for (i=0; i<bcols; i++) {
+          ierr = VecPlaceArray(w2,dy_k);CHKERRQ(ierr);
+          ierr = VecWAXPY(w2,-1.0,w1,coloring->yb[i]);CHKERRQ(ierr);
+          ierr = VecResetArray(w2);CHKERRQ(ierr);
+          dy_k += m;
+        }
+      } else {
+        for (i=0; i<bcols; i++) {
+          ierr = MatFDColoringPerturb_AIJ_Private(coloring,k+i,x1,dx,vscale_array,cstart,w3);CHKERRQ(ierr);
+
+          /*
+           (3-2) Evaluate function at w3 = x1 + dx (here dx is a vector of perturbations)
+                             w2 = F(x1 + dx) - F(x1)
+           */
+          ierr = PetscLogEventBegin(MAT_FDColoringFunction,0,0,0,0);CHKERRQ(ierr);
+          ierr = VecPlaceArray(w2,dy_k);CHKERRQ(ierr); /* place w2 to the array dy_i */
+          ierr = (*f)(sctx,w3,w2,fctx);CHKERRQ(ierr);
+          ierr = PetscLogEventEnd(MAT_FDColoringFunction,0,0,0,0);CHKERRQ(ierr);
+          ierr = VecAXPY(w2,-1.0,w1);CHKERRQ(ierr);
+          ierr = VecResetArray(w2);CHKERRQ(ierr);
+          dy_k += m; /* points to dy+i*nxloc */
+        }
       }
 
       /*
@@ -300,24 +339,7 @@ PetscErrorCode  MatFDColoringApply_AIJ(Mat J,MatFDColoring coloring,Vec x1,void
        (3-1) Loop over each column associated with color
        adding the perturbation to the vector w3 = x1 + dx.
        */
-      ierr = VecCopy(x1,w3);CHKERRQ(ierr);
-      ierr = VecGetArray(w3,&w3_array);CHKERRQ(ierr);
-      if (ctype == IS_COLORING_GLOBAL) w3_array -= cstart; /* shift pointer so global index can be used */
-      if (coloring->htype[0] == 'w') {
-        for (l=0; l<ncolumns[k]; l++) {
-          col = coloring->columns[k][l]; /* local column (in global index!) of the matrix we are probing for */
-          w3_array[col] += 1.0/dx;
-        }
-      } else { /* htype == 'ds' */
-        vscale_array -= cstart; /* shift pointer so global index can be used */
-        for (l=0; l<ncolumns[k]; l++) {
-          col = coloring->columns[k][l]; /* local column (in global index!) of the matrix we are probing for */
-          w3_array[col] += 1.0/vscale_array[col];
-        }
-        vscale_array += cstart;
-      }
-      if (ctype == IS_COLORING_GLOBAL) w3_array += cstart;
-      ierr = VecRestoreArray(w3,&w3_array);CHKERRQ(ierr);
+      ierr = MatFDColoringPerturb_AIJ_Private(coloring,k,x1,dx,vscale_array,cstart,w3);CHKERRQ(ierr);
 
       /*
        (3-2) Evaluate function at w3 = x1 + dx (here dx is a vector of perturbations)
@@ -18,7 +18,7 @@
    Options Database Keys:
 . -mat_type aij - sets the matrix type to "aij" during a call to MatSetFromOptions()
 
-  Developer Notes: Subclasses include MATAIJCUSP, MATAIJCUSPARSE, MATAIJPERM, MATAIJCRL, and also automatically switches over to use inodes when
+  Developer Notes: Subclasses include MATAIJCUSP, MATAIJCUSPARSE, MATAIJPERM, MATAIJSELL, MATAIJDELTA, MATAIJMIXED, MATAIJCRL, and also automatically switches over to use inodes when
    enough exist.
 
   Level: beginner
@@ -519,6 +519,180 @@ PetscErrorCode MatSetValuesRow_MPIAIJ(Mat A,PetscInt row,const PetscScalar v[])
   PetscFunctionReturn(0);
 }
 
+static PetscErrorCode MatFrozenDestroy_MPIAIJ(Mat_MPIAIJ_Frozen **frozen)
+{
+  Mat_MPIAIJ_Frozen *fr = *frozen;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (!fr) PetscFunctionReturn(0);
+  ierr = PetscFree(fr->rows);CHKERRQ(ierr);
+  ierr = PetscFree(fr->i);CHKERRQ(ierr);
+  ierr = PetscFree(fr->j);CHKERRQ(ierr);
+  ierr = PetscFree(fr->v);CHKERRQ(ierr);
+  ierr = PetscSFDestroy(&fr->sf);CHKERRQ(ierr);
+  ierr = PetscFree2(fr->dst,fr->rv);CHKERRQ(ierr);
+  ierr = PetscFree(*frozen);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   Adds values to an off-process row once the nonzero pattern is frozen: they are accumulated in the
+   row saved when the pattern was frozen and sent by the next assembly, without stashing their indices
+*/
+static PetscErrorCode MatSetValuesFrozen_MPIAIJ(Mat mat,PetscInt row,PetscInt n,const PetscInt in[],const PetscScalar v[],PetscInt stride,InsertMode addv)
+{
+  Mat_MPIAIJ_Frozen *fr = ((Mat_MPIAIJ*)mat->data)->frozen;
+  PetscInt          r,j,k,ncols;
+  const PetscInt    *cols;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (addv != ADD_VALUES) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Off-process entries must be added with ADD_VALUES once the nonzero pattern is frozen");
+  ierr = PetscFindInt(row,fr->nrows,fr->rows,&r);CHKERRQ(ierr);
+  if (r < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Off-process row %D was not set when the nonzero pattern was frozen",row);
+  cols  = fr->j + fr->i[r];
+  ncols = fr->i[r+1] - fr->i[r];
+  for (j=0; j<n; j++) {
+    if (in[j] < 0) continue;
+    ierr = PetscFindInt(in[j],ncols,cols,&k);CHKERRQ(ierr);
+    if (k < 0) {
+      if (v[j*stride] == 0.0) continue;
+      SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Off-process entry (%D, %D) was not set when the nonzero pattern was frozen",row,in[j]);
+    }
+    fr->v[fr->i[r]+k] += v[j*stride];
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   Saves the indices of the stashed off-process entries, called by each assembly until the final assembly that
+   freezes the pattern; nrows counts the saved entries until they are compressed to rows by MatFreezePatternEnd_MPIAIJ()
+*/
+static PetscErrorCode MatFreezePatternBegin_MPIAIJ(Mat mat)
+{
+  Mat_MPIAIJ         *aij = (Mat_MPIAIJ*)mat->data;
+  Mat_MPIAIJ_Frozen  *fr;
+  PetscMatStashSpace space;
+  PetscInt           cnt,l,*rows,*j;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  if (!aij->frozen) {ierr = PetscNew(&aij->frozen);CHKERRQ(ierr);}
+  fr   = aij->frozen;
+  cnt  = fr->nrows;
+  ierr = PetscMalloc1(cnt+mat->stash.n,&rows);CHKERRQ(ierr);
+  ierr = PetscMalloc1(cnt+mat->stash.n,&j);CHKERRQ(ierr);
+  ierr = PetscMemcpy(rows,fr->rows,cnt*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscMemcpy(j,fr->j,cnt*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscFree(fr->rows);CHKERRQ(ierr);
+  ierr = PetscFree(fr->j);CHKERRQ(ierr);
+  fr->rows = rows;
+  fr->j    = j;
+  for (space=mat->stash.space_head; space; space=space->next) {
+    for (l=0; l<space->local_used; l++) {
+      fr->rows[cnt] = space->idx[l];
+      fr->j[cnt++]  = space->idy[l];
+    }
+  }
+  if (cnt != fr->nrows+mat->stash.n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_PLIB,"MatStash n %D, but counted %D entries",mat->stash.n,cnt-fr->nrows);
+  fr->nrows = cnt;
+  PetscFunctionReturn(0);
+}
+
+/*
+   Sends the saved off-process structure to the owners of the rows, which find the place of each entry in
+   their diagonal or off-diagonal block; called once the final assembly that freezes the pattern is complete
+*/
+static PetscErrorCode MatFreezePatternEnd_MPIAIJ(Mat mat)
+{
+  Mat_MPIAIJ        *aij = (Mat_MPIAIJ*)mat->data;
+  Mat_MPIAIJ_Frozen *fr  = aij->frozen;
+  Mat_SeqAIJ        *a   = (Mat_SeqAIJ*)aij->A->data,*b = (Mat_SeqAIJ*)aij->B->data;
+  PetscInt          m = mat->rmap->n,cstart = mat->cmap->rstart,cend = mat->cmap->rend,nb = aij->B->cmap->n;
+  PetscInt          *cnt,*base,*roff,*next,*rcol,n,start,len,r,e,l,k,c;
+  PetscMPIInt       owner;
+  PetscSFNode       *iremote;
+  PetscSF           sf;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  /* compress the saved entries in place to one sorted row of distinct columns for each distinct row */
+  n         = fr->nrows;
+  fr->nrows = 0;
+  ierr      = PetscSortIntWithArray(n,fr->rows,fr->j);CHKERRQ(ierr);
+  for (start=0; start<n; start+=len) {
+    for (len=1; start+len<n && fr->rows[start+len] == fr->rows[start]; len++) ;
+    fr->nrows++;
+  }
+  ierr     = PetscMalloc1(fr->nrows+1,&fr->i);CHKERRQ(ierr);
+  fr->i[0] = 0;
+  for (start=0,r=0; start<n; start+=len,r++) {
+    for (len=1; start+len<n && fr->rows[start+len] == fr->rows[start]; len++) ;
+    fr->rows[r] = fr->rows[start];
+    l           = len;
+    ierr        = PetscSortRemoveDupsInt(&l,fr->j+start);CHKERRQ(ierr);
+    ierr        = PetscMemmove(fr->j+fr->i[r],fr->j+start,l*sizeof(PetscInt));CHKERRQ(ierr);
+    fr->i[r+1]  = fr->i[r] + l;
+  }
+  ierr = PetscCalloc1(fr->i[fr->nrows],&fr->v);CHKERRQ(ierr);
+
+  /* count the entries each row receives, and give each sender its place in them */
+  ierr = PetscMalloc2(fr->nrows,&cnt,fr->nrows,&base);CHKERRQ(ierr);
+  ierr = PetscCalloc1(m+1,&roff);CHKERRQ(ierr);
+  for (r=0; r<fr->nrows; r++) cnt[r] = fr->i[r+1] - fr->i[r];
+  ierr = PetscSFCreate(PetscObjectComm((PetscObject)mat),&sf);CHKERRQ(ierr);
+  ierr = PetscSFSetGraphLayout(sf,mat->rmap,fr->nrows,NULL,PETSC_USE_POINTER,fr->rows);CHKERRQ(ierr);
+  ierr = PetscSFReduceBegin(sf,MPIU_INT,cnt,roff+1,MPIU_SUM);CHKERRQ(ierr);
+  ierr = PetscSFReduceEnd(sf,MPIU_INT,cnt,roff+1,MPIU_SUM);CHKERRQ(ierr);
+  for (l=0; l<m; l++) roff[l+1] += roff[l];
+  fr->nrecv = roff[m];
+  ierr = PetscMalloc2(fr->nrecv,&fr->dst,fr->nrecv,&fr->rv);CHKERRQ(ierr);
+  ierr = PetscMalloc2(fr->nrecv,&rcol,m,&next);CHKERRQ(ierr);
+  ierr = PetscMemcpy(next,roff,m*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscSFFetchAndOpBegin(sf,MPIU_INT,next,cnt,base,MPIU_SUM);CHKERRQ(ierr);
+  ierr = PetscSFFetchAndOpEnd(sf,MPIU_INT,next,cnt,base,MPIU_SUM);CHKERRQ(ierr);
+  ierr = PetscSFDestroy(&sf);CHKERRQ(ierr);
+
+  /* one leaf for each saved entry, its root is its place among the entries received by the owner */
+  ierr = PetscMalloc1(fr->i[fr->nrows],&iremote);CHKERRQ(ierr);
+  for (r=0; r<fr->nrows; r++) {
+    ierr = PetscLayoutFindOwner(mat->rmap,fr->rows[r],&owner);CHKERRQ(ierr);
+    for (e=fr->i[r]; e<fr->i[r+1]; e++) {
+      iremote[e].rank  = owner;
+      iremote[e].index = base[r] + e - fr->i[r];
+    }
+  }
+  ierr = PetscFree2(cnt,base);CHKERRQ(ierr);
+  ierr = PetscSFCreate(PetscObjectComm((PetscObject)mat),&fr->sf);CHKERRQ(ierr);
+  ierr = PetscSFSetGraph(fr->sf,fr->nrecv,fr->i[fr->nrows],NULL,PETSC_OWN_POINTER,iremote,PETSC_OWN_POINTER);CHKERRQ(ierr);
+  ierr = PetscSFSetFromOptions(fr->sf);CHKERRQ(ierr);
+  ierr = PetscSFReduceBegin(fr->sf,MPIU_INT,fr->j,rcol,MPIU_REPLACE);CHKERRQ(ierr);
+  ierr = PetscSFReduceEnd(fr->sf,MPIU_INT,fr->j,rcol,MPIU_REPLACE);CHKERRQ(ierr);
+
+  /* place of the received entries in the diagonal or the off-diagonal block */
+  for (l=0; l<m; l++) {
+    for (e=roff[l]; e<roff[l+1]; e++) {
+      fr->dst[e] = -1;
+      if (rcol[e] >= cstart && rcol[e] < cend) {
+        ierr = PetscFindInt(rcol[e]-cstart,a->ilen[l],a->j+a->i[l],&k);CHKERRQ(ierr);
+        if (k >= 0) fr->dst[e] = a->i[l] + k;
+      } else {
+        ierr = PetscFindInt(rcol[e],nb,aij->garray,&c);CHKERRQ(ierr);
+        if (c >= 0) {ierr = PetscFindInt(c,b->ilen[l],b->j+b->i[l],&k);CHKERRQ(ierr);}
+        if (c >= 0 && k >= 0) fr->dst[e] = -(b->i[l] + k) - 2;
+      }
+    }
+  }
+  ierr = PetscFree(roff);CHKERRQ(ierr);
+  ierr = PetscFree2(rcol,next);CHKERRQ(ierr);
+  fr->state  = aij->A->nonzerostate + aij->B->nonzerostate;
+  fr->nonewA = a->nonew;
+  fr->nonewB = b->nonew;
+  ierr = MatSetOption(mat,MAT_NEW_NONZERO_LOCATION_ERR,PETSC_TRUE);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatSetValues_MPIAIJ(Mat mat,PetscInt m,const PetscInt im[],PetscInt n,const PetscInt in[],const PetscScalar v[],InsertMode addv)
 {
   Mat_MPIAIJ     *aij = (Mat_MPIAIJ*)mat->data;
@@ -612,7 +786,14 @@ PetscErrorCode MatSetValues_MPIAIJ(Mat mat,PetscInt m,const PetscInt im[],PetscI
       }
     } else {
       if (mat->nooffprocentries) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Setting off process row %D even though MatSetOption(,MAT_NO_OFF_PROC_ENTRIES,PETSC_TRUE) was set",im[i]);
-      if (!aij->donotstash) {
+      if (aij->frozen && aij->frozen->sf && !aij->donotstash) {
+        mat->assembled = PETSC_FALSE;
+        if (roworiented) {
+          ierr = MatSetValuesFrozen_MPIAIJ(mat,im[i],n,in,v+i*n,1,addv);CHKERRQ(ierr);
+        } else {
+          ierr = MatSetValuesFrozen_MPIAIJ(mat,im[i],n,in,v+i,m,addv);CHKERRQ(ierr);
+        }
+      } else if (!aij->donotstash) {
         mat->assembled = PETSC_FALSE;
         if (roworiented) {
           ierr = MatStashValuesRow_Private(&mat->stash,im[i],n,in,v+i*n,(PetscBool)(ignorezeroentries && (addv == ADD_VALUES)));CHKERRQ(ierr);
@@ -676,12 +857,22 @@ PetscErrorCode MatAssemblyBegin_MPIAIJ(Mat mat,MatAssemblyType mode)
   PetscFunctionBegin;
   if (aij->donotstash || mat->nooffprocentries) PetscFunctionReturn(0);
 
+  /* once the pattern is frozen the off-process values are sent without their indices */
+  if (aij->frozen && aij->frozen->sf) {
+    ierr = PetscSFReduceBegin(aij->frozen->sf,MPIU_SCALAR,aij->frozen->v,aij->frozen->rv,MPIU_REPLACE);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  if (aij->freeze) {
+    ierr = MatFreezePatternBegin_MPIAIJ(mat);CHKERRQ(ierr);
+  }
   ierr = MatStashScatterBegin_Private(mat,&mat->stash,mat->rmap->range);CHKERRQ(ierr);
   ierr = MatStashGetInfo_Private(&mat->stash,&nstash,&reallocs);CHKERRQ(ierr);
   ierr = PetscInfo2(aij->A,"Stash has %D entries, uses %D mallocs.\n",nstash,reallocs);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
+static PetscErrorCode MatDetectBlockSize_MPIAIJ(Mat);
+
 PetscErrorCode MatAssemblyEnd_MPIAIJ(Mat mat,MatAssemblyType mode)
 {
   Mat_MPIAIJ     *aij = (Mat_MPIAIJ*)mat->data;
@@ -696,7 +887,21 @@ PetscErrorCode MatAssemblyEnd_MPIAIJ(Mat mat,MatAssemblyType mode)
   /* do not use 'b = (Mat_SeqAIJ*)aij->B->data' as B can be reset in disassembly */
 
   PetscFunctionBegin;
-  if (!aij->donotstash && !mat->nooffprocentries) {
+  if (aij->frozen && aij->frozen->sf && !aij->donotstash && !mat->nooffprocentries) {
+    Mat_MPIAIJ_Frozen *fr = aij->frozen;
+    MatScalar         *aa = a->a,*ba = ((Mat_SeqAIJ*)aij->B->data)->a;
+    PetscBool         changed = (PetscBool)(fr->state != aij->A->nonzerostate + aij->B->nonzerostate),anychanged;
+
+    ierr = PetscSFReduceEnd(fr->sf,MPIU_SCALAR,fr->v,fr->rv,MPIU_REPLACE);CHKERRQ(ierr);
+    /* the places in dst are stale on any process whose pattern changed, so all processes must stop */
+    ierr = MPIU_Allreduce(&changed,&anychanged,1,MPIU_BOOL,MPI_LOR,PetscObjectComm((PetscObject)mat));CHKERRQ(ierr);
+    if (anychanged) SETERRQ(PetscObjectComm((PetscObject)mat),PETSC_ERR_ARG_WRONGSTATE,"The nonzero pattern changed after it was frozen");
+    for (i=0; i<fr->nrecv; i++) {
+      if (fr->dst[i] >= 0)      aa[fr->dst[i]]    += fr->rv[i];
+      else if (fr->dst[i] < -1) ba[-fr->dst[i]-2] += fr->rv[i];
+    }
+    ierr = PetscMemzero(fr->v,fr->i[fr->nrows]*sizeof(PetscScalar));CHKERRQ(ierr);
+  } else if (!aij->donotstash && !mat->nooffprocentries) {
     while (1) {
       ierr = MatStashScatterGetMesg_Private(&mat->stash,&n,&row,&col,&val,&flg);CHKERRQ(ierr);
       if (!flg) break;
@@ -750,6 +955,48 @@ PetscErrorCode MatAssemblyEnd_MPIAIJ(Mat mat,MatAssemblyType mode)
     PetscObjectState state = aij->A->nonzerostate + aij->B->nonzerostate;
     ierr = MPIU_Allreduce(&state,&mat->nonzerostate,1,MPIU_INT64,MPI_SUM,PetscObjectComm((PetscObject)mat));CHKERRQ(ierr);
   }
+  if (mode == MAT_FINAL_ASSEMBLY && aij->detectbs && PetscAbs(mat->rmap->bs) == 1 && PetscAbs(mat->cmap->bs) == 1) {
+    ierr = MatDetectBlockSize_MPIAIJ(mat);CHKERRQ(ierr);
+  }
+  if (aij->frozen && !aij->frozen->sf && mode == MAT_FINAL_ASSEMBLY) {
+    ierr = MatFreezePatternEnd_MPIAIJ(mat);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   The block size must divide the local sizes and be found in both the diagonal and the
+   off-diagonal part on all processes, see MatSeqAIJDetectBlockSize()
+*/
+static PetscErrorCode MatDetectBlockSize_MPIAIJ(Mat mat)
+{
+  Mat_MPIAIJ     *aij = (Mat_MPIAIJ*)mat->data;
+  PetscErrorCode ierr;
+  PetscInt       bs,mask = 0,gmask;
+
+  PetscFunctionBegin;
+  for (bs=2; bs<=MAT_DETECT_BLOCK_SIZE_MAX; bs++) {
+    if (!(mat->rmap->n % bs) && !(mat->cmap->n % bs)) mask |= (PetscInt)1 << bs;
+  }
+  if (mask && mat->rmap->n) {
+    ierr = MatSeqAIJCheckBlocks_Private(aij->A,NULL,&mask);CHKERRQ(ierr);
+    ierr = MatSeqAIJCheckBlocks_Private(aij->B,aij->garray,&mask);CHKERRQ(ierr);
+  }
+  ierr = MPIU_Allreduce(&mask,&gmask,1,MPIU_INT,MPI_BAND,PetscObjectComm((PetscObject)mat));CHKERRQ(ierr);
+  for (bs=MAT_DETECT_BLOCK_SIZE_MAX; bs>1; bs--) {
+    if (gmask & ((PetscInt)1 << bs)) break;
+  }
+  aij->detectedbs = bs;
+  if (bs > 1) {
+    ierr = PetscLayoutSetBlockSize(mat->rmap,bs);CHKERRQ(ierr);
+    ierr = PetscLayoutSetBlockSize(mat->cmap,bs);CHKERRQ(ierr);
+    ierr = PetscLayoutSetBlockSize(aij->A->rmap,bs);CHKERRQ(ierr);
+    ierr = PetscLayoutSetBlockSize(aij->A->cmap,bs);CHKERRQ(ierr);
+    ierr = PetscLayoutSetBlockSize(aij->B->rmap,bs);CHKERRQ(ierr);
+    ierr = PetscInfo1(mat,"Nonzero pattern is made of dense blocks of size %D, using it as the block size\n",bs);CHKERRQ(ierr);
+  } else {
+    ierr = PetscInfo(mat,"No block structure found in the nonzero pattern\n");CHKERRQ(ierr);
+  }
   PetscFunctionReturn(0);
 }
 
@@ -930,6 +1177,182 @@ PetscErrorCode MatZeroRowsColumns_MPIAIJ(Mat A,PetscInt N,const PetscInt rows[],
   PetscFunctionReturn(0);
 }
 
+static PetscErrorCode MatReorderDestroy_MPIAIJ(Mat_MPIAIJ_Reorder **reorder)
+{
+  Mat_MPIAIJ_Reorder *rd = *reorder;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  if (!rd) PetscFunctionReturn(0);
+  ierr = MatDestroy(&rd->A);CHKERRQ(ierr);
+  ierr = MatDestroy(&rd->B);CHKERRQ(ierr);
+  ierr = VecDestroy(&rd->x);CHKERRQ(ierr);
+  ierr = VecDestroy(&rd->y);CHKERRQ(ierr);
+  ierr = PetscFree3(rd->perm,rd->amap,rd->bmap);CHKERRQ(ierr);
+  ierr = PetscFree(*reorder);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   Creates the structure of A with its rows in the order perm and, if iperm is given, its columns renumbered by
+   iperm; map[k] is the location in A of the k-th nonzero of the copy
+*/
+static PetscErrorCode MatReorderCopyBlock_Private(Mat A,const PetscInt *perm,const PetscInt *iperm,Mat *Ap,PetscInt *map)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscInt       m = A->rmap->n,n = A->cmap->n,i,k,r,*ii,*jj;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr  = PetscMalloc2(m+1,&ii,a->i[m],&jj);CHKERRQ(ierr);
+  ii[0] = 0;
+  for (i=0; i<m; i++) {
+    r       = perm[i];
+    ii[i+1] = ii[i] + a->i[r+1] - a->i[r];
+    for (k=a->i[r]; k<a->i[r+1]; k++) {
+      jj[ii[i]+k-a->i[r]]  = iperm ? iperm[a->j[k]] : a->j[k];
+      map[ii[i]+k-a->i[r]] = k;
+    }
+    if (iperm) {ierr = PetscSortIntWithArray(ii[i+1]-ii[i],jj+ii[i],map+ii[i]);CHKERRQ(ierr);}
+  }
+  ierr = MatCreate(PETSC_COMM_SELF,Ap);CHKERRQ(ierr);
+  ierr = MatSetSizes(*Ap,m,n,m,n);CHKERRQ(ierr);
+  ierr = MatSetType(*Ap,MATSEQAIJ);CHKERRQ(ierr);
+  if (!iperm) {ierr = MatSetOption(*Ap,MAT_USE_INODES,PETSC_FALSE);CHKERRQ(ierr);}
+  ierr = MatSeqAIJSetPreallocationCSR(*Ap,ii,jj,NULL);CHKERRQ(ierr);
+  ierr = PetscFree2(ii,jj);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   Brings the reordered copies of the local blocks up to date: they are built again when the blocks are replaced or
+   their nonzero structure changes, and their values are copied again when the matrix or the blocks change. There
+   are no copies if the diagonal block is not square.
+*/
+static PetscErrorCode MatReorderSetUp_MPIAIJ(Mat mat)
+{
+  Mat_MPIAIJ         *aij = (Mat_MPIAIJ*)mat->data;
+  Mat_MPIAIJ_Reorder *rd  = aij->reorder;
+  Mat_SeqAIJ         *a   = (Mat_SeqAIJ*)aij->A->data,*b = (Mat_SeqAIJ*)aij->B->data,*ra,*rb;
+  PetscInt           m    = mat->rmap->n,i,k,*iperm;
+  const PetscInt     *idx;
+  PetscObjectState   state,astate,bstate;
+  PetscBool          fill = PETSC_FALSE;
+  IS                 rperm,cperm;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  if (rd && (rd->aid != ((PetscObject)aij->A)->id || rd->bid != ((PetscObject)aij->B)->id || rd->anzstate != aij->A->nonzerostate || rd->bnzstate != aij->B->nonzerostate)) {
+    ierr = MatReorderDestroy_MPIAIJ(&aij->reorder);CHKERRQ(ierr);
+    rd   = NULL;
+  }
+  if (!rd) {
+    if (m != mat->cmap->n) PetscFunctionReturn(0);
+    ierr = MatGetOrdering(aij->A,aij->reordertype,&rperm,&cperm);CHKERRQ(ierr);
+    ierr = PetscNew(&rd);CHKERRQ(ierr);
+    ierr = PetscMalloc3(m,&rd->perm,a->i[m],&rd->amap,b->i[m],&rd->bmap);CHKERRQ(ierr);
+    ierr = PetscMalloc1(m,&iperm);CHKERRQ(ierr);
+    ierr = ISGetIndices(rperm,&idx);CHKERRQ(ierr);
+    for (i=0; i<m; i++) {
+      rd->perm[i]   = idx[i];
+      iperm[idx[i]] = i;
+    }
+    ierr = ISRestoreIndices(rperm,&idx);CHKERRQ(ierr);
+    ierr = ISDestroy(&rperm);CHKERRQ(ierr);
+    ierr = ISDestroy(&cperm);CHKERRQ(ierr);
+    ierr = MatReorderCopyBlock_Private(aij->A,rd->perm,iperm,&rd->A,rd->amap);CHKERRQ(ierr);
+    ierr = MatReorderCopyBlock_Private(aij->B,rd->perm,NULL,&rd->B,rd->bmap);CHKERRQ(ierr);
+    ierr = PetscFree(iperm);CHKERRQ(ierr);
+    ierr = VecCreateSeq(PETSC_COMM_SELF,m,&rd->x);CHKERRQ(ierr);
+    ierr = VecDuplicate(rd->x,&rd->y);CHKERRQ(ierr);
+    ierr = PetscLogObjectParent((PetscObject)mat,(PetscObject)rd->A);CHKERRQ(ierr);
+    ierr = PetscLogObjectParent((PetscObject)mat,(PetscObject)rd->B);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)mat,m*sizeof(PetscInt)+(a->i[m]+b->i[m])*sizeof(PetscInt));CHKERRQ(ierr);
+    rd->aid      = ((PetscObject)aij->A)->id;
+    rd->bid      = ((PetscObject)aij->B)->id;
+    rd->anzstate = aij->A->nonzerostate;
+    rd->bnzstate = aij->B->nonzerostate;
+    aij->reorder = rd;
+    fill         = PETSC_TRUE;
+  }
+  ierr = PetscObjectStateGet((PetscObject)mat,&state);CHKERRQ(ierr);
+  ierr = PetscObjectStateGet((PetscObject)aij->A,&astate);CHKERRQ(ierr);
+  ierr = PetscObjectStateGet((PetscObject)aij->B,&bstate);CHKERRQ(ierr);
+  if (fill || state != rd->state || astate != rd->astate || bstate != rd->bstate) {
+    ra = (Mat_SeqAIJ*)rd->A->data;
+    rb = (Mat_SeqAIJ*)rd->B->data;
+    for (k=0; k<a->i[m]; k++) ra->a[k] = a->a[rd->amap[k]];
+    for (k=0; k<b->i[m]; k++) rb->a[k] = b->a[rd->bmap[k]];
+    ierr = MatSeqAIJInvalidateDiagonal(rd->A);CHKERRQ(ierr);
+    ierr = PetscObjectStateIncrease((PetscObject)rd->A);CHKERRQ(ierr);
+    ierr = PetscObjectStateIncrease((PetscObject)rd->B);CHKERRQ(ierr);
+    rd->state  = state;
+    rd->astate = astate;
+    rd->bstate = bstate;
+  }
+  PetscFunctionReturn(0);
+}
+
+/* xp[i] = x[perm[i]] */
+static PetscErrorCode MatReorderPermute_Private(Mat_MPIAIJ_Reorder *rd,Vec x,Vec xp)
+{
+  const PetscScalar *xa;
+  PetscScalar       *xpa;
+  PetscInt          i,m;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetLocalSize(xp,&m);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(x,&xa);CHKERRQ(ierr);
+  ierr = VecGetArray(xp,&xpa);CHKERRQ(ierr);
+  for (i=0; i<m; i++) xpa[i] = xa[rd->perm[i]];
+  ierr = VecRestoreArray(xp,&xpa);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(x,&xa);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* y[perm[i]] = w[perm[i]] + yp[i], or yp[i] if w is NULL */
+static PetscErrorCode MatReorderUnpermute_Private(Mat_MPIAIJ_Reorder *rd,Vec yp,Vec w,Vec y)
+{
+  const PetscScalar *ypa,*wa;
+  PetscScalar       *ya;
+  PetscInt          i,m;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetLocalSize(yp,&m);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(yp,&ypa);CHKERRQ(ierr);
+  ierr = VecGetArray(y,&ya);CHKERRQ(ierr);
+  if (!w) {
+    for (i=0; i<m; i++) ya[rd->perm[i]] = ypa[i];
+  } else {
+    if (w != y) {ierr = VecGetArrayRead(w,&wa);CHKERRQ(ierr);}
+    else wa = ya;
+    for (i=0; i<m; i++) ya[rd->perm[i]] = wa[rd->perm[i]] + ypa[i];
+    if (w != y) {ierr = VecRestoreArrayRead(w,&wa);CHKERRQ(ierr);}
+  }
+  ierr = VecRestoreArray(y,&ya);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(yp,&ypa);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* yy = A xx with the reordered copies of the local blocks, added to ww if it is given */
+static PetscErrorCode MatMultReordered_MPIAIJ(Mat A,Vec xx,Vec ww,Vec yy)
+{
+  Mat_MPIAIJ         *a  = (Mat_MPIAIJ*)A->data;
+  Mat_MPIAIJ_Reorder *rd = a->reorder;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  ierr = VecScatterBegin(a->Mvctx,xx,a->lvec,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  ierr = MatReorderPermute_Private(rd,xx,rd->x);CHKERRQ(ierr);
+  ierr = (*rd->A->ops->mult)(rd->A,rd->x,rd->y);CHKERRQ(ierr);
+  ierr = VecScatterEnd(a->Mvctx,xx,a->lvec,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  ierr = (*rd->B->ops->multadd)(rd->B,a->lvec,rd->y,rd->y);CHKERRQ(ierr);
+  ierr = MatReorderUnpermute_Private(rd,rd->y,ww,yy);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatMult_MPIAIJ(Mat A,Vec xx,Vec yy)
 {
   Mat_MPIAIJ     *a = (Mat_MPIAIJ*)A->data;
@@ -939,6 +1362,11 @@ PetscErrorCode MatMult_MPIAIJ(Mat A,Vec xx,Vec yy)
   PetscFunctionBegin;
   ierr = VecGetLocalSize(xx,&nt);CHKERRQ(ierr);
   if (nt != A->cmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Incompatible partition of A (%D) and xx (%D)",A->cmap->n,nt);
+  if (a->reordertype) {ierr = MatReorderSetUp_MPIAIJ(A);CHKERRQ(ierr);}
+  if (a->reorder) {
+    ierr = MatMultReordered_MPIAIJ(A,xx,NULL,yy);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
   ierr = VecScatterBegin(a->Mvctx,xx,a->lvec,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
   ierr = (*a->A->ops->mult)(a->A,xx,yy);CHKERRQ(ierr);
   ierr = VecScatterEnd(a->Mvctx,xx,a->lvec,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
@@ -962,6 +1390,11 @@ PetscErrorCode MatMultAdd_MPIAIJ(Mat A,Vec xx,Vec yy,Vec zz)
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
+  if (a->reordertype) {ierr = MatReorderSetUp_MPIAIJ(A);CHKERRQ(ierr);}
+  if (a->reorder) {
+    ierr = MatMultReordered_MPIAIJ(A,xx,yy,zz);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
   ierr = VecScatterBegin(a->Mvctx,xx,a->lvec,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
   ierr = (*a->A->ops->multadd)(a->A,xx,yy,zz);CHKERRQ(ierr);
   ierr = VecScatterEnd(a->Mvctx,xx,a->lvec,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
@@ -1105,6 +1538,9 @@ PetscErrorCode MatDestroy_MPIAIJ(Mat mat)
   ierr = VecScatterDestroy(&aij->Mvctx);CHKERRQ(ierr);
   ierr = PetscFree2(aij->rowvalues,aij->rowindices);CHKERRQ(ierr);
   ierr = PetscFree(aij->ld);CHKERRQ(ierr);
+  ierr = MatFrozenDestroy_MPIAIJ(&aij->frozen);CHKERRQ(ierr);
+  ierr = MatReorderDestroy_MPIAIJ(&aij->reorder);CHKERRQ(ierr);
+  ierr = PetscFree(aij->reordertype);CHKERRQ(ierr);
   ierr = PetscFree(mat->data);CHKERRQ(ierr);
 
   ierr = PetscObjectChangeTypeName((PetscObject)mat,0);CHKERRQ(ierr);
@@ -1115,6 +1551,8 @@ PetscErrorCode MatDestroy_MPIAIJ(Mat mat)
   ierr = PetscObjectComposeFunction((PetscObject)mat,"MatMPIAIJSetPreallocationCSR_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)mat,"MatDiagonalScaleLocal_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)mat,"MatConvert_mpiaij_mpisbaij_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)mat,"MatMPIAIJSetFrozenPattern_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)mat,"MatMPIAIJSetLocalityReordering_C",NULL);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_ELEMENTAL)
   ierr = PetscObjectComposeFunction((PetscObject)mat,"MatConvert_mpiaij_elemental_C",NULL);CHKERRQ(ierr);
 #endif
@@ -1125,6 +1563,76 @@ PetscErrorCode MatDestroy_MPIAIJ(Mat mat)
   PetscFunctionReturn(0);
 }
 
+#if defined(PETSC_HAVE_MPIIO)
+/*
+   Each process writes its own row lengths, column indices and values with collective MPI-IO calls
+   at the offsets given by prefix sums of the local row and nonzero counts; the MPI-IO layer then
+   aggregates the pieces into large file accesses (two-phase I/O) instead of funneling the whole
+   matrix through the first process.
+*/
+static PetscErrorCode MatView_MPIAIJ_Binary_MPIIO(Mat mat,PetscViewer viewer)
+{
+  Mat_MPIAIJ     *aij = (Mat_MPIAIJ*)mat->data;
+  Mat_SeqAIJ     *A   = (Mat_SeqAIJ*)aij->A->data;
+  Mat_SeqAIJ     *B   = (Mat_SeqAIJ*)aij->B->data;
+  PetscErrorCode ierr;
+  MPI_Comm       comm;
+  PetscMPIInt    lm,lnz;
+  PetscInt       m = mat->rmap->n,M = mat->rmap->N,nz,nzstart,header[4],*row_lengths,*column_indices;
+  PetscInt       i,j,k,cnt,*garray = aij->garray,cstart = mat->cmap->rstart;
+  PetscScalar    *column_values;
+  MPI_Offset     off;
+  FILE           *file;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject)mat,&comm);CHKERRQ(ierr);
+  nz   = A->nz + B->nz;
+  ierr = MPI_Scan(&nz,&nzstart,1,MPIU_INT,MPI_SUM,comm);CHKERRQ(ierr);
+  nzstart -= nz;
+
+  header[0] = MAT_FILE_CLASSID;
+  header[1] = M;
+  header[2] = mat->cmap->N;
+  ierr = MPIU_Allreduce(&nz,&header[3],1,MPIU_INT,MPI_SUM,comm);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryWrite(viewer,header,4,PETSC_INT,PETSC_TRUE);CHKERRQ(ierr);
+
+  /* load up the local rows in global column order */
+  ierr = PetscMalloc3(m+1,&row_lengths,nz+1,&column_indices,nz+1,&column_values);CHKERRQ(ierr);
+  cnt  = 0;
+  for (i=0; i<m; i++) {
+    row_lengths[i] = A->i[i+1] - A->i[i] + B->i[i+1] - B->i[i];
+    for (j=B->i[i]; j<B->i[i+1]; j++) {
+      if (garray[B->j[j]] > cstart) break;
+      column_indices[cnt]  = garray[B->j[j]];
+      column_values[cnt++] = B->a[j];
+    }
+    for (k=A->i[i]; k<A->i[i+1]; k++) {
+      column_indices[cnt]  = A->j[k] + cstart;
+      column_values[cnt++] = A->a[k];
+    }
+    for (; j<B->i[i+1]; j++) {
+      column_indices[cnt]  = garray[B->j[j]];
+      column_values[cnt++] = B->a[j];
+    }
+  }
+  if (cnt != nz) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Internal PETSc error: cnt = %D nz = %D",cnt,nz);
+
+  ierr = PetscMPIIntCast(m,&lm);CHKERRQ(ierr);
+  ierr = PetscMPIIntCast(nz,&lnz);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryGetMPIIOOffset(viewer,&off);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryWriteAtAllMPIIO(viewer,off+(MPI_Offset)mat->rmap->rstart*sizeof(PetscInt),row_lengths,lm,MPIU_INT);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryWriteAtAllMPIIO(viewer,off+((MPI_Offset)M+nzstart)*sizeof(PetscInt),column_indices,lnz,MPIU_INT);CHKERRQ(ierr);
+  off += ((MPI_Offset)M+header[3])*sizeof(PetscInt);
+  ierr = PetscViewerBinaryWriteAtAllMPIIO(viewer,off+(MPI_Offset)nzstart*sizeof(PetscScalar),column_values,lnz,MPIU_SCALAR);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryAddMPIIOOffset(viewer,((MPI_Offset)M+header[3])*sizeof(PetscInt)+(MPI_Offset)header[3]*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = PetscFree3(row_lengths,column_indices,column_values);CHKERRQ(ierr);
+
+  ierr = PetscViewerBinaryGetInfoPointer(viewer,&file);CHKERRQ(ierr);
+  if (file) fprintf(file,"-matload_block_size %d\n",(int)PetscAbs(mat->rmap->bs));
+  PetscFunctionReturn(0);
+}
+#endif
+
 PetscErrorCode MatView_MPIAIJ_Binary(Mat mat,PetscViewer viewer)
 {
   Mat_MPIAIJ     *aij = (Mat_MPIAIJ*)mat->data;
@@ -1138,8 +1646,18 @@ PetscErrorCode MatView_MPIAIJ_Binary(Mat mat,PetscViewer viewer)
   PetscScalar    *column_values;
   PetscInt       message_count,flowcontrolcount;
   FILE           *file;
+#if defined(PETSC_HAVE_MPIIO)
+  PetscBool      usempiio;
+#endif
 
   PetscFunctionBegin;
+#if defined(PETSC_HAVE_MPIIO)
+  ierr = PetscViewerBinaryGetUseMPIIO(viewer,&usempiio);CHKERRQ(ierr);
+  if (usempiio) {
+    ierr = MatView_MPIAIJ_Binary_MPIIO(mat,viewer);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
   ierr = MPI_Comm_rank(PetscObjectComm((PetscObject)mat),&rank);CHKERRQ(ierr);
   ierr = MPI_Comm_size(PetscObjectComm((PetscObject)mat),&size);CHKERRQ(ierr);
   nz   = A->nz + B->nz;
@@ -1305,12 +1823,22 @@ PetscErrorCode MatView_MPIAIJ_ASCIIorDraworSocket(Mat mat,PetscViewer viewer)
       } else {
         ierr = PetscViewerASCIIPrintf(viewer,"not using I-node (on process 0) routines\n");CHKERRQ(ierr);
       }
+      if (aij->detectedbs > 1) {
+        ierr = PetscViewerASCIIPrintf(viewer,"detected dense blocks of size %D in the nonzero structure\n",aij->detectedbs);CHKERRQ(ierr);
+      } else if (aij->detectedbs == 1) {
+        ierr = PetscViewerASCIIPrintf(viewer,"detected no block structure in the nonzero structure\n");CHKERRQ(ierr);
+      }
       PetscFunctionReturn(0);
     } else if (format == PETSC_VIEWER_ASCII_FACTOR_INFO) {
       PetscFunctionReturn(0);
     }
   } else if (isbinary) {
-    if (size == 1) {
+    PetscBool usempiio = PETSC_FALSE;
+
+#if defined(PETSC_HAVE_MPIIO)
+    ierr = PetscViewerBinaryGetUseMPIIO(viewer,&usempiio);CHKERRQ(ierr);
+#endif
+    if (size == 1 && !usempiio) {
       ierr = PetscObjectSetName((PetscObject)aij->A,((PetscObject)mat)->name);CHKERRQ(ierr);
       ierr = MatView(aij->A,viewer);CHKERRQ(ierr);
     } else {
@@ -1404,6 +1932,27 @@ PetscErrorCode MatView_MPIAIJ(Mat mat,PetscViewer viewer)
   PetscFunctionReturn(0);
 }
 
+/* sweeps of the diagonal block, in the ordering of its reordered copy if there is one */
+static PetscErrorCode MatSORLocal_MPIAIJ(Mat matin,Vec bb,PetscReal omega,MatSORType flag,PetscReal fshift,PetscInt lits,Vec xx)
+{
+  Mat_MPIAIJ         *mat = (Mat_MPIAIJ*)matin->data;
+  Mat_MPIAIJ_Reorder *rd;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  if (mat->reordertype) {ierr = MatReorderSetUp_MPIAIJ(matin);CHKERRQ(ierr);}
+  rd = mat->reorder;
+  if (!rd) {
+    ierr = (*mat->A->ops->sor)(mat->A,bb,omega,flag,fshift,lits,1,xx);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = MatReorderPermute_Private(rd,bb,rd->y);CHKERRQ(ierr);
+  if (!(flag & SOR_ZERO_INITIAL_GUESS)) {ierr = MatReorderPermute_Private(rd,xx,rd->x);CHKERRQ(ierr);}
+  ierr = (*rd->A->ops->sor)(rd->A,rd->y,omega,flag,fshift,lits,1,rd->x);CHKERRQ(ierr);
+  ierr = MatReorderUnpermute_Private(rd,rd->x,NULL,xx);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatSOR_MPIAIJ(Mat matin,Vec bb,PetscReal omega,MatSORType flag,PetscReal fshift,PetscInt its,PetscInt lits,Vec xx)
 {
   Mat_MPIAIJ     *mat = (Mat_MPIAIJ*)matin->data;
@@ -1423,7 +1972,7 @@ PetscErrorCode MatSOR_MPIAIJ(Mat matin,Vec bb,PetscReal omega,MatSORType flag,Pe
 
   if ((flag & SOR_LOCAL_SYMMETRIC_SWEEP) == SOR_LOCAL_SYMMETRIC_SWEEP) {
     if (flag & SOR_ZERO_INITIAL_GUESS) {
-      ierr = (*mat->A->ops->sor)(mat->A,bb,omega,flag,fshift,lits,1,xx);CHKERRQ(ierr);
+      ierr = MatSORLocal_MPIAIJ(matin,bb,omega,flag,fshift,lits,xx);CHKERRQ(ierr);
       its--;
     }
 
@@ -1436,11 +1985,11 @@ PetscErrorCode MatSOR_MPIAIJ(Mat matin,Vec bb,PetscReal omega,MatSORType flag,Pe
       ierr = (*mat->B->ops->multadd)(mat->B,mat->lvec,bb,bb1);CHKERRQ(ierr);
 
       /* local sweep */
-      ierr = (*mat->A->ops->sor)(mat->A,bb1,omega,SOR_SYMMETRIC_SWEEP,fshift,lits,1,xx);CHKERRQ(ierr);
+      ierr = MatSORLocal_MPIAIJ(matin,bb1,omega,SOR_SYMMETRIC_SWEEP,fshift,lits,xx);CHKERRQ(ierr);
     }
   } else if (flag & SOR_LOCAL_FORWARD_SWEEP) {
     if (flag & SOR_ZERO_INITIAL_GUESS) {
-      ierr = (*mat->A->ops->sor)(mat->A,bb,omega,flag,fshift,lits,1,xx);CHKERRQ(ierr);
+      ierr = MatSORLocal_MPIAIJ(matin,bb,omega,flag,fshift,lits,xx);CHKERRQ(ierr);
       its--;
     }
     while (its--) {
@@ -1452,11 +2001,11 @@ PetscErrorCode MatSOR_MPIAIJ(Mat matin,Vec bb,PetscReal omega,MatSORType flag,Pe
       ierr = (*mat->B->ops->multadd)(mat->B,mat->lvec,bb,bb1);CHKERRQ(ierr);
 
       /* local sweep */
-      ierr = (*mat->A->ops->sor)(mat->A,bb1,omega,SOR_FORWARD_SWEEP,fshift,lits,1,xx);CHKERRQ(ierr);
+      ierr = MatSORLocal_MPIAIJ(matin,bb1,omega,SOR_FORWARD_SWEEP,fshift,lits,xx);CHKERRQ(ierr);
     }
   } else if (flag & SOR_LOCAL_BACKWARD_SWEEP) {
     if (flag & SOR_ZERO_INITIAL_GUESS) {
-      ierr = (*mat->A->ops->sor)(mat->A,bb,omega,flag,fshift,lits,1,xx);CHKERRQ(ierr);
+      ierr = MatSORLocal_MPIAIJ(matin,bb,omega,flag,fshift,lits,xx);CHKERRQ(ierr);
       its--;
     }
     while (its--) {
@@ -1468,7 +2017,7 @@ PetscErrorCode MatSOR_MPIAIJ(Mat matin,Vec bb,PetscReal omega,MatSORType flag,Pe
       ierr = (*mat->B->ops->multadd)(mat->B,mat->lvec,bb,bb1);CHKERRQ(ierr);
 
       /* local sweep */
-      ierr = (*mat->A->ops->sor)(mat->A,bb1,omega,SOR_BACKWARD_SWEEP,fshift,lits,1,xx);CHKERRQ(ierr);
+      ierr = MatSORLocal_MPIAIJ(matin,bb1,omega,SOR_BACKWARD_SWEEP,fshift,lits,xx);CHKERRQ(ierr);
     }
   } else if (flag & SOR_EISENSTAT) {
     Vec xx1;
@@ -1500,7 +2049,8 @@ PetscErrorCode MatSOR_MPIAIJ(Mat matin,Vec bb,PetscReal omega,MatSORType flag,Pe
 
   ierr = VecDestroy(&bb1);CHKERRQ(ierr);
 
-  matin->factorerrortype = mat->A->factorerrortype;
+  if (mat->reorder && !(flag & SOR_EISENSTAT)) matin->factorerrortype = mat->reorder->A->factorerrortype;
+  else matin->factorerrortype = mat->A->factorerrortype;
   PetscFunctionReturn(0);
 }
 
@@ -1887,86 +2437,183 @@ PetscErrorCode MatNorm_MPIAIJ(Mat mat,NormType type,PetscReal *norm)
   PetscFunctionReturn(0);
 }
 
+/*
+   The local rows of the transpose of an MPIAIJ matrix A are the local columns of A: the transpose of the diagonal
+   block of A gives part of them, and the entries of the off-diagonal block of A are sent to the owners of their
+   columns. The rows are kept in CSR format with the local transposed entries first, followed by the received ones,
+   so MAT_REUSE_MATRIX only needs to move the values, as long as A and its nonzero pattern are those the plan was
+   built for.
+*/
+typedef struct {
+  PetscSF          sf;           /* moves the entries of the off-diagonal block of A to their places in the rows of the transpose */
+  PetscInt         *i,*j;        /* local rows of the transpose, with global (unsorted) column indices */
+  PetscInt         *dslot;       /* place of each entry of the diagonal block of A in the rows of the transpose */
+  PetscObjectId    id;           /* the matrix A the plan was built for */
+  PetscObjectState nonzerostate; /* and its nonzero state, which is the same on all processes */
+} Mat_MPIAIJ_Transpose;
+
+static PetscErrorCode MatTransposeDestroy_MPIAIJ(void *ptr)
+{
+  Mat_MPIAIJ_Transpose *tr = (Mat_MPIAIJ_Transpose*)ptr;
+  PetscErrorCode       ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSFDestroy(&tr->sf);CHKERRQ(ierr);
+  ierr = PetscFree(tr->i);CHKERRQ(ierr);
+  ierr = PetscFree(tr->j);CHKERRQ(ierr);
+  ierr = PetscFree(tr->dslot);CHKERRQ(ierr);
+  ierr = PetscFree(tr);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatTransposeSetUp_MPIAIJ(Mat A,Mat_MPIAIJ_Transpose **plan)
+{
+  Mat_MPIAIJ           *a   = (Mat_MPIAIJ*)A->data;
+  Mat_SeqAIJ           *Aloc=(Mat_SeqAIJ*)a->A->data,*Bloc=(Mat_SeqAIJ*)a->B->data;
+  PetscInt             ma = A->rmap->n,na = A->cmap->n,nb = a->B->cmap->n,rstart = A->rmap->rstart;
+  PetscInt             *ai = Aloc->i,*aj = Aloc->j,*bi = Bloc->i,*bj = Bloc->j,*o_nnz,*g_nnz,*goff,*rows,i,k,r,d,e;
+  PetscMPIInt          *gowner;
+  PetscSFNode          *iremote;
+  PetscSF              sf;
+  Mat_MPIAIJ_Transpose *tr;
+  PetscErrorCode       ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscNew(&tr);CHKERRQ(ierr);
+  ierr = PetscCalloc1(na+1,&tr->i);CHKERRQ(ierr);
+  ierr = PetscMalloc1(ai[ma],&tr->dslot);CHKERRQ(ierr);
+  ierr = PetscMalloc4(na,&o_nnz,nb,&g_nnz,nb,&goff,nb,&gowner);CHKERRQ(ierr);
+
+  /* number of entries of each local column of A in the diagonal and the off-diagonal blocks */
+  for (e=0; e<ai[ma]; e++) tr->i[aj[e]+1]++;
+  ierr = PetscMemzero(g_nnz,nb*sizeof(PetscInt));CHKERRQ(ierr);
+  for (e=0; e<bi[ma]; e++) g_nnz[bj[e]]++;
+
+  /* sum the off-diagonal counts on the owners of the columns, then give each sender its place in the rows */
+  ierr = PetscSFCreate(PetscObjectComm((PetscObject)A),&sf);CHKERRQ(ierr);
+  ierr = PetscSFSetGraphLayout(sf,A->cmap,nb,NULL,PETSC_USE_POINTER,a->garray);CHKERRQ(ierr);
+  ierr = PetscSFSetFromOptions(sf);CHKERRQ(ierr);
+  ierr = PetscMemzero(o_nnz,na*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscSFReduceBegin(sf,MPIU_INT,g_nnz,o_nnz,MPIU_SUM);CHKERRQ(ierr);
+  ierr = PetscSFReduceEnd(sf,MPIU_INT,g_nnz,o_nnz,MPIU_SUM);CHKERRQ(ierr);
+  for (r=0; r<na; r++) {
+    d          = tr->i[r+1];
+    tr->i[r+1] = tr->i[r] + d + o_nnz[r];
+    o_nnz[r]   = tr->i[r] + d;
+  }
+  ierr = PetscSFFetchAndOpBegin(sf,MPIU_INT,o_nnz,g_nnz,goff,MPIU_SUM);CHKERRQ(ierr);
+  ierr = PetscSFFetchAndOpEnd(sf,MPIU_INT,o_nnz,g_nnz,goff,MPIU_SUM);CHKERRQ(ierr);
+  ierr = PetscSFDestroy(&sf);CHKERRQ(ierr);
+
+  /* the diagonal block is transposed locally */
+  ierr = PetscMalloc1(tr->i[na],&tr->j);CHKERRQ(ierr);
+  for (r=0; r<na; r++) o_nnz[r] = tr->i[r];
+  for (i=0; i<ma; i++) {
+    for (e=ai[i]; e<ai[i+1]; e++) {
+      tr->dslot[e]        = o_nnz[aj[e]]++;
+      tr->j[tr->dslot[e]] = rstart + i;
+    }
+  }
+
+  /* one leaf per entry of the off-diagonal block, its root is its place in the row of the transpose */
+  for (k=0; k<nb; k++) {ierr = PetscLayoutFindOwner(A->cmap,a->garray[k],&gowner[k]);CHKERRQ(ierr);}
+  ierr = PetscMalloc1(bi[ma],&iremote);CHKERRQ(ierr);
+  ierr = PetscMalloc1(bi[ma],&rows);CHKERRQ(ierr);
+  for (i=0; i<ma; i++) {
+    for (e=bi[i]; e<bi[i+1]; e++) {
+      k                = bj[e];
+      iremote[e].rank  = gowner[k];
+      iremote[e].index = goff[k]++;
+      rows[e]          = rstart + i;
+    }
+  }
+  ierr = PetscFree4(o_nnz,g_nnz,goff,gowner);CHKERRQ(ierr);
+  ierr = PetscSFCreate(PetscObjectComm((PetscObject)A),&tr->sf);CHKERRQ(ierr);
+  ierr = PetscSFSetGraph(tr->sf,tr->i[na],bi[ma],NULL,PETSC_OWN_POINTER,iremote,PETSC_OWN_POINTER);CHKERRQ(ierr);
+  ierr = PetscSFSetFromOptions(tr->sf);CHKERRQ(ierr);
+  ierr = PetscSFReduceBegin(tr->sf,MPIU_INT,rows,tr->j,MPIU_REPLACE);CHKERRQ(ierr);
+  ierr = PetscSFReduceEnd(tr->sf,MPIU_INT,rows,tr->j,MPIU_REPLACE);CHKERRQ(ierr);
+  ierr = PetscFree(rows);CHKERRQ(ierr);
+  tr->id           = ((PetscObject)A)->id;
+  tr->nonzerostate = A->nonzerostate;
+  *plan = tr;
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatTranspose_MPIAIJ(Mat A,MatReuse reuse,Mat *matout)
 {
-  Mat_MPIAIJ     *a   = (Mat_MPIAIJ*)A->data;
-  Mat_SeqAIJ     *Aloc=(Mat_SeqAIJ*)a->A->data,*Bloc=(Mat_SeqAIJ*)a->B->data;
-  PetscErrorCode ierr;
-  PetscInt       M      = A->rmap->N,N = A->cmap->N,ma,na,mb,nb,*ai,*aj,*bi,*bj,row,*cols,*cols_tmp,i;
-  PetscInt       cstart = A->cmap->rstart,ncol;
-  Mat            B;
-  MatScalar      *array;
+  Mat_MPIAIJ           *a   = (Mat_MPIAIJ*)A->data;
+  Mat_SeqAIJ           *Aloc=(Mat_SeqAIJ*)a->A->data,*Bloc=(Mat_SeqAIJ*)a->B->data;
+  PetscErrorCode       ierr;
+  PetscInt             M = A->rmap->N,N = A->cmap->N,ma = A->rmap->n,na = A->cmap->n,cstart = A->cmap->rstart,e,r,row;
+  Mat                  B;
+  Mat_MPIAIJ_Transpose *tr = NULL;
+  PetscContainer       container = NULL;
+  PetscScalar          *v;
+  PetscBool            nooffprocentries,rebuilt = PETSC_FALSE;
 
   PetscFunctionBegin;
   if (reuse == MAT_INPLACE_MATRIX && M != N) SETERRQ(PetscObjectComm((PetscObject)A),PETSC_ERR_ARG_SIZ,"Square matrix only for in-place");
 
-  ma = A->rmap->n; na = A->cmap->n; mb = a->B->rmap->n; nb = a->B->cmap->n;
-  ai = Aloc->i; aj = Aloc->j;
-  bi = Bloc->i; bj = Bloc->j;
-  if (reuse == MAT_INITIAL_MATRIX || *matout == A) {
-    PetscInt             *d_nnz,*g_nnz,*o_nnz;
-    PetscSFNode          *oloc;
-    PETSC_UNUSED PetscSF sf;
-
-    ierr = PetscMalloc4(na,&d_nnz,na,&o_nnz,nb,&g_nnz,nb,&oloc);CHKERRQ(ierr);
-    /* compute d_nnz for preallocation */
-    ierr = PetscMemzero(d_nnz,na*sizeof(PetscInt));CHKERRQ(ierr);
-    for (i=0; i<ai[ma]; i++) {
-      d_nnz[aj[i]]++;
-      aj[i] += cstart; /* global col index to be used by MatSetValues() */
-    }
-    /* compute local off-diagonal contributions */
-    ierr = PetscMemzero(g_nnz,nb*sizeof(PetscInt));CHKERRQ(ierr);
-    for (i=0; i<bi[ma]; i++) g_nnz[bj[i]]++;
-    /* map those to global */
-    ierr = PetscSFCreate(PetscObjectComm((PetscObject)A),&sf);CHKERRQ(ierr);
-    ierr = PetscSFSetGraphLayout(sf,A->cmap,nb,NULL,PETSC_USE_POINTER,a->garray);CHKERRQ(ierr);
-    ierr = PetscSFSetFromOptions(sf);CHKERRQ(ierr);
-    ierr = PetscMemzero(o_nnz,na*sizeof(PetscInt));CHKERRQ(ierr);
-    ierr = PetscSFReduceBegin(sf,MPIU_INT,g_nnz,o_nnz,MPIU_SUM);CHKERRQ(ierr);
-    ierr = PetscSFReduceEnd(sf,MPIU_INT,g_nnz,o_nnz,MPIU_SUM);CHKERRQ(ierr);
-    ierr = PetscSFDestroy(&sf);CHKERRQ(ierr);
+  if (reuse == MAT_REUSE_MATRIX) {
+    ierr = PetscObjectQuery((PetscObject)*matout,"MatTranspose_MPIAIJ",(PetscObject*)&container);CHKERRQ(ierr);
+    if (container) {
+      ierr = PetscContainerGetPointer(container,(void**)&tr);CHKERRQ(ierr);
+      /* the plan of another matrix or of an older nonzero pattern of A is rebuilt */
+      if (tr->id != ((PetscObject)A)->id || tr->nonzerostate != A->nonzerostate) {
+        ierr = MatTransposeDestroy_MPIAIJ(tr);CHKERRQ(ierr);
+        ierr = MatTransposeSetUp_MPIAIJ(A,&tr);CHKERRQ(ierr);
+        ierr = PetscContainerSetPointer(container,tr);CHKERRQ(ierr);
+        rebuilt = PETSC_TRUE;
+      }
+    }
+  }
+  if (!tr) {
+    ierr    = MatTransposeSetUp_MPIAIJ(A,&tr);CHKERRQ(ierr);
+    rebuilt = PETSC_TRUE;
+  }
+
+  /* move the values of the off-diagonal block while transposing the diagonal one */
+  ierr = PetscMalloc1(tr->i[na],&v);CHKERRQ(ierr);
+  ierr = PetscSFReduceBegin(tr->sf,MPIU_SCALAR,Bloc->a,v,MPIU_REPLACE);CHKERRQ(ierr);
+  for (e=0; e<Aloc->i[ma]; e++) v[tr->dslot[e]] = Aloc->a[e];
+  ierr = PetscSFReduceEnd(tr->sf,MPIU_SCALAR,Bloc->a,v,MPIU_REPLACE);CHKERRQ(ierr);
 
+  if (reuse == MAT_REUSE_MATRIX) {
+    B    = *matout;
+    ierr = MatSetOption(B,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_TRUE);CHKERRQ(ierr);
+    /* entries of B outside of the pattern the plan was built for must not keep their old values */
+    if (rebuilt) {ierr = MatZeroEntries(B);CHKERRQ(ierr);}
+    for (r=0; r<na; r++) {
+      row  = cstart + r;
+      ierr = MatSetValues(B,1,&row,tr->i[r+1]-tr->i[r],tr->j+tr->i[r],v+tr->i[r],INSERT_VALUES);CHKERRQ(ierr);
+    }
+    nooffprocentries    = B->nooffprocentries;
+    B->nooffprocentries = PETSC_TRUE;
+    ierr = MatAssemblyBegin(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+    ierr = MatAssemblyEnd(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+    B->nooffprocentries = nooffprocentries;
+  } else {
     ierr = MatCreate(PetscObjectComm((PetscObject)A),&B);CHKERRQ(ierr);
     ierr = MatSetSizes(B,A->cmap->n,A->rmap->n,N,M);CHKERRQ(ierr);
     ierr = MatSetBlockSizes(B,PetscAbs(A->cmap->bs),PetscAbs(A->rmap->bs));CHKERRQ(ierr);
     ierr = MatSetType(B,((PetscObject)A)->type_name);CHKERRQ(ierr);
-    ierr = MatMPIAIJSetPreallocation(B,0,d_nnz,0,o_nnz);CHKERRQ(ierr);
-    ierr = PetscFree4(d_nnz,o_nnz,g_nnz,oloc);CHKERRQ(ierr);
-  } else {
-    B    = *matout;
-    ierr = MatSetOption(B,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_TRUE);CHKERRQ(ierr);
-    for (i=0; i<ai[ma]; i++) aj[i] += cstart; /* global col index to be used by MatSetValues() */
+    ierr = MatMPIAIJSetPreallocationCSR(B,tr->i,tr->j,v);CHKERRQ(ierr);
   }
+  ierr = PetscFree(v);CHKERRQ(ierr);
 
-  /* copy over the A part */
-  array = Aloc->a;
-  row   = A->rmap->rstart;
-  for (i=0; i<ma; i++) {
-    ncol = ai[i+1]-ai[i];
-    ierr = MatSetValues(B,ncol,aj,1,&row,array,INSERT_VALUES);CHKERRQ(ierr);
-    row++;
-    array += ncol; aj += ncol;
-  }
-  aj = Aloc->j;
-  for (i=0; i<ai[ma]; i++) aj[i] -= cstart; /* resume local col index */
-
-  /* copy over the B part */
-  ierr  = PetscCalloc1(bi[mb],&cols);CHKERRQ(ierr);
-  array = Bloc->a;
-  row   = A->rmap->rstart;
-  for (i=0; i<bi[mb]; i++) cols[i] = a->garray[bj[i]];
-  cols_tmp = cols;
-  for (i=0; i<mb; i++) {
-    ncol = bi[i+1]-bi[i];
-    ierr = MatSetValues(B,ncol,cols_tmp,1,&row,array,INSERT_VALUES);CHKERRQ(ierr);
-    row++;
-    array += ncol; cols_tmp += ncol;
-  }
-  ierr = PetscFree(cols);CHKERRQ(ierr);
-
-  ierr = MatAssemblyBegin(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
-  ierr = MatAssemblyEnd(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  /* keep the communication pattern with the transpose for MAT_REUSE_MATRIX */
+  if (!container) {
+    if (reuse == MAT_INPLACE_MATRIX) {
+      ierr = MatTransposeDestroy_MPIAIJ(tr);CHKERRQ(ierr);
+    } else {
+      ierr = PetscContainerCreate(PETSC_COMM_SELF,&container);CHKERRQ(ierr);
+      ierr = PetscContainerSetPointer(container,tr);CHKERRQ(ierr);
+      ierr = PetscContainerSetUserDestroy(container,MatTransposeDestroy_MPIAIJ);CHKERRQ(ierr);
+      ierr = PetscObjectCompose((PetscObject)B,"MatTranspose_MPIAIJ",(PetscObject)container);CHKERRQ(ierr);
+      ierr = PetscContainerDestroy(&container);CHKERRQ(ierr);
+    }
+  }
   if (reuse == MAT_INITIAL_MATRIX || reuse == MAT_REUSE_MATRIX) {
     *matout = B;
   } else {
@@ -2392,6 +3039,13 @@ PetscErrorCode MatMPIAIJSetUseScalableIncreaseOverlap_MPIAIJ(Mat A,PetscBool sc)
 +    A - the matrix
 -    sc - PETSC_TRUE indicates use the scalable algorithm (default is not to use the scalable algorithm)
 
+   Options Database Key:
+.  -mat_increase_overlap_scalable - use the scalable algorithm
+
+   Notes: The scalable algorithm keeps each index set in a hash table and at each level of overlap only expands,
+   and communicates, the rows added by the previous level. Its memory is proportional to the size of the index
+   sets rather than to the global number of rows or the number of processes.
+
  Level: advanced
 
 @*/
@@ -2404,10 +3058,122 @@ PetscErrorCode MatMPIAIJSetUseScalableIncreaseOverlap(Mat A,PetscBool sc)
   PetscFunctionReturn(0);
 }
 
+PetscErrorCode MatMPIAIJSetFrozenPattern_MPIAIJ(Mat A,PetscBool flg)
+{
+  Mat_MPIAIJ     *a = (Mat_MPIAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  a->freeze = flg;
+  if (!flg && a->frozen) {
+    if (a->frozen->sf) { /* restore the handling of new nonzero locations in place before the pattern was frozen */
+      ((Mat_SeqAIJ*)a->A->data)->nonew = a->frozen->nonewA;
+      ((Mat_SeqAIJ*)a->B->data)->nonew = a->frozen->nonewB;
+    }
+    ierr = MatFrozenDestroy_MPIAIJ(&a->frozen);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*@
+   MatMPIAIJSetFrozenPattern - Freezes the nonzero pattern of the matrix, including the off-process entries, on
+   the next final assembly so that later assemblies only move values
+
+   Collective on Mat
+
+   Input Parameters:
++    A - the matrix
+-    flg - PETSC_TRUE to freeze the pattern on the next final assembly, PETSC_FALSE to return to the usual assembly
+
+   Options Database Key:
+.  -mat_frozen_pattern - freeze the pattern on the first final assembly
+
+   Notes: The off-process entries set before the final assembly that freezes the pattern are remembered; each
+   process then adds the values it sets in those entries to a private copy of their rows, and the assembly sends
+   these values to the owners, with no indices, in a single exchange. The owners add them directly in place, with
+   no stash, search or sorting.
+
+   Once the pattern is frozen, off-process entries must be set with ADD_VALUES and be among those set in the
+   assembly that froze the pattern, and new nonzero locations generate an error. Operations that change the
+   nonzero pattern, such as MatZeroRows() without MAT_KEEP_NONZERO_PATTERN, are not allowed. Calling this routine
+   with PETSC_FALSE restores the handling of new nonzero locations in place before the pattern was frozen.
+
+   This is intended for the repeated assembly of Jacobians with the same nonzero structure, for example in
+   Newton's method.
+
+ Level: advanced
+
+.seealso: MatSetOption(), MAT_SUBSET_OFF_PROC_ENTRIES, MAT_NEW_NONZERO_LOCATIONS
+@*/
+PetscErrorCode MatMPIAIJSetFrozenPattern(Mat A,PetscBool flg)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(A,MAT_CLASSID,1);
+  PetscValidLogicalCollectiveBool(A,flg,2);
+  ierr = PetscTryMethod(A,"MatMPIAIJSetFrozenPattern_C",(Mat,PetscBool),(A,flg));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMPIAIJSetLocalityReordering_MPIAIJ(Mat A,MatOrderingType type)
+{
+  Mat_MPIAIJ     *a = (Mat_MPIAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatReorderDestroy_MPIAIJ(&a->reorder);CHKERRQ(ierr);
+  ierr = PetscFree(a->reordertype);CHKERRQ(ierr);
+  if (type) {ierr = PetscStrallocpy(type,&a->reordertype);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+/*@C
+   MatMPIAIJSetLocalityReordering - Sets an ordering of the local rows and columns in which MatMult(), MatMultAdd()
+   and the local sweeps of MatSOR() traverse the matrix, to improve the locality of their accesses to the vectors
+
+   Not Collective
+
+   Input Parameters:
++    A - the matrix
+-    type - the ordering, for example MATORDERINGRCM, or NULL to use the local numbering of the matrix
+
+   Options Database Key:
+.  -mat_locality_reorder <type> - sets the ordering
+
+   Notes: Each process computes the ordering of its diagonal block with MatGetOrdering() and keeps copies of its
+   diagonal and off-diagonal blocks with the rows and columns renumbered; the products permute the local parts of
+   the vectors, so the application, the vectors and the other operations keep the original numbering. The copies
+   are built on the first product after an assembly that changes the nonzero structure and their values are copied
+   again after the values of the matrix change. They double the memory used by the matrix.
+
+   With MATORDERINGRCM the diagonal block of a matrix from an unstructured mesh, whose numbering does not follow
+   the mesh, becomes banded. The local sweeps of MatSOR() are done in the new ordering, so the iterates differ from
+   those in the original numbering; Eisenstat's trick uses the original numbering. The processes whose diagonal
+   block is not square use the original numbering.
+
+   The factorizations used by PCBJACOBI and PCASM order the diagonal block with -sub_pc_factor_mat_ordering_type.
+
+ Level: advanced
+
+.seealso: MatGetOrdering(), MatOrderingType, MatSOR(), MatCreateAIJ()
+@*/
+PetscErrorCode MatMPIAIJSetLocalityReordering(Mat A,MatOrderingType type)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(A,MAT_CLASSID,1);
+  ierr = PetscTryMethod(A,"MatMPIAIJSetLocalityReordering_C",(Mat,MatOrderingType),(A,type));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatSetFromOptions_MPIAIJ(PetscOptionItems *PetscOptionsObject,Mat A)
 {
+  Mat_MPIAIJ           *a = (Mat_MPIAIJ*)A->data;
   PetscErrorCode       ierr;
   PetscBool            sc = PETSC_FALSE,flg;
+  char                 type[256];
 
   PetscFunctionBegin;
   ierr = PetscOptionsHead(PetscOptionsObject,"MPIAIJ options");CHKERRQ(ierr);
@@ -2417,6 +3183,15 @@ PetscErrorCode MatSetFromOptions_MPIAIJ(PetscOptionItems *PetscOptionsObject,Mat
     if (flg) {
       ierr = MatMPIAIJSetUseScalableIncreaseOverlap(A,sc);CHKERRQ(ierr);
     }
+    ierr = PetscOptionsBool("-mat_detect_block_size","Look for dense blocks in the nonzero structure on the final assembly","None",a->detectbs,&a->detectbs,NULL);CHKERRQ(ierr);
+    ierr = PetscOptionsBool("-mat_frozen_pattern","Freeze the nonzero pattern on the next final assembly","MatMPIAIJSetFrozenPattern",a->freeze,&sc,&flg);CHKERRQ(ierr);
+    if (flg) {
+      ierr = MatMPIAIJSetFrozenPattern(A,sc);CHKERRQ(ierr);
+    }
+    ierr = PetscOptionsFList("-mat_locality_reorder","Ordering of the local rows and columns for MatMult() and MatSOR()","MatMPIAIJSetLocalityReordering",MatOrderingList,a->reordertype ? a->reordertype : MATORDERINGNATURAL,type,sizeof(type),&flg);CHKERRQ(ierr);
+    if (flg) {
+      ierr = MatMPIAIJSetLocalityReordering(A,type);CHKERRQ(ierr);
+    }
   ierr = PetscOptionsEnd();CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -2733,6 +3508,43 @@ PetscErrorCode MatDuplicate_MPIAIJ(Mat matin,MatDuplicateOption cpvalues,Mat *ne
   PetscFunctionReturn(0);
 }
 
+#if defined(PETSC_HAVE_MPIIO)
+/*
+   Reads the row lengths, column indices and values of rows rstart to rstart+m of a matrix with M rows
+   and NZ nonzeros with collective MPI-IO calls; every process reads only its own part of the file
+*/
+static PetscErrorCode MatLoad_MPIAIJ_MPIIO_Private(PetscViewer viewer,MPI_Comm comm,PetscInt M,PetscInt NZ,PetscInt rstart,PetscInt m,PetscInt *ourlens,PetscInt *nz,PetscInt **mycols,PetscScalar **vals)
+{
+  PetscErrorCode ierr;
+  PetscMPIInt    lm,lnz;
+  PetscInt       i,nzstart;
+  MPI_File       mfdes;
+  MPI_Offset     off;
+
+  PetscFunctionBegin;
+  ierr = PetscMPIIntCast(m,&lm);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryGetMPIIODescriptor(viewer,&mfdes);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryGetMPIIOOffset(viewer,&off);CHKERRQ(ierr);
+  ierr = MPI_File_set_view(mfdes,off,MPIU_INT,MPIU_INT,(char*)"native",MPI_INFO_NULL);CHKERRQ(ierr);
+  ierr = MPIU_File_read_at_all(mfdes,(MPI_Offset)rstart,ourlens,lm,MPIU_INT,MPI_STATUS_IGNORE);CHKERRQ(ierr);
+  *nz  = 0;
+  for (i=0; i<m; i++) *nz += ourlens[i];
+  ierr = MPI_Scan(nz,&nzstart,1,MPIU_INT,MPI_SUM,comm);CHKERRQ(ierr);
+  nzstart -= *nz;
+  if (nzstart + *nz > NZ) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"Row lengths in file add up to more than the %D nonzeros in the header (at least %D)",NZ,nzstart+*nz);
+  ierr = PetscMPIIntCast(*nz,&lnz);CHKERRQ(ierr);
+
+  ierr = PetscMalloc1(*nz+1,mycols);CHKERRQ(ierr);
+  ierr = PetscMalloc1(*nz+1,vals);CHKERRQ(ierr);
+  ierr = MPIU_File_read_at_all(mfdes,(MPI_Offset)M+nzstart,*mycols,lnz,MPIU_INT,MPI_STATUS_IGNORE);CHKERRQ(ierr);
+  off += ((MPI_Offset)M+NZ)*sizeof(PetscInt);
+  ierr = MPI_File_set_view(mfdes,off,MPIU_SCALAR,MPIU_SCALAR,(char*)"native",MPI_INFO_NULL);CHKERRQ(ierr);
+  ierr = MPIU_File_read_at_all(mfdes,(MPI_Offset)nzstart,*vals,lnz,MPIU_SCALAR,MPI_STATUS_IGNORE);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryAddMPIIOOffset(viewer,((MPI_Offset)M+NZ)*sizeof(PetscInt)+(MPI_Offset)NZ*sizeof(PetscScalar));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
 PetscErrorCode MatLoad_MPIAIJ(Mat newMat, PetscViewer viewer)
 {
   PetscScalar    *vals,*svals;
@@ -2745,6 +3557,7 @@ PetscErrorCode MatLoad_MPIAIJ(Mat newMat, PetscViewer viewer)
   PetscInt       cend,cstart,n,*rowners;
   int            fd;
   PetscInt       bs = newMat->rmap->bs;
+  PetscBool      usempiio = PETSC_FALSE;
 
   PetscFunctionBegin;
   /* force binary viewer to load .info file if it has not yet done so */
@@ -2752,11 +3565,20 @@ PetscErrorCode MatLoad_MPIAIJ(Mat newMat, PetscViewer viewer)
   ierr = PetscObjectGetComm((PetscObject)viewer,&comm);CHKERRQ(ierr);
   ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
   ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
-  ierr = PetscViewerBinaryGetDescriptor(viewer,&fd);CHKERRQ(ierr);
-  if (!rank) {
-    ierr = PetscBinaryRead(fd,(char*)header,4,PETSC_INT);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_MPIIO)
+  ierr = PetscViewerBinaryGetUseMPIIO(viewer,&usempiio);CHKERRQ(ierr);
+#endif
+  if (usempiio) {
+    ierr = PetscViewerBinaryRead(viewer,header,4,NULL,PETSC_INT);CHKERRQ(ierr);
     if (header[0] != MAT_FILE_CLASSID) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"not matrix object");
     if (header[3] < 0) SETERRQ(PetscObjectComm((PetscObject)newMat),PETSC_ERR_FILE_UNEXPECTED,"Matrix stored in special format on disk,cannot load as MATMPIAIJ");
+  } else {
+    ierr = PetscViewerBinaryGetDescriptor(viewer,&fd);CHKERRQ(ierr);
+    if (!rank) {
+      ierr = PetscBinaryRead(fd,(char*)header,4,PETSC_INT);CHKERRQ(ierr);
+      if (header[0] != MAT_FILE_CLASSID) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"not matrix object");
+      if (header[3] < 0) SETERRQ(PetscObjectComm((PetscObject)newMat),PETSC_ERR_FILE_UNEXPECTED,"Matrix stored in special format on disk,cannot load as MATMPIAIJ");
+    }
   }
 
   ierr = PetscOptionsBegin(comm,NULL,"Options for loading MATMPIAIJ matrix","Mat");CHKERRQ(ierr);
@@ -2796,7 +3618,11 @@ PetscErrorCode MatLoad_MPIAIJ(Mat newMat, PetscViewer viewer)
 
   /* distribute row lengths to all processors */
   ierr = PetscMalloc2(m,&ourlens,m,&offlens);CHKERRQ(ierr);
-  if (!rank) {
+  if (usempiio) {
+#if defined(PETSC_HAVE_MPIIO)
+    ierr = MatLoad_MPIAIJ_MPIIO_Private(viewer,comm,M,header[3],rstart,m,ourlens,&nz,&mycols,&vals);CHKERRQ(ierr);
+#endif
+  } else if (!rank) {
     ierr = PetscBinaryRead(fd,ourlens,m,PETSC_INT);CHKERRQ(ierr);
     ierr = PetscMalloc1(mmax,&rowlengths);CHKERRQ(ierr);
     ierr = PetscCalloc1(size,&procsnz);CHKERRQ(ierr);
@@ -2816,7 +3642,9 @@ PetscErrorCode MatLoad_MPIAIJ(Mat newMat, PetscViewer viewer)
     ierr = MPIULong_Recv(ourlens,m,MPIU_INT,0,tag,comm);CHKERRQ(ierr);
   }
 
-  if (!rank) {
+  if (usempiio) {
+    /* column indices and values have already been read */
+  } else if (!rank) {
     /* determine max buffer needed and allocate it */
     maxnz = 0;
     for (i=0; i<size; i++) {
@@ -2883,7 +3711,18 @@ PetscErrorCode MatLoad_MPIAIJ(Mat newMat, PetscViewer viewer)
     ourlens[i] += offlens[i];
   }
 
-  if (!rank) {
+  if (usempiio) {
+    /* insert into matrix */
+    jj      = rstart;
+    smycols = mycols;
+    svals   = vals;
+    for (i=0; i<m; i++) {
+      ierr     = MatSetValues_MPIAIJ(newMat,1,&jj,ourlens[i],smycols,svals,INSERT_VALUES);CHKERRQ(ierr);
+      smycols += ourlens[i];
+      svals   += ourlens[i];
+      jj++;
+    }
+  } else if (!rank) {
     ierr = PetscMalloc1(maxnz+1,&vals);CHKERRQ(ierr);
 
     /* read in my part of the matrix numerical values  */
@@ -5314,6 +6153,14 @@ PetscErrorCode MatGetCommunicationStructs(Mat A, Vec *lvec, PetscInt *colmap[],
 
 PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJCRL(Mat,MatType,MatReuse,Mat*);
 PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJPERM(Mat,MatType,MatReuse,Mat*);
+PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJSELL(Mat,MatType,MatReuse,Mat*);
+PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJDelta(Mat,MatType,MatReuse,Mat*);
+#if defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX)
+PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJMixed(Mat,MatType,MatReuse,Mat*);
+#endif
+#if defined(PETSC_HAVE_OPENMP)
+PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPIAIJOMP(Mat,MatType,MatReuse,Mat*);
+#endif
 PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_MPISBAIJ(Mat,MatType,MatReuse,Mat*);
 #if defined(PETSC_HAVE_ELEMENTAL)
 PETSC_INTERN PetscErrorCode MatConvert_MPIAIJ_Elemental(Mat,MatType,MatReuse,Mat*);
@@ -5392,7 +6239,8 @@ PETSC_INTERN PetscErrorCode MatMatMult_MPIDense_MPIAIJ(Mat A,Mat B,MatReuse scal
    MATMPIAIJ - MATMPIAIJ = "mpiaij" - A matrix type to be used for parallel sparse matrices.
 
    Options Database Keys:
-. -mat_type mpiaij - sets the matrix type to "mpiaij" during a call to MatSetFromOptions()
++ -mat_type mpiaij - sets the matrix type to "mpiaij" during a call to MatSetFromOptions()
+- -mat_detect_block_size - on the final assembly look for dense blocks in the nonzero structure and use their size as the block size of the matrix
 
   Level: beginner
 
@@ -5438,6 +6286,8 @@ PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJ(Mat B)
   b->spptr = NULL;
 
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatMPIAIJSetUseScalableIncreaseOverlap_C",MatMPIAIJSetUseScalableIncreaseOverlap_MPIAIJ);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatMPIAIJSetFrozenPattern_C",MatMPIAIJSetFrozenPattern_MPIAIJ);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatMPIAIJSetLocalityReordering_C",MatMPIAIJSetLocalityReordering_MPIAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatStoreValues_C",MatStoreValues_MPIAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatRetrieveValues_C",MatRetrieveValues_MPIAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatIsTranspose_C",MatIsTranspose_MPIAIJ);CHKERRQ(ierr);
@@ -5446,6 +6296,14 @@ PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJ(Mat B)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatDiagonalScaleLocal_C",MatDiagonalScaleLocal_MPIAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_mpiaij_mpiaijperm_C",MatConvert_MPIAIJ_MPIAIJPERM);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_mpiaij_mpiaijcrl_C",MatConvert_MPIAIJ_MPIAIJCRL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_mpiaij_mpiaijsell_C",MatConvert_MPIAIJ_MPIAIJSELL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_mpiaij_mpiaijdelta_C",MatConvert_MPIAIJ_MPIAIJDelta);CHKERRQ(ierr);
+#if defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX)
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_mpiaij_mpiaijmixed_C",MatConvert_MPIAIJ_MPIAIJMixed);CHKERRQ(ierr);
+#endif
+#if defined(PETSC_HAVE_OPENMP)
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_mpiaij_mpiaijomp_C",MatConvert_MPIAIJ_MPIAIJOMP);CHKERRQ(ierr);
+#endif
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_mpiaij_mpisbaij_C",MatConvert_MPIAIJ_MPISBAIJ);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_ELEMENTAL)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_mpiaij_elemental_C",MatConvert_MPIAIJ_Elemental);CHKERRQ(ierr);
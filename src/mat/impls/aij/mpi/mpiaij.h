@@ -28,11 +28,40 @@ typedef struct { /* used by MatPtAP_MPIAIJ_MPIAIJ() and MatMatMult_MPIAIJ_MPIAIJ
   PetscBool   scalable;        /* flag determines scalable or non-scalable implementation */
   Mat         Rd,Ro,AP_loc,C_loc,C_oth;
 
+  /* used by the all-at-once algorithms, which never form A*P */
+  PetscInt    *c_othi,*c_othj;  /* rows of C computed by this process that belong to others, one for each column of P->B */
+  PetscScalar *c_otha;
+  PetscSF     sf;               /* sends the entries of c_otha to their owners */
+  PetscInt    nrecvrows,*recvrows,*recvi,*recvj; /* global row numbers and structure of the received rows */
+  PetscScalar *recva;
+  PetscBool   merged;           /* the symbolic phase has computed the values */
+
   Mat_Merge_SeqsToMPI *merge;
   PetscErrorCode (*destroy)(Mat);
   PetscErrorCode (*duplicate)(Mat,MatDuplicateOption,Mat*);
 } Mat_PtAPMPI;
 
+typedef struct { /* off-process entries of a matrix whose nonzero pattern is frozen, see MatMPIAIJSetFrozenPattern() */
+  PetscInt         nrows,*rows;         /* off-process rows set in the assembly that froze the pattern, sorted */
+  PetscInt         *i,*j;               /* their structure, with sorted global column indices */
+  PetscScalar      *v;                  /* values added to them since the last assembly */
+  PetscSF          sf;                  /* sends v to the owners of the rows */
+  PetscInt         nrecv,*dst;          /* received values go to a->a[dst] if dst >= 0, to b->a[-dst-2] if dst < -1 */
+  PetscScalar      *rv;
+  PetscObjectState state;               /* nonzero state of A and B when the pattern was frozen */
+  PetscInt         nonewA,nonewB;       /* a->nonew and b->nonew before the pattern was frozen, restored when it is unfrozen */
+} Mat_MPIAIJ_Frozen;
+
+typedef struct { /* copies of the local blocks in a locality improving ordering, see MatMPIAIJSetLocalityReordering() */
+  Mat              A,B;                 /* A(perm,perm) and B(perm,:) */
+  PetscInt         *perm;               /* local row and column perm[i] of the matrix is row and column i of the copies */
+  PetscInt         *amap,*bmap;         /* location in the blocks of the matrix of each nonzero of the copies */
+  Vec              x,y;                 /* work vectors in the new ordering */
+  PetscInt         aid,bid;             /* the blocks that were copied */
+  PetscObjectState anzstate,bnzstate;   /* and their nonzero states */
+  PetscObjectState state,astate,bstate; /* states of the matrix and blocks when the values were copied */
+} Mat_MPIAIJ_Reorder;
+
 typedef struct {
   Mat A,B;                             /* local submatrices: A (diag part),
                                            B (off-diag part) */
@@ -76,6 +105,14 @@ typedef struct {
   /* Used by MPICUSP and MPICUSPARSE classes */
   void * spptr;
 
+  PetscBool detectbs;              /* look for a block size on the final assembly, -mat_detect_block_size */
+  PetscInt  detectedbs;            /* block size found, 0 if not looked for */
+
+  PetscBool         freeze;        /* freeze the nonzero pattern on the next final assembly, -mat_frozen_pattern */
+  Mat_MPIAIJ_Frozen *frozen;
+
+  char               *reordertype;  /* ordering of the local rows and columns used by MatMult() and MatSOR(), -mat_locality_reorder */
+  Mat_MPIAIJ_Reorder *reorder;
 } Mat_MPIAIJ;
 
 PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJ(Mat);
@@ -116,6 +153,9 @@ PETSC_INTERN PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ(Mat,Mat,PetscReal,Mat*
 PETSC_INTERN PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ(Mat,Mat,Mat);
 
 PETSC_INTERN PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ_ptap(Mat,Mat,PetscReal,Mat*);
+PETSC_INTERN PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce(Mat,Mat,PetscReal,Mat*);
+PETSC_INTERN PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce_merged(Mat,Mat,PetscReal,Mat*);
+PETSC_INTERN PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce(Mat,Mat,Mat);
 PETSC_INTERN PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_ptap(Mat,Mat,Mat);
 
 PETSC_INTERN PetscErrorCode MatDestroy_MPIAIJ_PtAP(Mat);
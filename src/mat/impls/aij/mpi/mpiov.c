@@ -6,17 +6,16 @@
 #include <../src/mat/impls/aij/mpi/mpiaij.h>
 #include <petscbt.h>
 #include <petscsf.h>
+#include <petsc/private/hashseti.h>
 
 static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Once(Mat,PetscInt,IS*);
-static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Local(Mat,PetscInt,char**,PetscInt*,PetscInt**,PetscTable*);
+static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Local(Mat,PetscInt,char**,PetscInt*,PetscInt**,PetscHMapI*);
 static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Receive(Mat,PetscInt,PetscInt**,PetscInt**,PetscInt*);
 extern PetscErrorCode MatGetRow_MPIAIJ(Mat,PetscInt,PetscInt*,PetscInt**,PetscScalar**);
 extern PetscErrorCode MatRestoreRow_MPIAIJ(Mat,PetscInt,PetscInt*,PetscInt**,PetscScalar**);
 
-static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Once_Scalable(Mat,PetscInt,IS*);
-static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Local_Scalable(Mat,PetscInt,IS*);
+static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Frontier_Scalable(Mat,PetscInt,PetscHSetI*,PetscInt*,PetscInt**);
 static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Send_Scalable(Mat,PetscInt,PetscMPIInt,PetscMPIInt *,PetscInt *, PetscInt *,PetscInt **,PetscInt **);
-static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Receive_Scalable(Mat,PetscInt,IS*,PetscInt,PetscInt *);
 
 
 PetscErrorCode MatIncreaseOverlap_MPIAIJ(Mat C,PetscInt imax,IS is[],PetscInt ov)
@@ -35,203 +34,213 @@ PetscErrorCode MatIncreaseOverlap_MPIAIJ(Mat C,PetscInt imax,IS is[],PetscInt ov
 PetscErrorCode MatIncreaseOverlap_MPIAIJ_Scalable(Mat C,PetscInt imax,IS is[],PetscInt ov)
 {
   PetscErrorCode ierr;
-  PetscInt       i;
+  PetscInt       i,j,n,*nfront,**front,*idx;
+  const PetscInt *indices;
+  PetscHSetI     *sets;
+  PetscBool      missing;
 
   PetscFunctionBegin;
   if (ov < 0) SETERRQ(PetscObjectComm((PetscObject)C),PETSC_ERR_ARG_OUTOFRANGE,"Negative overlap specified");
+  if (!ov) PetscFunctionReturn(0);
+  /* the first frontier is the index sets themselves */
+  ierr = PetscMalloc3(imax,&sets,imax,&nfront,imax,&front);CHKERRQ(ierr);
+  for (i=0; i<imax; i++) {
+    ierr = ISGetLocalSize(is[i],&n);CHKERRQ(ierr);
+    ierr = ISGetIndices(is[i],&indices);CHKERRQ(ierr);
+    ierr = PetscHSetICreate(&sets[i]);CHKERRQ(ierr);
+    ierr = PetscHSetIResize(sets[i],n);CHKERRQ(ierr);
+    ierr = PetscMalloc1(n,&front[i]);CHKERRQ(ierr);
+    for (j=0,nfront[i]=0; j<n; j++) {
+      ierr = PetscHSetIQueryAdd(sets[i],indices[j],&missing);CHKERRQ(ierr);
+      if (missing) front[i][nfront[i]++] = indices[j];
+    }
+    ierr = ISRestoreIndices(is[i],&indices);CHKERRQ(ierr);
+  }
   for (i=0; i<ov; ++i) {
-    ierr = MatIncreaseOverlap_MPIAIJ_Once_Scalable(C,imax,is);CHKERRQ(ierr);
+    ierr = MatIncreaseOverlap_MPIAIJ_Frontier_Scalable(C,imax,sets,nfront,front);CHKERRQ(ierr);
   }
+  for (i=0; i<imax; i++) {
+    ierr = PetscHSetIGetSize(sets[i],&n);CHKERRQ(ierr);
+    ierr = PetscMalloc1(n,&idx);CHKERRQ(ierr);
+    j    = 0;
+    ierr = PetscHSetIGetElems(sets[i],&j,idx);CHKERRQ(ierr);
+    ierr = PetscSortInt(n,idx);CHKERRQ(ierr);
+    ierr = PetscHSetIDestroy(&sets[i]);CHKERRQ(ierr);
+    ierr = PetscFree(front[i]);CHKERRQ(ierr);
+    ierr = ISDestroy(&is[i]);CHKERRQ(ierr);
+    ierr = ISCreateGeneral(PETSC_COMM_SELF,n,idx,PETSC_OWN_POINTER,&is[i]);CHKERRQ(ierr);
+  }
+  ierr = PetscFree3(sets,nfront,front);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
 
-static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Once_Scalable(Mat mat,PetscInt nidx,IS is[])
+/*
+   One level of the scalable overlap. The rows of each index set are kept in a hash set and only the frontier,
+   the rows added by the previous level, is expanded. Frontier rows owned by other processes are sent to their
+   owners as pairs <index set, row>, the owners return the columns of these rows. Each row is sent at most once
+   and the memory is proportional to the size of the index sets, not to the global size of the matrix or the
+   number of processes.
+*/
+static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Frontier_Scalable(Mat mat,PetscInt nidx,PetscHSetI sets[],PetscInt nfront[],PetscInt *front[])
 {
   PetscErrorCode ierr;
   MPI_Comm       comm;
-  PetscInt       *length,length_i,tlength,*remoterows,nrrows,reducednrrows,*rrow_ranks,*rrow_isids,i,j,owner;
-  PetscInt       *tosizes,*tosizes_temp,*toffsets,*fromsizes,*todata,*fromdata;
-  PetscInt       nrecvrows,*sbsizes = 0,*sbdata = 0;
-  const PetscInt *indices_i,**indices;
-  PetscLayout    rmap;
-  PetscMPIInt    rank,size,*toranks,*fromranks,nto,nfrom;
+  PetscInt       *remoterows,nrrows,reducednrrows,*rrow_ranks,*rrow_isids,i,j,k,l,owner;
+  PetscInt       *tosizes,*fromsizes,*todata,*fromdata,nrecvrows,*recvdata = NULL,nrecv = 0;
+  PetscInt       *sbsizes = NULL,*sbdata = NULL,nsend,*count,**newfront,an,bn,row,col,rstart,rend,cstart,is_id,n;
+  const PetscInt *gcols,*ai,*aj,*bi,*bj;
+  Mat            amat,bmat;
+  PetscLayout    rmap,cmap;
+  PetscMPIInt    size,*toranks,*fromranks,nto,nfrom;
   PetscSF        sf;
   PetscSFNode    *remote;
+  PetscBool      done,missing;
 
   PetscFunctionBegin;
   ierr = PetscObjectGetComm((PetscObject)mat,&comm);CHKERRQ(ierr);
-  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
   ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
-  /* get row map to determine where rows should be going */
-  ierr = MatGetLayouts(mat,&rmap,NULL);CHKERRQ(ierr);
-  /* retrieve IS data and put all together so that we
-   * can optimize communication
-   *  */
-  ierr = PetscCalloc2(nidx,(PetscInt ***)&indices,nidx,&length);CHKERRQ(ierr);
-  for (i=0,tlength=0; i<nidx; i++){
-    ierr = ISGetLocalSize(is[i],&length[i]);CHKERRQ(ierr);
-    tlength += length[i];
-    ierr = ISGetIndices(is[i],&indices[i]);CHKERRQ(ierr);
-  }
-  /* find these rows on remote processors */
-  ierr = PetscCalloc3(tlength,&remoterows,tlength,&rrow_ranks,tlength,&rrow_isids);CHKERRQ(ierr);
-  ierr = PetscCalloc3(size,&toranks,2*size,&tosizes,size,&tosizes_temp);CHKERRQ(ierr);
+  ierr = MatGetLayouts(mat,&rmap,&cmap);CHKERRQ(ierr);
+  ierr = PetscLayoutGetRange(rmap,&rstart,&rend);CHKERRQ(ierr);
+  ierr = PetscLayoutGetRange(cmap,&cstart,NULL);CHKERRQ(ierr);
+
+  /* frontier rows owned by other processes */
+  for (i=0,nrrows=0; i<nidx; i++) nrrows += nfront[i];
+  ierr = PetscMalloc3(nrrows,&remoterows,nrrows,&rrow_ranks,nrrows,&rrow_isids);CHKERRQ(ierr);
   nrrows = 0;
-  for (i=0; i<nidx; i++){
-    length_i     = length[i];
-    indices_i    = indices[i];
-    for (j=0; j<length_i; j++){
-      owner = -1;
-      ierr = PetscLayoutFindOwner(rmap,indices_i[j],&owner);CHKERRQ(ierr);
-      /* remote processors */
-      if (owner != rank){
-        tosizes_temp[owner]++; /* number of rows to owner */
-        rrow_ranks[nrrows]  = owner; /* processor */
-        rrow_isids[nrrows]   = i; /* is id */
-        remoterows[nrrows++] = indices_i[j]; /* row */
-      }
-    }
-    ierr = ISRestoreIndices(is[i],&indices[i]);CHKERRQ(ierr);
-  }
-  ierr = PetscFree2(indices,length);CHKERRQ(ierr);
-  /* test if we need to exchange messages
-   * generally speaking, we do not need to exchange
-   * data when overlap is 1
-   * */
+  for (i=0; i<nidx; i++) {
+    for (j=0; j<nfront[i]; j++) {
+      row = front[i][j];
+      if (row >= rstart && row < rend) continue;
+      ierr = PetscLayoutFindOwner(rmap,row,&owner);CHKERRQ(ierr);
+      rrow_ranks[nrrows]   = owner;
+      rrow_isids[nrrows]   = i;
+      remoterows[nrrows++] = row;
+    }
+  }
   ierr = MPIU_Allreduce(&nrrows,&reducednrrows,1,MPIU_INT,MPIU_MAX,comm);CHKERRQ(ierr);
-  /* we do not have any messages
-   * It usually corresponds to overlap 1
-   * */
-  if (!reducednrrows){
-    ierr = PetscFree3(toranks,tosizes,tosizes_temp);CHKERRQ(ierr);
-    ierr = PetscFree3(remoterows,rrow_ranks,rrow_isids);CHKERRQ(ierr);
-    ierr = MatIncreaseOverlap_MPIAIJ_Local_Scalable(mat,nidx,is);CHKERRQ(ierr);
-    PetscFunctionReturn(0);
+  if (reducednrrows) {
+    /* group the pairs <index set, row> by owner, only the owners that are sent to are stored */
+    ierr = PetscSortIntWithArrayPair(nrrows,rrow_ranks,rrow_isids,remoterows);CHKERRQ(ierr);
+    for (i=0,nto=0; i<nrrows; i++) if (!i || rrow_ranks[i] != rrow_ranks[i-1]) nto++;
+    ierr = PetscMalloc3(nto,&toranks,2*nto,&tosizes,2*nrrows,&todata);CHKERRQ(ierr);
+    for (i=0,k=-1; i<nrrows; i++) {
+      if (!i || rrow_ranks[i] != rrow_ranks[i-1]) {
+        k++;
+        toranks[k]     = (PetscMPIInt)rrow_ranks[i];
+        tosizes[2*k]   = 0;   /* size */
+        tosizes[2*k+1] = 2*i; /* offset */
+      }
+      tosizes[2*k]   += 2;
+      todata[2*i]     = rrow_isids[i];
+      todata[2*i+1]   = remoterows[i];
+    }
+    ierr = PetscCommBuildTwoSided(comm,2,MPIU_INT,nto,toranks,tosizes,&nfrom,&fromranks,&fromsizes);CHKERRQ(ierr);
+    for (i=0,nrecvrows=0; i<nfrom; i++) nrecvrows += fromsizes[2*i];
+    ierr = PetscMalloc1(nrecvrows,&remote);CHKERRQ(ierr);
+    ierr = PetscMalloc1(nrecvrows,&fromdata);CHKERRQ(ierr);
+    for (i=0,nrecvrows=0; i<nfrom; i++) {
+      for (j=0; j<fromsizes[2*i]; j++) {
+        remote[nrecvrows].rank    = fromranks[i];
+        remote[nrecvrows++].index = fromsizes[2*i+1]+j;
+      }
+    }
+    ierr = PetscSFCreate(comm,&sf);CHKERRQ(ierr);
+    ierr = PetscSFSetGraph(sf,2*nrrows,nrecvrows,NULL,PETSC_OWN_POINTER,remote,PETSC_OWN_POINTER);CHKERRQ(ierr);
+    /* use two-sided communication by default since OPENMPI has some bugs for one-sided one */
+    ierr = PetscSFSetType(sf,PETSCSFBASIC);CHKERRQ(ierr);
+    ierr = PetscSFSetFromOptions(sf);CHKERRQ(ierr);
+    ierr = PetscSFBcastBegin(sf,MPIU_INT,todata,fromdata);CHKERRQ(ierr);
+    ierr = PetscSFBcastEnd(sf,MPIU_INT,todata,fromdata);CHKERRQ(ierr);
+    ierr = PetscSFDestroy(&sf);CHKERRQ(ierr);
+    ierr = PetscFree3(toranks,tosizes,todata);CHKERRQ(ierr);
+
+    /* the owners return triples <index set, number of columns, columns> */
+    ierr = MatIncreaseOverlap_MPIAIJ_Send_Scalable(mat,nidx,nfrom,fromranks,fromsizes,fromdata,&sbsizes,&sbdata);CHKERRQ(ierr);
+    ierr = PetscFree(fromdata);CHKERRQ(ierr);
+    ierr = PetscFree(fromsizes);CHKERRQ(ierr);
+    ierr = PetscCommBuildTwoSided(comm,2,MPIU_INT,nfrom,fromranks,sbsizes,&nto,&toranks,&tosizes);CHKERRQ(ierr);
+    ierr = PetscFree(fromranks);CHKERRQ(ierr);
+    for (i=0,nsend=0; i<nfrom; i++) nsend += sbsizes[2*i];
+    for (i=0; i<nto; i++) nrecv += tosizes[2*i];
+    ierr = PetscMalloc1(nrecv,&recvdata);CHKERRQ(ierr);
+    ierr = PetscMalloc1(nrecv,&remote);CHKERRQ(ierr);
+    for (i=0,nrecv=0; i<nto; i++) {
+      for (j=0; j<tosizes[2*i]; j++) {
+        remote[nrecv].rank    = toranks[i];
+        remote[nrecv++].index = tosizes[2*i+1]+j;
+      }
+    }
+    ierr = PetscSFCreate(comm,&sf);CHKERRQ(ierr);
+    ierr = PetscSFSetGraph(sf,nsend,nrecv,NULL,PETSC_OWN_POINTER,remote,PETSC_OWN_POINTER);CHKERRQ(ierr);
+    ierr = PetscSFSetType(sf,PETSCSFBASIC);CHKERRQ(ierr);
+    ierr = PetscSFSetFromOptions(sf);CHKERRQ(ierr);
+    ierr = PetscSFBcastBegin(sf,MPIU_INT,sbdata,recvdata);CHKERRQ(ierr);
+    ierr = PetscSFBcastEnd(sf,MPIU_INT,sbdata,recvdata);CHKERRQ(ierr);
+    ierr = PetscSFDestroy(&sf);CHKERRQ(ierr);
+    ierr = PetscFree2(sbdata,sbsizes);CHKERRQ(ierr);
+    ierr = PetscFree(toranks);CHKERRQ(ierr);
+    ierr = PetscFree(tosizes);CHKERRQ(ierr);
   }
-  nto = 0;
-  /* send sizes and ranks for building a two-sided communcation */
-  for (i=0; i<size; i++){
-   if (tosizes_temp[i]){
-     tosizes[nto*2]  = tosizes_temp[i]*2; /* size */
-     tosizes_temp[i] = nto; /* a map from processor to index */
-     toranks[nto++]  = i; /* processor */
-   }
-  }
-  ierr = PetscCalloc1(nto+1,&toffsets);CHKERRQ(ierr);
-  for (i=0; i<nto; i++){
-    toffsets[i+1]  = toffsets[i]+tosizes[2*i]; /* offsets */
-    tosizes[2*i+1] = toffsets[i]; /* offsets to send */
-  }
-  /* send information to other processors */
-  ierr = PetscCommBuildTwoSided(comm,2,MPIU_INT,nto,toranks,tosizes,&nfrom,&fromranks,&fromsizes);CHKERRQ(ierr);
-  nrecvrows = 0;
-  for (i=0; i<nfrom; i++) nrecvrows += fromsizes[2*i];
-  ierr = PetscMalloc1(nrecvrows,&remote);CHKERRQ(ierr);
-  nrecvrows = 0;
-  for (i=0; i<nfrom; i++){
-    for (j=0; j<fromsizes[2*i]; j++){
-      remote[nrecvrows].rank    = fromranks[i];
-      remote[nrecvrows++].index = fromsizes[2*i+1]+j;
-    }
-  }
-  ierr = PetscSFCreate(comm,&sf);CHKERRQ(ierr);
-  ierr = PetscSFSetGraph(sf,nrecvrows,nrecvrows,NULL,PETSC_OWN_POINTER,remote,PETSC_OWN_POINTER);CHKERRQ(ierr);
-  /* use two-sided communication by default since OPENMPI has some bugs for one-sided one */
-  ierr = PetscSFSetType(sf,PETSCSFBASIC);CHKERRQ(ierr);
-  ierr = PetscSFSetFromOptions(sf);CHKERRQ(ierr);
-  /* message pair <no of is, row>  */
-  ierr = PetscCalloc2(2*nrrows,&todata,nrecvrows,&fromdata);CHKERRQ(ierr);
-  for (i=0; i<nrrows; i++){
-    owner = rrow_ranks[i]; /* processor */
-    j     = tosizes_temp[owner]; /* index */
-    todata[toffsets[j]++] = rrow_isids[i];
-    todata[toffsets[j]++] = remoterows[i];
-  }
-  ierr = PetscFree3(toranks,tosizes,tosizes_temp);CHKERRQ(ierr);
   ierr = PetscFree3(remoterows,rrow_ranks,rrow_isids);CHKERRQ(ierr);
-  ierr = PetscFree(toffsets);CHKERRQ(ierr);
-  ierr = PetscSFBcastBegin(sf,MPIU_INT,todata,fromdata);CHKERRQ(ierr);
-  ierr = PetscSFBcastEnd(sf,MPIU_INT,todata,fromdata);CHKERRQ(ierr);
-  ierr = PetscSFDestroy(&sf);CHKERRQ(ierr);
-  /* send rows belonging to the remote so that then we could get the overlapping data back */
-  ierr = MatIncreaseOverlap_MPIAIJ_Send_Scalable(mat,nidx,nfrom,fromranks,fromsizes,fromdata,&sbsizes,&sbdata);CHKERRQ(ierr);
-  ierr = PetscFree2(todata,fromdata);CHKERRQ(ierr);
-  ierr = PetscFree(fromsizes);CHKERRQ(ierr);
-  ierr = PetscCommBuildTwoSided(comm,2,MPIU_INT,nfrom,fromranks,sbsizes,&nto,&toranks,&tosizes);CHKERRQ(ierr);
-  ierr = PetscFree(fromranks);CHKERRQ(ierr);
-  nrecvrows = 0;
-  for (i=0; i<nto; i++) nrecvrows += tosizes[2*i];
-  ierr = PetscCalloc1(nrecvrows,&todata);CHKERRQ(ierr);
-  ierr = PetscMalloc1(nrecvrows,&remote);CHKERRQ(ierr);
-  nrecvrows = 0;
-  for (i=0; i<nto; i++){
-    for (j=0; j<tosizes[2*i]; j++){
-      remote[nrecvrows].rank    = toranks[i];
-      remote[nrecvrows++].index = tosizes[2*i+1]+j;
-    }
-  }
-  ierr = PetscSFCreate(comm,&sf);CHKERRQ(ierr);
-  ierr = PetscSFSetGraph(sf,nrecvrows,nrecvrows,NULL,PETSC_OWN_POINTER,remote,PETSC_OWN_POINTER);CHKERRQ(ierr);
-  /* use two-sided communication by default since OPENMPI has some bugs for one-sided one */
-  ierr = PetscSFSetType(sf,PETSCSFBASIC);CHKERRQ(ierr);
-  ierr = PetscSFSetFromOptions(sf);CHKERRQ(ierr);
-  /* overlap communication and computation */
-  ierr = PetscSFBcastBegin(sf,MPIU_INT,sbdata,todata);CHKERRQ(ierr);
-  ierr = MatIncreaseOverlap_MPIAIJ_Local_Scalable(mat,nidx,is);CHKERRQ(ierr);
-  ierr = PetscSFBcastEnd(sf,MPIU_INT,sbdata,todata);CHKERRQ(ierr);
-  ierr = PetscSFDestroy(&sf);CHKERRQ(ierr);
-  ierr = PetscFree2(sbdata,sbsizes);CHKERRQ(ierr);
-  ierr = MatIncreaseOverlap_MPIAIJ_Receive_Scalable(mat,nidx,is,nrecvrows,todata);CHKERRQ(ierr);
-  ierr = PetscFree(toranks);CHKERRQ(ierr);
-  ierr = PetscFree(tosizes);CHKERRQ(ierr);
-  ierr = PetscFree(todata);CHKERRQ(ierr);
-  PetscFunctionReturn(0);
-}
 
-static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Receive_Scalable(Mat mat,PetscInt nidx, IS is[], PetscInt nrecvs, PetscInt *recvdata)
-{
-  PetscInt         *isz,isz_i,i,j,is_id, data_size;
-  PetscInt          col,lsize,max_lsize,*indices_temp, *indices_i;
-  const PetscInt   *indices_i_temp;
-  PetscErrorCode    ierr;
-
-  PetscFunctionBegin;
-  max_lsize = 0;
-  ierr = PetscMalloc1(nidx,&isz);CHKERRQ(ierr);
-  for (i=0; i<nidx; i++){
-    ierr = ISGetLocalSize(is[i],&lsize);CHKERRQ(ierr);
-    max_lsize = lsize>max_lsize ? lsize:max_lsize;
-    isz[i]    = lsize;
-  }
-  ierr = PetscMalloc1((max_lsize+nrecvs)*nidx,&indices_temp);CHKERRQ(ierr);
-  for (i=0; i<nidx; i++){
-    ierr = ISGetIndices(is[i],&indices_i_temp);CHKERRQ(ierr);
-    ierr = PetscMemcpy(indices_temp+i*(max_lsize+nrecvs),indices_i_temp, sizeof(PetscInt)*isz[i]);CHKERRQ(ierr);
-    ierr = ISRestoreIndices(is[i],&indices_i_temp);CHKERRQ(ierr);
-    ierr = ISDestroy(&is[i]);CHKERRQ(ierr);
+  /* the new frontier: the columns of the frontier rows that are not in the index sets yet */
+  ierr = MatMPIAIJGetSeqAIJ(mat,&amat,&bmat,&gcols);CHKERRQ(ierr);
+  ierr = MatGetRowIJ(amat,0,PETSC_FALSE,PETSC_FALSE,&an,&ai,&aj,&done);CHKERRQ(ierr);
+  if (!done) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"can not get row IJ \n");
+  ierr = MatGetRowIJ(bmat,0,PETSC_FALSE,PETSC_FALSE,&bn,&bi,&bj,&done);CHKERRQ(ierr);
+  if (!done) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"can not get row IJ \n");
+  ierr = PetscCalloc2(nidx,&count,nidx,&newfront);CHKERRQ(ierr);
+  for (i=0; i<nidx; i++) {
+    for (j=0; j<nfront[i]; j++) {
+      row = front[i][j];
+      if (row < rstart || row >= rend) continue;
+      row       -= rstart;
+      count[i]  += ai[row+1] - ai[row] + bi[row+1] - bi[row];
+    }
   }
-  /* retrieve information to get row id and its overlap */
-  for (i=0; i<nrecvs; ){
-    is_id      = recvdata[i++];
-    data_size  = recvdata[i++];
-    indices_i  = indices_temp+(max_lsize+nrecvs)*is_id;
-    isz_i      = isz[is_id];
-    for (j=0; j< data_size; j++){
-      col = recvdata[i++];
-      indices_i[isz_i++] = col;
-    }
-    isz[is_id] = isz_i;
-  }
-  /* remove duplicate entities */
-  for (i=0; i<nidx; i++){
-    indices_i  = indices_temp+(max_lsize+nrecvs)*i;
-    isz_i      = isz[i];
-    ierr = PetscSortRemoveDupsInt(&isz_i,indices_i);CHKERRQ(ierr);
-    ierr = ISCreateGeneral(PETSC_COMM_SELF,isz_i,indices_i,PETSC_COPY_VALUES,&is[i]);CHKERRQ(ierr);
-  }
-  ierr = PetscFree(isz);CHKERRQ(ierr);
-  ierr = PetscFree(indices_temp);CHKERRQ(ierr);
+  for (k=0; k<nrecv; k+=n) {
+    is_id         = recvdata[k++];
+    n             = recvdata[k++];
+    count[is_id] += n;
+  }
+  for (i=0; i<nidx; i++) {
+    ierr     = PetscMalloc1(count[i],&newfront[i]);CHKERRQ(ierr);
+    count[i] = 0;
+    for (j=0; j<nfront[i]; j++) {
+      row = front[i][j];
+      if (row < rstart || row >= rend) continue;
+      row -= rstart;
+      for (l=ai[row]; l<ai[row+1]; l++) { /* Amat */
+        col  = aj[l] + cstart;
+        ierr = PetscHSetIQueryAdd(sets[i],col,&missing);CHKERRQ(ierr);
+        if (missing) newfront[i][count[i]++] = col;
+      }
+      for (l=bi[row]; l<bi[row+1]; l++) { /* Bmat */
+        col  = gcols[bj[l]];
+        ierr = PetscHSetIQueryAdd(sets[i],col,&missing);CHKERRQ(ierr);
+        if (missing) newfront[i][count[i]++] = col;
+      }
+    }
+  }
+  for (k=0; k<nrecv; ) {
+    is_id = recvdata[k++];
+    n     = recvdata[k++];
+    for (l=0; l<n; l++) {
+      col  = recvdata[k++];
+      ierr = PetscHSetIQueryAdd(sets[is_id],col,&missing);CHKERRQ(ierr);
+      if (missing) newfront[is_id][count[is_id]++] = col;
+    }
+  }
+  for (i=0; i<nidx; i++) {
+    ierr      = PetscFree(front[i]);CHKERRQ(ierr);
+    front[i]  = newfront[i];
+    nfront[i] = count[i];
+  }
+  ierr = PetscFree2(count,newfront);CHKERRQ(ierr);
+  ierr = PetscFree(recvdata);CHKERRQ(ierr);
+  ierr = MatRestoreRowIJ(amat,0,PETSC_FALSE,PETSC_FALSE,&an,&ai,&aj,&done);CHKERRQ(ierr);
+  ierr = MatRestoreRowIJ(bmat,0,PETSC_FALSE,PETSC_FALSE,&bn,&bi,&bj,&done);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -357,70 +366,6 @@ static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Send_Scalable(Mat mat,PetscInt n
   PetscFunctionReturn(0);
 }
 
-static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Local_Scalable(Mat mat,PetscInt nidx, IS is[])
-{
-  const PetscInt   *gcols,*ai,*aj,*bi,*bj, *indices;
-  PetscInt          tnz,an,bn,i,j,row,start,end,rstart,cstart,col,k,*indices_temp;
-  PetscInt          lsize,lsize_tmp,owner;
-  PetscMPIInt       rank;
-  Mat               amat,bmat;
-  PetscBool         done;
-  PetscLayout       cmap,rmap;
-  MPI_Comm          comm;
-  PetscErrorCode    ierr;
-
-  PetscFunctionBegin;
-  ierr = PetscObjectGetComm((PetscObject)mat,&comm);CHKERRQ(ierr);
-  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
-  ierr = MatMPIAIJGetSeqAIJ(mat,&amat,&bmat,&gcols);CHKERRQ(ierr);
-  ierr = MatGetRowIJ(amat,0,PETSC_FALSE,PETSC_FALSE,&an,&ai,&aj,&done);CHKERRQ(ierr);
-  if (!done) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"can not get row IJ \n");
-  ierr = MatGetRowIJ(bmat,0,PETSC_FALSE,PETSC_FALSE,&bn,&bi,&bj,&done);CHKERRQ(ierr);
-  if (!done) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"can not get row IJ \n");
-  /* is it a safe way to compute number of nonzero values ? */
-  tnz  = ai[an]+bi[bn];
-  ierr = MatGetLayouts(mat,&rmap,&cmap);CHKERRQ(ierr);
-  ierr = PetscLayoutGetRange(rmap,&rstart,NULL);CHKERRQ(ierr);
-  ierr = PetscLayoutGetRange(cmap,&cstart,NULL);CHKERRQ(ierr);
-  /* it is a better way to estimate memory than the old implementation
-   * where global size of matrix is used
-   * */
-  ierr = PetscMalloc1(tnz,&indices_temp);CHKERRQ(ierr);
-  for (i=0; i<nidx; i++) {
-    ierr = ISGetLocalSize(is[i],&lsize);CHKERRQ(ierr);
-    ierr = ISGetIndices(is[i],&indices);CHKERRQ(ierr);
-    lsize_tmp = 0;
-    for (j=0; j<lsize; j++) {
-      owner = -1;
-      row   = indices[j];
-      ierr = PetscLayoutFindOwner(rmap,row,&owner);CHKERRQ(ierr);
-      if (owner != rank) continue;
-      /* local number */
-      row  -= rstart;
-      start = ai[row];
-      end   = ai[row+1];
-      for (k=start; k<end; k++) { /* Amat */
-        col = aj[k] + cstart;
-        indices_temp[lsize_tmp++] = col;
-      }
-      start = bi[row];
-      end   = bi[row+1];
-      for (k=start; k<end; k++) { /* Bmat */
-        col = gcols[bj[k]];
-        indices_temp[lsize_tmp++] = col;
-      }
-    }
-   ierr = ISRestoreIndices(is[i],&indices);CHKERRQ(ierr);
-   ierr = ISDestroy(&is[i]);CHKERRQ(ierr);
-   ierr = PetscSortRemoveDupsInt(&lsize_tmp,indices_temp);CHKERRQ(ierr);
-   ierr = ISCreateGeneral(PETSC_COMM_SELF,lsize_tmp,indices_temp,PETSC_COPY_VALUES,&is[i]);CHKERRQ(ierr);
-  }
-  ierr = PetscFree(indices_temp);CHKERRQ(ierr);
-  ierr = MatRestoreRowIJ(amat,0,PETSC_FALSE,PETSC_FALSE,&an,&ai,&aj,&done);CHKERRQ(ierr);
-  ierr = MatRestoreRowIJ(bmat,0,PETSC_FALSE,PETSC_FALSE,&bn,&bi,&bj,&done);CHKERRQ(ierr);
-  PetscFunctionReturn(0);
-}
-
 
 /*
   Sample message format:
@@ -452,8 +397,8 @@ static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Once(Mat C,PetscInt imax,IS is[]
   const PetscInt **idx,*idx_i;
   PetscInt       *n,**data,len;
 #if defined(PETSC_USE_CTABLE)
-  PetscTable     *table_data,table_data_i;
-  PetscInt       *tdata,tcount,tcount_max;
+  PetscHMapI     *table_data,table_data_i;
+  PetscInt       *tdata,*tkeys,*tvals,tcount,tcount_max;
 #else
   PetscInt       *data_i,*d_p;
 #endif
@@ -562,7 +507,8 @@ static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Once(Mat C,PetscInt imax,IS is[]
     ierr = PetscIntMultError((M/PETSC_BITS_PER_BYTE+1),imax, &M_BPB_imax);CHKERRQ(ierr);
     ierr = PetscMalloc1(imax,&table_data);CHKERRQ(ierr);
     for (i=0; i<imax; i++) {
-      ierr = PetscTableCreate(n[i]+1,M+1,&table_data[i]);CHKERRQ(ierr);
+      ierr = PetscHMapICreate(&table_data[i]);CHKERRQ(ierr);
+      ierr = PetscHMapIResize(table_data[i],n[i]);CHKERRQ(ierr);
     }
     ierr = PetscCalloc4(imax,&table, imax,&data, imax,&isz, M_BPB_imax,&t_p);CHKERRQ(ierr);
     for (i=0; i<imax; i++) {
@@ -605,7 +551,7 @@ static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Once(Mat C,PetscInt imax,IS is[]
           ptr[proc]++;
         } else if (!PetscBTLookupSet(table_i,row)) {
 #if defined(PETSC_USE_CTABLE)
-          ierr = PetscTableAdd(table_data_i,row+1,isz_i+1,INSERT_VALUES);CHKERRQ(ierr);
+          ierr = PetscHMapISet(table_data_i,row,isz_i+1);CHKERRQ(ierr);
 #else
           data_i[isz_i] = row; /* Update the local table */
 #endif
@@ -725,7 +671,7 @@ static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Once(Mat C,PetscInt imax,IS is[]
           row = rbuf2_i[ct1];
           if (!PetscBTLookupSet(table_i,row)) {
 #if defined(PETSC_USE_CTABLE)
-            ierr = PetscTableAdd(table_data_i,row+1,isz_i+1,INSERT_VALUES);CHKERRQ(ierr);
+            ierr = PetscHMapISet(table_data_i,row,isz_i+1);CHKERRQ(ierr);
 #else
             data_i[isz_i] = row;
 #endif
@@ -744,22 +690,18 @@ static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Once(Mat C,PetscInt imax,IS is[]
   tcount_max = 0;
   for (i=0; i<imax; ++i) {
     table_data_i = table_data[i];
-    ierr = PetscTableGetCount(table_data_i,&tcount);CHKERRQ(ierr);
+    ierr = PetscHMapIGetSize(table_data_i,&tcount);CHKERRQ(ierr);
     if (tcount_max < tcount) tcount_max = tcount;
   }
-  ierr = PetscMalloc1(tcount_max+1,&tdata);CHKERRQ(ierr);
+  ierr = PetscMalloc3(tcount_max+1,&tdata,tcount_max+1,&tkeys,tcount_max+1,&tvals);CHKERRQ(ierr);
 #endif
 
   for (i=0; i<imax; ++i) {
 #if defined(PETSC_USE_CTABLE)
-    PetscTablePosition tpos;
     table_data_i = table_data[i];
-
-    ierr = PetscTableGetHeadPosition(table_data_i,&tpos);CHKERRQ(ierr);
-    while (tpos) {
-      ierr = PetscTableGetNext(table_data_i,&tpos,&k,&j);CHKERRQ(ierr);
-      tdata[--j] = --k;
-    }
+    tcount       = 0;
+    ierr = PetscHMapIGetPairs(table_data_i,&tcount,tkeys,tvals);CHKERRQ(ierr);
+    for (j=0; j<tcount; j++) tdata[tvals[j]-1] = tkeys[j];
     ierr = ISCreateGeneral(PETSC_COMM_SELF,isz[i],tdata,PETSC_COPY_VALUES,is+i);CHKERRQ(ierr);
 #else
     ierr = ISCreateGeneral(PETSC_COMM_SELF,isz[i],data[i],PETSC_COPY_VALUES,is+i);CHKERRQ(ierr);
@@ -783,10 +725,10 @@ static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Once(Mat C,PetscInt imax,IS is[]
   ierr = PetscFree(isz1);CHKERRQ(ierr);
 #if defined(PETSC_USE_CTABLE)
   for (i=0; i<imax; i++) {
-    ierr = PetscTableDestroy((PetscTable*)&table_data[i]);CHKERRQ(ierr);
+    ierr = PetscHMapIDestroy(&table_data[i]);CHKERRQ(ierr);
   }
   ierr = PetscFree(table_data);CHKERRQ(ierr);
-  ierr = PetscFree(tdata);CHKERRQ(ierr);
+  ierr = PetscFree3(tdata,tkeys,tvals);CHKERRQ(ierr);
   ierr = PetscFree4(table,data,isz,t_p);CHKERRQ(ierr);
 #else
   ierr = PetscFree5(table,data,isz,d_p,t_p);CHKERRQ(ierr);
@@ -808,7 +750,7 @@ static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Once(Mat C,PetscInt imax,IS is[]
                to each index set;
       data or table_data  - pointer to the solutions
 */
-static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Local(Mat C,PetscInt imax,PetscBT *table,PetscInt *isz,PetscInt **data,PetscTable *table_data)
+static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Local(Mat C,PetscInt imax,PetscBT *table,PetscInt *isz,PetscInt **data,PetscHMapI *table_data)
 {
   Mat_MPIAIJ *c = (Mat_MPIAIJ*)C->data;
   Mat        A  = c->A,B = c->B;
@@ -817,10 +759,9 @@ static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Local(Mat C,PetscInt imax,PetscB
   PetscInt   *bi,*bj,*garray,i,j,k,row,isz_i;
   PetscBT    table_i;
 #if defined(PETSC_USE_CTABLE)
-  PetscTable         table_data_i;
+  PetscHMapI         table_data_i;
   PetscErrorCode     ierr;
-  PetscTablePosition tpos;
-  PetscInt           tcount,*tdata;
+  PetscInt           tcount,*tdata,*tkeys,*tvals;
 #else
   PetscInt           *data_i;
 #endif
@@ -838,15 +779,15 @@ static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Local(Mat C,PetscInt imax,PetscB
 #if defined(PETSC_USE_CTABLE)
     /* copy existing entries of table_data_i into tdata[] */
     table_data_i = table_data[i];
-    ierr = PetscTableGetCount(table_data_i,&tcount);CHKERRQ(ierr);
+    ierr = PetscHMapIGetSize(table_data_i,&tcount);CHKERRQ(ierr);
     if (tcount != isz[i]) SETERRQ3(PETSC_COMM_SELF,0," tcount %d != isz[%d] %d",tcount,i,isz[i]);
 
-    ierr = PetscMalloc1(tcount,&tdata);CHKERRQ(ierr);
-    ierr = PetscTableGetHeadPosition(table_data_i,&tpos);CHKERRQ(ierr);
-    while (tpos) {
-      ierr = PetscTableGetNext(table_data_i,&tpos,&row,&j);CHKERRQ(ierr);
-      tdata[--j] = --row;
-      if (j > tcount - 1) SETERRQ2(PETSC_COMM_SELF,0," j %d >= tcount %d",j,tcount);
+    ierr = PetscMalloc3(tcount,&tdata,tcount,&tkeys,tcount,&tvals);CHKERRQ(ierr);
+    j    = 0;
+    ierr = PetscHMapIGetPairs(table_data_i,&j,tkeys,tvals);CHKERRQ(ierr);
+    for (j=0; j<tcount; j++) {
+      if (tvals[j] > tcount) SETERRQ2(PETSC_COMM_SELF,0," j %d >= tcount %d",tvals[j]-1,tcount);
+      tdata[tvals[j]-1] = tkeys[j];
     }
 #else
     data_i  = data[i];
@@ -867,7 +808,7 @@ static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Local(Mat C,PetscInt imax,PetscB
         val = aj[k] + cstart;
         if (!PetscBTLookupSet(table_i,val)) {
 #if defined(PETSC_USE_CTABLE)
-          ierr = PetscTableAdd(table_data_i,val+1,isz_i+1,INSERT_VALUES);CHKERRQ(ierr);
+          ierr = PetscHMapISet(table_data_i,val,isz_i+1);CHKERRQ(ierr);
 #else
           data_i[isz_i] = val;
 #endif
@@ -880,7 +821,7 @@ static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Local(Mat C,PetscInt imax,PetscB
         val = garray[bj[k]];
         if (!PetscBTLookupSet(table_i,val)) {
 #if defined(PETSC_USE_CTABLE)
-          ierr = PetscTableAdd(table_data_i,val+1,isz_i+1,INSERT_VALUES);CHKERRQ(ierr);
+          ierr = PetscHMapISet(table_data_i,val,isz_i+1);CHKERRQ(ierr);
 #else
           data_i[isz_i] = val;
 #endif
@@ -891,7 +832,7 @@ static PetscErrorCode MatIncreaseOverlap_MPIAIJ_Local(Mat C,PetscInt imax,PetscB
     isz[i] = isz_i;
 
 #if defined(PETSC_USE_CTABLE)
-    ierr = PetscFree(tdata);CHKERRQ(ierr);
+    ierr = PetscFree3(tdata,tkeys,tvals);CHKERRQ(ierr);
 #endif
   }
   PetscFunctionReturn(0);
@@ -1231,21 +1172,21 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_SingleIS_Local(Mat C,PetscInt ismax,c
   PetscInt       nrow,ncol,start;
   PetscErrorCode ierr;
   PetscMPIInt    rank,size,tag1,tag2,tag3,tag4,*w1,*w2,nrqr;
-  PetscInt       **sbuf1,**sbuf2,i,j,k,l,ct1,ct2,ct3,**rbuf1,row,proc;
+  PetscInt       **sbuf1,**sbuf2,i,j,k,l,ct1,ct2,**rbuf1,row,proc;
   PetscInt       nrqs=0,msz,**ptr,*req_size,*ctr,*pa,*tmp,tcol,*iptr;
   PetscInt       **rbuf3,*req_source1,*req_source2,**sbuf_aj,**rbuf2,max1,nnz;
   PetscInt       *lens,rmax,ncols,*cols,Crow;
 #if defined(PETSC_USE_CTABLE)
-  PetscTable     cmap,rmap;
+  PetscHMapI     cmap,rmap;
   PetscInt       *cmap_loc,*rmap_loc;
 #else
   PetscInt       *cmap,*rmap;
 #endif
   PetscInt       ctr_j,*sbuf1_j,*sbuf_aj_i,*rbuf1_i,kmax,*sbuf1_i,*rbuf2_i,*rbuf3_i;
   PetscInt       *cworkB,lwrite,*subcols,*row2proc;
-  PetscScalar    *vworkA,*vworkB,*a_a = a->a,*b_a = b->a,*subvals=NULL;
+  PetscScalar    *vworkA,*vworkB,*a_a = a->a,*b_a = b->a,*subvals=NULL,*imat_a;
   MPI_Request    *s_waits1,*r_waits1,*s_waits2,*r_waits2,*r_waits3;
-  MPI_Request    *r_waits4,*s_waits3 = NULL,*s_waits4;
+  MPI_Request    *s_waits3 = NULL,*v_waits;
   MPI_Status     *r_status1,*r_status2,*s_status1,*s_status3 = NULL,*s_status2;
   MPI_Status     *r_status3 = NULL,*r_status4,*s_status4;
   MPI_Comm       comm;
@@ -1253,6 +1194,7 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_SingleIS_Local(Mat C,PetscInt ismax,c
   PetscMPIInt    *onodes1,*olengths1,idex,end;
   Mat_SubSppt    *smatis1;
   PetscBool      isrowsorted;
+  PetscInt       *loc_dest,*rbuf4_dest,*rbuf4_dest_i,loc;
 
   PetscFunctionBegin;
   if (ismax != 1) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"This routine only works when all processes have ismax=1");
@@ -1483,13 +1425,14 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_SingleIS_Local(Mat C,PetscInt ismax,c
     /* create column map (cmap): global col of C -> local col of submat */
 #if defined(PETSC_USE_CTABLE)
     if (!allcolumns) {
-      ierr = PetscTableCreate(ncol+1,C->cmap->N+1,&cmap);CHKERRQ(ierr);
+      ierr = PetscHMapICreate(&cmap);CHKERRQ(ierr);
+      ierr = PetscHMapIResize(cmap,ncol);CHKERRQ(ierr);
       ierr = PetscCalloc1(C->cmap->n,&cmap_loc);CHKERRQ(ierr);
       for (j=0; j<ncol; j++) { /* use array cmap_loc[] for local col indices */
         if (icol[j] >= cstart && icol[j] <cend) {
           cmap_loc[icol[j] - cstart] = j+1;
-        } else { /* use PetscTable for non-local col indices */
-          ierr = PetscTableAdd(cmap,icol[j]+1,j+1,INSERT_VALUES);CHKERRQ(ierr);
+        } else { /* use PetscHMapI for non-local col indices */
+          ierr = PetscHMapISet(cmap,icol[j],j+1);CHKERRQ(ierr);
         }
       }
     } else {
@@ -1536,7 +1479,7 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_SingleIS_Local(Mat C,PetscInt ismax,c
         if (!allcolumns) {
           for (k=0; k<ncols; k++) {
 #if defined(PETSC_USE_CTABLE)
-            ierr = PetscTableFind(cmap,bmap[cols[k]]+1,&tcol);CHKERRQ(ierr);
+            ierr = PetscHMapIGetWithDefault(cmap,bmap[cols[k]],0,&tcol);CHKERRQ(ierr);
 #else
             tcol = cmap[bmap[cols[k]]];
 #endif
@@ -1550,14 +1493,15 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_SingleIS_Local(Mat C,PetscInt ismax,c
 
     /* Create row map (rmap): global row of C -> local row of submat */
 #if defined(PETSC_USE_CTABLE)
-    ierr = PetscTableCreate(nrow+1,C->rmap->N+1,&rmap);CHKERRQ(ierr);
+    ierr = PetscHMapICreate(&rmap);CHKERRQ(ierr);
+    ierr = PetscHMapIResize(rmap,nrow);CHKERRQ(ierr);
     for (j=0; j<nrow; j++) {
       row  = irow[j];
       proc = row2proc[j];
       if (proc == rank) { /* a local row */
         rmap_loc[row - rstart] = j;
       } else {
-        ierr = PetscTableAdd(rmap,irow[j]+1,j+1,INSERT_VALUES);CHKERRQ(ierr);
+        ierr = PetscHMapISet(rmap,irow[j],j+1);CHKERRQ(ierr);
       }
     }
 #else
@@ -1583,7 +1527,7 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_SingleIS_Local(Mat C,PetscInt ismax,c
       max1   = sbuf1_i[2];
       for (k=0; k<max1; k++,ct1++) {
 #if defined(PETSC_USE_CTABLE)
-        ierr = PetscTableFind(rmap,sbuf1_i[ct1]+1,&row);CHKERRQ(ierr);
+        ierr = PetscHMapIGetWithDefault(rmap,sbuf1_i[ct1],0,&row);CHKERRQ(ierr);
         row--;
         if (row < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_PLIB,"row not found in table");
 #else
@@ -1599,7 +1543,7 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_SingleIS_Local(Mat C,PetscInt ismax,c
             if (rbuf3_i[ct2] >= cstart && rbuf3_i[ct2] <cend) {
               tcol = cmap_loc[rbuf3_i[ct2] - cstart];
             } else {
-              ierr = PetscTableFind(cmap,rbuf3_i[ct2]+1,&tcol);CHKERRQ(ierr);
+              ierr = PetscHMapIGetWithDefault(cmap,rbuf3_i[ct2],0,&tcol);CHKERRQ(ierr);
             }
 #else
             tcol = cmap[rbuf3_i[ct2]]; /* column index in submat */
@@ -1614,6 +1558,25 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_SingleIS_Local(Mat C,PetscInt ismax,c
     ierr = MPI_Waitall(nrqr,s_waits3,s_status3);CHKERRQ(ierr);
     ierr = PetscFree4(r_waits3,s_waits3,r_status3,s_status3);CHKERRQ(ierr);
 
+    /* Set up the exchange of the matrix values; it is kept with the submatrix so that
+       MAT_REUSE_MATRIX only restarts these persistent requests */
+    ierr = PetscObjectGetNewTag((PetscObject)C,&tag4);CHKERRQ(ierr);
+    ierr = PetscMalloc2(nrqs+1,&rbuf4,nrqr+1,&sbuf_aa);CHKERRQ(ierr);
+    for (i=0,j=0; i<nrqs; i++) j += rbuf2[i][0];
+    ierr = PetscMalloc1(j+1,&rbuf4[0]);CHKERRQ(ierr);
+    for (i=1; i<nrqs; i++) rbuf4[i] = rbuf4[i-1] + rbuf2[i-1][0];
+    for (i=0,j=0; i<nrqr; i++) j += req_size[i];
+    ierr = PetscMalloc1(j+1,&sbuf_aa[0]);CHKERRQ(ierr);
+    for (i=1; i<nrqr; i++) sbuf_aa[i] = sbuf_aa[i-1] + req_size[i-1];
+
+    ierr = PetscMalloc1(nrqs+nrqr+1,&v_waits);CHKERRQ(ierr);
+    for (i=0; i<nrqs; ++i) {
+      ierr = MPI_Recv_init(rbuf4[i],rbuf2[i][0],MPIU_SCALAR,req_source2[i],tag4,comm,v_waits+i);CHKERRQ(ierr);
+    }
+    for (i=0; i<nrqr; ++i) {
+      ierr = MPI_Send_init(sbuf_aa[i],req_size[i],MPIU_SCALAR,req_source1[i],tag4,comm,v_waits+nrqs+i);CHKERRQ(ierr);
+    }
+
     /* Create the submatrices */
     ierr = MatCreate(PETSC_COMM_SELF,&submat);CHKERRQ(ierr);
     ierr = MatSetSizes(submat,nrow,ncol,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRQ(ierr);
@@ -1647,6 +1610,10 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_SingleIS_Local(Mat C,PetscInt ismax,c
     smatis1->req_size     = req_size;
     smatis1->req_source1  = req_source1;
 
+    smatis1->v_waits      = v_waits;
+    smatis1->rbuf4        = rbuf4;
+    smatis1->sbuf_aa      = sbuf_aa;
+
     smatis1->allcolumns  = allcolumns;
     smatis1->singleis    = PETSC_TRUE;
     smatis1->row2proc    = row2proc;
@@ -1664,13 +1631,13 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_SingleIS_Local(Mat C,PetscInt ismax,c
     /* compute rmax */
     rmax = 0;
     for (i=0; i<nrow; i++) rmax = PetscMax(rmax,lens[i]);
+    ierr = PetscMalloc2(rmax,&subcols,rmax,&subvals);CHKERRQ(ierr);
 
   } else { /* scall == MAT_REUSE_MATRIX */
     submat = submats[0];
     if (submat->rmap->n != nrow || submat->cmap->n != ncol) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Cannot reuse matrix. wrong size");
 
     subc    = (Mat_SeqAIJ*)submat->data;
-    rmax    = subc->rmax;
     smatis1 = subc->submatis1;
     nrqs        = smatis1->nrqs;
     nrqr        = smatis1->nrqr;
@@ -1689,6 +1656,12 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_SingleIS_Local(Mat C,PetscInt ismax,c
     req_size   = smatis1->req_size;
     req_source1 = smatis1->req_source1;
 
+    v_waits    = smatis1->v_waits;
+    rbuf4      = smatis1->rbuf4;
+    sbuf_aa    = smatis1->sbuf_aa;
+    rbuf4_dest = smatis1->rbuf4_dest;
+    loc_dest   = smatis1->loc_dest;
+
     allcolumns = smatis1->allcolumns;
     row2proc   = smatis1->row2proc;
     rmap       = smatis1->rmap;
@@ -1700,20 +1673,10 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_SingleIS_Local(Mat C,PetscInt ismax,c
   }
 
   /* Post recv matrix values */
-  ierr = PetscMalloc3(nrqs+1,&rbuf4, rmax,&subcols, rmax,&subvals);CHKERRQ(ierr);
-  ierr = PetscMalloc4(nrqs+1,&r_waits4,nrqr+1,&s_waits4,nrqs+1,&r_status4,nrqr+1,&s_status4);CHKERRQ(ierr);
-  ierr = PetscObjectGetNewTag((PetscObject)C,&tag4);CHKERRQ(ierr);
-  for (i=0; i<nrqs; ++i) {
-    ierr = PetscMalloc1(rbuf2[i][0]+1,&rbuf4[i]);CHKERRQ(ierr);
-    ierr = MPI_Irecv(rbuf4[i],rbuf2[i][0],MPIU_SCALAR,req_source2[i],tag4,comm,r_waits4+i);CHKERRQ(ierr);
-  }
-
-  /* Allocate sending buffers for a->a, and send them off */
-  ierr = PetscMalloc1(nrqr+1,&sbuf_aa);CHKERRQ(ierr);
-  for (i=0,j=0; i<nrqr; i++) j += req_size[i];
-  ierr = PetscMalloc1(j+1,&sbuf_aa[0]);CHKERRQ(ierr);
-  for (i=1; i<nrqr; i++) sbuf_aa[i] = sbuf_aa[i-1] + req_size[i-1];
+  ierr = PetscMalloc2(nrqs+1,&r_status4,nrqr+1,&s_status4);CHKERRQ(ierr);
+  if (nrqs) {ierr = MPI_Startall(nrqs,v_waits);CHKERRQ(ierr);}
 
+  /* Load the sending buffers with a->a, and send them off */
   for (i=0; i<nrqr; i++) {
     rbuf1_i   = rbuf1[i];
     sbuf_aa_i = sbuf_aa[i];
@@ -1745,129 +1708,148 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_SingleIS_Local(Mat C,PetscInt ismax,c
 
       ct2 += ncols;
     }
-    ierr = MPI_Isend(sbuf_aa_i,req_size[i],MPIU_SCALAR,req_source1[i],tag4,comm,s_waits4+i);CHKERRQ(ierr);
   }
+  if (nrqr) {ierr = MPI_Startall(nrqr,v_waits+nrqs);CHKERRQ(ierr);}
 
-  /* Assemble submat */
-  /* First assemble the local rows */
-  for (j=0; j<nrow; j++) {
-    row  = irow[j];
-    proc = row2proc[j];
-    if (proc == rank) {
-      Crow = row - rstart;  /* local row index of C */
+  if (scall == MAT_REUSE_MATRIX) {
+    /* The nonzero structure is unchanged, put the values directly at their recorded locations */
+    imat_a = subc->a;
+    for (j=0,l=0; j<nrow; j++) {
+      if (row2proc[j] != rank) continue;
+      Crow = irow[j] - rstart;
+      for (k=ai[Crow]; k<ai[Crow+1]; k++,l++) {
+        if (loc_dest[l] >= 0) imat_a[loc_dest[l]] = a_a[k];
+      }
+      for (k=bi[Crow]; k<bi[Crow+1]; k++,l++) {
+        if (loc_dest[l] >= 0) imat_a[loc_dest[l]] = b_a[k];
+      }
+    }
+
+    if (nrqs) {ierr = MPI_Waitall(nrqs,v_waits,r_status4);CHKERRQ(ierr);}
+    for (i=0,nnz=0; i<nrqs; i++) nnz += rbuf2[i][0];
+    rbuf4_i = rbuf4[0];
+    for (l=0; l<nnz; l++) {
+      if (rbuf4_dest[l] >= 0) imat_a[rbuf4_dest[l]] = rbuf4_i[l];
+    }
+  } else {
+    /* Assemble submat */
+    /* First assemble the local rows */
+    for (j=0; j<nrow; j++) {
+      row  = irow[j];
+      proc = row2proc[j];
+      if (proc == rank) {
+        Crow = row - rstart;  /* local row index of C */
 #if defined(PETSC_USE_CTABLE)
-      row = rmap_loc[Crow]; /* row index of submat */
+        row = rmap_loc[Crow]; /* row index of submat */
 #else
-      row = rmap[row];
+        row = rmap[row];
 #endif
 
-      if (allcolumns) {
-        /* diagonal part A = c->A */
-        ncols = ai[Crow+1] - ai[Crow];
-        cols  = aj + ai[Crow];
-        vals  = a->a + ai[Crow];
-        i     = 0;
-        for (k=0; k<ncols; k++) {
-          subcols[i]   = cols[k] + cstart;
-          subvals[i++] = vals[k];
-        }
+        if (allcolumns) {
+          /* diagonal part A = c->A */
+          ncols = ai[Crow+1] - ai[Crow];
+          cols  = aj + ai[Crow];
+          vals  = a->a + ai[Crow];
+          i     = 0;
+          for (k=0; k<ncols; k++) {
+            subcols[i]   = cols[k] + cstart;
+            subvals[i++] = vals[k];
+          }
 
-        /* off-diagonal part B = c->B */
-        ncols = bi[Crow+1] - bi[Crow];
-        cols  = bj + bi[Crow];
-        vals  = b->a + bi[Crow];
-        for (k=0; k<ncols; k++) {
-          subcols[i]   = bmap[cols[k]];
-          subvals[i++] = vals[k];
-        }
+          /* off-diagonal part B = c->B */
+          ncols = bi[Crow+1] - bi[Crow];
+          cols  = bj + bi[Crow];
+          vals  = b->a + bi[Crow];
+          for (k=0; k<ncols; k++) {
+            subcols[i]   = bmap[cols[k]];
+            subvals[i++] = vals[k];
+          }
 
-        ierr = MatSetValues_SeqAIJ(submat,1,&row,i,subcols,subvals,INSERT_VALUES);CHKERRQ(ierr);
+          ierr = MatSetValues_SeqAIJ(submat,1,&row,i,subcols,subvals,INSERT_VALUES);CHKERRQ(ierr);
 
-      } else { /* !allcolumns */
+        } else { /* !allcolumns */
 #if defined(PETSC_USE_CTABLE)
-        /* diagonal part A = c->A */
-        ncols = ai[Crow+1] - ai[Crow];
-        cols  = aj + ai[Crow];
-        vals  = a->a + ai[Crow];
-        i     = 0;
-        for (k=0; k<ncols; k++) {
-          tcol = cmap_loc[cols[k]];
-          if (tcol) {
-            subcols[i]   = --tcol;
-            subvals[i++] = vals[k];
+          /* diagonal part A = c->A */
+          ncols = ai[Crow+1] - ai[Crow];
+          cols  = aj + ai[Crow];
+          vals  = a->a + ai[Crow];
+          i     = 0;
+          for (k=0; k<ncols; k++) {
+            tcol = cmap_loc[cols[k]];
+            if (tcol) {
+              subcols[i]   = --tcol;
+              subvals[i++] = vals[k];
+            }
           }
-        }
 
-        /* off-diagonal part B = c->B */
-        ncols = bi[Crow+1] - bi[Crow];
-        cols  = bj + bi[Crow];
-        vals  = b->a + bi[Crow];
-        for (k=0; k<ncols; k++) {
-          ierr = PetscTableFind(cmap,bmap[cols[k]]+1,&tcol);CHKERRQ(ierr);
-          if (tcol) {
-            subcols[i]   = --tcol;
-            subvals[i++] = vals[k];
+          /* off-diagonal part B = c->B */
+          ncols = bi[Crow+1] - bi[Crow];
+          cols  = bj + bi[Crow];
+          vals  = b->a + bi[Crow];
+          for (k=0; k<ncols; k++) {
+            ierr = PetscHMapIGetWithDefault(cmap,bmap[cols[k]],0,&tcol);CHKERRQ(ierr);
+            if (tcol) {
+              subcols[i]   = --tcol;
+              subvals[i++] = vals[k];
+            }
           }
-        }
 #else
-        /* diagonal part A = c->A */
-        ncols = ai[Crow+1] - ai[Crow];
-        cols  = aj + ai[Crow];
-        vals  = a->a + ai[Crow];
-        i     = 0;
-        for (k=0; k<ncols; k++) {
-          tcol = cmap[cols[k]+cstart];
-          if (tcol) {
-            subcols[i]   = --tcol;
-            subvals[i++] = vals[k];
+          /* diagonal part A = c->A */
+          ncols = ai[Crow+1] - ai[Crow];
+          cols  = aj + ai[Crow];
+          vals  = a->a + ai[Crow];
+          i     = 0;
+          for (k=0; k<ncols; k++) {
+            tcol = cmap[cols[k]+cstart];
+            if (tcol) {
+              subcols[i]   = --tcol;
+              subvals[i++] = vals[k];
+            }
           }
-        }
 
-        /* off-diagonal part B = c->B */
-        ncols = bi[Crow+1] - bi[Crow];
-        cols  = bj + bi[Crow];
-        vals  = b->a + bi[Crow];
-        for (k=0; k<ncols; k++) {
-          tcol = cmap[bmap[cols[k]]];
-          if (tcol) {
-            subcols[i]   = --tcol;
-            subvals[i++] = vals[k];
+          /* off-diagonal part B = c->B */
+          ncols = bi[Crow+1] - bi[Crow];
+          cols  = bj + bi[Crow];
+          vals  = b->a + bi[Crow];
+          for (k=0; k<ncols; k++) {
+            tcol = cmap[bmap[cols[k]]];
+            if (tcol) {
+              subcols[i]   = --tcol;
+              subvals[i++] = vals[k];
+            }
           }
-        }
 #endif
-        ierr = MatSetValues_SeqAIJ(submat,1,&row,i,subcols,subvals,INSERT_VALUES);CHKERRQ(ierr);
-      }
-    }
-  }
-
-  /* Now assemble the off-proc rows */
-  for (i=0; i<nrqs; i++) { /* for each requested message */
-    /* recv values from other processes */
-    ierr    = MPI_Waitany(nrqs,r_waits4,&idex,r_status4+i);CHKERRQ(ierr);
-    proc    = pa[idex];
-    sbuf1_i = sbuf1[proc];
-    /* jmax    = sbuf1_i[0]; if (jmax != 1)SETERRQ1(PETSC_COMM_SELF,0,"jmax %d != 1",jmax); */
-    ct1     = 2 + 1;
-    ct2     = 0; /* count of received C->j */
-    ct3     = 0; /* count of received C->j that will be inserted into submat */
-    rbuf2_i = rbuf2[idex]; /* int** received length of C->j from other processes */
-    rbuf3_i = rbuf3[idex]; /* int** received C->j from other processes */
-    rbuf4_i = rbuf4[idex]; /* scalar** received C->a from other processes */
-
-    /* is_no = sbuf1_i[2*j-1]; if (is_no != 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_PLIB,"is_no !=0"); */
-    max1 = sbuf1_i[2];             /* num of rows */
-    for (k=0; k<max1; k++,ct1++) { /* for each recved row */
-      row = sbuf1_i[ct1]; /* row index of submat */
-      if (!allcolumns) {
-        idex = 0;
-        if (scall == MAT_INITIAL_MATRIX) {
-          nnz  = rbuf2_i[ct1]; /* num of C entries in this row */
+          ierr = MatSetValues_SeqAIJ(submat,1,&row,i,subcols,subvals,INSERT_VALUES);CHKERRQ(ierr);
+        }
+      }
+    }
+
+    /* Now assemble the off-proc rows */
+    for (i=0; i<nrqs; i++) { /* for each requested message */
+      /* recv values from other processes */
+      ierr    = MPI_Waitany(nrqs,v_waits,&idex,r_status4+i);CHKERRQ(ierr);
+      proc    = pa[idex];
+      sbuf1_i = sbuf1[proc];
+      /* jmax    = sbuf1_i[0]; if (jmax != 1)SETERRQ1(PETSC_COMM_SELF,0,"jmax %d != 1",jmax); */
+      ct1     = 2 + 1;
+      ct2     = 0; /* count of received C->j */
+      rbuf2_i = rbuf2[idex]; /* int** received length of C->j from other processes */
+      rbuf3_i = rbuf3[idex]; /* int** received C->j from other processes */
+      rbuf4_i = rbuf4[idex]; /* scalar** received C->a from other processes */
+
+      /* is_no = sbuf1_i[2*j-1]; if (is_no != 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_PLIB,"is_no !=0"); */
+      max1 = sbuf1_i[2];             /* num of rows */
+      for (k=0; k<max1; k++,ct1++) { /* for each recved row */
+        row = sbuf1_i[ct1]; /* row index of submat */
+        nnz = rbuf2_i[ct1]; /* num of C entries in this row */
+        if (!allcolumns) {
+          idex = 0;
           for (l=0; l<nnz; l++,ct2++) { /* for each recved column */
 #if defined(PETSC_USE_CTABLE)
             if (rbuf3_i[ct2] >= cstart && rbuf3_i[ct2] <cend) {
               tcol = cmap_loc[rbuf3_i[ct2] - cstart];
             } else {
-              ierr = PetscTableFind(cmap,rbuf3_i[ct2]+1,&tcol);CHKERRQ(ierr);
+              ierr = PetscHMapIGetWithDefault(cmap,rbuf3_i[ct2],0,&tcol);CHKERRQ(ierr);
             }
 #else
             tcol = cmap[rbuf3_i[ct2]];
@@ -1875,43 +1857,104 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_SingleIS_Local(Mat C,PetscInt ismax,c
             if (tcol) {
               subcols[idex]   = --tcol;
               subvals[idex++] = rbuf4_i[ct2];
-
-              /* We receive an entire column of C, but a subset of it needs to be inserted into submat.
-               For reuse, we replace received C->j with index that should be inserted to submat */
-              rbuf3_i[ct3++] = ct2;
             }
           }
           ierr = MatSetValues_SeqAIJ(submat,1,&row,idex,subcols,subvals,INSERT_VALUES);CHKERRQ(ierr);
-
-        } else { /* scall == MAT_REUSE_MATRIX */
-          submat = submats[0];
-          subc   = (Mat_SeqAIJ*)submat->data;
-
-          nnz = subc->i[row+1] - subc->i[row]; /* num of submat entries in this row */
-          for (l=0; l<nnz; l++) {
-            ct2 = rbuf3_i[ct3++]; /* index of rbuf4_i[] which needs to be inserted into submat */
-            subvals[idex++] = rbuf4_i[ct2];
-          }
-
-          bj = subc->j + subc->i[row];
-          ierr = MatSetValues_SeqAIJ(submat,1,&row,nnz,bj,subvals,INSERT_VALUES);CHKERRQ(ierr);
+        } else { /* allcolumns */
+          ierr = MatSetValues_SeqAIJ(submat,1,&row,nnz,rbuf3_i+ct2,rbuf4_i+ct2,INSERT_VALUES);CHKERRQ(ierr);
+          ct2 += nnz;
         }
-      } else { /* allcolumns */
-        nnz  = rbuf2_i[ct1]; /* num of C entries in this row */
-        ierr = MatSetValues_SeqAIJ(submat,1,&row,nnz,rbuf3_i+ct2,rbuf4_i+ct2,INSERT_VALUES);CHKERRQ(ierr);
-        ct2 += nnz;
       }
     }
-  }
+  } /* endof scall == MAT_INITIAL_MATRIX */
 
   /* sending a->a are done */
-  ierr = MPI_Waitall(nrqr,s_waits4,s_status4);CHKERRQ(ierr);
-  ierr = PetscFree4(r_waits4,s_waits4,r_status4,s_status4);CHKERRQ(ierr);
+  if (nrqr) {ierr = MPI_Waitall(nrqr,v_waits+nrqs,s_status4);CHKERRQ(ierr);}
+  ierr = PetscFree2(r_status4,s_status4);CHKERRQ(ierr);
 
   ierr = MatAssemblyBegin(submat,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
   ierr = MatAssemblyEnd(submat,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
   submats[0] = submat;
 
+  if (scall == MAT_INITIAL_MATRIX) {
+    /* Record the location in the assembled submat of each value, for MAT_REUSE_MATRIX;
+       the row j of submat is irow[j] */
+    for (j=0,l=0; j<nrow; j++) {
+      if (row2proc[j] != rank) continue;
+      Crow = irow[j] - rstart;
+      l   += ai[Crow+1] - ai[Crow] + bi[Crow+1] - bi[Crow];
+    }
+    ierr = PetscMalloc1(l+1,&loc_dest);CHKERRQ(ierr);
+    for (j=0,l=0; j<nrow; j++) {
+      if (row2proc[j] != rank) continue;
+      Crow = irow[j] - rstart;
+      for (k=ai[Crow]; k<ai[Crow+1]; k++,l++) {
+        if (allcolumns) tcol = aj[k] + cstart + 1;
+        else {
+#if defined(PETSC_USE_CTABLE)
+          tcol = cmap_loc[aj[k]];
+#else
+          tcol = cmap[aj[k]+cstart];
+#endif
+        }
+        if (tcol) {
+          ierr = PetscFindInt(tcol-1,subc->i[j+1]-subc->i[j],subc->j+subc->i[j],&loc);CHKERRQ(ierr);
+          loc_dest[l] = subc->i[j] + loc;
+        } else loc_dest[l] = -1;
+      }
+      for (k=bi[Crow]; k<bi[Crow+1]; k++,l++) {
+        if (allcolumns) tcol = bmap[bj[k]] + 1;
+        else {
+#if defined(PETSC_USE_CTABLE)
+          ierr = PetscHMapIGetWithDefault(cmap,bmap[bj[k]],0,&tcol);CHKERRQ(ierr);
+#else
+          tcol = cmap[bmap[bj[k]]];
+#endif
+        }
+        if (tcol) {
+          ierr = PetscFindInt(tcol-1,subc->i[j+1]-subc->i[j],subc->j+subc->i[j],&loc);CHKERRQ(ierr);
+          loc_dest[l] = subc->i[j] + loc;
+        } else loc_dest[l] = -1;
+      }
+    }
+    smatis1->loc_dest = loc_dest;
+
+    for (i=0,j=0; i<nrqs; i++) j += rbuf2[i][0];
+    ierr = PetscMalloc1(j+1,&rbuf4_dest);CHKERRQ(ierr);
+    for (i=0; i<nrqs; i++) {
+      sbuf1_i      = sbuf1[pa[i]];
+      ct1          = 2 + 1;
+      ct2          = 0;
+      rbuf2_i      = rbuf2[i];
+      rbuf3_i      = rbuf3[i];
+      rbuf4_dest_i = rbuf4_dest + (rbuf4[i] - rbuf4[0]);
+      max1         = sbuf1_i[2];
+      for (k=0; k<max1; k++,ct1++) {
+        row = sbuf1_i[ct1]; /* row index of submat */
+        nnz = rbuf2_i[ct1];
+        for (l=0; l<nnz; l++,ct2++) {
+          if (allcolumns) tcol = rbuf3_i[ct2] + 1;
+          else {
+#if defined(PETSC_USE_CTABLE)
+            if (rbuf3_i[ct2] >= cstart && rbuf3_i[ct2] <cend) {
+              tcol = cmap_loc[rbuf3_i[ct2] - cstart];
+            } else {
+              ierr = PetscHMapIGetWithDefault(cmap,rbuf3_i[ct2],0,&tcol);CHKERRQ(ierr);
+            }
+#else
+            tcol = cmap[rbuf3_i[ct2]];
+#endif
+          }
+          if (tcol) {
+            ierr = PetscFindInt(tcol-1,subc->i[row+1]-subc->i[row],subc->j+subc->i[row],&loc);CHKERRQ(ierr);
+            rbuf4_dest_i[ct2] = subc->i[row] + loc;
+          } else rbuf4_dest_i[ct2] = -1;
+        }
+      }
+    }
+    smatis1->rbuf4_dest = rbuf4_dest;
+  }
+
   /* Restore the indices */
   ierr = ISRestoreIndices(isrow[0],&irow);CHKERRQ(ierr);
   if (!allcolumns) {
@@ -1919,14 +1962,8 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_SingleIS_Local(Mat C,PetscInt ismax,c
   }
 
   /* Destroy allocated memory */
-  for (i=0; i<nrqs; ++i) {
-    ierr = PetscFree3(rbuf4[i],subcols,subvals);CHKERRQ(ierr);
-  }
-  ierr = PetscFree3(rbuf4,subcols,subvals);CHKERRQ(ierr);
-  ierr = PetscFree(sbuf_aa[0]);CHKERRQ(ierr);
-  ierr = PetscFree(sbuf_aa);CHKERRQ(ierr);
-
   if (scall == MAT_INITIAL_MATRIX) {
+    ierr = PetscFree2(subcols,subvals);CHKERRQ(ierr);
     ierr = PetscFree(lens);CHKERRQ(ierr);
     ierr = PetscFree(sbuf_aj[0]);CHKERRQ(ierr);
     ierr = PetscFree(sbuf_aj);CHKERRQ(ierr);
@@ -2068,14 +2105,14 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS i
   PetscInt       **rbuf3=NULL,*req_source1=NULL,*req_source2,**sbuf_aj,**rbuf2=NULL,max1,max2;
   PetscInt       **lens,is_no,ncols,*cols,mat_i,*mat_j,tmp2,jmax;
 #if defined(PETSC_USE_CTABLE)
-  PetscTable     *cmap,cmap_i=NULL,*rmap,rmap_i;
+  PetscHMapI     *cmap,cmap_i=NULL,*rmap,rmap_i;
 #else
   PetscInt       **cmap,*cmap_i=NULL,**rmap,*rmap_i;
 #endif
   const PetscInt *irow_i;
   PetscInt       ctr_j,*sbuf1_j,*sbuf_aj_i,*rbuf1_i,kmax,*lens_i;
   MPI_Request    *s_waits1,*r_waits1,*s_waits2,*r_waits2,*r_waits3;
-  MPI_Request    *r_waits4,*s_waits3,*s_waits4;
+  MPI_Request    *s_waits3;
   MPI_Status     *r_status1,*r_status2,*s_status1,*s_status3,*s_status2;
   MPI_Status     *r_status3,*r_status4,*s_status4;
   MPI_Comm       comm;
@@ -2085,13 +2122,15 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS i
   Mat_SubSppt    *smat_i;
   PetscBool      *issorted,*allcolumns,colflag,iscsorted=PETSC_TRUE;
   PetscInt       *sbuf1_i,*rbuf2_i,*rbuf3_i,ilen;
+  MPI_Request    *v_waits=NULL;
+  PetscInt       **loc_dest,*loc_dest_i,*rbuf4_dest=NULL,*rbuf4_dest_i;
 
   PetscFunctionBegin;
   ierr = PetscObjectGetComm((PetscObject)C,&comm);CHKERRQ(ierr);
   size = c->size;
   rank = c->rank;
 
-  ierr = PetscMalloc4(ismax,&row2proc,ismax,&cmap,ismax,&rmap,ismax+1,&allcolumns);CHKERRQ(ierr);
+  ierr = PetscMalloc5(ismax,&row2proc,ismax,&cmap,ismax,&rmap,ismax+1,&allcolumns,ismax,&loc_dest);CHKERRQ(ierr);
   ierr = PetscMalloc5(ismax,&irow,ismax,&icol,ismax,&nrow,ismax,&ncol,ismax,&issorted);CHKERRQ(ierr);
 
   for (i=0; i<ismax; i++) {
@@ -2122,9 +2161,6 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS i
       subc = (Mat_SeqAIJ*)submats[i]->data;
       if ((submats[i]->rmap->n != nrow[i]) || (submats[i]->cmap->n != ncol[i])) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Cannot reuse matrix. wrong size");
 
-      /* Initial matrix as if empty */
-      ierr = PetscMemzero(subc->ilen,submats[i]->rmap->n*sizeof(PetscInt));CHKERRQ(ierr);
-
       smat_i   = subc->submatis1;
 
       nrqs        = smat_i->nrqs;
@@ -2144,10 +2180,16 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS i
       req_size    = smat_i->req_size;
       req_source1 = smat_i->req_source1;
 
+      v_waits     = smat_i->v_waits;
+      rbuf4       = smat_i->rbuf4;
+      sbuf_aa     = smat_i->sbuf_aa;
+      rbuf4_dest  = smat_i->rbuf4_dest;
+
       allcolumns[i] = smat_i->allcolumns;
       row2proc[i]   = smat_i->row2proc;
       rmap[i]       = smat_i->rmap;
       cmap[i]       = smat_i->cmap;
+      loc_dest[i]   = smat_i->loc_dest;
     }
 
     if (!ismax){ /* Get dummy submatrices and retrieve struct submatis1 */
@@ -2171,6 +2213,11 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS i
       req_size    = smat_i->req_size;
       req_source1 = smat_i->req_source1;
 
+      v_waits     = smat_i->v_waits;
+      rbuf4       = smat_i->rbuf4;
+      sbuf_aa     = smat_i->sbuf_aa;
+      rbuf4_dest  = smat_i->rbuf4_dest;
+
       allcolumns[0] = PETSC_FALSE;
     }
   } else { /* scall == MAT_INITIAL_MATRIX */
@@ -2412,13 +2459,14 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS i
 #if defined(PETSC_USE_CTABLE)
       for (i=0; i<ismax; i++) {
         if (!allcolumns[i]) {
-          ierr = PetscTableCreate(ncol[i]+1,C->cmap->N+1,&cmap[i]);CHKERRQ(ierr);
+          ierr = PetscHMapICreate(&cmap[i]);CHKERRQ(ierr);
+          ierr = PetscHMapIResize(cmap[i],ncol[i]);CHKERRQ(ierr);
 
           jmax   = ncol[i];
           icol_i = icol[i];
           cmap_i = cmap[i];
           for (j=0; j<jmax; j++) {
-            ierr = PetscTableAdd(cmap[i],icol_i[j]+1,j+1,INSERT_VALUES);CHKERRQ(ierr);
+            ierr = PetscHMapISet(cmap[i],icol_i[j],j+1);CHKERRQ(ierr);
           }
         } else cmap[i] = NULL;
       }
@@ -2461,7 +2509,7 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS i
           if (!allcolumns[i]) {
             for (k=0; k<ncols; k++) {
 #if defined(PETSC_USE_CTABLE)
-              ierr = PetscTableFind(cmap_i,cols[k]+1,&tcol);CHKERRQ(ierr);
+              ierr = PetscHMapIGetWithDefault(cmap_i,cols[k],0,&tcol);CHKERRQ(ierr);
 #else
               tcol = cmap_i[cols[k]];
 #endif
@@ -2478,11 +2526,12 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS i
     /* Create row map: global row of C -> local row of submatrices */
 #if defined(PETSC_USE_CTABLE)
     for (i=0; i<ismax; i++) {
-      ierr   = PetscTableCreate(nrow[i]+1,C->rmap->N+1,&rmap[i]);CHKERRQ(ierr);
+      ierr = PetscHMapICreate(&rmap[i]);CHKERRQ(ierr);
+      ierr = PetscHMapIResize(rmap[i],nrow[i]);CHKERRQ(ierr);
       irow_i = irow[i];
       jmax   = nrow[i];
       for (j=0; j<jmax; j++) {
-      ierr = PetscTableAdd(rmap[i],irow_i[j]+1,j+1,INSERT_VALUES);CHKERRQ(ierr);
+      ierr = PetscHMapISet(rmap[i],irow_i[j],j+1);CHKERRQ(ierr);
       }
     }
 #else
@@ -2517,7 +2566,7 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS i
           rmap_i = rmap[is_no];
           for (k=0; k<max1; k++,ct1++) {
 #if defined(PETSC_USE_CTABLE)
-            ierr = PetscTableFind(rmap_i,sbuf1_i[ct1]+1,&row);CHKERRQ(ierr);
+            ierr = PetscHMapIGetWithDefault(rmap_i,sbuf1_i[ct1],0,&row);CHKERRQ(ierr);
             row--;
             if (row < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_PLIB,"row not found in table");
 #else
@@ -2527,7 +2576,7 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS i
             for (l=0; l<max2; l++,ct2++) {
               if (!allcolumns[is_no]) {
 #if defined(PETSC_USE_CTABLE)
-                ierr = PetscTableFind(cmap_i,rbuf3_i[ct2]+1,&tcol);CHKERRQ(ierr);
+                ierr = PetscHMapIGetWithDefault(cmap_i,rbuf3_i[ct2],0,&tcol);CHKERRQ(ierr);
 #else
                 tcol = cmap_i[rbuf3_i[ct2]];
 #endif
@@ -2545,6 +2594,25 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS i
     ierr = PetscFree2(r_status3,s_status3);CHKERRQ(ierr);
     ierr = PetscFree(s_waits3);CHKERRQ(ierr);
 
+    /* Set up the exchange of the matrix values; it is kept with the submatrices so that
+       MAT_REUSE_MATRIX only restarts these persistent requests */
+    ierr = PetscObjectGetNewTag((PetscObject)C,&tag4);CHKERRQ(ierr);
+    ierr = PetscMalloc2(nrqs+1,&rbuf4,nrqr+1,&sbuf_aa);CHKERRQ(ierr);
+    for (i=0,j=0; i<nrqs; i++) j += rbuf2[i][0];
+    ierr = PetscMalloc1(j+1,&rbuf4[0]);CHKERRQ(ierr);
+    for (i=1; i<nrqs; i++) rbuf4[i] = rbuf4[i-1] + rbuf2[i-1][0];
+    for (i=0,j=0; i<nrqr; i++) j += req_size[i];
+    ierr = PetscMalloc1(j+1,&sbuf_aa[0]);CHKERRQ(ierr);
+    for (i=1; i<nrqr; i++) sbuf_aa[i] = sbuf_aa[i-1] + req_size[i-1];
+
+    ierr = PetscMalloc1(nrqs+nrqr+1,&v_waits);CHKERRQ(ierr);
+    for (i=0; i<nrqs; ++i) {
+      ierr = MPI_Recv_init(rbuf4[i],rbuf2[i][0],MPIU_SCALAR,req_source2[i],tag4,comm,v_waits+i);CHKERRQ(ierr);
+    }
+    for (i=0; i<nrqr; ++i) {
+      ierr = MPI_Send_init(sbuf_aa[i],req_size[i],MPIU_SCALAR,req_source1[i],tag4,comm,v_waits+nrqs+i);CHKERRQ(ierr);
+    }
+
     /* Create the submatrices */
     for (i=0; i<ismax; i++) {
       PetscInt    rbs,cbs;
@@ -2586,6 +2654,10 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS i
       smat_i->req_size     = req_size;
       smat_i->req_source1  = req_source1;
 
+      smat_i->v_waits      = v_waits;
+      smat_i->rbuf4        = rbuf4;
+      smat_i->sbuf_aa      = sbuf_aa;
+
       smat_i->allcolumns  = allcolumns[i];
       smat_i->singleis    = PETSC_FALSE;
       smat_i->row2proc    = row2proc[i];
@@ -2624,6 +2696,10 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS i
       smat_i->req_size     = req_size;
       smat_i->req_source1  = req_source1;
 
+      smat_i->v_waits      = v_waits;
+      smat_i->rbuf4        = rbuf4;
+      smat_i->sbuf_aa      = sbuf_aa;
+
       smat_i->allcolumns  = PETSC_FALSE;
       smat_i->singleis    = PETSC_FALSE;
       smat_i->row2proc    = NULL;
@@ -2639,23 +2715,11 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS i
   } /* endof scall == MAT_INITIAL_MATRIX */
 
   /* Post recv matrix values */
-  ierr = PetscObjectGetNewTag((PetscObject)C,&tag4);CHKERRQ(ierr);
-  ierr = PetscMalloc1(nrqs+1,&rbuf4);CHKERRQ(ierr);
-  ierr = PetscMalloc1(nrqs+1,&r_waits4);CHKERRQ(ierr);
   ierr = PetscMalloc1(nrqs+1,&r_status4);CHKERRQ(ierr);
   ierr = PetscMalloc1(nrqr+1,&s_status4);CHKERRQ(ierr);
-  for (i=0; i<nrqs; ++i) {
-    ierr = PetscMalloc1(rbuf2[i][0]+1,&rbuf4[i]);CHKERRQ(ierr);
-    ierr = MPI_Irecv(rbuf4[i],rbuf2[i][0],MPIU_SCALAR,req_source2[i],tag4,comm,r_waits4+i);CHKERRQ(ierr);
-  }
-
-  /* Allocate sending buffers for a->a, and send them off */
-  ierr = PetscMalloc1(nrqr+1,&sbuf_aa);CHKERRQ(ierr);
-  for (i=0,j=0; i<nrqr; i++) j += req_size[i];
-  ierr = PetscMalloc1(j+1,&sbuf_aa[0]);CHKERRQ(ierr);
-  for (i=1; i<nrqr; i++) sbuf_aa[i] = sbuf_aa[i-1] + req_size[i-1];
+  if (nrqs) {ierr = MPI_Startall(nrqs,v_waits);CHKERRQ(ierr);}
 
-  ierr = PetscMalloc1(nrqr+1,&s_waits4);CHKERRQ(ierr);
+  /* Load the sending buffers with a->a, and send them off */
   {
     PetscInt    nzA,nzB,*a_i = a->i,*b_i = b->i, *cworkB,lwrite;
     PetscInt    cstart = C->cmap->rstart,rstart = C->rmap->rstart,*bmap = c->garray;
@@ -2693,150 +2757,283 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS i
           ct2 += ncols;
         }
       }
-      ierr = MPI_Isend(sbuf_aa_i,req_size[i],MPIU_SCALAR,req_source1[i],tag4,comm,s_waits4+i);CHKERRQ(ierr);
     }
   }
+  if (nrqr) {ierr = MPI_Startall(nrqr,v_waits+nrqs);CHKERRQ(ierr);}
 
-  /* Assemble the matrices */
-  /* First assemble the local rows */
-  for (i=0; i<ismax; i++) {
-    row2proc_i = row2proc[i];
-    subc      = (Mat_SeqAIJ*)submats[i]->data;
-    imat_ilen = subc->ilen;
-    imat_j    = subc->j;
-    imat_i    = subc->i;
-    imat_a    = subc->a;
-
-    if (!allcolumns[i]) cmap_i = cmap[i];
-    rmap_i = rmap[i];
-    irow_i = irow[i];
-    jmax   = nrow[i];
-    for (j=0; j<jmax; j++) {
-      row  = irow_i[j];
-      proc = row2proc_i[j];
-      if (proc == rank) {
-        old_row = row;
+  if (scall == MAT_REUSE_MATRIX) {
+    /* The nonzero structure is unchanged, put the values directly at their recorded locations */
+    for (i=0; i<ismax; i++) {
+      row2proc_i = row2proc[i];
+      loc_dest_i = loc_dest[i];
+      imat_a     = ((Mat_SeqAIJ*)submats[i]->data)->a;
+      irow_i     = irow[i];
+      jmax       = nrow[i];
+      for (j=0,l=0; j<jmax; j++) {
+        if (row2proc_i[j] != rank) continue;
+        ierr = MatGetRow_MPIAIJ(C,irow_i[j],&ncols,NULL,&vals);CHKERRQ(ierr);
+        for (k=0; k<ncols; k++,l++) {
+          if (loc_dest_i[l] >= 0) imat_a[loc_dest_i[l]] = vals[k];
+        }
+        ierr = MatRestoreRow_MPIAIJ(C,irow_i[j],&ncols,NULL,&vals);CHKERRQ(ierr);
+      }
+    }
+
+    if (nrqs) {ierr = MPI_Waitall(nrqs,v_waits,r_status4);CHKERRQ(ierr);}
+    for (tmp2=0; tmp2<nrqs; tmp2++) {
+      sbuf1_i      = sbuf1[pa[tmp2]];
+      jmax         = sbuf1_i[0];
+      ct1          = 2*jmax + 1;
+      ct2          = 0;
+      rbuf2_i      = rbuf2[tmp2];
+      rbuf4_i      = rbuf4[tmp2];
+      rbuf4_dest_i = rbuf4_dest + (rbuf4_i - rbuf4[0]);
+      for (j=1; j<=jmax; j++) {
+        imat_a = ((Mat_SeqAIJ*)submats[sbuf1_i[2*j-1]]->data)->a;
+        max1   = sbuf1_i[2*j];
+        for (k=0; k<max1; k++,ct1++) {
+          max2 = rbuf2_i[ct1];
+          for (l=0; l<max2; l++,ct2++) {
+            if (rbuf4_dest_i[ct2] >= 0) imat_a[rbuf4_dest_i[ct2]] = rbuf4_i[ct2];
+          }
+        }
+      }
+    }
+  } else {
+    /* Assemble the matrices */
+    /* First assemble the local rows */
+    for (i=0; i<ismax; i++) {
+      row2proc_i = row2proc[i];
+      subc      = (Mat_SeqAIJ*)submats[i]->data;
+      imat_ilen = subc->ilen;
+      imat_j    = subc->j;
+      imat_i    = subc->i;
+      imat_a    = subc->a;
+
+      if (!allcolumns[i]) cmap_i = cmap[i];
+      rmap_i = rmap[i];
+      irow_i = irow[i];
+      jmax   = nrow[i];
+      for (j=0; j<jmax; j++) {
+        row  = irow_i[j];
+        proc = row2proc_i[j];
+        if (proc == rank) {
+          old_row = row;
 #if defined(PETSC_USE_CTABLE)
-        ierr = PetscTableFind(rmap_i,row+1,&row);CHKERRQ(ierr);
-        row--;
+          ierr = PetscHMapIGetWithDefault(rmap_i,row,0,&row);CHKERRQ(ierr);
+          row--;
 #else
-        row = rmap_i[row];
+          row = rmap_i[row];
 #endif
-        ilen_row = imat_ilen[row];
-        ierr     = MatGetRow_MPIAIJ(C,old_row,&ncols,&cols,&vals);CHKERRQ(ierr);
-        mat_i    = imat_i[row];
-        mat_a    = imat_a + mat_i;
-        mat_j    = imat_j + mat_i;
-        if (!allcolumns[i]) {
-          for (k=0; k<ncols; k++) {
+          ilen_row = imat_ilen[row];
+          ierr     = MatGetRow_MPIAIJ(C,old_row,&ncols,&cols,&vals);CHKERRQ(ierr);
+          mat_i    = imat_i[row];
+          mat_a    = imat_a + mat_i;
+          mat_j    = imat_j + mat_i;
+          if (!allcolumns[i]) {
+            for (k=0; k<ncols; k++) {
 #if defined(PETSC_USE_CTABLE)
-            ierr = PetscTableFind(cmap_i,cols[k]+1,&tcol);CHKERRQ(ierr);
+              ierr = PetscHMapIGetWithDefault(cmap_i,cols[k],0,&tcol);CHKERRQ(ierr);
 #else
-            tcol = cmap_i[cols[k]];
+              tcol = cmap_i[cols[k]];
 #endif
-            if (tcol) {
-              *mat_j++ = tcol - 1;
+              if (tcol) {
+                *mat_j++ = tcol - 1;
+                *mat_a++ = vals[k];
+                ilen_row++;
+              }
+            }
+          } else { /* allcolumns */
+            for (k=0; k<ncols; k++) {
+              *mat_j++ = cols[k];  /* global col index! */
               *mat_a++ = vals[k];
               ilen_row++;
             }
           }
-        } else { /* allcolumns */
-          for (k=0; k<ncols; k++) {
-            *mat_j++ = cols[k];  /* global col index! */
-            *mat_a++ = vals[k];
-            ilen_row++;
-          }
-        }
-        ierr = MatRestoreRow_MPIAIJ(C,old_row,&ncols,&cols,&vals);CHKERRQ(ierr);
+          ierr = MatRestoreRow_MPIAIJ(C,old_row,&ncols,&cols,&vals);CHKERRQ(ierr);
 
-        imat_ilen[row] = ilen_row;
+          imat_ilen[row] = ilen_row;
+        }
       }
     }
-  }
 
-  /* Now assemble the off proc rows */
-  ierr    = MPI_Waitall(nrqs,r_waits4,r_status4);CHKERRQ(ierr);
-  for (tmp2=0; tmp2<nrqs; tmp2++) {
-    sbuf1_i = sbuf1[pa[tmp2]];
-    jmax    = sbuf1_i[0];
-    ct1     = 2*jmax + 1;
-    ct2     = 0;
-    rbuf2_i = rbuf2[tmp2];
-    rbuf3_i = rbuf3[tmp2];
-    rbuf4_i = rbuf4[tmp2];
-    for (j=1; j<=jmax; j++) {
-      is_no     = sbuf1_i[2*j-1];
-      rmap_i    = rmap[is_no];
-      if (!allcolumns[is_no]) cmap_i = cmap[is_no];
-      subc      = (Mat_SeqAIJ*)submats[is_no]->data;
-      imat_ilen = subc->ilen;
-      imat_j    = subc->j;
-      imat_i    = subc->i;
-      imat_a    = subc->a;
-      max1      = sbuf1_i[2*j];
-      for (k=0; k<max1; k++,ct1++) {
-        row = sbuf1_i[ct1];
+    /* Now assemble the off proc rows */
+    if (nrqs) {ierr = MPI_Waitall(nrqs,v_waits,r_status4);CHKERRQ(ierr);}
+    for (tmp2=0; tmp2<nrqs; tmp2++) {
+      sbuf1_i = sbuf1[pa[tmp2]];
+      jmax    = sbuf1_i[0];
+      ct1     = 2*jmax + 1;
+      ct2     = 0;
+      rbuf2_i = rbuf2[tmp2];
+      rbuf3_i = rbuf3[tmp2];
+      rbuf4_i = rbuf4[tmp2];
+      for (j=1; j<=jmax; j++) {
+        is_no     = sbuf1_i[2*j-1];
+        rmap_i    = rmap[is_no];
+        if (!allcolumns[is_no]) cmap_i = cmap[is_no];
+        subc      = (Mat_SeqAIJ*)submats[is_no]->data;
+        imat_ilen = subc->ilen;
+        imat_j    = subc->j;
+        imat_i    = subc->i;
+        imat_a    = subc->a;
+        max1      = sbuf1_i[2*j];
+        for (k=0; k<max1; k++,ct1++) {
+          row = sbuf1_i[ct1];
 #if defined(PETSC_USE_CTABLE)
-        ierr = PetscTableFind(rmap_i,row+1,&row);CHKERRQ(ierr);
-        row--;
+          ierr = PetscHMapIGetWithDefault(rmap_i,row,0,&row);CHKERRQ(ierr);
+          row--;
 #else
-        row = rmap_i[row];
+          row = rmap_i[row];
 #endif
-        ilen  = imat_ilen[row];
-        mat_i = imat_i[row];
-        mat_a = imat_a + mat_i;
-        mat_j = imat_j + mat_i;
-        max2  = rbuf2_i[ct1];
-        if (!allcolumns[is_no]) {
-          for (l=0; l<max2; l++,ct2++) {
+          ilen  = imat_ilen[row];
+          mat_i = imat_i[row];
+          mat_a = imat_a + mat_i;
+          mat_j = imat_j + mat_i;
+          max2  = rbuf2_i[ct1];
+          if (!allcolumns[is_no]) {
+            for (l=0; l<max2; l++,ct2++) {
 #if defined(PETSC_USE_CTABLE)
-            ierr = PetscTableFind(cmap_i,rbuf3_i[ct2]+1,&tcol);CHKERRQ(ierr);
+              ierr = PetscHMapIGetWithDefault(cmap_i,rbuf3_i[ct2],0,&tcol);CHKERRQ(ierr);
 #else
-            tcol = cmap_i[rbuf3_i[ct2]];
+              tcol = cmap_i[rbuf3_i[ct2]];
 #endif
-            if (tcol) {
-              *mat_j++ = tcol - 1;
+              if (tcol) {
+                *mat_j++ = tcol - 1;
+                *mat_a++ = rbuf4_i[ct2];
+                ilen++;
+              }
+            }
+          } else { /* allcolumns */
+            for (l=0; l<max2; l++,ct2++) {
+              *mat_j++ = rbuf3_i[ct2]; /* same global column index of C */
               *mat_a++ = rbuf4_i[ct2];
               ilen++;
             }
           }
-        } else { /* allcolumns */
-          for (l=0; l<max2; l++,ct2++) {
-            *mat_j++ = rbuf3_i[ct2]; /* same global column index of C */
-            *mat_a++ = rbuf4_i[ct2];
-            ilen++;
-          }
+          imat_ilen[row] = ilen;
         }
-        imat_ilen[row] = ilen;
       }
     }
-  }
 
-  if (!iscsorted) { /* sort column indices of the rows */
-    for (i=0; i<ismax; i++) {
-      subc      = (Mat_SeqAIJ*)submats[i]->data;
-      imat_j    = subc->j;
-      imat_i    = subc->i;
-      imat_a    = subc->a;
-      imat_ilen = subc->ilen;
-
-      if (allcolumns[i]) continue;
-      jmax = nrow[i];
-      for (j=0; j<jmax; j++) {
-        mat_i = imat_i[j];
-        mat_a = imat_a + mat_i;
-        mat_j = imat_j + mat_i;
-        ierr  = PetscSortIntWithScalarArray(imat_ilen[j],mat_j,mat_a);CHKERRQ(ierr);
+    if (!iscsorted) { /* sort column indices of the rows */
+      for (i=0; i<ismax; i++) {
+        subc      = (Mat_SeqAIJ*)submats[i]->data;
+        imat_j    = subc->j;
+        imat_i    = subc->i;
+        imat_a    = subc->a;
+        imat_ilen = subc->ilen;
+
+        if (allcolumns[i]) continue;
+        jmax = nrow[i];
+        for (j=0; j<jmax; j++) {
+          mat_i = imat_i[j];
+          mat_a = imat_a + mat_i;
+          mat_j = imat_j + mat_i;
+          ierr  = PetscSortIntWithScalarArray(imat_ilen[j],mat_j,mat_a);CHKERRQ(ierr);
+        }
       }
     }
-  }
+  } /* endof scall == MAT_INITIAL_MATRIX */
 
   ierr = PetscFree(r_status4);CHKERRQ(ierr);
-  ierr = PetscFree(r_waits4);CHKERRQ(ierr);
-  if (nrqr) {ierr = MPI_Waitall(nrqr,s_waits4,s_status4);CHKERRQ(ierr);}
-  ierr = PetscFree(s_waits4);CHKERRQ(ierr);
+  if (nrqr) {ierr = MPI_Waitall(nrqr,v_waits+nrqs,s_status4);CHKERRQ(ierr);}
   ierr = PetscFree(s_status4);CHKERRQ(ierr);
 
+  for (i=0; i<ismax; i++) {
+    ierr = MatAssemblyBegin(submats[i],MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+    ierr = MatAssemblyEnd(submats[i],MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  }
+
+  if (scall == MAT_INITIAL_MATRIX) {
+    /* Record the location in the assembled submatrices of each value, for MAT_REUSE_MATRIX */
+    PetscInt loc;
+
+    for (i=0; i<ismax; i++) {
+      subc       = (Mat_SeqAIJ*)submats[i]->data;
+      row2proc_i = row2proc[i];
+      if (!allcolumns[i]) cmap_i = cmap[i];
+      rmap_i     = rmap[i];
+      irow_i     = irow[i];
+      jmax       = nrow[i];
+      for (j=0,l=0; j<jmax; j++) {
+        if (row2proc_i[j] != rank) continue;
+        row = irow_i[j] - C->rmap->rstart;
+        l  += a->i[row+1] - a->i[row] + b->i[row+1] - b->i[row];
+      }
+      ierr = PetscMalloc1(l+1,&loc_dest_i);CHKERRQ(ierr);
+      for (j=0,l=0; j<jmax; j++) {
+        if (row2proc_i[j] != rank) continue;
+#if defined(PETSC_USE_CTABLE)
+        ierr = PetscHMapIGetWithDefault(rmap_i,irow_i[j],0,&row);CHKERRQ(ierr);
+        row--;
+#else
+        row = rmap_i[irow_i[j]];
+#endif
+        ierr = MatGetRow_MPIAIJ(C,irow_i[j],&ncols,&cols,NULL);CHKERRQ(ierr);
+        for (k=0; k<ncols; k++,l++) {
+          if (allcolumns[i]) tcol = cols[k] + 1;
+          else {
+#if defined(PETSC_USE_CTABLE)
+            ierr = PetscHMapIGetWithDefault(cmap_i,cols[k],0,&tcol);CHKERRQ(ierr);
+#else
+            tcol = cmap_i[cols[k]];
+#endif
+          }
+          if (tcol) {
+            ierr = PetscFindInt(tcol-1,subc->i[row+1]-subc->i[row],subc->j+subc->i[row],&loc);CHKERRQ(ierr);
+            loc_dest_i[l] = subc->i[row] + loc;
+          } else loc_dest_i[l] = -1;
+        }
+        ierr = MatRestoreRow_MPIAIJ(C,irow_i[j],&ncols,&cols,NULL);CHKERRQ(ierr);
+      }
+      subc->submatis1->loc_dest = loc_dest_i;
+    }
+
+    for (i=0,j=0; i<nrqs; i++) j += rbuf2[i][0];
+    ierr = PetscMalloc1(j+1,&rbuf4_dest);CHKERRQ(ierr);
+    for (tmp2=0; tmp2<nrqs; tmp2++) {
+      sbuf1_i      = sbuf1[pa[tmp2]];
+      jmax         = sbuf1_i[0];
+      ct1          = 2*jmax + 1;
+      ct2          = 0;
+      rbuf2_i      = rbuf2[tmp2];
+      rbuf3_i      = rbuf3[tmp2];
+      rbuf4_dest_i = rbuf4_dest + (rbuf4[tmp2] - rbuf4[0]);
+      for (j=1; j<=jmax; j++) {
+        is_no  = sbuf1_i[2*j-1];
+        subc   = (Mat_SeqAIJ*)submats[is_no]->data;
+        rmap_i = rmap[is_no];
+        if (!allcolumns[is_no]) cmap_i = cmap[is_no];
+        max1   = sbuf1_i[2*j];
+        for (k=0; k<max1; k++,ct1++) {
+#if defined(PETSC_USE_CTABLE)
+          ierr = PetscHMapIGetWithDefault(rmap_i,sbuf1_i[ct1],0,&row);CHKERRQ(ierr);
+          row--;
+#else
+          row = rmap_i[sbuf1_i[ct1]];
+#endif
+          max2 = rbuf2_i[ct1];
+          for (l=0; l<max2; l++,ct2++) {
+            if (allcolumns[is_no]) tcol = rbuf3_i[ct2] + 1;
+            else {
+#if defined(PETSC_USE_CTABLE)
+              ierr = PetscHMapIGetWithDefault(cmap_i,rbuf3_i[ct2],0,&tcol);CHKERRQ(ierr);
+#else
+              tcol = cmap_i[rbuf3_i[ct2]];
+#endif
+            }
+            if (tcol) {
+              ierr = PetscFindInt(tcol-1,subc->i[row+1]-subc->i[row],subc->j+subc->i[row],&loc);CHKERRQ(ierr);
+              rbuf4_dest_i[ct2] = subc->i[row] + loc;
+            } else rbuf4_dest_i[ct2] = -1;
+          }
+        }
+      }
+    }
+    for (i=0; i<ismax; i++) ((Mat_SeqAIJ*)submats[i]->data)->submatis1->rbuf4_dest = rbuf4_dest;
+    if (!ismax) ((Mat_SubSppt*)submats[0]->data)->rbuf4_dest = rbuf4_dest;
+  }
+
   /* Restore the indices */
   for (i=0; i<ismax; i++) {
     ierr = ISRestoreIndices(isrow[i],irow+i);CHKERRQ(ierr);
@@ -2845,22 +3042,9 @@ PetscErrorCode MatCreateSubMatrices_MPIAIJ_Local(Mat C,PetscInt ismax,const IS i
     }
   }
 
-  for (i=0; i<ismax; i++) {
-    ierr = MatAssemblyBegin(submats[i],MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
-    ierr = MatAssemblyEnd(submats[i],MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
-  }
-
   /* Destroy allocated memory */
-  ierr = PetscFree(sbuf_aa[0]);CHKERRQ(ierr);
-  ierr = PetscFree(sbuf_aa);CHKERRQ(ierr);
   ierr = PetscFree5(irow,icol,nrow,ncol,issorted);CHKERRQ(ierr);
-
-  for (i=0; i<nrqs; ++i) {
-    ierr = PetscFree(rbuf4[i]);CHKERRQ(ierr);
-  }
-  ierr = PetscFree(rbuf4);CHKERRQ(ierr);
-
-  ierr = PetscFree4(row2proc,cmap,rmap,allcolumns);CHKERRQ(ierr);
+  ierr = PetscFree5(row2proc,cmap,rmap,allcolumns,loc_dest);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
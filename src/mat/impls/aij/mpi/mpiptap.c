@@ -9,6 +9,9 @@
 #include <../src/mat/impls/aij/mpi/mpiaij.h>
 #include <petscbt.h>
 #include <petsctime.h>
+#include <petsc/private/hashseti.h>
+#include <petsc/private/hashmapiv.h>
+#include <petscsf.h>
 
 /* #define PTAP_PROFILE */
 
@@ -40,6 +43,11 @@ PetscErrorCode MatDestroy_MPIAIJ_PtAP(Mat A)
     ierr = MatDestroy(&ptap->C_loc);CHKERRQ(ierr);
     ierr = MatDestroy(&ptap->C_oth);CHKERRQ(ierr);
     if (ptap->apa) {ierr = PetscFree(ptap->apa);CHKERRQ(ierr);}
+    ierr = PetscFree3(ptap->c_othi,ptap->c_othj,ptap->c_otha);CHKERRQ(ierr);
+    ierr = PetscSFDestroy(&ptap->sf);CHKERRQ(ierr);
+    ierr = PetscFree(ptap->recvrows);CHKERRQ(ierr);
+    ierr = PetscFree(ptap->recvi);CHKERRQ(ierr);
+    ierr = PetscFree2(ptap->recvj,ptap->recva);CHKERRQ(ierr);
 
     if (merge) { /* used by alg_ptap */
       ierr = PetscFree(merge->id_r);CHKERRQ(ierr);
@@ -535,6 +543,326 @@ PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ_scalable(Mat A,Mat P,PetscReal fill
   PetscFunctionReturn(0);
 }
 
+/*
+   All-at-once P^T*A*P: row i of A*P is formed in a hash table and immediately multiplied by row i of P,
+   C[k,:] += P[i,k]*(A*P)[i,:], so neither A*P nor P^T are stored.  Rows k of C owned by other processes
+   (the columns of P->B) are accumulated in c_oth and sent to their owners through a PetscSF.
+*/
+
+/* puts row i of A*P in (*apj,*apv), the column indices of P are global */
+static PetscErrorCode MatPtAPGetAPRow_allatonce(Mat A,Mat P,Mat_SeqAIJ *p_oth,PetscInt i,PetscHMapIV apmap,PetscInt *apnz,PetscInt *apmax,PetscInt **apj,PetscScalar **apv,PetscScalar **work,PetscLogDouble *flops)
+{
+  PetscErrorCode ierr;
+  Mat_MPIAIJ     *a   = (Mat_MPIAIJ*)A->data,*p = (Mat_MPIAIJ*)P->data;
+  Mat_SeqAIJ     *ad  = (Mat_SeqAIJ*)(a->A)->data,*ao = (Mat_SeqAIJ*)(a->B)->data;
+  Mat_SeqAIJ     *pd  = (Mat_SeqAIJ*)(p->A)->data,*po = (Mat_SeqAIJ*)(p->B)->data;
+  PetscInt       j,k,row,pcstart = P->cmap->rstart,off = 0;
+  PetscScalar    av;
+
+  PetscFunctionBegin;
+  ierr = PetscHMapIVClear(apmap);CHKERRQ(ierr);
+  for (j=ad->i[i]; j<ad->i[i+1]; j++) {
+    row = ad->j[j]; av = ad->a[j];
+    for (k=pd->i[row]; k<pd->i[row+1]; k++) {
+      ierr = PetscHMapIVAddValue(apmap,pd->j[k]+pcstart,av*pd->a[k]);CHKERRQ(ierr);
+    }
+    for (k=po->i[row]; k<po->i[row+1]; k++) {
+      ierr = PetscHMapIVAddValue(apmap,p->garray[po->j[k]],av*po->a[k]);CHKERRQ(ierr);
+    }
+    *flops += 2.0*(pd->i[row+1] - pd->i[row] + po->i[row+1] - po->i[row]);
+  }
+  if (p_oth) {
+    for (j=ao->i[i]; j<ao->i[i+1]; j++) {
+      row = ao->j[j]; av = ao->a[j];
+      for (k=p_oth->i[row]; k<p_oth->i[row+1]; k++) {
+        ierr = PetscHMapIVAddValue(apmap,p_oth->j[k],av*p_oth->a[k]);CHKERRQ(ierr);
+      }
+      *flops += 2.0*(p_oth->i[row+1] - p_oth->i[row]);
+    }
+  }
+  ierr = PetscHMapIVGetSize(apmap,apnz);CHKERRQ(ierr);
+  if (*apnz > *apmax) {
+    ierr   = PetscFree3(*apj,*apv,*work);CHKERRQ(ierr);
+    *apmax = PetscMax(*apnz,2*(*apmax));
+    ierr   = PetscMalloc3(*apmax,apj,*apmax,apv,*apmax,work);CHKERRQ(ierr);
+  }
+  ierr = PetscHMapIVGetPairs(apmap,&off,*apj,*apv);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce(Mat A,Mat P,Mat C)
+{
+  PetscErrorCode ierr;
+  Mat_MPIAIJ     *p    = (Mat_MPIAIJ*)P->data,*c = (Mat_MPIAIJ*)C->data;
+  Mat_SeqAIJ     *pd   = (Mat_SeqAIJ*)(p->A)->data,*po = (Mat_SeqAIJ*)(p->B)->data,*p_oth;
+  Mat_PtAPMPI    *ptap = c->ptap;
+  PetscInt       i,j,k,t,m,row,loc,am = A->rmap->n,pcstart = P->cmap->rstart,con = p->B->cmap->n;
+  PetscInt       apnz,apmax = 0,*apj = NULL,*c_othi = ptap->c_othi,*c_othj = ptap->c_othj;
+  PetscScalar    *apv = NULL,*work = NULL,pv;
+  PetscHMapIV    apmap;
+  PetscLogDouble flops = 0.0;
+
+  PetscFunctionBegin;
+  if (ptap->reuse == MAT_INITIAL_MATRIX && ptap->merged) { /* values were set by MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce_merged() */
+    ptap->reuse = MAT_REUSE_MATRIX;
+    PetscFunctionReturn(0);
+  }
+  if (ptap->reuse == MAT_REUSE_MATRIX) {
+    ierr = MatGetBrowsOfAoCols_MPIAIJ(A,P,MAT_REUSE_MATRIX,&ptap->startsj_s,&ptap->startsj_r,&ptap->bufa,&ptap->P_oth);CHKERRQ(ierr);
+  }
+  p_oth = ptap->P_oth ? (Mat_SeqAIJ*)(ptap->P_oth)->data : NULL;
+
+  ierr = MatZeroEntries(C);CHKERRQ(ierr);
+  ierr = PetscMemzero(ptap->c_otha,c_othi[con]*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = PetscHMapIVCreate(&apmap);CHKERRQ(ierr);
+  for (i=0; i<am; i++) {
+    ierr = MatPtAPGetAPRow_allatonce(A,P,p_oth,i,apmap,&apnz,&apmax,&apj,&apv,&work,&flops);CHKERRQ(ierr);
+    /* C[k,:] += P[i,k]*AP[i,:] for the rows k owned by this process */
+    for (j=pd->i[i]; j<pd->i[i+1]; j++) {
+      row = pd->j[j] + pcstart; pv = pd->a[j];
+      for (t=0; t<apnz; t++) work[t] = pv*apv[t];
+      ierr = MatSetValues(C,1,&row,apnz,apj,work,ADD_VALUES);CHKERRQ(ierr);
+    }
+    /* and for the rows owned by others */
+    for (j=po->i[i]; j<po->i[i+1]; j++) {
+      k = po->j[j]; pv = po->a[j];
+      for (t=0; t<apnz; t++) {
+        ierr = PetscFindInt(apj[t],c_othi[k+1]-c_othi[k],c_othj+c_othi[k],&loc);CHKERRQ(ierr);
+        ptap->c_otha[c_othi[k]+loc] += pv*apv[t];
+      }
+    }
+    flops += 2.0*apnz*(pd->i[i+1] - pd->i[i] + po->i[i+1] - po->i[i]);
+  }
+  ierr = PetscHMapIVDestroy(&apmap);CHKERRQ(ierr);
+  ierr = PetscFree3(apj,apv,work);CHKERRQ(ierr);
+
+  /* add the rows computed by other processes */
+  ierr = PetscSFReduceBegin(ptap->sf,MPIU_SCALAR,ptap->c_otha,ptap->recva,MPIU_REPLACE);CHKERRQ(ierr);
+  ierr = PetscSFReduceEnd(ptap->sf,MPIU_SCALAR,ptap->c_otha,ptap->recva,MPIU_REPLACE);CHKERRQ(ierr);
+  for (m=0; m<ptap->nrecvrows; m++) {
+    ierr = MatSetValues(C,1,&ptap->recvrows[m],ptap->recvi[m+1]-ptap->recvi[m],ptap->recvj+ptap->recvi[m],ptap->recva+ptap->recvi[m],ADD_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = PetscLogFlops(flops);CHKERRQ(ierr);
+  ptap->reuse = MAT_REUSE_MATRIX;
+  PetscFunctionReturn(0);
+}
+
+/*
+   Symbolic phase of the all-at-once algorithms: the column indices of each row of C are collected in a hash set,
+   or with merged in a hash map that also accumulates the values, so that C is complete at the end.
+*/
+static PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce_Private(Mat A,Mat P,PetscReal fill,PetscBool merged,Mat *C)
+{
+  PetscErrorCode    ierr;
+  Mat_PtAPMPI       *ptap;
+  Mat_MPIAIJ        *p = (Mat_MPIAIJ*)P->data,*c;
+  Mat_SeqAIJ        *pd = (Mat_SeqAIJ*)(p->A)->data,*po = (Mat_SeqAIJ*)(p->B)->data,*p_oth;
+  MPI_Comm          comm;
+  Mat               Cmpi;
+  PetscSF           sfrow;
+  const PetscInt    *rdegree;
+  const PetscSFNode *rowremote;
+  PetscSFNode       *remote;
+  PetscHSetI        *sets = NULL;
+  PetscHMapIV       *maps = NULL,apmap;
+  PetscInt          am = A->rmap->n,pn = P->cmap->n,pcstart = P->cmap->rstart,con = p->B->cmap->n;
+  PetscInt          i,j,k,t,m,e,n,row,nz,off,apnz,apmax = 0,*apj = NULL,*rowlen,*leafoff,*cols,cmax = 0,*dnz,*onz;
+  PetscScalar       *apv = NULL,*work = NULL,*vals,pv;
+  PetscLogDouble    flops = 0.0;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject)A,&comm);CHKERRQ(ierr);
+
+  /* create struct Mat_PtAPMPI and attached it to C later */
+  ierr         = PetscNew(&ptap);CHKERRQ(ierr);
+  ptap->reuse  = MAT_INITIAL_MATRIX;
+  ptap->merged = merged;
+
+  /* get P_oth by taking rows of P (= non-zero cols of local A) from other processors */
+  ierr  = MatGetBrowsOfAoCols_MPIAIJ(A,P,MAT_INITIAL_MATRIX,&ptap->startsj_s,&ptap->startsj_r,&ptap->bufa,&ptap->P_oth);CHKERRQ(ierr);
+  p_oth = ptap->P_oth ? (Mat_SeqAIJ*)(ptap->P_oth)->data : NULL;
+
+  /* (1) the column indices of the rows of C, pn local rows followed by con rows owned by others */
+  if (merged) {
+    ierr = PetscMalloc1(pn+con,&maps);CHKERRQ(ierr);
+    for (k=0; k<pn+con; k++) {ierr = PetscHMapIVCreate(&maps[k]);CHKERRQ(ierr);}
+  } else {
+    ierr = PetscMalloc1(pn+con,&sets);CHKERRQ(ierr);
+    for (k=0; k<pn+con; k++) {ierr = PetscHSetICreate(&sets[k]);CHKERRQ(ierr);}
+  }
+  ierr = PetscHMapIVCreate(&apmap);CHKERRQ(ierr);
+  for (i=0; i<am; i++) {
+    ierr = MatPtAPGetAPRow_allatonce(A,P,p_oth,i,apmap,&apnz,&apmax,&apj,&apv,&work,&flops);CHKERRQ(ierr);
+    for (j=pd->i[i]; j<pd->i[i+1]+po->i[i+1]-po->i[i]; j++) {
+      if (j < pd->i[i+1]) {k = pd->j[j]; pv = pd->a[j];}
+      else {k = pn + po->j[po->i[i]+j-pd->i[i+1]]; pv = po->a[po->i[i]+j-pd->i[i+1]];}
+      if (merged) {
+        for (t=0; t<apnz; t++) {ierr = PetscHMapIVAddValue(maps[k],apj[t],pv*apv[t]);CHKERRQ(ierr);}
+      } else {
+        ierr = PetscHSetIAddArray(sets[k],apnz,apj);CHKERRQ(ierr);
+      }
+    }
+    flops += 2.0*apnz*(pd->i[i+1] - pd->i[i] + po->i[i+1] - po->i[i]);
+  }
+  ierr = PetscHMapIVDestroy(&apmap);CHKERRQ(ierr);
+  ierr = PetscFree3(apj,apv,work);CHKERRQ(ierr);
+
+  /* (2) the rows owned by others, in sorted order */
+  ierr = PetscMalloc1(con,&rowlen);CHKERRQ(ierr);
+  for (k=0,nz=0; k<con; k++) {
+    if (merged) {ierr = PetscHMapIVGetSize(maps[pn+k],&rowlen[k]);CHKERRQ(ierr);}
+    else        {ierr = PetscHSetIGetSize(sets[pn+k],&rowlen[k]);CHKERRQ(ierr);}
+    nz += rowlen[k];
+  }
+  ierr = PetscMalloc3(con+1,&ptap->c_othi,nz,&ptap->c_othj,nz,&ptap->c_otha);CHKERRQ(ierr);
+  ptap->c_othi[0] = 0;
+  for (k=0; k<con; k++) {
+    ptap->c_othi[k+1] = ptap->c_othi[k] + rowlen[k];
+    off = ptap->c_othi[k];
+    if (merged) {
+      ierr = PetscHMapIVGetPairs(maps[pn+k],&off,ptap->c_othj,ptap->c_otha);CHKERRQ(ierr);
+      ierr = PetscSortIntWithScalarArray(rowlen[k],ptap->c_othj+ptap->c_othi[k],ptap->c_otha+ptap->c_othi[k]);CHKERRQ(ierr);
+      ierr = PetscHMapIVDestroy(&maps[pn+k]);CHKERRQ(ierr);
+    } else {
+      ierr = PetscHSetIGetElems(sets[pn+k],&off,ptap->c_othj);CHKERRQ(ierr);
+      ierr = PetscSortInt(rowlen[k],ptap->c_othj+ptap->c_othi[k]);CHKERRQ(ierr);
+      ierr = PetscHSetIDestroy(&sets[pn+k]);CHKERRQ(ierr);
+    }
+  }
+
+  /* (3) the communication pattern: each row owned by another process is a leaf of sfrow, with the row as root;
+         the owner gathers the row lengths and returns the offsets where it receives them */
+  ierr = PetscSFCreate(comm,&sfrow);CHKERRQ(ierr);
+  ierr = PetscSFSetGraphLayout(sfrow,P->cmap,con,NULL,PETSC_COPY_VALUES,p->garray);CHKERRQ(ierr);
+  ierr = PetscSFComputeDegreeBegin(sfrow,&rdegree);CHKERRQ(ierr);
+  ierr = PetscSFComputeDegreeEnd(sfrow,&rdegree);CHKERRQ(ierr);
+  for (k=0,ptap->nrecvrows=0; k<pn; k++) ptap->nrecvrows += rdegree[k];
+  ierr = PetscMalloc1(ptap->nrecvrows,&ptap->recvrows);CHKERRQ(ierr);
+  ierr = PetscMalloc1(ptap->nrecvrows+1,&ptap->recvi);CHKERRQ(ierr);
+  for (k=0,m=0; k<pn; k++) {
+    for (j=0; j<rdegree[k]; j++) ptap->recvrows[m++] = k + pcstart;
+  }
+  ierr = PetscSFGatherBegin(sfrow,MPIU_INT,rowlen,ptap->recvi+1);CHKERRQ(ierr);
+  ierr = PetscSFGatherEnd(sfrow,MPIU_INT,rowlen,ptap->recvi+1);CHKERRQ(ierr);
+  ptap->recvi[0] = 0;
+  for (m=0; m<ptap->nrecvrows; m++) ptap->recvi[m+1] += ptap->recvi[m];
+  ierr = PetscMalloc1(con,&leafoff);CHKERRQ(ierr);
+  ierr = PetscSFScatterBegin(sfrow,MPIU_INT,ptap->recvi,leafoff);CHKERRQ(ierr);
+  ierr = PetscSFScatterEnd(sfrow,MPIU_INT,ptap->recvi,leafoff);CHKERRQ(ierr);
+
+  /* each entry of c_oth is a leaf of ptap->sf */
+  ierr = PetscSFGetGraph(sfrow,NULL,NULL,NULL,&rowremote);CHKERRQ(ierr);
+  ierr = PetscMalloc1(ptap->c_othi[con],&remote);CHKERRQ(ierr);
+  for (k=0; k<con; k++) {
+    for (e=ptap->c_othi[k]; e<ptap->c_othi[k+1]; e++) {
+      remote[e].rank  = rowremote[k].rank;
+      remote[e].index = leafoff[k] + e - ptap->c_othi[k];
+    }
+  }
+  ierr = PetscSFCreate(comm,&ptap->sf);CHKERRQ(ierr);
+  ierr = PetscSFSetGraph(ptap->sf,ptap->recvi[ptap->nrecvrows],ptap->c_othi[con],NULL,PETSC_OWN_POINTER,remote,PETSC_OWN_POINTER);CHKERRQ(ierr);
+  ierr = PetscSFSetUp(ptap->sf);CHKERRQ(ierr);
+  ierr = PetscSFDestroy(&sfrow);CHKERRQ(ierr);
+  ierr = PetscFree(rowlen);CHKERRQ(ierr);
+  ierr = PetscFree(leafoff);CHKERRQ(ierr);
+
+  /* (4) receive the rows and merge them into the local rows */
+  n    = ptap->recvi[ptap->nrecvrows];
+  ierr = PetscMalloc2(n,&ptap->recvj,n,&ptap->recva);CHKERRQ(ierr);
+  ierr = PetscSFReduceBegin(ptap->sf,MPIU_INT,ptap->c_othj,ptap->recvj,MPIU_REPLACE);CHKERRQ(ierr);
+  ierr = PetscSFReduceEnd(ptap->sf,MPIU_INT,ptap->c_othj,ptap->recvj,MPIU_REPLACE);CHKERRQ(ierr);
+  if (merged) {
+    ierr = PetscSFReduceBegin(ptap->sf,MPIU_SCALAR,ptap->c_otha,ptap->recva,MPIU_REPLACE);CHKERRQ(ierr);
+    ierr = PetscSFReduceEnd(ptap->sf,MPIU_SCALAR,ptap->c_otha,ptap->recva,MPIU_REPLACE);CHKERRQ(ierr);
+  }
+  for (m=0; m<ptap->nrecvrows; m++) {
+    k = ptap->recvrows[m] - pcstart;
+    if (merged) {
+      for (e=ptap->recvi[m]; e<ptap->recvi[m+1]; e++) {ierr = PetscHMapIVAddValue(maps[k],ptap->recvj[e],ptap->recva[e]);CHKERRQ(ierr);}
+    } else {
+      ierr = PetscHSetIAddArray(sets[k],ptap->recvi[m+1]-ptap->recvi[m],ptap->recvj+ptap->recvi[m]);CHKERRQ(ierr);
+    }
+  }
+
+  /* (5) preallocate C */
+  ierr = MatCreate(comm,&Cmpi);CHKERRQ(ierr);
+  ierr = MatSetType(Cmpi,MATMPIAIJ);CHKERRQ(ierr);
+  ierr = MatSetSizes(Cmpi,pn,pn,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRQ(ierr);
+  ierr = MatSetBlockSizes(Cmpi,PetscAbs(P->cmap->bs),PetscAbs(P->cmap->bs));CHKERRQ(ierr);
+  for (k=0; k<pn; k++) {
+    if (merged) {ierr = PetscHMapIVGetSize(maps[k],&n);CHKERRQ(ierr);}
+    else        {ierr = PetscHSetIGetSize(sets[k],&n);CHKERRQ(ierr);}
+    cmax = PetscMax(cmax,n);
+  }
+  ierr = PetscMalloc2(cmax,&cols,cmax,&vals);CHKERRQ(ierr);
+  ierr = MatPreallocateInitialize(comm,pn,pn,dnz,onz);CHKERRQ(ierr);
+  for (k=0; k<pn; k++) {
+    off = 0;
+    if (merged) {ierr = PetscHMapIVGetPairs(maps[k],&off,cols,NULL);CHKERRQ(ierr);}
+    else        {ierr = PetscHSetIGetElems(sets[k],&off,cols);CHKERRQ(ierr);}
+    row  = k + pcstart;
+    ierr = MatPreallocateSet(row,off,cols,dnz,onz);CHKERRQ(ierr);
+  }
+  ierr = MatMPIAIJSetPreallocation(Cmpi,0,dnz,0,onz);CHKERRQ(ierr);
+  ierr = MatPreallocateFinalize(dnz,onz);CHKERRQ(ierr);
+  /* all values are added by the owning process */
+  ierr = MatSetOption(Cmpi,MAT_NO_OFF_PROC_ENTRIES,PETSC_TRUE);CHKERRQ(ierr);
+
+  if (merged) {
+    for (k=0; k<pn; k++) {
+      off  = 0;
+      ierr = PetscHMapIVGetPairs(maps[k],&off,cols,vals);CHKERRQ(ierr);
+      row  = k + pcstart;
+      ierr = MatSetValues(Cmpi,1,&row,off,cols,vals,INSERT_VALUES);CHKERRQ(ierr);
+      ierr = PetscHMapIVDestroy(&maps[k]);CHKERRQ(ierr);
+    }
+    ierr = MatAssemblyBegin(Cmpi,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+    ierr = MatAssemblyEnd(Cmpi,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+    ierr = PetscLogFlops(flops);CHKERRQ(ierr);
+    ierr = PetscFree(maps);CHKERRQ(ierr);
+  } else {
+    for (k=0; k<pn; k++) {ierr = PetscHSetIDestroy(&sets[k]);CHKERRQ(ierr);}
+    ierr = PetscFree(sets);CHKERRQ(ierr);
+  }
+  ierr = PetscFree2(cols,vals);CHKERRQ(ierr);
+  ierr = PetscInfo3(P,"%D rows of C sent, %D rows received, %D entries of C_oth\n",con,ptap->nrecvrows,ptap->c_othi[con]);CHKERRQ(ierr);
+
+  /* attach the supporting struct to Cmpi for reuse */
+  c = (Mat_MPIAIJ*)Cmpi->data;
+  c->ptap         = ptap;
+  ptap->duplicate = Cmpi->ops->duplicate;
+  ptap->destroy   = Cmpi->ops->destroy;
+
+  /* without merged Cmpi is not ready for use - assembly will be done by MatPtAPNumeric() */
+  if (!merged) Cmpi->assembled = PETSC_FALSE;
+  Cmpi->ops->destroy     = MatDestroy_MPIAIJ_PtAP;
+  Cmpi->ops->duplicate   = MatDuplicate_MPIAIJ_MatPtAP;
+  Cmpi->ops->ptapnumeric = MatPtAPNumeric_MPIAIJ_MPIAIJ_allatonce;
+  *C                     = Cmpi;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce(Mat A,Mat P,PetscReal fill,Mat *C)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce_Private(A,P,fill,PETSC_FALSE,C);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* for one-shot use: the values are computed together with the nonzero structure */
+PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce_merged(Mat A,Mat P,PetscReal fill,Mat *C)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce_Private(A,P,fill,PETSC_TRUE,C);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ(Mat A,Mat P,PetscReal fill,Mat *C)
 {
   PetscErrorCode      ierr;
@@ -561,11 +889,11 @@ PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ(Mat A,Mat P,PetscReal fill,Mat *C)
   PetscScalar         *apv;
   PetscTable          ta;
 #if defined(PETSC_HAVE_HYPRE)
-  const char          *algTypes[3] = {"scalable","nonscalable","hypre"};
-  PetscInt            nalg = 3;
+  const char          *algTypes[5] = {"scalable","nonscalable","allatonce","allatonce_merged","hypre"};
+  PetscInt            nalg = 5;
 #else
-  const char          *algTypes[2] = {"scalable","nonscalable"};
-  PetscInt            nalg = 2;
+  const char          *algTypes[4] = {"scalable","nonscalable","allatonce","allatonce_merged"};
+  PetscInt            nalg = 4;
 #endif
   PetscInt            alg = 1; /* set default algorithm */
 #if defined(PETSC_USE_INFO)
@@ -609,8 +937,14 @@ PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ(Mat A,Mat P,PetscReal fill,Mat *C)
     (*C)->ops->ptapnumeric = MatPtAPNumeric_MPIAIJ_MPIAIJ_scalable;
     PetscFunctionReturn(0);
 
-#if defined(PETSC_HAVE_HYPRE)
   } else if (alg == 2) {
+    ierr = MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce(A,P,fill,C);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  } else if (alg == 3) {
+    ierr = MatPtAPSymbolic_MPIAIJ_MPIAIJ_allatonce_merged(A,P,fill,C);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+#if defined(PETSC_HAVE_HYPRE)
+  } else if (alg == 4) {
     /* Use boomerAMGBuildCoarseOperator */
     ierr = MatPtAPSymbolic_AIJ_AIJ_wHYPRE(A,P,fill,C);CHKERRQ(ierr);
     PetscFunctionReturn(0);
@@ -397,6 +397,143 @@ PetscErrorCode MatSeqAIJSetValuesLocalFast(Mat A,PetscInt m,const PetscInt im[],
   return 0;
 }
 
+/*
+   With MAT_USE_HASH_TABLE the entries set before the first final assembly are accumulated in a
+   hash table keyed by (row,col) instead of being inserted into the CSR arrays, which would shift
+   the rows and reallocate the whole matrix whenever the (missing) preallocation is exceeded.
+   MatSeqAIJHashToCSR_Private() then counts the entries of each row, allocates exactly and fills
+   the CSR arrays in one pass, so assembly without preallocation costs O(nnz log(nnz/m)).
+*/
+static PetscErrorCode MatSetValues_SeqAIJ_Hash(Mat A,PetscInt m,const PetscInt im[],PetscInt n,const PetscInt in[],const PetscScalar v[],InsertMode is)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscInt       k,l;
+  PetscHMapIJKey key;
+  PetscScalar    value;
+  PetscBool      has;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  for (k=0; k<m; k++) {
+    if (im[k] < 0) continue;
+#if defined(PETSC_USE_DEBUG)
+    if (im[k] >= A->rmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Row too large: row %D max %D",im[k],A->rmap->n-1);
+#endif
+    key.i = im[k];
+    for (l=0; l<n; l++) {
+      if (in[l] < 0) continue;
+#if defined(PETSC_USE_DEBUG)
+      if (in[l] >= A->cmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Column too large: col %D max %D",in[l],A->cmap->n-1);
+#endif
+      key.j = in[l];
+      value = a->roworiented ? v[l + k*n] : v[k + l*m];
+      if ((value == 0.0 && a->ignorezeroentries) && (is == ADD_VALUES) && key.i != key.j) continue;
+      /* same rules as MatSetValues_SeqAIJ() for a new location, that is a key not yet in the table;
+         the table is never limited by an allocation, so nonew == -2 does not apply */
+      if ((value == 0.0 && a->ignorezeroentries && key.i != key.j) || a->nonew == 1 || a->nonew == -1) {
+        ierr = PetscHMapIJVHas(a->ht,key,&has);CHKERRQ(ierr);
+        if (!has) {
+          if (value == 0.0 && a->ignorezeroentries && key.i != key.j) continue;
+          if (a->nonew == 1) continue;
+          if (a->nonew == -1) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Inserting a new nonzero at (%D,%D) in the matrix",key.i,key.j);
+        }
+      }
+      if (is == ADD_VALUES) {
+        ierr = PetscHMapIJVAddValue(a->ht,key,value);CHKERRQ(ierr);
+      } else {
+        ierr = PetscHMapIJVSet(a->ht,key,value);CHKERRQ(ierr);
+      }
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatSeqAIJHashToCSR_Private(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscInt       m  = A->rmap->n,nz,i,k,row,*ai,*aj,*ailen;
+  PetscHMapIJKey *keys;
+  PetscScalar    *vals;
+  MatScalar      *aa;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscHMapIJVGetSize(a->ht,&nz);CHKERRQ(ierr);
+  ierr = PetscMalloc2(nz,&keys,nz,&vals);CHKERRQ(ierr);
+  k    = 0;
+  ierr = PetscHMapIJVGetPairs(a->ht,&k,keys,vals);CHKERRQ(ierr);
+  ierr = PetscHMapIJVDestroy(&a->ht);CHKERRQ(ierr);
+
+  /* exact preallocation */
+  if (!a->imax) {
+    ierr = PetscMalloc2(m,&a->imax,m,&a->ilen);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)A,2*m*sizeof(PetscInt));CHKERRQ(ierr);
+  }
+  ierr = MatSeqXAIJFreeAIJ(A,&a->a,&a->j,&a->i);CHKERRQ(ierr);
+  ierr = PetscMalloc3(nz,&a->a,nz,&a->j,m+1,&a->i);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)A,(m+1)*sizeof(PetscInt)+nz*(sizeof(PetscScalar)+sizeof(PetscInt)));CHKERRQ(ierr);
+  a->singlemalloc = PETSC_TRUE;
+  a->free_a       = PETSC_TRUE;
+  a->free_ij      = PETSC_TRUE;
+  ai = a->i; aj = a->j; aa = a->a; ailen = a->ilen;
+
+  ierr = PetscMemzero(a->imax,m*sizeof(PetscInt));CHKERRQ(ierr);
+  for (k=0; k<nz; k++) a->imax[keys[k].i]++;
+  ai[0] = 0;
+  for (i=0; i<m; i++) {
+    ai[i+1]  = ai[i] + a->imax[i];
+    ailen[i] = 0;
+  }
+  for (k=0; k<nz; k++) {
+    row = keys[k].i;
+    aj[ai[row] + ailen[row]]   = keys[k].j;
+    aa[ai[row] + ailen[row]++] = vals[k];
+  }
+  for (i=0; i<m; i++) {
+    ierr = PetscSortIntWithScalarArray(ailen[i],aj+ai[i],aa+ai[i]);CHKERRQ(ierr);
+  }
+  ierr = PetscFree2(keys,vals);CHKERRQ(ierr);
+
+  a->nz    = nz;
+  a->maxnz = nz;
+  A->nonzerostate++;
+  ierr = PetscInfo1(A,"Moved %D entries from the hash table into the CSR arrays\n",nz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatSeqAIJSetUseHashTable_Private(Mat A,PetscBool flg)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscInt       i,k;
+  PetscHMapIJKey key;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!flg) {
+    if (a->ht) {ierr = MatSeqAIJHashToCSR_Private(A);CHKERRQ(ierr);}
+    PetscFunctionReturn(0);
+  }
+  if (a->ht) PetscFunctionReturn(0);
+  if (A->assembled || A->was_assembled) {
+    ierr = PetscInfo(A,"Option MAT_USE_HASH_TABLE ignored, the matrix has already been assembled\n");CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = PetscHMapIJVCreate(&a->ht);CHKERRQ(ierr);
+  /* move entries already inserted into the CSR arrays */
+  if (a->ilen) {
+    for (i=0; i<A->rmap->n; i++) {
+      key.i = i;
+      for (k=0; k<a->ilen[i]; k++) {
+        key.j = a->j[a->i[i]+k];
+        ierr  = PetscHMapIJVSet(a->ht,key,a->a[a->i[i]+k]);CHKERRQ(ierr);
+      }
+      a->ilen[i] = 0;
+    }
+  }
+  a->nz = 0;
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatSetValues_SeqAIJ(Mat A,PetscInt m,const PetscInt im[],PetscInt n,const PetscInt in[],const PetscScalar v[],InsertMode is)
 {
   Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
@@ -409,6 +546,10 @@ PetscErrorCode MatSetValues_SeqAIJ(Mat A,PetscInt m,const PetscInt im[],PetscInt
   PetscBool      roworiented       = a->roworiented;
 
   PetscFunctionBegin;
+  if (a->ht) {
+    ierr = MatSetValues_SeqAIJ_Hash(A,m,im,n,in,v,is);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
   for (k=0; k<m; k++) { /* loop over added rows */
     row = im[k];
     if (row < 0) continue;
@@ -515,11 +656,9 @@ PetscErrorCode MatView_SeqAIJ_Binary(Mat A,PetscViewer viewer)
   Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
   PetscErrorCode ierr;
   PetscInt       i,*col_lens;
-  int            fd;
   FILE           *file;
 
   PetscFunctionBegin;
-  ierr = PetscViewerBinaryGetDescriptor(viewer,&fd);CHKERRQ(ierr);
   ierr = PetscMalloc1(4+A->rmap->n,&col_lens);CHKERRQ(ierr);
 
   col_lens[0] = MAT_FILE_CLASSID;
@@ -531,14 +670,14 @@ PetscErrorCode MatView_SeqAIJ_Binary(Mat A,PetscViewer viewer)
   for (i=0; i<A->rmap->n; i++) {
     col_lens[4+i] = a->i[i+1] - a->i[i];
   }
-  ierr = PetscBinaryWrite(fd,col_lens,4+A->rmap->n,PETSC_INT,PETSC_TRUE);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryWrite(viewer,col_lens,4+A->rmap->n,PETSC_INT,PETSC_TRUE);CHKERRQ(ierr);
   ierr = PetscFree(col_lens);CHKERRQ(ierr);
 
   /* store column indices (zero start index) */
-  ierr = PetscBinaryWrite(fd,a->j,a->nz,PETSC_INT,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryWrite(viewer,a->j,a->nz,PETSC_INT,PETSC_FALSE);CHKERRQ(ierr);
 
   /* store nonzero values */
-  ierr = PetscBinaryWrite(fd,a->a,a->nz,PETSC_SCALAR,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryWrite(viewer,a->a,a->nz,PETSC_SCALAR,PETSC_FALSE);CHKERRQ(ierr);
 
   ierr = PetscViewerBinaryGetInfoPointer(viewer,&file);CHKERRQ(ierr);
   if (file) {
@@ -940,6 +1079,11 @@ PetscErrorCode MatAssemblyEnd_SeqAIJ(Mat A,MatAssemblyType mode)
 
   PetscFunctionBegin;
   if (mode == MAT_FLUSH_ASSEMBLY) PetscFunctionReturn(0);
+  if (a->ht) {
+    ierr  = MatSeqAIJHashToCSR_Private(A);CHKERRQ(ierr);
+    ai    = a->i; aj = a->j; aa = a->a;
+    imax  = a->imax; ailen = a->ilen;
+  }
 
   if (m) rmax = ailen[0]; /* determine row with most nonzeros */
   for (i=1; i<m; i++) {
@@ -984,6 +1128,30 @@ PetscErrorCode MatAssemblyEnd_SeqAIJ(Mat A,MatAssemblyType mode)
   ierr = MatCheckCompressedRow(A,a->nonzerorowcnt,&a->compressedrow,a->i,m,ratio);CHKERRQ(ierr);
   ierr = MatAssemblyEnd_SeqAIJ_Inode(A,mode);CHKERRQ(ierr);
   ierr = MatSeqAIJInvalidateDiagonal(A);CHKERRQ(ierr);
+  if (a->detectbs && PetscAbs(A->rmap->bs) == 1 && PetscAbs(A->cmap->bs) == 1) {
+    ierr = MatSeqAIJDetectBlockSize(A);CHKERRQ(ierr);
+    if (a->detectbsconvert && A->rmap->bs > 1) {
+      PetscBool isseqaij;
+
+      /* subclasses keep their own storage; after this A is no longer a MATSEQAIJ so a may not be used */
+      ierr = PetscObjectTypeCompare((PetscObject)A,MATSEQAIJ,&isseqaij);CHKERRQ(ierr);
+      if (isseqaij) {ierr = MatConvert_SeqAIJ_SeqBAIJ(A,MATSEQBAIJ,MAT_INPLACE_MATRIX,&A);CHKERRQ(ierr);}
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatSetFromOptions_SeqAIJ(PetscOptionItems *PetscOptionsObject,Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsHead(PetscOptionsObject,"SeqAIJ options");CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-mat_detect_block_size","Look for dense blocks in the nonzero structure on the final assembly","None",a->detectbs,&a->detectbs,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-mat_detect_block_size_convert","Switch to MATSEQBAIJ if dense blocks are found","None",a->detectbsconvert,&a->detectbsconvert,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  if (a->detectbsconvert) a->detectbs = PETSC_TRUE;
   PetscFunctionReturn(0);
 }
 
@@ -1019,6 +1187,11 @@ PetscErrorCode MatZeroEntries_SeqAIJ(Mat A)
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
+  if (a->ht) { /* keep the entries, they define the nonzero pattern */
+    PetscInt i;
+    for (i=0; i<a->ht->nbuckets; i++) a->ht->vals[i] = 0.0;
+    PetscFunctionReturn(0);
+  }
   ierr = PetscMemzero(a->a,(a->i[A->rmap->n])*sizeof(PetscScalar));CHKERRQ(ierr);
   ierr = MatSeqAIJInvalidateDiagonal(A);CHKERRQ(ierr);
   PetscFunctionReturn(0);
@@ -1034,6 +1207,7 @@ PetscErrorCode MatDestroy_SeqAIJ(Mat A)
   PetscLogObjectState((PetscObject)A,"Rows=%D, Cols=%D, NZ=%D",A->rmap->n,A->cmap->n,a->nz);
 #endif
   ierr = MatSeqXAIJFreeAIJ(A,&a->a,&a->j,&a->i);CHKERRQ(ierr);
+  ierr = PetscHMapIJVDestroy(&a->ht);CHKERRQ(ierr);
   ierr = ISDestroy(&a->row);CHKERRQ(ierr);
   ierr = ISDestroy(&a->col);CHKERRQ(ierr);
   ierr = PetscFree(a->diag);CHKERRQ(ierr);
@@ -1046,6 +1220,12 @@ PetscErrorCode MatDestroy_SeqAIJ(Mat A)
   ierr = ISColoringDestroy(&a->coloring);CHKERRQ(ierr);
   ierr = PetscFree2(a->compressedrow.i,a->compressedrow.rindex);CHKERRQ(ierr);
   ierr = PetscFree(a->matmult_abdense);CHKERRQ(ierr);
+  if (a->abhash) {
+    ierr = PetscFree2(a->abhash->keys,a->abhash->pos);CHKERRQ(ierr);
+    ierr = PetscFree(a->abhash->dense);CHKERRQ(ierr);
+    ierr = PetscFree(a->abhash);CHKERRQ(ierr);
+  }
+  ierr = MatSeqAIJFactorDestroySolveLevels(&a->solvelevels);CHKERRQ(ierr);
 
   ierr = MatDestroy_SeqAIJ_Inode(A);CHKERRQ(ierr);
   ierr = PetscFree(A->data);CHKERRQ(ierr);
@@ -1057,6 +1237,14 @@ PetscErrorCode MatDestroy_SeqAIJ(Mat A)
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_seqsbaij_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_seqbaij_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_seqaijperm_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_seqaijsell_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_seqaijdelta_C",NULL);CHKERRQ(ierr);
+#if defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX)
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_seqaijmixed_C",NULL);CHKERRQ(ierr);
+#endif
+#if defined(PETSC_HAVE_OPENMP)
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_seqaijomp_C",NULL);CHKERRQ(ierr);
+#endif
 #if defined(PETSC_HAVE_ELEMENTAL)
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_elemental_C",NULL);CHKERRQ(ierr);
 #endif
@@ -1109,9 +1297,11 @@ PetscErrorCode MatSetOption_SeqAIJ(Mat A,MatOption op,PetscBool flg)
     break;
   case MAT_NEW_DIAGONALS:
   case MAT_IGNORE_OFF_PROC_ENTRIES:
-  case MAT_USE_HASH_TABLE:
     ierr = PetscInfo1(A,"Option %s ignored\n",MatOptions[op]);CHKERRQ(ierr);
     break;
+  case MAT_USE_HASH_TABLE:
+    ierr = MatSeqAIJSetUseHashTable_Private(A,flg);CHKERRQ(ierr);
+    break;
   case MAT_USE_INODES:
     /* Not an error because MatSetOption_SeqAIJ_Inode handles this one */
     break;
@@ -1248,6 +1438,10 @@ PetscErrorCode MatMult_SeqAIJ(Mat A,Vec xx,Vec yy)
     m    = a->compressedrow.nrows;
     ii   = a->compressedrow.i;
     ridx = a->compressedrow.rindex;
+#if defined(PETSC_USE_AVX512_KERNELS)
+    if (MatSeqAIJUseAVX512) MatMult_SeqAIJ_AVX512(m,ii,ridx,a->j,a->a,x,NULL,y);
+    else
+#endif
     for (i=0; i<m; i++) {
       n           = ii[i+1] - ii[i];
       aj          = a->j + ii[i];
@@ -1258,6 +1452,11 @@ PetscErrorCode MatMult_SeqAIJ(Mat A,Vec xx,Vec yy)
       y[*ridx++] = sum;
     }
   } else { /* do not use compressed row format */
+#if defined(PETSC_USE_AVX512_KERNELS)
+    if (MatSeqAIJUseAVX512) MatMult_SeqAIJ_AVX512(m,ii,NULL,a->j,a->a,x,NULL,y);
+    else
+#endif
+    {
 #if defined(PETSC_USE_FORTRAN_KERNEL_MULTAIJ)
     aj   = a->j;
     aa   = a->a;
@@ -1272,6 +1471,7 @@ PetscErrorCode MatMult_SeqAIJ(Mat A,Vec xx,Vec yy)
       y[i] = sum;
     }
 #endif
+    }
   }
   ierr = PetscLogFlops(2.0*a->nz - a->nonzerorowcnt);CHKERRQ(ierr);
   ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
@@ -1401,6 +1601,10 @@ PetscErrorCode MatMultAdd_SeqAIJ(Mat A,Vec xx,Vec yy,Vec zz)
     m    = a->compressedrow.nrows;
     ii   = a->compressedrow.i;
     ridx = a->compressedrow.rindex;
+#if defined(PETSC_USE_AVX512_KERNELS)
+    if (MatSeqAIJUseAVX512) MatMult_SeqAIJ_AVX512(m,ii,ridx,a->j,a->a,x,y,z);
+    else
+#endif
     for (i=0; i<m; i++) {
       n   = ii[i+1] - ii[i];
       aj  = a->j + ii[i];
@@ -1411,6 +1615,11 @@ PetscErrorCode MatMultAdd_SeqAIJ(Mat A,Vec xx,Vec yy,Vec zz)
     }
   } else { /* do not use compressed row format */
     ii = a->i;
+#if defined(PETSC_USE_AVX512_KERNELS)
+    if (MatSeqAIJUseAVX512) MatMult_SeqAIJ_AVX512(m,ii,NULL,a->j,a->a,x,y,z);
+    else
+#endif
+    {
 #if defined(PETSC_USE_FORTRAN_KERNEL_MULTADDAIJ)
     aj = a->j;
     aa = a->a;
@@ -1425,6 +1634,7 @@ PetscErrorCode MatMultAdd_SeqAIJ(Mat A,Vec xx,Vec yy,Vec zz)
       z[i] = sum;
     }
 #endif
+    }
   }
   ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
   ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
@@ -1496,7 +1706,7 @@ PetscErrorCode MatMissingDiagonal_SeqAIJ(Mat A,PetscBool  *missing,PetscInt *d)
 /*
    Negative shift indicates do not generate an error if there is a zero diagonal, just invert it anyways
 */
-PetscErrorCode  MatInvertDiagonal_SeqAIJ(Mat A,PetscScalar omega,PetscScalar fshift)
+PetscErrorCode MatInvertDiagonal_SeqAIJ(Mat A,PetscScalar omega,PetscScalar fshift)
 {
   Mat_SeqAIJ     *a = (Mat_SeqAIJ*) A->data;
   PetscErrorCode ierr;
@@ -2433,10 +2643,22 @@ PetscErrorCode MatDestroySubMatrices_Private(Mat_SubSppt *submatj)
     }
     ierr = PetscFree3(submatj->req_source2,submatj->rbuf2,submatj->rbuf3);CHKERRQ(ierr);
     ierr = PetscFree(submatj->pa);CHKERRQ(ierr);
+
+    if (submatj->v_waits) {
+      for (i=0; i<submatj->nrqs+submatj->nrqr; ++i) {
+        ierr = MPI_Request_free(submatj->v_waits+i);CHKERRQ(ierr);
+      }
+      ierr = PetscFree(submatj->v_waits);CHKERRQ(ierr);
+      ierr = PetscFree(submatj->rbuf4[0]);CHKERRQ(ierr);
+      ierr = PetscFree(submatj->sbuf_aa[0]);CHKERRQ(ierr);
+      ierr = PetscFree2(submatj->rbuf4,submatj->sbuf_aa);CHKERRQ(ierr);
+      ierr = PetscFree(submatj->rbuf4_dest);CHKERRQ(ierr);
+    }
   }
+  ierr = PetscFree(submatj->loc_dest);CHKERRQ(ierr);
 
 #if defined(PETSC_USE_CTABLE)
-  ierr = PetscTableDestroy((PetscTable*)&submatj->rmap);CHKERRQ(ierr);
+  ierr = PetscHMapIDestroy(&submatj->rmap);CHKERRQ(ierr);
   if (submatj->cmap_loc) {ierr = PetscFree(submatj->cmap_loc);CHKERRQ(ierr);}
   ierr = PetscFree(submatj->rmap_loc);CHKERRQ(ierr);
 #else
@@ -2445,7 +2667,7 @@ PetscErrorCode MatDestroySubMatrices_Private(Mat_SubSppt *submatj)
 
   if (!submatj->allcolumns) {
 #if defined(PETSC_USE_CTABLE)
-    ierr = PetscTableDestroy((PetscTable*)&submatj->cmap);CHKERRQ(ierr);
+    ierr = PetscHMapIDestroy(&submatj->cmap);CHKERRQ(ierr);
 #else
     ierr = PetscFree(submatj->cmap);CHKERRQ(ierr);
 #endif
@@ -3113,7 +3335,7 @@ static struct _MatOps MatOps_Values = { MatSetValues_SeqAIJ,
                                         0,
                                 /* 74*/ 0,
                                         MatFDColoringApply_AIJ,
-                                        0,
+                                        MatSetFromOptions_SeqAIJ,
                                         0,
                                         0,
                                 /* 79*/ MatFindZeroDiagonals_SeqAIJ,
@@ -3355,6 +3577,7 @@ PetscErrorCode  MatRetrieveValues(Mat mat)
   if (!mat->assembled) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Not for unassembled matrix");
   if (mat->factortype) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Not for factored matrix");
   ierr = PetscUseMethod(mat,"MatRetrieveValues_C",(Mat),(mat));CHKERRQ(ierr);
+  ierr = PetscObjectStateIncrease((PetscObject)mat);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -3404,7 +3627,8 @@ PetscErrorCode  MatRetrieveValues(Mat mat)
 
    Options Database Keys:
 +  -mat_no_inode  - Do not use inodes
--  -mat_inode_limit <limit> - Sets inode limit (max limit=5)
+.  -mat_inode_limit <limit> - Sets inode limit (max limit=5)
+-  -mat_no_avx512 - Do not use the AVX-512 matrix-vector product kernels even if the processor supports them
 
    Level: intermediate
 
@@ -3466,6 +3690,7 @@ PetscErrorCode  MatCreateSeqAIJ(MPI_Comm comm,PetscInt m,PetscInt n,PetscInt nz,
    Options Database Keys:
 +  -mat_no_inode  - Do not use inodes
 .  -mat_inode_limit <limit> - Sets inode limit (max limit=5)
+.  -mat_no_avx512 - Do not use the AVX-512 matrix-vector product kernels even if the processor supports them
 -  -mat_aij_oneindex - Internally use indexing starting at 1
         rather than 0.  Note that when calling MatSetValues(),
         the user still MUST index entries starting at 0!
@@ -3726,7 +3951,9 @@ PETSC_INTERN PetscErrorCode MatMatMult_SeqDense_SeqAIJ(Mat A,Mat B,MatReuse scal
    based on compressed sparse row format.
 
    Options Database Keys:
-. -mat_type seqaij - sets the matrix type to "seqaij" during a call to MatSetFromOptions()
++ -mat_type seqaij - sets the matrix type to "seqaij" during a call to MatSetFromOptions()
+. -mat_detect_block_size - on the final assembly look for dense blocks in the nonzero structure and use their size as the block size of the matrix
+- -mat_detect_block_size_convert - if such blocks are found also switch the storage to MATSEQBAIJ
 
   Level: beginner
 
@@ -3745,7 +3972,7 @@ M*/
    Options Database Keys:
 . -mat_type aij - sets the matrix type to "aij" during a call to MatSetFromOptions()
 
-  Developer Notes: Subclasses include MATAIJCUSP, MATAIJPERM, MATAIJCRL, and also automatically switches over to use inodes when
+  Developer Notes: Subclasses include MATAIJCUSP, MATAIJPERM, MATAIJSELL, MATAIJDELTA, MATAIJMIXED, MATAIJCRL, and also automatically switches over to use inodes when
    enough exist.
 
   Level: beginner
@@ -3843,6 +4070,8 @@ PetscErrorCode  MatSeqAIJGetMaxRowNonzeros(Mat A,PetscInt *nz)
 .  mat - a MATSEQAIJ matrix
 .  array - pointer to the data
 
+   Notes: The values may have been changed through the array, so the state of the matrix is increased
+
    Level: intermediate
 
 .seealso: MatSeqAIJGetArray(), MatSeqAIJRestoreArrayF90()
@@ -3853,6 +4082,7 @@ PetscErrorCode  MatSeqAIJRestoreArray(Mat A,PetscScalar **array)
 
   PetscFunctionBegin;
   ierr = PetscUseMethod(A,"MatSeqAIJRestoreArray_C",(Mat,PetscScalar**),(A,array));CHKERRQ(ierr);
+  ierr = PetscObjectStateIncrease((PetscObject)A);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -3866,6 +4096,9 @@ PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJ(Mat B)
   ierr = MPI_Comm_size(PetscObjectComm((PetscObject)B),&size);CHKERRQ(ierr);
   if (size > 1) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Comm must be of size 1");
 
+#if defined(PETSC_USE_AVX512_KERNELS)
+  ierr = MatSeqAIJInitializeAVX512_Private();CHKERRQ(ierr);
+#endif
   ierr = PetscNewLog(B,&b);CHKERRQ(ierr);
 
   B->data = (void*)b;
@@ -3908,6 +4141,14 @@ PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJ(Mat B)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqbaij_C",MatConvert_SeqAIJ_SeqBAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqaijperm_C",MatConvert_SeqAIJ_SeqAIJPERM);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqaijcrl_C",MatConvert_SeqAIJ_SeqAIJCRL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqaijsell_C",MatConvert_SeqAIJ_SeqAIJSELL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqaijdelta_C",MatConvert_SeqAIJ_SeqAIJDelta);CHKERRQ(ierr);
+#if defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX)
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqaijmixed_C",MatConvert_SeqAIJ_SeqAIJMixed);CHKERRQ(ierr);
+#endif
+#if defined(PETSC_HAVE_OPENMP)
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqaijomp_C",MatConvert_SeqAIJ_SeqAIJOMP);CHKERRQ(ierr);
+#endif
 #if defined(PETSC_HAVE_ELEMENTAL)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_elemental_C",MatConvert_SeqAIJ_Elemental);CHKERRQ(ierr);
 #endif
@@ -4036,14 +4277,86 @@ PetscErrorCode MatDuplicate_SeqAIJ(Mat A,MatDuplicateOption cpvalues,Mat *B)
   PetscFunctionReturn(0);
 }
 
+static PetscErrorCode MatLoad_SeqAIJ_FreeRowOffsets(void *ptr)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree(ptr);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   Points the column indices and values of a matrix that has not been preallocated into mappings of the file,
+   see PetscViewerBinaryReadMapped(). The mappings and the row offsets, which are not stored in the file, are
+   composed with the matrix and released when it is destroyed.
+*/
+static PetscErrorCode MatLoad_SeqAIJ_Mapped(Mat A,PetscViewer viewer,PetscInt nz,const PetscInt rowlengths[],PetscBool *mapped)
+{
+  Mat_SeqAIJ     *a;
+  PetscContainer jmap,amap,imap;
+  void           *j,*v;
+  PetscInt       i,m;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  *mapped = PETSC_FALSE;
+  if (A->preallocated) PetscFunctionReturn(0);
+  ierr = PetscViewerBinaryReadMapped(viewer,nz,PETSC_INT,&j,&jmap);CHKERRQ(ierr);
+  if (!j) PetscFunctionReturn(0);
+
+  ierr = MatSeqAIJSetPreallocation_SeqAIJ(A,MAT_SKIP_ALLOCATION,NULL);CHKERRQ(ierr);
+  a    = (Mat_SeqAIJ*)A->data;
+  m    = A->rmap->n;
+  if (!a->imax) {
+    ierr = PetscMalloc2(m,&a->imax,m,&a->ilen);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)A,2*m*sizeof(PetscInt));CHKERRQ(ierr);
+  }
+  ierr    = PetscMalloc1(m+1,&a->i);CHKERRQ(ierr);
+  a->i[0] = 0;
+  for (i=0; i<m; i++) {
+    a->imax[i] = a->ilen[i] = rowlengths[i];
+    a->i[i+1]  = a->i[i] + rowlengths[i];
+  }
+  a->j = (PetscInt*)j;
+
+  /* the values may not be aligned in the file, then they are read as usual */
+  ierr = PetscViewerBinaryReadMapped(viewer,nz,PETSC_SCALAR,&v,&amap);CHKERRQ(ierr);
+  if (v) {
+    a->a      = (MatScalar*)v;
+    a->free_a = PETSC_FALSE;
+    ierr      = PetscObjectCompose((PetscObject)A,"MatLoad_SeqAIJ_amap",(PetscObject)amap);CHKERRQ(ierr);
+    ierr      = PetscContainerDestroy(&amap);CHKERRQ(ierr);
+  } else {
+    ierr      = PetscMalloc1(nz,&a->a);CHKERRQ(ierr);
+    ierr      = PetscViewerBinaryRead(viewer,a->a,nz,NULL,PETSC_SCALAR);CHKERRQ(ierr);
+    a->free_a = PETSC_TRUE;
+  }
+  a->singlemalloc = PETSC_FALSE;
+  a->free_ij      = PETSC_FALSE;
+  a->maxnz        = nz;
+
+  ierr = PetscObjectCompose((PetscObject)A,"MatLoad_SeqAIJ_jmap",(PetscObject)jmap);CHKERRQ(ierr);
+  ierr = PetscContainerDestroy(&jmap);CHKERRQ(ierr);
+  ierr = PetscContainerCreate(PETSC_COMM_SELF,&imap);CHKERRQ(ierr);
+  ierr = PetscContainerSetPointer(imap,a->i);CHKERRQ(ierr);
+  ierr = PetscContainerSetUserDestroy(imap,MatLoad_SeqAIJ_FreeRowOffsets);CHKERRQ(ierr);
+  ierr = PetscObjectCompose((PetscObject)A,"MatLoad_SeqAIJ_imap",(PetscObject)imap);CHKERRQ(ierr);
+  ierr = PetscContainerDestroy(&imap);CHKERRQ(ierr);
+
+  ierr    = MatSetOption(A,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_TRUE);CHKERRQ(ierr);
+  *mapped = PETSC_TRUE;
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatLoad_SeqAIJ(Mat newMat, PetscViewer viewer)
 {
   Mat_SeqAIJ     *a;
   PetscErrorCode ierr;
   PetscInt       i,sum,nz,header[4],*rowlengths = 0,M,N,rows,cols;
-  int            fd;
   PetscMPIInt    size;
   MPI_Comm       comm;
+  PetscBool      mapped;
   PetscInt       bs = newMat->rmap->bs;
 
   PetscFunctionBegin;
@@ -4059,8 +4372,7 @@ PetscErrorCode MatLoad_SeqAIJ(Mat newMat, PetscViewer viewer)
   if (bs < 0) bs = 1;
   ierr = MatSetBlockSize(newMat,bs);CHKERRQ(ierr);
 
-  ierr = PetscViewerBinaryGetDescriptor(viewer,&fd);CHKERRQ(ierr);
-  ierr = PetscBinaryRead(fd,header,4,PETSC_INT);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryRead(viewer,header,4,NULL,PETSC_INT);CHKERRQ(ierr);
   if (header[0] != MAT_FILE_CLASSID) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"not matrix object in file");
   M = header[1]; N = header[2]; nz = header[3];
 
@@ -4068,7 +4380,7 @@ PetscErrorCode MatLoad_SeqAIJ(Mat newMat, PetscViewer viewer)
 
   /* read in row lengths */
   ierr = PetscMalloc1(M,&rowlengths);CHKERRQ(ierr);
-  ierr = PetscBinaryRead(fd,rowlengths,M,PETSC_INT);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryRead(viewer,rowlengths,M,NULL,PETSC_INT);CHKERRQ(ierr);
 
   /* check if sum of rowlengths is same as nz */
   for (i=0,sum=0; i< M; i++) sum +=rowlengths[i];
@@ -4085,19 +4397,22 @@ PetscErrorCode MatLoad_SeqAIJ(Mat newMat, PetscViewer viewer)
     }
     if (M != rows ||  N != cols) SETERRQ4(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED, "Matrix in file of different length (%D, %D) than the input matrix (%D, %D)",M,N,rows,cols);
   }
-  ierr = MatSeqAIJSetPreallocation_SeqAIJ(newMat,0,rowlengths);CHKERRQ(ierr);
-  a    = (Mat_SeqAIJ*)newMat->data;
+  ierr = MatLoad_SeqAIJ_Mapped(newMat,viewer,nz,rowlengths,&mapped);CHKERRQ(ierr);
+  if (!mapped) {
+    ierr = MatSeqAIJSetPreallocation_SeqAIJ(newMat,0,rowlengths);CHKERRQ(ierr);
+    a    = (Mat_SeqAIJ*)newMat->data;
 
-  ierr = PetscBinaryRead(fd,a->j,nz,PETSC_INT);CHKERRQ(ierr);
+    ierr = PetscViewerBinaryRead(viewer,a->j,nz,NULL,PETSC_INT);CHKERRQ(ierr);
 
-  /* read in nonzero values */
-  ierr = PetscBinaryRead(fd,a->a,nz,PETSC_SCALAR);CHKERRQ(ierr);
+    /* read in nonzero values */
+    ierr = PetscViewerBinaryRead(viewer,a->a,nz,NULL,PETSC_SCALAR);CHKERRQ(ierr);
 
-  /* set matrix "i" values */
-  a->i[0] = 0;
-  for (i=1; i<= M; i++) {
-    a->i[i]      = a->i[i-1] + rowlengths[i-1];
-    a->ilen[i-1] = rowlengths[i-1];
+    /* set matrix "i" values */
+    a->i[0] = 0;
+    for (i=1; i<= M; i++) {
+      a->i[i]      = a->i[i-1] + rowlengths[i-1];
+      a->ilen[i-1] = rowlengths[i-1];
+    }
   }
   ierr = PetscFree(rowlengths);CHKERRQ(ierr);
 
@@ -4,6 +4,7 @@
 
 #include <petsc/private/matimpl.h>
 #include <petscctable.h>
+#include <petsc/private/hashmapijv.h>
 
 /*
     Struct header shared by SeqAIJ, SeqBAIJ and SeqSBAIJ matrix formats
@@ -47,7 +48,7 @@ typedef struct {
   PetscErrorCode (*destroy)(Mat);
 } Mat_MatMatTransMult;
 
-typedef struct { /* for MatTransposeMatMult_SeqAIJ_SeqDense() */
+typedef struct { /* for MatTransposeMatMult_MPIAIJ_MPIDense() */
   Mat          mA;           /* maij matrix of A */
   Vec          bt,ct;        /* vectors to hold locally transposed arrays of B and C */
   PetscErrorCode (*destroy)(Mat);
@@ -105,6 +106,22 @@ PETSC_INTERN PetscErrorCode MatDuplicateNoCreate_SeqAIJ(Mat,Mat,MatDuplicateOpti
 PETSC_INTERN PetscErrorCode MatLUFactorNumeric_SeqAIJ_Inode_inplace(Mat,Mat,const MatFactorInfo*);
 PETSC_INTERN PetscErrorCode MatLUFactorNumeric_SeqAIJ_Inode(Mat,Mat,const MatFactorInfo*);
 
+/* level schedule of the triangular solves with a factored matrix, see aijlevels.c */
+typedef struct {
+  PetscInt    nlevels[2];           /* number of levels of the forward [0] and backward [1] solves */
+  PetscInt    *levelptr[2];         /* rows of level l are levelrows[][levelptr[][l]] to levelrows[][levelptr[][l+1]-1] */
+  PetscInt    *levelrows[2];
+  PetscInt    *ti,*tk,*tp;          /* ICC only: column j of U has its entries in rows tk[] at positions tp[] of a, ti[j] to ti[j+1]-1 */
+  PetscScalar *work;                /* ICC only: the forward solve before scaling by the diagonal */
+} Mat_SeqAIJSolveLevels;
+
+typedef struct { /* work space of the hash MatMatMult(), sized by its symbolic phase */
+  PetscInt    densethreshold;       /* rows of C = A*B with this many products use the dense accumulator */
+  PetscInt    nthreads,size;        /* number of threads, size of the hash table of each thread */
+  PetscInt    *keys,*pos;           /* hash tables of the threads; the keys are all negative between rows */
+  PetscScalar *dense;               /* dense accumulators of the threads, if some row uses them */
+} Mat_MatMatMultHash;
+
 typedef struct {
   SEQAIJHEADER(MatScalar);
   Mat_SeqAIJ_Inode inode;
@@ -119,12 +136,24 @@ typedef struct {
   ISColoring  coloring;                       /* set with MatADSetColoring() used by MatADSetValues() */
 
   PetscScalar         *matmult_abdense;    /* used by MatMatMult() */
+  Mat_MatMatMultHash  *abhash;             /* used by the hash MatMatMult() */
   Mat_PtAP            *ptap;               /* used by MatPtAP() */
   Mat_MatMatMatMult   *matmatmatmult;      /* used by MatMatMatMult() */
   Mat_RARt            *rart;               /* used by MatRARt() */
   Mat_MatMatTransMult *abt;                /* used by MatMatTransposeMult() */
+
+  PetscHMapIJV        ht;                  /* entries set before the first final assembly with MAT_USE_HASH_TABLE */
+
+  PetscBool           detectbs;            /* look for a block size on the final assembly, -mat_detect_block_size */
+  PetscBool           detectbsconvert;     /* switch to MATSEQBAIJ if one is found, -mat_detect_block_size_convert */
+  PetscInt            detectedbs;          /* block size found, 0 if not looked for */
+
+  Mat_SeqAIJSolveLevels *solvelevels;      /* level schedule of MatSolve() on a factor, -mat_solve_levels */
 } Mat_SeqAIJ;
 
+/* largest block size looked for by MatSeqAIJDetectBlockSize() */
+#define MAT_DETECT_BLOCK_SIZE_MAX 16
+
 /*
   Frees the a, i, and j arrays from the XAIJ (AIJ, BAIJ, and SBAIJ) matrix types
 */
@@ -190,6 +219,8 @@ PETSC_INTERN PetscErrorCode MatCholeskyFactorSymbolic_SeqAIJ_inplace(Mat,Mat,IS,
 PETSC_INTERN PetscErrorCode MatCholeskyFactorSymbolic_SeqAIJ(Mat,Mat,IS,const MatFactorInfo*);
 PETSC_INTERN PetscErrorCode MatCholeskyFactorNumeric_SeqAIJ_inplace(Mat,Mat,const MatFactorInfo*);
 PETSC_INTERN PetscErrorCode MatCholeskyFactorNumeric_SeqAIJ(Mat,Mat,const MatFactorInfo*);
+PETSC_INTERN PetscErrorCode MatSeqAIJFactorSetUpSolveLevels(Mat,PetscBool);
+PETSC_INTERN PetscErrorCode MatSeqAIJFactorDestroySolveLevels(Mat_SeqAIJSolveLevels**);
 PETSC_INTERN PetscErrorCode MatDuplicate_SeqAIJ(Mat,MatDuplicateOption,Mat*);
 PETSC_INTERN PetscErrorCode MatCopy_SeqAIJ(Mat,Mat,MatStructure);
 PETSC_INTERN PetscErrorCode MatMissingDiagonal_SeqAIJ(Mat,PetscBool*,PetscInt*);
@@ -201,6 +232,16 @@ PETSC_INTERN PetscErrorCode MatMultAdd_SeqAIJ(Mat A,Vec,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatMultTranspose_SeqAIJ(Mat A,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatMultTransposeAdd_SeqAIJ(Mat A,Vec,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatSOR_SeqAIJ(Mat,Vec,PetscReal,MatSORType,PetscReal,PetscInt,PetscInt,Vec);
+PETSC_INTERN PetscErrorCode MatInvertDiagonal_SeqAIJ(Mat,PetscScalar,PetscScalar);
+
+/* hand vectorized products, see aijavx512.c */
+#if defined(PETSC_HAVE_ATTRIBUTE_TARGET_AVX512) && defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_REAL_MAT_SINGLE)
+#define PETSC_USE_AVX512_KERNELS
+PETSC_INTERN PetscBool      MatSeqAIJUseAVX512;
+PETSC_INTERN PetscErrorCode MatSeqAIJInitializeAVX512_Private(void);
+PETSC_INTERN void           MatMult_SeqAIJ_AVX512(PetscInt,const PetscInt*,const PetscInt*,const PetscInt*,const MatScalar*,const PetscScalar*,const PetscScalar*,PetscScalar*);
+PETSC_INTERN void           MatMult_SeqAIJ_Inode_AVX512(PetscInt,const PetscInt*,const PetscInt*,const PetscInt*,const MatScalar*,const PetscScalar*,const PetscScalar*,PetscScalar*);
+#endif
 
 PETSC_INTERN PetscErrorCode MatSetOption_SeqAIJ(Mat,MatOption,PetscBool);
 
@@ -297,17 +338,26 @@ PETSC_INTERN PetscErrorCode MatSeqAIJInvalidateDiagonal(Mat);
 PETSC_INTERN PetscErrorCode MatSeqAIJInvalidateDiagonal_Inode(Mat);
 PETSC_INTERN PetscErrorCode MatSeqAIJCheckInode(Mat);
 PETSC_INTERN PetscErrorCode MatSeqAIJCheckInode_FactorLU(Mat);
+PETSC_INTERN PetscErrorCode MatSeqAIJCheckBlocks_Private(Mat,const PetscInt[],PetscInt*);
+PETSC_INTERN PetscErrorCode MatSeqAIJDetectBlockSize(Mat);
 
 PETSC_INTERN PetscErrorCode MatAXPYGetPreallocation_SeqAIJ(Mat,Mat,PetscInt*);
 
 PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqSBAIJ(Mat,MatType,MatReuse,Mat*);
 PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqBAIJ(Mat,MatType,MatReuse,Mat*);
 PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJPERM(Mat,MatType,MatReuse,Mat*);
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJSELL(Mat,MatType,MatReuse,Mat*);
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJDelta(Mat,MatType,MatReuse,Mat*);
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJMixed(Mat,MatType,MatReuse,Mat*);
+#if defined(PETSC_HAVE_OPENMP)
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJOMP(Mat,MatType,MatReuse,Mat*);
+#endif
 PETSC_INTERN PetscErrorCode MatReorderForNonzeroDiagonal_SeqAIJ(Mat,PetscReal,IS,IS);
 PETSC_INTERN PetscErrorCode MatMatMult_SeqDense_SeqAIJ(Mat,Mat,MatReuse,PetscReal,Mat*);
 PETSC_INTERN PetscErrorCode MatRARt_SeqAIJ_SeqAIJ(Mat,Mat,MatReuse,PetscReal,Mat*);
 PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJ(Mat);
 PETSC_INTERN PetscErrorCode MatAssemblyEnd_SeqAIJ(Mat,MatAssemblyType);
+PETSC_INTERN PetscErrorCode MatSetFromOptions_SeqAIJ(PetscOptionItems*,Mat);
 
 PETSC_INTERN PetscErrorCode MatAXPYGetPreallocation_SeqX_private(PetscInt,const PetscInt*,const PetscInt*,const PetscInt*,const PetscInt*,PetscInt*);
 PETSC_INTERN PetscErrorCode MatCreateMPIMatConcatenateSeqMat_SeqAIJ(MPI_Comm,Mat,PetscInt,MatReuse,Mat*);
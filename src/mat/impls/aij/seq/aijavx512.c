@@ -0,0 +1,127 @@
+
+/*
+   Hand vectorized AVX-512 kernels for the sparse matrix-vector products of SeqAIJ matrices.
+
+   The code is compiled for AVX-512 one function at a time with __attribute((target)), so the rest of
+   the library does not require such a processor; the first MatCreate_SeqAIJ() checks the processor at run
+   time and the products only call these kernels when it is supported.  Each row is processed eight
+   entries at a time: the column indices are loaded, the entries of x gathered and multiplied with the
+   values; the remainder of the row is handled with masked loads and gathers instead of a scalar loop.
+*/
+#include <../src/mat/impls/aij/seq/aij.h>
+
+#if defined(PETSC_USE_AVX512_KERNELS)
+#include <immintrin.h>
+
+PetscBool        MatSeqAIJUseAVX512 = PETSC_FALSE;
+static PetscBool MatSeqAIJAVX512Initialized = PETSC_FALSE;
+
+#if defined(PETSC_USE_64BIT_INDICES)
+#define AVX512Gather(x,idx)           _mm512_i64gather_pd(_mm512_loadu_si512(idx),x,8)
+#define AVX512MaskGather(mask,x,idx)  _mm512_mask_i64gather_pd(_mm512_setzero_pd(),mask,_mm512_maskz_loadu_epi64(mask,idx),x,8)
+#else
+#define AVX512Gather(x,idx)           _mm512_i32gather_pd(_mm256_loadu_si256((const __m256i*)(idx)),x,8)
+#define AVX512MaskGather(mask,x,idx)  _mm512_mask_i32gather_pd(_mm512_setzero_pd(),mask,_mm512_castsi512_si256(_mm512_maskz_loadu_epi32((__mmask16)(mask),idx)),x,8)
+#endif
+
+/* number of rows of an inode that share the gathered entries of x */
+#define AVX512_NODE_MAX 5
+
+__attribute((target("avx512f")))
+PETSC_STATIC_INLINE PetscScalar MatSeqAIJRowDot_AVX512(const PetscScalar *x,const MatScalar *v,const PetscInt *idx,PetscInt n)
+{
+  __m512d  sum0 = _mm512_setzero_pd(),sum1 = _mm512_setzero_pd();
+  __mmask8 mask;
+  PetscInt j;
+
+  for (j=0; j+16<=n; j+=16) {
+    sum0 = _mm512_fmadd_pd(_mm512_loadu_pd(v+j),AVX512Gather(x,idx+j),sum0);
+    sum1 = _mm512_fmadd_pd(_mm512_loadu_pd(v+j+8),AVX512Gather(x,idx+j+8),sum1);
+  }
+  if (j+8 <= n) {
+    sum0 = _mm512_fmadd_pd(_mm512_loadu_pd(v+j),AVX512Gather(x,idx+j),sum0);
+    j   += 8;
+  }
+  if (j < n) {
+    mask = (__mmask8)(0xff >> (8-(n-j)));
+    sum1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask,v+j),AVX512MaskGather(mask,x,idx+j),sum1);
+  }
+  return _mm512_reduce_add_pd(_mm512_add_pd(sum0,sum1));
+}
+
+/*
+   z[r] = y[r] + A(r,:) x, with y = NULL meaning zero, for the m rows starting at ii[]; ridx[] gives
+   the row numbers for the compressed row format, otherwise the rows are 0,..,m-1
+*/
+__attribute((target("avx512f")))
+void MatMult_SeqAIJ_AVX512(PetscInt m,const PetscInt *ii,const PetscInt *ridx,const PetscInt *aj,const MatScalar *aa,const PetscScalar *x,const PetscScalar *y,PetscScalar *z)
+{
+  PetscInt    i,row;
+  PetscScalar sum;
+
+  for (i=0; i<m; i++) {
+    row    = ridx ? ridx[i] : i;
+    sum    = MatSeqAIJRowDot_AVX512(x,aa+ii[i],aj+ii[i],ii[i+1]-ii[i]);
+    z[row] = y ? y[row] + sum : sum;
+  }
+}
+
+/*
+   Same as MatMult_SeqAIJ_AVX512() for a matrix with inodes: the rows of a node have the same
+   column indices, so each gather of x is used for all the rows of the node
+*/
+__attribute((target("avx512f")))
+void MatMult_SeqAIJ_Inode_AVX512(PetscInt node_max,const PetscInt *ns,const PetscInt *ii,const PetscInt *aj,const MatScalar *aa,const PetscScalar *x,const PetscScalar *y,PetscScalar *z)
+{
+  __m512d        vx,sum[AVX512_NODE_MAX];
+  __mmask8       mask;
+  const PetscInt *idx;
+  PetscInt       i,r,r0,nr,j,n,row = 0;
+
+  for (i=0; i<node_max; i++) {
+    n   = ii[row+1] - ii[row];
+    idx = aj + ii[row];
+    for (r0=0; r0<ns[i]; r0+=AVX512_NODE_MAX) {
+      nr = PetscMin(ns[i]-r0,AVX512_NODE_MAX);
+      for (r=0; r<nr; r++) sum[r] = _mm512_setzero_pd();
+      for (j=0; j+8<=n; j+=8) {
+        vx = AVX512Gather(x,idx+j);
+        for (r=0; r<nr; r++) sum[r] = _mm512_fmadd_pd(_mm512_loadu_pd(aa+ii[row+r0+r]+j),vx,sum[r]);
+      }
+      if (j < n) {
+        mask = (__mmask8)(0xff >> (8-(n-j)));
+        vx   = AVX512MaskGather(mask,x,idx+j);
+        for (r=0; r<nr; r++) sum[r] = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask,aa+ii[row+r0+r]+j),vx,sum[r]);
+      }
+      for (r=0; r<nr; r++) z[row+r0+r] = (y ? y[row+r0+r] : 0.0) + _mm512_reduce_add_pd(sum[r]);
+    }
+    row += ns[i];
+  }
+}
+
+static PetscErrorCode MatSeqAIJFinalizeAVX512_Private(void)
+{
+  PetscFunctionBegin;
+  MatSeqAIJAVX512Initialized = PETSC_FALSE;
+  MatSeqAIJUseAVX512         = PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
+
+/*
+   Called by the first MatCreate_SeqAIJ(); uses the kernels if the processor supports AVX-512, unless -mat_no_avx512 is given
+*/
+PetscErrorCode MatSeqAIJInitializeAVX512_Private(void)
+{
+  PetscBool      flg = PETSC_FALSE;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (MatSeqAIJAVX512Initialized) PetscFunctionReturn(0);
+  MatSeqAIJAVX512Initialized = PETSC_TRUE;
+  ierr = PetscRegisterFinalize(MatSeqAIJFinalizeAVX512_Private);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-mat_no_avx512",&flg,NULL);CHKERRQ(ierr);
+  MatSeqAIJUseAVX512 = (PetscBool)(!flg && __builtin_cpu_supports("avx512f"));
+  ierr = PetscInfo1(NULL,"AVX-512 kernels for SeqAIJ matrix-vector products %s\n",MatSeqAIJUseAVX512 ? "enabled" : "disabled");CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
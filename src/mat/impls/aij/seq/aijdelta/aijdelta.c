@@ -0,0 +1,391 @@
+
+/*
+  Defines basic operations for the MATSEQAIJDELTA matrix class.
+  This class is derived from the MATSEQAIJ class and retains the
+  compressed row storage, but the matrix-vector products read the column
+  indices from a second copy in which each index is encoded as a 16 bit
+  difference to the previous column of its row.  For the banded matrices
+  of PDE discretizations almost all differences fit, so the products move
+  2 bytes per nonzero for the index instead of 4 (or 8 with 64 bit
+  indices); the values are read directly from the AIJ storage.
+*/
+
+#include <../src/mat/impls/aij/seq/aijdelta/aijdelta.h>
+
+static PetscErrorCode MatSeqAIJDelta_Build(Mat A)
+{
+  Mat_SeqAIJ      *a   = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJDelta *dlt = (Mat_SeqAIJDelta*)A->spptr;
+  const PetscInt  *ai  = a->i,*aj = a->j;
+  PetscInt        m    = A->rmap->n,i,k,p,prev,d;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree(dlt->cdelta);CHKERRQ(ierr);
+  ierr = PetscFree(dlt->cptr);CHKERRQ(ierr);
+  dlt->nescapes = 0;
+  for (i=0; i<m; i++) {
+    for (k=ai[i],prev=i; k<ai[i+1]; prev=aj[k++]) {
+      d = aj[k] - prev;
+      if (d <= AIJDELTA_ESCAPE || d > 32767) dlt->nescapes++;
+    }
+  }
+  ierr = PetscMalloc1(ai[m]+dlt->nescapes*AIJDELTA_ESCAPE_LEN,&dlt->cdelta);CHKERRQ(ierr);
+  if (dlt->nescapes) {ierr = PetscMalloc1(m+1,&dlt->cptr);CHKERRQ(ierr);}
+  ierr = PetscLogObjectMemory((PetscObject)A,(ai[m]+dlt->nescapes*AIJDELTA_ESCAPE_LEN)*sizeof(short)+(dlt->nescapes ? m+1 : 0)*sizeof(PetscInt));CHKERRQ(ierr);
+  for (i=0,p=0; i<m; i++) {
+    if (dlt->cptr) dlt->cptr[i] = p;
+    for (k=ai[i],prev=i; k<ai[i+1]; prev=aj[k++]) {
+      d = aj[k] - prev;
+      if (d <= AIJDELTA_ESCAPE || d > 32767) {
+        dlt->cdelta[p] = AIJDELTA_ESCAPE;
+        ierr = PetscMemcpy(dlt->cdelta+p+1,aj+k,sizeof(PetscInt));CHKERRQ(ierr);
+        p   += 1+AIJDELTA_ESCAPE_LEN;
+      } else dlt->cdelta[p++] = (short)d;
+    }
+  }
+  if (dlt->cptr) dlt->cptr[m] = p;
+  dlt->nonzerostate = A->nonzerostate;
+  ierr = PetscInfo2(A,"%D of %D column indices do not fit in 16 bits\n",dlt->nescapes,ai[m]);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* the values are not copied, so only a change of the nonzero structure requires a new encoding */
+PETSC_STATIC_INLINE PetscErrorCode MatSeqAIJDelta_Update(Mat A)
+{
+  Mat_SeqAIJDelta *dlt = (Mat_SeqAIJDelta*)A->spptr;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  if (dlt->nonzerostate != A->nonzerostate) {
+    ierr = MatSeqAIJDelta_Build(A);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatSeqAIJDelta_Reset(Mat A)
+{
+  Mat_SeqAIJDelta *dlt = (Mat_SeqAIJDelta*)A->spptr;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree(dlt->cdelta);CHKERRQ(ierr);
+  ierr = PetscFree(dlt->cptr);CHKERRQ(ierr);
+  dlt->nescapes     = 0;
+  dlt->nonzerostate = -1;
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJDelta_SeqAIJ(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  /* This routine is only called to convert a MATAIJDELTA to its base PETSc type, */
+  /* so we will ignore 'MatType type'. */
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  /* Reset the original function pointers. */
+  B->ops->duplicate        = MatDuplicate_SeqAIJ;
+  B->ops->assemblyend      = MatAssemblyEnd_SeqAIJ;
+  B->ops->destroy          = MatDestroy_SeqAIJ;
+  B->ops->mult             = MatMult_SeqAIJ;
+  B->ops->multadd          = MatMultAdd_SeqAIJ;
+  B->ops->multtranspose    = MatMultTranspose_SeqAIJ;
+  B->ops->multtransposeadd = MatMultTransposeAdd_SeqAIJ;
+
+  ierr = MatSeqAIJDelta_Reset(B);CHKERRQ(ierr);
+  ierr = PetscFree(B->spptr);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaijdelta_seqaij_C",NULL);CHKERRQ(ierr);
+
+  /* Change the type of B to MATSEQAIJ. */
+  ierr = PetscObjectChangeTypeName((PetscObject)B,MATSEQAIJ);CHKERRQ(ierr);
+
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatDestroy_SeqAIJDelta(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (A->spptr) {
+    ierr = MatSeqAIJDelta_Reset(A);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(A->spptr);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaijdelta_seqaij_C",NULL);CHKERRQ(ierr);
+
+  /* Change the type of A back to SEQAIJ and use MatDestroy_SeqAIJ()
+   * to destroy everything that remains. */
+  ierr = PetscObjectChangeTypeName((PetscObject)A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatDestroy_SeqAIJ(A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatDuplicate_SeqAIJDelta(Mat A,MatDuplicateOption op,Mat *M)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  /* the new matrix is created with the type of A, so it gets its own encoding, built on first use */
+  ierr = MatDuplicate_SeqAIJ(A,op,M);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatAssemblyEnd_SeqAIJDelta(Mat A,MatAssemblyType mode)
+{
+  Mat_SeqAIJ      *a   = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJDelta *dlt = (Mat_SeqAIJDelta*)A->spptr;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  if (mode == MAT_FLUSH_ASSEMBLY) PetscFunctionReturn(0);
+
+  /* inodes would replace the multiply routines set by this class */
+  a->inode.use = PETSC_FALSE;
+  ierr         = MatAssemblyEnd_SeqAIJ(A,mode);CHKERRQ(ierr);
+
+  /* the column indices may have been renumbered, for example by MatSetUpMultiply_MPIAIJ(), so encode them again */
+  dlt->nonzerostate = -1;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMult_SeqAIJDelta(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqAIJ        *a   = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJDelta   *dlt = (Mat_SeqAIJDelta*)A->spptr;
+  const PetscInt    *ai  = a->i,*cptr,*ridx = NULL;
+  const MatScalar   *aa  = a->a;
+  const short       *cd;
+  const PetscScalar *x;
+  PetscScalar       *y,sum;
+  PetscInt          m = A->rmap->n,i,k,p,row,col;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJDelta_Update(A);CHKERRQ(ierr);
+  cd   = dlt->cdelta;
+  cptr = dlt->cptr ? dlt->cptr : ai;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  if (a->compressedrow.use) {
+    ierr = PetscMemzero(y,m*sizeof(PetscScalar));CHKERRQ(ierr);
+    m    = a->compressedrow.nrows;
+    ridx = a->compressedrow.rindex;
+  }
+  for (i=0; i<m; i++) {
+    row = ridx ? ridx[i] : i;
+    p   = cptr[row];
+    col = row;
+    sum = 0.0;
+    for (k=ai[row]; k<ai[row+1]; k++) {
+      MatSeqAIJDeltaNextColumn(cd,p,col);
+      sum += aa[k]*x[col];
+    }
+    y[row] = sum;
+  }
+  ierr = PetscLogFlops(2.0*a->nz - a->nonzerorowcnt);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultAdd_SeqAIJDelta(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqAIJ        *a   = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJDelta   *dlt = (Mat_SeqAIJDelta*)A->spptr;
+  const PetscInt    *ai  = a->i,*cptr,*ridx = NULL;
+  const MatScalar   *aa  = a->a;
+  const short       *cd;
+  const PetscScalar *x;
+  PetscScalar       *y,*z,sum;
+  PetscInt          m = A->rmap->n,i,k,p,row,col;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJDelta_Update(A);CHKERRQ(ierr);
+  cd   = dlt->cdelta;
+  cptr = dlt->cptr ? dlt->cptr : ai;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  if (a->compressedrow.use) {
+    if (zz != yy) {
+      ierr = PetscMemcpy(z,y,m*sizeof(PetscScalar));CHKERRQ(ierr);
+    }
+    m    = a->compressedrow.nrows;
+    ridx = a->compressedrow.rindex;
+  }
+  for (i=0; i<m; i++) {
+    row = ridx ? ridx[i] : i;
+    p   = cptr[row];
+    col = row;
+    sum = y[row];
+    for (k=ai[row]; k<ai[row+1]; k++) {
+      MatSeqAIJDeltaNextColumn(cd,p,col);
+      sum += aa[k]*x[col];
+    }
+    z[row] = sum;
+  }
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTransposeAdd_SeqAIJDelta(Mat A,Vec xx,Vec zz,Vec yy)
+{
+  Mat_SeqAIJ        *a   = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJDelta   *dlt = (Mat_SeqAIJDelta*)A->spptr;
+  const PetscInt    *ai  = a->i,*cptr,*ridx = NULL;
+  const MatScalar   *aa  = a->a;
+  const short       *cd;
+  const PetscScalar *x;
+  PetscScalar       *y,alpha;
+  PetscInt          m = A->rmap->n,i,k,p,row,col;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJDelta_Update(A);CHKERRQ(ierr);
+  cd   = dlt->cdelta;
+  cptr = dlt->cptr ? dlt->cptr : ai;
+  if (zz != yy) {ierr = VecCopy(zz,yy);CHKERRQ(ierr);}
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  if (a->compressedrow.use) {
+    m    = a->compressedrow.nrows;
+    ridx = a->compressedrow.rindex;
+  }
+  for (i=0; i<m; i++) {
+    row   = ridx ? ridx[i] : i;
+    p     = cptr[row];
+    col   = row;
+    alpha = x[row];
+    for (k=ai[row]; k<ai[row+1]; k++) {
+      MatSeqAIJDeltaNextColumn(cd,p,col);
+      y[col] += alpha*aa[k];
+    }
+  }
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTranspose_SeqAIJDelta(Mat A,Vec xx,Vec yy)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecSet(yy,0.0);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd_SeqAIJDelta(A,xx,yy,yy);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJDelta(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode  ierr;
+  Mat             B = *newmat;
+  Mat_SeqAIJDelta *dlt;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  ierr     = PetscNewLog(B,&dlt);CHKERRQ(ierr);
+  B->spptr = (void*)dlt;
+  dlt->nonzerostate = -1;
+
+  /* Set function pointers for methods that we inherit from AIJ but override. */
+  B->ops->duplicate        = MatDuplicate_SeqAIJDelta;
+  B->ops->assemblyend      = MatAssemblyEnd_SeqAIJDelta;
+  B->ops->destroy          = MatDestroy_SeqAIJDelta;
+  B->ops->mult             = MatMult_SeqAIJDelta;
+  B->ops->multadd          = MatMultAdd_SeqAIJDelta;
+  B->ops->multtranspose    = MatMultTranspose_SeqAIJDelta;
+  B->ops->multtransposeadd = MatMultTransposeAdd_SeqAIJDelta;
+
+  /* inodes of an assembled matrix would otherwise keep being used in place of these kernels after the next assembly */
+  ((Mat_SeqAIJ*)B->data)->inode.use = PETSC_FALSE;
+
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaijdelta_seqaij_C",MatConvert_SeqAIJDelta_SeqAIJ);CHKERRQ(ierr);
+
+  ierr    = PetscObjectChangeTypeName((PetscObject)B,MATSEQAIJDELTA);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+/*@C
+   MatCreateSeqAIJDelta - Creates a sparse matrix of type SEQAIJDELTA.
+   This type inherits from AIJ, but its matrix-vector products read the
+   column indices from a copy in which each index is stored as the 16 bit
+   difference to the previous column of the row.  As with the AIJ type, it
+   is important to preallocate matrix storage in order to get good assembly
+   performance.
+
+   Collective on MPI_Comm
+
+   Input Parameters:
++  comm - MPI communicator, set to PETSC_COMM_SELF
+.  m - number of rows
+.  n - number of columns
+.  nz - number of nonzeros per row (same for all rows)
+-  nnz - array containing the number of nonzeros in the various rows
+         (possibly different for each row) or NULL
+
+   Output Parameter:
+.  A - the matrix
+
+   Notes:
+   If nnz is given then nz is ignored
+
+   The first column of a row is stored relative to the row number.  Differences that do not
+   fit in 16 bits are stored in full, behind an escape code; if there are any, the start of
+   each row in the encoded indices is kept as well.  The encoded copy adds 2 bytes per nonzero
+   to the memory used by the matrix, but the products only read it and the values: 10 instead
+   of 12 bytes per nonzero, or instead of 16 with 64 bit indices.  It is rebuilt by the first
+   product after the nonzero structure has changed.
+
+   Level: intermediate
+
+.keywords: matrix, compressed, column indices, sparse
+
+.seealso: MatCreate(), MatCreateMPIAIJDelta(), MatSetValues(), MATSEQAIJDELTA
+@*/
+PetscErrorCode  MatCreateSeqAIJDelta(MPI_Comm comm,PetscInt m,PetscInt n,PetscInt nz,const PetscInt nnz[],Mat *A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreate(comm,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,m,n,m,n);CHKERRQ(ierr);
+  ierr = MatSetType(*A,MATSEQAIJDELTA);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation_SeqAIJ(*A,nz,nnz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   MATSEQAIJDELTA - MATSEQAIJDELTA = "seqaijdelta" - A sequential AIJ matrix whose matrix-vector
+   products read 16 bit differences of the column indices instead of the indices themselves.
+
+   Options Database Keys:
+.  -mat_type seqaijdelta - sets the matrix type to "seqaijdelta" during a call to MatSetFromOptions()
+
+  Level: intermediate
+
+.seealso: MatCreateSeqAIJDelta(), MATAIJDELTA, MATSEQAIJPERM, MATSEQAIJSELL
+M*/
+
+PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJDelta(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSetType(A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatConvert_SeqAIJ_SeqAIJDelta(A,MATSEQAIJDELTA,MAT_INPLACE_MATRIX,&A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
@@ -0,0 +1,27 @@
+
+#if !defined(__AIJDELTA_H)
+#define __AIJDELTA_H
+
+#include <../src/mat/impls/aij/seq/aij.h>
+
+/*
+   A column index is stored as the 16 bit difference to the previous column of its row, or to the
+   row number for the first entry.  Differences that do not fit are stored as AIJDELTA_ESCAPE
+   followed by the column index itself, in the next AIJDELTA_ESCAPE_LEN shorts.
+*/
+#define AIJDELTA_ESCAPE     ((short)-32768)
+#define AIJDELTA_ESCAPE_LEN ((PetscInt)(sizeof(PetscInt)/sizeof(short)))
+
+typedef struct {
+  short            *cdelta;       /* encoded column indices of all rows */
+  PetscInt         *cptr;         /* start of each row in cdelta; NULL when there are no escapes, then a->i is used */
+  PetscInt         nescapes;      /* number of column indices stored in full */
+  PetscObjectState nonzerostate;  /* nonzero state of the matrix when cdelta was built */
+} Mat_SeqAIJDelta;
+
+/* advances col to the next column of the row, whose code starts at cd[p] */
+#define MatSeqAIJDeltaNextColumn(cd,p,col) { \
+    if (cd[p] == AIJDELTA_ESCAPE) {memcpy(&(col),(cd)+(p)+1,sizeof(PetscInt)); (p) += 1+AIJDELTA_ESCAPE_LEN;} \
+    else (col) += (cd)[(p)++];}
+
+#endif
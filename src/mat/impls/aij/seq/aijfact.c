@@ -288,6 +288,7 @@ PetscErrorCode MatLUFactorSymbolic_SeqAIJ(Mat B,Mat A,IS isrow,IS iscol,const Ma
   PetscBool          missing;
 
   PetscFunctionBegin;
+  ierr = MatSeqAIJFactorDestroySolveLevels(&((Mat_SeqAIJ*)B->data)->solvelevels);CHKERRQ(ierr);
   if (A->rmap->N != A->cmap->N) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"matrix must be square");
   ierr = MatMissingDiagonal(A,&missing,&i);CHKERRQ(ierr);
   if (missing) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Matrix is missing diagonal entry %D",i);
@@ -592,6 +593,7 @@ PetscErrorCode MatLUFactorNumeric_SeqAIJ(Mat B,Mat A,const MatFactorInfo *info)
   } else {
     C->ops->solve = MatSolve_SeqAIJ;
   }
+  ierr = MatSeqAIJFactorSetUpSolveLevels(C,PETSC_FALSE);CHKERRQ(ierr);
   C->ops->solveadd          = MatSolveAdd_SeqAIJ;
   C->ops->solvetranspose    = MatSolveTranspose_SeqAIJ;
   C->ops->solvetransposeadd = MatSolveTransposeAdd_SeqAIJ;
@@ -1596,6 +1598,7 @@ PetscErrorCode MatILUFactorSymbolic_SeqAIJ_ilu0(Mat fact,Mat A,IS isrow,IS iscol
   IS             isicol;
 
   PetscFunctionBegin;
+  ierr = MatSeqAIJFactorDestroySolveLevels(&((Mat_SeqAIJ*)fact->data)->solvelevels);CHKERRQ(ierr);
   ierr = ISInvertPermutation(iscol,PETSC_DECIDE,&isicol);CHKERRQ(ierr);
   ierr = MatDuplicateNoCreate_SeqAIJ(fact,A,MAT_DO_NOT_COPY_VALUES,PETSC_FALSE);CHKERRQ(ierr);
   b    = (Mat_SeqAIJ*)(fact)->data;
@@ -1682,6 +1685,7 @@ PetscErrorCode MatILUFactorSymbolic_SeqAIJ(Mat fact,Mat A,IS isrow,IS iscol,cons
   PetscFreeSpaceList free_space_lvl=NULL,current_space_lvl=NULL;
 
   PetscFunctionBegin;
+  ierr = MatSeqAIJFactorDestroySolveLevels(&((Mat_SeqAIJ*)fact->data)->solvelevels);CHKERRQ(ierr);
   if (A->rmap->n != A->cmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Must be square matrix, rows %D columns %D",A->rmap->n,A->cmap->n);
   ierr = MatMissingDiagonal(A,&missing,&i);CHKERRQ(ierr);
   if (missing) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Matrix is missing diagonal entry %D",i);
@@ -2168,6 +2172,7 @@ PetscErrorCode MatCholeskyFactorNumeric_SeqAIJ(Mat B,Mat A,const MatFactorInfo *
     B->ops->forwardsolve   = MatForwardSolve_SeqSBAIJ_1;
     B->ops->backwardsolve  = MatBackwardSolve_SeqSBAIJ_1;
   }
+  ierr = MatSeqAIJFactorSetUpSolveLevels(B,PETSC_TRUE);CHKERRQ(ierr);
 
   C->assembled    = PETSC_TRUE;
   C->preallocated = PETSC_TRUE;
@@ -2376,6 +2381,7 @@ PetscErrorCode MatICCFactorSymbolic_SeqAIJ(Mat fact,Mat A,IS perm,const MatFacto
   IS                 iperm;
 
   PetscFunctionBegin;
+  ierr = MatSeqAIJFactorDestroySolveLevels(&((Mat_SeqSBAIJ*)fact->data)->solvelevels);CHKERRQ(ierr);
   if (A->rmap->n != A->cmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Must be square matrix, rows %D columns %D",A->rmap->n,A->cmap->n);
   ierr = MatMissingDiagonal(A,&missing,&d);CHKERRQ(ierr);
   if (missing) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Matrix is missing diagonal entry %D",d);
@@ -2778,6 +2784,16 @@ PetscErrorCode MatCholeskyFactorSymbolic_SeqAIJ(Mat fact,Mat A,IS perm,const Mat
   IS                 iperm;
 
   PetscFunctionBegin;
+  ierr = MatSeqAIJFactorDestroySolveLevels(&((Mat_SeqSBAIJ*)fact->data)->solvelevels);CHKERRQ(ierr);
+  ierr = MatSeqSBAIJFactorDestroySupernodes(&((Mat_SeqSBAIJ*)fact->data)->supernodes);CHKERRQ(ierr);
+  /* a repeated symbolic factorization replaces the previous factor */
+  b    = (Mat_SeqSBAIJ*)fact->data;
+  ierr = MatSeqXAIJFreeAIJ(fact,&b->a,&b->j,&b->i);CHKERRQ(ierr);
+  if (b->free_diag) {ierr = PetscFree(b->diag);CHKERRQ(ierr);}
+  ierr = ISDestroy(&b->row);CHKERRQ(ierr);
+  ierr = ISDestroy(&b->col);CHKERRQ(ierr);
+  ierr = ISDestroy(&b->icol);CHKERRQ(ierr);
+  ierr = PetscFree(b->solve_work);CHKERRQ(ierr);
   if (A->rmap->n != A->cmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Must be square matrix, rows %D columns %D",A->rmap->n,A->cmap->n);
   ierr = MatMissingDiagonal(A,&missing,&i);CHKERRQ(ierr);
   if (missing) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Matrix is missing diagonal entry %D",i);
@@ -2930,6 +2946,7 @@ PetscErrorCode MatCholeskyFactorSymbolic_SeqAIJ(Mat fact,Mat A,IS perm,const Mat
   }
 #endif
   fact->ops->choleskyfactornumeric = MatCholeskyFactorNumeric_SeqAIJ;
+  ierr = MatSeqSBAIJFactorSetUpSupernodes(fact);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -0,0 +1,269 @@
+
+/*
+   Level scheduled triangular solves with the LU, ILU, Cholesky and ICC factors of SeqAIJ matrices.
+
+   The rows of a triangular factor are grouped into levels such that a row only depends on rows of earlier
+   levels; the rows of one level are then independent and are computed in parallel with OpenMP. The levels only
+   depend on the nonzero structure of the factor, so they are computed at the first numeric factorization after
+   a symbolic factorization and reused by the following numeric factorizations.
+*/
+#include <../src/mat/impls/aij/seq/aij.h>
+#include <../src/mat/impls/sbaij/seq/sbaij.h>
+
+/* levels with fewer rows than this are computed by a single thread */
+#define MATSOLVE_LEVELS_OMP_MIN 64
+
+/* groups the rows 0 to n-1 by their level, keeping them in increasing order inside each level */
+static PetscErrorCode MatSeqAIJGroupLevels_Private(PetscInt n,const PetscInt level[],PetscInt *nlevels,PetscInt **levelptr,PetscInt **levelrows)
+{
+  PetscErrorCode ierr;
+  PetscInt       i,nl = 0,*ptr,*rows,*next;
+
+  PetscFunctionBegin;
+  for (i=0; i<n; i++) nl = PetscMax(nl,level[i]+1);
+  ierr = PetscCalloc1(nl+1,&ptr);CHKERRQ(ierr);
+  ierr = PetscMalloc1(n,&rows);CHKERRQ(ierr);
+  ierr = PetscMalloc1(nl,&next);CHKERRQ(ierr);
+  for (i=0; i<n; i++) ptr[level[i]+1]++;
+  for (i=0; i<nl; i++) {
+    ptr[i+1] += ptr[i];
+    next[i]   = ptr[i];
+  }
+  for (i=0; i<n; i++) rows[next[level[i]]++] = i;
+  ierr = PetscFree(next);CHKERRQ(ierr);
+  *nlevels   = nl;
+  *levelptr  = ptr;
+  *levelrows = rows;
+  PetscFunctionReturn(0);
+}
+
+/*
+   LU: L is stored by rows in a->i, the strict upper part of U row i is at a->diag[i+1]+1 to a->diag[i]-1.
+   Cholesky: the factor is a SeqSBAIJ matrix with U stored by rows and the diagonal last, the forward solve with U^T
+   uses the columns of U.
+*/
+static PetscErrorCode MatSeqAIJFactorCreateSolveLevels_Private(Mat B,const PetscInt ai[],const PetscInt aj[],const PetscInt adiag[],PetscBool cholesky,Mat_SeqAIJSolveLevels **levels)
+{
+  const PetscInt        n = B->rmap->n;
+  Mat_SeqAIJSolveLevels *lv;
+  PetscInt              i,j,p,lev,*level,*cnt;
+  PetscErrorCode        ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscNewLog(B,&lv);CHKERRQ(ierr);
+  ierr = PetscMalloc1(n,&level);CHKERRQ(ierr);
+  if (!cholesky) {
+    for (i=0; i<n; i++) {
+      lev = 0;
+      for (p=ai[i]; p<ai[i+1]; p++) lev = PetscMax(lev,level[aj[p]]+1);
+      level[i] = lev;
+    }
+    ierr = MatSeqAIJGroupLevels_Private(n,level,&lv->nlevels[0],&lv->levelptr[0],&lv->levelrows[0]);CHKERRQ(ierr);
+    for (i=n-1; i>=0; i--) {
+      lev = 0;
+      for (p=adiag[i+1]+1; p<adiag[i]; p++) lev = PetscMax(lev,level[aj[p]]+1);
+      level[i] = lev;
+    }
+    ierr = MatSeqAIJGroupLevels_Private(n,level,&lv->nlevels[1],&lv->levelptr[1],&lv->levelrows[1]);CHKERRQ(ierr);
+  } else {
+    ierr = PetscMemzero(level,n*sizeof(PetscInt));CHKERRQ(ierr);
+    for (i=0; i<n; i++) {
+      for (p=ai[i]; p<ai[i+1]-1; p++) level[aj[p]] = PetscMax(level[aj[p]],level[i]+1);
+    }
+    ierr = MatSeqAIJGroupLevels_Private(n,level,&lv->nlevels[0],&lv->levelptr[0],&lv->levelrows[0]);CHKERRQ(ierr);
+    for (i=n-1; i>=0; i--) {
+      lev = 0;
+      for (p=ai[i]; p<ai[i+1]-1; p++) lev = PetscMax(lev,level[aj[p]]+1);
+      level[i] = lev;
+    }
+    ierr = MatSeqAIJGroupLevels_Private(n,level,&lv->nlevels[1],&lv->levelptr[1],&lv->levelrows[1]);CHKERRQ(ierr);
+
+    /* transpose of the strict upper part of U, by positions so that it remains valid after refactorization */
+    ierr = PetscCalloc1(n+1,&lv->ti);CHKERRQ(ierr);
+    ierr = PetscMalloc2(ai[n]-n,&lv->tk,ai[n]-n,&lv->tp);CHKERRQ(ierr);
+    for (i=0; i<n; i++) {
+      for (p=ai[i]; p<ai[i+1]-1; p++) lv->ti[aj[p]+1]++;
+    }
+    for (i=0; i<n; i++) lv->ti[i+1] += lv->ti[i];
+    cnt  = level;
+    ierr = PetscMemcpy(cnt,lv->ti,n*sizeof(PetscInt));CHKERRQ(ierr);
+    for (i=0; i<n; i++) {
+      for (p=ai[i]; p<ai[i+1]-1; p++) {
+        j         = cnt[aj[p]]++;
+        lv->tk[j] = i;
+        lv->tp[j] = p;
+      }
+    }
+    ierr = PetscMalloc1(n,&lv->work);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(level);CHKERRQ(ierr);
+  ierr = PetscInfo3(B,"Triangular solves with %D rows have %D forward and %D backward levels\n",n,lv->nlevels[0],lv->nlevels[1]);CHKERRQ(ierr);
+  *levels = lv;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatSeqAIJFactorDestroySolveLevels(Mat_SeqAIJSolveLevels **levels)
+{
+  Mat_SeqAIJSolveLevels *lv = *levels;
+  PetscErrorCode        ierr;
+
+  PetscFunctionBegin;
+  if (!lv) PetscFunctionReturn(0);
+  ierr = PetscFree(lv->levelptr[0]);CHKERRQ(ierr);
+  ierr = PetscFree(lv->levelrows[0]);CHKERRQ(ierr);
+  ierr = PetscFree(lv->levelptr[1]);CHKERRQ(ierr);
+  ierr = PetscFree(lv->levelrows[1]);CHKERRQ(ierr);
+  ierr = PetscFree(lv->ti);CHKERRQ(ierr);
+  ierr = PetscFree2(lv->tk,lv->tp);CHKERRQ(ierr);
+  ierr = PetscFree(lv->work);CHKERRQ(ierr);
+  ierr = PetscFree(*levels);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatSolve_SeqAIJ_Levels(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqAIJ            *a  = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJSolveLevels *lv = a->solvelevels;
+  PetscErrorCode        ierr;
+  const PetscInt        n   = A->rmap->n,*ai = a->i,*aj = a->j,*adiag = a->diag,*r,*c,*rows;
+  const MatScalar       *aa = a->a;
+  const PetscScalar     *b;
+  PetscScalar           *x,*tmp = a->solve_work;
+  PetscInt              l,k;
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = ISGetIndices(a->row,&r);CHKERRQ(ierr);
+  ierr = ISGetIndices(a->col,&c);CHKERRQ(ierr);
+
+  /* forward solve the lower triangular */
+  rows = lv->levelrows[0];
+  for (l=0; l<lv->nlevels[0]; l++) {
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for schedule(static) if (lv->levelptr[0][l+1]-lv->levelptr[0][l] > MATSOLVE_LEVELS_OMP_MIN)
+#endif
+    for (k=lv->levelptr[0][l]; k<lv->levelptr[0][l+1]; k++) {
+      const PetscInt  i   = rows[k],nz = ai[i+1]-ai[i],*vi = aj+ai[i];
+      const MatScalar *v  = aa+ai[i];
+      PetscScalar     sum = b[r[i]];
+
+      PetscSparseDenseMinusDot(sum,tmp,v,vi,nz);
+      tmp[i] = sum;
+    }
+  }
+
+  /* backward solve the upper triangular */
+  rows = lv->levelrows[1];
+  for (l=0; l<lv->nlevels[1]; l++) {
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for schedule(static) if (lv->levelptr[1][l+1]-lv->levelptr[1][l] > MATSOLVE_LEVELS_OMP_MIN)
+#endif
+    for (k=lv->levelptr[1][l]; k<lv->levelptr[1][l+1]; k++) {
+      const PetscInt  i   = rows[k],nz = adiag[i]-adiag[i+1]-1,*vi = aj+adiag[i+1]+1;
+      const MatScalar *v  = aa+adiag[i+1]+1;
+      PetscScalar     sum = tmp[i];
+
+      PetscSparseDenseMinusDot(sum,tmp,v,vi,nz);
+      x[c[i]] = tmp[i] = sum*v[nz]; /* v[nz] = aa[adiag[i]] */
+    }
+  }
+
+  ierr = ISRestoreIndices(a->row,&r);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(a->col,&c);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2*a->nz - A->cmap->n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   The forward solve U^T D y = perm(b) gathers along the columns of U: w(j) = perm(b)(j) + sum_k U(k,j) w(k)
+   and y(j) = w(j)/D(j), with the sign convention of MatSolve_SeqSBAIJ_1()
+*/
+static PetscErrorCode MatSolve_SeqAIJ_Cholesky_Levels(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqSBAIJ          *a  = (Mat_SeqSBAIJ*)A->data;
+  Mat_SeqAIJSolveLevels *lv = a->solvelevels;
+  PetscErrorCode        ierr;
+  const PetscInt        n   = A->rmap->n,*ai = a->i,*aj = a->j,*adiag = a->diag,*ti = lv->ti,*tk = lv->tk,*tp = lv->tp,*rp,*rows;
+  const MatScalar       *aa = a->a;
+  const PetscScalar     *b;
+  PetscScalar           *x,*t = a->solve_work,*w = lv->work;
+  PetscInt              l,k;
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = ISGetIndices(a->row,&rp);CHKERRQ(ierr);
+
+  /* solve U^T*D*y = perm(b) by forward substitution */
+  rows = lv->levelrows[0];
+  for (l=0; l<lv->nlevels[0]; l++) {
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for schedule(static) if (lv->levelptr[0][l+1]-lv->levelptr[0][l] > MATSOLVE_LEVELS_OMP_MIN)
+#endif
+    for (k=lv->levelptr[0][l]; k<lv->levelptr[0][l+1]; k++) {
+      const PetscInt j   = rows[k];
+      PetscScalar    sum = b[rp[j]];
+      PetscInt       q;
+
+      for (q=ti[j]; q<ti[j+1]; q++) sum += aa[tp[q]]*w[tk[q]];
+      w[j] = sum;
+      t[j] = sum*aa[adiag[j]]; /* aa[adiag[j]] = 1/D(j) */
+    }
+  }
+
+  /* solve U*perm(x) = y by back substitution */
+  rows = lv->levelrows[1];
+  for (l=0; l<lv->nlevels[1]; l++) {
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for schedule(static) if (lv->levelptr[1][l+1]-lv->levelptr[1][l] > MATSOLVE_LEVELS_OMP_MIN)
+#endif
+    for (k=lv->levelptr[1][l]; k<lv->levelptr[1][l+1]; k++) {
+      const PetscInt i   = rows[k];
+      PetscScalar    sum = t[i];
+      PetscInt       p;
+
+      for (p=ai[i]; p<ai[i+1]-1; p++) sum += aa[p]*t[aj[p]];
+      x[rp[i]] = t[i] = sum;
+    }
+  }
+
+  ierr = ISRestoreIndices(a->row,&rp);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = PetscLogFlops(4.0*a->nz - 3.0*n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   MatSeqAIJFactorSetUpSolveLevels - called at the end of a numeric factorization, replaces MatSolve() of the factor
+   B by the level scheduled solve if -mat_solve_levels is set. It is off by default, since the OpenMP threads of the
+   solve would compete with the MPI processes for the cores. The option is read with the prefix of the factor, which
+   the factor preconditioners set to their own, for example -sub_mat_solve_levels for PCBJACOBI and PCASM.
+*/
+PetscErrorCode MatSeqAIJFactorSetUpSolveLevels(Mat B,PetscBool cholesky)
+{
+  PetscBool      flg = PETSC_FALSE;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsGetBool(((PetscObject)B)->options,((PetscObject)B)->prefix,"-mat_solve_levels",&flg,NULL);CHKERRQ(ierr);
+  if (!flg || !B->rmap->n) PetscFunctionReturn(0);
+  if (cholesky) {
+    Mat_SeqSBAIJ *b = (Mat_SeqSBAIJ*)B->data;
+
+    if (!b->solvelevels) {ierr = MatSeqAIJFactorCreateSolveLevels_Private(B,b->i,b->j,b->diag,PETSC_TRUE,&b->solvelevels);CHKERRQ(ierr);}
+    B->ops->solve          = MatSolve_SeqAIJ_Cholesky_Levels;
+    B->ops->solvetranspose = MatSolve_SeqAIJ_Cholesky_Levels;
+  } else {
+    Mat_SeqAIJ *b = (Mat_SeqAIJ*)B->data;
+
+    if (!b->solvelevels) {ierr = MatSeqAIJFactorCreateSolveLevels_Private(B,b->i,b->j,b->diag,PETSC_FALSE,&b->solvelevels);CHKERRQ(ierr);}
+    B->ops->solve = MatSolve_SeqAIJ_Levels;
+  }
+  PetscFunctionReturn(0);
+}
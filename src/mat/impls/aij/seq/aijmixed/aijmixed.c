@@ -0,0 +1,584 @@
+
+/*
+  Defines basic operations for the MATSEQAIJMIXED matrix class.
+  This class is derived from the MATSEQAIJ class and retains the
+  compressed row storage, but the matrix-vector products, the SOR sweeps
+  and the triangular solves of its LU and ILU factors read a single
+  precision copy of the values.  The vectors and all sums stay in double
+  precision, so these bandwidth bound kernels move 4 instead of 8 bytes
+  per value while the iteration using them is still carried out in double.
+*/
+
+#include <../src/mat/impls/aij/seq/aijmixed/aijmixed.h>
+
+PETSC_INTERN PetscErrorCode MatGetFactor_seqaij_petsc(Mat,MatFactorType,Mat*);
+
+/* the copy is refreshed lazily so that matrices that are only assembled, or changed through MatScale() and friends, stay correct */
+static PetscErrorCode MatSeqAIJMixed_Update(Mat A)
+{
+  Mat_SeqAIJ      *a  = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJMixed *mx = (Mat_SeqAIJMixed*)A->spptr;
+  PetscInt        i,nz = a->nz;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  if (mx->state == ((PetscObject)A)->state) PetscFunctionReturn(0);
+  if (nz > mx->maxnz) {
+    ierr = PetscFree(mx->a);CHKERRQ(ierr);
+    ierr = PetscMalloc1(nz,&mx->a);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)A,(nz-mx->maxnz)*sizeof(float));CHKERRQ(ierr);
+    mx->maxnz = nz;
+  }
+  for (i=0; i<nz; i++) mx->a[i] = (float)a->a[i];
+  mx->state = ((PetscObject)A)->state;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatSeqAIJMixed_Reset(Mat A)
+{
+  Mat_SeqAIJMixed *mx = (Mat_SeqAIJMixed*)A->spptr;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr      = PetscFree(mx->a);CHKERRQ(ierr);
+  mx->maxnz = 0;
+  mx->state = -1;
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJMixed_SeqAIJ(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  /* This routine is only called to convert a MATAIJMIXED to its base PETSc type, */
+  /* so we will ignore 'MatType type'. */
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  /* Reset the original function pointers. */
+  B->ops->duplicate   = MatDuplicate_SeqAIJ;
+  B->ops->assemblyend = MatAssemblyEnd_SeqAIJ;
+  B->ops->destroy     = MatDestroy_SeqAIJ;
+  B->ops->mult        = MatMult_SeqAIJ;
+  B->ops->multadd     = MatMultAdd_SeqAIJ;
+  B->ops->sor         = MatSOR_SeqAIJ;
+
+  ierr = MatSeqAIJMixed_Reset(B);CHKERRQ(ierr);
+  ierr = PetscFree(B->spptr);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaijmixed_seqaij_C",NULL);CHKERRQ(ierr);
+
+  /* Change the type of B to MATSEQAIJ. */
+  ierr = PetscObjectChangeTypeName((PetscObject)B,MATSEQAIJ);CHKERRQ(ierr);
+
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatDestroy_SeqAIJMixed(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (A->spptr) {
+    ierr = MatSeqAIJMixed_Reset(A);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(A->spptr);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaijmixed_seqaij_C",NULL);CHKERRQ(ierr);
+
+  /* Change the type of A back to SEQAIJ and use MatDestroy_SeqAIJ()
+   * to destroy everything that remains. */
+  ierr = PetscObjectChangeTypeName((PetscObject)A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatDestroy_SeqAIJ(A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatDuplicate_SeqAIJMixed(Mat A,MatDuplicateOption op,Mat *M)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  /* the new matrix is created with the type of A, so it gets its own copy, made on first use */
+  ierr = MatDuplicate_SeqAIJ(A,op,M);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatAssemblyEnd_SeqAIJMixed(Mat A,MatAssemblyType mode)
+{
+  Mat_SeqAIJ      *a  = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJMixed *mx = (Mat_SeqAIJMixed*)A->spptr;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  if (mode == MAT_FLUSH_ASSEMBLY) PetscFunctionReturn(0);
+
+  /* inodes would replace the multiply and SOR routines set by this class */
+  a->inode.use = PETSC_FALSE;
+  ierr         = MatAssemblyEnd_SeqAIJ(A,mode);CHKERRQ(ierr);
+  mx->state    = -1;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMult_SeqAIJMixed(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqAIJ        *a  = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJMixed   *mx = (Mat_SeqAIJMixed*)A->spptr;
+  const PetscInt    *ai = a->i,*aj,*ridx = NULL;
+  const float       *aa;
+  const PetscScalar *x;
+  PetscScalar       *y,sum;
+  PetscInt          m = A->rmap->n,i,n,row;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJMixed_Update(A);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  if (a->compressedrow.use) {
+    ierr = PetscMemzero(y,m*sizeof(PetscScalar));CHKERRQ(ierr);
+    m    = a->compressedrow.nrows;
+    ridx = a->compressedrow.rindex;
+  }
+  for (i=0; i<m; i++) {
+    row = ridx ? ridx[i] : i;
+    n   = ai[row+1] - ai[row];
+    aj  = a->j + ai[row];
+    aa  = mx->a + ai[row];
+    sum = 0.0;
+    PetscSparseDensePlusDot(sum,x,aa,aj,n);
+    y[row] = sum;
+  }
+  ierr = PetscLogFlops(2.0*a->nz - a->nonzerorowcnt);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultAdd_SeqAIJMixed(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqAIJ        *a  = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJMixed   *mx = (Mat_SeqAIJMixed*)A->spptr;
+  const PetscInt    *ai = a->i,*aj,*ridx = NULL;
+  const float       *aa;
+  const PetscScalar *x;
+  PetscScalar       *y,*z,sum;
+  PetscInt          m = A->rmap->n,i,n,row;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJMixed_Update(A);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  if (a->compressedrow.use) {
+    if (zz != yy) {ierr = PetscMemcpy(z,y,m*sizeof(PetscScalar));CHKERRQ(ierr);}
+    m    = a->compressedrow.nrows;
+    ridx = a->compressedrow.rindex;
+  }
+  for (i=0; i<m; i++) {
+    row = ridx ? ridx[i] : i;
+    n   = ai[row+1] - ai[row];
+    aj  = a->j + ai[row];
+    aa  = mx->a + ai[row];
+    sum = y[row];
+    PetscSparseDensePlusDot(sum,x,aa,aj,n);
+    z[row] = sum;
+  }
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   The same sweeps as MatSOR_SeqAIJ() with the single precision values; the inverse diagonal
+   is kept in double.  Eisenstat's trick and SOR_APPLY_UPPER are left to MatSOR_SeqAIJ().
+*/
+PetscErrorCode MatSOR_SeqAIJMixed(Mat A,Vec bb,PetscReal omega,MatSORType flag,PetscReal fshift,PetscInt its,PetscInt lits,Vec xx)
+{
+  Mat_SeqAIJ        *a  = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJMixed   *mx = (Mat_SeqAIJMixed*)A->spptr;
+  PetscScalar       *x,sum,*t;
+  const float       *v;
+  const MatScalar   *idiag,*mdiag;
+  const PetscScalar *b,*xb;
+  PetscErrorCode    ierr;
+  PetscInt          n,m = A->rmap->n,i;
+  const PetscInt    *idx,*diag;
+
+  PetscFunctionBegin;
+  if (flag == SOR_APPLY_UPPER || flag == SOR_APPLY_LOWER || (flag & SOR_EISENSTAT)) {
+    ierr = MatSOR_SeqAIJ(A,bb,omega,flag,fshift,its,lits,xx);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  its = its*lits;
+
+  if (fshift != a->fshift || omega != a->omega) a->idiagvalid = PETSC_FALSE; /* must recompute idiag[] */
+  if (!a->idiagvalid) {ierr = MatInvertDiagonal_SeqAIJ(A,omega,fshift);CHKERRQ(ierr);}
+  a->fshift = fshift;
+  a->omega  = omega;
+  ierr      = MatSeqAIJMixed_Update(A);CHKERRQ(ierr);
+
+  diag  = a->diag;
+  t     = a->ssor_work;
+  idiag = a->idiag;
+  mdiag = a->mdiag;
+
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  /* We count flops by assuming the upper triangular and lower triangular parts have the same number of nonzeros */
+  if (flag & SOR_ZERO_INITIAL_GUESS) {
+    if (flag & SOR_FORWARD_SWEEP || flag & SOR_LOCAL_FORWARD_SWEEP) {
+      for (i=0; i<m; i++) {
+        n   = diag[i] - a->i[i];
+        idx = a->j + a->i[i];
+        v   = mx->a + a->i[i];
+        sum = b[i];
+        PetscSparseDenseMinusDot(sum,x,v,idx,n);
+        t[i] = sum;
+        x[i] = sum*idiag[i];
+      }
+      xb   = t;
+      ierr = PetscLogFlops(a->nz);CHKERRQ(ierr);
+    } else xb = b;
+    if (flag & SOR_BACKWARD_SWEEP || flag & SOR_LOCAL_BACKWARD_SWEEP) {
+      for (i=m-1; i>=0; i--) {
+        n   = a->i[i+1] - diag[i] - 1;
+        idx = a->j + diag[i] + 1;
+        v   = mx->a + diag[i] + 1;
+        sum = xb[i];
+        PetscSparseDenseMinusDot(sum,x,v,idx,n);
+        if (xb == b) {
+          x[i] = sum*idiag[i];
+        } else {
+          x[i] = (1-omega)*x[i] + sum*idiag[i];  /* omega in idiag */
+        }
+      }
+      ierr = PetscLogFlops(a->nz);CHKERRQ(ierr); /* assumes 1/2 in upper */
+    }
+    its--;
+  }
+  while (its--) {
+    if (flag & SOR_FORWARD_SWEEP || flag & SOR_LOCAL_FORWARD_SWEEP) {
+      for (i=0; i<m; i++) {
+        /* lower */
+        n   = diag[i] - a->i[i];
+        idx = a->j + a->i[i];
+        v   = mx->a + a->i[i];
+        sum = b[i];
+        PetscSparseDenseMinusDot(sum,x,v,idx,n);
+        t[i] = sum;             /* save application of the lower-triangular part */
+        /* upper */
+        n   = a->i[i+1] - diag[i] - 1;
+        idx = a->j + diag[i] + 1;
+        v   = mx->a + diag[i] + 1;
+        PetscSparseDenseMinusDot(sum,x,v,idx,n);
+        x[i] = (1. - omega)*x[i] + sum*idiag[i]; /* omega in idiag */
+      }
+      xb   = t;
+      ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+    } else xb = b;
+    if (flag & SOR_BACKWARD_SWEEP || flag & SOR_LOCAL_BACKWARD_SWEEP) {
+      for (i=m-1; i>=0; i--) {
+        sum = xb[i];
+        if (xb == b) {
+          /* whole matrix (no checkpointing available) */
+          n   = a->i[i+1] - a->i[i];
+          idx = a->j + a->i[i];
+          v   = mx->a + a->i[i];
+          PetscSparseDenseMinusDot(sum,x,v,idx,n);
+          x[i] = (1. - omega)*x[i] + (sum + mdiag[i]*x[i])*idiag[i];
+        } else { /* lower-triangular part has been saved, so only apply upper-triangular */
+          n   = a->i[i+1] - diag[i] - 1;
+          idx = a->j + diag[i] + 1;
+          v   = mx->a + diag[i] + 1;
+          PetscSparseDenseMinusDot(sum,x,v,idx,n);
+          x[i] = (1. - omega)*x[i] + sum*idiag[i];  /* omega in idiag */
+        }
+      }
+      if (xb == b) {
+        ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+      } else {
+        ierr = PetscLogFlops(a->nz);CHKERRQ(ierr); /* assumes 1/2 in upper */
+      }
+    }
+  }
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* MatSolve_SeqAIJ_NaturalOrdering() with the single precision values of the factor */
+static PetscErrorCode MatSolve_SeqAIJMixed_NaturalOrdering(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqAIJ        *a  = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJMixed   *mx = (Mat_SeqAIJMixed*)A->spptr;
+  PetscErrorCode    ierr;
+  PetscInt          n   = A->rmap->n;
+  const PetscInt    *ai = a->i,*aj = a->j,*adiag = a->diag,*vi;
+  PetscScalar       *x,sum;
+  const PetscScalar *b;
+  const float       *v;
+  PetscInt          i,nz;
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+  ierr = MatSeqAIJMixed_Update(A);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+
+  /* forward solve the lower triangular */
+  x[0] = b[0];
+  v    = mx->a;
+  vi   = aj;
+  for (i=1; i<n; i++) {
+    nz  = ai[i+1] - ai[i];
+    sum = b[i];
+    PetscSparseDenseMinusDot(sum,x,v,vi,nz);
+    v   += nz;
+    vi  += nz;
+    x[i] = sum;
+  }
+
+  /* backward solve the upper triangular */
+  for (i=n-1; i>=0; i--) {
+    v   = mx->a + adiag[i+1] + 1;
+    vi  = aj + adiag[i+1] + 1;
+    nz  = adiag[i] - adiag[i+1]-1;
+    sum = x[i];
+    PetscSparseDenseMinusDot(sum,x,v,vi,nz);
+    x[i] = sum*v[nz]; /* x[i]=aa[adiag[i]]*sum; v++; */
+  }
+
+  ierr = PetscLogFlops(2.0*a->nz - A->cmap->n);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* MatSolve_SeqAIJ() with the single precision values of the factor */
+static PetscErrorCode MatSolve_SeqAIJMixed(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqAIJ        *a    = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJMixed   *mx   = (Mat_SeqAIJMixed*)A->spptr;
+  IS                iscol = a->col,isrow = a->row;
+  PetscErrorCode    ierr;
+  PetscInt          i,n=A->rmap->n,*vi,*ai=a->i,*aj=a->j,*adiag = a->diag,nz;
+  const PetscInt    *rout,*cout,*r,*c;
+  PetscScalar       *x,*tmp,sum;
+  const PetscScalar *b;
+  const float       *v;
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+  ierr = MatSeqAIJMixed_Update(A);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  tmp  = a->solve_work;
+
+  ierr = ISGetIndices(isrow,&rout);CHKERRQ(ierr); r = rout;
+  ierr = ISGetIndices(iscol,&cout);CHKERRQ(ierr); c = cout;
+
+  /* forward solve the lower triangular */
+  tmp[0] = b[r[0]];
+  v      = mx->a;
+  vi     = aj;
+  for (i=1; i<n; i++) {
+    nz  = ai[i+1] - ai[i];
+    sum = b[r[i]];
+    PetscSparseDenseMinusDot(sum,tmp,v,vi,nz);
+    tmp[i] = sum;
+    v     += nz; vi += nz;
+  }
+
+  /* backward solve the upper triangular */
+  for (i=n-1; i>=0; i--) {
+    v   = mx->a + adiag[i+1]+1;
+    vi  = aj + adiag[i+1]+1;
+    nz  = adiag[i]-adiag[i+1]-1;
+    sum = tmp[i];
+    PetscSparseDenseMinusDot(sum,tmp,v,vi,nz);
+    x[c[i]] = tmp[i] = sum*v[nz]; /* v[nz] = aa[adiag[i]] */
+  }
+
+  ierr = ISRestoreIndices(isrow,&rout);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(iscol,&cout);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2*a->nz - A->cmap->n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   The factorization itself is the AIJ one, in double precision; afterwards the solves of the
+   factor storage of MatLUFactorNumeric_SeqAIJ() are replaced.  Factors in any other format,
+   for example from -pc_factor_in_place or ILU with drop tolerances, keep their double solves.
+*/
+static PetscErrorCode MatLUFactorNumeric_SeqAIJMixed(Mat B,Mat A,const MatFactorInfo *info)
+{
+  Mat_SeqAIJMixed *mx = (Mat_SeqAIJMixed*)B->spptr;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = (*mx->lufactornumeric)(B,A,info);CHKERRQ(ierr);
+  if (B->ops->solve == MatSolve_SeqAIJ_NaturalOrdering) B->ops->solve = MatSolve_SeqAIJMixed_NaturalOrdering;
+  else if (B->ops->solve == MatSolve_SeqAIJ || B->ops->solve == MatSolve_SeqAIJ_Inode) B->ops->solve = MatSolve_SeqAIJMixed;
+  mx->state = -1;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatSeqAIJMixed_SetFactorNumeric(Mat B)
+{
+  Mat_SeqAIJMixed *mx = (Mat_SeqAIJMixed*)B->spptr;
+
+  PetscFunctionBegin;
+  if (B->ops->lufactornumeric != MatLUFactorNumeric_SeqAIJMixed) {
+    mx->lufactornumeric      = B->ops->lufactornumeric;
+    B->ops->lufactornumeric  = MatLUFactorNumeric_SeqAIJMixed;
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatLUFactorSymbolic_SeqAIJMixed(Mat B,Mat A,IS isrow,IS iscol,const MatFactorInfo *info)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatLUFactorSymbolic_SeqAIJ(B,A,isrow,iscol,info);CHKERRQ(ierr);
+  ierr = MatSeqAIJMixed_SetFactorNumeric(B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatILUFactorSymbolic_SeqAIJMixed(Mat B,Mat A,IS isrow,IS iscol,const MatFactorInfo *info)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatILUFactorSymbolic_SeqAIJ(B,A,isrow,iscol,info);CHKERRQ(ierr);
+  ierr = MatSeqAIJMixed_SetFactorNumeric(B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* LU and ILU factors are MATSEQAIJMIXED matrices as well; Cholesky and ICC factors are the double SBAIJ ones of MATSEQAIJ */
+PETSC_INTERN PetscErrorCode MatGetFactor_seqaijmixed_petsc(Mat A,MatFactorType ftype,Mat *B)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetFactor_seqaij_petsc(A,ftype,B);CHKERRQ(ierr);
+  if (ftype == MAT_FACTOR_LU || ftype == MAT_FACTOR_ILU) {
+    ierr = MatConvert_SeqAIJ_SeqAIJMixed(*B,MATSEQAIJMIXED,MAT_INPLACE_MATRIX,B);CHKERRQ(ierr);
+    (*B)->ops->lufactorsymbolic  = MatLUFactorSymbolic_SeqAIJMixed;
+    (*B)->ops->ilufactorsymbolic = MatILUFactorSymbolic_SeqAIJMixed;
+  }
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJMixed(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode  ierr;
+  Mat             B = *newmat;
+  Mat_SeqAIJMixed *mx;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  ierr      = PetscNewLog(B,&mx);CHKERRQ(ierr);
+  B->spptr  = (void*)mx;
+  mx->state = -1;
+
+  /* Set function pointers for methods that we inherit from AIJ but override. */
+  B->ops->duplicate   = MatDuplicate_SeqAIJMixed;
+  B->ops->assemblyend = MatAssemblyEnd_SeqAIJMixed;
+  B->ops->destroy     = MatDestroy_SeqAIJMixed;
+  B->ops->mult        = MatMult_SeqAIJMixed;
+  B->ops->multadd     = MatMultAdd_SeqAIJMixed;
+  B->ops->sor         = MatSOR_SeqAIJMixed;
+
+  /* inodes of an assembled matrix would otherwise keep being used in place of these kernels after the next assembly */
+  ((Mat_SeqAIJ*)B->data)->inode.use = PETSC_FALSE;
+
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaijmixed_seqaij_C",MatConvert_SeqAIJMixed_SeqAIJ);CHKERRQ(ierr);
+
+  ierr    = PetscObjectChangeTypeName((PetscObject)B,MATSEQAIJMIXED);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+/*@C
+   MatCreateSeqAIJMixed - Creates a sparse matrix of type SEQAIJMIXED.
+   This type inherits from AIJ, but its matrix-vector products, SOR sweeps
+   and LU/ILU triangular solves read a single precision copy of the values
+   while accumulating in double precision.  As with the AIJ type, it is
+   important to preallocate matrix storage in order to get good assembly
+   performance.
+
+   Collective on MPI_Comm
+
+   Input Parameters:
++  comm - MPI communicator, set to PETSC_COMM_SELF
+.  m - number of rows
+.  n - number of columns
+.  nz - number of nonzeros per row (same for all rows)
+-  nnz - array containing the number of nonzeros in the various rows (possibly different for each row) or NULL
+
+   Output Parameter:
+.  A - the matrix
+
+   Notes:
+   If nnz is given then nz is ignored
+
+   The values are set, stored and factored in double precision; the single precision copy adds
+   4 bytes per nonzero to the memory used by the matrix and is refreshed by the first product
+   after the values have changed.  The rounding of the values to single precision perturbs the
+   operator by a relative 1e-7, which is harmless for preconditioners such as the smoothers
+   and coarse operators of multigrid or the subdomain solves of ASM, but it limits the accuracy
+   of a Krylov method whose operator is of this type.  MatMultTranspose() uses the double values.
+
+   Level: intermediate
+
+.keywords: matrix, mixed precision, single precision, sparse
+
+.seealso: MatCreate(), MatCreateMPIAIJMixed(), MatSetValues(), MATSEQAIJMIXED
+@*/
+PetscErrorCode  MatCreateSeqAIJMixed(MPI_Comm comm,PetscInt m,PetscInt n,PetscInt nz,const PetscInt nnz[],Mat *A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreate(comm,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,m,n,m,n);CHKERRQ(ierr);
+  ierr = MatSetType(*A,MATSEQAIJMIXED);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation_SeqAIJ(*A,nz,nnz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   MATSEQAIJMIXED - MATSEQAIJMIXED = "seqaijmixed" - A sequential AIJ matrix whose matrix-vector
+   products, SOR sweeps and LU/ILU triangular solves read single precision values and accumulate
+   in double precision.
+
+   Options Database Keys:
+.  -mat_type seqaijmixed - sets the matrix type to "seqaijmixed" during a call to MatSetFromOptions()
+
+   Notes:
+   Only available for real double precision builds.  An existing preconditioner matrix can be
+   switched with MatConvert(P,MATAIJMIXED,MAT_INPLACE_MATRIX,&P).
+
+  Level: intermediate
+
+.seealso: MatCreateSeqAIJMixed(), MATAIJMIXED, MATSEQAIJPERM, MATSEQAIJSELL
+M*/
+
+PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJMixed(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSetType(A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatConvert_SeqAIJ_SeqAIJMixed(A,MATSEQAIJMIXED,MAT_INPLACE_MATRIX,&A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
@@ -0,0 +1,14 @@
+
+#if !defined(__AIJMIXED_H)
+#define __AIJMIXED_H
+
+#include <../src/mat/impls/aij/seq/aij.h>
+
+typedef struct {
+  float            *a;            /* single precision copy of the first nz entries of a->a */
+  PetscInt         maxnz;         /* length of a */
+  PetscObjectState state;         /* state of the matrix when a was copied */
+  PetscErrorCode   (*lufactornumeric)(Mat,Mat,const MatFactorInfo*); /* numeric factorization of the AIJ factor, for factor matrices */
+} Mat_SeqAIJMixed;
+
+#endif
@@ -0,0 +1,543 @@
+
+/*
+  Defines basic operations for the MATSEQAIJOMP matrix class.
+  This class is derived from the MATSEQAIJ class and retains the
+  compressed row storage; the matrix-vector products and the SOR
+  relaxation are performed by several OpenMP threads.
+
+  The rows are split into one part per requested thread so that each part
+  has about the same number of nonzeros.  OpenMP may create a smaller team,
+  so every thread loops over the parts p = t, t + size, ... of its thread
+  number t and the team size.  MatMultTranspose() lets each thread
+  scatter its rows into a private copy of the result, and the copies are
+  then summed, again in parallel, so that no two threads write the same
+  entry.  MatSOR() visits the rows in a multicolor ordering: rows of the
+  same color are not coupled, so they are relaxed simultaneously.
+*/
+
+#include <../src/mat/impls/aij/seq/aijomp/aijomp.h>
+#include <omp.h>
+
+/* nnz balanced split of the rows, of the compressed row format when it is in use */
+static PetscErrorCode MatSeqAIJOMP_BuildPartition(Mat A)
+{
+  Mat_SeqAIJ     *a   = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJOMP  *omp = (Mat_SeqAIJOMP*)A->spptr;
+  const PetscInt *ii  = a->compressedrow.use ? a->compressedrow.i : a->i;
+  PetscInt       m    = a->compressedrow.use ? a->compressedrow.nrows : A->rmap->n,t,r = 0;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree(omp->rowstart);CHKERRQ(ierr);
+  ierr = PetscMalloc1(omp->nthreads+1,&omp->rowstart);CHKERRQ(ierr);
+  for (t=0; t<omp->nthreads; t++) {
+    while (r < m && ii[r] - ii[0] < (PetscInt)(((double)t*(ii[m]-ii[0]))/omp->nthreads)) r++;
+    omp->rowstart[t] = r;
+  }
+  omp->rowstart[omp->nthreads] = m;
+  PetscFunctionReturn(0);
+}
+
+/*
+   Greedy coloring of the graph of A + A^T; the rows of one color do not reference each other,
+   so a Gauss-Seidel sweep can update all of them at the same time
+*/
+static PetscErrorCode MatSeqAIJOMP_BuildColoring(Mat A)
+{
+  Mat_SeqAIJ     *a   = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJOMP  *omp = (Mat_SeqAIJOMP*)A->spptr;
+  PetscInt       m    = A->rmap->n,i,k,c,*ti,*tj,*color,*mark,*cnt;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetSymbolicTranspose_SeqAIJ(A,&ti,&tj);CHKERRQ(ierr);
+  ierr = PetscMalloc3(m,&color,m+1,&mark,m+1,&cnt);CHKERRQ(ierr);
+  for (c=0; c<=m; c++) mark[c] = -1;
+  omp->ncolors = 0;
+  for (i=0; i<m; i++) {
+    for (k=a->i[i]; k<a->i[i+1]; k++) if (a->j[k] < i) mark[color[a->j[k]]] = i;
+    for (k=ti[i]; k<ti[i+1]; k++) if (tj[k] < i) mark[color[tj[k]]] = i;
+    for (c=0; mark[c] == i; c++) ;
+    color[i]     = c;
+    omp->ncolors = PetscMax(omp->ncolors,c+1);
+  }
+  ierr = MatRestoreSymbolicTranspose_SeqAIJ(A,&ti,&tj);CHKERRQ(ierr);
+
+  ierr = PetscMalloc2(omp->ncolors+1,&omp->colorptr,m,&omp->colorrows);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)A,(omp->ncolors+1+m)*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscMemzero(cnt,(omp->ncolors+1)*sizeof(PetscInt));CHKERRQ(ierr);
+  for (i=0; i<m; i++) cnt[color[i]+1]++;
+  for (c=0; c<omp->ncolors; c++) cnt[c+1] += cnt[c];
+  ierr = PetscMemcpy(omp->colorptr,cnt,(omp->ncolors+1)*sizeof(PetscInt));CHKERRQ(ierr);
+  for (i=0; i<m; i++) omp->colorrows[cnt[color[i]]++] = i;
+  ierr = PetscFree3(color,mark,cnt);CHKERRQ(ierr);
+  ierr = PetscInfo2(A,"%D colors for the multicolor SOR of %D rows\n",omp->ncolors,m);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatSeqAIJOMP_Reset(Mat A)
+{
+  Mat_SeqAIJOMP  *omp = (Mat_SeqAIJOMP*)A->spptr;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree(omp->rowstart);CHKERRQ(ierr);
+  ierr = PetscFree2(omp->colorptr,omp->colorrows);CHKERRQ(ierr);
+  ierr = PetscFree(omp->work);CHKERRQ(ierr);
+  omp->ncolors      = 0;
+  omp->nonzerostate = -1;
+  PetscFunctionReturn(0);
+}
+
+/* the partition and the coloring only depend on the nonzero structure */
+PETSC_STATIC_INLINE PetscErrorCode MatSeqAIJOMP_Update(Mat A)
+{
+  Mat_SeqAIJOMP  *omp = (Mat_SeqAIJOMP*)A->spptr;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (omp->nonzerostate != A->nonzerostate) {
+    ierr = MatSeqAIJOMP_Reset(A);CHKERRQ(ierr);
+    ierr = MatSeqAIJOMP_BuildPartition(A);CHKERRQ(ierr);
+    omp->nonzerostate = A->nonzerostate;
+  }
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJOMP_SeqAIJ(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  /* This routine is only called to convert a MATAIJOMP to its base PETSc type, */
+  /* so we will ignore 'MatType type'. */
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  /* Reset the original function pointers. */
+  B->ops->duplicate        = MatDuplicate_SeqAIJ;
+  B->ops->assemblyend      = MatAssemblyEnd_SeqAIJ;
+  B->ops->destroy          = MatDestroy_SeqAIJ;
+  B->ops->setfromoptions   = MatSetFromOptions_SeqAIJ;
+  B->ops->mult             = MatMult_SeqAIJ;
+  B->ops->multadd          = MatMultAdd_SeqAIJ;
+  B->ops->multtranspose    = MatMultTranspose_SeqAIJ;
+  B->ops->multtransposeadd = MatMultTransposeAdd_SeqAIJ;
+  B->ops->sor              = MatSOR_SeqAIJ;
+
+  ierr = MatSeqAIJOMP_Reset(B);CHKERRQ(ierr);
+  ierr = PetscFree(B->spptr);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaijomp_seqaij_C",NULL);CHKERRQ(ierr);
+
+  /* Change the type of B to MATSEQAIJ. */
+  ierr = PetscObjectChangeTypeName((PetscObject)B,MATSEQAIJ);CHKERRQ(ierr);
+
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatDestroy_SeqAIJOMP(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (A->spptr) {
+    ierr = MatSeqAIJOMP_Reset(A);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(A->spptr);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaijomp_seqaij_C",NULL);CHKERRQ(ierr);
+
+  /* Change the type of A back to SEQAIJ and use MatDestroy_SeqAIJ()
+   * to destroy everything that remains. */
+  ierr = PetscObjectChangeTypeName((PetscObject)A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatDestroy_SeqAIJ(A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatDuplicate_SeqAIJOMP(Mat A,MatDuplicateOption op,Mat *M)
+{
+  Mat_SeqAIJOMP  *omp = (Mat_SeqAIJOMP*)A->spptr;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatDuplicate_SeqAIJ(A,op,M);CHKERRQ(ierr);
+  ((Mat_SeqAIJOMP*)(*M)->spptr)->nthreads = omp->nthreads;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatAssemblyEnd_SeqAIJOMP(Mat A,MatAssemblyType mode)
+{
+  Mat_SeqAIJ     *a   = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJOMP  *omp = (Mat_SeqAIJOMP*)A->spptr;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (mode == MAT_FLUSH_ASSEMBLY) PetscFunctionReturn(0);
+
+  /* inodes would replace the multiply routines set by this class */
+  a->inode.use = PETSC_FALSE;
+  ierr         = MatAssemblyEnd_SeqAIJ(A,mode);CHKERRQ(ierr);
+
+  /* the compressed row format may have been turned on or off, and the columns renumbered by MatSetUpMultiply_MPIAIJ() */
+  omp->nonzerostate = -1;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatSetFromOptions_SeqAIJOMP(PetscOptionItems *PetscOptionsObject,Mat A)
+{
+  Mat_SeqAIJOMP  *omp     = (Mat_SeqAIJOMP*)A->spptr;
+  PetscInt       nthreads = omp->nthreads;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsHead(PetscOptionsObject,"SeqAIJOMP options");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-mat_aijomp_threads","Number of OpenMP threads used by the products and SOR","None",nthreads,&nthreads,NULL);CHKERRQ(ierr);
+  if (nthreads < 1) SETERRQ1(PetscObjectComm((PetscObject)A),PETSC_ERR_ARG_OUTOFRANGE,"Number of threads %D must be positive",nthreads);
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  if (nthreads != omp->nthreads) {
+    omp->nthreads     = nthreads;
+    omp->nonzerostate = -1;
+  }
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMult_SeqAIJOMP(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqAIJ        *a   = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJOMP     *omp = (Mat_SeqAIJOMP*)A->spptr;
+  const PetscInt    *ii,*ridx = a->compressedrow.use ? a->compressedrow.rindex : NULL;
+  const PetscScalar *x;
+  PetscScalar       *y;
+  PetscInt          m = A->rmap->n;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJOMP_Update(A);CHKERRQ(ierr);
+  ii   = ridx ? a->compressedrow.i : a->i;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+#pragma omp parallel num_threads(omp->nthreads)
+  {
+    PetscInt        p,i,n;
+    const PetscInt  *aj;
+    const MatScalar *aa;
+    PetscScalar     sum;
+
+    if (ridx) {
+#pragma omp for schedule(static)
+      for (i=0; i<m; i++) y[i] = 0.0;
+    }
+    for (p=omp_get_thread_num(); p<omp->nthreads; p+=omp_get_num_threads()) {
+      for (i=omp->rowstart[p]; i<omp->rowstart[p+1]; i++) {
+        n   = ii[i+1] - ii[i];
+        aj  = a->j + ii[i];
+        aa  = a->a + ii[i];
+        sum = 0.0;
+        PetscSparseDensePlusDot(sum,x,aa,aj,n);
+        y[ridx ? ridx[i] : i] = sum;
+      }
+    }
+  }
+  ierr = PetscLogFlops(2.0*a->nz - a->nonzerorowcnt);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultAdd_SeqAIJOMP(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqAIJ        *a   = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJOMP     *omp = (Mat_SeqAIJOMP*)A->spptr;
+  const PetscInt    *ii,*ridx = a->compressedrow.use ? a->compressedrow.rindex : NULL;
+  const PetscScalar *x;
+  PetscScalar       *y,*z;
+  PetscInt          m = A->rmap->n;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJOMP_Update(A);CHKERRQ(ierr);
+  ii   = ridx ? a->compressedrow.i : a->i;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+#pragma omp parallel num_threads(omp->nthreads)
+  {
+    PetscInt        p,i,n,row;
+    const PetscInt  *aj;
+    const MatScalar *aa;
+    PetscScalar     sum;
+
+    if (ridx && z != y) {
+#pragma omp for schedule(static)
+      for (i=0; i<m; i++) z[i] = y[i];
+    }
+    for (p=omp_get_thread_num(); p<omp->nthreads; p+=omp_get_num_threads()) {
+      for (i=omp->rowstart[p]; i<omp->rowstart[p+1]; i++) {
+        row = ridx ? ridx[i] : i;
+        n   = ii[i+1] - ii[i];
+        aj  = a->j + ii[i];
+        aa  = a->a + ii[i];
+        sum = y[row];
+        PetscSparseDensePlusDot(sum,x,aa,aj,n);
+        z[row] = sum;
+      }
+    }
+  }
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTransposeAdd_SeqAIJOMP(Mat A,Vec xx,Vec zz,Vec yy)
+{
+  Mat_SeqAIJ        *a   = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJOMP     *omp = (Mat_SeqAIJOMP*)A->spptr;
+  const PetscInt    *ii,*ridx = a->compressedrow.use ? a->compressedrow.rindex : NULL;
+  const PetscScalar *x;
+  PetscScalar       *y,*work;
+  PetscInt          n = A->cmap->n;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJOMP_Update(A);CHKERRQ(ierr);
+  if (!omp->work) {
+    ierr = PetscMalloc1(omp->nthreads*n,&omp->work);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)A,omp->nthreads*n*sizeof(PetscScalar));CHKERRQ(ierr);
+  }
+  work = omp->work;
+  ii   = ridx ? a->compressedrow.i : a->i;
+  if (zz != yy) {ierr = VecCopy(zz,yy);CHKERRQ(ierr);}
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+#pragma omp parallel num_threads(omp->nthreads)
+  {
+    PetscInt        t = omp_get_thread_num(),size = omp_get_num_threads(),p,i,j,k,nz;
+    PetscScalar     *w = work + t*n,alpha;
+    const PetscInt  *idx;
+    const MatScalar *v;
+
+    for (j=0; j<n; j++) w[j] = 0.0;
+    for (p=t; p<omp->nthreads; p+=size) {
+      for (i=omp->rowstart[p]; i<omp->rowstart[p+1]; i++) {
+        idx   = a->j + ii[i];
+        v     = a->a + ii[i];
+        nz    = ii[i+1] - ii[i];
+        alpha = x[ridx ? ridx[i] : i];
+        for (k=0; k<nz; k++) w[idx[k]] += alpha*v[k];
+      }
+    }
+#pragma omp barrier
+#pragma omp for schedule(static)
+    for (j=0; j<n; j++) {
+      for (k=0; k<size; k++) y[j] += work[k*n+j];
+    }
+  }
+  ierr = PetscLogFlops(2.0*a->nz + (omp->nthreads-1)*n);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTranspose_SeqAIJOMP(Mat A,Vec xx,Vec yy)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecSet(yy,0.0);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd_SeqAIJOMP(A,xx,yy,yy);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   Gauss-Seidel/SOR sweeps in the multicolor ordering.  The result does not depend on the
+   number of threads, but differs from MatSOR_SeqAIJ() since the rows are visited in another order.
+   Eisenstat's trick and the SOR_APPLY variants are passed on to MatSOR_SeqAIJ().
+*/
+PetscErrorCode MatSOR_SeqAIJOMP(Mat A,Vec bb,PetscReal omega,MatSORType flag,PetscReal fshift,PetscInt its,PetscInt lits,Vec xx)
+{
+  Mat_SeqAIJ        *a   = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJOMP     *omp = (Mat_SeqAIJOMP*)A->spptr;
+  const PetscScalar *b;
+  PetscScalar       *x;
+  PetscInt          m = A->rmap->n;
+  PetscBool         forward,backward;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (flag & (SOR_EISENSTAT | SOR_APPLY_UPPER | SOR_APPLY_LOWER)) {
+    ierr = MatSOR_SeqAIJ(A,bb,omega,flag,fshift,its,lits,xx);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = MatSeqAIJOMP_Update(A);CHKERRQ(ierr);
+  if (!omp->colorptr) {ierr = MatSeqAIJOMP_BuildColoring(A);CHKERRQ(ierr);}
+  if (fshift != a->fshift || omega != a->omega) a->idiagvalid = PETSC_FALSE;
+  if (!a->idiagvalid) {ierr = MatInvertDiagonal_SeqAIJ(A,omega,fshift);CHKERRQ(ierr);}
+  a->fshift = fshift;
+  a->omega  = omega;
+
+  forward  = (flag & (SOR_FORWARD_SWEEP | SOR_LOCAL_FORWARD_SWEEP)) ? PETSC_TRUE : PETSC_FALSE;
+  backward = (flag & (SOR_BACKWARD_SWEEP | SOR_LOCAL_BACKWARD_SWEEP)) ? PETSC_TRUE : PETSC_FALSE;
+  its      = its*lits;
+  if (flag & SOR_ZERO_INITIAL_GUESS) {ierr = VecSet(xx,0.0);CHKERRQ(ierr);}
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+#pragma omp parallel num_threads(omp->nthreads)
+  {
+    PetscInt        it,c,k,row,n;
+    const PetscInt  *aj;
+    const MatScalar *aa;
+    PetscScalar     sum;
+
+    for (it=0; it<its; it++) {
+      if (forward) {
+        for (c=0; c<omp->ncolors; c++) {
+#pragma omp for schedule(static)
+          for (k=omp->colorptr[c]; k<omp->colorptr[c+1]; k++) {
+            row = omp->colorrows[k];
+            n   = a->i[row+1] - a->i[row];
+            aj  = a->j + a->i[row];
+            aa  = a->a + a->i[row];
+            sum = b[row];
+            PetscSparseDenseMinusDot(sum,x,aa,aj,n);
+            sum   += a->mdiag[row]*x[row];
+            x[row] = (1.0 - omega)*x[row] + sum*a->idiag[row];
+          }
+        }
+      }
+      if (backward) {
+        for (c=omp->ncolors-1; c>=0; c--) {
+#pragma omp for schedule(static)
+          for (k=omp->colorptr[c]; k<omp->colorptr[c+1]; k++) {
+            row = omp->colorrows[k];
+            n   = a->i[row+1] - a->i[row];
+            aj  = a->j + a->i[row];
+            aa  = a->a + a->i[row];
+            sum = b[row];
+            PetscSparseDenseMinusDot(sum,x,aa,aj,n);
+            sum   += a->mdiag[row]*x[row];
+            x[row] = (1.0 - omega)*x[row] + sum*a->idiag[row];
+          }
+        }
+      }
+    }
+  }
+  ierr = PetscLogFlops(its*((forward ? 1 : 0) + (backward ? 1 : 0))*(2.0*a->nz + 4.0*m));CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJOMP(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+  Mat_SeqAIJOMP  *omp;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  ierr     = PetscNewLog(B,&omp);CHKERRQ(ierr);
+  B->spptr = (void*)omp;
+  omp->nthreads     = omp_get_max_threads();
+  omp->nonzerostate = -1;
+  ierr = PetscOptionsGetInt(((PetscObject)B)->options,((PetscObject)B)->prefix,"-mat_aijomp_threads",&omp->nthreads,NULL);CHKERRQ(ierr);
+  if (omp->nthreads < 1) SETERRQ1(PetscObjectComm((PetscObject)B),PETSC_ERR_ARG_OUTOFRANGE,"Number of threads %D must be positive",omp->nthreads);
+
+  /* Set function pointers for methods that we inherit from AIJ but override. */
+  B->ops->duplicate        = MatDuplicate_SeqAIJOMP;
+  B->ops->assemblyend      = MatAssemblyEnd_SeqAIJOMP;
+  B->ops->destroy          = MatDestroy_SeqAIJOMP;
+  B->ops->setfromoptions   = MatSetFromOptions_SeqAIJOMP;
+  B->ops->mult             = MatMult_SeqAIJOMP;
+  B->ops->multadd          = MatMultAdd_SeqAIJOMP;
+  B->ops->multtranspose    = MatMultTranspose_SeqAIJOMP;
+  B->ops->multtransposeadd = MatMultTransposeAdd_SeqAIJOMP;
+  B->ops->sor              = MatSOR_SeqAIJOMP;
+
+  /* inodes of an assembled matrix would otherwise keep being used in place of the threaded kernels after the next assembly */
+  ((Mat_SeqAIJ*)B->data)->inode.use = PETSC_FALSE;
+
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaijomp_seqaij_C",MatConvert_SeqAIJOMP_SeqAIJ);CHKERRQ(ierr);
+
+  ierr    = PetscObjectChangeTypeName((PetscObject)B,MATSEQAIJOMP);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+/*@C
+   MatCreateSeqAIJOMP - Creates a sparse matrix of type SEQAIJOMP.
+   This type inherits from AIJ and uses the same storage, but performs
+   its matrix-vector products and SOR relaxation with several OpenMP
+   threads.  As with the AIJ type, it is important to preallocate matrix
+   storage in order to get good assembly performance.
+
+   Collective on MPI_Comm
+
+   Input Parameters:
++  comm - MPI communicator, set to PETSC_COMM_SELF
+.  m - number of rows
+.  n - number of columns
+.  nz - number of nonzeros per row (same for all rows)
+-  nnz - array containing the number of nonzeros in the various rows
+         (possibly different for each row) or NULL
+
+   Output Parameter:
+.  A - the matrix
+
+   Options Database Keys:
+.  -mat_aijomp_threads <n> - number of threads, defaults to the OpenMP maximum (OMP_NUM_THREADS)
+
+   Notes:
+   If nnz is given then nz is ignored
+
+   MatSOR() relaxes the rows in a multicolor ordering, so that the rows of one color can be
+   updated simultaneously.  Its result does not depend on the number of threads, but is not the
+   same as that of the natural ordering used by MATSEQAIJ.
+
+   MatMultTranspose() keeps one work vector per thread, of the length of the columns.
+
+   Level: intermediate
+
+.keywords: matrix, openmp, threads, sparse
+
+.seealso: MatCreate(), MatCreateMPIAIJOMP(), MatSetValues(), MATSEQAIJOMP
+@*/
+PetscErrorCode  MatCreateSeqAIJOMP(MPI_Comm comm,PetscInt m,PetscInt n,PetscInt nz,const PetscInt nnz[],Mat *A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreate(comm,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,m,n,m,n);CHKERRQ(ierr);
+  ierr = MatSetType(*A,MATSEQAIJOMP);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation_SeqAIJ(*A,nz,nnz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   MATSEQAIJOMP - MATSEQAIJOMP = "seqaijomp" - A sequential AIJ matrix whose matrix-vector products
+   and SOR relaxation are performed by several OpenMP threads.  Requires PETSc to be configured
+   with --with-openmp.
+
+   Options Database Keys:
++  -mat_type seqaijomp - sets the matrix type to "seqaijomp" during a call to MatSetFromOptions()
+-  -mat_aijomp_threads <n> - number of threads
+
+  Level: intermediate
+
+.seealso: MatCreateSeqAIJOMP(), MATAIJOMP, MATSEQAIJPERM, MATSEQAIJSELL
+M*/
+
+PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJOMP(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSetType(A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatConvert_SeqAIJ_SeqAIJOMP(A,MATSEQAIJOMP,MAT_INPLACE_MATRIX,&A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
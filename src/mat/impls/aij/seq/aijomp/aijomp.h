@@ -0,0 +1,17 @@
+
+#if !defined(__AIJOMP_H)
+#define __AIJOMP_H
+
+#include <../src/mat/impls/aij/seq/aij.h>
+
+typedef struct {
+  PetscInt         nthreads;      /* number of OpenMP threads used by the kernels */
+  PetscInt         *rowstart;     /* thread t multiplies rows rowstart[t] to rowstart[t+1]-1 of the (possibly compressed) row format */
+  PetscInt         ncolors;       /* number of colors of the multicolor Gauss-Seidel ordering */
+  PetscInt         *colorptr;     /* rows of color c are colorrows[colorptr[c]] to colorrows[colorptr[c+1]-1] */
+  PetscInt         *colorrows;
+  PetscScalar      *work;         /* nthreads partial results of MatMultTranspose(), each of length A->cmap->n */
+  PetscObjectState nonzerostate;  /* nonzero state of the matrix when the partition and the coloring were built */
+} Mat_SeqAIJOMP;
+
+#endif
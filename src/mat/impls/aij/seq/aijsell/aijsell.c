@@ -0,0 +1,432 @@
+
+/*
+  Defines basic operations for the MATSEQAIJSELL matrix class.
+  This class is derived from the MATSEQAIJ class and retains the
+  compressed row storage, but keeps an additional copy of the matrix
+  in sliced ELLPACK (SELL-C-sigma) format that is used for the
+  matrix-vector products.
+
+  The rows are cut into slices of C = AIJSELL_SLICE_HEIGHT consecutive
+  rows, and each slice is stored column by column, padded with zeros to
+  the length of its longest row.  The multiply then works on C rows at
+  once with unit stride access to the values and column indices, which
+  maps directly onto SIMD registers.  To reduce the padding, the rows are
+  first sorted by decreasing length within windows of sigma rows.
+*/
+
+#include <../src/mat/impls/aij/seq/aijsell/aijsell.h>
+
+/*
+   Builds the sliced ELLPACK copy of the matrix, or only refreshes its values
+   if the nonzero structure has not changed since it was last built
+*/
+static PetscErrorCode MatSeqAIJSELL_Build(Mat A)
+{
+  Mat_SeqAIJ      *a    = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJSELL  *sell = (Mat_SeqAIJSELL*)A->spptr;
+  const PetscInt  *ai   = a->i,*aj = a->j,C = AIJSELL_SLICE_HEIGHT;
+  const MatScalar *aa   = a->a;
+  PetscInt        m     = A->rmap->n,s,r,c,k,row,len,width,nrows,pad,*keys;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  if (sell->nonzerostate != A->nonzerostate) {
+    ierr = PetscFree2(sell->sliidx,sell->rowperm);CHKERRQ(ierr);
+    ierr = PetscFree2(sell->colidx,sell->val);CHKERRQ(ierr);
+    sell->nslices = (m + C - 1)/C;
+    ierr = PetscMalloc2(sell->nslices+1,&sell->sliidx,m,&sell->rowperm);CHKERRQ(ierr);
+    for (k=0; k<m; k++) sell->rowperm[k] = k;
+    if (sell->sigma > 1) {
+      ierr = PetscMalloc1(m,&keys);CHKERRQ(ierr);
+      for (k=0; k<m; k++) keys[k] = ai[k] - ai[k+1];
+      for (k=0; k<m; k+=sell->sigma) {
+        ierr = PetscSortIntWithArray(PetscMin(sell->sigma,m-k),keys+k,sell->rowperm+k);CHKERRQ(ierr);
+      }
+      ierr = PetscFree(keys);CHKERRQ(ierr);
+    }
+    sell->sliidx[0] = 0;
+    for (s=0; s<sell->nslices; s++) {
+      nrows = PetscMin(C,m-s*C);
+      width = 0;
+      for (r=0; r<nrows; r++) {
+        row   = sell->rowperm[s*C+r];
+        width = PetscMax(width,ai[row+1]-ai[row]);
+      }
+      sell->sliidx[s+1] = sell->sliidx[s] + C*width;
+    }
+    ierr = PetscMalloc2(sell->sliidx[sell->nslices],&sell->colidx,sell->sliidx[sell->nslices],&sell->val);CHKERRQ(ierr);
+    ierr = PetscMemzero(sell->val,sell->sliidx[sell->nslices]*sizeof(MatScalar));CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)A,(sell->nslices+1+m)*sizeof(PetscInt)+sell->sliidx[sell->nslices]*(sizeof(PetscInt)+sizeof(MatScalar)));CHKERRQ(ierr);
+    for (s=0; s<sell->nslices; s++) {
+      nrows = PetscMin(C,m-s*C);
+      for (r=0; r<C; r++) {
+        /* padding repeats the last column of the row so that it does not touch new cache lines of x */
+        if (r < nrows) {
+          row = sell->rowperm[s*C+r];
+          len = ai[row+1] - ai[row];
+          pad = len ? aj[ai[row+1]-1] : 0;
+        } else {
+          row = 0; len = 0; pad = 0;
+        }
+        for (c=0,k=sell->sliidx[s]+r; k<sell->sliidx[s+1]; c++,k+=C) sell->colidx[k] = c < len ? aj[ai[row]+c] : pad;
+      }
+    }
+    sell->nonzerostate = A->nonzerostate;
+    ierr = PetscInfo3(A,"Sliced ELLPACK structure with %D slices and %D stored entries for %D nonzeros\n",sell->nslices,sell->sliidx[sell->nslices],ai[m]);CHKERRQ(ierr);
+  }
+  for (s=0; s<sell->nslices; s++) {
+    nrows = PetscMin(C,m-s*C);
+    for (r=0; r<nrows; r++) {
+      row = sell->rowperm[s*C+r];
+      len = ai[row+1] - ai[row];
+      for (c=0; c<len; c++) sell->val[sell->sliidx[s]+c*C+r] = aa[ai[row]+c];
+    }
+  }
+  sell->state = ((PetscObject)A)->state;
+  PetscFunctionReturn(0);
+}
+
+/* the copy is refreshed lazily so that matrices that are only assembled, or changed through MatScale() and friends, stay correct */
+PETSC_STATIC_INLINE PetscErrorCode MatSeqAIJSELL_Update(Mat A)
+{
+  Mat_SeqAIJSELL *sell = (Mat_SeqAIJSELL*)A->spptr;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (sell->state != ((PetscObject)A)->state || sell->nonzerostate != A->nonzerostate) {
+    ierr = MatSeqAIJSELL_Build(A);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatSeqAIJSELL_Reset(Mat A)
+{
+  Mat_SeqAIJSELL *sell = (Mat_SeqAIJSELL*)A->spptr;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree2(sell->sliidx,sell->rowperm);CHKERRQ(ierr);
+  ierr = PetscFree2(sell->colidx,sell->val);CHKERRQ(ierr);
+  sell->nslices      = 0;
+  sell->nonzerostate = -1;
+  sell->state        = -1;
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJSELL_SeqAIJ(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  /* This routine is only called to convert a MATAIJSELL to its base PETSc type, */
+  /* so we will ignore 'MatType type'. */
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  /* Reset the original function pointers. */
+  B->ops->duplicate        = MatDuplicate_SeqAIJ;
+  B->ops->assemblyend      = MatAssemblyEnd_SeqAIJ;
+  B->ops->destroy          = MatDestroy_SeqAIJ;
+  B->ops->setfromoptions   = MatSetFromOptions_SeqAIJ;
+  B->ops->mult             = MatMult_SeqAIJ;
+  B->ops->multadd          = MatMultAdd_SeqAIJ;
+  B->ops->multtranspose    = MatMultTranspose_SeqAIJ;
+  B->ops->multtransposeadd = MatMultTransposeAdd_SeqAIJ;
+
+  ierr = MatSeqAIJSELL_Reset(B);CHKERRQ(ierr);
+  ierr = PetscFree(B->spptr);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaijsell_seqaij_C",NULL);CHKERRQ(ierr);
+
+  /* Change the type of B to MATSEQAIJ. */
+  ierr = PetscObjectChangeTypeName((PetscObject)B,MATSEQAIJ);CHKERRQ(ierr);
+
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatDestroy_SeqAIJSELL(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (A->spptr) {
+    ierr = MatSeqAIJSELL_Reset(A);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(A->spptr);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaijsell_seqaij_C",NULL);CHKERRQ(ierr);
+
+  /* Change the type of A back to SEQAIJ and use MatDestroy_SeqAIJ()
+   * to destroy everything that remains. */
+  ierr = PetscObjectChangeTypeName((PetscObject)A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatDestroy_SeqAIJ(A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatDuplicate_SeqAIJSELL(Mat A,MatDuplicateOption op,Mat *M)
+{
+  Mat_SeqAIJSELL *sell = (Mat_SeqAIJSELL*)A->spptr;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  /* the new matrix is created with the type of A, so it gets its own, still empty, sliced copy that is built on first use */
+  ierr = MatDuplicate_SeqAIJ(A,op,M);CHKERRQ(ierr);
+  ((Mat_SeqAIJSELL*)(*M)->spptr)->sigma = sell->sigma;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatAssemblyEnd_SeqAIJSELL(Mat A,MatAssemblyType mode)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (mode == MAT_FLUSH_ASSEMBLY) PetscFunctionReturn(0);
+
+  /* inodes would replace the multiply routines set by this class; the sliced copy is refreshed on the next product */
+  a->inode.use = PETSC_FALSE;
+  ierr         = MatAssemblyEnd_SeqAIJ(A,mode);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatSetFromOptions_SeqAIJSELL(PetscOptionItems *PetscOptionsObject,Mat A)
+{
+  Mat_SeqAIJSELL *sell = (Mat_SeqAIJSELL*)A->spptr;
+  PetscInt       sigma = sell->sigma;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsHead(PetscOptionsObject,"SeqAIJSELL options");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-mat_aijsell_sigma","Number of rows sorted by length together, 1 disables sorting","None",sigma,&sigma,NULL);CHKERRQ(ierr);
+  if (sigma < 1) SETERRQ1(PetscObjectComm((PetscObject)A),PETSC_ERR_ARG_OUTOFRANGE,"Sorting window %D must be positive",sigma);
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  if (sigma != sell->sigma) {
+    sell->sigma        = sigma;
+    sell->nonzerostate = -1;
+  }
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMult_SeqAIJSELL(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqAIJ        *a    = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJSELL    *sell = (Mat_SeqAIJSELL*)A->spptr;
+  const PetscInt    C     = AIJSELL_SLICE_HEIGHT,*sliidx,*colidx,*rowperm;
+  const MatScalar   *val;
+  const PetscScalar *x;
+  PetscScalar       *y,sum[AIJSELL_SLICE_HEIGHT];
+  PetscInt          m = A->rmap->n,s,r,k,nrows;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr    = MatSeqAIJSELL_Update(A);CHKERRQ(ierr);
+  sliidx  = sell->sliidx;
+  colidx  = sell->colidx;
+  val     = sell->val;
+  rowperm = sell->rowperm;
+  ierr    = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr    = VecGetArray(yy,&y);CHKERRQ(ierr);
+  for (s=0; s<sell->nslices; s++) {
+    for (r=0; r<C; r++) sum[r] = 0.0;
+    for (k=sliidx[s]; k<sliidx[s+1]; k+=C) {
+      /* the compiler turns this fixed length loop into vector gathers and fused multiply-adds */
+      for (r=0; r<C; r++) sum[r] += val[k+r]*x[colidx[k+r]];
+    }
+    nrows = PetscMin(C,m-s*C);
+    for (r=0; r<nrows; r++) y[rowperm[s*C+r]] = sum[r];
+  }
+  ierr = PetscLogFlops(2.0*a->nz - a->nonzerorowcnt);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultAdd_SeqAIJSELL(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqAIJ        *a    = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJSELL    *sell = (Mat_SeqAIJSELL*)A->spptr;
+  const PetscInt    C     = AIJSELL_SLICE_HEIGHT,*sliidx,*colidx,*rowperm;
+  const MatScalar   *val;
+  const PetscScalar *x;
+  PetscScalar       *y,*z,sum[AIJSELL_SLICE_HEIGHT];
+  PetscInt          m = A->rmap->n,s,r,k,nrows;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr    = MatSeqAIJSELL_Update(A);CHKERRQ(ierr);
+  sliidx  = sell->sliidx;
+  colidx  = sell->colidx;
+  val     = sell->val;
+  rowperm = sell->rowperm;
+  ierr    = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr    = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  for (s=0; s<sell->nslices; s++) {
+    for (r=0; r<C; r++) sum[r] = 0.0;
+    for (k=sliidx[s]; k<sliidx[s+1]; k+=C) {
+      for (r=0; r<C; r++) sum[r] += val[k+r]*x[colidx[k+r]];
+    }
+    nrows = PetscMin(C,m-s*C);
+    for (r=0; r<nrows; r++) z[rowperm[s*C+r]] = y[rowperm[s*C+r]] + sum[r];
+  }
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTransposeAdd_SeqAIJSELL(Mat A,Vec xx,Vec zz,Vec yy)
+{
+  Mat_SeqAIJ        *a    = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJSELL    *sell = (Mat_SeqAIJSELL*)A->spptr;
+  const PetscInt    C     = AIJSELL_SLICE_HEIGHT,*sliidx,*colidx,*rowperm;
+  const MatScalar   *val;
+  const PetscScalar *x;
+  PetscScalar       *y,xs[AIJSELL_SLICE_HEIGHT];
+  PetscInt          m = A->rmap->n,s,r,k,nrows;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr    = MatSeqAIJSELL_Update(A);CHKERRQ(ierr);
+  sliidx  = sell->sliidx;
+  colidx  = sell->colidx;
+  val     = sell->val;
+  rowperm = sell->rowperm;
+  if (zz != yy) {ierr = VecCopy(zz,yy);CHKERRQ(ierr);}
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  for (s=0; s<sell->nslices; s++) {
+    nrows = PetscMin(C,m-s*C);
+    for (r=0; r<nrows; r++) xs[r] = x[rowperm[s*C+r]];
+    for (; r<C; r++) xs[r] = 0.0;
+    /* rows of a slice may share columns, so the scatter into y is done one entry at a time */
+    for (k=sliidx[s]; k<sliidx[s+1]; k+=C) {
+      for (r=0; r<C; r++) y[colidx[k+r]] += val[k+r]*xs[r];
+    }
+  }
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTranspose_SeqAIJSELL(Mat A,Vec xx,Vec yy)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecSet(yy,0.0);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd_SeqAIJSELL(A,xx,yy,yy);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJSELL(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+  Mat_SeqAIJSELL *sell;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  ierr     = PetscNewLog(B,&sell);CHKERRQ(ierr);
+  B->spptr = (void*)sell;
+  sell->sigma        = 8*AIJSELL_SLICE_HEIGHT;
+  sell->nonzerostate = -1;
+  sell->state        = -1;
+  ierr = PetscOptionsGetInt(((PetscObject)B)->options,((PetscObject)B)->prefix,"-mat_aijsell_sigma",&sell->sigma,NULL);CHKERRQ(ierr);
+  if (sell->sigma < 1) SETERRQ1(PetscObjectComm((PetscObject)B),PETSC_ERR_ARG_OUTOFRANGE,"Sorting window %D must be positive",sell->sigma);
+
+  /* Set function pointers for methods that we inherit from AIJ but override. */
+  B->ops->duplicate        = MatDuplicate_SeqAIJSELL;
+  B->ops->assemblyend      = MatAssemblyEnd_SeqAIJSELL;
+  B->ops->destroy          = MatDestroy_SeqAIJSELL;
+  B->ops->setfromoptions   = MatSetFromOptions_SeqAIJSELL;
+  B->ops->mult             = MatMult_SeqAIJSELL;
+  B->ops->multadd          = MatMultAdd_SeqAIJSELL;
+  B->ops->multtranspose    = MatMultTranspose_SeqAIJSELL;
+  B->ops->multtransposeadd = MatMultTransposeAdd_SeqAIJSELL;
+
+  /* inodes of an assembled matrix would otherwise keep being used in place of the sliced kernels after the next assembly */
+  ((Mat_SeqAIJ*)B->data)->inode.use = PETSC_FALSE;
+
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaijsell_seqaij_C",MatConvert_SeqAIJSELL_SeqAIJ);CHKERRQ(ierr);
+
+  ierr    = PetscObjectChangeTypeName((PetscObject)B,MATSEQAIJSELL);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+/*@C
+   MatCreateSeqAIJSELL - Creates a sparse matrix of type SEQAIJSELL.
+   This type inherits from AIJ, but keeps an additional copy of the matrix
+   in sliced ELLPACK (SELL-C-sigma) format, in which slices of consecutive
+   rows are stored column by column.  The matrix-vector products use this
+   copy and process a whole slice with SIMD instructions.  As with the AIJ
+   type, it is important to preallocate matrix storage in order to get good
+   assembly performance.
+
+   Collective on MPI_Comm
+
+   Input Parameters:
++  comm - MPI communicator, set to PETSC_COMM_SELF
+.  m - number of rows
+.  n - number of columns
+.  nz - number of nonzeros per row (same for all rows)
+-  nnz - array containing the number of nonzeros in the various rows
+         (possibly different for each row) or NULL
+
+   Output Parameter:
+.  A - the matrix
+
+   Options Database Keys:
+.  -mat_aijsell_sigma <sigma> - number of consecutive rows that are sorted by length to reduce the padding, 1 disables sorting
+
+   Notes:
+   If nnz is given then nz is ignored
+
+   The sliced copy roughly doubles the memory used by the matrix.  It is rebuilt
+   lazily by the first product after the matrix has changed.
+
+   Level: intermediate
+
+.keywords: matrix, sell, sliced ellpack, sparse, simd
+
+.seealso: MatCreate(), MatCreateMPIAIJSELL(), MatSetValues(), MATSEQAIJSELL
+@*/
+PetscErrorCode  MatCreateSeqAIJSELL(MPI_Comm comm,PetscInt m,PetscInt n,PetscInt nz,const PetscInt nnz[],Mat *A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreate(comm,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,m,n,m,n);CHKERRQ(ierr);
+  ierr = MatSetType(*A,MATSEQAIJSELL);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation_SeqAIJ(*A,nz,nnz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   MATSEQAIJSELL - MATSEQAIJSELL = "seqaijsell" - A sequential AIJ matrix that performs its
+   matrix-vector products with a sliced ELLPACK (SELL-C-sigma) copy of the matrix.
+
+   Options Database Keys:
++  -mat_type seqaijsell - sets the matrix type to "seqaijsell" during a call to MatSetFromOptions()
+-  -mat_aijsell_sigma <sigma> - number of consecutive rows that are sorted by length to reduce the padding
+
+  Level: intermediate
+
+.seealso: MatCreateSeqAIJSELL(), MATAIJSELL, MATSEQAIJPERM, MATSEQAIJCRL
+M*/
+
+PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJSELL(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSetType(A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatConvert_SeqAIJ_SeqAIJSELL(A,MATSEQAIJSELL,MAT_INPLACE_MATRIX,&A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
@@ -0,0 +1,21 @@
+
+#if !defined(__AIJSELL_H)
+#define __AIJSELL_H
+
+#include <../src/mat/impls/aij/seq/aij.h>
+
+/* number of rows in each slice; 8 double precision values fill one 512 bit vector register */
+#define AIJSELL_SLICE_HEIGHT 8
+
+typedef struct {
+  PetscInt         sigma;         /* rows are sorted by decreasing length within windows of sigma rows */
+  PetscInt         nslices;       /* number of slices, the last one may be partially filled */
+  PetscInt         *sliidx;       /* sliidx[s] is the start of slice s in colidx and val */
+  PetscInt         *colidx;       /* column indices, stored one column of the slice at a time */
+  MatScalar        *val;          /* values, stored as colidx; padding entries are zero */
+  PetscInt         *rowperm;      /* rowperm[k] is the row of the matrix stored in position k */
+  PetscObjectState nonzerostate;  /* nonzero state of the matrix when colidx was built */
+  PetscObjectState state;         /* object state of the matrix when val was filled */
+} Mat_SeqAIJSELL;
+
+#endif
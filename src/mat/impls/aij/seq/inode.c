@@ -394,6 +394,15 @@ static PetscErrorCode MatMult_SeqAIJ_Inode(Mat A,Vec xx,Vec yy)
   ns       = a->inode.size;     /* Node Size array */
   ierr     = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
   ierr     = VecGetArray(yy,&y);CHKERRQ(ierr);
+#if defined(PETSC_USE_AVX512_KERNELS)
+  if (MatSeqAIJUseAVX512) {
+    MatMult_SeqAIJ_Inode_AVX512(node_max,ns,a->i,a->j,a->a,x,NULL,y);
+    ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+    ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+    ierr = PetscLogFlops(2.0*a->nz - a->nonzerorowcnt);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
   idx      = a->j;
   v1       = a->a;
   ii       = a->i;
@@ -581,6 +590,15 @@ static PetscErrorCode MatMultAdd_SeqAIJ_Inode(Mat A,Vec xx,Vec zz,Vec yy)
 
   ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
   ierr = VecGetArrayPair(zz,yy,&z,&y);CHKERRQ(ierr);
+#if defined(PETSC_USE_AVX512_KERNELS)
+  if (MatSeqAIJUseAVX512) {
+    MatMult_SeqAIJ_Inode_AVX512(node_max,ns,a->i,a->j,a->a,x,z,y);
+    ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+    ierr = VecRestoreArrayPair(zz,yy,&z,&y);CHKERRQ(ierr);
+    ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
   zt = z;
 
   idx = a->j;
@@ -1845,6 +1863,7 @@ PetscErrorCode MatLUFactorNumeric_SeqAIJ_Inode(Mat B,Mat A,const MatFactorInfo *
   } else {
     C->ops->solve           = MatSolve_SeqAIJ;
   }
+  ierr = MatSeqAIJFactorSetUpSolveLevels(C,PETSC_FALSE);CHKERRQ(ierr);
   C->ops->solveadd          = MatSolveAdd_SeqAIJ;
   C->ops->solvetranspose    = MatSolveTranspose_SeqAIJ;
   C->ops->solvetransposeadd = MatSolveTransposeAdd_SeqAIJ;
@@ -4128,6 +4147,80 @@ PetscErrorCode MatSeqAIJCheckInode(Mat A)
   PetscFunctionReturn(0);
 }
 
+/*
+   MatSeqAIJCheckBlocks_Private - Removes from mask (bit bs for the block size bs) the block sizes
+   for which the nonzero pattern of A is not made of dense bs by bs blocks.  As with inodes the
+   rows of a block row must have identical column indices, in addition the columns must come in
+   runs of bs starting at a multiple of bs.  colmap[] gives the global column of each local column
+   when the alignment is with respect to the global numbering (the off-diagonal part of MPIAIJ),
+   it may be NULL.
+*/
+PetscErrorCode MatSeqAIJCheckBlocks_Private(Mat A,const PetscInt colmap[],PetscInt *mask)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+  PetscInt       bs,i,j,k,l,m = A->rmap->n,nz,col;
+  PetscBool      blocked;
+  const PetscInt *idx,*ii = a->i;
+
+  PetscFunctionBegin;
+  for (bs=2; bs<=MAT_DETECT_BLOCK_SIZE_MAX; bs++) {
+    if (!(*mask & ((PetscInt)1 << bs))) continue;
+    blocked = (PetscBool)!(m % bs);
+    for (i=0; blocked && i<m; i+=bs) {
+      nz  = ii[i+1] - ii[i];
+      idx = a->j + ii[i];
+      if (nz % bs) blocked = PETSC_FALSE;
+      for (j=i+1; blocked && j<i+bs; j++) {
+        if (ii[j+1] - ii[j] != nz) blocked = PETSC_FALSE;
+        else {
+          ierr = PetscMemcmp(idx,a->j+ii[j],nz*sizeof(PetscInt),&blocked);CHKERRQ(ierr);
+        }
+      }
+      for (k=0; blocked && k<nz; k+=bs) {
+        col = colmap ? colmap[idx[k]] : idx[k];
+        if (col % bs) blocked = PETSC_FALSE;
+        for (l=1; blocked && l<bs; l++) {
+          if ((colmap ? colmap[idx[k+l]] : idx[k+l]) != col+l) blocked = PETSC_FALSE;
+        }
+      }
+    }
+    if (!blocked) *mask &= ~((PetscInt)1 << bs);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   MatSeqAIJDetectBlockSize - Sets the block size of A to the largest one, up to
+   MAT_DETECT_BLOCK_SIZE_MAX, for which the nonzero pattern is made of dense blocks.
+   Used on the final assembly with -mat_detect_block_size.
+*/
+PetscErrorCode MatSeqAIJDetectBlockSize(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+  PetscInt       bs,mask = 0;
+
+  PetscFunctionBegin;
+  for (bs=2; bs<=MAT_DETECT_BLOCK_SIZE_MAX; bs++) {
+    if (!(A->rmap->n % bs) && !(A->cmap->n % bs)) mask |= (PetscInt)1 << bs;
+  }
+  if (A->rmap->n) {ierr = MatSeqAIJCheckBlocks_Private(A,NULL,&mask);CHKERRQ(ierr);}
+  else mask = 0;
+  for (bs=MAT_DETECT_BLOCK_SIZE_MAX; bs>1; bs--) {
+    if (mask & ((PetscInt)1 << bs)) break;
+  }
+  a->detectedbs = bs;
+  if (bs > 1) {
+    ierr = PetscLayoutSetBlockSize(A->rmap,bs);CHKERRQ(ierr);
+    ierr = PetscLayoutSetBlockSize(A->cmap,bs);CHKERRQ(ierr);
+    ierr = PetscInfo1(A,"Nonzero pattern is made of dense blocks of size %D, using it as the block size\n",bs);CHKERRQ(ierr);
+  } else {
+    ierr = PetscInfo(A,"No block structure found in the nonzero pattern\n");CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatDuplicate_SeqAIJ_Inode(Mat A,MatDuplicateOption cpvalues,Mat *C)
 {
   Mat            B =*C;
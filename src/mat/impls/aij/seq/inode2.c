@@ -21,6 +21,11 @@ PetscErrorCode MatView_SeqAIJ_Inode(Mat A,PetscViewer viewer)
       } else {
         ierr = PetscViewerASCIIPrintf(viewer,"not using I-node routines\n");CHKERRQ(ierr);
       }
+      if (a->detectedbs > 1) {
+        ierr = PetscViewerASCIIPrintf(viewer,"detected dense blocks of size %D in the nonzero structure\n",a->detectedbs);CHKERRQ(ierr);
+      } else if (a->detectedbs == 1) {
+        ierr = PetscViewerASCIIPrintf(viewer,"detected no block structure in the nonzero structure\n");CHKERRQ(ierr);
+      }
     }
   }
   PetscFunctionReturn(0);
@@ -9,8 +9,19 @@
 #include <petscbt.h>
 #include <petsc/private/isimpl.h>
 #include <../src/mat/impls/dense/seq/dense.h>
+#if defined(PETSC_HAVE_OPENMP)
+#include <omp.h>
+#endif
 
 static PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_LLCondensed(Mat,Mat,PetscReal,Mat*);
+static PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_Hash(Mat,Mat,PetscReal,PetscInt,Mat*);
+
+/*
+   with -matmatmult_via auto a row of A*B uses the dense accumulator when its number of products (multiply-adds) is at
+   least 1/MATMATMULT_DENSE_FRACTION of the number of columns of B; the products bound the number of distinct columns of
+   the row from above and, unlike them, are known before the symbolic phase
+*/
+#define MATMATMULT_DENSE_FRACTION 8
 
 #if defined(PETSC_HAVE_HYPRE)
 PETSC_INTERN PetscErrorCode MatMatMultSymbolic_AIJ_AIJ_wHYPRE(Mat,Mat,PetscReal,Mat*);
@@ -20,11 +31,11 @@ PETSC_INTERN PetscErrorCode MatMatMult_SeqAIJ_SeqAIJ(Mat A,Mat B,MatReuse scall,
 {
   PetscErrorCode ierr;
 #if !defined(PETSC_HAVE_HYPRE)
-  const char     *algTypes[6] = {"sorted","scalable","scalable_fast","heap","btheap","llcondensed"};
-  PetscInt       nalg = 6;
+  const char     *algTypes[8] = {"sorted","scalable","scalable_fast","heap","btheap","llcondensed","hash","auto"};
+  PetscInt       nalg = 8;
 #else
-  const char     *algTypes[7] = {"sorted","scalable","scalable_fast","heap","btheap","llcondensed","hypre"};
-  PetscInt       nalg = 7;
+  const char     *algTypes[9] = {"sorted","scalable","scalable_fast","heap","btheap","llcondensed","hash","auto","hypre"};
+  PetscInt       nalg = 9;
 #endif
   PetscInt       alg = 0; /* set default algorithm */
 
@@ -51,8 +62,15 @@ PETSC_INTERN PetscErrorCode MatMatMult_SeqAIJ_SeqAIJ(Mat A,Mat B,MatReuse scall,
     case 5:
       ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_LLCondensed(A,B,fill,C);CHKERRQ(ierr);
       break;
-#if defined(PETSC_HAVE_HYPRE)
     case 6:
+      ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_Hash(A,B,fill,PETSC_MAX_INT,C);CHKERRQ(ierr);
+      break;
+    case 7:
+      /* the hash accumulator for rows with few products, the dense one for rows with at least N(B)/MATMATMULT_DENSE_FRACTION */
+      ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_Hash(A,B,fill,B->cmap->N/MATMATMULT_DENSE_FRACTION,C);CHKERRQ(ierr);
+      break;
+#if defined(PETSC_HAVE_HYPRE)
+    case 8:
       ierr = MatMatMultSymbolic_AIJ_AIJ_wHYPRE(A,B,fill,C);CHKERRQ(ierr);
       break;
 #endif
@@ -156,7 +174,6 @@ static PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_LLCondensed(Mat A,Mat B,P
   if (afill < 1.0) afill = 1.0;
   c->maxnz                     = ci[am];
   c->nz                        = ci[am];
-  (*C)->info.mallocs           = ndouble;
   (*C)->info.fill_ratio_given  = fill;
   (*C)->info.fill_ratio_needed = afill;
 
@@ -377,7 +394,6 @@ PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_Scalable_fast(Mat A,Mat B,PetscR
   if (afill < 1.0) afill = 1.0;
   c->maxnz                     = ci[am];
   c->nz                        = ci[am];
-  (*C)->info.mallocs           = ndouble;
   (*C)->info.fill_ratio_given  = fill;
   (*C)->info.fill_ratio_needed = afill;
 
@@ -483,7 +499,6 @@ PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_Scalable(Mat A,Mat B,PetscReal f
   if (afill < 1.0) afill = 1.0;
   c->maxnz                     = ci[am];
   c->nz                        = ci[am];
-  (*C)->info.mallocs           = ndouble;
   (*C)->info.fill_ratio_given  = fill;
   (*C)->info.fill_ratio_needed = afill;
 
@@ -589,7 +604,6 @@ PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_Heap(Mat A,Mat B,PetscReal fill,
   if (afill < 1.0) afill = 1.0;
   c->maxnz                     = ci[am];
   c->nz                        = ci[am];
-  (*C)->info.mallocs           = ndouble;
   (*C)->info.fill_ratio_given  = fill;
   (*C)->info.fill_ratio_needed = afill;
 
@@ -709,7 +723,6 @@ PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_BTHeap(Mat A,Mat B,PetscReal fil
   if (afill < 1.0) afill = 1.0;
   c->maxnz                     = ci[am];
   c->nz                        = ci[am];
-  (*C)->info.mallocs           = ndouble;
   (*C)->info.fill_ratio_given  = fill;
   (*C)->info.fill_ratio_needed = afill;
 
@@ -797,7 +810,6 @@ PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ(Mat A,Mat B,PetscReal fill,Mat *
   if (afill < 1.0) afill = 1.0;
   c->maxnz                     = ci[am];
   c->nz                        = ci[am];
-  (*C)->info.mallocs           = ndouble;
   (*C)->info.fill_ratio_given  = fill;
   (*C)->info.fill_ratio_needed = afill;
 
@@ -812,6 +824,251 @@ PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ(Mat A,Mat B,PetscReal fill,Mat *
   PetscFunctionReturn(0);
 }
 
+/*
+   Row-wise hash accumulator.  Row i of C = A*B is accumulated in an open addressing table (linear probing)
+   whose size is the power of 2 that is at least twice the number of products in the row, so the work space is
+   O(max products per row) instead of O(columns of B) and it stays in cache when B has many columns.  Rows with at
+   least densethreshold products use the dense accumulator of MatMatMultSymbolic_SeqAIJ_SeqAIJ() instead; for the
+   same C both accumulators sum the products of each entry in the same order.
+*/
+#define MatMatMultHash_Private(col,mask) ((PetscInt)(((size_t)(col)*(size_t)2654435761U) & (size_t)(mask)))
+
+PETSC_STATIC_INLINE PetscInt MatMatMultHashSize_Private(PetscInt n)
+{
+  PetscInt size = 4;
+
+  while (size < 2*n) size *= 2;
+  return size;
+}
+
+/* number of products (multiply-adds) needed for row i of A*B */
+PETSC_STATIC_INLINE PetscInt MatMatMultRowProducts_Private(const Mat_SeqAIJ *a,const Mat_SeqAIJ *b,PetscInt i)
+{
+  const PetscInt *aj = a->j + a->i[i],anzi = a->i[i+1] - a->i[i];
+  PetscInt       j,nprod = 0;
+
+  for (j=0; j<anzi; j++) nprod += b->i[aj[j]+1] - b->i[aj[j]];
+  return nprod;
+}
+
+/* computes the values of row i of C; keys[] must be all negative on entry and is left so; returns the flops */
+PETSC_STATIC_INLINE PetscLogDouble MatMatMultNumericRow_Hash_Private(const Mat_SeqAIJ *a,const Mat_SeqAIJ *b,Mat_SeqAIJ *c,PetscInt i,PetscInt densethreshold,PetscInt *keys,PetscInt *pos,PetscScalar *dense)
+{
+  const PetscInt    *aj = a->j + a->i[i],anzi = a->i[i+1] - a->i[i],*cj = c->j + c->i[i],cnzi = c->i[i+1] - c->i[i];
+  const PetscScalar *aa = a->a + a->i[i];
+  PetscScalar       *ca = c->a + c->i[i],valtmp;
+  const PetscInt    *bjj;
+  const PetscScalar *baj;
+  PetscInt          j,k,h,col,bnzi,size,mask,nprod;
+
+  nprod = MatMatMultRowProducts_Private(a,b,i);
+  if (nprod >= densethreshold) {
+    for (j=0; j<anzi; j++) {
+      bnzi   = b->i[aj[j]+1] - b->i[aj[j]];
+      bjj    = b->j + b->i[aj[j]];
+      baj    = b->a + b->i[aj[j]];
+      valtmp = aa[j];
+      for (k=0; k<bnzi; k++) dense[bjj[k]] += valtmp*baj[k];
+    }
+    for (k=0; k<cnzi; k++) {
+      ca[k]        = dense[cj[k]];
+      dense[cj[k]] = 0.0;
+    }
+  } else {
+    size = MatMatMultHashSize_Private(cnzi);
+    mask = size - 1;
+    for (k=0; k<cnzi; k++) {
+      h = MatMatMultHash_Private(cj[k],mask);
+      while (keys[h] >= 0) h = (h+1) & mask;
+      keys[h] = cj[k];
+      pos[h]  = k;
+      ca[k]   = 0.0;
+    }
+    for (j=0; j<anzi; j++) {
+      bnzi   = b->i[aj[j]+1] - b->i[aj[j]];
+      bjj    = b->j + b->i[aj[j]];
+      baj    = b->a + b->i[aj[j]];
+      valtmp = aa[j];
+      for (k=0; k<bnzi; k++) {
+        col = bjj[k];
+        h   = MatMatMultHash_Private(col,mask);
+        while (keys[h] != col && keys[h] >= 0) h = (h+1) & mask;
+        if (keys[h] == col) ca[pos[h]] += valtmp*baj[k];
+      }
+    }
+    for (k=0; k<size; k++) keys[k] = -1;
+  }
+  return 2.0*nprod + cnzi;
+}
+
+static PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ_Hash(Mat A,Mat B,Mat C)
+{
+  PetscErrorCode     ierr;
+  PetscLogDouble     flops = 0.0;
+  Mat_SeqAIJ         *a = (Mat_SeqAIJ*)A->data,*b = (Mat_SeqAIJ*)B->data,*c = (Mat_SeqAIJ*)C->data;
+  Mat_MatMatMultHash *ab = c->abhash;
+  PetscInt           am = A->rmap->n,*ci = c->i,i;
+
+  PetscFunctionBegin;
+  if (!ab) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Missing the work space of the symbolic product");
+  if (!c->a) {
+    ierr      = PetscMalloc1(ci[am]+1,&c->a);CHKERRQ(ierr);
+    c->free_a = PETSC_TRUE;
+  }
+
+#if defined(PETSC_HAVE_OPENMP)
+  /* rows are independent; each thread accumulates in its own tables */
+#pragma omp parallel for schedule(dynamic,64) reduction(+:flops) num_threads(ab->nthreads)
+  for (i=0; i<am; i++) {
+    PetscInt t = omp_get_thread_num();
+    flops += MatMatMultNumericRow_Hash_Private(a,b,c,i,ab->densethreshold,ab->keys+t*ab->size,ab->pos+t*ab->size,ab->dense ? ab->dense+t*B->cmap->N : NULL);
+  }
+#else
+  for (i=0; i<am; i++) {
+    flops += MatMatMultNumericRow_Hash_Private(a,b,c,i,ab->densethreshold,ab->keys,ab->pos,ab->dense);
+  }
+#endif
+
+  ierr = MatAssemblyBegin(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = PetscLogFlops(flops);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* the hash accumulator for rows with fewer than densethreshold products, the dense one for the others */
+static PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_Hash(Mat A,Mat B,PetscReal fill,PetscInt densethreshold,Mat *C)
+{
+  PetscErrorCode     ierr;
+  Mat_SeqAIJ         *a  = (Mat_SeqAIJ*)A->data,*b=(Mat_SeqAIJ*)B->data,*c;
+  Mat_MatMatMultHash *ab;
+  const PetscInt     *ai = a->i,*bi=b->i,*aj=a->j,*bj=b->j;
+  PetscInt           *ci,*cj,*keys = NULL,*nprod;
+  PetscInt           am=A->rmap->N,bn=B->cmap->N,bm=B->rmap->N;
+  PetscReal          afill;
+  PetscInt           i,j,k,h,size,mask,hmax = 0,ndense = 0,cmax = 0;
+  PetscSegBuffer     seg,segrow;
+  char               *seen = NULL;
+
+  PetscFunctionBegin;
+  ierr  = PetscMalloc1(am+1,&ci);CHKERRQ(ierr);
+  ierr  = PetscMalloc1(am,&nprod);CHKERRQ(ierr);
+  ci[0] = 0;
+
+  /* estimate the size of each row of C by its number of products, choose the accumulator of each row */
+  for (i=0; i<am; i++) {
+    nprod[i] = MatMatMultRowProducts_Private(a,b,i);
+    if (nprod[i] >= densethreshold) ndense++;
+    else hmax = PetscMax(hmax,PetscMin(nprod[i],bn));
+  }
+  if (ndense) {
+    ierr = PetscCalloc1(bn,&seen);CHKERRQ(ierr);
+  }
+  if (ndense < am) {
+    size = MatMatMultHashSize_Private(hmax);
+    ierr = PetscMalloc1(size,&keys);CHKERRQ(ierr);
+    for (k=0; k<size; k++) keys[k] = -1;
+  }
+
+  /* Initial FreeSpace size is fill*(nnz(A)+nnz(B)) */
+  ierr = PetscSegBufferCreate(sizeof(PetscInt),(PetscInt)(fill*(ai[am]+bi[bm])),&seg);CHKERRQ(ierr);
+  ierr = PetscSegBufferCreate(sizeof(PetscInt),100,&segrow);CHKERRQ(ierr);
+
+  /* Determine ci and cj */
+  for (i=0; i<am; i++) {
+    const PetscInt anzi  = ai[i+1] - ai[i];
+    const PetscInt *acol = aj + ai[i];
+    PetscInt       packlen = 0,*PETSC_RESTRICT crow;
+    PetscBool      usedense = (PetscBool)(nprod[i] >= densethreshold);
+
+    size = MatMatMultHashSize_Private(PetscMin(nprod[i],bn));
+    mask = size - 1;
+    for (j=0; j<anzi; j++) {
+      PetscInt brow = acol[j],bjstart = bi[brow],bjend = bi[brow+1];
+      for (k=bjstart; k<bjend; k++) {
+        PetscInt bcol = bj[k];
+        if (usedense) {
+          if (seen[bcol]) continue;
+          seen[bcol] = 1;
+        } else {
+          h = MatMatMultHash_Private(bcol,mask);
+          while (keys[h] >= 0 && keys[h] != bcol) h = (h+1) & mask;
+          if (keys[h] == bcol) continue;
+          keys[h] = bcol;
+        }
+        {
+          PetscInt *PETSC_RESTRICT slot;
+          ierr = PetscSegBufferGetInts(segrow,1,&slot);CHKERRQ(ierr);
+          *slot = bcol;
+          packlen++;
+        }
+      }
+    }
+    ierr = PetscSegBufferGetInts(seg,packlen,&crow);CHKERRQ(ierr);
+    ierr = PetscSegBufferExtractTo(segrow,crow);CHKERRQ(ierr);
+    ierr = PetscSortInt(packlen,crow);CHKERRQ(ierr);
+    ci[i+1] = ci[i] + packlen;
+    if (usedense) {
+      for (j=0; j<packlen; j++) seen[crow[j]] = 0;
+    } else {
+      for (k=0; k<size; k++) keys[k] = -1;
+      cmax = PetscMax(cmax,packlen);
+    }
+  }
+  ierr = PetscSegBufferDestroy(&segrow);CHKERRQ(ierr);
+  ierr = PetscFree(seen);CHKERRQ(ierr);
+  ierr = PetscFree(keys);CHKERRQ(ierr);
+  ierr = PetscFree(nprod);CHKERRQ(ierr);
+
+  /* Column indices are in the segmented buffer */
+  ierr = PetscSegBufferExtractAlloc(seg,&cj);CHKERRQ(ierr);
+  ierr = PetscSegBufferDestroy(&seg);CHKERRQ(ierr);
+
+  /* put together the new symbolic matrix */
+  ierr = MatCreateSeqAIJWithArrays(PetscObjectComm((PetscObject)A),am,bn,ci,cj,NULL,C);CHKERRQ(ierr);
+  ierr = MatSetBlockSizesFromMats(*C,A,B);CHKERRQ(ierr);
+
+  /* MatCreateSeqAIJWithArrays flags matrix so PETSc doesn't free the user's arrays. */
+  /* These are PETSc arrays, so change flags so arrays can be deleted by PETSc */
+  c          = (Mat_SeqAIJ*)((*C)->data);
+  c->free_a  = PETSC_TRUE;
+  c->free_ij = PETSC_TRUE;
+  c->nonew   = 0;
+
+  /* work space of the numeric phase: a hash table for the longest hash row of C and a dense row for each thread */
+  ierr = PetscNew(&c->abhash);CHKERRQ(ierr);
+  ab                 = c->abhash;
+  ab->densethreshold = densethreshold;
+  ab->nthreads       = 1;
+#if defined(PETSC_HAVE_OPENMP)
+  ab->nthreads       = omp_get_max_threads();
+#endif
+  ab->size           = MatMatMultHashSize_Private(cmax);
+  ierr = PetscMalloc2(ab->nthreads*ab->size,&ab->keys,ab->nthreads*ab->size,&ab->pos);CHKERRQ(ierr);
+  for (k=0; k<ab->nthreads*ab->size; k++) ab->keys[k] = -1;
+  if (ndense) {ierr = PetscCalloc1(ab->nthreads*bn,&ab->dense);CHKERRQ(ierr);}
+
+  (*C)->ops->matmultnumeric = MatMatMultNumeric_SeqAIJ_SeqAIJ_Hash;
+
+  /* set MatInfo */
+  afill = (PetscReal)ci[am]/(ai[am]+bi[bm]) + 1.e-5;
+  if (afill < 1.0) afill = 1.0;
+  c->maxnz                     = ci[am];
+  c->nz                        = ci[am];
+  (*C)->info.fill_ratio_given  = fill;
+  (*C)->info.fill_ratio_needed = afill;
+
+#if defined(PETSC_USE_INFO)
+  ierr = PetscInfo3((*C),"%D of %D rows use the dense accumulator, the others a hash table of at most %D entries\n",ndense,am,MatMatMultHashSize_Private(hmax));CHKERRQ(ierr);
+  if (ci[am]) {
+    ierr = PetscInfo2((*C),"Fill ratio: given %g needed %g.\n",(double)fill,(double)afill);CHKERRQ(ierr);
+    ierr = PetscInfo1((*C),"Use MatMatMult(A,B,MatReuse,%g,&C) for best performance.;\n",(double)afill);CHKERRQ(ierr);
+  } else {
+    ierr = PetscInfo((*C),"Empty matrix product\n");CHKERRQ(ierr);
+  }
+#endif
+  PetscFunctionReturn(0);
+}
+
 /* This routine is not used. Should be removed! */
 PetscErrorCode MatMatTransposeMult_SeqAIJ_SeqAIJ(Mat A,Mat B,MatReuse scall,PetscReal fill,Mat *C)
 {
@@ -1109,62 +1366,94 @@ PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqDense(Mat A,Mat B,PetscReal fill,Mat
   PetscFunctionReturn(0);
 }
 
-PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqDense(Mat A,Mat B,Mat C)
+/* number of columns of the dense matrices processed together by the sparse times dense kernels */
+#define MAT_SPMM_NB 8
+
+/*
+   C = A*B, or C += A*B when add is set, for SeqAIJ A and column-major dense B and C with leading dimensions ldb and ldc.
+
+   The columns of B are processed in slabs of MAT_SPMM_NB; each slab is first copied to row-major (interleaved)
+   storage so that every nonzero of A multiplies a contiguous row of the slab, which keeps the partial sums of the
+   row of C in registers and streams A once per slab instead of once per column.
+*/
+static PetscErrorCode MatMatMultKernel_SeqAIJ_SeqDense(Mat A,const PetscScalar *b,PetscInt ldb,PetscScalar *c,PetscInt ldc,PetscInt cn,PetscBool add)
 {
-  Mat_SeqAIJ        *a=(Mat_SeqAIJ*)A->data;
-  Mat_SeqDense      *bd = (Mat_SeqDense*)B->data;
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscInt          am = A->rmap->n,an = A->cmap->n,m,col,nb,i,j,k,t,n,row;
+  const PetscInt    *ii,*ridx = NULL,*aj;
+  const MatScalar   *aa;
+  const PetscScalar *bj;
+  PetscScalar       *bt,r[MAT_SPMM_NB],*ci,v;
   PetscErrorCode    ierr;
-  PetscScalar       *c,*b,r1,r2,r3,r4,*c1,*c2,*c3,*c4,aatmp;
-  const PetscScalar *aa,*b1,*b2,*b3,*b4;
-  const PetscInt    *aj;
-  PetscInt          cm=C->rmap->n,cn=B->cmap->n,bm=bd->lda,am=A->rmap->n;
-  PetscInt          am4=4*am,bm4=4*bm,col,i,j,n,ajtmp;
 
   PetscFunctionBegin;
-  if (!cm || !cn) PetscFunctionReturn(0);
-  if (B->rmap->n != A->cmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Number columns in A %D not equal rows in B %D\n",A->cmap->n,B->rmap->n);
-  if (A->rmap->n != C->rmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Number rows in C %D not equal rows in A %D\n",C->rmap->n,A->rmap->n);
-  if (B->cmap->n != C->cmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Number columns in B %D not equal columns in C %D\n",B->cmap->n,C->cmap->n);
-  b = bd->v;
-  ierr = MatDenseGetArray(C,&c);CHKERRQ(ierr);
-  b1 = b; b2 = b1 + bm; b3 = b2 + bm; b4 = b3 + bm;
-  c1 = c; c2 = c1 + am; c3 = c2 + am; c4 = c3 + am;
-  for (col=0; col<cn-4; col += 4) {  /* over columns of C */
-    for (i=0; i<am; i++) {        /* over rows of C in those columns */
-      r1 = r2 = r3 = r4 = 0.0;
-      n  = a->i[i+1] - a->i[i];
-      aj = a->j + a->i[i];
-      aa = a->a + a->i[i];
-      for (j=0; j<n; j++) {
-        aatmp = aa[j]; ajtmp = aj[j]; 
-        r1 += aatmp*b1[ajtmp]; 
-        r2 += aatmp*b2[ajtmp]; 
-        r3 += aatmp*b3[ajtmp]; 
-        r4 += aatmp*b4[ajtmp];
-      }
-      c1[i] = r1;
-      c2[i] = r2;
-      c3[i] = r3;
-      c4[i] = r4;
+  if (a->compressedrow.use) {
+    /* rows of A without nonzeros are skipped, so the corresponding entries of C must be zeroed first */
+    if (!add) {
+      for (col=0; col<cn; col++) {ierr = PetscMemzero(c+col*ldc,am*sizeof(PetscScalar));CHKERRQ(ierr);}
+      add = PETSC_TRUE;
     }
-    b1 += bm4; b2 += bm4; b3 += bm4; b4 += bm4;
-    c1 += am4; c2 += am4; c3 += am4; c4 += am4;
+    m    = a->compressedrow.nrows;
+    ii   = a->compressedrow.i;
+    ridx = a->compressedrow.rindex;
+  } else {
+    m  = am;
+    ii = a->i;
   }
-  for (; col<cn; col++) {   /* over extra columns of C */
-    for (i=0; i<am; i++) {  /* over rows of C in those columns */
-      r1 = 0.0;
-      n  = a->i[i+1] - a->i[i];
-      aj = a->j + a->i[i];
-      aa = a->a + a->i[i];
-      for (j=0; j<n; j++) {
-        r1 += aa[j]*b1[aj[j]]; 
+  ierr = PetscMalloc1(an*PetscMin(cn,MAT_SPMM_NB),&bt);CHKERRQ(ierr);
+  for (col=0; col<cn; col+=nb) {
+    nb = PetscMin(MAT_SPMM_NB,cn-col);
+    for (t=0; t<nb; t++) {
+      bj = b + (col+t)*ldb;
+      for (j=0; j<an; j++) bt[j*nb+t] = bj[j];
+    }
+    for (i=0; i<m; i++) {
+      n   = ii[i+1] - ii[i];
+      aj  = a->j + ii[i];
+      aa  = a->a + ii[i];
+      row = ridx ? ridx[i] : i;
+      if (nb == MAT_SPMM_NB) {
+        for (t=0; t<MAT_SPMM_NB; t++) r[t] = 0.0;
+        for (k=0; k<n; k++) {
+          v  = aa[k];
+          bj = bt + aj[k]*MAT_SPMM_NB;
+          for (t=0; t<MAT_SPMM_NB; t++) r[t] += v*bj[t];
+        }
+      } else {
+        for (t=0; t<nb; t++) r[t] = 0.0;
+        for (k=0; k<n; k++) {
+          v  = aa[k];
+          bj = bt + aj[k]*nb;
+          for (t=0; t<nb; t++) r[t] += v*bj[t];
+        }
+      }
+      ci = c + col*ldc + row;
+      if (add) {
+        for (t=0; t<nb; t++) ci[t*ldc] += r[t];
+      } else {
+        for (t=0; t<nb; t++) ci[t*ldc] = r[t];
       }
-      c1[i] = r1;
     }
-    b1 += bm; 
-    c1 += am;
   }
+  ierr = PetscFree(bt);CHKERRQ(ierr);
   ierr = PetscLogFlops(cn*(2.0*a->nz));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqDense(Mat A,Mat B,Mat C)
+{
+  Mat_SeqDense   *bd = (Mat_SeqDense*)B->data,*cd = (Mat_SeqDense*)C->data;
+  PetscErrorCode ierr;
+  PetscScalar    *c;
+  PetscInt       cm=C->rmap->n,cn=B->cmap->n;
+
+  PetscFunctionBegin;
+  if (!cm || !cn) PetscFunctionReturn(0);
+  if (B->rmap->n != A->cmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Number columns in A %D not equal rows in B %D\n",A->cmap->n,B->rmap->n);
+  if (A->rmap->n != C->rmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Number rows in C %D not equal rows in A %D\n",C->rmap->n,A->rmap->n);
+  if (B->cmap->n != C->cmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Number columns in B %D not equal columns in C %D\n",B->cmap->n,C->cmap->n);
+  ierr = MatDenseGetArray(C,&c);CHKERRQ(ierr);
+  ierr = MatMatMultKernel_SeqAIJ_SeqDense(A,bd->v,bd->lda,c,cd->lda,cn,PETSC_FALSE);CHKERRQ(ierr);
   ierr = MatDenseRestoreArray(C,&c);CHKERRQ(ierr);
   ierr = MatAssemblyBegin(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
   ierr = MatAssemblyEnd(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
@@ -1172,110 +1461,19 @@ PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqDense(Mat A,Mat B,Mat C)
 }
 
 /*
-   Note very similar to MatMult_SeqAIJ(), should generate both codes from same base
+   C += A*B, used for the off-diagonal part of MatMatMult_MPIAIJ_MPIDense()
 */
 PetscErrorCode MatMatMultNumericAdd_SeqAIJ_SeqDense(Mat A,Mat B,Mat C)
 {
-  Mat_SeqAIJ     *a=(Mat_SeqAIJ*)A->data;
-  Mat_SeqDense   *bd = (Mat_SeqDense*)B->data;
+  Mat_SeqDense   *bd = (Mat_SeqDense*)B->data,*cd = (Mat_SeqDense*)C->data;
   PetscErrorCode ierr;
-  PetscScalar    *b,*c,r1,r2,r3,r4,*b1,*b2,*b3,*b4;
-  MatScalar      *aa;
-  PetscInt       cm  = C->rmap->n, cn=B->cmap->n, bm=bd->lda, col, i,j,n,*aj, am = A->rmap->n,*ii,arm;
-  PetscInt       am2 = 2*am, am3 = 3*am,  bm4 = 4*bm,colam,*ridx;
+  PetscScalar    *c;
+  PetscInt       cm=C->rmap->n,cn=B->cmap->n;
 
   PetscFunctionBegin;
   if (!cm || !cn) PetscFunctionReturn(0);
-  b = bd->v;
   ierr = MatDenseGetArray(C,&c);CHKERRQ(ierr);
-  b1   = b; b2 = b1 + bm; b3 = b2 + bm; b4 = b3 + bm;
-
-  if (a->compressedrow.use) { /* use compressed row format */
-    for (col=0; col<cn-4; col += 4) {  /* over columns of C */
-      colam = col*am;
-      arm   = a->compressedrow.nrows;
-      ii    = a->compressedrow.i;
-      ridx  = a->compressedrow.rindex;
-      for (i=0; i<arm; i++) {        /* over rows of C in those columns */
-        r1 = r2 = r3 = r4 = 0.0;
-        n  = ii[i+1] - ii[i];
-        aj = a->j + ii[i];
-        aa = a->a + ii[i];
-        for (j=0; j<n; j++) {
-          r1 += (*aa)*b1[*aj];
-          r2 += (*aa)*b2[*aj];
-          r3 += (*aa)*b3[*aj];
-          r4 += (*aa++)*b4[*aj++];
-        }
-        c[colam       + ridx[i]] += r1;
-        c[colam + am  + ridx[i]] += r2;
-        c[colam + am2 + ridx[i]] += r3;
-        c[colam + am3 + ridx[i]] += r4;
-      }
-      b1 += bm4;
-      b2 += bm4;
-      b3 += bm4;
-      b4 += bm4;
-    }
-    for (; col<cn; col++) {     /* over extra columns of C */
-      colam = col*am;
-      arm   = a->compressedrow.nrows;
-      ii    = a->compressedrow.i;
-      ridx  = a->compressedrow.rindex;
-      for (i=0; i<arm; i++) {  /* over rows of C in those columns */
-        r1 = 0.0;
-        n  = ii[i+1] - ii[i];
-        aj = a->j + ii[i];
-        aa = a->a + ii[i];
-
-        for (j=0; j<n; j++) {
-          r1 += (*aa++)*b1[*aj++];
-        }
-        c[colam + ridx[i]] += r1;
-      }
-      b1 += bm;
-    }
-  } else {
-    for (col=0; col<cn-4; col += 4) {  /* over columns of C */
-      colam = col*am;
-      for (i=0; i<am; i++) {        /* over rows of C in those columns */
-        r1 = r2 = r3 = r4 = 0.0;
-        n  = a->i[i+1] - a->i[i];
-        aj = a->j + a->i[i];
-        aa = a->a + a->i[i];
-        for (j=0; j<n; j++) {
-          r1 += (*aa)*b1[*aj];
-          r2 += (*aa)*b2[*aj];
-          r3 += (*aa)*b3[*aj];
-          r4 += (*aa++)*b4[*aj++];
-        }
-        c[colam + i]       += r1;
-        c[colam + am + i]  += r2;
-        c[colam + am2 + i] += r3;
-        c[colam + am3 + i] += r4;
-      }
-      b1 += bm4;
-      b2 += bm4;
-      b3 += bm4;
-      b4 += bm4;
-    }
-    for (; col<cn; col++) {     /* over extra columns of C */
-      colam = col*am;
-      for (i=0; i<am; i++) {  /* over rows of C in those columns */
-        r1 = 0.0;
-        n  = a->i[i+1] - a->i[i];
-        aj = a->j + a->i[i];
-        aa = a->a + a->i[i];
-
-        for (j=0; j<n; j++) {
-          r1 += (*aa++)*b1[*aj++];
-        }
-        c[colam + i] += r1;
-      }
-      b1 += bm;
-    }
-  }
-  ierr = PetscLogFlops(cn*2.0*a->nz);CHKERRQ(ierr);
+  ierr = MatMatMultKernel_SeqAIJ_SeqDense(A,bd->v,bd->lda,c,cd->lda,cn,PETSC_TRUE);CHKERRQ(ierr);
   ierr = MatDenseRestoreArray(C,&c);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
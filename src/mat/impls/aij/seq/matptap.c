@@ -17,11 +17,11 @@ PETSC_INTERN PetscErrorCode MatPtAP_SeqAIJ_SeqAIJ(Mat A,Mat P,MatReuse scall,Pet
 {
   PetscErrorCode ierr;
 #if !defined(PETSC_HAVE_HYPRE)
-  const char     *algTypes[2] = {"scalable","nonscalable"};
-  PetscInt       nalg = 2;
+  const char     *algTypes[4] = {"scalable","nonscalable","allatonce","allatonce_merged"};
+  PetscInt       nalg = 4;
 #else
-  const char     *algTypes[3] = {"scalable","nonscalable","hypre"};
-  PetscInt       nalg = 3;
+  const char     *algTypes[5] = {"scalable","nonscalable","allatonce","allatonce_merged","hypre"};
+  PetscInt       nalg = 5;
 #endif
   PetscInt       alg = 0; /* set default algorithm */
 
@@ -32,6 +32,7 @@ PETSC_INTERN PetscErrorCode MatPtAP_SeqAIJ_SeqAIJ(Mat A,Mat P,MatReuse scall,Pet
        "nonscalable": do dense axpy in MatPtAPNumeric() - fastest, but requires storage of struct A*P;
        "scalable":    do two sparse axpy in MatPtAPNumeric() - might slow, does not store structure of A*P.
        "hypre":    use boomerAMGBuildCoarseOperator.
+     The all-at-once algorithms of MPIAIJ use "scalable", which does not store A*P either.
      */
     ierr = PetscObjectOptionsBegin((PetscObject)A);CHKERRQ(ierr);
     PetscOptionsObject->alreadyprinted = PETSC_FALSE; /* a hack to ensure the option shows in '-help' */
@@ -43,7 +44,7 @@ PETSC_INTERN PetscErrorCode MatPtAP_SeqAIJ_SeqAIJ(Mat A,Mat P,MatReuse scall,Pet
       ierr = MatPtAPSymbolic_SeqAIJ_SeqAIJ_DenseAxpy(A,P,fill,C);CHKERRQ(ierr);
       break;
 #if defined(PETSC_HAVE_HYPRE)
-    case 2:
+    case 4:
       ierr = MatPtAPSymbolic_AIJ_AIJ_wHYPRE(A,P,fill,C);CHKERRQ(ierr);
       break;
 #endif
@@ -7,21 +7,6 @@
 #include <../src/mat/impls/aij/seq/aij.h> /*I "petscmat.h" I*/
 #include <../src/mat/impls/dense/seq/dense.h>
 
-PetscErrorCode MatDestroy_SeqDense_MatTransMatMult(Mat A)
-{
-  PetscErrorCode      ierr;
-  Mat_SeqDense        *a = (Mat_SeqDense*)A->data;
-  Mat_MatTransMatMult *atb = a->atb;
-
-  PetscFunctionBegin;
-  ierr = MatDestroy(&atb->mA);CHKERRQ(ierr);
-  ierr = VecDestroy(&atb->bt);CHKERRQ(ierr);
-  ierr = VecDestroy(&atb->ct);CHKERRQ(ierr);
-  ierr = (atb->destroy)(A);CHKERRQ(ierr);
-  ierr = PetscFree(atb);CHKERRQ(ierr);
-  PetscFunctionReturn(0);
-}
-
 PetscErrorCode MatTransposeMatMult_SeqAIJ_SeqDense(Mat A,Mat B,MatReuse scall,PetscReal fill,Mat *C)
 {
   PetscErrorCode ierr;
@@ -40,76 +25,99 @@ PetscErrorCode MatTransposeMatMult_SeqAIJ_SeqDense(Mat A,Mat B,MatReuse scall,Pe
 
 PetscErrorCode MatTransposeMatMultSymbolic_SeqAIJ_SeqDense(Mat A,Mat B,PetscReal fill,Mat *C)
 {
-  PetscErrorCode      ierr;
-  PetscInt            m=A->rmap->n,n=A->cmap->n,BN=B->cmap->N;
-  Mat_MatTransMatMult *atb;
-  Mat                 Cdense;
-  Vec                 bt,ct;
-  Mat_SeqDense        *c;
+  PetscErrorCode ierr;
+  PetscInt       n=A->cmap->n,BN=B->cmap->N;
+  Mat            Cdense;
 
   PetscFunctionBegin;
-  ierr = PetscNew(&atb);CHKERRQ(ierr);
-
   /* create output dense matrix C = A^T*B */
   ierr = MatCreate(PETSC_COMM_SELF,&Cdense);CHKERRQ(ierr);
   ierr = MatSetSizes(Cdense,n,BN,n,BN);CHKERRQ(ierr);
   ierr = MatSetType(Cdense,MATSEQDENSE);CHKERRQ(ierr);
   ierr = MatSeqDenseSetPreallocation(Cdense,NULL);CHKERRQ(ierr);
+  *C   = Cdense;
+  PetscFunctionReturn(0);
+}
 
-  /* create vectors bt and ct to hold locally transposed arrays of B and C */
-  ierr = VecCreate(PETSC_COMM_SELF,&bt);CHKERRQ(ierr);
-  ierr = VecSetSizes(bt,m*BN,m*BN);CHKERRQ(ierr);
-  ierr = VecSetType(bt,VECSTANDARD);CHKERRQ(ierr);
-  ierr = VecCreate(PETSC_COMM_SELF,&ct);CHKERRQ(ierr);
-  ierr = VecSetSizes(ct,n*BN,n*BN);CHKERRQ(ierr);
-  ierr = VecSetType(ct,VECSTANDARD);CHKERRQ(ierr);
-  atb->bt = bt;
-  atb->ct = ct;
+/*
+   C = A^T*B for the columns of B and C processed in slabs of MAT_SPMM_NB, as in MatMatMultKernel_SeqAIJ_SeqDense():
+   the slabs of B and C are interleaved so that each nonzero a_ij adds a_ij times the row i of the slab of B to the
+   contiguous row j of the slab of C. Rows of A without nonzeros are skipped using the compressed row storage.
+*/
+#define MAT_SPMM_NB 8
 
-  *C                   = Cdense;
-  c                    = (Mat_SeqDense*)Cdense->data;
-  c->atb               = atb;
-  atb->destroy         = Cdense->ops->destroy;
-  Cdense->ops->destroy = MatDestroy_SeqDense_MatTransMatMult;
+static PetscErrorCode MatTransposeMatMultKernel_SeqAIJ_SeqDense(Mat A,const PetscScalar *b,PetscInt ldb,PetscScalar *c,PetscInt ldc,PetscInt cn)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscInt          am = A->rmap->n,an = A->cmap->n,m,col,nb,i,j,k,t,n,row;
+  const PetscInt    *ii,*ridx = NULL,*aj;
+  const MatScalar   *aa;
+  const PetscScalar *bi,*bj;
+  PetscScalar       *bt,*ct,*cj,v;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (a->compressedrow.use) {
+    m    = a->compressedrow.nrows;
+    ii   = a->compressedrow.i;
+    ridx = a->compressedrow.rindex;
+  } else {
+    m  = am;
+    ii = a->i;
+  }
+  nb   = PetscMin(cn,MAT_SPMM_NB);
+  ierr = PetscMalloc2(am*nb,&bt,an*nb,&ct);CHKERRQ(ierr);
+  for (col=0; col<cn; col+=nb) {
+    nb = PetscMin(MAT_SPMM_NB,cn-col);
+    for (t=0; t<nb; t++) {
+      bj = b + (col+t)*ldb;
+      for (i=0; i<am; i++) bt[i*nb+t] = bj[i];
+    }
+    ierr = PetscMemzero(ct,an*nb*sizeof(PetscScalar));CHKERRQ(ierr);
+    for (i=0; i<m; i++) {
+      n   = ii[i+1] - ii[i];
+      aj  = a->j + ii[i];
+      aa  = a->a + ii[i];
+      row = ridx ? ridx[i] : i;
+      bi  = bt + row*nb;
+      if (nb == MAT_SPMM_NB) {
+        for (k=0; k<n; k++) {
+          v  = aa[k];
+          cj = ct + aj[k]*MAT_SPMM_NB;
+          for (t=0; t<MAT_SPMM_NB; t++) cj[t] += v*bi[t];
+        }
+      } else {
+        for (k=0; k<n; k++) {
+          v  = aa[k];
+          cj = ct + aj[k]*nb;
+          for (t=0; t<nb; t++) cj[t] += v*bi[t];
+        }
+      }
+    }
+    for (t=0; t<nb; t++) {
+      cj = c + (col+t)*ldc;
+      for (j=0; j<an; j++) cj[j] = ct[j*nb+t];
+    }
+  }
+  ierr = PetscFree2(bt,ct);CHKERRQ(ierr);
+  ierr = PetscLogFlops(cn*(2.0*a->nz));CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
 PetscErrorCode MatTransposeMatMultNumeric_SeqAIJ_SeqDense(Mat A,Mat B,Mat C)
 {
-  PetscErrorCode      ierr;
-  PetscInt            i,j,k,m=A->rmap->n,n=A->cmap->n,BN=B->cmap->N;
-  PetscScalar         *Barray,*Carray,*btarray,*ctarray;
-  Mat_SeqDense        *c=(Mat_SeqDense*)C->data;
-  Mat_MatTransMatMult *atb=c->atb;
-  Vec                 bt=atb->bt,ct=atb->ct;
+  PetscErrorCode ierr;
+  Mat_SeqDense   *b=(Mat_SeqDense*)B->data,*c=(Mat_SeqDense*)C->data;
+  PetscScalar    *Carray;
 
   PetscFunctionBegin;
-  /* create MAIJ matrix mA from A -- should be done in symbolic phase */
-  ierr = MatDestroy(&atb->mA);CHKERRQ(ierr);
-  ierr = MatCreateMAIJ(A,BN,&atb->mA);CHKERRQ(ierr);
-
-  /* transpose local arry of B, then copy it to vector bt */
-  ierr = MatDenseGetArray(B,&Barray);CHKERRQ(ierr);
-  ierr = VecGetArray(bt,&btarray);CHKERRQ(ierr);
-
-  k=0;
-  for (j=0; j<BN; j++) {
-    for (i=0; i<m; i++) btarray[i*BN + j] = Barray[k++]; 
-  }
-  ierr = VecRestoreArray(bt,&btarray);CHKERRQ(ierr);
-  ierr = MatDenseRestoreArray(B,&Barray);CHKERRQ(ierr);
-  
-  /* compute ct = mA^T * cb */
-  ierr = MatMultTranspose(atb->mA,bt,ct);CHKERRQ(ierr);
-
-  /* transpose local arry of ct to matrix C */
+  if (A->rmap->n != B->rmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Number rows in A %D not equal rows in B %D\n",A->rmap->n,B->rmap->n);
+  if (A->cmap->n != C->rmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Number rows in C %D not equal columns in A %D\n",C->rmap->n,A->cmap->n);
+  if (B->cmap->n != C->cmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Number columns in B %D not equal columns in C %D\n",B->cmap->n,C->cmap->n);
   ierr = MatDenseGetArray(C,&Carray);CHKERRQ(ierr);
-  ierr = VecGetArray(ct,&ctarray);CHKERRQ(ierr);
-  k = 0;
-  for (j=0; j<BN; j++) {
-    for (i=0; i<n; i++) Carray[k++] = ctarray[i*BN + j];
-  }
-  ierr = VecRestoreArray(ct,&ctarray);CHKERRQ(ierr);
+  ierr = MatTransposeMatMultKernel_SeqAIJ_SeqDense(A,b->v,b->lda,Carray,c->lda,B->cmap->n);CHKERRQ(ierr);
   ierr = MatDenseRestoreArray(C,&Carray);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -620,7 +620,7 @@ PetscErrorCode MatCreateSubMatrices_MPIBAIJ_local(Mat C,PetscInt ismax,const IS
   PetscInt       **rbuf3=NULL,*req_source1=NULL,*req_source2,**sbuf_aj,**rbuf2=NULL,max1,max2;
   PetscInt       **lens,is_no,ncols,*cols,mat_i,*mat_j,tmp2,jmax;
 #if defined(PETSC_USE_CTABLE)
-  PetscTable     *cmap,cmap_i=NULL,*rmap,rmap_i;
+  PetscHMapI     *cmap,cmap_i=NULL,*rmap,rmap_i;
 #else
   PetscInt       **cmap,*cmap_i=NULL,**rmap,*rmap_i;
 #endif
@@ -974,13 +974,14 @@ PetscErrorCode MatCreateSubMatrices_MPIBAIJ_local(Mat C,PetscInt ismax,const IS
 #if defined(PETSC_USE_CTABLE)
     for (i=0; i<ismax; i++) {
       if (!allcolumns[i]) {
-        ierr = PetscTableCreate(ncol[i]+1,c->Nbs+1,&cmap[i]);CHKERRQ(ierr);
+        ierr = PetscHMapICreate(&cmap[i]);CHKERRQ(ierr);
+        ierr = PetscHMapIResize(cmap[i],ncol[i]);CHKERRQ(ierr);
 
         jmax   = ncol[i];
         icol_i = icol[i];
         cmap_i = cmap[i];
         for (j=0; j<jmax; j++) {
-          ierr = PetscTableAdd(cmap[i],icol_i[j]+1,j+1,INSERT_VALUES);CHKERRQ(ierr);
+          ierr = PetscHMapISet(cmap[i],icol_i[j],j+1);CHKERRQ(ierr);
         }
       } else cmap[i] = NULL;
     }
@@ -1031,11 +1032,11 @@ PetscErrorCode MatCreateSubMatrices_MPIBAIJ_local(Mat C,PetscInt ismax,const IS
           if (!allcolumns[i]) {
 #if defined(PETSC_USE_CTABLE)
             for (k=0; k<nzA; k++) {
-              ierr = PetscTableFind(cmap_i,cstart+cworkA[k]+1,&tt);CHKERRQ(ierr);
+              ierr = PetscHMapIGetWithDefault(cmap_i,cstart+cworkA[k],0,&tt);CHKERRQ(ierr);
               if (tt) lens_i[j]++;
             }
             for (k=0; k<nzB; k++) {
-              ierr = PetscTableFind(cmap_i,bmap[cworkB[k]]+1,&tt);CHKERRQ(ierr);
+              ierr = PetscHMapIGetWithDefault(cmap_i,bmap[cworkB[k]],0,&tt);CHKERRQ(ierr);
               if (tt) lens_i[j]++;
             }
 
@@ -1058,14 +1059,15 @@ PetscErrorCode MatCreateSubMatrices_MPIBAIJ_local(Mat C,PetscInt ismax,const IS
     for (i=0; i<ismax; i++) {
       if (!allrows[i]) {
 #if defined(PETSC_USE_CTABLE)
-        ierr   = PetscTableCreate(nrow[i]+1,c->Mbs+1,&rmap[i]);CHKERRQ(ierr);
+        ierr = PetscHMapICreate(&rmap[i]);CHKERRQ(ierr);
+        ierr = PetscHMapIResize(rmap[i],nrow[i]);CHKERRQ(ierr);
         irow_i = irow[i];
         jmax   = nrow[i];
         for (j=0; j<jmax; j++) {
           if (allrows[i]) {
-            ierr = PetscTableAdd(rmap[i],j+1,j+1,INSERT_VALUES);CHKERRQ(ierr);
+            ierr = PetscHMapISet(rmap[i],j,j+1);CHKERRQ(ierr);
           } else {
-            ierr = PetscTableAdd(rmap[i],irow_i[j]+1,j+1,INSERT_VALUES);CHKERRQ(ierr);
+            ierr = PetscHMapISet(rmap[i],irow_i[j],j+1);CHKERRQ(ierr);
           }
         }
 #else
@@ -1104,7 +1106,7 @@ PetscErrorCode MatCreateSubMatrices_MPIBAIJ_local(Mat C,PetscInt ismax,const IS
               row = sbuf1_i[ct1];
             } else {
 #if defined(PETSC_USE_CTABLE)
-              ierr = PetscTableFind(rmap_i,sbuf1_i[ct1]+1,&row);CHKERRQ(ierr);
+              ierr = PetscHMapIGetWithDefault(rmap_i,sbuf1_i[ct1],0,&row);CHKERRQ(ierr);
               row--;
               if (row < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_PLIB,"row not found in table");
 #else
@@ -1115,7 +1117,7 @@ PetscErrorCode MatCreateSubMatrices_MPIBAIJ_local(Mat C,PetscInt ismax,const IS
             for (l=0; l<max2; l++,ct2++) {
               if (!allcolumns[is_no]) {
 #if defined(PETSC_USE_CTABLE)
-                ierr = PetscTableFind(cmap_i,rbuf3_i[ct2]+1,&tcol);CHKERRQ(ierr);
+                ierr = PetscHMapIGetWithDefault(cmap_i,rbuf3_i[ct2],0,&tcol);CHKERRQ(ierr);
 #else
                 tcol = cmap_i[rbuf3_i[ct2]];
 #endif
@@ -1321,7 +1323,7 @@ PetscErrorCode MatCreateSubMatrices_MPIBAIJ_local(Mat C,PetscInt ismax,const IS
           row = row+rstart;
         } else {
 #if defined(PETSC_USE_CTABLE)
-          ierr = PetscTableFind(rmap_i,row+rstart+1,&row);CHKERRQ(ierr);
+          ierr = PetscHMapIGetWithDefault(rmap_i,row+rstart,0,&row);CHKERRQ(ierr);
           row--;
 
           if (row < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_PLIB,"row not found in table");
@@ -1339,7 +1341,7 @@ PetscErrorCode MatCreateSubMatrices_MPIBAIJ_local(Mat C,PetscInt ismax,const IS
           for (l=0; l<nzB; l++) {
             if ((ctmp = bmap[cworkB[l]]) < cstart) {
 #if defined(PETSC_USE_CTABLE)
-              ierr = PetscTableFind(cmap_i,ctmp+1,&tcol);CHKERRQ(ierr);
+              ierr = PetscHMapIGetWithDefault(cmap_i,ctmp,0,&tcol);CHKERRQ(ierr);
               if (tcol) {
 #else
               if ((tcol = cmap_i[ctmp])) {
@@ -1354,7 +1356,7 @@ PetscErrorCode MatCreateSubMatrices_MPIBAIJ_local(Mat C,PetscInt ismax,const IS
           imark = l;
           for (l=0; l<nzA; l++) {
 #if defined(PETSC_USE_CTABLE)
-            ierr = PetscTableFind(cmap_i,cstart+cworkA[l]+1,&tcol);CHKERRQ(ierr);
+            ierr = PetscHMapIGetWithDefault(cmap_i,cstart+cworkA[l],0,&tcol);CHKERRQ(ierr);
             if (tcol) {
 #else
             if ((tcol = cmap_i[cstart + cworkA[l]])) {
@@ -1369,7 +1371,7 @@ PetscErrorCode MatCreateSubMatrices_MPIBAIJ_local(Mat C,PetscInt ismax,const IS
           }
           for (l=imark; l<nzB; l++) {
 #if defined(PETSC_USE_CTABLE)
-            ierr = PetscTableFind(cmap_i,bmap[cworkB[l]]+1,&tcol);CHKERRQ(ierr);
+            ierr = PetscHMapIGetWithDefault(cmap_i,bmap[cworkB[l]],0,&tcol);CHKERRQ(ierr);
             if (tcol) {
 #else
             if ((tcol = cmap_i[bmap[cworkB[l]]])) {
@@ -1443,7 +1445,7 @@ PetscErrorCode MatCreateSubMatrices_MPIBAIJ_local(Mat C,PetscInt ismax,const IS
           row = sbuf1_i[ct1];
         } else {
 #if defined(PETSC_USE_CTABLE)
-          ierr = PetscTableFind(rmap_i,row+1,&row);CHKERRQ(ierr);
+          ierr = PetscHMapIGetWithDefault(rmap_i,row,0,&row);CHKERRQ(ierr);
           row--;
           if (row < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_PLIB,"row not found in table");
 #else
@@ -1458,7 +1460,7 @@ PetscErrorCode MatCreateSubMatrices_MPIBAIJ_local(Mat C,PetscInt ismax,const IS
         if (!allcolumns[is_no]) {
           for (l=0; l<max2; l++,ct2++) {
 #if defined(PETSC_USE_CTABLE)
-            ierr = PetscTableFind(cmap_i,rbuf3_i[ct2]+1,&tcol);CHKERRQ(ierr);
+            ierr = PetscHMapIGetWithDefault(cmap_i,rbuf3_i[ct2],0,&tcol);CHKERRQ(ierr);
 #else
             tcol = cmap_i[rbuf3_i[ct2]];
 #endif
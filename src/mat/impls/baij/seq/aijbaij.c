@@ -58,20 +58,73 @@ PETSC_INTERN PetscErrorCode MatConvert_SeqBAIJ_SeqAIJ(Mat A, MatType newtype,Mat
 
 #include <../src/mat/impls/aij/seq/aij.h>
 
+/* copies the dense bs by bs blocks of A, its nonzero structure must be made of them, see MatSeqAIJCheckBlocks_Private() */
+static PetscErrorCode MatConvert_SeqAIJ_SeqBAIJ_Blocked(Mat A,MatReuse reuse,Mat *newmat)
+{
+  Mat            B;
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqBAIJ    *b;
+  PetscErrorCode ierr;
+  PetscInt       bs = A->rmap->bs,bs2 = bs*bs,mbs = A->rmap->n/bs,i,k,r,c,nbz,*blen;
+  const PetscInt *ai = a->i,*aj = a->j;
+  MatScalar      *v;
+
+  PetscFunctionBegin;
+  ierr = PetscMalloc1(mbs,&blen);CHKERRQ(ierr);
+  for (i=0; i<mbs; i++) blen[i] = (ai[i*bs+1] - ai[i*bs])/bs;
+  ierr = MatCreate(PetscObjectComm((PetscObject)A),&B);CHKERRQ(ierr);
+  ierr = MatSetSizes(B,A->rmap->n,A->cmap->n,A->rmap->n,A->cmap->n);CHKERRQ(ierr);
+  ierr = MatSetType(B,MATSEQBAIJ);CHKERRQ(ierr);
+  ierr = MatSeqBAIJSetPreallocation(B,bs,0,blen);CHKERRQ(ierr);
+  ierr = PetscFree(blen);CHKERRQ(ierr);
+
+  b = (Mat_SeqBAIJ*)B->data;
+  for (i=0; i<mbs; i++) {
+    nbz = (ai[i*bs+1] - ai[i*bs])/bs;
+    for (k=0; k<nbz; k++) {
+      b->j[b->i[i]+k] = aj[ai[i*bs]+k*bs]/bs;
+      v               = b->a + bs2*(b->i[i]+k);
+      /* the blocks of BAIJ are stored by columns */
+      for (c=0; c<bs; c++) {
+        for (r=0; r<bs; r++) v[c*bs+r] = a->a[ai[i*bs+r]+k*bs+c];
+      }
+    }
+    b->ilen[i] = nbz;
+  }
+  ierr = MatAssemblyBegin(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  if (reuse == MAT_INPLACE_MATRIX) {
+    ierr = MatHeaderReplace(A,&B);CHKERRQ(ierr);
+  } else {
+    *newmat = B;
+  }
+  PetscFunctionReturn(0);
+}
+
 PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqBAIJ(Mat A,MatType newtype,MatReuse reuse,Mat *newmat)
 {
   Mat            B;
   Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
   Mat_SeqBAIJ    *b;
   PetscErrorCode ierr;
-  PetscInt       *ai=a->i,m=A->rmap->N,n=A->cmap->N,i,*rowlengths;
+  PetscInt       *ai=a->i,m=A->rmap->N,n=A->cmap->N,i,*rowlengths,bs=A->rmap->bs,mask;
 
   PetscFunctionBegin;
-  if (n != m) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Matrix must be square");
-  if (A->rmap->bs > 1) {
-    ierr = MatConvert_Basic(A,newtype,reuse,newmat);CHKERRQ(ierr);
+  if (bs > 1) {
+    mask = 0;
+    if (bs == A->cmap->bs && bs <= MAT_DETECT_BLOCK_SIZE_MAX && m) {
+      mask = (PetscInt)1 << bs;
+      ierr = MatSeqAIJCheckBlocks_Private(A,NULL,&mask);CHKERRQ(ierr);
+    }
+    if (mask) {
+      ierr = MatConvert_SeqAIJ_SeqBAIJ_Blocked(A,reuse,newmat);CHKERRQ(ierr);
+    } else {
+      ierr = MatConvert_Basic(A,newtype,reuse,newmat);CHKERRQ(ierr);
+    }
     PetscFunctionReturn(0);
   }
+  if (n != m) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Matrix must be square");
 
   ierr = PetscMalloc1(m,&rowlengths);CHKERRQ(ierr);
   for (i=0; i<m; i++) {
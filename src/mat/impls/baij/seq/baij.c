@@ -2746,7 +2746,8 @@ static PetscErrorCode  MatSeqBAIJSetPreallocation_SeqBAIJ(Mat B,PetscInt bs,Pets
   Mat_SeqBAIJ    *b;
   PetscErrorCode ierr;
   PetscInt       i,mbs,nbs,bs2;
-  PetscBool      flg = PETSC_FALSE,skipallocation = PETSC_FALSE,realalloc = PETSC_FALSE;
+  PetscBool      flg = PETSC_FALSE,fixed = PETSC_FALSE,skipallocation = PETSC_FALSE,realalloc = PETSC_FALSE;
+  const MatSeqBAIJFixedKernels *kernels;
 
   PetscFunctionBegin;
   if (nz >= 0 || nnz) realalloc = PETSC_TRUE;
@@ -2778,11 +2779,28 @@ static PetscErrorCode  MatSeqBAIJSetPreallocation_SeqBAIJ(Mat B,PetscInt bs,Pets
   }
 
   b    = (Mat_SeqBAIJ*)B->data;
-  ierr = PetscOptionsBegin(PetscObjectComm((PetscObject)B),NULL,"Optimize options for SEQBAIJ matrix 2 ","Mat");CHKERRQ(ierr);
+  ierr = PetscOptionsBegin(PetscObjectComm((PetscObject)B),((PetscObject)B)->prefix,"Optimize options for SEQBAIJ matrix 2 ","Mat");CHKERRQ(ierr);
   ierr = PetscOptionsBool("-mat_no_unroll","Do not optimize for block size (slow)",NULL,flg,&flg,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-mat_baij_fixed_kernels","Use the generated kernels for all block sizes up to 16","MatSeqBAIJGetFixedKernels",fixed,&fixed,NULL);CHKERRQ(ierr);
   ierr = PetscOptionsEnd();CHKERRQ(ierr);
 
-  if (!flg) {
+  B->ops->sor              = MatSOR_SeqBAIJ;
+  B->ops->multtranspose    = MatMultTranspose_SeqBAIJ;
+  B->ops->multtransposeadd = MatMultTransposeAdd_SeqBAIJ;
+  ierr = MatSeqBAIJGetFixedKernels(bs,&kernels);CHKERRQ(ierr);
+  if (!flg && kernels && fixed) {
+    B->ops->mult             = kernels->mult;
+    B->ops->multadd          = kernels->multadd;
+    B->ops->multtranspose    = kernels->multtranspose;
+    B->ops->multtransposeadd = kernels->multtransposeadd;
+    B->ops->sor              = kernels->sor;
+  } else if (!flg) {
+    /* the generated kernels replace the general ones for the block sizes without hand written kernels */
+    if (kernels && bs > 5) {
+      B->ops->multtranspose    = kernels->multtranspose;
+      B->ops->multtransposeadd = kernels->multtransposeadd;
+    }
+    if (kernels && bs > 7) B->ops->sor = kernels->sor;
     switch (bs) {
     case 1:
       B->ops->mult    = MatMult_SeqBAIJ_1;
@@ -2818,15 +2836,14 @@ static PetscErrorCode  MatSeqBAIJSetPreallocation_SeqBAIJ(Mat B,PetscInt bs,Pets
       break;
     case 15:
       B->ops->mult    = MatMult_SeqBAIJ_15_ver1;
-      B->ops->multadd = MatMultAdd_SeqBAIJ_N;
+      B->ops->multadd = kernels->multadd;
       break;
     default:
-      B->ops->mult    = MatMult_SeqBAIJ_N;
-      B->ops->multadd = MatMultAdd_SeqBAIJ_N;
+      B->ops->mult    = kernels ? kernels->mult : MatMult_SeqBAIJ_N;
+      B->ops->multadd = kernels ? kernels->multadd : MatMultAdd_SeqBAIJ_N;
       break;
     }
   }
-  B->ops->sor = MatSOR_SeqBAIJ;
   b->mbs = mbs;
   b->nbs = nbs;
   if (!skipallocation) {
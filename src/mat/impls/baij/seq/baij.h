@@ -229,7 +229,21 @@ PETSC_INTERN PetscErrorCode MatMultAdd_SeqBAIJ_11(Mat,Vec,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatMultAdd_SeqBAIJ_N(Mat,Vec,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatLoad_SeqBAIJ(Mat,PetscViewer);
 PETSC_INTERN PetscErrorCode MatSeqBAIJSetNumericFactorization_inplace(Mat,PetscBool);
-PETSC_INTERN PetscErrorCode MatSeqBAIJSetNumericFactorization(Mat,PetscBool);
+PETSC_INTERN PetscErrorCode MatSeqBAIJSetNumericFactorization(Mat,Mat,PetscBool);
+
+/*
+   Kernels generated from baijfixed.h for each block size up to MATSEQBAIJ_FIXED_MAXBS, see baijfixed.c
+*/
+#define MATSEQBAIJ_FIXED_MAXBS 16
+typedef struct {
+  PetscErrorCode (*mult)(Mat,Vec,Vec);
+  PetscErrorCode (*multadd)(Mat,Vec,Vec,Vec);
+  PetscErrorCode (*multtranspose)(Mat,Vec,Vec);
+  PetscErrorCode (*multtransposeadd)(Mat,Vec,Vec,Vec);
+  PetscErrorCode (*sor)(Mat,Vec,PetscReal,MatSORType,PetscReal,PetscInt,PetscInt,Vec);
+  PetscErrorCode (*lufactornumeric)(Mat,Mat,const MatFactorInfo*);
+} MatSeqBAIJFixedKernels;
+PETSC_INTERN PetscErrorCode MatSeqBAIJGetFixedKernels(PetscInt,const MatSeqBAIJFixedKernels**);
 
 PETSC_INTERN PetscErrorCode MatGetRow_SeqBAIJ_private(Mat,PetscInt,PetscInt*,PetscInt**,PetscScalar**,PetscInt*,PetscInt*,PetscScalar*);
 PETSC_INTERN PetscErrorCode MatAXPYGetPreallocation_SeqBAIJ(Mat,Mat,PetscInt*);
@@ -375,7 +375,7 @@ PetscErrorCode MatILUFactorSymbolic_SeqBAIJ(Mat fact,Mat A,IS isrow,IS iscol,con
   if (!levels && both_identity) {
     /* special case: ilu(0) with natural ordering */
     ierr = MatILUFactorSymbolic_SeqBAIJ_ilu0(fact,A,isrow,iscol,info);CHKERRQ(ierr);
-    ierr = MatSeqBAIJSetNumericFactorization(fact,both_identity);CHKERRQ(ierr);
+    ierr = MatSeqBAIJSetNumericFactorization(fact,A,both_identity);CHKERRQ(ierr);
 
     fact->factortype               = MAT_FACTOR_ILU;
     (fact)->info.factor_mallocs    = 0;
@@ -536,7 +536,7 @@ PetscErrorCode MatILUFactorSymbolic_SeqBAIJ(Mat fact,Mat A,IS isrow,IS iscol,con
   fact->info.fill_ratio_given  = f;
   fact->info.fill_ratio_needed = ((PetscReal)(bdiag[0]+1))/((PetscReal)ai[n]);
 
-  ierr = MatSeqBAIJSetNumericFactorization(fact,both_identity);CHKERRQ(ierr);
+  ierr = MatSeqBAIJSetNumericFactorization(fact,A,both_identity);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
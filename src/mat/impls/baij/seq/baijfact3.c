@@ -6,12 +6,21 @@
 #include <petsc/private/kernels/blockinvert.h>
 
 /*
-   This is used to set the numeric factorization for both LU and ILU symbolic factorization
+   This is used to set the numeric factorization for both LU and ILU symbolic factorization;
+   A is the matrix being factored, whose options prefix is used
 */
-PetscErrorCode MatSeqBAIJSetNumericFactorization(Mat fact,PetscBool natural)
+PetscErrorCode MatSeqBAIJSetNumericFactorization(Mat fact,Mat A,PetscBool natural)
 {
+  PetscErrorCode               ierr;
+  PetscBool                    fixed = PETSC_FALSE;
+  const MatSeqBAIJFixedKernels *kernels;
+
   PetscFunctionBegin;
-  if (natural) {
+  ierr = MatSeqBAIJGetFixedKernels(fact->rmap->bs,&kernels);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(((PetscObject)A)->options,((PetscObject)A)->prefix,"-mat_baij_fixed_kernels",&fixed,NULL);CHKERRQ(ierr);
+  if (kernels && fixed) {
+    fact->ops->lufactornumeric = kernels->lufactornumeric;
+  } else if (natural) {
     switch (fact->rmap->bs) {
     case 1:
       fact->ops->lufactornumeric = MatLUFactorNumeric_SeqBAIJ_1;
@@ -38,7 +47,7 @@ PetscErrorCode MatSeqBAIJSetNumericFactorization(Mat fact,PetscBool natural)
       fact->ops->lufactornumeric = MatLUFactorNumeric_SeqBAIJ_15_NaturalOrdering;
       break;
     default:
-      fact->ops->lufactornumeric = MatLUFactorNumeric_SeqBAIJ_N;
+      fact->ops->lufactornumeric = kernels ? kernels->lufactornumeric : MatLUFactorNumeric_SeqBAIJ_N;
       break;
     }
   } else {
@@ -65,7 +74,7 @@ PetscErrorCode MatSeqBAIJSetNumericFactorization(Mat fact,PetscBool natural)
       fact->ops->lufactornumeric = MatLUFactorNumeric_SeqBAIJ_7;
       break;
     default:
-      fact->ops->lufactornumeric = MatLUFactorNumeric_SeqBAIJ_N;
+      fact->ops->lufactornumeric = kernels ? kernels->lufactornumeric : MatLUFactorNumeric_SeqBAIJ_N;
       break;
     }
   }
@@ -333,7 +342,7 @@ PetscErrorCode MatLUFactorSymbolic_SeqBAIJ(Mat B,Mat A,IS isrow,IS iscol,const M
 
   both_identity = (PetscBool) (row_identity && col_identity);
 
-  ierr = MatSeqBAIJSetNumericFactorization(B,both_identity);CHKERRQ(ierr);
+  ierr = MatSeqBAIJSetNumericFactorization(B,A,both_identity);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
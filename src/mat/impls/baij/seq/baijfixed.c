@@ -0,0 +1,93 @@
+
+/*
+   SeqBAIJ kernels for the block sizes 1 to MATSEQBAIJ_FIXED_MAXBS, generated from the single
+   template baijfixed.h.  Used for the block sizes that have no hand written kernels, in place
+   of the general _N kernels, or for all block sizes with -mat_baij_fixed_kernels.
+*/
+#include <../src/mat/impls/baij/seq/baij.h>
+#include <petsc/private/kernels/blockinvert.h>
+
+#define MatSeqBAIJFixedName__(f,bs) f##_##bs##_Fixed
+#define MatSeqBAIJFixedName_(f,bs)  MatSeqBAIJFixedName__(f,bs)
+#define FIXED(f)                    MatSeqBAIJFixedName_(f,BS)
+
+#define BS 1
+#include <../src/mat/impls/baij/seq/baijfixed.h>
+#undef BS
+#define BS 2
+#include <../src/mat/impls/baij/seq/baijfixed.h>
+#undef BS
+#define BS 3
+#include <../src/mat/impls/baij/seq/baijfixed.h>
+#undef BS
+#define BS 4
+#include <../src/mat/impls/baij/seq/baijfixed.h>
+#undef BS
+#define BS 5
+#include <../src/mat/impls/baij/seq/baijfixed.h>
+#undef BS
+#define BS 6
+#include <../src/mat/impls/baij/seq/baijfixed.h>
+#undef BS
+#define BS 7
+#include <../src/mat/impls/baij/seq/baijfixed.h>
+#undef BS
+#define BS 8
+#include <../src/mat/impls/baij/seq/baijfixed.h>
+#undef BS
+#define BS 9
+#include <../src/mat/impls/baij/seq/baijfixed.h>
+#undef BS
+#define BS 10
+#include <../src/mat/impls/baij/seq/baijfixed.h>
+#undef BS
+#define BS 11
+#include <../src/mat/impls/baij/seq/baijfixed.h>
+#undef BS
+#define BS 12
+#include <../src/mat/impls/baij/seq/baijfixed.h>
+#undef BS
+#define BS 13
+#include <../src/mat/impls/baij/seq/baijfixed.h>
+#undef BS
+#define BS 14
+#include <../src/mat/impls/baij/seq/baijfixed.h>
+#undef BS
+#define BS 15
+#include <../src/mat/impls/baij/seq/baijfixed.h>
+#undef BS
+#define BS 16
+#include <../src/mat/impls/baij/seq/baijfixed.h>
+#undef BS
+
+#define MatSeqBAIJFixedKernelsEntry(bs) { \
+    MatSeqBAIJFixedName_(MatMult_SeqBAIJ,bs),                      \
+    MatSeqBAIJFixedName_(MatMultAdd_SeqBAIJ,bs),                   \
+    MatSeqBAIJFixedName_(MatMultTranspose_SeqBAIJ,bs),             \
+    MatSeqBAIJFixedName_(MatMultTransposeAdd_SeqBAIJ,bs),          \
+    MatSeqBAIJFixedName_(MatSOR_SeqBAIJ,bs),                       \
+    MatSeqBAIJFixedName_(MatLUFactorNumeric_SeqBAIJ,bs)}
+
+static const MatSeqBAIJFixedKernels MatSeqBAIJFixedKernelsTable[MATSEQBAIJ_FIXED_MAXBS] = {
+  MatSeqBAIJFixedKernelsEntry(1),  MatSeqBAIJFixedKernelsEntry(2),  MatSeqBAIJFixedKernelsEntry(3),  MatSeqBAIJFixedKernelsEntry(4),
+  MatSeqBAIJFixedKernelsEntry(5),  MatSeqBAIJFixedKernelsEntry(6),  MatSeqBAIJFixedKernelsEntry(7),  MatSeqBAIJFixedKernelsEntry(8),
+  MatSeqBAIJFixedKernelsEntry(9),  MatSeqBAIJFixedKernelsEntry(10), MatSeqBAIJFixedKernelsEntry(11), MatSeqBAIJFixedKernelsEntry(12),
+  MatSeqBAIJFixedKernelsEntry(13), MatSeqBAIJFixedKernelsEntry(14), MatSeqBAIJFixedKernelsEntry(15), MatSeqBAIJFixedKernelsEntry(16)
+};
+
+/*
+   MatSeqBAIJGetFixedKernels - Gets the generated kernels for a block size
+
+   Input Parameter:
+.  bs - the block size
+
+   Output Parameter:
+.  kernels - the kernels, or NULL if there are none for this block size
+*/
+PetscErrorCode MatSeqBAIJGetFixedKernels(PetscInt bs,const MatSeqBAIJFixedKernels **kernels)
+{
+  PetscFunctionBegin;
+  if (bs >= 1 && bs <= MATSEQBAIJ_FIXED_MAXBS) *kernels = &MatSeqBAIJFixedKernelsTable[bs-1];
+  else *kernels = NULL;
+  PetscFunctionReturn(0);
+}
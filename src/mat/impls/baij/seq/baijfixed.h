@@ -0,0 +1,542 @@
+
+/*
+   Template for the SeqBAIJ kernels of one fixed block size, see baijfixed.c.
+
+   This file is included once for every block size BS with FIXED(f) defined to give the
+   name of the function f for that size.  The block size is a compile time constant, so
+   the compiler unrolls the loops over a block and vectorizes the loops over a column of
+   it; blocks are stored by columns.  There is no include guard on purpose.
+*/
+
+static PetscErrorCode FIXED(MatMult_SeqBAIJ)(Mat A,Vec xx,Vec zz)
+{
+  Mat_SeqBAIJ       *a = (Mat_SeqBAIJ*)A->data;
+  PetscScalar       *z,*zarray,sum[BS];
+  const PetscScalar *x,*xb;
+  const MatScalar   *v = a->a;
+  const PetscInt    *idx = a->j,*ii,*ridx = NULL;
+  PetscInt          mbs,i,j,n,r,c;
+  PetscBool         usecprow = a->compressedrow.use;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(zz,&zarray);CHKERRQ(ierr);
+  if (usecprow) {
+    mbs  = a->compressedrow.nrows;
+    ii   = a->compressedrow.i;
+    ridx = a->compressedrow.rindex;
+    ierr = PetscMemzero(zarray,BS*a->mbs*sizeof(PetscScalar));CHKERRQ(ierr);
+  } else {
+    mbs = a->mbs;
+    ii  = a->i;
+  }
+  for (i=0; i<mbs; i++) {
+    n = ii[i+1] - ii[i];
+    for (r=0; r<BS; r++) sum[r] = 0.0;
+    for (j=0; j<n; j++) {
+      xb = x + BS*idx[j];
+      for (c=0; c<BS; c++) {
+        for (r=0; r<BS; r++) sum[r] += v[c*BS+r]*xb[c];
+      }
+      v += BS*BS;
+    }
+    idx += n;
+    z    = zarray + BS*(usecprow ? ridx[i] : i);
+    for (r=0; r<BS; r++) z[r] = sum[r];
+  }
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(zz,&zarray);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*a->nz*BS*BS - BS*a->nonzerorowcnt);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode FIXED(MatMultAdd_SeqBAIJ)(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqBAIJ       *a = (Mat_SeqBAIJ*)A->data;
+  PetscScalar       *z,*zarray,sum[BS];
+  const PetscScalar *x,*xb;
+  const MatScalar   *v = a->a;
+  const PetscInt    *idx = a->j,*ii,*ridx = NULL;
+  PetscInt          mbs,i,j,n,r,c;
+  PetscBool         usecprow = a->compressedrow.use;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecCopy(yy,zz);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(zz,&zarray);CHKERRQ(ierr);
+  if (usecprow) {
+    mbs  = a->compressedrow.nrows;
+    ii   = a->compressedrow.i;
+    ridx = a->compressedrow.rindex;
+  } else {
+    mbs = a->mbs;
+    ii  = a->i;
+  }
+  for (i=0; i<mbs; i++) {
+    n = ii[i+1] - ii[i];
+    z = zarray + BS*(usecprow ? ridx[i] : i);
+    for (r=0; r<BS; r++) sum[r] = z[r];
+    for (j=0; j<n; j++) {
+      xb = x + BS*idx[j];
+      for (c=0; c<BS; c++) {
+        for (r=0; r<BS; r++) sum[r] += v[c*BS+r]*xb[c];
+      }
+      v += BS*BS;
+    }
+    idx += n;
+    for (r=0; r<BS; r++) z[r] = sum[r];
+  }
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(zz,&zarray);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*a->nz*BS*BS);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode FIXED(MatMultTransposeAdd_SeqBAIJ)(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqBAIJ       *a = (Mat_SeqBAIJ*)A->data;
+  PetscScalar       *z,*zb,xr[BS],sum;
+  const PetscScalar *x,*xb;
+  const MatScalar   *v = a->a;
+  const PetscInt    *idx = a->j,*ii,*ridx = NULL;
+  PetscInt          mbs,i,j,n,r,c;
+  PetscBool         usecprow = a->compressedrow.use;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (yy != zz) {ierr = VecCopy(yy,zz);CHKERRQ(ierr);}
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(zz,&z);CHKERRQ(ierr);
+  if (usecprow) {
+    mbs  = a->compressedrow.nrows;
+    ii   = a->compressedrow.i;
+    ridx = a->compressedrow.rindex;
+  } else {
+    mbs = a->mbs;
+    ii  = a->i;
+  }
+  for (i=0; i<mbs; i++) {
+    n  = ii[i+1] - ii[i];
+    xb = x + BS*(usecprow ? ridx[i] : i);
+    for (r=0; r<BS; r++) xr[r] = xb[r];
+    for (j=0; j<n; j++) {
+      zb = z + BS*idx[j];
+      for (c=0; c<BS; c++) {
+        sum = 0.0;
+        for (r=0; r<BS; r++) sum += v[c*BS+r]*xr[r];
+        zb[c] += sum;
+      }
+      v += BS*BS;
+    }
+    idx += n;
+  }
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(zz,&z);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*a->nz*BS*BS);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode FIXED(MatMultTranspose_SeqBAIJ)(Mat A,Vec xx,Vec zz)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecSet(zz,0.0);CHKERRQ(ierr);
+  ierr = FIXED(MatMultTransposeAdd_SeqBAIJ)(A,xx,zz,zz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* the sweeps of MatSOR_SeqBAIJ(), with the same restrictions */
+static PetscErrorCode FIXED(MatSOR_SeqBAIJ)(Mat A,Vec bb,PetscReal omega,MatSORType flag,PetscReal fshift,PetscInt its,PetscInt lits,Vec xx)
+{
+  Mat_SeqBAIJ       *a = (Mat_SeqBAIJ*)A->data;
+  PetscScalar       *x,*xi,*t,w[BS];
+  const PetscScalar *b,*xb,*xj;
+  const MatScalar   *v,*aa = a->a,*idiag;
+  const PetscInt    *diag,*ai = a->i,*aj = a->j,*vi;
+  PetscInt          m = a->mbs,i,k,r,c,nz;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (fshift == -1.0) fshift = 0.0; /* negative fshift indicates do not error on zero diagonal; this code never errors on zero diagonal */
+  its = its*lits;
+  if (flag & SOR_EISENSTAT) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"No support yet for Eisenstat");
+  if (its <= 0) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Relaxation requires global its %D and local its %D both positive",its,lits);
+  if (fshift) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Sorry, no support for diagonal shift");
+  if (omega != 1.0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Sorry, no support for non-trivial relaxation factor");
+  if ((flag & SOR_APPLY_UPPER) || (flag & SOR_APPLY_LOWER)) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Sorry, no support for applying upper or lower triangular parts");
+
+  if (!a->idiagvalid) {ierr = MatInvertBlockDiagonal(A,NULL);CHKERRQ(ierr);}
+
+  if (!m) PetscFunctionReturn(0);
+  diag = a->diag;
+  if (!a->sor_workt) {
+    ierr = PetscMalloc1(PetscMax(A->rmap->n,A->cmap->n),&a->sor_workt);CHKERRQ(ierr);
+  }
+  t = a->sor_workt;
+
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+
+  if (flag & SOR_ZERO_INITIAL_GUESS) {
+    if (flag & SOR_FORWARD_SWEEP || flag & SOR_LOCAL_FORWARD_SWEEP) {
+      idiag = a->idiag;
+      for (i=0; i<m; i++) {
+        v  = aa + BS*BS*ai[i];
+        vi = aj + ai[i];
+        nz = diag[i] - ai[i];
+        for (r=0; r<BS; r++) w[r] = b[BS*i+r];
+        for (k=0; k<nz; k++) {
+          xj = x + BS*vi[k];
+          for (c=0; c<BS; c++) {
+            for (r=0; r<BS; r++) w[r] -= v[c*BS+r]*xj[c];
+          }
+          v += BS*BS;
+        }
+        /* save the application of the lower triangular part for the backward sweep */
+        for (r=0; r<BS; r++) t[BS*i+r] = w[r];
+        xi = x + BS*i;
+        for (r=0; r<BS; r++) xi[r] = 0.0;
+        for (c=0; c<BS; c++) {
+          for (r=0; r<BS; r++) xi[r] += idiag[c*BS+r]*w[c];
+        }
+        idiag += BS*BS;
+      }
+      /* for logging purposes assume number of nonzero in lower half is 1/2 of total */
+      ierr = PetscLogFlops(1.0*BS*BS*a->nz);CHKERRQ(ierr);
+      xb   = t;
+    } else xb = b;
+    if (flag & SOR_BACKWARD_SWEEP || flag & SOR_LOCAL_BACKWARD_SWEEP) {
+      idiag = a->idiag + BS*BS*(m-1);
+      for (i=m-1; i>=0; i--) {
+        v  = aa + BS*BS*(diag[i]+1);
+        vi = aj + diag[i] + 1;
+        nz = ai[i+1] - diag[i] - 1;
+        for (r=0; r<BS; r++) w[r] = xb[BS*i+r];
+        for (k=0; k<nz; k++) {
+          xj = x + BS*vi[k];
+          for (c=0; c<BS; c++) {
+            for (r=0; r<BS; r++) w[r] -= v[c*BS+r]*xj[c];
+          }
+          v += BS*BS;
+        }
+        xi = x + BS*i;
+        for (r=0; r<BS; r++) xi[r] = 0.0;
+        for (c=0; c<BS; c++) {
+          for (r=0; r<BS; r++) xi[r] += idiag[c*BS+r]*w[c];
+        }
+        idiag -= BS*BS;
+      }
+      ierr = PetscLogFlops(1.0*BS*BS*a->nz);CHKERRQ(ierr);
+    }
+    its--;
+  }
+  while (its--) {
+    if (flag & SOR_FORWARD_SWEEP || flag & SOR_LOCAL_FORWARD_SWEEP) {
+      idiag = a->idiag;
+      for (i=0; i<m; i++) {
+        v  = aa + BS*BS*ai[i];
+        vi = aj + ai[i];
+        nz = ai[i+1] - ai[i];
+        for (r=0; r<BS; r++) w[r] = b[BS*i+r];
+        for (k=0; k<nz; k++) {
+          xj = x + BS*vi[k];
+          for (c=0; c<BS; c++) {
+            for (r=0; r<BS; r++) w[r] -= v[c*BS+r]*xj[c];
+          }
+          v += BS*BS;
+        }
+        xi = x + BS*i;
+        for (c=0; c<BS; c++) {
+          for (r=0; r<BS; r++) xi[r] += idiag[c*BS+r]*w[c];
+        }
+        idiag += BS*BS;
+      }
+      ierr = PetscLogFlops(2.0*BS*BS*a->nz);CHKERRQ(ierr);
+    }
+    if (flag & SOR_BACKWARD_SWEEP || flag & SOR_LOCAL_BACKWARD_SWEEP) {
+      idiag = a->idiag + BS*BS*(m-1);
+      for (i=m-1; i>=0; i--) {
+        v  = aa + BS*BS*ai[i];
+        vi = aj + ai[i];
+        nz = ai[i+1] - ai[i];
+        for (r=0; r<BS; r++) w[r] = b[BS*i+r];
+        for (k=0; k<nz; k++) {
+          xj = x + BS*vi[k];
+          for (c=0; c<BS; c++) {
+            for (r=0; r<BS; r++) w[r] -= v[c*BS+r]*xj[c];
+          }
+          v += BS*BS;
+        }
+        xi = x + BS*i;
+        for (c=0; c<BS; c++) {
+          for (r=0; r<BS; r++) xi[r] += idiag[c*BS+r]*w[c];
+        }
+        idiag -= BS*BS;
+      }
+      ierr = PetscLogFlops(2.0*BS*BS*a->nz);CHKERRQ(ierr);
+    }
+  }
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode FIXED(MatSolve_SeqBAIJ_NaturalOrdering)(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqBAIJ       *a = (Mat_SeqBAIJ*)A->data;
+  const PetscInt    *ai = a->i,*aj = a->j,*adiag = a->diag,*vi;
+  PetscInt          i,k,r,c,n = a->mbs,nz;
+  const MatScalar   *aa = a->a,*v;
+  PetscScalar       *x,*t,*s,ls[BS];
+  const PetscScalar *b,*tj;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  t    = a->solve_work;
+
+  /* forward solve the lower triangular */
+  for (i=0; i<n; i++) {
+    v  = aa + BS*BS*ai[i];
+    vi = aj + ai[i];
+    nz = ai[i+1] - ai[i];
+    for (r=0; r<BS; r++) ls[r] = b[BS*i+r];
+    for (k=0; k<nz; k++) {
+      tj = t + BS*vi[k];
+      for (c=0; c<BS; c++) {
+        for (r=0; r<BS; r++) ls[r] -= v[c*BS+r]*tj[c];
+      }
+      v += BS*BS;
+    }
+    s = t + BS*i;
+    for (r=0; r<BS; r++) s[r] = ls[r];
+  }
+
+  /* backward solve the upper triangular */
+  for (i=n-1; i>=0; i--) {
+    v  = aa + BS*BS*(adiag[i+1]+1);
+    vi = aj + adiag[i+1] + 1;
+    nz = adiag[i] - adiag[i+1] - 1;
+    s  = t + BS*i;
+    for (r=0; r<BS; r++) ls[r] = s[r];
+    for (k=0; k<nz; k++) {
+      tj = t + BS*vi[k];
+      for (c=0; c<BS; c++) {
+        for (r=0; r<BS; r++) ls[r] -= v[c*BS+r]*tj[c];
+      }
+      v += BS*BS;
+    }
+    /* multiply by the inverse of the diagonal block */
+    v = aa + BS*BS*adiag[i];
+    for (r=0; r<BS; r++) s[r] = 0.0;
+    for (c=0; c<BS; c++) {
+      for (r=0; r<BS; r++) s[r] += v[c*BS+r]*ls[c];
+    }
+    for (r=0; r<BS; r++) x[BS*i+r] = s[r];
+  }
+
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*BS*BS*a->nz - BS*A->cmap->n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode FIXED(MatSolve_SeqBAIJ)(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqBAIJ       *a = (Mat_SeqBAIJ*)A->data;
+  IS                iscol = a->col,isrow = a->row;
+  const PetscInt    *r,*c,*rout,*cout,*ai = a->i,*aj = a->j,*adiag = a->diag,*vi;
+  PetscInt          i,k,p,q,n = a->mbs,nz;
+  const MatScalar   *aa = a->a,*v;
+  PetscScalar       *x,*t,*s,ls[BS];
+  const PetscScalar *b,*tj;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  t    = a->solve_work;
+
+  ierr = ISGetIndices(isrow,&rout);CHKERRQ(ierr); r = rout;
+  ierr = ISGetIndices(iscol,&cout);CHKERRQ(ierr); c = cout;
+
+  /* forward solve the lower triangular */
+  for (i=0; i<n; i++) {
+    v  = aa + BS*BS*ai[i];
+    vi = aj + ai[i];
+    nz = ai[i+1] - ai[i];
+    for (p=0; p<BS; p++) ls[p] = b[BS*r[i]+p];
+    for (k=0; k<nz; k++) {
+      tj = t + BS*vi[k];
+      for (q=0; q<BS; q++) {
+        for (p=0; p<BS; p++) ls[p] -= v[q*BS+p]*tj[q];
+      }
+      v += BS*BS;
+    }
+    s = t + BS*i;
+    for (p=0; p<BS; p++) s[p] = ls[p];
+  }
+
+  /* backward solve the upper triangular */
+  for (i=n-1; i>=0; i--) {
+    v  = aa + BS*BS*(adiag[i+1]+1);
+    vi = aj + adiag[i+1] + 1;
+    nz = adiag[i] - adiag[i+1] - 1;
+    s  = t + BS*i;
+    for (p=0; p<BS; p++) ls[p] = s[p];
+    for (k=0; k<nz; k++) {
+      tj = t + BS*vi[k];
+      for (q=0; q<BS; q++) {
+        for (p=0; p<BS; p++) ls[p] -= v[q*BS+p]*tj[q];
+      }
+      v += BS*BS;
+    }
+    /* multiply by the inverse of the diagonal block */
+    v = aa + BS*BS*adiag[i];
+    for (p=0; p<BS; p++) s[p] = 0.0;
+    for (q=0; q<BS; q++) {
+      for (p=0; p<BS; p++) s[p] += v[q*BS+p]*ls[q];
+    }
+    for (p=0; p<BS; p++) x[BS*c[i]+p] = s[p];
+  }
+
+  ierr = ISRestoreIndices(isrow,&rout);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(iscol,&cout);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*BS*BS*a->nz - BS*A->cmap->n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* MatLUFactorNumeric_SeqBAIJ_N() with the block products written out for the fixed size */
+static PetscErrorCode FIXED(MatLUFactorNumeric_SeqBAIJ)(Mat B,Mat A,const MatFactorInfo *info)
+{
+  Mat            C     = B;
+  Mat_SeqBAIJ    *a    = (Mat_SeqBAIJ*)A->data,*b = (Mat_SeqBAIJ*)C->data;
+  IS             isrow = b->row,isicol = b->icol;
+  const PetscInt *r,*ic;
+  PetscInt       i,j,k,p,q,l,n = a->mbs,*ai = a->i,*aj = a->j,*bi = b->i,*bj = b->j;
+  PetscInt       *ajtmp,*bjtmp,nz,nzL,row,*bdiag = b->diag,*pj,flg;
+  PetscInt       v_pivots[BS];
+  MatScalar      *rtmp,*pc,*v,*pv,*pa,*aa = a->a,mwork[BS*BS],v_work[BS],sum;
+  PetscBool      col_identity,row_identity,allowzeropivot,zeropivotdetected;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = ISGetIndices(isrow,&r);CHKERRQ(ierr);
+  ierr = ISGetIndices(isicol,&ic);CHKERRQ(ierr);
+  allowzeropivot = PetscNot(A->erroriffailure);
+
+  ierr = PetscCalloc1(BS*BS*n,&rtmp);CHKERRQ(ierr);
+
+  for (i=0; i<n; i++) {
+    /* zero rtmp */
+    /* L part */
+    nz    = bi[i+1] - bi[i];
+    bjtmp = bj + bi[i];
+    for (j=0; j<nz; j++) {
+      ierr = PetscMemzero(rtmp+BS*BS*bjtmp[j],BS*BS*sizeof(MatScalar));CHKERRQ(ierr);
+    }
+
+    /* U part */
+    nz    = bdiag[i] - bdiag[i+1];
+    bjtmp = bj + bdiag[i+1]+1;
+    for (j=0; j<nz; j++) {
+      ierr = PetscMemzero(rtmp+BS*BS*bjtmp[j],BS*BS*sizeof(MatScalar));CHKERRQ(ierr);
+    }
+
+    /* load in initial (unfactored row) */
+    nz    = ai[r[i]+1] - ai[r[i]];
+    ajtmp = aj + ai[r[i]];
+    v     = aa + BS*BS*ai[r[i]];
+    for (j=0; j<nz; j++) {
+      ierr = PetscMemcpy(rtmp+BS*BS*ic[ajtmp[j]],v+BS*BS*j,BS*BS*sizeof(MatScalar));CHKERRQ(ierr);
+    }
+
+    /* elimination */
+    bjtmp = bj + bi[i];
+    nzL   = bi[i+1] - bi[i];
+    for (k=0; k < nzL; k++) {
+      row = bjtmp[k];
+      pc  = rtmp + BS*BS*row;
+      for (flg=0,j=0; j<BS*BS; j++) {
+        if (pc[j] != (MatScalar)0.0) {
+          flg = 1;
+          break;
+        }
+      }
+      if (flg) {
+        /* *pc = *pc * (*pv) with the inverse of the diagonal block of the pivot row */
+        pv = b->a + BS*BS*bdiag[row];
+        for (j=0; j<BS*BS; j++) mwork[j] = pc[j];
+        for (q=0; q<BS; q++) {
+          for (p=0; p<BS; p++) {
+            sum = 0.0;
+            for (l=0; l<BS; l++) sum += mwork[l*BS+p]*pv[q*BS+l];
+            pc[q*BS+p] = sum;
+          }
+        }
+        pj = b->j + bdiag[row+1]+1;         /* begining of U(row,:) */
+        pv = b->a + BS*BS*(bdiag[row+1]+1);
+        nz = bdiag[row] - bdiag[row+1] - 1; /* num of entries inU(row,:), excluding diag */
+        for (j=0; j<nz; j++) {
+          pa = rtmp + BS*BS*pj[j];
+          for (q=0; q<BS; q++) {
+            for (l=0; l<BS; l++) {
+              for (p=0; p<BS; p++) pa[q*BS+p] -= pc[l*BS+p]*pv[q*BS+l];
+            }
+          }
+          pv += BS*BS;
+        }
+        ierr = PetscLogFlops(2.0*BS*BS*BS*(nz+1)-BS*BS);CHKERRQ(ierr); /* flops = 2*bs^3*nz + 2*bs^3 - bs2) */
+      }
+    }
+
+    /* finished row so stick it into b->a */
+    /* L part */
+    pv = b->a + BS*BS*bi[i];
+    pj = b->j + bi[i];
+    nz = bi[i+1] - bi[i];
+    for (j=0; j<nz; j++) {
+      ierr = PetscMemcpy(pv+BS*BS*j,rtmp+BS*BS*pj[j],BS*BS*sizeof(MatScalar));CHKERRQ(ierr);
+    }
+
+    /* Mark diagonal and invert diagonal for simplier triangular solves */
+    pv   = b->a + BS*BS*bdiag[i];
+    pj   = b->j + bdiag[i];
+    ierr = PetscMemcpy(pv,rtmp+BS*BS*pj[0],BS*BS*sizeof(MatScalar));CHKERRQ(ierr);
+
+    ierr = PetscKernel_A_gets_inverse_A(BS,pv,v_pivots,v_work,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
+    if (zeropivotdetected) B->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
+
+    /* U part */
+    pv = b->a + BS*BS*(bdiag[i+1]+1);
+    pj = b->j + bdiag[i+1]+1;
+    nz = bdiag[i] - bdiag[i+1] - 1;
+    for (j=0; j<nz; j++) {
+      ierr = PetscMemcpy(pv+BS*BS*j,rtmp+BS*BS*pj[j],BS*BS*sizeof(MatScalar));CHKERRQ(ierr);
+    }
+  }
+
+  ierr = PetscFree(rtmp);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(isicol,&ic);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(isrow,&r);CHKERRQ(ierr);
+
+  ierr = ISIdentity(isrow,&row_identity);CHKERRQ(ierr);
+  ierr = ISIdentity(isicol,&col_identity);CHKERRQ(ierr);
+  if (row_identity && col_identity) {
+    C->ops->solve = FIXED(MatSolve_SeqBAIJ_NaturalOrdering);
+  } else {
+    C->ops->solve = FIXED(MatSolve_SeqBAIJ);
+  }
+  C->ops->solvetranspose = MatSolveTranspose_SeqBAIJ_N;
+
+  C->assembled = PETSC_TRUE;
+
+  ierr = PetscLogFlops(1.333333333333*BS*BS*BS*b->mbs);CHKERRQ(ierr); /* from inverting diagonal blocks */
+  PetscFunctionReturn(0);
+}
@@ -0,0 +1,879 @@
+
+/*
+    Defines the basic matrix operations for the KAIJ matrix storage format.
+  This format is used for problems with several unknowns per node that are
+  coupled the same way at every node, for example the stage systems of fully
+  implicit Runge-Kutta methods or multicomponent reaction-diffusion problems.
+  With dof unknowns per node, interlaced, block (i,j) of the matrix is
+
+                    delta_ij S + a_ij T
+
+  where A = (a_ij) is an AIJ matrix and S, T are dense dof by dof matrices,
+  that is the matrix is I kron S + A kron T.  Only A, S and T are stored, the
+  matrix itself is never formed.  MAIJ is the special case S = 0, T = I.
+
+     We provide:
+         MatMult()
+         MatMultTranspose()
+         MatMultTransposeAdd()
+         MatMultAdd()
+         MatSOR()
+         MatGetDiagonal()
+          and
+         MatCreateKAIJ(Mat,dof,S,T,Mat*)
+
+     This single directory handles both the sequential and parallel codes
+*/
+
+#include <../src/mat/impls/kaij/kaij.h> /*I "petscmat.h" I*/
+#include <petsc/private/kernels/blockinvert.h>
+
+/*@
+   MatKAIJGetAIJ - Get the AIJ matrix A of the KAIJ matrix I kron S + A kron T
+
+   Not Collective, but if the KAIJ matrix is parallel, the AIJ matrix is also parallel
+
+   Input Parameter:
+.  A - the KAIJ matrix
+
+   Output Parameter:
+.  B - the AIJ matrix
+
+   Level: advanced
+
+   Notes: The reference count on the AIJ matrix is not increased so you should not destroy it.
+
+.seealso: MatCreateKAIJ(), MatKAIJGetS(), MatKAIJGetT()
+@*/
+PetscErrorCode  MatKAIJGetAIJ(Mat A,Mat *B)
+{
+  PetscErrorCode ierr;
+  PetscBool      ismpikaij,isseqkaij;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)A,MATMPIKAIJ,&ismpikaij);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)A,MATSEQKAIJ,&isseqkaij);CHKERRQ(ierr);
+  if (ismpikaij) {
+    Mat_MPIKAIJ *b = (Mat_MPIKAIJ*)A->data;
+
+    *B = b->A;
+  } else if (isseqkaij) {
+    Mat_SeqKAIJ *b = (Mat_SeqKAIJ*)A->data;
+
+    *B = b->AIJ;
+  } else SETERRQ(PetscObjectComm((PetscObject)A),PETSC_ERR_ARG_WRONG,"Matrix passed in is not of type KAIJ");
+  PetscFunctionReturn(0);
+}
+
+/* gets the pieces shared by the sequential and the parallel formats */
+static PetscErrorCode MatKAIJGetBlocks_Private(Mat A,PetscInt *dof,const PetscScalar **S,const PetscScalar **T,PetscBool *isTI)
+{
+  PetscErrorCode ierr;
+  PetscBool      ismpikaij,isseqkaij;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)A,MATMPIKAIJ,&ismpikaij);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)A,MATSEQKAIJ,&isseqkaij);CHKERRQ(ierr);
+  if (ismpikaij) {
+    Mat_MPIKAIJ *b = (Mat_MPIKAIJ*)A->data;
+
+    if (dof)  *dof  = b->dof;
+    if (S)    *S    = b->S;
+    if (T)    *T    = b->T;
+    if (isTI) *isTI = b->isTI;
+  } else if (isseqkaij) {
+    Mat_SeqKAIJ *b = (Mat_SeqKAIJ*)A->data;
+
+    if (dof)  *dof  = b->dof;
+    if (S)    *S    = b->S;
+    if (T)    *T    = b->T;
+    if (isTI) *isTI = b->isTI;
+  } else SETERRQ(PetscObjectComm((PetscObject)A),PETSC_ERR_ARG_WRONG,"Matrix passed in is not of type KAIJ");
+  PetscFunctionReturn(0);
+}
+
+/*@C
+   MatKAIJGetS - Get the dense matrix S of the KAIJ matrix I kron S + A kron T
+
+   Not Collective
+
+   Input Parameter:
+.  A - the KAIJ matrix
+
+   Output Parameters:
++  dof - the size of S, or NULL
+-  S - the dof by dof matrix S in column major order, NULL if S is zero
+
+   Level: advanced
+
+.seealso: MatCreateKAIJ(), MatKAIJGetAIJ(), MatKAIJGetT()
+@*/
+PetscErrorCode  MatKAIJGetS(Mat A,PetscInt *dof,const PetscScalar **S)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatKAIJGetBlocks_Private(A,dof,S,NULL,NULL);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*@C
+   MatKAIJGetT - Get the dense matrix T of the KAIJ matrix I kron S + A kron T
+
+   Not Collective
+
+   Input Parameter:
+.  A - the KAIJ matrix
+
+   Output Parameters:
++  dof - the size of T, or NULL
+-  T - the dof by dof matrix T in column major order
+
+   Level: advanced
+
+.seealso: MatCreateKAIJ(), MatKAIJGetAIJ(), MatKAIJGetS()
+@*/
+PetscErrorCode  MatKAIJGetT(Mat A,PetscInt *dof,const PetscScalar **T)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatKAIJGetBlocks_Private(A,dof,NULL,T,NULL);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* copies S and T, a NULL S means zero and a NULL T means the identity */
+static PetscErrorCode MatKAIJSetBlocks_Private(PetscInt dof,const PetscScalar S[],const PetscScalar T[],PetscScalar **bS,PetscScalar **bT,PetscBool *isTI)
+{
+  PetscErrorCode ierr;
+  PetscInt       i,j;
+
+  PetscFunctionBegin;
+  *bS = NULL;
+  if (S) {
+    ierr = PetscMalloc1(dof*dof,bS);CHKERRQ(ierr);
+    ierr = PetscMemcpy(*bS,S,dof*dof*sizeof(PetscScalar));CHKERRQ(ierr);
+  }
+  ierr = PetscMalloc1(dof*dof,bT);CHKERRQ(ierr);
+  if (T) {
+    ierr = PetscMemcpy(*bT,T,dof*dof*sizeof(PetscScalar));CHKERRQ(ierr);
+  } else {
+    ierr = PetscMemzero(*bT,dof*dof*sizeof(PetscScalar));CHKERRQ(ierr);
+    for (i=0; i<dof; i++) (*bT)[i+i*dof] = 1.0;
+  }
+  *isTI = PETSC_TRUE;
+  for (j=0; j<dof; j++) {
+    for (i=0; i<dof; i++) {
+      if ((*bT)[i+j*dof] != (PetscScalar)(i == j ? 1.0 : 0.0)) *isTI = PETSC_FALSE;
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatDestroy_SeqKAIJ(Mat A)
+{
+  PetscErrorCode ierr;
+  Mat_SeqKAIJ    *b = (Mat_SeqKAIJ*)A->data;
+
+  PetscFunctionBegin;
+  ierr = MatDestroy(&b->AIJ);CHKERRQ(ierr);
+  ierr = PetscFree(b->S);CHKERRQ(ierr);
+  ierr = PetscFree(b->T);CHKERRQ(ierr);
+  ierr = PetscFree(b->ibdiag);CHKERRQ(ierr);
+  ierr = PetscFree(b->work);CHKERRQ(ierr);
+  ierr = PetscFree(A->data);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqkaij_seqaij_C",NULL);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatSetUp_KAIJ(Mat A)
+{
+  PetscFunctionBegin;
+  SETERRQ(PetscObjectComm((PetscObject)A),PETSC_ERR_SUP,"Must use MatCreateKAIJ() to create KAIJ matrices");
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatView_KAIJ(Mat A,PetscViewer viewer)
+{
+  PetscErrorCode ierr;
+  Mat            B;
+
+  PetscFunctionBegin;
+  ierr = MatConvert(A,MATAIJ,MAT_INITIAL_MATRIX,&B);CHKERRQ(ierr);
+  ierr = MatView(B,viewer);CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatDestroy_MPIKAIJ(Mat A)
+{
+  PetscErrorCode ierr;
+  Mat_MPIKAIJ    *b = (Mat_MPIKAIJ*)A->data;
+
+  PetscFunctionBegin;
+  ierr = MatDestroy(&b->AIJ);CHKERRQ(ierr);
+  ierr = MatDestroy(&b->OAIJ);CHKERRQ(ierr);
+  ierr = MatDestroy(&b->A);CHKERRQ(ierr);
+  ierr = PetscFree(b->S);CHKERRQ(ierr);
+  ierr = PetscFree(b->T);CHKERRQ(ierr);
+  ierr = VecScatterDestroy(&b->ctx);CHKERRQ(ierr);
+  ierr = VecDestroy(&b->w);CHKERRQ(ierr);
+  ierr = PetscFree(A->data);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_mpikaij_mpiaij_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectChangeTypeName((PetscObject)A,0);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+  MATKAIJ - MATKAIJ = "kaij" - A matrix type for problems with dof unknowns per node that are
+  coupled the same way at every node.  The matrix is I kron S + A kron T: with the unknowns of
+  each node interlaced, block (i,j) is delta_ij S + a_ij T.  Only the AIJ matrix A and the dense
+  dof by dof matrices S and T are stored, so the memory used is that of A alone instead of about
+  dof*dof times that.  Fully implicit Runge-Kutta stage systems have this form, with S the inverse
+  of the Butcher matrix scaled by 1/dt and T the identity, as do multicomponent problems where all
+  components see the same operator.  The matrix type is based on MATSEQAIJ for sequential
+  matrices, and MATMPIAIJ for distributed matrices.
+
+  Operations provided:
+. MatMult
+. MatMultTranspose
+. MatMultAdd
+. MatMultTransposeAdd
+. MatSOR (point-block, the blocks being S + a_ii T; only local sweeps in parallel)
+. MatGetDiagonal
+. MatInvertBlockDiagonal (sequential only)
+
+  Level: advanced
+
+.seealso: MatKAIJGetAIJ(), MatKAIJGetS(), MatKAIJGetT(), MatCreateKAIJ(), MATMAIJ
+M*/
+
+PETSC_EXTERN PetscErrorCode MatCreate_KAIJ(Mat A)
+{
+  PetscErrorCode ierr;
+  PetscMPIInt    size;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_size(PetscObjectComm((PetscObject)A),&size);CHKERRQ(ierr);
+  if (size == 1) {
+    Mat_SeqKAIJ *b;
+
+    ierr    = PetscNewLog(A,&b);CHKERRQ(ierr);
+    A->data = (void*)b;
+  } else {
+    Mat_MPIKAIJ *b;
+
+    ierr    = PetscNewLog(A,&b);CHKERRQ(ierr);
+    A->data = (void*)b;
+  }
+
+  ierr = PetscMemzero(A->ops,sizeof(struct _MatOps));CHKERRQ(ierr);
+
+  A->ops->setup = MatSetUp_KAIJ;
+
+  if (size == 1) {
+    ierr = PetscObjectChangeTypeName((PetscObject)A,MATSEQKAIJ);CHKERRQ(ierr);
+  } else {
+    ierr = PetscObjectChangeTypeName((PetscObject)A,MATMPIKAIJ);CHKERRQ(ierr);
+  }
+  A->preallocated  = PETSC_TRUE;
+  A->assembled     = PETSC_TRUE;
+  PetscFunctionReturn(0);
+}
+
+/* --------------------------------------------------------------------------------------*/
+/* y[i] += T (sum_j a_ij x[j]) + S x[i] for each block row i */
+static PetscErrorCode MatMultAdd_SeqKAIJ_Private(Mat A,const PetscScalar *x,PetscScalar *y)
+{
+  Mat_SeqKAIJ       *b = (Mat_SeqKAIJ*)A->data;
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)b->AIJ->data;
+  const PetscScalar *v,*xj,*S = b->S,*T = b->T;
+  PetscScalar       *sums = b->work,*yi;
+  PetscErrorCode    ierr;
+  const PetscInt    m = b->AIJ->rmap->n,dof = b->dof,*idx,*ii = a->i;
+  PetscInt          nonzerorow = 0,n,i,j,k,l;
+
+  PetscFunctionBegin;
+  for (i=0; i<m; i++) {
+    idx = a->j + ii[i];
+    v   = a->a + ii[i];
+    n   = ii[i+1] - ii[i];
+    yi  = y + dof*i;
+    nonzerorow += (n>0);
+    if (b->isTI) {
+      for (j=0; j<n; j++) {
+        xj = x + dof*idx[j];
+        for (k=0; k<dof; k++) yi[k] += v[j]*xj[k];
+      }
+    } else if (n) {
+      for (k=0; k<dof; k++) sums[k] = 0.0;
+      for (j=0; j<n; j++) {
+        xj = x + dof*idx[j];
+        for (k=0; k<dof; k++) sums[k] += v[j]*xj[k];
+      }
+      for (l=0; l<dof; l++) {
+        for (k=0; k<dof; k++) yi[k] += T[k+l*dof]*sums[l];
+      }
+    }
+    if (S) {
+      xj = x + dof*i;
+      for (l=0; l<dof; l++) {
+        for (k=0; k<dof; k++) yi[k] += S[k+l*dof]*xj[l];
+      }
+    }
+  }
+  ierr = PetscLogFlops(2.0*dof*a->nz + (b->isTI ? 0.0 : 2.0*dof*dof*nonzerorow) + (S ? 2.0*dof*dof*m : 0.0));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* y[j] += T^T (sum_i a_ij x[i]) + S^T x[j] for each block row j */
+static PetscErrorCode MatMultTransposeAdd_SeqKAIJ_Private(Mat A,const PetscScalar *x,PetscScalar *y)
+{
+  Mat_SeqKAIJ       *b = (Mat_SeqKAIJ*)A->data;
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)b->AIJ->data;
+  const PetscScalar *v,*xi,*alpha,*S = b->S,*T = b->T;
+  PetscScalar       *u = b->work,*yj;
+  PetscErrorCode    ierr;
+  const PetscInt    m = b->AIJ->rmap->n,dof = b->dof,*idx,*ii = a->i;
+  PetscInt          nonzerorow = 0,n,i,j,k,l;
+
+  PetscFunctionBegin;
+  for (i=0; i<m; i++) {
+    idx = a->j + ii[i];
+    v   = a->a + ii[i];
+    n   = ii[i+1] - ii[i];
+    xi  = x + dof*i;
+    nonzerorow += (n>0);
+    if (b->isTI) alpha = xi;
+    else if (n) {
+      for (k=0; k<dof; k++) {
+        u[k] = 0.0;
+        for (l=0; l<dof; l++) u[k] += T[l+k*dof]*xi[l];
+      }
+      alpha = u;
+    } else alpha = NULL;
+    for (j=0; j<n; j++) {
+      yj = y + dof*idx[j];
+      for (k=0; k<dof; k++) yj[k] += v[j]*alpha[k];
+    }
+    if (S) {
+      yj = y + dof*i;
+      for (k=0; k<dof; k++) {
+        for (l=0; l<dof; l++) yj[k] += S[l+k*dof]*xi[l];
+      }
+    }
+  }
+  ierr = PetscLogFlops(2.0*dof*a->nz + (b->isTI ? 0.0 : 2.0*dof*dof*nonzerorow) + (S ? 2.0*dof*dof*m : 0.0));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMult_SeqKAIJ(Mat A,Vec xx,Vec yy)
+{
+  const PetscScalar *x;
+  PetscScalar       *y;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecSet(yy,0.0);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  ierr = MatMultAdd_SeqKAIJ_Private(A,x,y);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultAdd_SeqKAIJ(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  const PetscScalar *x;
+  PetscScalar       *y;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (yy != zz) {ierr = VecCopy(yy,zz);CHKERRQ(ierr);}
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(zz,&y);CHKERRQ(ierr);
+  ierr = MatMultAdd_SeqKAIJ_Private(A,x,y);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(zz,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTranspose_SeqKAIJ(Mat A,Vec xx,Vec yy)
+{
+  const PetscScalar *x;
+  PetscScalar       *y;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecSet(yy,0.0);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd_SeqKAIJ_Private(A,x,y);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTransposeAdd_SeqKAIJ(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  const PetscScalar *x;
+  PetscScalar       *y;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (yy != zz) {ierr = VecCopy(yy,zz);CHKERRQ(ierr);}
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(zz,&y);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd_SeqKAIJ_Private(A,x,y);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(zz,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatGetDiagonal_SeqKAIJ(Mat A,Vec vv)
+{
+  Mat_SeqKAIJ       *b = (Mat_SeqKAIJ*)A->data;
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)b->AIJ->data;
+  const PetscScalar *S = b->S,*T = b->T;
+  PetscScalar       *v,aii;
+  PetscErrorCode    ierr;
+  const PetscInt    m = b->AIJ->rmap->n,dof = b->dof;
+  PetscInt          i,k;
+
+  PetscFunctionBegin;
+  if (A->rmap->n != A->cmap->n) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Matrix must be square to get the diagonal");
+  ierr = MatMarkDiagonal_SeqAIJ(b->AIJ);CHKERRQ(ierr);
+  ierr = VecGetArray(vv,&v);CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    aii = (a->diag[i] < a->i[i+1]) ? a->a[a->diag[i]] : 0.0;
+    for (k=0; k<dof; k++) v[dof*i+k] = aii*T[k+k*dof] + (S ? S[k+k*dof] : 0.0);
+  }
+  ierr = VecRestoreArray(vv,&v);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* inverts the blocks S + a_ii T; recomputed when the values of A change */
+PetscErrorCode MatInvertBlockDiagonal_SeqKAIJ(Mat A,const PetscScalar **values)
+{
+  Mat_SeqKAIJ       *b = (Mat_SeqKAIJ*)A->data;
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)b->AIJ->data;
+  const PetscScalar *S = b->S,*T = b->T;
+  PetscScalar       aii;
+  MatScalar         *diag,*v_work;
+  PetscErrorCode    ierr;
+  const PetscInt    m = b->AIJ->rmap->n,dof = b->dof,dof2 = dof*dof;
+  PetscInt          i,k,*v_pivots;
+  PetscBool         allowzeropivot,zeropivotdetected = PETSC_FALSE;
+
+  PetscFunctionBegin;
+  allowzeropivot = PetscNot(A->erroriffailure);
+  if (b->ibdiagvalid && b->ibdiagstate == ((PetscObject)b->AIJ)->state) {
+    if (values) *values = b->ibdiag;
+    PetscFunctionReturn(0);
+  }
+  if (A->rmap->n != A->cmap->n) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Matrix must be square to invert the block diagonal");
+  ierr = MatMarkDiagonal_SeqAIJ(b->AIJ);CHKERRQ(ierr);
+  if (!b->ibdiag) {
+    ierr = PetscMalloc1(dof2*m,&b->ibdiag);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)A,dof2*m*sizeof(MatScalar));CHKERRQ(ierr);
+  }
+  ierr = PetscMalloc2(dof,&v_work,dof,&v_pivots);CHKERRQ(ierr);
+  diag = b->ibdiag;
+  for (i=0; i<m; i++) {
+    aii = (a->diag[i] < a->i[i+1]) ? a->a[a->diag[i]] : 0.0;
+    for (k=0; k<dof2; k++) diag[k] = aii*T[k] + (S ? S[k] : 0.0);
+    ierr = PetscKernel_A_gets_inverse_A(dof,diag,v_pivots,v_work,allowzeropivot,&zeropivotdetected);CHKERRQ(ierr);
+    if (zeropivotdetected) A->factorerrortype = MAT_FACTOR_NUMERIC_ZEROPIVOT;
+    diag += dof2;
+  }
+  ierr = PetscFree2(v_work,v_pivots);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*dof*dof2*m);CHKERRQ(ierr);
+  b->ibdiagvalid = PETSC_TRUE;
+  b->ibdiagstate = ((PetscObject)b->AIJ)->state;
+  if (values) *values = b->ibdiag;
+  PetscFunctionReturn(0);
+}
+
+/* relaxes block row i: x[i] = (1-omega) x[i] + omega (S + a_ii T)^{-1} (b[i] - T sum_{j != i} a_ij x[j]) */
+PETSC_STATIC_INLINE void MatSORRow_SeqKAIJ_Private(Mat_SeqKAIJ *kaij,Mat_SeqAIJ *a,PetscInt i,const PetscScalar *b,PetscScalar *x,PetscReal omega)
+{
+  const PetscInt    dof = kaij->dof,*idx = a->j + a->i[i],n = a->i[i+1] - a->i[i];
+  const PetscScalar *v = a->a + a->i[i],*T = kaij->T,*xj,*bi = b + dof*i;
+  const MatScalar   *idiag = kaij->ibdiag + dof*dof*i;
+  PetscScalar       *t = kaij->work,*r = kaij->work + dof,*xi = x + dof*i,s;
+  PetscInt          j,k,l;
+
+  for (k=0; k<dof; k++) t[k] = 0.0;
+  for (j=0; j<n; j++) {
+    if (idx[j] == i) continue;
+    xj = x + dof*idx[j];
+    for (k=0; k<dof; k++) t[k] += v[j]*xj[k];
+  }
+  if (kaij->isTI) {
+    for (k=0; k<dof; k++) r[k] = bi[k] - t[k];
+  } else {
+    for (k=0; k<dof; k++) r[k] = bi[k];
+    for (l=0; l<dof; l++) {
+      for (k=0; k<dof; k++) r[k] -= T[k+l*dof]*t[l];
+    }
+  }
+  for (k=0; k<dof; k++) {
+    s = 0.0;
+    for (l=0; l<dof; l++) s += idiag[k+l*dof]*r[l];
+    xi[k] = (1.0-omega)*xi[k] + omega*s;
+  }
+}
+
+PetscErrorCode MatSOR_SeqKAIJ(Mat A,Vec bb,PetscReal omega,MatSORType flag,PetscReal fshift,PetscInt its,PetscInt lits,Vec xx)
+{
+  Mat_SeqKAIJ       *kaij = (Mat_SeqKAIJ*)A->data;
+  Mat_SeqAIJ        *a    = (Mat_SeqAIJ*)kaij->AIJ->data;
+  const PetscScalar *b;
+  PetscScalar       *x;
+  PetscErrorCode    ierr;
+  const PetscInt    m = kaij->AIJ->rmap->n,dof = kaij->dof;
+  PetscInt          i,it;
+
+  PetscFunctionBegin;
+  if (fshift == -1.0) fshift = 0.0; /* negative fshift indicates do not error on zero diagonal; this code never errors on zero diagonal */
+  its = its*lits;
+  if (flag & SOR_EISENSTAT) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"No support yet for Eisenstat");
+  if (its <= 0) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Relaxation requires global its %D and local its %D both positive",its,lits);
+  if (fshift) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Sorry, no support for diagonal shift");
+  if ((flag & SOR_APPLY_UPPER) || (flag & SOR_APPLY_LOWER)) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Sorry, no support for applying upper or lower triangular parts");
+
+  ierr = MatInvertBlockDiagonal_SeqKAIJ(A,NULL);CHKERRQ(ierr);
+  if (flag & SOR_ZERO_INITIAL_GUESS) {ierr = VecSet(xx,0.0);CHKERRQ(ierr);}
+
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  for (it=0; it<its; it++) {
+    if (flag & SOR_FORWARD_SWEEP || flag & SOR_LOCAL_FORWARD_SWEEP) {
+      for (i=0; i<m; i++) MatSORRow_SeqKAIJ_Private(kaij,a,i,b,x,omega);
+      ierr = PetscLogFlops(2.0*dof*a->nz + 4.0*dof*dof*m);CHKERRQ(ierr);
+    }
+    if (flag & SOR_BACKWARD_SWEEP || flag & SOR_LOCAL_BACKWARD_SWEEP) {
+      for (i=m-1; i>=0; i--) MatSORRow_SeqKAIJ_Private(kaij,a,i,b,x,omega);
+      ierr = PetscLogFlops(2.0*dof*a->nz + 4.0*dof*dof*m);CHKERRQ(ierr);
+    }
+  }
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*===================================================================================*/
+PetscErrorCode MatMult_MPIKAIJ(Mat A,Vec xx,Vec yy)
+{
+  Mat_MPIKAIJ    *b = (Mat_MPIKAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  /* start the scatter */
+  ierr = VecScatterBegin(b->ctx,xx,b->w,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  ierr = (*b->AIJ->ops->mult)(b->AIJ,xx,yy);CHKERRQ(ierr);
+  ierr = VecScatterEnd(b->ctx,xx,b->w,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  ierr = (*b->OAIJ->ops->multadd)(b->OAIJ,b->w,yy,yy);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTranspose_MPIKAIJ(Mat A,Vec xx,Vec yy)
+{
+  Mat_MPIKAIJ    *b = (Mat_MPIKAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = (*b->OAIJ->ops->multtranspose)(b->OAIJ,xx,b->w);CHKERRQ(ierr);
+  ierr = (*b->AIJ->ops->multtranspose)(b->AIJ,xx,yy);CHKERRQ(ierr);
+  ierr = VecScatterBegin(b->ctx,b->w,yy,ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+  ierr = VecScatterEnd(b->ctx,b->w,yy,ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultAdd_MPIKAIJ(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_MPIKAIJ    *b = (Mat_MPIKAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  /* start the scatter */
+  ierr = VecScatterBegin(b->ctx,xx,b->w,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  ierr = (*b->AIJ->ops->multadd)(b->AIJ,xx,yy,zz);CHKERRQ(ierr);
+  ierr = VecScatterEnd(b->ctx,xx,b->w,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  ierr = (*b->OAIJ->ops->multadd)(b->OAIJ,b->w,zz,zz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTransposeAdd_MPIKAIJ(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_MPIKAIJ    *b = (Mat_MPIKAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = (*b->OAIJ->ops->multtranspose)(b->OAIJ,xx,b->w);CHKERRQ(ierr);
+  ierr = VecScatterBegin(b->ctx,b->w,zz,ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+  ierr = (*b->AIJ->ops->multtransposeadd)(b->AIJ,xx,yy,zz);CHKERRQ(ierr);
+  ierr = VecScatterEnd(b->ctx,b->w,zz,ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatGetDiagonal_MPIKAIJ(Mat A,Vec v)
+{
+  Mat_MPIKAIJ    *b = (Mat_MPIKAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (A->rmap->rstart != A->cmap->rstart || A->rmap->rend != A->cmap->rend) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Only works for matrices with matching row and column layouts");
+  ierr = MatGetDiagonal(b->AIJ,v);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* only processor local sweeps, the off-process coupling is moved to the right hand side */
+PetscErrorCode MatSOR_MPIKAIJ(Mat A,Vec bb,PetscReal omega,MatSORType flag,PetscReal fshift,PetscInt its,PetscInt lits,Vec xx)
+{
+  Mat_MPIKAIJ    *b   = (Mat_MPIKAIJ*)A->data;
+  Vec            bb1  = NULL;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if ((flag & SOR_EISENSTAT) || (flag & SOR_APPLY_UPPER) || (flag & SOR_APPLY_LOWER)) SETERRQ(PetscObjectComm((PetscObject)A),PETSC_ERR_SUP,"Sorry, no support for Eisenstat or applying upper or lower triangular parts");
+  if (!(flag & SOR_LOCAL_SYMMETRIC_SWEEP)) SETERRQ(PetscObjectComm((PetscObject)A),PETSC_ERR_SUP,"Parallel SOR not supported");
+
+  if (flag & SOR_ZERO_INITIAL_GUESS) {
+    ierr = (*b->AIJ->ops->sor)(b->AIJ,bb,omega,flag,fshift,lits,1,xx);CHKERRQ(ierr);
+    its--;
+  }
+  if (its > 0) {ierr = VecDuplicate(bb,&bb1);CHKERRQ(ierr);}
+  while (its-- > 0) {
+    ierr = VecScatterBegin(b->ctx,xx,b->w,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+    ierr = VecScatterEnd(b->ctx,xx,b->w,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+
+    /* update rhs: bb1 = bb - B*x */
+    ierr = VecScale(b->w,-1.0);CHKERRQ(ierr);
+    ierr = (*b->OAIJ->ops->multadd)(b->OAIJ,b->w,bb,bb1);CHKERRQ(ierr);
+
+    /* local sweep */
+    ierr = (*b->AIJ->ops->sor)(b->AIJ,bb1,omega,(MatSORType)(flag & SOR_LOCAL_SYMMETRIC_SWEEP),fshift,lits,1,xx);CHKERRQ(ierr);
+  }
+  ierr = VecDestroy(&bb1);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* ---------------------------------------------------------------------------------- */
+/* assembles I kron S + A kron T as an AIJ matrix, for both the sequential and the parallel formats */
+PetscErrorCode MatConvert_KAIJ_AIJ(Mat A,MatType newtype,MatReuse reuse,Mat *newmat)
+{
+  Mat               Aij,B;
+  const PetscScalar *S,*T,*vals;
+  const PetscInt    *cols;
+  PetscScalar       *bvals;
+  PetscErrorCode    ierr;
+  PetscInt          dof,i,j,k,l,r,m,ncols,nd,nmax = 0,rstart,cstart,cend,width,row,nc,*dnz,*onz,*bcols;
+  PetscBool         isTI;
+
+  PetscFunctionBegin;
+  ierr   = MatKAIJGetAIJ(A,&Aij);CHKERRQ(ierr);
+  ierr   = MatKAIJGetBlocks_Private(A,&dof,&S,&T,&isTI);CHKERRQ(ierr);
+  ierr   = MatGetOwnershipRange(Aij,&rstart,NULL);CHKERRQ(ierr);
+  ierr   = MatGetOwnershipRangeColumn(Aij,&cstart,&cend);CHKERRQ(ierr);
+  m      = Aij->rmap->n;
+  width  = isTI ? 1 : dof;
+
+  ierr = PetscMalloc2(A->rmap->n,&dnz,A->rmap->n,&onz);CHKERRQ(ierr);
+  for (r=0; r<m; r++) {
+    ierr = MatGetRow(Aij,rstart+r,&ncols,&cols,NULL);CHKERRQ(ierr);
+    nmax = PetscMax(nmax,ncols);
+    for (nd=0,j=0; j<ncols; j++) nd += (cols[j] >= cstart && cols[j] < cend);
+    for (k=0; k<dof; k++) {
+      dnz[dof*r+k] = PetscMin(width*nd + (S ? dof : 0),A->cmap->n);
+      onz[dof*r+k] = width*(ncols - nd);
+    }
+    ierr = MatRestoreRow(Aij,rstart+r,&ncols,&cols,NULL);CHKERRQ(ierr);
+  }
+  ierr = MatCreate(PetscObjectComm((PetscObject)A),&B);CHKERRQ(ierr);
+  ierr = MatSetSizes(B,A->rmap->n,A->cmap->n,A->rmap->N,A->cmap->N);CHKERRQ(ierr);
+  ierr = MatSetBlockSize(B,dof);CHKERRQ(ierr);
+  ierr = MatSetType(B,MATAIJ);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(B,0,dnz);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(B,0,dnz,0,onz);CHKERRQ(ierr);
+  ierr = PetscFree2(dnz,onz);CHKERRQ(ierr);
+
+  ierr = PetscMalloc2(nmax*width+dof,&bcols,nmax*width+dof,&bvals);CHKERRQ(ierr);
+  for (r=0; r<m; r++) {
+    i    = rstart + r;
+    ierr = MatGetRow(Aij,i,&ncols,&cols,&vals);CHKERRQ(ierr);
+    for (k=0; k<dof; k++) {
+      row = dof*i + k;
+      nc  = 0;
+      for (j=0; j<ncols; j++) {
+        for (l=0; l<dof; l++) {
+          if (isTI && l != k) continue;
+          bcols[nc]   = dof*cols[j] + l;
+          bvals[nc++] = vals[j]*T[k+l*dof];
+        }
+      }
+      if (S) {
+        for (l=0; l<dof; l++) {
+          bcols[nc]   = dof*i + l;
+          bvals[nc++] = S[k+l*dof];
+        }
+      }
+      ierr = MatSetValues(B,1,&row,nc,bcols,bvals,ADD_VALUES);CHKERRQ(ierr);
+    }
+    ierr = MatRestoreRow(Aij,i,&ncols,&cols,&vals);CHKERRQ(ierr);
+  }
+  ierr = PetscFree2(bcols,bvals);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  if (reuse == MAT_INPLACE_MATRIX) {
+    ierr = MatHeaderReplace(A,&B);CHKERRQ(ierr);
+  } else {
+    *newmat = B;
+  }
+  PetscFunctionReturn(0);
+}
+
+/* ---------------------------------------------------------------------------------- */
+/*@C
+  MatCreateKAIJ - Creates a matrix of the form I kron S + A kron T, where A is an AIJ
+  matrix and S and T are small dense matrices, without forming it.  With the dof unknowns
+  of each node interlaced, block (i,j) of the matrix is delta_ij S + a_ij T.  The matrix
+  type is based on MATSEQAIJ for sequential matrices, and MATMPIAIJ for distributed matrices.
+
+  Collective
+
+  Input Parameters:
++ A - the AIJ matrix
+. dof - the size of S and T (number of unknowns per node)
+. S - the dof by dof matrix S in column major order, or NULL for S = 0
+- T - the dof by dof matrix T in column major order, or NULL for T = I
+
+  Output Parameter:
+. kaij - the new KAIJ matrix
+
+  Notes: S and T are copied, A is referenced and must keep its nonzero structure; changing
+  the values of A changes the KAIJ matrix.  When S is given A must be square and, in
+  parallel, have the same row and column layout.
+
+  With S = 0 and T = I this is the MAIJ matrix of A.
+
+  Operations provided:
++ MatMult
+. MatMultTranspose
+. MatMultAdd
+. MatMultTransposeAdd
+. MatSOR
+. MatGetDiagonal
+- MatView
+
+  Level: advanced
+
+.seealso: MatKAIJGetAIJ(), MatKAIJGetS(), MatKAIJGetT(), MATKAIJ, MatCreateMAIJ()
+@*/
+PetscErrorCode  MatCreateKAIJ(Mat A,PetscInt dof,const PetscScalar S[],const PetscScalar T[],Mat *kaij)
+{
+  PetscErrorCode ierr;
+  PetscMPIInt    size;
+  PetscInt       n;
+  Mat            B;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(A,MAT_CLASSID,1);
+  PetscValidLogicalCollectiveInt(A,dof,2);
+  PetscValidPointer(kaij,5);
+  if (dof < 1) SETERRQ1(PetscObjectComm((PetscObject)A),PETSC_ERR_ARG_OUTOFRANGE,"Block size %D must be positive",dof);
+  if (S && (A->rmap->n != A->cmap->n || A->rmap->N != A->cmap->N)) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"S can only be given for a square matrix A with the same row and column layout");
+  ierr = PetscObjectReference((PetscObject)A);CHKERRQ(ierr);
+
+  ierr = MatCreate(PetscObjectComm((PetscObject)A),&B);CHKERRQ(ierr);
+  ierr = MatSetSizes(B,dof*A->rmap->n,dof*A->cmap->n,dof*A->rmap->N,dof*A->cmap->N);CHKERRQ(ierr);
+  ierr = PetscLayoutSetBlockSize(B->rmap,dof);CHKERRQ(ierr);
+  ierr = PetscLayoutSetBlockSize(B->cmap,dof);CHKERRQ(ierr);
+  ierr = PetscLayoutSetUp(B->rmap);CHKERRQ(ierr);
+  ierr = PetscLayoutSetUp(B->cmap);CHKERRQ(ierr);
+
+  B->assembled = PETSC_TRUE;
+
+  ierr = MPI_Comm_size(PetscObjectComm((PetscObject)A),&size);CHKERRQ(ierr);
+  if (size == 1) {
+    Mat_SeqKAIJ *b;
+
+    ierr = MatSetType(B,MATSEQKAIJ);CHKERRQ(ierr);
+
+    B->ops->setup   = NULL;
+    B->ops->destroy = MatDestroy_SeqKAIJ;
+    B->ops->view    = MatView_KAIJ;
+    b               = (Mat_SeqKAIJ*)B->data;
+    b->dof          = dof;
+    b->AIJ          = A;
+
+    ierr = MatKAIJSetBlocks_Private(dof,S,T,&b->S,&b->T,&b->isTI);CHKERRQ(ierr);
+    ierr = PetscMalloc1(3*dof,&b->work);CHKERRQ(ierr);
+
+    B->ops->mult                 = MatMult_SeqKAIJ;
+    B->ops->multadd              = MatMultAdd_SeqKAIJ;
+    B->ops->multtranspose        = MatMultTranspose_SeqKAIJ;
+    B->ops->multtransposeadd     = MatMultTransposeAdd_SeqKAIJ;
+    B->ops->sor                  = MatSOR_SeqKAIJ;
+    B->ops->getdiagonal          = MatGetDiagonal_SeqKAIJ;
+    B->ops->invertblockdiagonal  = MatInvertBlockDiagonal_SeqKAIJ;
+
+    ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqkaij_seqaij_C",MatConvert_KAIJ_AIJ);CHKERRQ(ierr);
+  } else {
+    Mat_MPIAIJ  *mpiaij = (Mat_MPIAIJ*)A->data;
+    Mat_MPIKAIJ *b;
+    IS          from,to;
+    Vec         gvec;
+
+    ierr = MatSetType(B,MATMPIKAIJ);CHKERRQ(ierr);
+
+    B->ops->setup   = NULL;
+    B->ops->destroy = MatDestroy_MPIKAIJ;
+    B->ops->view    = MatView_KAIJ;
+
+    b      = (Mat_MPIKAIJ*)B->data;
+    b->dof = dof;
+    b->A   = A;
+
+    ierr = MatKAIJSetBlocks_Private(dof,S,T,&b->S,&b->T,&b->isTI);CHKERRQ(ierr);
+
+    /* the diagonal part carries S, the off-diagonal part only T */
+    ierr = MatCreateKAIJ(mpiaij->A,dof,S,T,&b->AIJ);CHKERRQ(ierr);
+    ierr = MatCreateKAIJ(mpiaij->B,dof,NULL,T,&b->OAIJ);CHKERRQ(ierr);
+
+    ierr = VecGetSize(mpiaij->lvec,&n);CHKERRQ(ierr);
+    ierr = VecCreate(PETSC_COMM_SELF,&b->w);CHKERRQ(ierr);
+    ierr = VecSetSizes(b->w,n*dof,n*dof);CHKERRQ(ierr);
+    ierr = VecSetBlockSize(b->w,dof);CHKERRQ(ierr);
+    ierr = VecSetType(b->w,VECSEQ);CHKERRQ(ierr);
+
+    /* create two temporary Index sets for build scatter gather */
+    ierr = ISCreateBlock(PetscObjectComm((PetscObject)A),dof,n,mpiaij->garray,PETSC_COPY_VALUES,&from);CHKERRQ(ierr);
+    ierr = ISCreateStride(PETSC_COMM_SELF,n*dof,0,1,&to);CHKERRQ(ierr);
+
+    /* create temporary global vector to generate scatter context */
+    ierr = VecCreateMPIWithArray(PetscObjectComm((PetscObject)A),dof,dof*A->cmap->n,dof*A->cmap->N,NULL,&gvec);CHKERRQ(ierr);
+
+    /* generate the scatter context */
+    ierr = VecScatterCreate(gvec,from,b->w,to,&b->ctx);CHKERRQ(ierr);
+
+    ierr = ISDestroy(&from);CHKERRQ(ierr);
+    ierr = ISDestroy(&to);CHKERRQ(ierr);
+    ierr = VecDestroy(&gvec);CHKERRQ(ierr);
+
+    B->ops->mult             = MatMult_MPIKAIJ;
+    B->ops->multtranspose    = MatMultTranspose_MPIKAIJ;
+    B->ops->multadd          = MatMultAdd_MPIKAIJ;
+    B->ops->multtransposeadd = MatMultTransposeAdd_MPIKAIJ;
+    B->ops->sor              = MatSOR_MPIKAIJ;
+    B->ops->getdiagonal      = MatGetDiagonal_MPIKAIJ;
+
+    ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_mpikaij_mpiaij_C",MatConvert_KAIJ_AIJ);CHKERRQ(ierr);
+  }
+  ierr  = MatSetUp(B);CHKERRQ(ierr);
+  *kaij = B;
+  ierr  = MatViewFromOptions(B,NULL,"-mat_view");CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
@@ -0,0 +1,27 @@
+#if !defined(_KAIJ_H)
+#define _KAIJ_H
+
+#include <../src/mat/impls/aij/mpi/mpiaij.h>
+
+typedef struct {
+  PetscInt         dof;         /* size of the blocks S and T */
+  Mat              AIJ;         /* the sparse matrix A */
+  PetscScalar      *S,*T;       /* dof by dof dense blocks in column major order, S is NULL if it is zero */
+  PetscBool        isTI;        /* T is the identity */
+  MatScalar        *ibdiag;     /* inverses of the diagonal blocks S + a_ii T, used by MatSOR() */
+  PetscBool        ibdiagvalid;
+  PetscObjectState ibdiagstate; /* state of AIJ when ibdiag was computed */
+  PetscScalar      *work;       /* work space of length 3*dof */
+} Mat_SeqKAIJ;
+
+typedef struct {
+  PetscInt    dof;              /* size of the blocks S and T */
+  Mat         AIJ,OAIJ;         /* sequential KAIJ matrices for the diagonal and off-diagonal parts */
+  Mat         A;                /* the parallel sparse matrix A */
+  PetscScalar *S,*T;            /* dof by dof dense blocks in column major order, S is NULL if it is zero */
+  PetscBool   isTI;             /* T is the identity */
+  VecScatter  ctx;              /* update ghost points for parallel case */
+  Vec         w;                /* work space for ghost values for parallel case */
+} Mat_MPIKAIJ;
+
+#endif
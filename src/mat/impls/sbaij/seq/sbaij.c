@@ -188,6 +188,8 @@ PetscErrorCode MatDestroy_SeqSBAIJ(Mat A)
   ierr = PetscFree(a->saved_values);CHKERRQ(ierr);
   if (a->free_jshort) {ierr = PetscFree(a->jshort);CHKERRQ(ierr);}
   ierr = PetscFree(a->inew);CHKERRQ(ierr);
+  ierr = MatSeqAIJFactorDestroySolveLevels(&a->solvelevels);CHKERRQ(ierr);
+  ierr = MatSeqSBAIJFactorDestroySupernodes(&a->supernodes);CHKERRQ(ierr);
   ierr = MatDestroy(&a->parent);CHKERRQ(ierr);
   ierr = PetscFree(A->data);CHKERRQ(ierr);
 
@@ -9,6 +9,15 @@
   arrays start at 0.
 */
 
+/* supernodes of a Cholesky factor with bs = 1, see sbaijsupernodal.c */
+typedef struct {
+  PetscInt  nsuper;           /* number of supernodes */
+  PetscInt  *sptr;            /* supernode s is made of the rows sptr[s] to sptr[s+1]-1 of U */
+  PetscInt  *rowsuper;        /* supernode of each row */
+  PetscInt  *panelptr;        /* the dense panel of supernode s starts at panelptr[s] in the work space of the numeric factorization */
+  PetscInt  maxcols,maxrows;  /* largest panel dimensions */
+} Mat_SeqSBAIJSupernodes;
+
 typedef struct {
   SEQAIJHEADER(MatScalar);
   SEQBAIJHEADER;
@@ -24,11 +33,16 @@ typedef struct {
   Mat_SeqAIJ_Inode inode;
   unsigned short   *jshort;
   PetscBool        free_jshort;
+  Mat_SeqAIJSolveLevels *solvelevels; /* level schedule of MatSolve() on a Cholesky or ICC factor of a SeqAIJ matrix */
+  Mat_SeqSBAIJSupernodes *supernodes; /* used by the supernodal numeric Cholesky factorization, -mat_cholesky_supernodal */
 } Mat_SeqSBAIJ;
 
 PETSC_INTERN PetscErrorCode MatCholeskyFactorSymbolic_SeqSBAIJ(Mat,Mat,IS,const MatFactorInfo*);
 PETSC_INTERN PetscErrorCode MatCholeskyFactorSymbolic_SeqSBAIJ_inplace(Mat,Mat,IS,const MatFactorInfo*);
 PETSC_INTERN PetscErrorCode MatCholeskyFactor_SeqSBAIJ(Mat,IS,const MatFactorInfo*);
+PETSC_INTERN PetscErrorCode MatSeqSBAIJFactorSetUpSupernodes(Mat);
+PETSC_INTERN PetscErrorCode MatSeqSBAIJFactorDestroySupernodes(Mat_SeqSBAIJSupernodes**);
+PETSC_INTERN PetscErrorCode MatCholeskyFactorNumeric_SeqSBAIJ_1_Supernodal(Mat,Mat,const MatFactorInfo*);
 PETSC_INTERN PetscErrorCode MatICCFactorSymbolic_SeqSBAIJ(Mat,Mat,IS,const MatFactorInfo*);
 PETSC_INTERN PetscErrorCode MatICCFactorSymbolic_SeqSBAIJ_inplace(Mat,Mat,IS,const MatFactorInfo*);
 PETSC_INTERN PetscErrorCode MatDuplicate_SeqSBAIJ(Mat,MatDuplicateOption,Mat*);
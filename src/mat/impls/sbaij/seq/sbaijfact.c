@@ -221,6 +221,16 @@ PetscErrorCode MatCholeskyFactorSymbolic_SeqSBAIJ(Mat fact,Mat A,IS perm,const M
   PetscBT            lnkbt;
 
   PetscFunctionBegin;
+  ierr = MatSeqAIJFactorDestroySolveLevels(&((Mat_SeqSBAIJ*)fact->data)->solvelevels);CHKERRQ(ierr);
+  ierr = MatSeqSBAIJFactorDestroySupernodes(&((Mat_SeqSBAIJ*)fact->data)->supernodes);CHKERRQ(ierr);
+  /* a repeated symbolic factorization replaces the previous factor */
+  b    = (Mat_SeqSBAIJ*)fact->data;
+  ierr = MatSeqXAIJFreeAIJ(fact,&b->a,&b->j,&b->i);CHKERRQ(ierr);
+  if (b->free_diag) {ierr = PetscFree(b->diag);CHKERRQ(ierr);}
+  ierr = ISDestroy(&b->row);CHKERRQ(ierr);
+  ierr = ISDestroy(&b->col);CHKERRQ(ierr);
+  ierr = ISDestroy(&b->icol);CHKERRQ(ierr);
+  ierr = PetscFree(b->solve_work);CHKERRQ(ierr);
   if (A->rmap->n != A->cmap->n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Must be square matrix, rows %D columns %D",A->rmap->n,A->cmap->n);
   ierr = MatMissingDiagonal(A,&missing,&i);CHKERRQ(ierr);
   if (missing) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Matrix is missing diagonal entry %D",i);
@@ -369,6 +379,7 @@ PetscErrorCode MatCholeskyFactorSymbolic_SeqSBAIJ(Mat fact,Mat A,IS perm,const M
   }
 #endif
   fact->ops->choleskyfactornumeric = MatCholeskyFactorNumeric_SeqSBAIJ_1_NaturalOrdering;
+  ierr = MatSeqSBAIJFactorSetUpSupernodes(fact);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -0,0 +1,327 @@
+
+/*
+   Supernodal left-looking numeric Cholesky (LDL^T) factorization for SeqAIJ and SeqSBAIJ matrices with bs = 1.
+
+   A supernode is a set of consecutive rows k = f..l of U whose off-diagonal structure is {k+1,...,l} together with a
+   common set C, that is, a chain f -> f+1 -> ... -> l in the elimination tree whose rows only differ by the chain
+   itself. The columns f..l of L = U^T are then a dense panel with the rows {f,...,l} U C. Each panel is factored
+   after it has received, with one dense matrix-matrix product (BLAS gemm) each, the updates of all the previous
+   supernodes that have rows in f..l. The panels only live during the numeric factorization, the result is copied into
+   the usual MATSEQSBAIJ factor storage, so that all the solves, MatGetInertia() etc. are those of the row by row
+   factorization.
+*/
+#include <../src/mat/impls/sbaij/seq/sbaij.h>
+#include <petscblaslapack.h>
+
+PetscErrorCode MatSeqSBAIJFactorDestroySupernodes(Mat_SeqSBAIJSupernodes **supernodes)
+{
+  Mat_SeqSBAIJSupernodes *sn = *supernodes;
+  PetscErrorCode         ierr;
+
+  PetscFunctionBegin;
+  if (!sn) PetscFunctionReturn(0);
+  ierr = PetscFree3(sn->sptr,sn->rowsuper,sn->panelptr);CHKERRQ(ierr);
+  ierr = PetscFree(*supernodes);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* updates from supernodes with fewer columns are not done with BLAS */
+#define MAT_SUPERNODAL_GEMM_MIN 4
+
+/*
+   MatSeqSBAIJFactorSetUpSupernodes - called at the end of the symbolic Cholesky factorization of a SeqAIJ or SeqSBAIJ
+   matrix, finds the supernodes of the factor and selects the supernodal numeric factorization if -mat_cholesky_supernodal
+   is set
+*/
+PetscErrorCode MatSeqSBAIJFactorSetUpSupernodes(Mat fact)
+{
+  Mat_SeqSBAIJ           *b  = (Mat_SeqSBAIJ*)fact->data;
+  const PetscInt         n   = fact->rmap->n,*bi = b->i,*bj = b->j;
+  PetscBool              flg = PETSC_FALSE;
+  Mat_SeqSBAIJSupernodes *sn;
+  PetscInt               k,s,nr,nc;
+  PetscErrorCode         ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsGetBool(((PetscObject)fact)->options,NULL,"-mat_cholesky_supernodal",&flg,NULL);CHKERRQ(ierr);
+  if (!flg || !n) PetscFunctionReturn(0);
+
+  ierr = PetscNewLog(fact,&sn);CHKERRQ(ierr);
+  ierr = PetscMalloc3(n+1,&sn->sptr,n,&sn->rowsuper,n+1,&sn->panelptr);CHKERRQ(ierr);
+  /* row k starts a new supernode unless k is the parent of k-1 in the elimination tree and row k-1 is {k-1} U row k */
+  sn->nsuper  = 0;
+  sn->sptr[0] = 0;
+  for (k=0; k<n; k++) {
+    if (k && !(bi[k]-bi[k-1] > 1 && bj[bi[k-1]] == k && bi[k]-bi[k-1] == bi[k+1]-bi[k]+1)) sn->sptr[++sn->nsuper] = k;
+    sn->rowsuper[k] = sn->nsuper;
+  }
+  sn->sptr[++sn->nsuper] = n;
+
+  sn->panelptr[0] = 0;
+  sn->maxcols     = 0;
+  sn->maxrows     = 0;
+  for (s=0; s<sn->nsuper; s++) {
+    nc                = sn->sptr[s+1]-sn->sptr[s];
+    nr                = bi[sn->sptr[s]+1]-bi[sn->sptr[s]]; /* the first row of the supernode has all the columns */
+    sn->panelptr[s+1] = sn->panelptr[s]+nr*nc;
+    sn->maxcols       = PetscMax(sn->maxcols,nc);
+    sn->maxrows       = PetscMax(sn->maxrows,nr);
+  }
+  ierr = PetscLogObjectMemory((PetscObject)fact,3*n*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscInfo4(fact,"%D supernodes for %D rows, largest has %D columns, %D rows\n",sn->nsuper,n,sn->maxcols,sn->maxrows);CHKERRQ(ierr);
+
+  b->supernodes                    = sn;
+  fact->ops->choleskyfactornumeric = MatCholeskyFactorNumeric_SeqSBAIJ_1_Supernodal;
+  PetscFunctionReturn(0);
+}
+
+/* sets sctx->shift_top for MAT_SHIFT_POSITIVE_DEFINITE, as the row by row factorizations */
+static PetscErrorCode MatSupernodalShiftTop_Private(Mat A,PetscBool sbaij,const MatFactorInfo *info,FactorShiftCtx *sctx)
+{
+  const PetscInt  n = A->rmap->n;
+  const PetscInt  *ai,*aj;
+  const MatScalar *aa;
+  PetscReal       *rs,rsi;
+  PetscInt        i,j;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  if (sbaij) {
+    Mat_SeqSBAIJ *a = (Mat_SeqSBAIJ*)A->data;
+    ai = a->i; aj = a->j; aa = a->a;
+  } else {
+    Mat_SeqAIJ *a = (Mat_SeqAIJ*)A->data;
+    ai = a->i; aj = a->j; aa = a->a;
+  }
+  ierr = PetscCalloc1(n,&rs);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    for (j=ai[i]; j<ai[i+1]; j++) {
+      if (aj[j] == i) {
+        rs[i] -= PetscRealPart(aa[j]);
+      } else {
+        rs[i] += PetscAbsScalar(aa[j]);
+        if (sbaij) rs[aj[j]] += PetscAbsScalar(aa[j]);
+      }
+    }
+  }
+  sctx->shift_top = info->zeropivot;
+  for (i=0; i<n; i++) {
+    rsi = rs[i];
+    if (rsi > sctx->shift_top) sctx->shift_top = rsi;
+  }
+  ierr = PetscFree(rs);CHKERRQ(ierr);
+  sctx->shift_top *= 1.1;
+  sctx->nshift_max = 5;
+  sctx->shift_lo   = 0.;
+  sctx->shift_hi   = 1.;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatCholeskyFactorNumeric_SeqSBAIJ_1_Supernodal(Mat B,Mat A,const MatFactorInfo *info)
+{
+  Mat_SeqSBAIJ           *b  = (Mat_SeqSBAIJ*)B->data;
+  Mat_SeqSBAIJSupernodes *sn = b->supernodes;
+  const PetscInt         n   = A->rmap->n,*bi = b->i,*bj = b->j,*bdiag = b->diag,*sptr = sn->sptr,*rowsuper = sn->rowsuper;
+  const PetscInt         *ai,*aj,*rip = NULL,*riip = NULL;
+  const MatScalar        *aa;
+  const PetscInt         *rows,*rowsK;
+  MatScalar              *ba = b->a,*panel,*P,*LK,*W,*Y,d,lrc;
+  PetscInt               s,t,tnext,f,l,nc,nr,ncK,nrK,p,q,m,r,c,cc,j,k,row,col,*relind,*ind,*head,*next,*pos;
+  PetscBLASInt           bm,bq,bnc,bld;
+  PetscScalar            one = 1.0,zero = 0.0;
+  PetscBool              sbaij,perm_identity;
+  FactorShiftCtx         sctx;
+  PetscReal              rs;
+  PetscLogDouble         flops;
+  PetscErrorCode         ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)A,MATSEQSBAIJ,&sbaij);CHKERRQ(ierr);
+  if (sbaij) {
+    Mat_SeqSBAIJ *a = (Mat_SeqSBAIJ*)A->data;
+    ai = a->i; aj = a->j; aa = a->a;
+  } else {
+    Mat_SeqAIJ *a = (Mat_SeqAIJ*)A->data;
+    ai = a->i; aj = a->j; aa = a->a;
+    ierr = ISGetIndices(b->row,&rip);CHKERRQ(ierr);
+    ierr = ISGetIndices(b->icol,&riip);CHKERRQ(ierr);
+  }
+
+  /* MatPivotSetUp(): initialize shift context sctx */
+  ierr = PetscMemzero(&sctx,sizeof(FactorShiftCtx));CHKERRQ(ierr);
+  if (info->shifttype == (PetscReal)MAT_SHIFT_POSITIVE_DEFINITE) {
+    ierr = MatSupernodalShiftTop_Private(A,sbaij,info,&sctx);CHKERRQ(ierr);
+  }
+
+  /*
+     relind: position of a row in the panel being factored, ind: relind[] of the rows of an update
+     head, next: linked lists of the supernodes that still have to update a supernode, pos: first row of the panel
+                 of a supernode not yet used in an update
+     panel: columns of L = U^T of each supernode, column major, over all the rows of the supernode
+  */
+  ierr = PetscMalloc5(n,&relind,sn->maxrows,&ind,sn->nsuper,&head,sn->nsuper,&next,sn->nsuper,&pos);CHKERRQ(ierr);
+  ierr = PetscMalloc1(sn->panelptr[sn->nsuper],&panel);CHKERRQ(ierr);
+  ierr = PetscMalloc2(sn->maxrows*sn->maxcols,&W,sn->maxcols*sn->maxcols,&Y);CHKERRQ(ierr);
+
+  do {
+    sctx.newshift = PETSC_FALSE;
+    flops         = 0.0;
+    for (s=0; s<sn->nsuper; s++) head[s] = -1;
+
+    for (s=0; s<sn->nsuper && !sctx.newshift; s++) {
+      f  = sptr[s]; l = sptr[s+1]-1;
+      nc = l-f+1;
+      nr = bi[f+1]-bi[f];
+      P  = panel+sn->panelptr[s];
+
+      /* the rows of the panel are f followed by the off-diagonal columns of row f of U */
+      rows      = bj+bi[f]-1;
+      relind[f] = 0;
+      for (r=1; r<nr; r++) relind[rows[r]] = r;
+
+      /* load the upper triangular part of the rows f..l of A */
+      ierr = PetscMemzero(P,nr*nc*sizeof(MatScalar));CHKERRQ(ierr);
+      for (c=0; c<nc; c++) {
+        k = f+c;
+        if (sbaij) {
+          for (j=ai[k]; j<ai[k+1]; j++) P[relind[aj[j]]+c*nr] = aa[j];
+        } else {
+          row = rip[k];
+          for (j=ai[row]; j<ai[row+1]; j++) {
+            col = riip[aj[j]];
+            if (col >= k) P[relind[col]+c*nr] = aa[j];
+          }
+        }
+        P[c+c*nr] += sctx.shift_amount; /* shift the diagonal of the matrix */
+      }
+
+      /* left-looking: add in the supernodes t with rows in f..l */
+      for (t=head[s]; t>=0; t=tnext) {
+        tnext = next[t];
+        ncK   = sptr[t+1]-sptr[t];
+        nrK   = bi[sptr[t]+1]-bi[sptr[t]];
+        rowsK = bj+bi[sptr[t]]-1; /* p >= ncK >= 1 so row 0 of the panel is not needed */
+        LK    = panel+sn->panelptr[t];
+        p     = pos[t];
+        for (q=0; p+q<nrK && rowsK[p+q] <= l; q++) ;
+        m     = nrK-p;
+        for (r=0; r<m; r++) ind[r] = relind[rowsK[p+r]];
+
+        if (ncK >= MAT_SUPERNODAL_GEMM_MIN) {
+          /* W = L_t(p:nrK-1,:) D_t L_t(p:p+q-1,:)^T, then subtract its lower triangular part from the panel */
+          for (c=0; c<ncK; c++) {
+            d = LK[c+c*nrK];
+            for (j=0; j<q; j++) Y[j+c*q] = LK[p+j+c*nrK]*d;
+          }
+          ierr = PetscBLASIntCast(m,&bm);CHKERRQ(ierr);
+          ierr = PetscBLASIntCast(q,&bq);CHKERRQ(ierr);
+          ierr = PetscBLASIntCast(ncK,&bnc);CHKERRQ(ierr);
+          ierr = PetscBLASIntCast(nrK,&bld);CHKERRQ(ierr);
+          PetscStackCallBLAS("BLASgemm",BLASgemm_("N","T",&bm,&bq,&bnc,&one,LK+p,&bld,Y,&bq,&zero,W,&bm));
+          for (j=0; j<q; j++) {
+            col = ind[j]*nr; /* the rows f..l come first in the panel, so ind[j] is also the column */
+            for (r=j; r<m; r++) P[ind[r]+col] -= W[r+j*m];
+          }
+        } else {
+          for (j=0; j<q; j++) {
+            col = ind[j]*nr;
+            for (c=0; c<ncK; c++) {
+              lrc = LK[p+j+c*nrK]*LK[c+c*nrK];
+              for (r=j; r<m; r++) P[ind[r]+col] -= LK[p+r+c*nrK]*lrc;
+            }
+          }
+        }
+        flops += 2.0*m*q*ncK;
+
+        /* pass t on to the next supernode it updates */
+        pos[t] = p+q;
+        if (p+q < nrK) {
+          j       = rowsuper[rowsK[p+q]];
+          next[t] = head[j]; head[j] = t;
+        }
+      }
+
+      /* factor the panel, L(r,c) overwrites P(r,c) for r > c and D(c) overwrites P(c,c) */
+      for (c=0; c<nc; c++) {
+        d  = P[c+c*nr];
+        rs = 0.0;
+        for (r=c+1; r<nr; r++) rs += PetscAbsScalar(P[r+c*nr]);
+
+        /* MatPivotCheck() */
+        sctx.rs = rs;
+        sctx.pv = d;
+        ierr    = MatPivotCheck(B,A,info,&sctx,f+c);CHKERRQ(ierr);
+        if (sctx.newshift) break;
+        d = sctx.pv;
+
+        P[c+c*nr] = d;
+        for (cc=c+1; cc<nc; cc++) {
+          lrc = P[cc+c*nr]/d;
+          for (r=cc; r<nr; r++) P[r+cc*nr] -= P[r+c*nr]*lrc;
+        }
+        for (r=c+1; r<nr; r++) P[r+c*nr] /= d;
+        flops += (nr-c-1)*(1.0+(nc-c-1)*2.0);
+      }
+
+      /* the first supernode s will update */
+      if (nr > nc) {
+        pos[s]  = nc;
+        j       = rowsuper[rows[nc]];
+        next[s] = head[j]; head[j] = s;
+      }
+    }
+  } while (sctx.newshift);
+
+  /* copy into the factor: U(k,:) = -L(:,k)^T without the diagonal, stored first, then 1/D(k) */
+  for (s=0; s<sn->nsuper; s++) {
+    f  = sptr[s]; l = sptr[s+1]-1;
+    nc = l-f+1;
+    nr = bi[f+1]-bi[f];
+    P  = panel+sn->panelptr[s];
+    for (c=0; c<nc; c++) {
+      k = f+c;
+      for (r=c+1; r<nr; r++) ba[bi[k]+r-c-1] = -P[r+c*nr];
+      ba[bdiag[k]] = 1.0/P[c+c*nr];
+    }
+  }
+
+  ierr = PetscFree5(relind,ind,head,next,pos);CHKERRQ(ierr);
+  ierr = PetscFree(panel);CHKERRQ(ierr);
+  ierr = PetscFree2(W,Y);CHKERRQ(ierr);
+  if (!sbaij) {
+    ierr = ISRestoreIndices(b->row,&rip);CHKERRQ(ierr);
+    ierr = ISRestoreIndices(b->icol,&riip);CHKERRQ(ierr);
+  }
+
+  ierr = ISIdentity(b->row,&perm_identity);CHKERRQ(ierr);
+  if (perm_identity) {
+    B->ops->solve          = MatSolve_SeqSBAIJ_1_NaturalOrdering;
+    B->ops->solvetranspose = MatSolve_SeqSBAIJ_1_NaturalOrdering;
+    B->ops->forwardsolve   = MatForwardSolve_SeqSBAIJ_1_NaturalOrdering;
+    B->ops->backwardsolve  = MatBackwardSolve_SeqSBAIJ_1_NaturalOrdering;
+  } else {
+    B->ops->solve          = MatSolve_SeqSBAIJ_1;
+    B->ops->solvetranspose = MatSolve_SeqSBAIJ_1;
+    B->ops->forwardsolve   = MatForwardSolve_SeqSBAIJ_1;
+    B->ops->backwardsolve  = MatBackwardSolve_SeqSBAIJ_1;
+  }
+  if (sbaij) B->ops->solves = MatSolves_SeqSBAIJ_1;
+  ierr = MatSeqAIJFactorSetUpSolveLevels(B,PETSC_TRUE);CHKERRQ(ierr);
+
+  B->assembled    = PETSC_TRUE;
+  B->preallocated = PETSC_TRUE;
+
+  ierr = PetscLogFlops(flops+B->rmap->n);CHKERRQ(ierr);
+
+  /* MatPivotView() */
+  if (sctx.nshift) {
+    if (info->shifttype == (PetscReal)MAT_SHIFT_POSITIVE_DEFINITE) {
+      ierr = PetscInfo4(A,"number of shift_pd tries %D, shift_amount %g, diagonal shifted up by %e fraction top_value %e\n",sctx.nshift,(double)sctx.shift_amount,(double)sctx.shift_fraction,(double)sctx.shift_top);CHKERRQ(ierr);
+    } else if (info->shifttype == (PetscReal)MAT_SHIFT_NONZERO) {
+      ierr = PetscInfo2(A,"number of shift_nz tries %D, shift_amount %g\n",sctx.nshift,(double)sctx.shift_amount);CHKERRQ(ierr);
+    } else if (info->shifttype == (PetscReal)MAT_SHIFT_INBLOCKS) {
+      ierr = PetscInfo2(A,"number of shift_inblocks applied %D, each shift_amount %g\n",sctx.nshift,(double)info->shiftamount);CHKERRQ(ierr);
+    }
+  }
+  PetscFunctionReturn(0);
+}
@@ -3,6 +3,7 @@
 
 PETSC_EXTERN PetscErrorCode MatCreate_MFFD(Mat);
 PETSC_EXTERN PetscErrorCode MatCreate_MAIJ(Mat);
+PETSC_EXTERN PetscErrorCode MatCreate_KAIJ(Mat);
 PETSC_EXTERN PetscErrorCode MatCreate_IS(Mat);
 
 PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJ(Mat);
@@ -24,6 +25,20 @@ PETSC_EXTERN PetscErrorCode MatCreate_Composite(Mat);
 PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJPERM(Mat);
 PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJPERM(Mat);
 
+PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJSELL(Mat);
+PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJSELL(Mat);
+PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJDelta(Mat);
+PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJDelta(Mat);
+#if defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX)
+PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJMixed(Mat);
+PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJMixed(Mat);
+#endif
+
+#if defined PETSC_HAVE_OPENMP
+PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJOMP(Mat);
+PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJOMP(Mat);
+#endif
+
 PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJCRL(Mat);
 PETSC_EXTERN PetscErrorCode MatCreate_MPIAIJCRL(Mat);
 
@@ -83,6 +98,10 @@ PetscErrorCode  MatRegisterAll(void)
   ierr = MatRegister(MATSEQMAIJ,        MatCreate_MAIJ);CHKERRQ(ierr);
   ierr = MatRegister(MATMAIJ,           MatCreate_MAIJ);CHKERRQ(ierr);
 
+  ierr = MatRegister(MATMPIKAIJ,        MatCreate_KAIJ);CHKERRQ(ierr);
+  ierr = MatRegister(MATSEQKAIJ,        MatCreate_KAIJ);CHKERRQ(ierr);
+  ierr = MatRegister(MATKAIJ,           MatCreate_KAIJ);CHKERRQ(ierr);
+
   ierr = MatRegister(MATIS,             MatCreate_IS);CHKERRQ(ierr);
   ierr = MatRegister(MATSHELL,          MatCreate_Shell);CHKERRQ(ierr);
   ierr = MatRegister(MATCOMPOSITE,      MatCreate_Composite);CHKERRQ(ierr);
@@ -95,6 +114,26 @@ PetscErrorCode  MatRegisterAll(void)
   ierr = MatRegister(MATMPIAIJPERM,     MatCreate_MPIAIJPERM);CHKERRQ(ierr);
   ierr = MatRegister(MATSEQAIJPERM,     MatCreate_SeqAIJPERM);CHKERRQ(ierr);
 
+  ierr = MatRegisterBaseName(MATAIJSELL,MATSEQAIJSELL,MATMPIAIJSELL);CHKERRQ(ierr);
+  ierr = MatRegister(MATMPIAIJSELL,     MatCreate_MPIAIJSELL);CHKERRQ(ierr);
+  ierr = MatRegister(MATSEQAIJSELL,     MatCreate_SeqAIJSELL);CHKERRQ(ierr);
+
+  ierr = MatRegisterBaseName(MATAIJDELTA,MATSEQAIJDELTA,MATMPIAIJDELTA);CHKERRQ(ierr);
+  ierr = MatRegister(MATMPIAIJDELTA,    MatCreate_MPIAIJDelta);CHKERRQ(ierr);
+  ierr = MatRegister(MATSEQAIJDELTA,    MatCreate_SeqAIJDelta);CHKERRQ(ierr);
+
+#if defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX)
+  ierr = MatRegisterBaseName(MATAIJMIXED,MATSEQAIJMIXED,MATMPIAIJMIXED);CHKERRQ(ierr);
+  ierr = MatRegister(MATMPIAIJMIXED,    MatCreate_MPIAIJMixed);CHKERRQ(ierr);
+  ierr = MatRegister(MATSEQAIJMIXED,    MatCreate_SeqAIJMixed);CHKERRQ(ierr);
+#endif
+
+#if defined PETSC_HAVE_OPENMP
+  ierr = MatRegisterBaseName(MATAIJOMP,MATSEQAIJOMP,MATMPIAIJOMP);CHKERRQ(ierr);
+  ierr = MatRegister(MATMPIAIJOMP,      MatCreate_MPIAIJOMP);CHKERRQ(ierr);
+  ierr = MatRegister(MATSEQAIJOMP,      MatCreate_SeqAIJOMP);CHKERRQ(ierr);
+#endif
+
   ierr = MatRegisterBaseName(MATAIJCRL,MATSEQAIJCRL,MATMPIAIJCRL);CHKERRQ(ierr);
   ierr = MatRegister(MATSEQAIJCRL,      MatCreate_SeqAIJCRL);CHKERRQ(ierr);
   ierr = MatRegister(MATMPIAIJCRL,      MatCreate_MPIAIJCRL);CHKERRQ(ierr);
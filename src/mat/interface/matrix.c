@@ -329,6 +329,7 @@ PetscErrorCode MatRealPart(Mat mat)
   if (!mat->ops->realpart) SETERRQ1(PetscObjectComm((PetscObject)mat),PETSC_ERR_SUP,"Mat type %s",((PetscObject)mat)->type_name);
   MatCheckPreallocated(mat,1);
   ierr = (*mat->ops->realpart)(mat);CHKERRQ(ierr);
+  ierr = PetscObjectStateIncrease((PetscObject)mat);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_CUSP)
   if (mat->valid_GPU_matrix != PETSC_CUSP_UNALLOCATED) {
     mat->valid_GPU_matrix = PETSC_CUSP_CPU;
@@ -406,6 +407,7 @@ PetscErrorCode MatImaginaryPart(Mat mat)
   if (!mat->ops->imaginarypart) SETERRQ1(PetscObjectComm((PetscObject)mat),PETSC_ERR_SUP,"Mat type %s",((PetscObject)mat)->type_name);
   MatCheckPreallocated(mat,1);
   ierr = (*mat->ops->imaginarypart)(mat);CHKERRQ(ierr);
+  ierr = PetscObjectStateIncrease((PetscObject)mat);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_CUSP)
   if (mat->valid_GPU_matrix != PETSC_CUSP_UNALLOCATED) {
     mat->valid_GPU_matrix = PETSC_CUSP_CPU;
@@ -555,6 +557,7 @@ PetscErrorCode MatConjugate(Mat mat)
   if (!mat->assembled) SETERRQ(PetscObjectComm((PetscObject)mat),PETSC_ERR_ARG_WRONGSTATE,"Not for unassembled matrix");
   if (!mat->ops->conjugate) SETERRQ(PetscObjectComm((PetscObject)mat),PETSC_ERR_SUP,"Not provided for this matrix format, send email to petsc-maint@mcs.anl.gov");
   ierr = (*mat->ops->conjugate)(mat);CHKERRQ(ierr);
+  ierr = PetscObjectStateIncrease((PetscObject)mat);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_CUSP)
   if (mat->valid_GPU_matrix != PETSC_CUSP_UNALLOCATED) {
     mat->valid_GPU_matrix = PETSC_CUSP_CPU;
@@ -928,9 +931,16 @@ PetscErrorCode MatView(Mat mat,PetscViewer viewer)
   MatCheckPreallocated(mat,1);
   ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERBINARY,&ibinary);CHKERRQ(ierr);
   if (ibinary) {
-    PetscBool mpiio;
+    PetscBool         mpiio;
+    PetscVoidFunction seqaij = NULL,mpiaij = NULL;
+
     ierr = PetscViewerBinaryGetUseMPIIO(viewer,&mpiio);CHKERRQ(ierr);
-    if (mpiio) SETERRQ(PetscObjectComm((PetscObject)viewer),PETSC_ERR_SUP,"PETSc matrix viewers do not support using MPI-IO, turn off that flag");
+    /* the types derived from AIJ, such as MATSEQAIJPERM or MATMPIAIJSELL, share its storage and its viewer */
+    if (mpiio) {
+      ierr = PetscObjectQueryFunction((PetscObject)mat,"MatSeqAIJSetPreallocation_C",&seqaij);CHKERRQ(ierr);
+      ierr = PetscObjectQueryFunction((PetscObject)mat,"MatMPIAIJSetPreallocation_C",&mpiaij);CHKERRQ(ierr);
+    }
+    if (mpiio && !seqaij && !mpiaij) SETERRQ(PetscObjectComm((PetscObject)viewer),PETSC_ERR_SUP,"Only AIJ matrix viewers support using MPI-IO, turn off that flag");
   }
 
   ierr = PetscLogEventBegin(MAT_View,mat,viewer,0,0);CHKERRQ(ierr);
@@ -5296,7 +5306,9 @@ PetscErrorCode MatAssemblyEnd(Mat mat,MatAssemblyType type)
    used the next time through, during MatSetVaules()/MatSetVaulesBlocked()
    to improve the searching of indices. MAT_NEW_NONZERO_LOCATIONS flag
    should be used with MAT_USE_HASH_TABLE flag. This option is currently
-   supported by MATMPIBAIJ format only.
+   supported by MATMPIBAIJ format and by MATSEQAIJ, where the entries set before
+   the first final assembly are collected in a hash table so that no preallocation
+   is needed; the exact nonzero structure is then built by MatAssemblyEnd().
 
    MAT_KEEP_NONZERO_PATTERN indicates when MatZeroRows() is called the zeroed entries
    are kept in the nonzero structure
@@ -311,6 +311,49 @@ PetscErrorCode  MatFDColoringSetFunction(MatFDColoring matfd,PetscErrorCode (*f)
   PetscFunctionReturn(0);
 }
 
+/*@C
+   MatFDColoringSetFunctionBatch - Sets a function that evaluates the function of MatFDColoringSetFunction() at
+   several points in one call, so that MatFDColoringApply() perturbs several colors at once
+
+   Logically Collective on MatFDColoring
+
+   Input Parameters:
++  coloring - the coloring context
+.  f - the function, or NULL to evaluate one point at a time
+-  fctx - the optional user-defined function context
+
+   Calling sequence of (*f) function:
+$    PetscErrorCode f(void *sctx,PetscInt n,Vec x[],Vec y[],void *fctx)
++  sctx - the SNES for SNES, otherwise the argument sctx of MatFDColoringApply()
+.  n - the number of points
+.  x - the points, the vectors are not to be changed
+.  y - the function values at the points
+-  fctx - the function context
+
+   Notes: The function of MatFDColoringSetFunction() is still used for the unperturbed point and by matrix types
+   that do not batch the evaluations. For AIJ matrices the colors are treated in blocks of the number of columns set
+   with MatFDColoringSetBlockSize() (or -mat_fd_coloring_bcols), whose default depends on the memory used by the
+   matrix; each block is one call of f. This amortizes the cost of each evaluation, such as updating ghost values
+   and setting up the function, over many colors; f may also interleave the points to vectorize across them.
+   MatFDColoringGetPerturbedColumns() returns the columns of the first color of the block.
+
+   The coloring keeps two vectors for each point in a block.
+
+   Level: advanced
+
+.keywords: Mat, Jacobian, finite differences, set, function
+
+.seealso: MatFDColoringSetFunction(), MatFDColoringSetBlockSize(), MatFDColoringApply()
+@*/
+PetscErrorCode  MatFDColoringSetFunctionBatch(MatFDColoring matfd,PetscErrorCode (*f)(void*,PetscInt,Vec[],Vec[],void*),void *fctx)
+{
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(matfd,MAT_FDCOLORING_CLASSID,1);
+  matfd->fbatch    = f;
+  matfd->fbatchctx = fctx;
+  PetscFunctionReturn(0);
+}
+
 /*@
    MatFDColoringSetFromOptions - Sets coloring finite difference parameters from
    the options database.
@@ -531,6 +574,10 @@ PetscErrorCode  MatFDColoringDestroy(MatFDColoring *c)
   ierr = VecDestroy(&color->w1);CHKERRQ(ierr);
   ierr = VecDestroy(&color->w2);CHKERRQ(ierr);
   ierr = VecDestroy(&color->w3);CHKERRQ(ierr);
+  if (color->nb) {
+    ierr = VecDestroyVecs(color->nb,&color->xb);CHKERRQ(ierr);
+    ierr = VecDestroyVecs(color->nb,&color->yb);CHKERRQ(ierr);
+  }
   ierr = PetscHeaderDestroy(c);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -168,6 +168,7 @@ PetscErrorCode  MatShift(Mat Y,PetscScalar a)
   } else {
     ierr = MatShift_Basic(Y,a);CHKERRQ(ierr);
   }
+  ierr = PetscObjectStateIncrease((PetscObject)Y);CHKERRQ(ierr);
 
 #if defined(PETSC_HAVE_CUSP)
   if (Y->valid_GPU_matrix != PETSC_CUSP_UNALLOCATED) {
@@ -241,6 +242,7 @@ PetscErrorCode  MatDiagonalSet(Mat Y,Vec D,InsertMode is)
   } else {
     ierr = MatDiagonalSet_Default(Y,D,is);CHKERRQ(ierr);
   }
+  ierr = PetscObjectStateIncrease((PetscObject)Y);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
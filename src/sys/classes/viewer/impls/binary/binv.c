@@ -7,6 +7,9 @@
 #if defined(PETSC_HAVE_IO_H)
 #include <io.h>
 #endif
+#if defined(PETSC_HAVE_SYS_MMAN_H)
+#include <sys/mman.h>
+#endif
 
 typedef struct  {
   int           fdes;                 /* file descriptor, ignored if using MPI IO */
@@ -14,6 +17,12 @@ typedef struct  {
   PetscBool     usempiio;
   MPI_File      mfdes;                /* ignored unless using MPI IO */
   MPI_Offset    moff;
+  PetscBool     useasync;             /* write from staging buffers with nonblocking collective MPI IO calls */
+  PetscInt      maxpending;           /* allow only <maxpending> asynchronous writes outstanding at a time */
+  PetscInt      npending,firstpending;
+  MPI_Request   *requests;            /* circular queue of the outstanding asynchronous writes */
+  void          **stagebufs;          /* and their staging buffers */
+  PetscBool     byteview;             /* the file view is the byte view used by PetscViewerBinaryWriteAtAllMPIIO() */
 #endif
   PetscFileMode btype;                /* read or write? */
   FILE          *fdes_info;           /* optional file containing info on binary file*/
@@ -23,6 +32,7 @@ typedef struct  {
   PetscBool     skipoptions;          /* don't use PETSc options database when loading */
   PetscInt      flowcontrol;          /* allow only <flowcontrol> messages outstanding at a time while doing IO */
   PetscBool     skipheader;           /* don't write header, only raw data */
+  PetscBool     usemmap;              /* map the file into memory when loading on one process */
   PetscBool     matlabheaderwritten;  /* if format is PETSC_VIEWER_BINARY_MATLAB has the MATLAB .info header been written yet */
   PetscBool     setfromoptionscalled;
 } PetscViewer_Binary;
@@ -60,6 +70,89 @@ static PetscErrorCode PetscViewerRestoreSubViewer_Binary(PetscViewer viewer,MPI_
 }
 
 #if defined(PETSC_HAVE_MPIIO)
+/*
+   Completes the oldest outstanding asynchronous writes until at most nkeep remain; with nkeep = 0
+   the file view may be changed afterwards
+*/
+static PetscErrorCode PetscViewerBinaryAsyncWait_Private(PetscViewer viewer,PetscInt nkeep)
+{
+  PetscViewer_Binary *vbinary = (PetscViewer_Binary*)viewer->data;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  while (vbinary->npending > nkeep) {
+    PetscInt k = vbinary->firstpending;
+
+    ierr = MPI_Wait(&vbinary->requests[k],MPI_STATUS_IGNORE);CHKERRQ(ierr);
+    ierr = PetscFree(vbinary->stagebufs[k]);CHKERRQ(ierr);
+    vbinary->firstpending = (k+1) % vbinary->maxpending;
+    vbinary->npending--;
+  }
+  if (!nkeep) vbinary->byteview = PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
+
+/*@C
+    PetscViewerBinaryWriteAtAllMPIIO - Collectively writes data at a given position of the file of a binary viewer that uses MPI-IO
+
+    Collective on PetscViewer
+
+    Input Parameters:
++   viewer - PetscViewer context, obtained from PetscViewerBinaryOpen()
+.   off - the position in the file in bytes, usually obtained from PetscViewerBinaryGetMPIIOOffset()
+.   data - location of the local data
+.   cnt - number of local items
+-   dtype - MPI datatype of the items
+
+    Level: developer
+
+    Notes:
+    The offset of the viewer is not changed, use PetscViewerBinaryAddMPIIOOffset() after all processes have written their part.
+
+    If the viewer writes asynchronously (see PetscViewerBinarySetUseAsync()) the data is copied into a staging buffer and the
+    write is started with MPI_File_iwrite_at_all(), so that data may be changed as soon as this routine returns. The write is
+    completed by a later call, by PetscViewerFlush() or when the viewer is destroyed.
+
+    Fortran Note:
+    This routine is not supported in Fortran.
+
+.seealso: PetscViewerBinaryOpen(), PetscViewerBinaryGetMPIIOOffset(), PetscViewerBinaryAddMPIIOOffset(), PetscViewerBinarySetUseAsync()
+@*/
+PetscErrorCode PetscViewerBinaryWriteAtAllMPIIO(PetscViewer viewer,MPI_Offset off,void *data,PetscMPIInt cnt,MPI_Datatype dtype)
+{
+  PetscViewer_Binary *vbinary = (PetscViewer_Binary*)viewer->data;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscViewerSetUp(viewer);CHKERRQ(ierr);
+  if (!vbinary->byteview) {
+    ierr = MPI_File_set_view(vbinary->mfdes,0,MPI_BYTE,MPI_BYTE,(char*)"native",MPI_INFO_NULL);CHKERRQ(ierr);
+    vbinary->byteview = PETSC_TRUE;
+  }
+#if defined(PETSC_HAVE_MPI_FILE_IWRITE_AT_ALL)
+  if (vbinary->useasync) {
+    PetscInt      k;
+    PetscDataType pdtype;
+    size_t        dsize;
+
+    ierr = PetscViewerBinaryAsyncWait_Private(viewer,vbinary->maxpending-1);CHKERRQ(ierr);
+    k    = (vbinary->firstpending + vbinary->npending) % vbinary->maxpending;
+    ierr = PetscMPIDataTypeToPetscDataType(dtype,&pdtype);CHKERRQ(ierr);
+    ierr = PetscDataTypeGetSize(pdtype,&dsize);CHKERRQ(ierr);
+    ierr = PetscMalloc(cnt*dsize,&vbinary->stagebufs[k]);CHKERRQ(ierr);
+    ierr = PetscMemcpy(vbinary->stagebufs[k],data,cnt*dsize);CHKERRQ(ierr);
+#if !defined(PETSC_WORDS_BIGENDIAN)
+    ierr = PetscByteSwap(vbinary->stagebufs[k],pdtype,cnt);CHKERRQ(ierr);
+#endif
+    ierr = MPI_File_iwrite_at_all(vbinary->mfdes,off,vbinary->stagebufs[k],cnt,dtype,&vbinary->requests[k]);CHKERRQ(ierr);
+    vbinary->npending++;
+    PetscFunctionReturn(0);
+  }
+#endif
+  ierr = MPIU_File_write_at_all(vbinary->mfdes,off,data,cnt,dtype,MPI_STATUS_IGNORE);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /*@C
     PetscViewerBinaryGetMPIIOOffset - Gets the current offset that should be passed to MPI_File_set_view()
 
@@ -135,6 +228,10 @@ PetscErrorCode PetscViewerBinaryAddMPIIOOffset(PetscViewer viewer,MPI_Offset off
 
     Level: advanced
 
+    Notes:
+    Outstanding asynchronous writes (see PetscViewerBinarySetUseAsync()) are completed first, since the
+    caller may change the file view.
+
     Fortran Note:
     This routine is not supported in Fortran.
 
@@ -150,6 +247,8 @@ PetscErrorCode PetscViewerBinaryGetMPIIODescriptor(PetscViewer viewer,MPI_File *
 
   PetscFunctionBegin;
   ierr = PetscViewerSetUp(viewer);CHKERRQ(ierr);
+  /* the caller may change the file view, which is not allowed while nonblocking writes are pending */
+  ierr = PetscViewerBinaryAsyncWait_Private(viewer,0);CHKERRQ(ierr);
   *fdes = vbinary->mfdes;
   PetscFunctionReturn(0);
 }
@@ -162,8 +261,90 @@ static PetscErrorCode PetscViewerBinaryGetUseMPIIO_Binary(PetscViewer viewer,Pet
   *flg = vbinary->usempiio;
   PetscFunctionReturn(0);
 }
+
+static PetscErrorCode PetscViewerBinaryGetUseAsync_Binary(PetscViewer viewer,PetscBool *flg)
+{
+  PetscViewer_Binary *vbinary = (PetscViewer_Binary*)viewer->data;
+
+  PetscFunctionBegin;
+  *flg = vbinary->useasync;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscViewerBinarySetUseAsync_Binary(PetscViewer viewer,PetscBool flg)
+{
+  PetscViewer_Binary *vbinary = (PetscViewer_Binary*)viewer->data;
+
+  PetscFunctionBegin;
+  vbinary->useasync = flg;
+  if (flg) vbinary->usempiio = PETSC_TRUE;
+  PetscFunctionReturn(0);
+}
 #endif
 
+/*@C
+    PetscViewerBinaryGetUseAsync - Returns PETSC_TRUE if the binary viewer writes asynchronously
+
+    Not Collective
+
+    Input Parameter:
+.   viewer - PetscViewer context, obtained from PetscViewerBinaryOpen()
+
+    Output Parameter:
+.   flg - PETSC_TRUE if writes are asynchronous
+
+    Level: advanced
+
+    Note:
+    If MPI-IO is not available, this function will always return PETSC_FALSE
+
+.seealso: PetscViewerBinaryOpen(), PetscViewerBinarySetUseAsync(), PetscViewerBinaryGetUseMPIIO()
+@*/
+PetscErrorCode PetscViewerBinaryGetUseAsync(PetscViewer viewer,PetscBool *flg)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  *flg = PETSC_FALSE;
+  ierr = PetscTryMethod(viewer,"PetscViewerBinaryGetUseAsync_C",(PetscViewer,PetscBool*),(viewer,flg));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*@C
+    PetscViewerBinarySetUseAsync - Sets a binary viewer to write vectors and matrices asynchronously so that the
+        output overlaps with the following computation. Must be called before PetscViewerFileSetName()
+
+    Logically Collective on PetscViewer
+
+    Input Parameters:
++   viewer - the PetscViewer; must be a binary
+-   flg - PETSC_TRUE means the writes will be asynchronous
+
+    Options Database:
++   -viewer_binary_async - Flag for asynchronous writes
+-   -viewer_binary_async_max_pending <n> - Number of writes allowed to be outstanding at the same time, default 2
+
+    Level: advanced
+
+    Notes:
+    This implies PetscViewerBinarySetUseMPIIO(). The data is copied into a staging buffer and written with
+    MPI_File_iwrite_at_all(); when <n> writes are outstanding the oldest one is completed before a new one is started.
+    PetscViewerFlush() completes all outstanding writes, bounding the memory used by staging buffers. If the MPI
+    implementation does not provide MPI_File_iwrite_at_all() the writes are performed synchronously.
+
+.seealso: PetscViewerFileSetMode(), PetscViewerCreate(), PetscViewerSetType(), PetscViewerBinaryOpen(),
+          PetscViewerBinaryGetUseAsync(), PetscViewerBinarySetUseMPIIO(), PetscViewerFlush()
+@*/
+PetscErrorCode PetscViewerBinarySetUseAsync(PetscViewer viewer,PetscBool flg)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  ierr = PetscTryMethod(viewer,"PetscViewerBinarySetUseAsync_C",(PetscViewer,PetscBool),(viewer,flg));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 
 /*@C
     PetscViewerBinaryGetUseMPIIO - Returns PETSC_TRUE if the binary viewer uses MPI-IO.
@@ -202,6 +383,199 @@ PetscErrorCode PetscViewerBinaryGetUseMPIIO(PetscViewer viewer,PetscBool *flg)
   PetscFunctionReturn(0);
 }
 
+static PetscErrorCode PetscViewerBinaryGetUseMmap_Binary(PetscViewer viewer,PetscBool *flg)
+{
+  PetscViewer_Binary *vbinary = (PetscViewer_Binary*)viewer->data;
+
+  PetscFunctionBegin;
+  *flg = vbinary->usemmap;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscViewerBinarySetUseMmap_Binary(PetscViewer viewer,PetscBool flg)
+{
+  PetscViewer_Binary *vbinary = (PetscViewer_Binary*)viewer->data;
+
+  PetscFunctionBegin;
+  vbinary->usemmap = flg;
+  PetscFunctionReturn(0);
+}
+
+/*@C
+    PetscViewerBinaryGetUseMmap - Returns PETSC_TRUE if the binary viewer maps sequential loads into memory
+
+    Not Collective
+
+    Input Parameter:
+.   viewer - PetscViewer context, obtained from PetscViewerBinaryOpen()
+
+    Output Parameter:
+.   flg - PETSC_TRUE if mmap() is used for loading
+
+    Level: advanced
+
+.seealso: PetscViewerBinaryOpen(), PetscViewerBinarySetUseMmap(), PetscViewerBinaryReadMapped()
+@*/
+PetscErrorCode PetscViewerBinaryGetUseMmap(PetscViewer viewer,PetscBool *flg)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  *flg = PETSC_FALSE;
+  ierr = PetscTryMethod(viewer,"PetscViewerBinaryGetUseMmap_C",(PetscViewer,PetscBool*),(viewer,flg));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*@C
+    PetscViewerBinarySetUseMmap - Sets a binary viewer to map the file into memory when loading vectors and
+        matrices on one process, instead of reading the data into newly allocated arrays
+
+    Logically Collective on PetscViewer
+
+    Input Parameters:
++   viewer - the PetscViewer; must be a binary
+-   flg - PETSC_TRUE means loads use mmap()
+
+    Options Database:
+.   -viewer_binary_mmap - Flag for loading with mmap()
+
+    Level: advanced
+
+    Notes:
+    VecLoad() into a VECSEQ and MatLoad() into a MATSEQAIJ then point the vector array and the column indices and
+    values of the matrix directly into a private mapping of the file, so loading costs only the page faults on the
+    data that is actually touched. Changes to the loaded objects never reach the file.
+
+    Ignored for parallel viewers, for MPI-IO, on systems without mmap(), and on little-endian machines, since binary
+    files are stored big-endian and byte swapping the mapping in place would copy every page of it.
+
+.seealso: PetscViewerFileSetMode(), PetscViewerCreate(), PetscViewerSetType(), PetscViewerBinaryOpen(),
+          PetscViewerBinaryGetUseMmap(), PetscViewerBinaryReadMapped()
+@*/
+PetscErrorCode PetscViewerBinarySetUseMmap(PetscViewer viewer,PetscBool flg)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  ierr = PetscTryMethod(viewer,"PetscViewerBinarySetUseMmap_C",(PetscViewer,PetscBool),(viewer,flg));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#if defined(PETSC_HAVE_MMAP) && defined(PETSC_HAVE_SYS_MMAN_H)
+typedef struct {
+  void   *addr;
+  size_t len;
+} PetscViewerBinaryMap;
+
+static PetscErrorCode PetscViewerBinaryUnmap_Private(void *ctx)
+{
+  PetscViewerBinaryMap *map = (PetscViewerBinaryMap*)ctx;
+  PetscErrorCode       ierr;
+
+  PetscFunctionBegin;
+  if (munmap(map->addr,map->len)) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SYS,"munmap() failed");
+  ierr = PetscFree(map);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
+/*@C
+    PetscViewerBinaryReadMapped - Maps the next items of a binary file into memory instead of reading them
+
+    Not Collective
+
+    Input Parameters:
++   viewer - the binary viewer, obtained from PetscViewerBinaryOpen()
+.   num - number of items to map
+-   dtype - type of the items
+
+    Output Parameters:
++   data - location of the items, or NULL if they could not be mapped
+-   map - container owning the mapping, or NULL; destroying it unmaps the items
+
+    Level: developer
+
+    Notes:
+    The items are mapped only if PetscViewerBinarySetUseMmap() was set, the file is open for reading on one
+    process without MPI-IO, the machine is big-endian so the items need no byte swapping, and the current
+    position in the file is a multiple of the size of dtype. Otherwise
+    data and map are NULL, the position in the file is unchanged, and the items must be read with PetscViewerBinaryRead().
+
+    The mapping outlives the viewer; compose the container with the object that uses the data so that it is unmapped
+    when the object is destroyed, see PetscObjectCompose().
+
+.seealso: PetscViewerBinarySetUseMmap(), PetscViewerBinaryRead(), PetscContainerCreate()
+@*/
+PetscErrorCode PetscViewerBinaryReadMapped(PetscViewer viewer,PetscInt num,PetscDataType dtype,void **data,PetscContainer *map)
+{
+  PetscErrorCode       ierr;
+#if defined(PETSC_HAVE_MMAP) && defined(PETSC_HAVE_SYS_MMAN_H)
+  PetscViewer_Binary   *vbinary = (PetscViewer_Binary*)viewer->data;
+  PetscViewerBinaryMap *ctx;
+  PetscBool            isbinary;
+  PetscMPIInt          size;
+  size_t               tsize,len;
+  off_t                off,start,end;
+  long                 pagesize;
+  void                 *addr;
+#endif
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  PetscValidPointer(data,4);
+  PetscValidPointer(map,5);
+  *data = NULL;
+  *map  = NULL;
+#if defined(PETSC_HAVE_MMAP) && defined(PETSC_HAVE_SYS_MMAN_H)
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERBINARY,&isbinary);CHKERRQ(ierr);
+  if (!isbinary || !vbinary->usemmap || vbinary->btype != FILE_MODE_READ || num <= 0) PetscFunctionReturn(0);
+#if defined(PETSC_HAVE_MPIIO)
+  if (vbinary->usempiio) PetscFunctionReturn(0);
+#endif
+  ierr = MPI_Comm_size(PetscObjectComm((PetscObject)viewer),&size);CHKERRQ(ierr);
+  if (size > 1) PetscFunctionReturn(0);
+#if !defined(PETSC_WORDS_BIGENDIAN)
+  /* swapping the items in a private mapping would copy every page of it, so they are read as usual */
+  ierr = PetscInfo(viewer,"Binary files are big-endian, reading the data instead of mapping it\n");CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+#endif
+
+  ierr = PetscDataTypeGetSize(dtype,&tsize);CHKERRQ(ierr);
+  ierr = PetscBinarySeek(vbinary->fdes,0,PETSC_BINARY_SEEK_CUR,&off);CHKERRQ(ierr);
+  if (off % tsize) PetscFunctionReturn(0);
+  ierr = PetscBinarySeek(vbinary->fdes,0,PETSC_BINARY_SEEK_END,&end);CHKERRQ(ierr);
+  if (end < off + (off_t)(num*tsize)) {
+    ierr = PetscBinarySeek(vbinary->fdes,off,PETSC_BINARY_SEEK_SET,&end);CHKERRQ(ierr);
+    SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_READ,"Read past end of file");
+  }
+  ierr = PetscBinarySeek(vbinary->fdes,off + (off_t)(num*tsize),PETSC_BINARY_SEEK_SET,&end);CHKERRQ(ierr);
+
+#if defined(PETSC_HAVE_GETPAGESIZE)
+  pagesize = getpagesize();
+#else
+  pagesize = sysconf(_SC_PAGESIZE);
+#endif
+  start = off - off % pagesize;
+  len   = (size_t)(off - start) + num*tsize;
+  addr  = mmap(NULL,len,PROT_READ | PROT_WRITE,MAP_PRIVATE,vbinary->fdes,start);
+  if (addr == MAP_FAILED) {
+    ierr = PetscBinarySeek(vbinary->fdes,off,PETSC_BINARY_SEEK_SET,&end);CHKERRQ(ierr);
+    ierr = PetscInfo(viewer,"mmap() failed, reading the data instead\n");CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  *data = (char*)addr + (off - start);
+
+  ierr      = PetscNew(&ctx);CHKERRQ(ierr);
+  ctx->addr = addr;
+  ctx->len  = len;
+  ierr      = PetscContainerCreate(PETSC_COMM_SELF,map);CHKERRQ(ierr);
+  ierr      = PetscContainerSetPointer(*map,ctx);CHKERRQ(ierr);
+  ierr      = PetscContainerSetUserDestroy(*map,PetscViewerBinaryUnmap_Private);CHKERRQ(ierr);
+#endif
+  PetscFunctionReturn(0);
+}
+
 static PetscErrorCode  PetscViewerBinaryGetFlowControl_Binary(PetscViewer viewer,PetscInt *fc)
 {
   PetscViewer_Binary *vbinary = (PetscViewer_Binary*)viewer->data;
@@ -672,6 +1046,7 @@ static PetscErrorCode PetscViewerFileClose_BinaryMPIIO(PetscViewer v)
   PetscErrorCode     ierr;
 
   PetscFunctionBegin;
+  ierr = PetscViewerBinaryAsyncWait_Private(v,0);CHKERRQ(ierr);
   if (vbinary->mfdes) {
     ierr = MPI_File_close(&vbinary->mfdes);CHKERRQ(ierr);
   }
@@ -709,6 +1084,9 @@ static PetscErrorCode PetscViewerDestroy_Binary(PetscViewer v)
   }
 #endif
   if (vbinary->filename) { ierr = PetscFree(vbinary->filename);CHKERRQ(ierr); }
+#if defined(PETSC_HAVE_MPIIO)
+  ierr = PetscFree2(vbinary->requests,vbinary->stagebufs);CHKERRQ(ierr);
+#endif
   ierr = PetscFree(vbinary);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -789,6 +1167,18 @@ static PetscErrorCode PetscViewerBinaryWriteReadMPIIO(PetscViewer viewer,void *d
   PetscFunctionBegin;
   ierr = PetscMPIIntCast(num,&cnt);CHKERRQ(ierr);
   ierr = PetscDataTypeToMPIDataType(dtype,&mdtype);CHKERRQ(ierr);
+  if (write && vbinary->useasync) {
+    PetscMPIInt rank;
+
+    /* all processes write the same data, one copy suffices */
+    ierr = MPI_Comm_rank(PetscObjectComm((PetscObject)viewer),&rank);CHKERRQ(ierr);
+    ierr = MPI_Type_get_extent(mdtype,&ul,&dsize);CHKERRQ(ierr);
+    ierr = PetscViewerBinaryWriteAtAllMPIIO(viewer,vbinary->moff,data,rank ? 0 : cnt,mdtype);CHKERRQ(ierr);
+    vbinary->moff += dsize*cnt;
+    if (count) *count = num;
+    PetscFunctionReturn(0);
+  }
+  ierr = PetscViewerBinaryAsyncWait_Private(viewer,0);CHKERRQ(ierr);
   ierr = MPI_File_set_view(vbinary->mfdes,vbinary->moff,mdtype,mdtype,(char*)"native",MPI_INFO_NULL);CHKERRQ(ierr);
   if (write) {
     ierr = MPIU_File_write_all(vbinary->mfdes,data,cnt,mdtype,&status);CHKERRQ(ierr);
@@ -1206,6 +1596,7 @@ static PetscErrorCode PetscViewerFileSetUp_BinaryMPIIO(PetscViewer viewer)
   char               *gz;
   PetscBool          found;
   PetscFileMode      type = vbinary->btype;
+  MPI_Info           info;
 
   PetscFunctionBegin;
   if (type == (PetscFileMode) -1) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ORDER,"Must call PetscViewerFileSetMode()");
@@ -1216,12 +1607,20 @@ static PetscErrorCode PetscViewerFileSetUp_BinaryMPIIO(PetscViewer viewer)
 
   vbinary->storecompressed = PETSC_FALSE;
 
-  /* only first processor opens file if writeable */
+  /*
+     request two-phase collective buffering so that the collective reads and writes of all
+     processes (e.g. MatLoad()/MatView() of MPIAIJ matrices) are aggregated into large contiguous
+     file accesses by a few aggregator processes; implementations ignore hints they do not know
+  */
+  ierr = MPI_Info_create(&info);CHKERRQ(ierr);
+  ierr = MPI_Info_set(info,(char*)"romio_cb_read",(char*)"enable");CHKERRQ(ierr);
+  ierr = MPI_Info_set(info,(char*)"romio_cb_write",(char*)"enable");CHKERRQ(ierr);
   if (type == FILE_MODE_READ) {
-    MPI_File_open(PetscObjectComm((PetscObject)viewer),vbinary->filename,MPI_MODE_RDONLY,MPI_INFO_NULL,&vbinary->mfdes);CHKERRQ(ierr);
+    ierr = MPI_File_open(PetscObjectComm((PetscObject)viewer),vbinary->filename,MPI_MODE_RDONLY,info,&vbinary->mfdes);CHKERRQ(ierr);
   } else if (type == FILE_MODE_WRITE) {
-    MPI_File_open(PetscObjectComm((PetscObject)viewer),vbinary->filename,MPI_MODE_WRONLY | MPI_MODE_CREATE,MPI_INFO_NULL,&vbinary->mfdes);CHKERRQ(ierr);
+    ierr = MPI_File_open(PetscObjectComm((PetscObject)viewer),vbinary->filename,MPI_MODE_WRONLY | MPI_MODE_CREATE,info,&vbinary->mfdes);CHKERRQ(ierr);
   }
+  ierr = MPI_Info_free(&info);CHKERRQ(ierr);
 
   /*
       try to open info file: all processors open this file if read only
@@ -1264,6 +1663,22 @@ static PetscErrorCode PetscViewerBinarySetUseMPIIO_Binary(PetscViewer viewer,Pet
 }
 #endif
 
+static PetscErrorCode PetscViewerFlush_Binary(PetscViewer v)
+{
+#if defined(PETSC_HAVE_MPIIO)
+  PetscViewer_Binary *vbinary = (PetscViewer_Binary*)v->data;
+  PetscErrorCode     ierr;
+#endif
+
+  PetscFunctionBegin;
+#if defined(PETSC_HAVE_MPIIO)
+  if (vbinary->usempiio) {
+    ierr = PetscViewerBinaryAsyncWait_Private(v,0);CHKERRQ(ierr);
+  }
+#endif
+  PetscFunctionReturn(0);
+}
+
 static PetscErrorCode PetscViewerView_Binary(PetscViewer v,PetscViewer viewer)
 {
   PetscErrorCode     ierr;
@@ -1285,6 +1700,10 @@ static PetscErrorCode PetscViewerSetUp_Binary(PetscViewer v)
   if (!binary->setfromoptionscalled) { ierr = PetscViewerSetFromOptions(v);CHKERRQ(ierr); }
     
 #if defined(PETSC_HAVE_MPIIO)
+  if (binary->useasync) {
+    binary->usempiio = PETSC_TRUE;
+    if (!binary->requests) {ierr = PetscMalloc2(binary->maxpending,&binary->requests,binary->maxpending,&binary->stagebufs);CHKERRQ(ierr);}
+  }
   if (binary->usempiio) {
     ierr = PetscViewerFileSetUp_BinaryMPIIO(v);CHKERRQ(ierr);
   } else {
@@ -1311,8 +1730,13 @@ static PetscErrorCode PetscViewerSetFromOptions_Binary(PetscOptionItems *PetscOp
   ierr = PetscOptionsBool("-viewer_binary_skip_info","Skip writing/reading .info file","PetscViewerBinarySetSkipInfo",PETSC_FALSE,&binary->skipinfo,NULL);CHKERRQ(ierr);
   ierr = PetscOptionsBool("-viewer_binary_skip_options","Skip parsing vec load options","PetscViewerBinarySetSkipOptions",PETSC_TRUE,&binary->skipoptions,NULL);CHKERRQ(ierr);
   ierr = PetscOptionsBool("-viewer_binary_skip_header","Skip writing/reading header information","PetscViewerBinarySetSkipHeader",PETSC_FALSE,&binary->skipheader,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-viewer_binary_mmap","Map the file into memory when loading on one process","PetscViewerBinarySetUseMmap",binary->usemmap,&binary->usemmap,NULL);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_MPIIO)
   ierr = PetscOptionsBool("-viewer_binary_mpiio","Use MPI-IO functionality to write/read binary file","PetscViewerBinarySetUseMPIIO",PETSC_FALSE,&binary->usempiio,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-viewer_binary_async","Write asynchronously with nonblocking MPI-IO","PetscViewerBinarySetUseAsync",binary->useasync,&binary->useasync,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-viewer_binary_async_max_pending","Number of asynchronous writes allowed to be outstanding","PetscViewerBinarySetUseAsync",binary->maxpending,&binary->maxpending,NULL);CHKERRQ(ierr);
+  if (binary->maxpending < 1) SETERRQ1(PetscObjectComm((PetscObject)v),PETSC_ERR_ARG_OUTOFRANGE,"Number of pending writes must be positive, %D was set",binary->maxpending);
+  if (binary->useasync) binary->usempiio = PETSC_TRUE;
 #elif defined(PETSC_HAVE_MPIUNI)
   ierr = PetscOptionsBool("-viewer_binary_mpiio","Use MPI-IO functionality to write/read binary file","PetscViewerBinarySetUseMPIIO",PETSC_FALSE,NULL,NULL);CHKERRQ(ierr);  
 #endif
@@ -1346,12 +1770,13 @@ PETSC_EXTERN PetscErrorCode PetscViewerCreate_Binary(PetscViewer v)
   v->ops->destroy          = PetscViewerDestroy_Binary;
   v->ops->view             = PetscViewerView_Binary;
   v->ops->setup            = PetscViewerSetUp_Binary;
-  v->ops->flush            = NULL;
+  v->ops->flush            = PetscViewerFlush_Binary;
   vbinary->fdes_info       = 0;
   vbinary->fdes            = 0;
   vbinary->skipinfo        = PETSC_FALSE;
   vbinary->skipoptions     = PETSC_TRUE;
   vbinary->skipheader      = PETSC_FALSE;
+  vbinary->usemmap         = PETSC_FALSE;
   vbinary->setfromoptionscalled = PETSC_FALSE;
   v->ops->getsubviewer     = PetscViewerGetSubViewer_Binary;
   v->ops->restoresubviewer = PetscViewerRestoreSubViewer_Binary;
@@ -1360,6 +1785,9 @@ PETSC_EXTERN PetscErrorCode PetscViewerCreate_Binary(PetscViewer v)
   vbinary->storecompressed = PETSC_FALSE;
   vbinary->filename        = 0;
   vbinary->flowcontrol     = 256; /* seems a good number for Cray XT-5 */
+#if defined(PETSC_HAVE_MPIIO)
+  vbinary->maxpending      = 2;
+#endif
 
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinaryGetFlowControl_C",PetscViewerBinaryGetFlowControl_Binary);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinarySetFlowControl_C",PetscViewerBinarySetFlowControl_Binary);CHKERRQ(ierr);
@@ -1370,6 +1798,8 @@ PETSC_EXTERN PetscErrorCode PetscViewerCreate_Binary(PetscViewer v)
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinaryGetSkipInfo_C",PetscViewerBinaryGetSkipInfo_Binary);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinarySetSkipInfo_C",PetscViewerBinarySetSkipInfo_Binary);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinaryGetInfoPointer_C",PetscViewerBinaryGetInfoPointer_Binary);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinaryGetUseMmap_C",PetscViewerBinaryGetUseMmap_Binary);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinarySetUseMmap_C",PetscViewerBinarySetUseMmap_Binary);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerFileSetName_C",PetscViewerFileSetName_Binary);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerFileSetMode_C",PetscViewerFileSetMode_Binary);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerFileGetMode_C",PetscViewerFileGetMode_Binary);CHKERRQ(ierr);
@@ -1377,6 +1807,8 @@ PETSC_EXTERN PetscErrorCode PetscViewerCreate_Binary(PetscViewer v)
 #if defined(PETSC_HAVE_MPIIO)
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinaryGetUseMPIIO_C",PetscViewerBinaryGetUseMPIIO_Binary);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinarySetUseMPIIO_C",PetscViewerBinarySetUseMPIIO_Binary);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinaryGetUseAsync_C",PetscViewerBinaryGetUseAsync_Binary);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerBinarySetUseAsync_C",PetscViewerBinarySetUseAsync_Binary);CHKERRQ(ierr);
 #endif
   PetscFunctionReturn(0);
 }
@@ -1404,7 +1836,9 @@ static int Petsc_Viewer_Binary_keyval = MPI_KEYVAL_INVALID;
 .    -viewer_binary_skip_info
 .    -viewer_binary_skip_options
 .    -viewer_binary_skip_header
--    -viewer_binary_mpiio
+.    -viewer_binary_mpiio
+.    -viewer_binary_async
+-    -viewer_binary_mmap
 
    Environmental variables:
 -   PETSC_VIEWER_BINARY_FILENAME
@@ -14,6 +14,13 @@ typedef struct {
   GroupList     *groups;
   PetscBool     basedimension2;  /* save vectors and DMDA vectors with a dimension of at least 2 even if the bs/dof is 1 */
   PetscBool     spoutput;  /* write data in single precision even if PETSc is compiled with double precision PetscReal */
+  PetscInt      chunksize;      /* number of vector entries in a chunk, 0 for one chunk per timestep */
+  PetscInt      compress;       /* deflate level of the datasets, 0 for no compression */
+  PetscInt      szip;           /* pixels per block of the szip filter, 0 for no szip compression */
+  PetscBool     shuffle;        /* apply the shuffle filter before compressing */
+  PetscInt      alignment;      /* align file objects larger than alignthreshold bytes to multiples of alignment bytes */
+  PetscInt      alignthreshold;
+  PetscBool     collective;     /* collective or independent transfer of dataset raw data */
 } PetscViewer_HDF5;
 
 static PetscErrorCode PetscViewerSetFromOptions_HDF5(PetscOptionItems *PetscOptionsObject,PetscViewer v)
@@ -25,6 +32,17 @@ static PetscErrorCode PetscViewerSetFromOptions_HDF5(PetscOptionItems *PetscOpti
   ierr = PetscOptionsHead(PetscOptionsObject,"HDF5 PetscViewer Options");CHKERRQ(ierr);
   ierr = PetscOptionsBool("-viewer_hdf5_base_dimension2","1d Vectors get 2 dimensions in HDF5","PetscViewerHDF5SetBaseDimension2",hdf5->basedimension2,&hdf5->basedimension2,NULL);CHKERRQ(ierr);
   ierr = PetscOptionsBool("-viewer_hdf5_sp_output","Force data to be written in single precision","PetscViewerHDF5SetSPOutput",hdf5->spoutput,&hdf5->spoutput,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-viewer_hdf5_chunk_size","Number of vector entries in a dataset chunk, 0 for one chunk per timestep","PetscViewerHDF5SetChunkSize",hdf5->chunksize,&hdf5->chunksize,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-viewer_hdf5_compress","Deflate level (0-9) for compressing datasets, 0 for none","PetscViewerHDF5SetCompress",hdf5->compress,&hdf5->compress,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-viewer_hdf5_szip","Pixels per block for szip compression of datasets, 0 for none","PetscViewerHDF5SetCompress",hdf5->szip,&hdf5->szip,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-viewer_hdf5_shuffle","Shuffle the bytes of dataset values before compressing them","PetscViewerHDF5SetCompress",hdf5->shuffle,&hdf5->shuffle,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-viewer_hdf5_alignment","Align file objects to multiples of this number of bytes, for example the file system stripe size","PetscViewerHDF5SetAlignment",hdf5->alignment,&hdf5->alignment,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-viewer_hdf5_alignment_threshold","Only align file objects of at least this number of bytes","PetscViewerHDF5SetAlignment",hdf5->alignthreshold,&hdf5->alignthreshold,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-viewer_hdf5_collective","Use collective instead of independent transfers of dataset values","PetscViewerHDF5SetCollective",hdf5->collective,&hdf5->collective,NULL);CHKERRQ(ierr);
+  if (hdf5->chunksize < 0) SETERRQ1(PetscObjectComm((PetscObject)v),PETSC_ERR_ARG_OUTOFRANGE,"Chunk size cannot be negative, %D was set",hdf5->chunksize);
+  if (hdf5->compress < 0 || hdf5->compress > 9) SETERRQ1(PetscObjectComm((PetscObject)v),PETSC_ERR_ARG_OUTOFRANGE,"Deflate level must be between 0 and 9, %D was set",hdf5->compress);
+  if (hdf5->szip < 0 || hdf5->szip % 2 || hdf5->szip > 32) SETERRQ1(PetscObjectComm((PetscObject)v),PETSC_ERR_ARG_OUTOFRANGE,"Szip pixels per block must be even and at most 32, %D was set",hdf5->szip);
+  if (hdf5->alignment < 0 || hdf5->alignthreshold < 0) SETERRQ(PetscObjectComm((PetscObject)v),PETSC_ERR_ARG_OUTOFRANGE,"Alignment and its threshold cannot be negative");
   ierr = PetscOptionsTail();CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -215,11 +233,276 @@ PetscErrorCode PetscViewerHDF5GetSPOutput(PetscViewer viewer,PetscBool *flg)
   PetscFunctionReturn(0);
 }
 
+static PetscErrorCode PetscViewerHDF5SetChunkSize_HDF5(PetscViewer viewer,PetscInt n)
+{
+  PetscViewer_HDF5 *hdf5 = (PetscViewer_HDF5*) viewer->data;
+
+  PetscFunctionBegin;
+  if (n < 0) SETERRQ1(PetscObjectComm((PetscObject)viewer),PETSC_ERR_ARG_OUTOFRANGE,"Chunk size cannot be negative, %D was given",n);
+  hdf5->chunksize = n;
+  PetscFunctionReturn(0);
+}
+
+/*@
+     PetscViewerHDF5SetChunkSize - Sets the number of vector entries stored in each chunk of the datasets
+       written by VecView()
+
+    Logically Collective on PetscViewer
+
+  Input Parameters:
++  viewer - the PetscViewer; if it is not hdf5 then this command is ignored
+-  n - number of vector entries in a chunk, or 0 to store each timestep of the vector in a single chunk
+
+  Options Database:
+.  -viewer_hdf5_chunk_size <n> - number of vector entries in a chunk
+
+  Notes: The chunk is the unit of compression and of I/O to the file. A chunk covering a whole timestep of a large
+         vector can exceed the 4 GB limit HDF5 puts on a chunk, and when compressing in parallel each chunk shared by
+         several processes must be gathered before it is compressed. Chunks of a few megabytes that evenly divide the
+         local parts of the vector usually write fastest.
+
+  Level: advanced
+
+.seealso: PetscViewerHDF5SetCompress(), PetscViewerHDF5SetAlignment(), PetscViewerHDF5SetCollective(), VecView()
+@*/
+PetscErrorCode PetscViewerHDF5SetChunkSize(PetscViewer viewer,PetscInt n)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  PetscValidLogicalCollectiveInt(viewer,n,2);
+  ierr = PetscTryMethod(viewer,"PetscViewerHDF5SetChunkSize_C",(PetscViewer,PetscInt),(viewer,n));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscViewerHDF5SetCompress_HDF5(PetscViewer viewer,PetscInt level,PetscBool shuffle)
+{
+  PetscViewer_HDF5 *hdf5 = (PetscViewer_HDF5*) viewer->data;
+
+  PetscFunctionBegin;
+  if (level < 0 || level > 9) SETERRQ1(PetscObjectComm((PetscObject)viewer),PETSC_ERR_ARG_OUTOFRANGE,"Deflate level must be between 0 and 9, %D was given",level);
+  hdf5->compress = level;
+  hdf5->shuffle  = shuffle;
+  PetscFunctionReturn(0);
+}
+
+/*@
+     PetscViewerHDF5SetCompress - Compresses the datasets written by VecView() with the deflate (gzip) filter
+
+    Logically Collective on PetscViewer
+
+  Input Parameters:
++  viewer - the PetscViewer; if it is not hdf5 then this command is ignored
+.  level - deflate level from 1 (fastest) to 9 (smallest), or 0 for no compression
+-  shuffle - if PETSC_TRUE the bytes of the values are shuffled before the compression, which usually compresses
+             floating point data much better
+
+  Options Database:
++  -viewer_hdf5_compress <level> - deflate level
+.  -viewer_hdf5_shuffle - shuffle the bytes before compressing
+-  -viewer_hdf5_szip <n> - compress with szip using n pixels per block instead, if HDF5 was built with szip
+
+  Notes: Compression is applied per chunk, see PetscViewerHDF5SetChunkSize(). Writing compressed datasets in parallel
+         requires HDF5 1.10.2 or later and collective transfers.
+
+  Level: advanced
+
+.seealso: PetscViewerHDF5SetChunkSize(), PetscViewerHDF5SetCollective(), VecView()
+@*/
+PetscErrorCode PetscViewerHDF5SetCompress(PetscViewer viewer,PetscInt level,PetscBool shuffle)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  PetscValidLogicalCollectiveInt(viewer,level,2);
+  PetscValidLogicalCollectiveBool(viewer,shuffle,3);
+  ierr = PetscTryMethod(viewer,"PetscViewerHDF5SetCompress_C",(PetscViewer,PetscInt,PetscBool),(viewer,level,shuffle));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscViewerHDF5SetAlignment_HDF5(PetscViewer viewer,PetscInt threshold,PetscInt alignment)
+{
+  PetscViewer_HDF5 *hdf5 = (PetscViewer_HDF5*) viewer->data;
+
+  PetscFunctionBegin;
+  if (hdf5->file_id) SETERRQ(PetscObjectComm((PetscObject)viewer),PETSC_ERR_ORDER,"Must call PetscViewerHDF5SetAlignment() before PetscViewerFileSetName()");
+  if (threshold < 0 || alignment < 0) SETERRQ(PetscObjectComm((PetscObject)viewer),PETSC_ERR_ARG_OUTOFRANGE,"Alignment and its threshold cannot be negative");
+  hdf5->alignthreshold = threshold;
+  hdf5->alignment      = alignment;
+  PetscFunctionReturn(0);
+}
+
+/*@
+     PetscViewerHDF5SetAlignment - Aligns the objects in the HDF5 file, for example to the stripe size of a parallel
+       file system so that each chunk is written to as few storage targets as possible
+
+    Logically Collective on PetscViewer
+
+  Input Parameters:
++  viewer - the PetscViewer; if it is not hdf5 then this command is ignored
+.  threshold - only objects of at least this number of bytes are aligned
+-  alignment - objects start at multiples of this number of bytes, or 0 for no alignment
+
+  Options Database:
++  -viewer_hdf5_alignment <bytes> - alignment
+-  -viewer_hdf5_alignment_threshold <bytes> - threshold
+
+  Notes: Must be called before PetscViewerFileSetName(). When a new file is created with MPI-IO the alignment is
+         also passed as the striping_unit hint, which file systems like Lustre and GPFS use for a new file.
+
+  Level: advanced
+
+.seealso: PetscViewerHDF5SetChunkSize(), PetscViewerHDF5SetCollective(), PetscViewerFileSetName()
+@*/
+PetscErrorCode PetscViewerHDF5SetAlignment(PetscViewer viewer,PetscInt threshold,PetscInt alignment)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  PetscValidLogicalCollectiveInt(viewer,threshold,2);
+  PetscValidLogicalCollectiveInt(viewer,alignment,3);
+  ierr = PetscTryMethod(viewer,"PetscViewerHDF5SetAlignment_C",(PetscViewer,PetscInt,PetscInt),(viewer,threshold,alignment));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PetscViewerHDF5SetCollective_HDF5(PetscViewer viewer,PetscBool flg)
+{
+  PetscViewer_HDF5 *hdf5 = (PetscViewer_HDF5*) viewer->data;
+
+  PetscFunctionBegin;
+  hdf5->collective = flg;
+  PetscFunctionReturn(0);
+}
+
+/*@
+     PetscViewerHDF5SetCollective - Transfers the values of vectors to and from the file with collective or with
+       independent MPI-IO operations
+
+    Logically Collective on PetscViewer
+
+  Input Parameters:
++  viewer - the PetscViewer; if it is not hdf5 then this command is ignored
+-  flg - PETSC_TRUE (the default) for collective transfers, PETSC_FALSE for independent ones
+
+  Options Database:
+.  -viewer_hdf5_collective <true,false> - collective or independent transfers
+
+  Notes: Collective transfers let the MPI-IO layer aggregate the data of many processes into large requests that
+         match the file system (collective buffering). Independent transfers can be faster when few processes
+         own most of the data.
+
+  Level: advanced
+
+.seealso: PetscViewerHDF5SetChunkSize(), PetscViewerHDF5SetCompress(), PetscViewerHDF5SetAlignment()
+@*/
+PetscErrorCode PetscViewerHDF5SetCollective(PetscViewer viewer,PetscBool flg)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  PetscValidLogicalCollectiveBool(viewer,flg,2);
+  ierr = PetscTryMethod(viewer,"PetscViewerHDF5SetCollective_C",(PetscViewer,PetscBool),(viewer,flg));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*@C
+     PetscViewerHDF5CreateDatasetPList - Creates the property list for creating a dataset with the chunking and the
+       filters set for the viewer
+
+    Collective on PetscViewer
+
+  Input Parameters:
++  viewer - the PetscViewer, must be of type HDF5
+.  dim - number of dimensions of the dataset
+.  vdim - the dimension along which the vector is laid out
+-  bs - number of vector entries per index of that dimension
+
+  Input/Output Parameter:
+.  chunkDims - on input one chunk per timestep, on output the chunk dimensions used
+
+  Output Parameter:
+.  plist - the property list, to be closed with H5Pclose()
+
+  Level: developer
+
+.seealso: PetscViewerHDF5SetChunkSize(), PetscViewerHDF5SetCompress(), PetscViewerHDF5CreateTransferPList()
+@*/
+PetscErrorCode PetscViewerHDF5CreateDatasetPList(PetscViewer viewer,int dim,int vdim,PetscInt bs,hsize_t chunkDims[],hid_t *plist)
+{
+  PetscViewer_HDF5 *hdf5 = (PetscViewer_HDF5*) viewer->data;
+  PetscMPIInt      size;
+  hsize_t          len;
+  htri_t           avail;
+  PetscErrorCode   ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  if (hdf5->chunksize) {
+    ierr = PetscHDF5IntCast(PetscMax(hdf5->chunksize/bs,1),&len);CHKERRQ(ierr);
+    chunkDims[vdim] = PetscMin(chunkDims[vdim],len);
+  }
+  /* HDF5 does not accept empty chunks */
+  chunkDims[vdim] = PetscMax(chunkDims[vdim],1);
+  if (hdf5->compress || hdf5->szip || hdf5->shuffle) {
+    ierr = MPI_Comm_size(PetscObjectComm((PetscObject)viewer),&size);CHKERRQ(ierr);
+#if (H5_VERS_MAJOR * 10000 + H5_VERS_MINOR * 100 + H5_VERS_RELEASE < 11002)
+    if (size > 1) SETERRQ(PetscObjectComm((PetscObject)viewer),PETSC_ERR_SUP,"Writing compressed datasets in parallel requires HDF5 1.10.2 or later");
+#endif
+    if (size > 1 && !hdf5->collective) SETERRQ(PetscObjectComm((PetscObject)viewer),PETSC_ERR_SUP,"Writing compressed datasets in parallel requires collective transfers");
+  }
+  PetscStackCallHDF5Return(*plist,H5Pcreate,(H5P_DATASET_CREATE));
+  PetscStackCallHDF5(H5Pset_chunk,(*plist, dim, chunkDims));
+  if (hdf5->shuffle) PetscStackCallHDF5(H5Pset_shuffle,(*plist));
+  if (hdf5->szip) {
+    PetscStackCallHDF5Return(avail,H5Zfilter_avail,(H5Z_FILTER_SZIP));
+    if (!avail) SETERRQ(PetscObjectComm((PetscObject)viewer),PETSC_ERR_SUP,"HDF5 was built without szip compression");
+    PetscStackCallHDF5(H5Pset_szip,(*plist, H5_SZIP_NN_OPTION_MASK, (unsigned)hdf5->szip));
+  }
+  if (hdf5->compress) PetscStackCallHDF5(H5Pset_deflate,(*plist, (unsigned)hdf5->compress));
+  PetscFunctionReturn(0);
+}
+
+/*@C
+     PetscViewerHDF5CreateTransferPList - Creates the property list for transferring the values of a dataset,
+       collectively or independently as set with PetscViewerHDF5SetCollective()
+
+    Not Collective
+
+  Input Parameter:
+.  viewer - the PetscViewer, must be of type HDF5
+
+  Output Parameter:
+.  plist - the property list, to be closed with H5Pclose()
+
+  Level: developer
+
+.seealso: PetscViewerHDF5SetCollective(), PetscViewerHDF5CreateDatasetPList()
+@*/
+PetscErrorCode PetscViewerHDF5CreateTransferPList(PetscViewer viewer,hid_t *plist)
+{
+#if defined(PETSC_HAVE_H5PSET_FAPL_MPIO)
+  PetscViewer_HDF5 *hdf5 = (PetscViewer_HDF5*) viewer->data;
+#endif
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  PetscStackCallHDF5Return(*plist,H5Pcreate,(H5P_DATASET_XFER));
+#if defined(PETSC_HAVE_H5PSET_FAPL_MPIO)
+  PetscStackCallHDF5(H5Pset_dxpl_mpio,(*plist, hdf5->collective ? H5FD_MPIO_COLLECTIVE : H5FD_MPIO_INDEPENDENT));
+#endif
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode  PetscViewerFileSetName_HDF5(PetscViewer viewer, const char name[])
 {
   PetscViewer_HDF5 *hdf5 = (PetscViewer_HDF5*) viewer->data;
 #if defined(PETSC_HAVE_H5PSET_FAPL_MPIO)
   MPI_Info          info = MPI_INFO_NULL;
+  char              stripe[32];
 #endif
   hid_t             plist_id;
   PetscErrorCode    ierr;
@@ -231,8 +514,16 @@ PetscErrorCode  PetscViewerFileSetName_HDF5(PetscViewer viewer, const char name[
   /* Set up file access property list with parallel I/O access */
   PetscStackCallHDF5Return(plist_id,H5Pcreate,(H5P_FILE_ACCESS));
 #if defined(PETSC_HAVE_H5PSET_FAPL_MPIO)
+  if (hdf5->alignment > 0 && hdf5->btype == FILE_MODE_WRITE) {
+    /* ask the MPI-IO layer to create the file with the same stripe size the objects are aligned to */
+    ierr = PetscSNPrintf(stripe,sizeof(stripe),"%D",hdf5->alignment);CHKERRQ(ierr);
+    ierr = MPI_Info_create(&info);CHKERRQ(ierr);
+    ierr = MPI_Info_set(info,(char*)"striping_unit",stripe);CHKERRQ(ierr);
+  }
   PetscStackCallHDF5(H5Pset_fapl_mpio,(plist_id, PetscObjectComm((PetscObject)viewer), info));
+  if (info != MPI_INFO_NULL) {ierr = MPI_Info_free(&info);CHKERRQ(ierr);}
 #endif
+  if (hdf5->alignment > 0) PetscStackCallHDF5(H5Pset_alignment,(plist_id, (hsize_t)hdf5->alignthreshold, (hsize_t)hdf5->alignment));
   /* Create or open the file collectively */
   switch (hdf5->btype) {
   case FILE_MODE_READ:
@@ -289,12 +580,17 @@ PETSC_EXTERN PetscErrorCode PetscViewerCreate_HDF5(PetscViewer v)
   hdf5->filename         = 0;
   hdf5->timestep         = -1;
   hdf5->groups           = NULL;
+  hdf5->collective       = PETSC_TRUE;
 
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerFileSetName_C",PetscViewerFileSetName_HDF5);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerFileGetName_C",PetscViewerFileGetName_HDF5);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerFileSetMode_C",PetscViewerFileSetMode_HDF5);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerHDF5SetBaseDimension2_C",PetscViewerHDF5SetBaseDimension2_HDF5);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerHDF5SetSPOutput_C",PetscViewerHDF5SetSPOutput_HDF5);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerHDF5SetChunkSize_C",PetscViewerHDF5SetChunkSize_HDF5);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerHDF5SetCompress_C",PetscViewerHDF5SetCompress_HDF5);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerHDF5SetAlignment_C",PetscViewerHDF5SetAlignment_HDF5);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)v,"PetscViewerHDF5SetCollective_C",PetscViewerHDF5SetCollective_HDF5);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -317,6 +613,13 @@ $    FILE_MODE_APPEND - open existing file for binary output
   Options Database:
 .  -viewer_hdf5_base_dimension2 - turns on (true) or off (false) using a dimension of 2 in the HDF5 file even if the bs/dof of the vector is 1
 .  -viewer_hdf5_sp_output - forces (if true) the viewer to write data in single precision independent on the precision of PetscReal
+.  -viewer_hdf5_chunk_size <n> - number of vector entries in a dataset chunk
+.  -viewer_hdf5_compress <level> - deflate level of the datasets
+.  -viewer_hdf5_szip <n> - pixels per block for szip compression of the datasets
+.  -viewer_hdf5_shuffle - shuffle the bytes of the values before compressing them
+.  -viewer_hdf5_alignment <bytes> - align file objects, for example to the stripe size of the file system
+.  -viewer_hdf5_alignment_threshold <bytes> - only align objects at least this large
+-  -viewer_hdf5_collective <true,false> - collective (default) or independent transfer of the values
 
    Level: beginner
 
@@ -338,6 +641,10 @@ PetscErrorCode  PetscViewerHDF5Open(MPI_Comm comm, const char name[], PetscFileM
   ierr = PetscViewerCreate(comm, hdf5v);CHKERRQ(ierr);
   ierr = PetscViewerSetType(*hdf5v, PETSCVIEWERHDF5);CHKERRQ(ierr);
   ierr = PetscViewerFileSetMode(*hdf5v, type);CHKERRQ(ierr);
+  /* the alignment is a property of the open file, so the options must be processed first */
+  ierr = PetscObjectOptionsBegin((PetscObject)*hdf5v);CHKERRQ(ierr);
+  ierr = PetscViewerSetFromOptions_HDF5(PetscOptionsObject,*hdf5v);CHKERRQ(ierr);
+  ierr = PetscOptionsEnd();CHKERRQ(ierr);
   ierr = PetscViewerFileSetName(*hdf5v, name);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
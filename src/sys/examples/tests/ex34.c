@@ -0,0 +1,92 @@
+
+static char help[] = "Tests the open-addressing hash sets and maps PetscHSetI, PetscHMapI and PetscHMapIJ.\n\n";
+
+#include <petscsys.h>
+#include <petsc/private/hashseti.h>
+#include <petsc/private/hashmapi.h>
+#include <petsc/private/hashmapij.h>
+
+int main(int argc,char **argv)
+{
+  PetscHSetI     set;
+  PetscHMapI     map;
+  PetscHMapIJ    mapij;
+  PetscHMapIJKey key;
+  PetscInt       N = 1000,i,n,off,*keys,*vals,look[4] = {-7,3,8,123456},lval[4];
+  PetscBool      has,missing;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&argv,NULL,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&N,NULL);CHKERRQ(ierr);
+  ierr = PetscMalloc2(N,&keys,N,&vals);CHKERRQ(ierr);
+
+  /* strided keys would all collide in a table indexed by the low bits of the key */
+  ierr = PetscHSetICreate(&set);CHKERRQ(ierr);
+  for (i=0; i<N; i++) keys[i] = 1024*(i % (N/2));
+  ierr = PetscHSetIAddArray(set,N,keys);CHKERRQ(ierr);
+  ierr = PetscHSetIGetSize(set,&n);CHKERRQ(ierr);
+  if (n != N/2) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Set has %D entries, expected %D",n,N/2);
+  /* delete every other key, the remaining ones must still be found after the backward shifts */
+  for (i=0; i<N/2; i+=2) {ierr = PetscHSetIDel(set,1024*i);CHKERRQ(ierr);}
+  for (i=0; i<N/2; i++) {
+    ierr = PetscHSetIHas(set,1024*i,&has);CHKERRQ(ierr);
+    if (has != (i%2 ? PETSC_TRUE : PETSC_FALSE)) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Wrong membership for key %D",1024*i);
+  }
+  ierr = PetscHSetIQueryAdd(set,-1,&missing);CHKERRQ(ierr);
+  ierr = PetscHSetIQueryAdd(set,1024,&has);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_SELF,"Set: inserted -1 %d, inserted 1024 %d\n",(int)missing,(int)has);CHKERRQ(ierr);
+  off  = 0;
+  ierr = PetscHSetIGetElems(set,&off,keys);CHKERRQ(ierr);
+  ierr = PetscSortInt(off,keys);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_SELF,"Set: %D entries, smallest %D %D %D\n",off,keys[0],keys[1],keys[2]);CHKERRQ(ierr);
+  ierr = PetscHSetIClear(set);CHKERRQ(ierr);
+  ierr = PetscHSetIGetSize(set,&n);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_SELF,"Set: %D entries after clear\n",n);CHKERRQ(ierr);
+  ierr = PetscHSetIDestroy(&set);CHKERRQ(ierr);
+
+  /* map, including negative keys and value accumulation */
+  ierr = PetscHMapICreate(&map);CHKERRQ(ierr);
+  for (i=0; i<N; i++) {keys[i] = i - N/2; vals[i] = 2*i;}
+  ierr = PetscHMapISetArray(map,N,keys,vals);CHKERRQ(ierr);
+  ierr = PetscHMapIAddValue(map,3,100);CHKERRQ(ierr);
+  ierr = PetscHMapIDel(map,8);CHKERRQ(ierr);
+  ierr = PetscHMapILookupArray(map,4,look,lval);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_SELF,"Map: %D -> %D, %D -> %D, %D -> %D, %D -> %D\n",look[0],lval[0],look[1],lval[1],look[2],lval[2],look[3],lval[3]);CHKERRQ(ierr);
+  ierr = PetscHMapIGetWithDefault(map,8,0,&lval[0]);CHKERRQ(ierr);
+  ierr = PetscHMapIGetSize(map,&n);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_SELF,"Map: %D entries, deleted key gives default %D\n",n,lval[0]);CHKERRQ(ierr);
+  off  = 0;
+  ierr = PetscHMapIGetPairs(map,&off,keys,vals);CHKERRQ(ierr);
+  for (i=0; i<off; i++) {
+    if (keys[i] != 3 && vals[i] != 2*(keys[i]+N/2)) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Wrong pair %D %D",keys[i],vals[i]);
+  }
+  ierr = PetscHMapIDestroy(&map);CHKERRQ(ierr);
+
+  /* pair keys */
+  ierr = PetscHMapIJCreate(&mapij);CHKERRQ(ierr);
+  for (i=0; i<N; i++) {
+    key.i = i % 10; key.j = i / 10;
+    ierr  = PetscHMapIJAddValue(mapij,key,1);CHKERRQ(ierr);
+    key.i = i / 10; key.j = i % 10;
+    ierr  = PetscHMapIJAddValue(mapij,key,1);CHKERRQ(ierr);
+  }
+  key.i = 2; key.j = 3;
+  ierr = PetscHMapIJGet(mapij,key,&lval[0]);CHKERRQ(ierr);
+  key.i = 2; key.j = 30;
+  ierr = PetscHMapIJGet(mapij,key,&lval[1]);CHKERRQ(ierr);
+  key.i = 30; key.j = 30;
+  ierr = PetscHMapIJGet(mapij,key,&lval[2]);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_SELF,"MapIJ: (2,3) -> %D, (2,30) -> %D, (30,30) -> %D\n",lval[0],lval[1],lval[2]);CHKERRQ(ierr);
+  ierr = PetscHMapIJDestroy(&mapij);CHKERRQ(ierr);
+
+  ierr = PetscFree2(keys,vals);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
+
+
+/*TEST
+
+   test:
+
+TEST*/
@@ -780,5 +780,30 @@ PetscErrorCode MPIU_File_read_all(MPI_File fd,void *data,PetscMPIInt cnt,MPI_Dat
   ierr = PetscByteSwap(data,pdtype,cnt);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
+
+PetscErrorCode MPIU_File_write_at_all(MPI_File fd,MPI_Offset off,void *data,PetscMPIInt cnt,MPI_Datatype dtype,MPI_Status *status)
+{
+  PetscErrorCode ierr;
+  PetscDataType  pdtype;
+
+  PetscFunctionBegin;
+  ierr = PetscMPIDataTypeToPetscDataType(dtype,&pdtype);CHKERRQ(ierr);
+  ierr = PetscByteSwap(data,pdtype,cnt);CHKERRQ(ierr);
+  ierr = MPI_File_write_at_all(fd,off,data,cnt,dtype,status);CHKERRQ(ierr);
+  ierr = PetscByteSwap(data,pdtype,cnt);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MPIU_File_read_at_all(MPI_File fd,MPI_Offset off,void *data,PetscMPIInt cnt,MPI_Datatype dtype,MPI_Status *status)
+{
+  PetscErrorCode ierr;
+  PetscDataType  pdtype;
+
+  PetscFunctionBegin;
+  ierr = PetscMPIDataTypeToPetscDataType(dtype,&pdtype);CHKERRQ(ierr);
+  ierr = MPI_File_read_at_all(fd,off,data,cnt,dtype,status);CHKERRQ(ierr);
+  ierr = PetscByteSwap(data,pdtype,cnt);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
 #endif
 #endif
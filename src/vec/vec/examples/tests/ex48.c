@@ -0,0 +1,55 @@
+
+static char help[] = "Tests asynchronous VecView() with a binary viewer, the vector is changed while the writes are pending.\n\n";
+
+#include <petscvec.h>
+#include <petscviewer.h>
+
+int main(int argc,char **args)
+{
+  Vec            x,y;
+  PetscViewer    viewer;
+  PetscInt       i,n = 25,nsteps = 5;
+  PetscReal      norm;
+  PetscScalar    *a;
+  PetscBool      isasync,ismpiio;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = VecCreateMPI(PETSC_COMM_WORLD,PETSC_DECIDE,n,&x);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&y);CHKERRQ(ierr);
+
+  ierr = PetscViewerCreate(PETSC_COMM_WORLD,&viewer);CHKERRQ(ierr);
+  ierr = PetscViewerSetType(viewer,PETSCVIEWERBINARY);CHKERRQ(ierr);
+  ierr = PetscViewerBinarySetUseAsync(viewer,PETSC_TRUE);CHKERRQ(ierr);
+  ierr = PetscViewerFileSetMode(viewer,FILE_MODE_WRITE);CHKERRQ(ierr);
+  ierr = PetscViewerFileSetName(viewer,"async.dat");CHKERRQ(ierr);
+  ierr = PetscViewerBinaryGetUseAsync(viewer,&isasync);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryGetUseMPIIO(viewer,&ismpiio);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Asynchronous %d, MPI-IO %d\n",(int)isasync,(int)ismpiio);CHKERRQ(ierr);
+  for (i=0; i<nsteps; i++) {
+    ierr = VecSet(x,(PetscScalar)(i+1));CHKERRQ(ierr);
+    ierr = VecView(x,viewer);CHKERRQ(ierr);
+    /* the data written must not be affected by changing the vector right away */
+    ierr = VecGetArray(x,&a);CHKERRQ(ierr);
+    a[0] = -1.0;
+    ierr = VecRestoreArray(x,&a);CHKERRQ(ierr);
+    if (i == 2) {ierr = PetscViewerFlush(viewer);CHKERRQ(ierr);}
+  }
+  ierr = PetscViewerDestroy(&viewer);CHKERRQ(ierr);
+
+  ierr = PetscViewerBinaryOpen(PETSC_COMM_WORLD,"async.dat",FILE_MODE_READ,&viewer);CHKERRQ(ierr);
+  for (i=0; i<nsteps; i++) {
+    ierr = VecLoad(y,viewer);CHKERRQ(ierr);
+    ierr = VecSet(x,(PetscScalar)(i+1));CHKERRQ(ierr);
+    ierr = VecAXPY(x,-1.0,y);CHKERRQ(ierr);
+    ierr = VecNorm(x,NORM_INFINITY,&norm);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Step %D error %g\n",i,(double)norm);CHKERRQ(ierr);
+  }
+  ierr = PetscViewerDestroy(&viewer);CHKERRQ(ierr);
+
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
@@ -412,15 +412,13 @@ PetscErrorCode VecView_MPI_Binary(Vec xin,PetscViewer viewer)
 #if defined(PETSC_HAVE_MPIIO)
   } else {
     MPI_Offset   off;
-    MPI_File     mfdes;
     PetscMPIInt  lsize;
 
+    /* with an asynchronous viewer the array is copied and the write overlaps the following computation */
     ierr = PetscMPIIntCast(xin->map->n,&lsize);CHKERRQ(ierr);
-    ierr = PetscViewerBinaryGetMPIIODescriptor(viewer,&mfdes);CHKERRQ(ierr);
     ierr = PetscViewerBinaryGetMPIIOOffset(viewer,&off);CHKERRQ(ierr);
     off += xin->map->rstart*sizeof(PetscScalar); /* off is MPI_Offset, not PetscMPIInt */
-    ierr = MPI_File_set_view(mfdes,off,MPIU_SCALAR,MPIU_SCALAR,(char*)"native",MPI_INFO_NULL);CHKERRQ(ierr);
-    ierr = MPIU_File_write_all(mfdes,(void*)xarray,lsize,MPIU_SCALAR,MPI_STATUS_IGNORE);CHKERRQ(ierr);
+    ierr = PetscViewerBinaryWriteAtAllMPIIO(viewer,off,(void*)xarray,lsize,MPIU_SCALAR);CHKERRQ(ierr);
     ierr = PetscViewerBinaryAddMPIIOOffset(viewer,xin->map->N*sizeof(PetscScalar));CHKERRQ(ierr);
   }
 #endif
@@ -669,9 +667,8 @@ PetscErrorCode VecView_MPI_HDF5(Vec xin, PetscViewer viewer)
   /* Create the dataset with default properties and close filespace */
   ierr = PetscObjectGetName((PetscObject) xin, &vecname);CHKERRQ(ierr);
   if (!H5Lexists(group, vecname, H5P_DEFAULT)) {
-    /* Create chunk */
-    PetscStackCallHDF5Return(chunkspace,H5Pcreate,(H5P_DATASET_CREATE));
-    PetscStackCallHDF5(H5Pset_chunk,(chunkspace, dim, chunkDims));
+    /* Create chunk, with the chunk size and compression filters of the viewer */
+    ierr = PetscViewerHDF5CreateDatasetPList(viewer, dim, timestep >= 0 ? 1 : 0, bs, chunkDims, &chunkspace);CHKERRQ(ierr);
 
 #if (H5_VERS_MAJOR * 10000 + H5_VERS_MINOR * 100 + H5_VERS_RELEASE >= 10800)
     PetscStackCallHDF5Return(dset_id,H5Dcreate2,(group, vecname, filescalartype, filespace, H5P_DEFAULT, chunkspace, H5P_DEFAULT));
@@ -733,12 +730,8 @@ PetscErrorCode VecView_MPI_HDF5(Vec xin, PetscViewer viewer)
     PetscStackCallHDF5Return(filespace,H5Screate,(H5S_NULL));
   }
 
-  /* Create property list for collective dataset write */
-  PetscStackCallHDF5Return(plist_id,H5Pcreate,(H5P_DATASET_XFER));
-#if defined(PETSC_HAVE_H5PSET_FAPL_MPIO)
-  PetscStackCallHDF5(H5Pset_dxpl_mpio,(plist_id, H5FD_MPIO_COLLECTIVE));
-#endif
-  /* To write dataset independently use H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_INDEPENDENT) */
+  /* Create property list for collective or independent dataset write */
+  ierr = PetscViewerHDF5CreateTransferPList(viewer, &plist_id);CHKERRQ(ierr);
 
   ierr   = VecGetArrayRead(xin, &x);CHKERRQ(ierr);
   PetscStackCallHDF5(H5Dwrite,(dset_id, memscalartype, memspace, filespace, plist_id, x));
@@ -8,6 +8,7 @@
 #include <petscsys.h>
 #include <petscvec.h>         /*I  "petscvec.h"  I*/
 #include <petsc/private/vecimpl.h>
+#include <../src/vec/vec/impls/dvecimpl.h>
 #include <petscviewerhdf5.h>
 
 static PetscErrorCode PetscViewerBinaryReadVecHeader_Private(PetscViewer viewer,PetscInt *rows)
@@ -56,13 +57,42 @@ static PetscErrorCode VecLoad_Binary_MPIIO(Vec vec, PetscViewer viewer)
 }
 #endif
 
+/*
+   Points the array of a VECSEQ owning its storage into a mapping of the file, the mapping is composed with
+   the vector and unmapped when the vector is destroyed
+*/
+static PetscErrorCode VecLoad_Binary_Mapped(Vec vec,PetscViewer viewer,PetscBool *mapped)
+{
+  Vec_Seq        *s = (Vec_Seq*)vec->data;
+  PetscContainer map;
+  void           *data;
+  PetscBool      isseq;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  *mapped = PETSC_FALSE;
+  ierr    = PetscObjectTypeCompare((PetscObject)vec,VECSEQ,&isseq);CHKERRQ(ierr);
+  if (!isseq || !s->array_allocated || s->array != s->array_allocated || s->unplacedarray) PetscFunctionReturn(0);
+  ierr = PetscViewerBinaryReadMapped(viewer,vec->map->n,PETSC_SCALAR,&data,&map);CHKERRQ(ierr);
+  if (!data) PetscFunctionReturn(0);
+  ierr     = PetscFree(s->array_allocated);CHKERRQ(ierr);
+  s->array = (PetscScalar*)data;
+  ierr     = PetscObjectCompose((PetscObject)vec,"VecLoad_Binary_map",(PetscObject)map);CHKERRQ(ierr);
+  ierr     = PetscContainerDestroy(&map);CHKERRQ(ierr);
+  ierr     = PetscObjectStateIncrease((PetscObject)vec);CHKERRQ(ierr);
+  ierr     = VecAssemblyBegin(vec);CHKERRQ(ierr);
+  ierr     = VecAssemblyEnd(vec);CHKERRQ(ierr);
+  *mapped  = PETSC_TRUE;
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode VecLoad_Binary(Vec vec, PetscViewer viewer)
 {
   PetscMPIInt    size,rank,tag;
   int            fd;
   PetscInt       i,rows = 0,n,*range,N,bs;
   PetscErrorCode ierr;
-  PetscBool      flag,skipheader;
+  PetscBool      flag,skipheader,mapped;
   PetscScalar    *avec,*avecwork;
   MPI_Comm       comm;
   MPI_Request    request;
@@ -112,6 +142,10 @@ PetscErrorCode VecLoad_Binary(Vec vec, PetscViewer viewer)
 #endif
 
   ierr = VecGetLocalSize(vec,&n);CHKERRQ(ierr);
+  if (size == 1) {
+    ierr = VecLoad_Binary_Mapped(vec,viewer,&mapped);CHKERRQ(ierr);
+    if (mapped) PetscFunctionReturn(0);
+  }
   ierr = PetscObjectGetNewTag((PetscObject)viewer,&tag);CHKERRQ(ierr);
   ierr = VecGetArray(vec,&avec);CHKERRQ(ierr);
   if (!rank) {
@@ -347,12 +381,8 @@ PetscErrorCode VecLoad_HDF5(Vec xin, PetscViewer viewer)
 #endif
   PetscStackCallHDF5(H5Sselect_hyperslab,(filespace, H5S_SELECT_SET, offset, NULL, count, NULL));
 
-  /* Create property list for collective dataset read */
-  PetscStackCallHDF5Return(plist_id,H5Pcreate,(H5P_DATASET_XFER));
-#if defined(PETSC_HAVE_H5PSET_FAPL_MPIO)
-  PetscStackCallHDF5(H5Pset_dxpl_mpio,(plist_id, H5FD_MPIO_COLLECTIVE));
-#endif
-  /* To write dataset independently use H5Pset_dxpl_mpio(plist_id, H5FD_MPIO_INDEPENDENT) */
+  /* Create property list for collective or independent dataset read */
+  ierr = PetscViewerHDF5CreateTransferPList(viewer, &plist_id);CHKERRQ(ierr);
 
   ierr   = VecGetArray(xin, &x);CHKERRQ(ierr);
   PetscStackCallHDF5(H5Dread,(dset_id, scalartype, memspace, filespace, plist_id, x));